@@ -0,0 +1,164 @@
+/*=Plus=header=begin======================================================
+  Program: Plus
+  Copyright (c) Laboratory for Percutaneous Surgery. All rights reserved.
+  See License.txt for details.
+=========================================================Plus=header=end*/
+
+/*!
+  \file BufferBenchmarks.cxx
+  \brief Benchmarks of adding items to and getting items from vtkPlusBuffer
+*/
+
+#include "PlusBenchmarkData.h"
+#include "vtkPlusBuffer.h"
+
+// VTK includes
+#include <vtkImageData.h>
+#include <vtkMatrix4x4.h>
+#include <vtkSmartPointer.h>
+
+// Google Benchmark includes
+#include <benchmark/benchmark.h>
+
+namespace
+{
+  const int BUFFER_SIZE = 150;
+  const std::array<int, 3> NO_CLIP_RECTANGLE = {PlusCommon::NO_CLIP, PlusCommon::NO_CLIP, PlusCommon::NO_CLIP};
+
+  //----------------------------------------------------------------------------
+  PlusStatus FillTransformBuffer(vtkPlusBuffer* buffer, int numberOfItems)
+  {
+    vtkSmartPointer<vtkMatrix4x4> matrix = vtkSmartPointer<vtkMatrix4x4>::New();
+    for (int frameIndex = 0; frameIndex < numberOfItems; ++frameIndex)
+    {
+      PlusBenchmarkData::GetSweepTransform(frameIndex, matrix);
+      double timestamp = frameIndex * PlusBenchmarkData::FRAME_PERIOD_SEC;
+      if (buffer->AddTimeStampedItem(matrix, TOOL_OK, frameIndex, timestamp, timestamp) != PLUS_SUCCESS)
+      {
+        return PLUS_FAIL;
+      }
+    }
+    return PLUS_SUCCESS;
+  }
+}
+
+//----------------------------------------------------------------------------
+// Add video frames of width x height pixels (arguments) to a buffer
+static void BM_BufferAddVideoItem(benchmark::State& state)
+{
+  const int width = static_cast<int>(state.range(0));
+  const int height = static_cast<int>(state.range(1));
+  vtkSmartPointer<vtkPlusBuffer> buffer = vtkSmartPointer<vtkPlusBuffer>::New();
+  buffer->SetBufferSize(BUFFER_SIZE);
+  buffer->SetFrameSize(width, height, 1);
+  vtkSmartPointer<vtkImageData> image = vtkSmartPointer<vtkImageData>::New();
+  PlusBenchmarkData::CreateImage(image, width, height);
+
+  long frameNumber = 0;
+  for (auto _ : state)
+  {
+    double timestamp = frameNumber * PlusBenchmarkData::FRAME_PERIOD_SEC;
+    if (buffer->AddItem(image, US_IMG_ORIENT_MF, US_IMG_BRIGHTNESS, frameNumber, NO_CLIP_RECTANGLE, NO_CLIP_RECTANGLE, timestamp, timestamp) != PLUS_SUCCESS)
+    {
+      state.SkipWithError("Failed to add video item to the buffer");
+      break;
+    }
+    ++frameNumber;
+  }
+  state.SetItemsProcessed(state.iterations());
+  state.SetBytesProcessed(state.iterations() * width * height);
+}
+BENCHMARK(BM_BufferAddVideoItem)->Args({320, 240})->Args({640, 480})->Args({1920, 1080});
+
+//----------------------------------------------------------------------------
+// Add transforms to a buffer
+static void BM_BufferAddTransformItem(benchmark::State& state)
+{
+  vtkSmartPointer<vtkPlusBuffer> buffer = vtkSmartPointer<vtkPlusBuffer>::New();
+  buffer->SetBufferSize(BUFFER_SIZE);
+  vtkSmartPointer<vtkMatrix4x4> matrix = vtkSmartPointer<vtkMatrix4x4>::New();
+  PlusBenchmarkData::GetSweepTransform(1, matrix);
+
+  unsigned long frameNumber = 0;
+  for (auto _ : state)
+  {
+    double timestamp = frameNumber * PlusBenchmarkData::FRAME_PERIOD_SEC;
+    if (buffer->AddTimeStampedItem(matrix, TOOL_OK, frameNumber, timestamp, timestamp) != PLUS_SUCCESS)
+    {
+      state.SkipWithError("Failed to add transform item to the buffer");
+      break;
+    }
+    ++frameNumber;
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_BufferAddTransformItem);
+
+//----------------------------------------------------------------------------
+// Get transforms from a full buffer at times between the item timestamps, with the interpolation type given as argument
+static void BM_BufferGetTransformItemFromTime(benchmark::State& state)
+{
+  vtkPlusBuffer::DataItemTemporalInterpolationType interpolation = static_cast<vtkPlusBuffer::DataItemTemporalInterpolationType>(state.range(0));
+  vtkSmartPointer<vtkPlusBuffer> buffer = vtkSmartPointer<vtkPlusBuffer>::New();
+  buffer->SetBufferSize(BUFFER_SIZE);
+  if (FillTransformBuffer(buffer, BUFFER_SIZE) != PLUS_SUCCESS)
+  {
+    state.SkipWithError("Failed to fill the buffer");
+    return;
+  }
+  state.SetLabel(interpolation == vtkPlusBuffer::INTERPOLATED ? "interpolated" : "closest");
+
+  StreamBufferItem item;
+  int queryIndex = 0;
+  for (auto _ : state)
+  {
+    // Query times cycle through the whole buffer, in the middle between two items
+    double time = (queryIndex % (BUFFER_SIZE - 1) + 0.5) * PlusBenchmarkData::FRAME_PERIOD_SEC;
+    if (buffer->GetStreamBufferItemFromTime(time, &item, interpolation) != ITEM_OK)
+    {
+      state.SkipWithError("Failed to get transform item from the buffer");
+      break;
+    }
+    ++queryIndex;
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_BufferGetTransformItemFromTime)->Arg(vtkPlusBuffer::CLOSEST_TIME)->Arg(vtkPlusBuffer::INTERPOLATED);
+
+//----------------------------------------------------------------------------
+// Get video frames of 640x480 pixels from a full buffer by time (the frame is copied)
+static void BM_BufferGetVideoItemFromTime(benchmark::State& state)
+{
+  const int width = 640;
+  const int height = 480;
+  vtkSmartPointer<vtkPlusBuffer> buffer = vtkSmartPointer<vtkPlusBuffer>::New();
+  buffer->SetBufferSize(BUFFER_SIZE);
+  buffer->SetFrameSize(width, height, 1);
+  vtkSmartPointer<vtkImageData> image = vtkSmartPointer<vtkImageData>::New();
+  for (int frameIndex = 0; frameIndex < BUFFER_SIZE; ++frameIndex)
+  {
+    PlusBenchmarkData::CreateImage(image, width, height, frameIndex);
+    double timestamp = frameIndex * PlusBenchmarkData::FRAME_PERIOD_SEC;
+    if (buffer->AddItem(image, US_IMG_ORIENT_MF, US_IMG_BRIGHTNESS, frameIndex, NO_CLIP_RECTANGLE, NO_CLIP_RECTANGLE, timestamp, timestamp) != PLUS_SUCCESS)
+    {
+      state.SkipWithError("Failed to fill the buffer");
+      return;
+    }
+  }
+
+  StreamBufferItem item;
+  int queryIndex = 0;
+  for (auto _ : state)
+  {
+    double time = (queryIndex % BUFFER_SIZE) * PlusBenchmarkData::FRAME_PERIOD_SEC;
+    if (buffer->GetStreamBufferItemFromTime(time, &item, vtkPlusBuffer::CLOSEST_TIME) != ITEM_OK)
+    {
+      state.SkipWithError("Failed to get video item from the buffer");
+      break;
+    }
+    ++queryIndex;
+  }
+  state.SetItemsProcessed(state.iterations());
+  state.SetBytesProcessed(state.iterations() * width * height);
+}
+BENCHMARK(BM_BufferGetVideoItemFromTime);
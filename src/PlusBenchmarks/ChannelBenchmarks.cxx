@@ -0,0 +1,75 @@
+/*=Plus=header=begin======================================================
+  Program: Plus
+  Copyright (c) Laboratory for Percutaneous Surgery. All rights reserved.
+  See License.txt for details.
+=========================================================Plus=header=end*/
+
+/*!
+  \file ChannelBenchmarks.cxx
+  \brief Benchmarks of getting tracked frames from a vtkPlusChannel
+*/
+
+#include "PlusBenchmarkData.h"
+#include "vtkPlusChannel.h"
+
+// Google Benchmark includes
+#include <benchmark/benchmark.h>
+
+namespace
+{
+  const int BUFFER_SIZE = 150;
+}
+
+//----------------------------------------------------------------------------
+// Get the latest tracked frame of width x height pixels (arguments) from a channel with full buffers
+static void BM_ChannelGetTrackedFrame(benchmark::State& state)
+{
+  PlusBenchmarkData::SyntheticChannel syntheticChannel(static_cast<int>(state.range(0)), static_cast<int>(state.range(1)), BUFFER_SIZE);
+  for (int i = 0; i < BUFFER_SIZE; ++i)
+  {
+    if (syntheticChannel.AddFrame() != PLUS_SUCCESS)
+    {
+      state.SkipWithError("Failed to fill the channel buffers");
+      return;
+    }
+  }
+
+  PlusTrackedFrame trackedFrame;
+  for (auto _ : state)
+  {
+    if (syntheticChannel.GetChannel()->GetTrackedFrame(trackedFrame) != PLUS_SUCCESS)
+    {
+      state.SkipWithError("Failed to get tracked frame from the channel");
+      break;
+    }
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_ChannelGetTrackedFrame)->Args({640, 480})->Args({1920, 1080});
+
+//----------------------------------------------------------------------------
+// Acquisition loop: add a frame of width x height pixels (arguments) and a transform, then get the latest tracked frame
+static void BM_ChannelAcquireAndGetTrackedFrame(benchmark::State& state)
+{
+  const int width = static_cast<int>(state.range(0));
+  const int height = static_cast<int>(state.range(1));
+  PlusBenchmarkData::SyntheticChannel syntheticChannel(width, height, BUFFER_SIZE);
+
+  PlusTrackedFrame trackedFrame;
+  for (auto _ : state)
+  {
+    if (syntheticChannel.AddFrame() != PLUS_SUCCESS)
+    {
+      state.SkipWithError("Failed to add frame to the channel");
+      break;
+    }
+    if (syntheticChannel.GetChannel()->GetTrackedFrame(trackedFrame) != PLUS_SUCCESS)
+    {
+      state.SkipWithError("Failed to get tracked frame from the channel");
+      break;
+    }
+  }
+  state.SetItemsProcessed(state.iterations());
+  state.SetBytesProcessed(state.iterations() * width * height);
+}
+BENCHMARK(BM_ChannelAcquireAndGetTrackedFrame)->Args({640, 480})->Args({1920, 1080});
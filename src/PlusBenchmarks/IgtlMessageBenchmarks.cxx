@@ -0,0 +1,142 @@
+/*=Plus=header=begin======================================================
+  Program: Plus
+  Copyright (c) Laboratory for Percutaneous Surgery. All rights reserved.
+  See License.txt for details.
+=========================================================Plus=header=end*/
+
+/*!
+  \file IgtlMessageBenchmarks.cxx
+  \brief Benchmarks of packing OpenIGTLink messages with vtkPlusIgtlMessageFactory
+*/
+
+#include "PlusBenchmarkData.h"
+#include "PlusIgtlClientInfo.h"
+#include "vtkPlusChannel.h"
+#include "vtkPlusIgtlMessageFactory.h"
+#include "vtkPlusTransformRepository.h"
+
+// VTK includes
+#include <vtkMatrix4x4.h>
+#include <vtkSmartPointer.h>
+
+// Google Benchmark includes
+#include <benchmark/benchmark.h>
+
+namespace
+{
+  const int BUFFER_SIZE = 150;
+
+  //----------------------------------------------------------------------------
+  // Client that receives the image with its ImageToReference transform and the ProbeToTracker transform
+  PlusIgtlClientInfo CreateClientInfo(bool sendImage)
+  {
+    PlusIgtlClientInfo clientInfo;
+    clientInfo.IgtlMessageTypes.push_back("TRANSFORM");
+    clientInfo.TransformNames.push_back(PlusTransformName("Probe", "Tracker"));
+    if (sendImage)
+    {
+      clientInfo.IgtlMessageTypes.push_back("IMAGE");
+      PlusIgtlClientInfo::ImageStream imageStream;
+      imageStream.Name = "Image";
+      imageStream.EmbeddedTransformToFrame = "Reference";
+      clientInfo.ImageStreams.push_back(imageStream);
+    }
+    return clientInfo;
+  }
+
+  //----------------------------------------------------------------------------
+  // Static transforms (calibration and reference), the frames provide the ProbeToTracker transform
+  PlusStatus SetUpRepository(vtkPlusTransformRepository* repository)
+  {
+    vtkSmartPointer<vtkMatrix4x4> identity = vtkSmartPointer<vtkMatrix4x4>::New();
+    if (repository->SetTransform(PlusTransformName("Image", "Probe"), identity) != PLUS_SUCCESS)
+    {
+      return PLUS_FAIL;
+    }
+    return repository->SetTransform(PlusTransformName("Reference", "Tracker"), identity);
+  }
+}
+
+//----------------------------------------------------------------------------
+// Pack the messages of a 640x480 tracked frame, arguments: send image (0/1) and zero-copy image messages (0/1)
+static void BM_IgtlPackMessages(benchmark::State& state)
+{
+  const bool sendImage = (state.range(0) != 0);
+  const bool zeroCopy = (state.range(1) != 0);
+  const int width = 640;
+  const int height = 480;
+
+  vtkSmartPointer<vtkPlusIgtlMessageFactory> factory = vtkSmartPointer<vtkPlusIgtlMessageFactory>::New();
+  factory->SetZeroCopyImageMessages(zeroCopy);
+  vtkSmartPointer<vtkPlusTransformRepository> repository = vtkSmartPointer<vtkPlusTransformRepository>::New();
+  PlusTrackedFrame trackedFrame;
+  if (PlusBenchmarkData::CreateTrackedFrame(trackedFrame, width, height, 1) != PLUS_SUCCESS)
+  {
+    state.SkipWithError("Failed to create tracked frame");
+    return;
+  }
+  PlusIgtlClientInfo clientInfo = CreateClientInfo(sendImage);
+  state.SetLabel(std::string(sendImage ? "image+transform" : "transform") + (zeroCopy ? " zero-copy" : ""));
+
+  std::vector<igtl::MessageBase::Pointer> igtlMessages;
+  for (auto _ : state)
+  {
+    if (factory->PackMessages(0, clientInfo, igtlMessages, trackedFrame, true, repository) != PLUS_SUCCESS)
+    {
+      state.SkipWithError("Failed to pack messages");
+      break;
+    }
+  }
+  state.SetItemsProcessed(state.iterations());
+  if (sendImage)
+  {
+    state.SetBytesProcessed(state.iterations() * width * height);
+  }
+}
+BENCHMARK(BM_IgtlPackMessages)->Args({0, 0})->Args({1, 0})->Args({1, 1});
+
+//----------------------------------------------------------------------------
+// Broadcast pipeline of the server for each frame: acquire a 640x480 frame and a transform, get the tracked frame
+// from the channel, and pack the image and transform messages, argument: zero-copy image messages (0/1)
+static void BM_IgtlAcquireAndPackMessages(benchmark::State& state)
+{
+  const bool zeroCopy = (state.range(0) != 0);
+  const int width = 640;
+  const int height = 480;
+
+  PlusBenchmarkData::SyntheticChannel syntheticChannel(width, height, BUFFER_SIZE);
+  vtkSmartPointer<vtkPlusIgtlMessageFactory> factory = vtkSmartPointer<vtkPlusIgtlMessageFactory>::New();
+  factory->SetZeroCopyImageMessages(zeroCopy);
+  vtkSmartPointer<vtkPlusTransformRepository> repository = vtkSmartPointer<vtkPlusTransformRepository>::New();
+  if (SetUpRepository(repository) != PLUS_SUCCESS)
+  {
+    state.SkipWithError("Failed to set up the transform repository");
+    return;
+  }
+  PlusIgtlClientInfo clientInfo = CreateClientInfo(true);
+  state.SetLabel(zeroCopy ? "zero-copy" : "");
+
+  PlusTrackedFrame trackedFrame;
+  std::vector<igtl::MessageBase::Pointer> igtlMessages;
+  for (auto _ : state)
+  {
+    if (syntheticChannel.AddFrame() != PLUS_SUCCESS)
+    {
+      state.SkipWithError("Failed to add frame to the channel");
+      break;
+    }
+    if (syntheticChannel.GetChannel()->GetTrackedFrame(trackedFrame) != PLUS_SUCCESS)
+    {
+      state.SkipWithError("Failed to get tracked frame from the channel");
+      break;
+    }
+    if (factory->PackMessages(0, clientInfo, igtlMessages, trackedFrame, true, repository) != PLUS_SUCCESS)
+    {
+      state.SkipWithError("Failed to pack messages");
+      break;
+    }
+  }
+  state.SetItemsProcessed(state.iterations());
+  state.SetBytesProcessed(state.iterations() * width * height);
+}
+BENCHMARK(BM_IgtlAcquireAndPackMessages)->Arg(0)->Arg(1);
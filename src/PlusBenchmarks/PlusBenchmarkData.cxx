@@ -0,0 +1,147 @@
+/*=Plus=header=begin======================================================
+  Program: Plus
+  Copyright (c) Laboratory for Percutaneous Surgery. All rights reserved.
+  See License.txt for details.
+=========================================================Plus=header=end*/
+
+#include "PlusBenchmarkData.h"
+#include "vtkPlusChannel.h"
+#include "vtkPlusDataSource.h"
+#include "vtkPlusTrackedFrameList.h"
+
+// VTK includes
+#include <vtkImageData.h>
+#include <vtkMatrix4x4.h>
+#include <vtkTransform.h>
+
+//----------------------------------------------------------------------------
+void PlusBenchmarkData::CreateImage(vtkImageData* image, int width, int height, int frameIndex)
+{
+  image->SetExtent(0, width - 1, 0, height - 1, 0, 0);
+  image->AllocateScalars(VTK_UNSIGNED_CHAR, 1);
+  unsigned char* pixels = static_cast<unsigned char*>(image->GetScalarPointer());
+  // Linear congruential generator seeded by the frame index, so that each frame is different but reproducible
+  unsigned int value = 12345u + static_cast<unsigned int>(frameIndex);
+  for (int i = 0; i < width * height; ++i)
+  {
+    value = value * 1103515245u + 12345u;
+    pixels[i] = static_cast<unsigned char>((value >> 16) & 0xFF);
+  }
+  image->Modified();
+}
+
+//----------------------------------------------------------------------------
+void PlusBenchmarkData::GetSweepTransform(int frameIndex, vtkMatrix4x4* transform)
+{
+  vtkSmartPointer<vtkTransform> sweepTransform = vtkSmartPointer<vtkTransform>::New();
+  sweepTransform->Translate(0, 0, frameIndex % SWEEP_LENGTH);
+  sweepTransform->RotateX(10.0);
+  transform->DeepCopy(sweepTransform->GetMatrix());
+}
+
+//----------------------------------------------------------------------------
+PlusStatus PlusBenchmarkData::CreateTrackedFrame(PlusTrackedFrame& trackedFrame, int width, int height, int frameIndex)
+{
+  vtkSmartPointer<vtkImageData> image = vtkSmartPointer<vtkImageData>::New();
+  CreateImage(image, width, height, frameIndex);
+  PlusVideoFrame videoFrame;
+  if (videoFrame.DeepCopyFrom(image) != PLUS_SUCCESS)
+  {
+    LOG_ERROR("Failed to create synthetic video frame");
+    return PLUS_FAIL;
+  }
+  videoFrame.SetImageOrientation(US_IMG_ORIENT_MF);
+  videoFrame.SetImageType(US_IMG_BRIGHTNESS);
+  trackedFrame.SetImageData(videoFrame);
+  trackedFrame.SetTimestamp(frameIndex * FRAME_PERIOD_SEC);
+
+  vtkSmartPointer<vtkMatrix4x4> identity = vtkSmartPointer<vtkMatrix4x4>::New();
+  vtkSmartPointer<vtkMatrix4x4> probeToTracker = vtkSmartPointer<vtkMatrix4x4>::New();
+  GetSweepTransform(frameIndex, probeToTracker);
+
+  PlusTransformName imageToProbeName("Image", "Probe");
+  PlusTransformName probeToTrackerName("Probe", "Tracker");
+  PlusTransformName referenceToTrackerName("Reference", "Tracker");
+  if (trackedFrame.SetFrameTransform(imageToProbeName, identity) != PLUS_SUCCESS
+      || trackedFrame.SetFrameTransformStatus(imageToProbeName, FIELD_OK) != PLUS_SUCCESS
+      || trackedFrame.SetFrameTransform(probeToTrackerName, probeToTracker) != PLUS_SUCCESS
+      || trackedFrame.SetFrameTransformStatus(probeToTrackerName, FIELD_OK) != PLUS_SUCCESS
+      || trackedFrame.SetFrameTransform(referenceToTrackerName, identity) != PLUS_SUCCESS
+      || trackedFrame.SetFrameTransformStatus(referenceToTrackerName, FIELD_OK) != PLUS_SUCCESS)
+  {
+    LOG_ERROR("Failed to set synthetic frame transforms");
+    return PLUS_FAIL;
+  }
+  return PLUS_SUCCESS;
+}
+
+//----------------------------------------------------------------------------
+PlusStatus PlusBenchmarkData::CreateTrackedFrameList(vtkPlusTrackedFrameList* trackedFrameList, int numberOfFrames, int width, int height)
+{
+  trackedFrameList->Clear();
+  for (int frameIndex = 0; frameIndex < numberOfFrames; ++frameIndex)
+  {
+    PlusTrackedFrame trackedFrame;
+    if (CreateTrackedFrame(trackedFrame, width, height, frameIndex) != PLUS_SUCCESS)
+    {
+      return PLUS_FAIL;
+    }
+    if (trackedFrameList->AddTrackedFrame(&trackedFrame) != PLUS_SUCCESS)
+    {
+      LOG_ERROR("Failed to add synthetic frame " << frameIndex << " to the tracked frame list");
+      return PLUS_FAIL;
+    }
+  }
+  return PLUS_SUCCESS;
+}
+
+//----------------------------------------------------------------------------
+PlusBenchmarkData::SyntheticChannel::SyntheticChannel(int width, int height, int bufferSize)
+  : Channel(vtkSmartPointer<vtkPlusChannel>::New())
+  , VideoSource(vtkSmartPointer<vtkPlusDataSource>::New())
+  , ProbeTool(vtkSmartPointer<vtkPlusDataSource>::New())
+  , Image(vtkSmartPointer<vtkImageData>::New())
+  , Matrix(vtkSmartPointer<vtkMatrix4x4>::New())
+  , FrameNumber(0)
+{
+  this->VideoSource->SetId("Video");
+  this->VideoSource->SetType(DATA_SOURCE_TYPE_VIDEO);
+  this->VideoSource->SetBufferSize(bufferSize);
+  this->VideoSource->SetInputImageOrientation(US_IMG_ORIENT_MF);
+  this->VideoSource->SetImageType(US_IMG_BRIGHTNESS);
+  this->VideoSource->SetPixelType(VTK_UNSIGNED_CHAR);
+  this->VideoSource->SetNumberOfScalarComponents(1);
+  this->VideoSource->SetInputFrameSize(width, height, 1);
+
+  this->ProbeTool->SetId("ProbeToTracker");
+  this->ProbeTool->SetReferenceCoordinateFrameName("Tracker");
+  this->ProbeTool->SetType(DATA_SOURCE_TYPE_TOOL);
+  this->ProbeTool->SetBufferSize(bufferSize);
+
+  this->Channel->SetChannelId("SyntheticChannel");
+  this->Channel->SetVideoSource(this->VideoSource);
+  this->Channel->AddTool(this->ProbeTool);
+
+  CreateImage(this->Image, width, height);
+}
+
+//----------------------------------------------------------------------------
+PlusStatus PlusBenchmarkData::SyntheticChannel::AddFrame()
+{
+  double timestamp = this->FrameNumber * FRAME_PERIOD_SEC;
+  int* dimensions = this->Image->GetDimensions();
+  FrameSizeType frameSize = {static_cast<unsigned int>(dimensions[0]), static_cast<unsigned int>(dimensions[1]), 1};
+  if (this->VideoSource->AddItem(this->Image->GetScalarPointer(), US_IMG_ORIENT_MF, frameSize, VTK_UNSIGNED_CHAR, 1, US_IMG_BRIGHTNESS, 0, this->FrameNumber, timestamp, timestamp) != PLUS_SUCCESS)
+  {
+    LOG_ERROR("Failed to add synthetic frame " << this->FrameNumber << " to the video source");
+    return PLUS_FAIL;
+  }
+  GetSweepTransform(this->FrameNumber, this->Matrix);
+  if (this->ProbeTool->AddTimeStampedItem(this->Matrix, TOOL_OK, this->FrameNumber, timestamp, timestamp) != PLUS_SUCCESS)
+  {
+    LOG_ERROR("Failed to add synthetic transform " << this->FrameNumber << " to the tool");
+    return PLUS_FAIL;
+  }
+  ++this->FrameNumber;
+  return PLUS_SUCCESS;
+}
@@ -0,0 +1,85 @@
+/*=Plus=header=begin======================================================
+  Program: Plus
+  Copyright (c) Laboratory for Percutaneous Surgery. All rights reserved.
+  See License.txt for details.
+=========================================================Plus=header=end*/
+
+#ifndef __PlusBenchmarkData_h
+#define __PlusBenchmarkData_h
+
+#include "PlusConfigure.h"
+#include "PlusTrackedFrame.h"
+
+// VTK includes
+#include <vtkSmartPointer.h>
+
+class vtkImageData;
+class vtkMatrix4x4;
+class vtkPlusChannel;
+class vtkPlusDataSource;
+class vtkPlusTrackedFrameList;
+
+/*!
+  \file PlusBenchmarkData.h
+  \brief Synthetic data for the benchmarks
+
+  All data is computed from the frame index (no random numbers, no input files, no hardware),
+  so that results of different runs and different machines are comparable.
+  Frames simulate a probe sweep: the image is tilted and translated along the elevational axis
+  by one unit per frame, the sweep restarts after SWEEP_LENGTH frames.
+  The tracked frames contain ImageToProbe (identity), ProbeToTracker (the sweep), and ReferenceToTracker (identity)
+  transforms, so ImageToReference is the same as the sweep transform.
+
+  \ingroup PlusLibBenchmarks
+*/
+namespace PlusBenchmarkData
+{
+  /*! Time between consecutive synthetic frames, in seconds */
+  static const double FRAME_PERIOD_SEC = 0.01;
+
+  /*! Number of frames in a sweep */
+  static const int SWEEP_LENGTH = 100;
+
+  /*! Fill an 8-bit single component image with a deterministic speckle-like pattern */
+  void CreateImage(vtkImageData* image, int width, int height, int frameIndex = 0);
+
+  /*! Get the transform of the frame in the synthetic sweep */
+  void GetSweepTransform(int frameIndex, vtkMatrix4x4* transform);
+
+  /*! Create a tracked frame with image (B-mode, MF orientation), timestamp, and transforms */
+  PlusStatus CreateTrackedFrame(PlusTrackedFrame& trackedFrame, int width, int height, int frameIndex);
+
+  /*! Create a list of tracked frames of the synthetic sweep */
+  PlusStatus CreateTrackedFrameList(vtkPlusTrackedFrameList* trackedFrameList, int numberOfFrames, int width, int height);
+
+  /*!
+    \class SyntheticChannel
+    \brief Channel with a video source and a ProbeToTracker tool, as set up by a tracked imaging device
+
+    The data sources are filled directly by AddFrame, so no device or hardware is needed.
+  */
+  class SyntheticChannel
+  {
+  public:
+    SyntheticChannel(int width, int height, int bufferSize);
+
+    /*! Add the next frame of the synthetic sweep to the video source and its transform to the tool */
+    PlusStatus AddFrame();
+
+    vtkPlusChannel* GetChannel() { return this->Channel; }
+
+  protected:
+    vtkSmartPointer<vtkPlusChannel> Channel;
+    vtkSmartPointer<vtkPlusDataSource> VideoSource;
+    vtkSmartPointer<vtkPlusDataSource> ProbeTool;
+    vtkSmartPointer<vtkImageData> Image;
+    vtkSmartPointer<vtkMatrix4x4> Matrix;
+    long FrameNumber;
+
+  private:
+    SyntheticChannel(const SyntheticChannel&);
+    void operator=(const SyntheticChannel&);
+  };
+}
+
+#endif
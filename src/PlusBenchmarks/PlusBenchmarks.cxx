@@ -0,0 +1,41 @@
+/*=Plus=header=begin======================================================
+  Program: Plus
+  Copyright (c) Laboratory for Percutaneous Surgery. All rights reserved.
+  See License.txt for details.
+=========================================================Plus=header=end*/
+
+/*!
+  \file PlusBenchmarks.cxx
+  \brief Micro- and macro-benchmarks of the performance-critical parts of Plus
+
+  All benchmarks use synthetic data and devices, so they run without hardware, input files, or display.
+  The command-line arguments are the standard Google Benchmark arguments, for example:
+
+    PlusBenchmarks --benchmark_filter=Buffer --benchmark_repetitions=5 --benchmark_out=results.json --benchmark_out_format=json
+
+  The JSON output contains the Plus version (with revision) in its context section, so results can be tracked over time.
+  Only errors are logged by default, as logging would distort the measurements.
+*/
+
+#include "PlusConfigure.h"
+
+// Google Benchmark includes
+#include <benchmark/benchmark.h>
+
+//----------------------------------------------------------------------------
+int main(int argc, char** argv)
+{
+  benchmark::Initialize(&argc, argv);
+  if (benchmark::ReportUnrecognizedArguments(argc, argv))
+  {
+    return EXIT_FAILURE;
+  }
+
+  vtkPlusLogger::Instance()->SetLogLevel(vtkPlusLogger::LOG_LEVEL_ERROR);
+
+  benchmark::AddCustomContext("plus_version", PlusCommon::GetPlusLibVersionString());
+
+  benchmark::RunSpecifiedBenchmarks();
+  benchmark::Shutdown();
+  return EXIT_SUCCESS;
+}
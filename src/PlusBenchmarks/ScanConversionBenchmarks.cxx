@@ -0,0 +1,95 @@
+/*=Plus=header=begin======================================================
+  Program: Plus
+  Copyright (c) Laboratory for Percutaneous Surgery. All rights reserved.
+  See License.txt for details.
+=========================================================Plus=header=end*/
+
+/*!
+  \file ScanConversionBenchmarks.cxx
+  \brief Benchmarks of scan converting brightness lines with vtkPlusUsScanConvertLinear and vtkPlusUsScanConvertCurvilinear
+*/
+
+#include "PlusBenchmarkData.h"
+#include "vtkPlusUsScanConvertCurvilinear.h"
+#include "vtkPlusUsScanConvertLinear.h"
+
+// VTK includes
+#include <vtkImageData.h>
+#include <vtkSmartPointer.h>
+#include <vtkXMLDataElement.h>
+
+// Google Benchmark includes
+#include <benchmark/benchmark.h>
+
+namespace
+{
+  const int NUMBER_OF_SAMPLES_PER_LINE = 1024;
+  const int NUMBER_OF_LINES = 128;
+  const int OUTPUT_IMAGE_WIDTH = 640;
+  const int OUTPUT_IMAGE_HEIGHT = 480;
+
+  //----------------------------------------------------------------------------
+  // Scan converter configuration of a typical curvilinear or linear probe
+  vtkSmartPointer<vtkPlusUsScanConvert> CreateScanConverter(bool curvilinear)
+  {
+    vtkSmartPointer<vtkXMLDataElement> scanConversionElement = vtkSmartPointer<vtkXMLDataElement>::New();
+    scanConversionElement->SetName("ScanConversion");
+    scanConversionElement->SetAttribute("OutputImageSizePixel", "640 480");
+    vtkSmartPointer<vtkPlusUsScanConvert> scanConverter;
+    if (curvilinear)
+    {
+      scanConversionElement->SetAttribute("TransducerGeometry", "CURVILINEAR");
+      scanConversionElement->SetAttribute("OutputImageSpacingMmPerPixel", "0.2 0.2");
+      scanConversionElement->SetAttribute("TransducerCenterPixel", "320 -100");
+      scanConversionElement->SetAttribute("RadiusStartMm", "20");
+      scanConversionElement->SetAttribute("RadiusStopMm", "110");
+      scanConversionElement->SetAttribute("ThetaStartDeg", "-30");
+      scanConversionElement->SetAttribute("ThetaStopDeg", "30");
+      scanConverter = vtkSmartPointer<vtkPlusUsScanConvertCurvilinear>::New();
+    }
+    else
+    {
+      scanConversionElement->SetAttribute("TransducerGeometry", "LINEAR");
+      scanConversionElement->SetAttribute("OutputImageSpacingMmPerPixel", "0.1 0.1");
+      scanConversionElement->SetAttribute("TransducerCenterPixel", "320 0");
+      scanConversionElement->SetAttribute("TransducerWidthMm", "38");
+      scanConversionElement->SetAttribute("ImagingDepthMm", "48");
+      scanConverter = vtkSmartPointer<vtkPlusUsScanConvertLinear>::New();
+    }
+    if (scanConverter->ReadConfiguration(scanConversionElement) != PLUS_SUCCESS)
+    {
+      return vtkSmartPointer<vtkPlusUsScanConvert>();
+    }
+    return scanConverter;
+  }
+}
+
+//----------------------------------------------------------------------------
+// Scan convert 128 lines of 1024 samples into a 640x480 image, argument: 1 for curvilinear, 0 for linear transducer geometry
+static void BM_ScanConvert(benchmark::State& state)
+{
+  const bool curvilinear = (state.range(0) != 0);
+  vtkSmartPointer<vtkPlusUsScanConvert> scanConverter = CreateScanConverter(curvilinear);
+  if (scanConverter.GetPointer() == NULL)
+  {
+    state.SkipWithError("Failed to configure scan converter");
+    return;
+  }
+  state.SetLabel(scanConverter->GetTransducerGeometry());
+
+  vtkSmartPointer<vtkImageData> scanLines = vtkSmartPointer<vtkImageData>::New();
+  PlusBenchmarkData::CreateImage(scanLines, NUMBER_OF_SAMPLES_PER_LINE, NUMBER_OF_LINES);
+  scanConverter->SetInputData(scanLines);
+  scanConverter->SetInputImageExtent(scanLines->GetExtent());
+
+  for (auto _ : state)
+  {
+    // Force execution, as it would happen for each new frame
+    scanLines->Modified();
+    scanConverter->Update();
+    benchmark::DoNotOptimize(scanConverter->GetOutput()->GetScalarPointer());
+  }
+  state.SetItemsProcessed(state.iterations());
+  state.SetBytesProcessed(state.iterations() * OUTPUT_IMAGE_WIDTH * OUTPUT_IMAGE_HEIGHT);
+}
+BENCHMARK(BM_ScanConvert)->Arg(0)->Arg(1);
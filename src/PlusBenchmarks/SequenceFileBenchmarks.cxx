@@ -0,0 +1,112 @@
+/*=Plus=header=begin======================================================
+  Program: Plus
+  Copyright (c) Laboratory for Percutaneous Surgery. All rights reserved.
+  See License.txt for details.
+=========================================================Plus=header=end*/
+
+/*!
+  \file SequenceFileBenchmarks.cxx
+  \brief Benchmarks of writing and reading sequence files
+
+  The sequence files are written to the output directory of the Plus configuration.
+*/
+
+#include "PlusBenchmarkData.h"
+#include "vtkPlusConfig.h"
+#include "vtkPlusSequenceIO.h"
+#include "vtkPlusTrackedFrameList.h"
+
+// VTK includes
+#include <vtkSmartPointer.h>
+
+// Google Benchmark includes
+#include <benchmark/benchmark.h>
+
+namespace
+{
+  const int NUMBER_OF_FRAMES = 50;
+  const int FRAME_WIDTH = 640;
+  const int FRAME_HEIGHT = 480;
+
+  /*! Sequence file formats, the benchmark argument is the index in this list */
+  struct SequenceFileFormat
+  {
+    const char* Extension;
+    bool UseCompression;
+    const char* Label;
+  };
+  const SequenceFileFormat SEQUENCE_FILE_FORMATS[] =
+  {
+    { ".mha", false, "mha" },
+    { ".mha", true, "mha compressed" },
+    { ".nrrd", false, "nrrd" },
+    { ".nrrd", true, "nrrd compressed" }
+  };
+
+  //----------------------------------------------------------------------------
+  std::string GetSequenceFilePath(const SequenceFileFormat& format)
+  {
+    std::string filename = std::string("PlusBenchmarkSequence") + (format.UseCompression ? "Compressed" : "") + format.Extension;
+    return vtkPlusConfig::GetInstance()->GetOutputPath(filename);
+  }
+}
+
+//----------------------------------------------------------------------------
+// Write a sequence of 640x480 frames to a file, in the format given as argument
+static void BM_SequenceFileWrite(benchmark::State& state)
+{
+  const SequenceFileFormat& format = SEQUENCE_FILE_FORMATS[state.range(0)];
+  state.SetLabel(format.Label);
+  vtkSmartPointer<vtkPlusTrackedFrameList> trackedFrameList = vtkSmartPointer<vtkPlusTrackedFrameList>::New();
+  if (PlusBenchmarkData::CreateTrackedFrameList(trackedFrameList, NUMBER_OF_FRAMES, FRAME_WIDTH, FRAME_HEIGHT) != PLUS_SUCCESS)
+  {
+    state.SkipWithError("Failed to create tracked frame list");
+    return;
+  }
+
+  std::string filePath = GetSequenceFilePath(format);
+  for (auto _ : state)
+  {
+    if (vtkPlusSequenceIO::Write(filePath, trackedFrameList, US_IMG_ORIENT_MF, format.UseCompression) != PLUS_SUCCESS)
+    {
+      state.SkipWithError("Failed to write sequence file");
+      break;
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * NUMBER_OF_FRAMES);
+  state.SetBytesProcessed(state.iterations() * NUMBER_OF_FRAMES * FRAME_WIDTH * FRAME_HEIGHT);
+}
+BENCHMARK(BM_SequenceFileWrite)->DenseRange(0, 3)->Unit(benchmark::kMillisecond);
+
+//----------------------------------------------------------------------------
+// Read a sequence of 640x480 frames from a file, in the format given as argument
+static void BM_SequenceFileRead(benchmark::State& state)
+{
+  const SequenceFileFormat& format = SEQUENCE_FILE_FORMATS[state.range(0)];
+  state.SetLabel(format.Label);
+  vtkSmartPointer<vtkPlusTrackedFrameList> trackedFrameList = vtkSmartPointer<vtkPlusTrackedFrameList>::New();
+  if (PlusBenchmarkData::CreateTrackedFrameList(trackedFrameList, NUMBER_OF_FRAMES, FRAME_WIDTH, FRAME_HEIGHT) != PLUS_SUCCESS)
+  {
+    state.SkipWithError("Failed to create tracked frame list");
+    return;
+  }
+  std::string filePath = GetSequenceFilePath(format);
+  if (vtkPlusSequenceIO::Write(filePath, trackedFrameList, US_IMG_ORIENT_MF, format.UseCompression) != PLUS_SUCCESS)
+  {
+    state.SkipWithError("Failed to write sequence file");
+    return;
+  }
+
+  for (auto _ : state)
+  {
+    trackedFrameList->Clear();
+    if (vtkPlusSequenceIO::Read(filePath, trackedFrameList) != PLUS_SUCCESS)
+    {
+      state.SkipWithError("Failed to read sequence file");
+      break;
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * NUMBER_OF_FRAMES);
+  state.SetBytesProcessed(state.iterations() * NUMBER_OF_FRAMES * FRAME_WIDTH * FRAME_HEIGHT);
+}
+BENCHMARK(BM_SequenceFileRead)->DenseRange(0, 3)->Unit(benchmark::kMillisecond);
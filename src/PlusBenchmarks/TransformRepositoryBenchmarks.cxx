@@ -0,0 +1,120 @@
+/*=Plus=header=begin======================================================
+  Program: Plus
+  Copyright (c) Laboratory for Percutaneous Surgery. All rights reserved.
+  See License.txt for details.
+=========================================================Plus=header=end*/
+
+/*!
+  \file TransformRepositoryBenchmarks.cxx
+  \brief Benchmarks of computing transforms in vtkPlusTransformRepository
+*/
+
+#include "PlusBenchmarkData.h"
+#include "vtkPlusTransformRepository.h"
+
+// VTK includes
+#include <vtkMatrix4x4.h>
+#include <vtkSmartPointer.h>
+
+// Google Benchmark includes
+#include <benchmark/benchmark.h>
+
+namespace
+{
+  //----------------------------------------------------------------------------
+  // Transform graph of a typical tracked ultrasound setup with a calibrated stylus
+  PlusStatus SetUpRepository(vtkPlusTransformRepository* repository)
+  {
+    PlusTrackedFrame trackedFrame;
+    if (PlusBenchmarkData::CreateTrackedFrame(trackedFrame, 1, 1, 1) != PLUS_SUCCESS)
+    {
+      return PLUS_FAIL;
+    }
+    if (repository->SetTransforms(trackedFrame) != PLUS_SUCCESS)
+    {
+      return PLUS_FAIL;
+    }
+    vtkSmartPointer<vtkMatrix4x4> matrix = vtkSmartPointer<vtkMatrix4x4>::New();
+    PlusBenchmarkData::GetSweepTransform(2, matrix);
+    if (repository->SetTransform(PlusTransformName("Stylus", "Tracker"), matrix) != PLUS_SUCCESS)
+    {
+      return PLUS_FAIL;
+    }
+    matrix->Identity();
+    matrix->SetElement(2, 3, 210.0);
+    return repository->SetTransform(PlusTransformName("StylusTip", "Stylus"), matrix);
+  }
+}
+
+//----------------------------------------------------------------------------
+// Get a transform that is computed from the number of stored transforms given as argument (1, 3, or 4)
+static void BM_TransformRepositoryGetTransform(benchmark::State& state)
+{
+  vtkSmartPointer<vtkPlusTransformRepository> repository = vtkSmartPointer<vtkPlusTransformRepository>::New();
+  if (SetUpRepository(repository) != PLUS_SUCCESS)
+  {
+    state.SkipWithError("Failed to set up the transform repository");
+    return;
+  }
+
+  PlusTransformName transformName;
+  switch (state.range(0))
+  {
+    case 1:
+      transformName = PlusTransformName("Probe", "Tracker");
+      break;
+    case 3:
+      transformName = PlusTransformName("Image", "Reference");
+      break;
+    default:
+      transformName = PlusTransformName("StylusTip", "Image");
+      break;
+  }
+  state.SetLabel(transformName.GetTransformName());
+
+  vtkSmartPointer<vtkMatrix4x4> matrix = vtkSmartPointer<vtkMatrix4x4>::New();
+  bool isValid = false;
+  for (auto _ : state)
+  {
+    if (repository->GetTransform(transformName, matrix, &isValid) != PLUS_SUCCESS)
+    {
+      state.SkipWithError("Failed to get transform from the repository");
+      break;
+    }
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_TransformRepositoryGetTransform)->Arg(1)->Arg(3)->Arg(4);
+
+//----------------------------------------------------------------------------
+// Update the repository from a tracked frame and get a transform, as done for each frame that is broadcast
+static void BM_TransformRepositorySetTransformsAndGetTransform(benchmark::State& state)
+{
+  vtkSmartPointer<vtkPlusTransformRepository> repository = vtkSmartPointer<vtkPlusTransformRepository>::New();
+  if (SetUpRepository(repository) != PLUS_SUCCESS)
+  {
+    state.SkipWithError("Failed to set up the transform repository");
+    return;
+  }
+  PlusTrackedFrame trackedFrame;
+  if (PlusBenchmarkData::CreateTrackedFrame(trackedFrame, 1, 1, 3) != PLUS_SUCCESS)
+  {
+    state.SkipWithError("Failed to create tracked frame");
+    return;
+  }
+
+  PlusTransformName imageToReferenceName("Image", "Reference");
+  vtkSmartPointer<vtkMatrix4x4> matrix = vtkSmartPointer<vtkMatrix4x4>::New();
+  bool isValid = false;
+  for (auto _ : state)
+  {
+    if (repository->SetTransforms(trackedFrame) != PLUS_SUCCESS
+        || repository->GetTransform(imageToReferenceName, matrix, &isValid) != PLUS_SUCCESS)
+    {
+      state.SkipWithError("Failed to update the transform repository");
+      break;
+    }
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_TransformRepositorySetTransformsAndGetTransform);
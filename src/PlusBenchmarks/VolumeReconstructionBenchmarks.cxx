@@ -0,0 +1,126 @@
+/*=Plus=header=begin======================================================
+  Program: Plus
+  Copyright (c) Laboratory for Percutaneous Surgery. All rights reserved.
+  See License.txt for details.
+=========================================================Plus=header=end*/
+
+/*!
+  \file VolumeReconstructionBenchmarks.cxx
+  \brief Benchmarks of inserting slices into a volume with vtkPlusPasteSliceIntoVolume
+*/
+
+#include "PlusBenchmarkData.h"
+#include "vtkPlusPasteSliceIntoVolume.h"
+
+// VTK includes
+#include <vtkImageData.h>
+#include <vtkMatrix4x4.h>
+#include <vtkSmartPointer.h>
+
+// Google Benchmark includes
+#include <benchmark/benchmark.h>
+
+// STL includes
+#include <vector>
+
+namespace
+{
+  const int SLICE_SIZE = 128;
+  const int VOLUME_SIZE = 128;
+
+  //----------------------------------------------------------------------------
+  PlusStatus SetUpPaster(vtkPlusPasteSliceIntoVolume* paster, vtkPlusPasteSliceIntoVolume::InterpolationType interpolation, int numberOfThreads)
+  {
+    int outputExtent[6] = { 0, VOLUME_SIZE - 1, 0, VOLUME_SIZE - 1, 0, VOLUME_SIZE - 1 };
+    paster->SetOutputExtent(outputExtent);
+    paster->SetInterpolationMode(interpolation);
+    paster->SetCompoundingMode(vtkPlusPasteSliceIntoVolume::MEAN_COMPOUNDING_MODE);
+    paster->SetOptimization(vtkPlusPasteSliceIntoVolume::FULL_OPTIMIZATION);
+    paster->SetNumberOfThreads(numberOfThreads);
+    return paster->ResetOutput();
+  }
+}
+
+//----------------------------------------------------------------------------
+// Insert 128x128 slices into a 128^3 volume one by one, arguments: interpolation type and number of threads (0 = default)
+static void BM_PasteSliceIntoVolumeInsertSlice(benchmark::State& state)
+{
+  vtkPlusPasteSliceIntoVolume::InterpolationType interpolation = static_cast<vtkPlusPasteSliceIntoVolume::InterpolationType>(state.range(0));
+  vtkSmartPointer<vtkPlusPasteSliceIntoVolume> paster = vtkSmartPointer<vtkPlusPasteSliceIntoVolume>::New();
+  if (SetUpPaster(paster, interpolation, static_cast<int>(state.range(1))) != PLUS_SUCCESS)
+  {
+    state.SkipWithError("Failed to reset output volume");
+    return;
+  }
+  state.SetLabel(interpolation == vtkPlusPasteSliceIntoVolume::LINEAR_INTERPOLATION ? "linear" : "nearest neighbor");
+
+  vtkSmartPointer<vtkImageData> slice = vtkSmartPointer<vtkImageData>::New();
+  PlusBenchmarkData::CreateImage(slice, SLICE_SIZE, SLICE_SIZE);
+  std::vector<vtkSmartPointer<vtkMatrix4x4> > sliceToVolumeTransforms;
+  for (int frameIndex = 0; frameIndex < PlusBenchmarkData::SWEEP_LENGTH; ++frameIndex)
+  {
+    sliceToVolumeTransforms.push_back(vtkSmartPointer<vtkMatrix4x4>::New());
+    PlusBenchmarkData::GetSweepTransform(frameIndex, sliceToVolumeTransforms.back());
+  }
+
+  int frameIndex = 0;
+  for (auto _ : state)
+  {
+    if (paster->InsertSlice(slice, sliceToVolumeTransforms[frameIndex % PlusBenchmarkData::SWEEP_LENGTH]) != PLUS_SUCCESS)
+    {
+      state.SkipWithError("Failed to insert slice");
+      break;
+    }
+    ++frameIndex;
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_PasteSliceIntoVolumeInsertSlice)
+->Args({vtkPlusPasteSliceIntoVolume::NEAREST_NEIGHBOR_INTERPOLATION, 1})
+->Args({vtkPlusPasteSliceIntoVolume::LINEAR_INTERPOLATION, 1})
+->Args({vtkPlusPasteSliceIntoVolume::NEAREST_NEIGHBOR_INTERPOLATION, 0})
+->Args({vtkPlusPasteSliceIntoVolume::LINEAR_INTERPOLATION, 0});
+
+//----------------------------------------------------------------------------
+// Reconstruct a volume from a full sweep of 128x128 slices (offline reconstruction), argument: number of threads (0 = default)
+static void BM_PasteSliceIntoVolumeReconstructSweep(benchmark::State& state)
+{
+  vtkSmartPointer<vtkPlusPasteSliceIntoVolume> paster = vtkSmartPointer<vtkPlusPasteSliceIntoVolume>::New();
+  if (SetUpPaster(paster, vtkPlusPasteSliceIntoVolume::LINEAR_INTERPOLATION, static_cast<int>(state.range(0))) != PLUS_SUCCESS)
+  {
+    state.SkipWithError("Failed to reset output volume");
+    return;
+  }
+
+  std::vector<vtkSmartPointer<vtkImageData> > images;
+  std::vector<vtkSmartPointer<vtkMatrix4x4> > sliceToVolumeTransforms;
+  std::vector<vtkPlusPasteSliceIntoVolume::SliceToInsert> slices;
+  for (int frameIndex = 0; frameIndex < PlusBenchmarkData::SWEEP_LENGTH; ++frameIndex)
+  {
+    images.push_back(vtkSmartPointer<vtkImageData>::New());
+    PlusBenchmarkData::CreateImage(images.back(), SLICE_SIZE, SLICE_SIZE, frameIndex);
+    sliceToVolumeTransforms.push_back(vtkSmartPointer<vtkMatrix4x4>::New());
+    PlusBenchmarkData::GetSweepTransform(frameIndex, sliceToVolumeTransforms.back());
+
+    vtkPlusPasteSliceIntoVolume::SliceToInsert slice;
+    slice.Image = images.back();
+    slice.ImageToReference = sliceToVolumeTransforms.back();
+    slice.FanAnglesDeg[0] = 0.0;
+    slice.FanAnglesDeg[1] = 0.0;
+    slices.push_back(slice);
+  }
+
+  for (auto _ : state)
+  {
+    state.PauseTiming();
+    paster->ResetOutput();
+    state.ResumeTiming();
+    if (paster->InsertSlices(slices) != PLUS_SUCCESS)
+    {
+      state.SkipWithError("Failed to insert slices");
+      break;
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * PlusBenchmarkData::SWEEP_LENGTH);
+}
+BENCHMARK(BM_PasteSliceIntoVolumeReconstructSweep)->Arg(1)->Arg(0)->Unit(benchmark::kMillisecond);
@@ -0,0 +1,177 @@
+/*=Plus=header=begin======================================================
+Program: Plus
+Copyright (c) Laboratory for Percutaneous Surgery. All rights reserved.
+See License.txt for details.
+=========================================================Plus=header=end*/
+
+/*!
+  \file vtkPlusTemporalCalibrationAlgoTest.cxx
+  \brief Compares the FFT-based normalized cross-correlation of vtkPlusTemporalCalibrationAlgo with a brute-force computation on small signals
+*/
+
+// Local includes
+#include "PlusConfigure.h"
+#include "vtkPlusTemporalCalibrationAlgo.h"
+
+// VTK includes
+#include <vtksys/CommandLineArguments.hxx>
+
+// STL includes
+#include <cmath>
+#include <deque>
+
+namespace
+{
+  const double MAX_CORRELATION_DIFFERENCE = 1e-9;
+
+  //----------------------------------------------------------------------------
+  // Deterministic test signal: sum of two sinusoids and a pseudo-random component
+  double GetSignalValue(int sampleIndex)
+  {
+    return 3.0 * sin(0.31 * sampleIndex) + 1.2 * cos(0.77 * sampleIndex + 0.4) + 0.5 * ((sampleIndex * 7919) % 23) / 23.0 + 10.0;
+  }
+
+  //----------------------------------------------------------------------------
+  // Brute-force normalized cross-correlation, by the definition: the fixed signal is normalized once,
+  // the moving signal is normalized separately in each window that the fixed signal overlaps
+  void ComputeNormalizedCrossCorrelationBruteForce(const std::deque<double>& fixedValues, const std::deque<double>& movingValues, std::deque<double>& corrValues, std::deque<double>& normalizationFactors)
+  {
+    corrValues.clear();
+    normalizationFactors.clear();
+    const int numberOfFixedSamples = static_cast<int>(fixedValues.size());
+    const int numberOfOffsets = static_cast<int>(movingValues.size()) - numberOfFixedSamples + 1;
+    for (int offsetIndex = 0; offsetIndex < numberOfOffsets; ++offsetIndex)
+    {
+      double mean = 0;
+      for (int i = 0; i < numberOfFixedSamples; ++i)
+      {
+        mean += movingValues[offsetIndex + i];
+      }
+      mean /= numberOfFixedSamples;
+      double sumOfSquaredDifferences = 0;
+      for (int i = 0; i < numberOfFixedSamples; ++i)
+      {
+        sumOfSquaredDifferences += (movingValues[offsetIndex + i] - mean) * (movingValues[offsetIndex + i] - mean);
+      }
+      double normalizationFactor = 1.0 / std::sqrt(sumOfSquaredDifferences / (numberOfFixedSamples - 1));
+      double correlation = 0;
+      for (int i = 0; i < numberOfFixedSamples; ++i)
+      {
+        correlation += fixedValues[i] * (movingValues[offsetIndex + i] - mean) * normalizationFactor;
+      }
+      corrValues.push_back(correlation);
+      normalizationFactors.push_back(normalizationFactor);
+    }
+  }
+
+  //----------------------------------------------------------------------------
+  // The moving signal contains the fixed signal starting at fixedSignalOffset, so the correlation must be the highest at that offset
+  PlusStatus TestCorrelation(int numberOfFixedSamples, int numberOfMovingSamples, int fixedSignalOffset)
+  {
+    std::deque<double> movingValues(numberOfMovingSamples);
+    for (int i = 0; i < numberOfMovingSamples; ++i)
+    {
+      movingValues[i] = GetSignalValue(i);
+    }
+
+    std::deque<double> fixedValues(numberOfFixedSamples);
+    double fixedMean = 0;
+    for (int i = 0; i < numberOfFixedSamples; ++i)
+    {
+      fixedValues[i] = movingValues[fixedSignalOffset + i];
+      fixedMean += fixedValues[i];
+    }
+    fixedMean /= numberOfFixedSamples;
+    for (int i = 0; i < numberOfFixedSamples; ++i)
+    {
+      fixedValues[i] -= fixedMean;
+    }
+
+    std::deque<double> fftCorrValues;
+    std::deque<double> fftNormalizationFactors;
+    if (vtkPlusTemporalCalibrationAlgo::ComputeNormalizedCrossCorrelationUsingFft(fixedValues, movingValues, fftCorrValues, fftNormalizationFactors) != PLUS_SUCCESS)
+    {
+      LOG_ERROR("FFT correlation failed (fixed samples: " << numberOfFixedSamples << ", moving samples: " << numberOfMovingSamples << ")");
+      return PLUS_FAIL;
+    }
+    std::deque<double> bruteForceCorrValues;
+    std::deque<double> bruteForceNormalizationFactors;
+    ComputeNormalizedCrossCorrelationBruteForce(fixedValues, movingValues, bruteForceCorrValues, bruteForceNormalizationFactors);
+
+    if (fftCorrValues.size() != bruteForceCorrValues.size() || fftNormalizationFactors.size() != bruteForceNormalizationFactors.size())
+    {
+      LOG_ERROR("Number of correlation values mismatch: " << fftCorrValues.size() << " (FFT) != " << bruteForceCorrValues.size() << " (brute force)");
+      return PLUS_FAIL;
+    }
+
+    int bestOffset = 0;
+    for (unsigned int offsetIndex = 0; offsetIndex < fftCorrValues.size(); ++offsetIndex)
+    {
+      if (fabs(fftCorrValues[offsetIndex] - bruteForceCorrValues[offsetIndex]) > MAX_CORRELATION_DIFFERENCE
+          || fabs(fftNormalizationFactors[offsetIndex] - bruteForceNormalizationFactors[offsetIndex]) > MAX_CORRELATION_DIFFERENCE)
+      {
+        LOG_ERROR("Correlation mismatch at offset " << offsetIndex << " (fixed samples: " << numberOfFixedSamples << ", moving samples: " << numberOfMovingSamples << "): "
+                  << fftCorrValues[offsetIndex] << " (FFT) != " << bruteForceCorrValues[offsetIndex] << " (brute force), normalization factor "
+                  << fftNormalizationFactors[offsetIndex] << " (FFT) != " << bruteForceNormalizationFactors[offsetIndex] << " (brute force)");
+        return PLUS_FAIL;
+      }
+      if (fftCorrValues[offsetIndex] > fftCorrValues[bestOffset])
+      {
+        bestOffset = offsetIndex;
+      }
+    }
+
+    if (bestOffset != fixedSignalOffset)
+    {
+      LOG_ERROR("Best correlation is at offset " << bestOffset << ", expected at " << fixedSignalOffset
+                << " (fixed samples: " << numberOfFixedSamples << ", moving samples: " << numberOfMovingSamples << ")");
+      return PLUS_FAIL;
+    }
+
+    LOG_INFO("FFT correlation matches brute-force correlation (fixed samples: " << numberOfFixedSamples << ", moving samples: " << numberOfMovingSamples << ")");
+    return PLUS_SUCCESS;
+  }
+}
+
+//----------------------------------------------------------------------------
+int main(int argc, char** argv)
+{
+  bool printHelp(false);
+  int verboseLevel = vtkPlusLogger::LOG_LEVEL_UNDEFINED;
+
+  vtksys::CommandLineArguments args;
+  args.Initialize(argc, argv);
+
+  args.AddArgument("--help", vtksys::CommandLineArguments::NO_ARGUMENT, &printHelp, "Print this help.");
+  args.AddArgument("--verbose", vtksys::CommandLineArguments::EQUAL_ARGUMENT, &verboseLevel, "Verbose level (1=error only, 2=warning, 3=info, 4=debug, 5=trace)");
+
+  if (!args.Parse())
+  {
+    std::cerr << "Problem parsing arguments" << std::endl;
+    std::cout << "Help: " << args.GetHelp() << std::endl;
+    exit(EXIT_FAILURE);
+  }
+
+  if (printHelp)
+  {
+    std::cout << args.GetHelp() << std::endl;
+    exit(EXIT_SUCCESS);
+  }
+
+  vtkPlusLogger::Instance()->SetLogLevel(verboseLevel);
+
+  int numberOfFailures(0);
+  // Single offset, power of 2 and odd sizes
+  if (TestCorrelation(16, 16, 0) != PLUS_SUCCESS) { numberOfFailures++; }
+  if (TestCorrelation(16, 32, 9) != PLUS_SUCCESS) { numberOfFailures++; }
+  if (TestCorrelation(21, 38, 13) != PLUS_SUCCESS) { numberOfFailures++; }
+  if (TestCorrelation(37, 101, 50) != PLUS_SUCCESS) { numberOfFailures++; }
+
+  if (numberOfFailures > 0)
+  {
+    LOG_ERROR("Number of failures: " << numberOfFailures);
+    return EXIT_FAILURE;
+  }
+  LOG_INFO("Test completed successfully!");
+  return EXIT_SUCCESS;
+}
@@ -193,6 +193,7 @@ int main(int argc, char** argv)
   std::vector<int> clipRectOrigin;
   std::vector<int> clipRectSize;
   std::string inputBaselineFileName;
+  std::string signalAlignmentMetric("SSD");
 
   vtksys::CommandLineArguments args;
   args.Initialize(argc, argv);
@@ -211,6 +212,7 @@ int main(int argc, char** argv)
   args.AddArgument("--clip-rect-origin", vtksys::CommandLineArguments::MULTI_ARGUMENT, &clipRectOrigin, "Origin of the clipping rectangle");
   args.AddArgument("--clip-rect-size", vtksys::CommandLineArguments::MULTI_ARGUMENT, &clipRectSize, "Size of the clipping rectangle");
   args.AddArgument("--baseline-file", vtksys::CommandLineArguments::EQUAL_ARGUMENT, &inputBaselineFileName, "Input xml baseline file name with path");
+  args.AddArgument("--signal-alignment-metric", vtksys::CommandLineArguments::EQUAL_ARGUMENT, &signalAlignmentMetric, "Metric used for aligning the signals: SSD (default), CORRELATION (FFT-based, fast), or SAD");
 
   if (!args.Parse())
   {
@@ -306,6 +308,23 @@ int main(int argc, char** argv)
   testTemporalCalibrationObject->SetSaveIntermediateImages(saveIntermediateImages);
   testTemporalCalibrationObject->SetIntermediateFilesOutputDirectory(intermediateFileOutputDirectory);
   testTemporalCalibrationObject->SetMaximumMovingLagSec(maxTimeOffsetSec);
+  if (PlusCommon::IsEqualInsensitive(signalAlignmentMetric, "SSD"))
+  {
+    testTemporalCalibrationObject->SetSignalAlignmentMetric(vtkPlusTemporalCalibrationAlgo::SIGNAL_ALIGNMENT_METRIC_SSD);
+  }
+  else if (PlusCommon::IsEqualInsensitive(signalAlignmentMetric, "CORRELATION"))
+  {
+    testTemporalCalibrationObject->SetSignalAlignmentMetric(vtkPlusTemporalCalibrationAlgo::SIGNAL_ALIGNMENT_METRIC_CORRELATION);
+  }
+  else if (PlusCommon::IsEqualInsensitive(signalAlignmentMetric, "SAD"))
+  {
+    testTemporalCalibrationObject->SetSignalAlignmentMetric(vtkPlusTemporalCalibrationAlgo::SIGNAL_ALIGNMENT_METRIC_SAD);
+  }
+  else
+  {
+    LOG_ERROR("Invalid signal alignment metric: " << signalAlignmentMetric << ". Expected SSD, CORRELATION, or SAD.");
+    exit(EXIT_FAILURE);
+  }
 
   if (clipRectOrigin.size() > 0 || clipRectSize.size() > 0)
   {
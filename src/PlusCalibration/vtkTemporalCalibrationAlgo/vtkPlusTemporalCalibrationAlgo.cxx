@@ -16,8 +16,10 @@
 #include "vtkPlusTemporalCalibrationAlgo.h"
 #include "vtkPlusTrackedFrameList.h"
 #include <algorithm>
+#include <complex>
 #include <fstream>
 #include <iostream>
+#include <vector>
 
 //-----------------------------------------------------------------------------
 
@@ -38,20 +40,12 @@ namespace
   const double DEFAULT_SAMPLING_RESOLUTION_SEC = 0.001;
   const double DEFAULT_MAX_MOVING_LAG_SEC = 0.5;
 
-  enum SignalAlignmentMetricType
-  {
-    SSD,
-    CORRELATION,
-    SAD,
-    SIGNAL_METRIC_TYPE_COUNT
-  };
-  const double SIGNAL_ALIGNMENT_METRIC_THRESHOLD[SIGNAL_METRIC_TYPE_COUNT] =
+  const double SIGNAL_ALIGNMENT_METRIC_THRESHOLD[vtkPlusTemporalCalibrationAlgo::SIGNAL_ALIGNMENT_METRIC_TYPE_COUNT] =
   {
     -2 ^ 500,
     -2 ^ 500,
     2 ^ 500
   };
-  SignalAlignmentMetricType SIGNAL_ALIGNMENT_METRIC = SSD;
 
   enum MetricNormalizationType
   {
@@ -59,6 +53,47 @@ namespace
     AMPLITUDE
   };
   MetricNormalizationType METRIC_NORMALIZATION = STD;
+
+  //-----------------------------------------------------------------------------
+  // In-place radix-2 FFT, the size of the data must be a power of 2. The inverse transform is not scaled.
+  void ComputeFft(std::vector< std::complex<double> >& data, bool inverse)
+  {
+    const size_t n = data.size();
+    for (size_t i = 1, j = 0; i < n; ++i)
+    {
+      size_t bit = n >> 1;
+      for (; j & bit; bit >>= 1)
+      {
+        j ^= bit;
+      }
+      j ^= bit;
+      if (i < j)
+      {
+        std::swap(data[i], data[j]);
+      }
+    }
+    std::vector< std::complex<double> > twiddleFactors;
+    for (size_t length = 2; length <= n; length <<= 1)
+    {
+      const size_t halfLength = length / 2;
+      const double angle = (inverse ? 2.0 : -2.0) * vtkMath::Pi() / length;
+      twiddleFactors.resize(halfLength);
+      for (size_t k = 0; k < halfLength; ++k)
+      {
+        twiddleFactors[k] = std::polar(1.0, angle * k);
+      }
+      for (size_t start = 0; start < n; start += length)
+      {
+        for (size_t k = 0; k < halfLength; ++k)
+        {
+          std::complex<double> even = data[start + k];
+          std::complex<double> odd = data[start + k + halfLength] * twiddleFactors[k];
+          data[start + k] = even + odd;
+          data[start + k + halfLength] = even - odd;
+        }
+      }
+    }
+  }
 }
 
 //-----------------------------------------------------------------------------
@@ -68,6 +103,7 @@ vtkPlusTemporalCalibrationAlgo::vtkPlusTemporalCalibrationAlgo()
   , SaveIntermediateImages(false)
   , IntermediateFilesOutputDirectory(vtkPlusConfig::GetInstance()->GetOutputDirectory())
   , SamplingResolutionSec(DEFAULT_SAMPLING_RESOLUTION_SEC)
+  , SignalAlignmentMetric(SIGNAL_ALIGNMENT_METRIC_SSD)
   , BestCorrelationValue(0.0)
   , BestCorrelationLagIndex(-1)
   , BestCorrelationTimeOffset(0.0)
@@ -174,6 +210,12 @@ void vtkPlusTemporalCalibrationAlgo::SetSamplingResolutionSec(double samplingRes
   this->SamplingResolutionSec = samplingResolutionSec;
 }
 
+//-----------------------------------------------------------------------------
+void vtkPlusTemporalCalibrationAlgo::SetSignalAlignmentMetric(SIGNAL_ALIGNMENT_METRIC_TYPE metric)
+{
+  this->SignalAlignmentMetric = metric;
+}
+
 //-----------------------------------------------------------------------------
 void vtkPlusTemporalCalibrationAlgo::SetMaximumMovingLagSec(double maxLagSec)
 {
@@ -467,27 +509,38 @@ void vtkPlusTemporalCalibrationAlgo::ComputeCorrelationBetweenFixedAndMovingSign
     LOG_ERROR("Sampling resolution is too small: " << stepSizeSec << " sec");
     return;
   }
-  std::deque<double> slidingSignalTimestamps(this->FixedSignal.signalTimestamps.size());
-  std::deque<double> resampledTrackerPositionMetric;
   corrValues.clear();
   corrTimeOffsets.clear();
-  for (double offsetValueSec = minTrackerLagSec; offsetValueSec <= maxTrackerLagSec; offsetValueSec += stepSizeSec)
+  if (this->SignalAlignmentMetric == SIGNAL_ALIGNMENT_METRIC_CORRELATION)
   {
-    //LOG_DEBUG("offsetValueSec = " << offsetValueSec);
-    corrTimeOffsets.push_back(offsetValueSec);
-    for (unsigned int i = 0; i < slidingSignalTimestamps.size(); ++i)
+    // Correlation is computed for all offsets at once (the signals are normalized by their standard deviation)
+    if (ComputeCorrelationUsingFft(trackerPositionPiecewiseSignal, minTrackerLagSec, maxTrackerLagSec, stepSizeSec, corrTimeOffsets, corrValues, normalizationFactors) != PLUS_SUCCESS)
     {
-      slidingSignalTimestamps.at(i) =  this->FixedSignal.signalTimestamps.at(i) + offsetValueSec;
+      return;
     }
+  }
+  else
+  {
+    std::deque<double> slidingSignalTimestamps(this->FixedSignal.signalTimestamps.size());
+    std::deque<double> resampledTrackerPositionMetric;
+    for (double offsetValueSec = minTrackerLagSec; offsetValueSec <= maxTrackerLagSec; offsetValueSec += stepSizeSec)
+    {
+      //LOG_DEBUG("offsetValueSec = " << offsetValueSec);
+      corrTimeOffsets.push_back(offsetValueSec);
+      for (unsigned int i = 0; i < slidingSignalTimestamps.size(); ++i)
+      {
+        slidingSignalTimestamps.at(i) =  this->FixedSignal.signalTimestamps.at(i) + offsetValueSec;
+      }
 
-    NormalizeMetricValues(this->FixedSignal.signalValues, this->FixedSignalValuesNormalizationFactor, slidingSignalTimestamps.front(), slidingSignalTimestamps.back(), this->FixedSignal.signalTimestamps);
+      NormalizeMetricValues(this->FixedSignal.signalValues, this->FixedSignalValuesNormalizationFactor, slidingSignalTimestamps.front(), slidingSignalTimestamps.back(), this->FixedSignal.signalTimestamps);
 
-    ResampleSignalLinearly(slidingSignalTimestamps, trackerPositionPiecewiseSignal, resampledTrackerPositionMetric);
-    double normalizationFactor = 1.0;
-    NormalizeMetricValues(resampledTrackerPositionMetric, normalizationFactor);
-    normalizationFactors.push_back(normalizationFactor);
+      ResampleSignalLinearly(slidingSignalTimestamps, trackerPositionPiecewiseSignal, resampledTrackerPositionMetric);
+      double normalizationFactor = 1.0;
+      NormalizeMetricValues(resampledTrackerPositionMetric, normalizationFactor);
+      normalizationFactors.push_back(normalizationFactor);
 
-    corrValues.push_back(ComputeAlignmentMetric(this->FixedSignal.signalValues, resampledTrackerPositionMetric));
+      corrValues.push_back(ComputeAlignmentMetric(this->FixedSignal.signalValues, resampledTrackerPositionMetric));
+    }
   }
 
   // Find the time offset that has the best alignment metric value
@@ -509,6 +562,140 @@ void vtkPlusTemporalCalibrationAlgo::ComputeCorrelationBetweenFixedAndMovingSign
   LOG_DEBUG("numberOfSamples=" << corrValues.size());
 }
 
+//-----------------------------------------------------------------------------
+PlusStatus vtkPlusTemporalCalibrationAlgo::ComputeCorrelationUsingFft(const vtkSmartPointer<vtkPiecewiseFunction>& movingSignalFunction, double minTrackerLagSec, double maxTrackerLagSec, double stepSizeSec, std::deque<double>& corrTimeOffsets, std::deque<double>& corrValues, std::deque<double>& normalizationFactors)
+{
+  const std::deque<double>& fixedTimestamps = this->FixedSignal.signalTimestamps;
+  if (fixedTimestamps.size() < 2 || maxTrackerLagSec < minTrackerLagSec)
+  {
+    LOG_ERROR("Cannot compute correlation: not enough fixed signal samples or empty time offset range");
+    return PLUS_FAIL;
+  }
+
+  // The fixed signal is normalized once, in the whole range (it is used for computing calibration errors later)
+  NormalizeMetricValues(this->FixedSignal.signalValues, this->FixedSignalValuesNormalizationFactor);
+
+  // Resample the fixed signal uniformly
+  vtkSmartPointer<vtkPiecewiseFunction> fixedSignalFunction = vtkSmartPointer<vtkPiecewiseFunction>::New();
+  for (unsigned int i = 0; i < fixedTimestamps.size(); ++i)
+  {
+    fixedSignalFunction->AddPoint(fixedTimestamps.at(i), this->FixedSignal.signalValues.at(i), 0.5, 0);
+  }
+  const double fixedStartTimeSec = fixedTimestamps.front();
+  const int numberOfFixedSamples = static_cast<int>(floor((fixedTimestamps.back() - fixedStartTimeSec) / stepSizeSec)) + 1;
+  const int numberOfOffsets = static_cast<int>(floor((maxTrackerLagSec - minTrackerLagSec) / stepSizeSec + TIMESTAMP_EPSILON_SEC / stepSizeSec)) + 1;
+  const int numberOfMovingSamples = numberOfFixedSamples + numberOfOffsets - 1;
+  if (numberOfFixedSamples < 2)
+  {
+    LOG_ERROR("Cannot compute correlation: sampling resolution (" << stepSizeSec << " sec) is too coarse for the fixed signal");
+    return PLUS_FAIL;
+  }
+  std::deque<double> fixedValues(numberOfFixedSamples);
+  for (int i = 0; i < numberOfFixedSamples; ++i)
+  {
+    fixedValues[i] = fixedSignalFunction->GetValue(fixedStartTimeSec + i * stepSizeSec);
+  }
+  double fixedNormalizationFactor = 1.0;
+  NormalizeMetricValues(fixedValues, fixedNormalizationFactor);
+
+  // Resample the moving signal uniformly, in the range that all the tested offsets cover
+  std::deque<double> movingValues(numberOfMovingSamples);
+  for (int i = 0; i < numberOfMovingSamples; ++i)
+  {
+    movingValues[i] = movingSignalFunction->GetValue(fixedStartTimeSec + minTrackerLagSec + i * stepSizeSec);
+  }
+
+  if (ComputeNormalizedCrossCorrelationUsingFft(fixedValues, movingValues, corrValues, normalizationFactors) != PLUS_SUCCESS)
+  {
+    return PLUS_FAIL;
+  }
+  for (int offsetIndex = 0; offsetIndex < numberOfOffsets; ++offsetIndex)
+  {
+    corrTimeOffsets.push_back(minTrackerLagSec + offsetIndex * stepSizeSec);
+  }
+
+  return PLUS_SUCCESS;
+}
+
+//-----------------------------------------------------------------------------
+PlusStatus vtkPlusTemporalCalibrationAlgo::ComputeNormalizedCrossCorrelationUsingFft(const std::deque<double>& fixedValues, const std::deque<double>& movingValues, std::deque<double>& corrValues, std::deque<double>& normalizationFactors)
+{
+  corrValues.clear();
+  normalizationFactors.clear();
+  const int numberOfFixedSamples = static_cast<int>(fixedValues.size());
+  const int numberOfMovingSamples = static_cast<int>(movingValues.size());
+  if (numberOfFixedSamples < 2 || numberOfMovingSamples < numberOfFixedSamples)
+  {
+    LOG_ERROR("Cannot compute correlation: the fixed signal must have at least 2 samples and the moving signal must not be shorter than the fixed signal");
+    return PLUS_FAIL;
+  }
+  const int numberOfOffsets = numberOfMovingSamples - numberOfFixedSamples + 1;
+
+  // The moving signal mean is removed to reduce round-off errors (it does not change the correlation, as the fixed signal has zero mean).
+  double movingMean = 0;
+  for (int i = 0; i < numberOfMovingSamples; ++i)
+  {
+    movingMean += movingValues[i];
+  }
+  movingMean /= numberOfMovingSamples;
+
+  // correlation[offsetIndex] = sum(fixed[i] * moving[i + offsetIndex]) = IFFT(conj(FFT(fixed)) * FFT(moving))[offsetIndex]
+  size_t fftSize = 1;
+  while (fftSize < static_cast<size_t>(numberOfFixedSamples + numberOfMovingSamples - 1))
+  {
+    fftSize <<= 1;
+  }
+  std::vector< std::complex<double> > fixedSpectrum(fftSize);
+  std::vector< std::complex<double> > movingSpectrum(fftSize);
+  for (int i = 0; i < numberOfFixedSamples; ++i)
+  {
+    fixedSpectrum[i] = fixedValues[i];
+  }
+  for (int i = 0; i < numberOfMovingSamples; ++i)
+  {
+    movingSpectrum[i] = movingValues[i] - movingMean;
+  }
+  ComputeFft(fixedSpectrum, false);
+  ComputeFft(movingSpectrum, false);
+  for (size_t i = 0; i < fftSize; ++i)
+  {
+    movingSpectrum[i] *= std::conj(fixedSpectrum[i]);
+  }
+  ComputeFft(movingSpectrum, true);
+
+  // The moving signal is normalized in each window by its standard deviation (mean does not matter, see above),
+  // which is computed from running sums of the values and squared values.
+  std::vector<double> sumOfValues(numberOfMovingSamples + 1, 0.0);
+  std::vector<double> sumOfSquaredValues(numberOfMovingSamples + 1, 0.0);
+  for (int i = 0; i < numberOfMovingSamples; ++i)
+  {
+    double value = movingValues[i] - movingMean;
+    sumOfValues[i + 1] = sumOfValues[i] + value;
+    sumOfSquaredValues[i + 1] = sumOfSquaredValues[i] + value * value;
+  }
+
+  for (int offsetIndex = 0; offsetIndex < numberOfOffsets; ++offsetIndex)
+  {
+    double windowSum = sumOfValues[offsetIndex + numberOfFixedSamples] - sumOfValues[offsetIndex];
+    double windowSumOfSquares = sumOfSquaredValues[offsetIndex + numberOfFixedSamples] - sumOfSquaredValues[offsetIndex];
+    double stdev = std::sqrt(std::max(windowSumOfSquares - windowSum * windowSum / numberOfFixedSamples, 0.0)) / std::sqrt(numberOfFixedSamples - 1.0);
+    double normalizationFactor = 1.0;
+    if (stdev < 1e-10)
+    {
+      LOG_ERROR("Cannot normalize data, stdev is too small");
+    }
+    else
+    {
+      normalizationFactor = 1.0 / stdev;
+    }
+    corrValues.push_back(movingSpectrum[offsetIndex].real() / fftSize * normalizationFactor);
+    normalizationFactors.push_back(normalizationFactor);
+  }
+
+  return PLUS_SUCCESS;
+}
+
+//-----------------------------------------------------------------------------
 double vtkPlusTemporalCalibrationAlgo::ComputeAlignmentMetric(const std::deque<double>& signalA, const std::deque<double>& signalB)
 {
   if (signalA.size() != signalB.size())
@@ -516,9 +703,9 @@ double vtkPlusTemporalCalibrationAlgo::ComputeAlignmentMetric(const std::deque<d
     LOG_ERROR("Cannot compute alignment metric: input signals size mismatch");
     return 0;
   }
-  switch (SIGNAL_ALIGNMENT_METRIC)
+  switch (this->SignalAlignmentMetric)
   {
-  case SSD:
+  case SIGNAL_ALIGNMENT_METRIC_SSD:
   {
     // Use sum of squared differences as signal alignment metric
     double ssdSum = 0;
@@ -529,17 +716,7 @@ double vtkPlusTemporalCalibrationAlgo::ComputeAlignmentMetric(const std::deque<d
     }
     return ssdSum;
   }
-  case CORRELATION:
-  {
-    // Use correlation as signal alignment metric
-    double xCorrSum = 0;
-    for (unsigned int i = 0; i < signalA.size(); ++i)
-    {
-      xCorrSum += signalA.at(i) * signalB.at(i);     // XCORR
-    }
-    return xCorrSum;
-  }
-  case SAD:
+  case SIGNAL_ALIGNMENT_METRIC_SAD:
   {
     // Use sum of absolute differences as signal alignment metric
     double sadSum = 0;
@@ -550,7 +727,7 @@ double vtkPlusTemporalCalibrationAlgo::ComputeAlignmentMetric(const std::deque<d
     return sadSum;
   }
   default:
-    LOG_ERROR("Unknown metric: " << SIGNAL_ALIGNMENT_METRIC);
+    LOG_ERROR("Unknown metric: " << this->SignalAlignmentMetric);
   }
   return 0;
 }
@@ -793,8 +970,6 @@ PlusStatus vtkPlusTemporalCalibrationAlgo::ComputeMovingSignalLagSec(TEMPORAL_CA
   double unusedNormFactor = 1.0;
   NormalizeMetricValues(this->MovingSignal.normalizedSignalValues, unusedNormFactor);
 
-  this->CalibrationError = sqrt(-this->BestCorrelationValue) / this->BestCorrelationNormalizationFactor;   // RMSE in mm
-
   LOG_DEBUG("Moving signal lags fixed signal by: " << this->MovingLagSec << " [s]");
 
 
@@ -828,6 +1003,21 @@ PlusStatus vtkPlusTemporalCalibrationAlgo::ComputeMovingSignalLagSec(TEMPORAL_CA
     this->CalibrationErrorVector.push_back(diff * diff);
   }
 
+  if (this->SignalAlignmentMetric == SIGNAL_ALIGNMENT_METRIC_SSD)
+  {
+    this->CalibrationError = sqrt(-this->BestCorrelationValue) / this->BestCorrelationNormalizationFactor;   // RMSE in mm
+  }
+  else
+  {
+    // The best metric value is not a sum of squared differences, so compute the error from the aligned signals
+    double sumOfSquaredDifferences = 0;
+    for (unsigned int i = 0; i < this->CalibrationErrorVector.size(); ++i)
+    {
+      sumOfSquaredDifferences += this->CalibrationErrorVector.at(i);
+    }
+    this->CalibrationError = sqrt(sumOfSquaredDifferences) / this->BestCorrelationNormalizationFactor;
+  }
+
   this->MaxCalibrationError = 0;
   for (unsigned int i = 0; i < this->CalibrationErrorVector.size(); ++i)
   {
@@ -841,14 +1031,14 @@ PlusStatus vtkPlusTemporalCalibrationAlgo::ComputeMovingSignalLagSec(TEMPORAL_CA
 
   this->NeverUpdated = false;
 
-  if (this->BestCorrelationValue <= SIGNAL_ALIGNMENT_METRIC_THRESHOLD[SIGNAL_ALIGNMENT_METRIC])
+  if (this->BestCorrelationValue <= SIGNAL_ALIGNMENT_METRIC_THRESHOLD[this->SignalAlignmentMetric])
   {
     error = TEMPORAL_CALIBRATION_ERROR_RESULT_ABOVE_THRESHOLD;
     LOG_ERROR("Calculated correlation exceeds threshold value. This may be an indicator of a poor calibration.");
     return PLUS_FAIL;
   }
 
-  LOG_DEBUG("Temporal calibration BestCorrelationValue = " << this->BestCorrelationValue << " (threshold=" << SIGNAL_ALIGNMENT_METRIC_THRESHOLD[SIGNAL_ALIGNMENT_METRIC] << ")");
+  LOG_DEBUG("Temporal calibration BestCorrelationValue = " << this->BestCorrelationValue << " (threshold=" << SIGNAL_ALIGNMENT_METRIC_THRESHOLD[this->SignalAlignmentMetric] << ")");
   LOG_DEBUG("MaxCalibrationError=" << this->MaxCalibrationError);
   LOG_DEBUG("CalibrationError=" << this->CalibrationError);
   return PLUS_SUCCESS;
@@ -894,6 +1084,10 @@ PlusStatus vtkPlusTemporalCalibrationAlgo::ReadConfiguration(vtkXMLDataElement*
   }
   XML_READ_BOOL_ATTRIBUTE_OPTIONAL(SaveIntermediateImages, calibrationParameters);
   XML_READ_SCALAR_ATTRIBUTE_OPTIONAL(double, MaximumMovingLagSec, calibrationParameters);
+  XML_READ_ENUM3_ATTRIBUTE_OPTIONAL(SignalAlignmentMetric, calibrationParameters,
+                                    "SSD", SIGNAL_ALIGNMENT_METRIC_SSD,
+                                    "CORRELATION", SIGNAL_ALIGNMENT_METRIC_CORRELATION,
+                                    "SAD", SIGNAL_ALIGNMENT_METRIC_SAD);
 
   if (calibrationParameters != NULL)
   {
@@ -62,6 +62,14 @@ public:
     // (e.g., bottom of water tank)
   };
 
+  enum SIGNAL_ALIGNMENT_METRIC_TYPE
+  {
+    SIGNAL_ALIGNMENT_METRIC_SSD, // Sum of squared differences
+    SIGNAL_ALIGNMENT_METRIC_CORRELATION, // Cross-correlation, computed using FFT for all the time offsets at once
+    SIGNAL_ALIGNMENT_METRIC_SAD, // Sum of absolute differences
+    SIGNAL_ALIGNMENT_METRIC_TYPE_COUNT
+  };
+
   struct SignalType
   {
     vtkPlusTrackedFrameList* frameList;
@@ -105,6 +113,13 @@ public:
   /*! Sets the maximum allowable time lag between the corresponding tracker and video frames. Default is 2 seconds */
   void SetMaximumMovingLagSec(double maxLagSec);
 
+  /*!
+    Sets the metric that is used for finding the best alignment of the fixed and moving signals. Default is SSD.
+    SSD and SAD are computed separately for each tested time offset. CORRELATION is computed for all the time offsets
+    at once, by FFT-based cross-correlation of the uniformly resampled signals, which is much faster for long acquisitions.
+  */
+  void SetSignalAlignmentMetric(SIGNAL_ALIGNMENT_METRIC_TYPE metric);
+
   /*! Enable/disable saving of intermediate images for debugging. Need to call before SetVideoFrames. */
   void SetSaveIntermediateImages(bool saveIntermediateImages);
 
@@ -138,6 +153,14 @@ public:
   PlusStatus GetBestCorrelation(double& videoCorrelation);
   PlusStatus GetMaxCalibrationError(double& maxCalibrationError);
 
+  /*!
+    Compute the normalized cross-correlation of two uniformly sampled signals for each offset at which the fixed signal fits in the moving signal:
+    corrValues[offset] = sum(fixedValues[i] * (movingValues[i + offset] - mean)) / stdev, where mean and stdev are computed in the overlapping
+    window of the moving signal. The fixed signal is expected to have zero mean. The correlation is computed by FFT, the window statistics from running sums.
+    \param normalizationFactors Inverse of the moving signal standard deviation in each window
+  */
+  static PlusStatus ComputeNormalizedCrossCorrelationUsingFft(const std::deque<double>& fixedValues, const std::deque<double>& movingValues, std::deque<double>& corrValues, std::deque<double>& normalizationFactors);
+
 protected:
   PlusStatus ComputeMovingSignalLagSec(TEMPORAL_CALIBRATION_ERROR& error);
   PlusStatus ComputePositionSignalValues(SignalType& signal);
@@ -150,6 +173,12 @@ protected:
   PlusStatus NormalizeMetricValues(std::deque<double>& signal, double& normalizationFactor, double startTime, double stopTime, const std::deque<double>& timestamps);
   void ComputeCorrelationBetweenFixedAndMovingSignal(double minTrackerLagSec, double maxTrackerLagSec, double stepSizeSec, double& bestCorrelationValue, double& bestCorrelationTimeOffset, double& bestCorrelationNormalizationFactor, std::deque<double>& corrTimeOffsets, std::deque<double>& corrValues);
 
+  /*!
+    Compute the normalized cross-correlation between the fixed and moving signals for all the time offsets between minTrackerLagSec and maxTrackerLagSec.
+    Both signals are resampled uniformly with stepSizeSec resolution and the correlation is computed by ComputeNormalizedCrossCorrelationUsingFft.
+  */
+  PlusStatus ComputeCorrelationUsingFft(const vtkSmartPointer<vtkPiecewiseFunction>& movingSignalFunction, double minTrackerLagSec, double maxTrackerLagSec, double stepSizeSec, std::deque<double>& corrTimeOffsets, std::deque<double>& corrValues, std::deque<double>& normalizationFactors);
+
   double ComputeAlignmentMetric(const std::deque<double>& signalA, const std::deque<double>& signalB);
 
   PlusStatus ConstructTableSignal(std::deque<double>& x, std::deque<double>& y, vtkTable* table, double timeCorrection);
@@ -173,6 +202,9 @@ protected:
   /*! Resolution used for re-sampling [s]*/
   double SamplingResolutionSec;
 
+  /*! Metric used for finding the best alignment of the fixed and moving signals */
+  SIGNAL_ALIGNMENT_METRIC_TYPE SignalAlignmentMetric;
+
   /*! The computed signal correlation values (corresponding to the better sign convention) */
   std::deque<double> CorrelationValues;
   /*! The time-offsets used to compute the correlations */
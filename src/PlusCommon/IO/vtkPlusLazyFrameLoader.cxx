@@ -0,0 +1,250 @@
+/*=Plus=header=begin======================================================
+  Program: Plus
+  Copyright (c) Laboratory for Percutaneous Surgery. All rights reserved.
+  See License.txt for details.
+=========================================================Plus=header=end*/
+
+#include "PlusConfigure.h"
+#include "PlusTrackedFrame.h"
+#include "vtkPlusLazyFrameLoader.h"
+
+// VTK includes
+#include <vtkImageData.h>
+#include <vtkObjectFactory.h>
+
+// STL includes
+#include <algorithm>
+
+#ifdef _WIN32
+  #define FSEEK _fseeki64
+#else
+  #define FSEEK fseek
+#endif
+
+vtkStandardNewMacro(vtkPlusLazyFrameLoader);
+
+//----------------------------------------------------------------------------
+vtkPlusLazyFrameLoader::vtkPlusLazyFrameLoader()
+  : PixelDataFileOffset(0)
+  , PixelDataFileHandle(NULL)
+  , FrameSizeInBytes(0)
+  , PixelType(VTK_VOID)
+  , NumberOfScalarComponents(1)
+  , ImageType(US_IMG_TYPE_XX)
+  , ImageOrientationInMemory(US_IMG_ORIENT_XX)
+  , MaximumNumberOfResidentFrames(100)
+{
+  this->FrameSize[0] = 0;
+  this->FrameSize[1] = 0;
+  this->FrameSize[2] = 0;
+}
+
+//----------------------------------------------------------------------------
+vtkPlusLazyFrameLoader::~vtkPlusLazyFrameLoader()
+{
+  // Frames keep a reference to the loader, so there are no resident frames left at this point
+  if (this->PixelDataFileHandle != NULL)
+  {
+    fclose(this->PixelDataFileHandle);
+    this->PixelDataFileHandle = NULL;
+  }
+}
+
+//----------------------------------------------------------------------------
+void vtkPlusLazyFrameLoader::PrintSelf(ostream& os, vtkIndent indent)
+{
+  this->Superclass::PrintSelf(os, indent);
+  os << indent << "PixelDataFilePath: " << this->PixelDataFilePath << std::endl;
+  os << indent << "PixelDataFileOffset: " << this->PixelDataFileOffset << std::endl;
+  os << indent << "FrameSizeInBytes: " << this->FrameSizeInBytes << std::endl;
+  os << indent << "MaximumNumberOfResidentFrames: " << this->MaximumNumberOfResidentFrames << std::endl;
+  os << indent << "NumberOfResidentFrames: " << this->GetNumberOfResidentFrames() << std::endl;
+}
+
+//----------------------------------------------------------------------------
+PlusStatus vtkPlusLazyFrameLoader::Open(const std::string& pixelDataFilePath, long long pixelDataFileOffset, const FrameSizeType& frameSize,
+                                        PlusCommon::VTKScalarPixelType pixelType, unsigned int numberOfScalarComponents, US_IMAGE_TYPE imageType,
+                                        US_IMAGE_ORIENTATION imageOrientationInFile, US_IMAGE_ORIENTATION imageOrientationInMemory)
+{
+  std::lock_guard<std::mutex> lock(this->Mutex);
+
+  if (PlusVideoFrame::GetFlipAxes(imageOrientationInFile, imageType, imageOrientationInMemory, this->FlipInfo) != PLUS_SUCCESS)
+  {
+    LOG_ERROR("Failed to convert image data to the requested orientation, from " << PlusVideoFrame::GetStringFromUsImageOrientation(imageOrientationInFile) <<
+              " to " << PlusVideoFrame::GetStringFromUsImageOrientation(imageOrientationInMemory));
+    return PLUS_FAIL;
+  }
+
+  if (this->PixelDataFileHandle != NULL)
+  {
+    fclose(this->PixelDataFileHandle);
+    this->PixelDataFileHandle = NULL;
+  }
+  this->PixelDataFileHandle = fopen(pixelDataFilePath.c_str(), "rb");
+  if (this->PixelDataFileHandle == NULL)
+  {
+    LOG_ERROR("The file " << pixelDataFilePath << " could not be opened for reading");
+    return PLUS_FAIL;
+  }
+
+  this->PixelDataFilePath = pixelDataFilePath;
+  this->PixelDataFileOffset = pixelDataFileOffset;
+  this->FrameSize = frameSize;
+  this->PixelType = pixelType;
+  this->NumberOfScalarComponents = numberOfScalarComponents;
+  this->ImageType = imageType;
+  this->ImageOrientationInMemory = imageOrientationInMemory;
+  this->FrameSizeInBytes = static_cast<unsigned long long>(frameSize[0]) * frameSize[1] * frameSize[2]
+                           * PlusVideoFrame::GetNumberOfBytesPerScalar(pixelType) * numberOfScalarComponents;
+  this->PixelBuffer.resize(this->FrameSizeInBytes);
+
+  return PLUS_SUCCESS;
+}
+
+//----------------------------------------------------------------------------
+int vtkPlusLazyFrameLoader::GetNumberOfResidentFrames()
+{
+  std::lock_guard<std::mutex> lock(this->Mutex);
+  return static_cast<int>(this->ResidentFrames.size());
+}
+
+//----------------------------------------------------------------------------
+FrameSizeType vtkPlusLazyFrameLoader::GetFrameSize()
+{
+  std::lock_guard<std::mutex> lock(this->Mutex);
+  return this->FrameSize;
+}
+
+//----------------------------------------------------------------------------
+PlusCommon::VTKScalarPixelType vtkPlusLazyFrameLoader::GetPixelType()
+{
+  std::lock_guard<std::mutex> lock(this->Mutex);
+  return this->PixelType;
+}
+
+//----------------------------------------------------------------------------
+unsigned int vtkPlusLazyFrameLoader::GetNumberOfScalarComponents()
+{
+  std::lock_guard<std::mutex> lock(this->Mutex);
+  return this->NumberOfScalarComponents;
+}
+
+//----------------------------------------------------------------------------
+PlusStatus vtkPlusLazyFrameLoader::LoadImageData(PlusTrackedFrame* trackedFrame, int frameIndex, PlusVideoFrame* imageCopy)
+{
+  std::lock_guard<std::mutex> lock(this->Mutex);
+
+  std::map<PlusTrackedFrame*, ResidentFrameListType::iterator>::iterator residentFrame = this->ResidentFramePositions.find(trackedFrame);
+  if (residentFrame != this->ResidentFramePositions.end())
+  {
+    // Already in memory, just mark it as the most recently used frame
+    this->ResidentFrames.splice(this->ResidentFrames.begin(), this->ResidentFrames, residentFrame->second);
+    if (imageCopy != NULL)
+    {
+      imageCopy->ShallowCopy(trackedFrame->ImageData);
+    }
+    return PLUS_SUCCESS;
+  }
+
+  this->ReleaseFramesForLoading();
+
+  // If the image was copied from another frame of this loader then it is valid already and only has to be tracked
+  PlusVideoFrame& videoFrame = trackedFrame->ImageData;
+  if (!videoFrame.IsImageValid())
+  {
+    if (this->PixelDataFileHandle == NULL || this->FrameSizeInBytes == 0)
+    {
+      LOG_ERROR("Cannot load frame " << frameIndex << ": pixel data file is not open");
+      return PLUS_FAIL;
+    }
+
+    FSEEK(this->PixelDataFileHandle, this->PixelDataFileOffset + static_cast<long long>(frameIndex) * this->FrameSizeInBytes, SEEK_SET);
+    if (fread(&(this->PixelBuffer[0]), 1, this->FrameSizeInBytes, this->PixelDataFileHandle) != this->FrameSizeInBytes)
+    {
+      LOG_ERROR("Could not read " << this->FrameSizeInBytes << " bytes of frame " << frameIndex << " from " << this->PixelDataFilePath);
+      return PLUS_FAIL;
+    }
+
+    videoFrame.SetImageOrientation(this->ImageOrientationInMemory);
+    videoFrame.SetImageType(this->ImageType);
+    if (videoFrame.AllocateFrame(this->FrameSize, this->PixelType, this->NumberOfScalarComponents) != PLUS_SUCCESS)
+    {
+      LOG_ERROR("Cannot allocate memory for frame " << frameIndex);
+      return PLUS_FAIL;
+    }
+
+    std::array<int, 3> clipRectOrigin = {PlusCommon::NO_CLIP, PlusCommon::NO_CLIP, PlusCommon::NO_CLIP};
+    std::array<int, 3> clipRectSize = {PlusCommon::NO_CLIP, PlusCommon::NO_CLIP, PlusCommon::NO_CLIP};
+    if (PlusVideoFrame::GetOrientedClippedImage(&(this->PixelBuffer[0]), this->FlipInfo, this->ImageType, this->PixelType, this->NumberOfScalarComponents,
+        this->FrameSize, videoFrame, clipRectOrigin, clipRectSize) != PLUS_SUCCESS)
+    {
+      LOG_ERROR("Failed to get oriented image from " << this->PixelDataFilePath << " (frame number: " << frameIndex << ")!");
+      videoFrame.ReleaseImage();
+      return PLUS_FAIL;
+    }
+  }
+
+  this->ResidentFrames.push_front(trackedFrame);
+  this->ResidentFramePositions[trackedFrame] = this->ResidentFrames.begin();
+  if (imageCopy != NULL)
+  {
+    imageCopy->ShallowCopy(videoFrame);
+  }
+  return PLUS_SUCCESS;
+}
+
+//----------------------------------------------------------------------------
+void vtkPlusLazyFrameLoader::RemoveFrame(PlusTrackedFrame* trackedFrame)
+{
+  std::lock_guard<std::mutex> lock(this->Mutex);
+  std::map<PlusTrackedFrame*, ResidentFrameListType::iterator>::iterator residentFrame = this->ResidentFramePositions.find(trackedFrame);
+  if (residentFrame == this->ResidentFramePositions.end())
+  {
+    return;
+  }
+  this->ResidentFrames.erase(residentFrame->second);
+  this->ResidentFramePositions.erase(residentFrame);
+}
+
+//----------------------------------------------------------------------------
+void vtkPlusLazyFrameLoader::ReleaseFramesForLoading()
+{
+  // At least one frame must stay in memory: the one that is being loaded
+  int maximumNumberOfResidentFrames = std::max(this->MaximumNumberOfResidentFrames, 1);
+  if (static_cast<int>(this->ResidentFrames.size()) < maximumNumberOfResidentFrames)
+  {
+    return;
+  }
+
+  // Copies of a frame may share the image, so an image is only referenced from outside
+  // if it has more references than the number of resident frames that hold it
+  std::map<vtkImageData*, int> numberOfResidentReferences;
+  for (ResidentFrameListType::iterator frameIt = this->ResidentFrames.begin(); frameIt != this->ResidentFrames.end(); ++frameIt)
+  {
+    vtkImageData* image = (*frameIt)->ImageData.GetImage();
+    if (image != NULL)
+    {
+      numberOfResidentReferences[image]++;
+    }
+  }
+
+  ResidentFrameListType::iterator frameIt = this->ResidentFrames.end();
+  while (static_cast<int>(this->ResidentFrames.size()) >= maximumNumberOfResidentFrames && frameIt != this->ResidentFrames.begin())
+  {
+    --frameIt;
+    PlusTrackedFrame* leastRecentlyUsedFrame = *frameIt;
+    vtkImageData* image = leastRecentlyUsedFrame->ImageData.GetImage();
+    if (image != NULL)
+    {
+      if (image->GetReferenceCount() > numberOfResidentReferences[image])
+      {
+        // The image is in use, releasing it would invalidate the caller's pointer without freeing any memory
+        continue;
+      }
+      numberOfResidentReferences[image]--;
+    }
+    leastRecentlyUsedFrame->ImageData.ReleaseImage();
+    this->ResidentFramePositions.erase(leastRecentlyUsedFrame);
+    frameIt = this->ResidentFrames.erase(frameIt);
+  }
+}
@@ -0,0 +1,126 @@
+/*=Plus=header=begin======================================================
+  Program: Plus
+  Copyright (c) Laboratory for Percutaneous Surgery. All rights reserved.
+  See License.txt for details.
+=========================================================Plus=header=end*/
+
+#ifndef __vtkPlusLazyFrameLoader_h
+#define __vtkPlusLazyFrameLoader_h
+
+#include "PlusCommon.h"
+#include "vtkPlusCommonExport.h"
+#include "PlusVideoFrame.h"
+
+// VTK includes
+#include <vtkObject.h>
+
+// STL includes
+#include <list>
+#include <map>
+#include <mutex>
+#include <vector>
+
+class PlusTrackedFrame;
+
+/*!
+  \class vtkPlusLazyFrameLoader
+  \brief Reads the pixel data of tracked frames from an uncompressed sequence file when the image data is first accessed
+
+  Sequence file readers create a loader and assign it to the frames (see PlusTrackedFrame::SetImageDataLoader) instead of
+  reading all the pixel data into memory. The frames are read from the file through a file handle that is kept open while the loader
+  exists. At most MaximumNumberOfResidentFrames frames are kept in memory: when a frame is loaded and the limit is reached,
+  the image of the least recently accessed frame is released. Images that were shallow copied from a released frame remain valid.
+
+  The image of a frame is not released while it is referenced from outside the loader (e.g., by a vtkSmartPointer, a shallow copy
+  or a processing pipeline), so callers that need the images of several frames at the same time must hold a reference to each of them.
+  These frames do not count towards the limit until the references are given up (the number of frames in memory may exceed
+  the limit meanwhile). A raw pointer returned by PlusTrackedFrame::GetImageData without taking a reference is only valid until the next load.
+  Callers that share the frames between threads must use PlusTrackedFrame::ShallowCopyImageDataTo, which takes the reference
+  while the image cannot be released.
+
+  \ingroup PlusLibCommon
+*/
+class vtkPlusCommonExport vtkPlusLazyFrameLoader : public vtkObject
+{
+public:
+  static vtkPlusLazyFrameLoader* New();
+  vtkTypeMacro(vtkPlusLazyFrameLoader, vtkObject);
+  virtual void PrintSelf(ostream& os, vtkIndent indent) VTK_OVERRIDE;
+
+  /*!
+    Open the file that contains the pixel data and set the layout of the frames in it.
+    The frames are stored one after the other, without compression, starting at pixelDataFileOffset.
+  */
+  PlusStatus Open(const std::string& pixelDataFilePath, long long pixelDataFileOffset, const FrameSizeType& frameSize,
+                  PlusCommon::VTKScalarPixelType pixelType, unsigned int numberOfScalarComponents, US_IMAGE_TYPE imageType,
+                  US_IMAGE_ORIENTATION imageOrientationInFile, US_IMAGE_ORIENTATION imageOrientationInMemory);
+
+  /*! Maximum number of frames whose image data is kept in memory */
+  vtkGetMacro(MaximumNumberOfResidentFrames, int);
+  /*! Maximum number of frames whose image data is kept in memory. Frames are released at the next load if the number is decreased. */
+  vtkSetMacro(MaximumNumberOfResidentFrames, int);
+
+  /*! Get the number of frames whose image data is currently kept in memory by the loader */
+  int GetNumberOfResidentFrames();
+
+  /*! Size of the frames, as read from the file header (does not load any pixel data) */
+  FrameSizeType GetFrameSize();
+  /*! Pixel type of the frames, as read from the file header (does not load any pixel data) */
+  PlusCommon::VTKScalarPixelType GetPixelType();
+  /*! Number of scalar components of the frames, as read from the file header (does not load any pixel data) */
+  unsigned int GetNumberOfScalarComponents();
+
+  /*!
+    Make sure that the image data of the tracked frame is in memory. If it is not then the least recently used frames are released
+    (as needed to respect the resident frame limit) and the pixel data of frame frameIndex is read from the file.
+    \param imageCopy If not NULL then it is set to a shallow copy of the loaded image before the loader is unlocked,
+      so the image is guaranteed to stay valid even if other threads load frames and the frame is released.
+  */
+  PlusStatus LoadImageData(PlusTrackedFrame* trackedFrame, int frameIndex, PlusVideoFrame* imageCopy = NULL);
+
+  /*! Forget the tracked frame (called when the frame is deleted or it is detached from the loader), its image is not released */
+  void RemoveFrame(PlusTrackedFrame* trackedFrame);
+
+protected:
+  vtkPlusLazyFrameLoader();
+  virtual ~vtkPlusLazyFrameLoader();
+
+  /*!
+    Release the least recently used frames until there is room for loading a new frame.
+    Frames whose image is referenced from outside the resident frames are skipped.
+  */
+  void ReleaseFramesForLoading();
+
+  typedef std::list<PlusTrackedFrame*> ResidentFrameListType;
+
+  std::string PixelDataFilePath;
+  long long PixelDataFileOffset;
+  FILE* PixelDataFileHandle;
+
+  FrameSizeType FrameSize;
+  unsigned long long FrameSizeInBytes;
+  PlusCommon::VTKScalarPixelType PixelType;
+  unsigned int NumberOfScalarComponents;
+  US_IMAGE_TYPE ImageType;
+  US_IMAGE_ORIENTATION ImageOrientationInMemory;
+  PlusVideoFrame::FlipInfoType FlipInfo;
+
+  int MaximumNumberOfResidentFrames;
+
+  /*! Frames that have their image data in memory, the most recently accessed frame is the first */
+  ResidentFrameListType ResidentFrames;
+  /*! Position of each resident frame in ResidentFrames */
+  std::map<PlusTrackedFrame*, ResidentFrameListType::iterator> ResidentFramePositions;
+
+  /*! Buffer for reading the pixel data of a frame from the file, reused between reads */
+  std::vector<unsigned char> PixelBuffer;
+
+  /*! Frames may be accessed from multiple threads, the file handle and the resident frame list are protected by this mutex */
+  std::mutex Mutex;
+
+private:
+  vtkPlusLazyFrameLoader(const vtkPlusLazyFrameLoader&);
+  void operator=(const vtkPlusLazyFrameLoader&);
+};
+
+#endif
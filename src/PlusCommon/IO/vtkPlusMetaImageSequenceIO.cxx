@@ -7,8 +7,14 @@ See License.txt for details.
 #include "PlusConfigure.h"
 #include "itksys/SystemTools.hxx"
 #include "vtkPlusMetaImageSequenceIO.h"
+#include "vtkPlusWorkerPool.h"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
 #include <iomanip>
 #include <iostream>
+#include <map>
+#include <mutex>
 #include <vector>
 
 #ifdef _WIN32
@@ -61,6 +67,77 @@ namespace
 
   static std::string SEQMETA_FIELD_FRAME_FIELD_PREFIX = "Seq_Frame";
   static std::string SEQMETA_FIELD_IMG_STATUS = "ImageStatus";
+  static std::string SEQMETA_FIELD_COMPRESSED_DATA_OFFSET = "CompressedDataOffset";
+
+  // zlib stream header (deflate method, 32K window, default compression level), written before the first chunk
+  static const unsigned char ZLIB_STREAM_HEADER[2] = { 0x78, 0x9C };
+  // Empty final deflate block (fixed Huffman codes), written after the last chunk
+  static const unsigned char DEFLATE_EMPTY_FINAL_BLOCK[2] = { 0x03, 0x00 };
+
+  // Maximum number of compressed chunks per compression thread that may wait in memory for being written to file
+  static const int MAX_NUMBER_OF_CHUNKS_IN_MEMORY_PER_THREAD = 2;
+
+  struct CompressedChunkData
+  {
+    std::vector<unsigned char> Data;
+    int NumberOfFrames;
+    uLong Checksum;
+    unsigned long long UncompressedSize;
+
+    void swap(CompressedChunkData& other)
+    {
+      this->Data.swap(other.Data);
+      std::swap(this->NumberOfFrames, other.NumberOfFrames);
+      std::swap(this->Checksum, other.Checksum);
+      std::swap(this->UncompressedSize, other.UncompressedSize);
+    }
+  };
+
+  struct CompressChunksInfo
+  {
+    vtkPlusTrackedFrameList* TrackedFrameList;
+    PlusVideoFrame* BlankFrame;
+    bool EnableImageDataWrite;
+    int FramesPerChunk;
+    int NumberOfChunks;
+    int MaxNumberOfChunksInMemory;
+    FILE* OutputImageFileHandle;
+
+    // All the members below are protected by Mutex
+    std::mutex Mutex;
+    // Signaled when chunks are written to file (or compression failed)
+    std::condition_variable ChunkWritten;
+    int NextChunk;
+    int NextChunkToWrite;
+    // Compressed chunks that wait for the preceding chunks to be written
+    std::map<int, CompressedChunkData> PendingChunks;
+    unsigned long long NextChunkOffset;
+    unsigned long long NumberOfBytesWritten;
+    std::vector<unsigned long long>* ChunkOffsets;
+    uLong* Checksum;
+    bool Failed;
+  };
+
+  struct CompressedChunk
+  {
+    int FirstFrameNumber;
+    int NumberOfFrames;
+    unsigned long long CompressedDataOffset;
+    unsigned long long CompressedDataSize;
+  };
+
+  struct DecompressChunksInfo
+  {
+    vtkPlusMetaImageSequenceIO* Self;
+    std::string PixelDataFilePath;
+    std::vector<CompressedChunk> Chunks;
+    int FirstFrameNumber;
+    int LastFrameNumber;
+    unsigned int FrameSizeInBytes;
+    PlusVideoFrame::FlipInfoType FlipInfo;
+    std::atomic<int> NextChunk;
+    std::atomic<int> NumberOfErrors;
+  };
 }
 
 //----------------------------------------------------------------------------
@@ -72,12 +149,19 @@ vtkPlusMetaImageSequenceIO::vtkPlusMetaImageSequenceIO()
   : vtkPlusSequenceIOBase()
   , IsPixelDataBinary(true)
   , Output2DDataWithZDimensionIncluded(false)
+  , CompressedFramesPerChunk(0)
+  , CompressedChunksBytesWritten(0)
+  , CompressedChunksWritten(false)
+  , CompressedChunksChecksum(adler32(0L, Z_NULL, 0))
+  , WorkerPool(vtkPlusWorkerPool::New())
 {
 }
 
 //----------------------------------------------------------------------------
 vtkPlusMetaImageSequenceIO::~vtkPlusMetaImageSequenceIO()
 {
+  this->WorkerPool->Delete();
+  this->WorkerPool = NULL;
 }
 
 //----------------------------------------------------------------------------
@@ -85,7 +169,45 @@ void vtkPlusMetaImageSequenceIO::PrintSelf(ostream& os, vtkIndent indent)
 {
   Superclass::PrintSelf(os, indent);
 
-  // TODO : anything specific to print
+  os << indent << "CompressedFramesPerChunk: " << this->CompressedFramesPerChunk << std::endl;
+}
+
+//----------------------------------------------------------------------------
+PlusStatus vtkPlusMetaImageSequenceIO::ReadFrames(int firstFrameNumber, int lastFrameNumber)
+{
+  this->TrackedFrameList->Clear();
+
+  if (this->ReadImageHeader() != PLUS_SUCCESS)
+  {
+    LOG_ERROR("Could not load header from file: " << this->FileName);
+    return PLUS_FAIL;
+  }
+
+  int numberOfFrames = std::max<int>(this->Dimensions[3], this->TrackedFrameList->GetNumberOfTrackedFrames());
+  if (firstFrameNumber < 0 || lastFrameNumber >= numberOfFrames || firstFrameNumber > lastFrameNumber)
+  {
+    LOG_ERROR("Invalid frame range (" << firstFrameNumber << ", " << lastFrameNumber << ") is requested from " << this->FileName
+              << ", the file contains " << numberOfFrames << " frames");
+    return PLUS_FAIL;
+  }
+
+  if (this->ReadImagePixelsInRange(firstFrameNumber, lastFrameNumber) != PLUS_SUCCESS)
+  {
+    return PLUS_FAIL;
+  }
+
+  // Keep only the requested frames
+  this->CreateTrackedFrameIfNonExisting(numberOfFrames - 1);
+  if (lastFrameNumber < numberOfFrames - 1)
+  {
+    this->TrackedFrameList->RemoveTrackedFrameRange(lastFrameNumber + 1, numberOfFrames - 1);
+  }
+  if (firstFrameNumber > 0)
+  {
+    this->TrackedFrameList->RemoveTrackedFrameRange(0, firstFrameNumber - 1);
+  }
+
+  return PLUS_SUCCESS;
 }
 
 //----------------------------------------------------------------------------
@@ -335,6 +457,17 @@ PlusStatus vtkPlusMetaImageSequenceIO::ReadImageHeader()
 //----------------------------------------------------------------------------
 // Read the spacing and dimensions of the image.
 PlusStatus vtkPlusMetaImageSequenceIO::ReadImagePixels()
+{
+  if (this->Dimensions[3] == 0)
+  {
+    LOG_DEBUG("No frames in the metafile");
+    return PLUS_SUCCESS;
+  }
+  return this->ReadImagePixelsInRange(0, this->Dimensions[3] - 1);
+}
+
+//----------------------------------------------------------------------------
+PlusStatus vtkPlusMetaImageSequenceIO::ReadImagePixelsInRange(int firstFrameNumber, int lastFrameNumber)
 {
   int frameCount = this->Dimensions[3];
   unsigned int frameSizeInBytes = 0;
@@ -349,18 +482,66 @@ PlusStatus vtkPlusMetaImageSequenceIO::ReadImagePixels()
     return PLUS_SUCCESS;
   }
 
-  int numberOfErrors = 0;
+  if (firstFrameNumber < 0 || lastFrameNumber >= frameCount || firstFrameNumber > lastFrameNumber)
+  {
+    LOG_ERROR("Invalid frame range (" << firstFrameNumber << ", " << lastFrameNumber << "), the pixel data contains " << frameCount << " frames");
+    return PLUS_FAIL;
+  }
 
-  FILE* stream = NULL;
+  if (this->LazyImageLoading)
+  {
+    if (!this->UseCompression)
+    {
+      // Pixel data is read from the file when the image data of the frames is accessed
+      return this->SetUpLazyImageLoading(firstFrameNumber, lastFrameNumber, SEQMETA_FIELD_IMG_STATUS);
+    }
+    LOG_INFO("Lazy image loading is not available for compressed pixel data, reading all frames of " << this->FileName);
+  }
 
-  if (FileOpen(&stream, GetPixelDataFilePath().c_str(), "rb") != PLUS_SUCCESS)
+  int numberOfErrors = 0;
+
+  PlusVideoFrame::FlipInfoType flipInfo;
+  if (PlusVideoFrame::GetFlipAxes(this->ImageOrientationInFile, this->ImageType, this->ImageOrientationInMemory, flipInfo) != PLUS_SUCCESS)
   {
-    LOG_ERROR("The file " << GetPixelDataFilePath() << " could not be opened for reading");
+    LOG_ERROR("Failed to convert image data to the requested orientation, from " << PlusVideoFrame::GetStringFromUsImageOrientation(this->ImageOrientationInFile) <<
+              " to " << PlusVideoFrame::GetStringFromUsImageOrientation(this->ImageOrientationInMemory));
     return PLUS_FAIL;
   }
 
-  std::vector<unsigned char> allFramesPixelBuffer;
+  // If the file was written in chunks then the offset of its chunk is stored for each frame
+  bool readCompressedChunks = false;
+  std::vector<long long> chunkOffsets;
   if (this->UseCompression)
+  {
+    readCompressedChunks = true;
+    chunkOffsets.resize(frameCount, -1);
+    for (int frameNumber = 0; frameNumber < frameCount; frameNumber++)
+    {
+      CreateTrackedFrameIfNonExisting(frameNumber);
+      PlusTrackedFrame* trackedFrame = this->TrackedFrameList->GetTrackedFrame(frameNumber);
+      const char* chunkOffsetStr = trackedFrame->GetFrameField(SEQMETA_FIELD_COMPRESSED_DATA_OFFSET.c_str());
+      if (chunkOffsetStr == NULL || PlusCommon::StringToLong(chunkOffsetStr, chunkOffsets[frameNumber]) != PLUS_SUCCESS)
+      {
+        readCompressedChunks = false;
+        continue;
+      }
+      // The offset is only needed for reading the file, it is not kept in the tracked frame
+      trackedFrame->DeleteFrameField(SEQMETA_FIELD_COMPRESSED_DATA_OFFSET.c_str());
+    }
+  }
+
+  FILE* stream = NULL;
+  std::vector<unsigned char> allFramesPixelBuffer;
+  if (!readCompressedChunks)
+  {
+    if (FileOpen(&stream, GetPixelDataFilePath().c_str(), "rb") != PLUS_SUCCESS)
+    {
+      LOG_ERROR("The file " << GetPixelDataFilePath() << " could not be opened for reading");
+      return PLUS_FAIL;
+    }
+  }
+
+  if (this->UseCompression && !readCompressedChunks)
   {
     unsigned int allFramesPixelBufferSize = frameCount * frameSizeInBytes;
 
@@ -406,7 +587,7 @@ PlusStatus vtkPlusMetaImageSequenceIO::ReadImagePixels()
 
   std::vector<unsigned char> pixelBuffer;
   pixelBuffer.resize(frameSizeInBytes);
-  for (int frameNumber = 0; frameNumber < frameCount; frameNumber++)
+  for (int frameNumber = firstFrameNumber; frameNumber <= lastFrameNumber; frameNumber++)
   {
     CreateTrackedFrameIfNonExisting(frameNumber);
     PlusTrackedFrame* trackedFrame = this->TrackedFrameList->GetTrackedFrame(frameNumber);
@@ -443,14 +624,6 @@ PlusStatus vtkPlusMetaImageSequenceIO::ReadImagePixels()
     std::array<int, 3> clipRectOrigin = {PlusCommon::NO_CLIP, PlusCommon::NO_CLIP, PlusCommon::NO_CLIP};
     std::array<int, 3> clipRectSize = {PlusCommon::NO_CLIP, PlusCommon::NO_CLIP, PlusCommon::NO_CLIP};
 
-    PlusVideoFrame::FlipInfoType flipInfo;
-    if (PlusVideoFrame::GetFlipAxes(this->ImageOrientationInFile, this->ImageType, this->ImageOrientationInMemory, flipInfo) != PLUS_SUCCESS)
-    {
-      LOG_ERROR("Failed to convert image data to the requested orientation, from " << PlusVideoFrame::GetStringFromUsImageOrientation(this->ImageOrientationInFile) <<
-                " to " << PlusVideoFrame::GetStringFromUsImageOrientation(this->ImageOrientationInMemory));
-      return PLUS_FAIL;
-    }
-
     if (!this->UseCompression)
     {
       FilePositionOffsetType offset = PixelDataFileOffset + frameNumber * frameSizeInBytes;
@@ -468,7 +641,7 @@ PlusStatus vtkPlusMetaImageSequenceIO::ReadImagePixels()
         continue;
       }
     }
-    else
+    else if (!readCompressedChunks)
     {
       FrameSizeType frameSize = { this->Dimensions[0], this->Dimensions[1], this->Dimensions[2] };
       if (PlusVideoFrame::GetOrientedClippedImage(&(allFramesPixelBuffer[0]) + frameNumber * frameSizeInBytes, flipInfo, this->ImageType, this->PixelType, this->NumberOfScalarComponents, frameSize, *trackedFrame->GetImageData(), clipRectOrigin, clipRectSize) != PLUS_SUCCESS)
@@ -480,7 +653,21 @@ PlusStatus vtkPlusMetaImageSequenceIO::ReadImagePixels()
     }
   }
 
-  fclose(stream);
+  if (stream != NULL)
+  {
+    fclose(stream);
+  }
+
+  if (readCompressedChunks && numberOfErrors == 0)
+  {
+    // The frames are allocated now, fill them from the chunks
+    unsigned long long compressedDataSize = 0;
+    PlusCommon::StringToLong(this->TrackedFrameList->GetCustomString(SEQMETA_FIELD_COMPRESSED_DATA_SIZE), compressedDataSize);
+    if (this->ReadCompressedChunks(firstFrameNumber, lastFrameNumber, chunkOffsets, compressedDataSize, flipInfo) != PLUS_SUCCESS)
+    {
+      numberOfErrors++;
+    }
+  }
 
   if (numberOfErrors > 0)
   {
@@ -490,6 +677,141 @@ PlusStatus vtkPlusMetaImageSequenceIO::ReadImagePixels()
   return PLUS_SUCCESS;
 }
 
+//----------------------------------------------------------------------------
+PlusStatus vtkPlusMetaImageSequenceIO::ReadCompressedChunks(int firstFrameNumber, int lastFrameNumber, const std::vector<long long>& chunkOffsets,
+    unsigned long long compressedDataSize, const PlusVideoFrame::FlipInfoType& flipInfo)
+{
+  DecompressChunksInfo info;
+  info.Self = this;
+  info.PixelDataFilePath = GetPixelDataFilePath();
+  info.FirstFrameNumber = firstFrameNumber;
+  info.LastFrameNumber = lastFrameNumber;
+  info.FrameSizeInBytes = this->Dimensions[0] * this->Dimensions[1] * this->Dimensions[2] * PlusVideoFrame::GetNumberOfBytesPerScalar(this->PixelType) * this->NumberOfScalarComponents;
+  info.FlipInfo = flipInfo;
+  info.NextChunk = 0;
+  info.NumberOfErrors = 0;
+
+  // Consecutive frames with the same offset are in the same chunk, a chunk ends where the next one starts
+  int frameCount = static_cast<int>(chunkOffsets.size());
+  for (int frameNumber = 0; frameNumber < frameCount;)
+  {
+    int nextChunkFrameNumber = frameNumber + 1;
+    while (nextChunkFrameNumber < frameCount && chunkOffsets[nextChunkFrameNumber] == chunkOffsets[frameNumber])
+    {
+      nextChunkFrameNumber++;
+    }
+    unsigned long long chunkEnd = (nextChunkFrameNumber < frameCount) ? chunkOffsets[nextChunkFrameNumber] : compressedDataSize;
+    if (chunkOffsets[frameNumber] < 0 || chunkEnd <= static_cast<unsigned long long>(chunkOffsets[frameNumber]) || chunkEnd > compressedDataSize)
+    {
+      LOG_ERROR("Invalid compressed data offset for frame " << frameNumber << " in " << this->FileName);
+      return PLUS_FAIL;
+    }
+    if (nextChunkFrameNumber > firstFrameNumber && frameNumber <= lastFrameNumber)
+    {
+      CompressedChunk chunk;
+      chunk.FirstFrameNumber = frameNumber;
+      chunk.NumberOfFrames = nextChunkFrameNumber - frameNumber;
+      chunk.CompressedDataOffset = chunkOffsets[frameNumber];
+      chunk.CompressedDataSize = chunkEnd - chunkOffsets[frameNumber];
+      info.Chunks.push_back(chunk);
+    }
+    frameNumber = nextChunkFrameNumber;
+  }
+
+  LOG_DEBUG("Decompressing " << info.Chunks.size() << " chunks for frames " << firstFrameNumber << "-" << lastFrameNumber);
+  this->WorkerPool->SingleMethodExecute(DecompressChunksThreadFunction, &info);
+
+  return (info.NumberOfErrors == 0) ? PLUS_SUCCESS : PLUS_FAIL;
+}
+
+//----------------------------------------------------------------------------
+VTK_THREAD_RETURN_TYPE vtkPlusMetaImageSequenceIO::DecompressChunksThreadFunction(void* arg)
+{
+  vtkMultiThreader::ThreadInfo* threadInfo = static_cast<vtkMultiThreader::ThreadInfo*>(arg);
+  DecompressChunksInfo* info = static_cast<DecompressChunksInfo*>(threadInfo->UserData);
+  vtkPlusMetaImageSequenceIO* self = info->Self;
+
+  // Each thread reads the file through its own file handle
+  FILE* stream = NULL;
+  std::vector<unsigned char> compressedBuffer;
+  std::vector<unsigned char> pixelBuffer;
+  for (int chunkIndex = info->NextChunk++; chunkIndex < static_cast<int>(info->Chunks.size()); chunkIndex = info->NextChunk++)
+  {
+    const CompressedChunk& chunk = info->Chunks[chunkIndex];
+    if (stream == NULL && FileOpen(&stream, info->PixelDataFilePath.c_str(), "rb") != PLUS_SUCCESS)
+    {
+      LOG_ERROR("The file " << info->PixelDataFilePath << " could not be opened for reading");
+      info->NumberOfErrors++;
+      break;
+    }
+
+    compressedBuffer.resize(chunk.CompressedDataSize);
+    pixelBuffer.resize(static_cast<size_t>(chunk.NumberOfFrames) * info->FrameSizeInBytes);
+
+    FSEEK(stream, self->PixelDataFileOffset + chunk.CompressedDataOffset, SEEK_SET);
+    if (fread(&(compressedBuffer[0]), 1, compressedBuffer.size(), stream) != compressedBuffer.size())
+    {
+      LOG_ERROR("Could not read " << compressedBuffer.size() << " bytes from " << info->PixelDataFilePath);
+      info->NumberOfErrors++;
+      continue;
+    }
+
+    // Chunks are raw deflate data (the zlib header is only written before the first chunk)
+    z_stream strm;
+    strm.zalloc = Z_NULL;
+    strm.zfree = Z_NULL;
+    strm.opaque = Z_NULL;
+    strm.next_in = Z_NULL;
+    strm.avail_in = 0;
+    int ret = inflateInit2(&strm, -MAX_WBITS);
+    if (ret != Z_OK)
+    {
+      LOG_ERROR("Image decompression initialization failed (errorCode=" << ret << ")");
+      info->NumberOfErrors++;
+      continue;
+    }
+    strm.next_in = &(compressedBuffer[0]);
+    strm.avail_in = static_cast<uInt>(compressedBuffer.size());
+    strm.next_out = &(pixelBuffer[0]);
+    strm.avail_out = static_cast<uInt>(pixelBuffer.size());
+    ret = inflate(&strm, Z_SYNC_FLUSH);
+    inflateEnd(&strm);
+    if ((ret != Z_OK && ret != Z_STREAM_END) || strm.avail_out != 0)
+    {
+      LOG_ERROR("Cannot uncompress the pixel data of frames " << chunk.FirstFrameNumber << "-" << chunk.FirstFrameNumber + chunk.NumberOfFrames - 1 << " (errorCode=" << ret << ")");
+      info->NumberOfErrors++;
+      continue;
+    }
+
+    int firstFrameNumber = std::max(chunk.FirstFrameNumber, info->FirstFrameNumber);
+    int lastFrameNumber = std::min(chunk.FirstFrameNumber + chunk.NumberOfFrames - 1, info->LastFrameNumber);
+    for (int frameNumber = firstFrameNumber; frameNumber <= lastFrameNumber; frameNumber++)
+    {
+      PlusTrackedFrame* trackedFrame = self->TrackedFrameList->GetTrackedFrame(frameNumber);
+      if (!trackedFrame->GetImageData()->IsImageValid())
+      {
+        // image status is not OK, the frame is not allocated
+        continue;
+      }
+      std::array<int, 3> clipRectOrigin = {PlusCommon::NO_CLIP, PlusCommon::NO_CLIP, PlusCommon::NO_CLIP};
+      std::array<int, 3> clipRectSize = {PlusCommon::NO_CLIP, PlusCommon::NO_CLIP, PlusCommon::NO_CLIP};
+      FrameSizeType frameSize = { self->Dimensions[0], self->Dimensions[1], self->Dimensions[2] };
+      unsigned char* framePixels = &(pixelBuffer[0]) + static_cast<size_t>(frameNumber - chunk.FirstFrameNumber) * info->FrameSizeInBytes;
+      if (PlusVideoFrame::GetOrientedClippedImage(framePixels, info->FlipInfo, self->ImageType, self->PixelType, self->NumberOfScalarComponents, frameSize, *trackedFrame->GetImageData(), clipRectOrigin, clipRectSize) != PLUS_SUCCESS)
+      {
+        LOG_ERROR("Failed to get oriented image from sequence metafile (frame number: " << frameNumber << ")!");
+        info->NumberOfErrors++;
+      }
+    }
+  }
+
+  if (stream != NULL)
+  {
+    fclose(stream);
+  }
+  return VTK_THREAD_RETURN_VALUE;
+}
+
 //----------------------------------------------------------------------------
 PlusStatus vtkPlusMetaImageSequenceIO::PrepareImageFile()
 {
@@ -505,6 +827,10 @@ PlusStatus vtkPlusMetaImageSequenceIO::PrepareImageFile()
       LOG_ERROR("Image compression initialization failed (errorCode=" << ret << ")");
       return PLUS_FAIL;
     }
+    this->CompressedChunkOffsets.clear();
+    this->CompressedChunksBytesWritten = 0;
+    this->CompressedChunksWritten = false;
+    this->CompressedChunksChecksum = adler32(0L, Z_NULL, 0);
   }
   if (FileOpen(&this->OutputImageFileHandle, this->TempImageFileName.c_str(), "ab+") != PLUS_SUCCESS)
   {
@@ -845,6 +1171,19 @@ PlusStatus vtkPlusMetaImageSequenceIO::WriteInitialImageHeader()
 //----------------------------------------------------------------------------
 PlusStatus vtkPlusMetaImageSequenceIO::AppendImagesToHeader()
 {
+  bool writeChunkOffsets = false;
+  if (this->UseCompression && this->CompressedFramesPerChunk > 0
+      && this->Dimensions[0] > 0 && this->Dimensions[1] > 0 && this->Dimensions[2] > 0)
+  {
+    // The chunks are compressed now, because their position in the file is written into the header
+    if (this->CompressChunks() != PLUS_SUCCESS)
+    {
+      LOG_ERROR("Failed to compress the image data of " << this->FileName);
+      return PLUS_FAIL;
+    }
+    writeChunkOffsets = true;
+  }
+
   FILE* stream = NULL;
   // open in binary mode because we determine the start of the image buffer also during this read
   if (FileOpen(&stream, this->TempHeaderFileName.c_str(), "ab+") != PLUS_SUCCESS)
@@ -885,6 +1224,14 @@ PlusStatus vtkPlusMetaImageSequenceIO::AppendImagesToHeader()
       fputs(imgStatusField.c_str(), stream);
       TotalBytesWritten += imgStatusField.length();
     }
+    if (writeChunkOffsets)
+    {
+      std::ostringstream chunkOffsetField;
+      chunkOffsetField << SEQMETA_FIELD_FRAME_FIELD_PREFIX << frameIndexStr.str() << "_" << SEQMETA_FIELD_COMPRESSED_DATA_OFFSET
+                       << " = " << this->CompressedChunkOffsets[adjustedFrameNumber] << "\n";
+      fputs(chunkOffsetField.str().c_str(), stream);
+      TotalBytesWritten += chunkOffsetField.str().length();
+    }
   }
 
   fclose(stream);
@@ -923,8 +1270,13 @@ PlusStatus vtkPlusMetaImageSequenceIO::FinalizeHeader()
 }
 
 //----------------------------------------------------------------------------
-PlusStatus vtkPlusMetaImageSequenceIO::WriteCompressedImagePixelsToFile(int& compressedDataSize)
+PlusStatus vtkPlusMetaImageSequenceIO::WriteCompressedImagePixelsToFile(unsigned long long& compressedDataSize)
 {
+  if (this->CompressedFramesPerChunk > 0)
+  {
+    return this->WriteCompressedChunksToFile(compressedDataSize);
+  }
+
   LOG_DEBUG("Writing compressed pixel data into file started");
 
   compressedDataSize = 0;
@@ -1035,6 +1387,263 @@ PlusStatus vtkPlusMetaImageSequenceIO::WriteCompressedImagePixelsToFile(int& com
   return PLUS_SUCCESS;
 }
 
+//----------------------------------------------------------------------------
+PlusStatus vtkPlusMetaImageSequenceIO::CompressChunks()
+{
+  this->CompressedChunkOffsets.clear();
+  this->CompressedChunksBytesWritten = 0;
+  this->CompressedChunksWritten = false;
+
+  int numberOfFrames = this->TrackedFrameList->GetNumberOfTrackedFrames();
+  if (numberOfFrames == 0)
+  {
+    return PLUS_SUCCESS;
+  }
+
+  if (this->PixelType == VTK_VOID)
+  {
+    // If the pixel type was not defined, define it to UCHAR
+    this->PixelType = VTK_UNSIGNED_CHAR;
+  }
+
+  // Create a blank frame if we have to write an invalid frame to metafile
+  PlusVideoFrame blankFrame;
+  FrameSizeType frameSize = { this->Dimensions[0], this->Dimensions[1], this->Dimensions[2] };
+  if (blankFrame.AllocateFrame(frameSize, this->PixelType, this->NumberOfScalarComponents) != PLUS_SUCCESS)
+  {
+    LOG_ERROR("Failed to allocate space for blank image.");
+    return PLUS_FAIL;
+  }
+  blankFrame.FillBlank();
+
+  // Offsets are relative to the start of the compressed data, which starts with the zlib header
+  unsigned long long chunkOffset = this->CompressedBytesWritten;
+  if (chunkOffset == 0)
+  {
+    unsigned char zlibHeader[sizeof(ZLIB_STREAM_HEADER)];
+    memcpy(zlibHeader, ZLIB_STREAM_HEADER, sizeof(ZLIB_STREAM_HEADER));
+    size_t numberOfBytesWritten = 0;
+    if (PlusCommon::RobustFwrite(this->OutputImageFileHandle, zlibHeader, sizeof(zlibHeader), numberOfBytesWritten) != PLUS_SUCCESS)
+    {
+      LOG_ERROR("Error writing compressed data into file");
+      return PLUS_FAIL;
+    }
+    this->CompressedChunksBytesWritten += numberOfBytesWritten;
+    chunkOffset = sizeof(ZLIB_STREAM_HEADER);
+  }
+
+  CompressChunksInfo info;
+  info.TrackedFrameList = this->TrackedFrameList;
+  info.BlankFrame = &blankFrame;
+  info.EnableImageDataWrite = this->EnableImageDataWrite;
+  info.FramesPerChunk = this->CompressedFramesPerChunk;
+  info.NumberOfChunks = (numberOfFrames + this->CompressedFramesPerChunk - 1) / this->CompressedFramesPerChunk;
+  info.MaxNumberOfChunksInMemory = std::max(1, MAX_NUMBER_OF_CHUNKS_IN_MEMORY_PER_THREAD * this->WorkerPool->GetNumberOfThreads());
+  info.OutputImageFileHandle = this->OutputImageFileHandle;
+  info.NextChunk = 0;
+  info.NextChunkToWrite = 0;
+  info.NextChunkOffset = chunkOffset;
+  info.NumberOfBytesWritten = 0;
+  info.ChunkOffsets = &this->CompressedChunkOffsets;
+  info.Checksum = &this->CompressedChunksChecksum;
+  info.Failed = false;
+  this->WorkerPool->SingleMethodExecute(CompressChunksThreadFunction, &info);
+
+  // Chunks that were written before a failure are counted, so that the written data size remains consistent
+  this->CompressedChunksBytesWritten += info.NumberOfBytesWritten;
+  this->CompressedChunksWritten = true;
+  if (info.Failed)
+  {
+    return PLUS_FAIL;
+  }
+
+  return PLUS_SUCCESS;
+}
+
+//----------------------------------------------------------------------------
+VTK_THREAD_RETURN_TYPE vtkPlusMetaImageSequenceIO::CompressChunksThreadFunction(void* arg)
+{
+  vtkMultiThreader::ThreadInfo* threadInfo = static_cast<vtkMultiThreader::ThreadInfo*>(arg);
+  CompressChunksInfo* info = static_cast<CompressChunksInfo*>(threadInfo->UserData);
+
+  const int outputBufferSize = 16384;
+  unsigned char outputBuffer[outputBufferSize];
+
+  int numberOfFrames = info->TrackedFrameList->GetNumberOfTrackedFrames();
+  while (true)
+  {
+    // Claim the next chunk, but do not get ahead of the writing by more than MaxNumberOfChunksInMemory chunks,
+    // so that the memory used by compressed chunks that wait for being written remains bounded
+    int chunkIndex = 0;
+    {
+      std::unique_lock<std::mutex> lock(info->Mutex);
+      chunkIndex = info->NextChunk++;
+      if (chunkIndex >= info->NumberOfChunks)
+      {
+        break;
+      }
+      info->ChunkWritten.wait(lock, [info, chunkIndex]() { return info->Failed || chunkIndex < info->NextChunkToWrite + info->MaxNumberOfChunksInMemory; });
+      if (info->Failed)
+      {
+        break;
+      }
+    }
+
+    // Raw deflate data (negative window bits), the zlib header and trailer are written only once for all chunks
+    z_stream strm;
+    strm.zalloc = Z_NULL;
+    strm.zfree = Z_NULL;
+    strm.opaque = Z_NULL;
+    int ret = deflateInit2(&strm, Z_DEFAULT_COMPRESSION, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY);
+    if (ret != Z_OK)
+    {
+      LOG_ERROR("Image compression initialization failed (errorCode=" << ret << ")");
+      {
+        std::lock_guard<std::mutex> lock(info->Mutex);
+        info->Failed = true;
+      }
+      info->ChunkWritten.notify_all();
+      break;
+    }
+
+    CompressedChunkData chunk;
+    chunk.Checksum = adler32(0L, Z_NULL, 0);
+    chunk.UncompressedSize = 0;
+    int firstFrameNumber = chunkIndex * info->FramesPerChunk;
+    int lastFrameNumber = std::min(firstFrameNumber + info->FramesPerChunk, numberOfFrames) - 1;
+    chunk.NumberOfFrames = lastFrameNumber - firstFrameNumber + 1;
+    for (int frameNumber = firstFrameNumber; frameNumber <= lastFrameNumber && ret != Z_STREAM_ERROR; frameNumber++)
+    {
+      PlusVideoFrame* videoFrame = info->BlankFrame;
+      if (info->EnableImageDataWrite && info->TrackedFrameList->GetTrackedFrame(frameNumber)->GetImageData()->IsImageValid())
+      {
+        videoFrame = info->TrackedFrameList->GetTrackedFrame(frameNumber)->GetImageData();
+      }
+
+      strm.next_in = (Bytef*)videoFrame->GetScalarPointer();
+      strm.avail_in = videoFrame->GetFrameSizeInBytes();
+      chunk.Checksum = adler32(chunk.Checksum, strm.next_in, strm.avail_in);
+      chunk.UncompressedSize += strm.avail_in;
+
+      // Full flush at the end of the chunk makes the output byte aligned and independent from the other chunks
+      int flush = (frameNumber < lastFrameNumber) ? Z_NO_FLUSH : Z_FULL_FLUSH;
+      do
+      {
+        strm.avail_out = outputBufferSize;
+        strm.next_out = outputBuffer;
+        ret = deflate(&strm, flush);
+        if (ret == Z_STREAM_ERROR)
+        {
+          break;
+        }
+        chunk.Data.insert(chunk.Data.end(), outputBuffer, outputBuffer + (outputBufferSize - strm.avail_out));
+      }
+      while (strm.avail_out == 0);
+    }
+    bool inputConsumed = (strm.avail_in == 0);
+    deflateEnd(&strm);
+
+    bool failed = false;
+    if (ret == Z_STREAM_ERROR || !inputConsumed)
+    {
+      LOG_ERROR("Zlib state became invalid during the compression process (frames " << firstFrameNumber << "-" << lastFrameNumber << ")");
+      failed = true;
+    }
+
+    {
+      std::lock_guard<std::mutex> lock(info->Mutex);
+      if (failed)
+      {
+        info->Failed = true;
+      }
+      else if (!info->Failed)
+      {
+        info->PendingChunks[chunkIndex].swap(chunk);
+
+        // Write the chunks in order, as soon as all the preceding chunks are written
+        std::map<int, CompressedChunkData>::iterator pendingChunkIt = info->PendingChunks.find(info->NextChunkToWrite);
+        while (pendingChunkIt != info->PendingChunks.end())
+        {
+          CompressedChunkData& pendingChunk = pendingChunkIt->second;
+          size_t numberOfBytesWritten = 0;
+          if (!pendingChunk.Data.empty()
+              && PlusCommon::RobustFwrite(info->OutputImageFileHandle, &(pendingChunk.Data[0]), pendingChunk.Data.size(), numberOfBytesWritten) != PLUS_SUCCESS)
+          {
+            LOG_ERROR("Error writing compressed data into file");
+            info->NumberOfBytesWritten += numberOfBytesWritten;
+            info->Failed = true;
+            break;
+          }
+          info->NumberOfBytesWritten += numberOfBytesWritten;
+          info->ChunkOffsets->insert(info->ChunkOffsets->end(), pendingChunk.NumberOfFrames, info->NextChunkOffset);
+          info->NextChunkOffset += pendingChunk.Data.size();
+          *(info->Checksum) = adler32_combine(*(info->Checksum), pendingChunk.Checksum, static_cast<z_off_t>(pendingChunk.UncompressedSize));
+
+          info->PendingChunks.erase(pendingChunkIt);
+          info->NextChunkToWrite++;
+          pendingChunkIt = info->PendingChunks.find(info->NextChunkToWrite);
+        }
+      }
+      failed = info->Failed;
+    }
+    info->ChunkWritten.notify_all();
+    if (failed)
+    {
+      break;
+    }
+  }
+
+  return VTK_THREAD_RETURN_VALUE;
+}
+
+//----------------------------------------------------------------------------
+PlusStatus vtkPlusMetaImageSequenceIO::WriteCompressedChunksToFile(unsigned long long& compressedDataSize)
+{
+  compressedDataSize = 0;
+
+  if (!this->CompressedChunksWritten)
+  {
+    // AppendImagesToHeader has not compressed the frames
+    if (this->CompressChunks() != PLUS_SUCCESS)
+    {
+      compressedDataSize = this->CompressedChunksBytesWritten;
+      this->CompressedChunksBytesWritten = 0;
+      this->CompressedChunksWritten = false;
+      return PLUS_FAIL;
+    }
+  }
+
+  // The chunks are already written to the file by CompressChunks, only the written size is reported here
+  compressedDataSize = this->CompressedChunksBytesWritten;
+  this->CompressedChunksBytesWritten = 0;
+  this->CompressedChunksWritten = false;
+  this->CompressedChunkOffsets.clear();
+  return PLUS_SUCCESS;
+}
+
+//----------------------------------------------------------------------------
+PlusStatus vtkPlusMetaImageSequenceIO::WriteCompressedChunksTrailer()
+{
+  // Terminate the deflate stream and append the Adler-32 checksum of the uncompressed data (most significant byte first)
+  unsigned char trailer[sizeof(DEFLATE_EMPTY_FINAL_BLOCK) + 4];
+  memcpy(trailer, DEFLATE_EMPTY_FINAL_BLOCK, sizeof(DEFLATE_EMPTY_FINAL_BLOCK));
+  for (int i = 0; i < 4; i++)
+  {
+    trailer[sizeof(DEFLATE_EMPTY_FINAL_BLOCK) + i] = static_cast<unsigned char>((this->CompressedChunksChecksum >> (24 - 8 * i)) & 0xFF);
+  }
+
+  size_t numberOfBytesWritten = 0;
+  if (PlusCommon::RobustFwrite(this->OutputImageFileHandle, trailer, sizeof(trailer), numberOfBytesWritten) != PLUS_SUCCESS)
+  {
+    LOG_ERROR("Error writing compressed data into file");
+    return PLUS_FAIL;
+  }
+  this->TotalBytesWritten += numberOfBytesWritten;
+  this->CompressedBytesWritten += numberOfBytesWritten;
+
+  return PLUS_SUCCESS;
+}
+
 //----------------------------------------------------------------------------
 PlusStatus vtkPlusMetaImageSequenceIO::ConvertMetaElementTypeToVtkPixelType(const std::string& elementTypeStr, PlusCommon::VTKScalarPixelType& vtkPixelType)
 {
@@ -1308,6 +1917,13 @@ PlusStatus vtkPlusMetaImageSequenceIO::Close()
   // Update fields that are known only at the end of the processing
   if (this->GetUseCompression())
   {
+    if (this->CompressedFramesPerChunk > 0 && this->CompressedBytesWritten > 0)
+    {
+      if (this->WriteCompressedChunksTrailer() != PLUS_SUCCESS)
+      {
+        return PLUS_FAIL;
+      }
+    }
     std::stringstream ss;
     ss << this->CompressedBytesWritten;
     this->SetCustomString(SEQMETA_FIELD_COMPRESSED_DATA_SIZE, ss.str().c_str());
@@ -16,7 +16,10 @@
 #include "vtkPlusSequenceIOBase.h"
 #include "itk_zlib.h"
 
+#include "vtkMultiThreader.h"
+
 class vtkPlusTrackedFrameList;
+class vtkPlusWorkerPool;
 
 /*!
   \class vtkPlusMetaImageSequenceIO
@@ -34,6 +37,24 @@ public:
   vtkSetMacro(Output2DDataWithZDimensionIncluded, bool);
   vtkGetMacro(Output2DDataWithZDimensionIncluded, bool);
 
+  /*!
+    Number of frames that are compressed into one independently decompressible chunk.
+    If 0 (default) then all frames are compressed into a single stream. If positive, then the chunks
+    are compressed in parallel and the position of each frame's chunk is stored in the frame fields,
+    which allows reading a range of frames by decompressing only the chunks that contain them.
+    The compressed pixel data remains a single valid zlib stream, so the file can be read by any MetaImage reader.
+    Must not be changed while a file is being written.
+  */
+  vtkSetMacro(CompressedFramesPerChunk, int);
+  vtkGetMacro(CompressedFramesPerChunk, int);
+
+  /*!
+    Read the header and the pixel data of the frames in the [firstFrameNumber, lastFrameNumber] range.
+    Only the frames in the range are kept in the tracked frame list. If the file was written with
+    CompressedFramesPerChunk>0 then only the chunks containing the requested frames are decompressed.
+  */
+  PlusStatus ReadFrames(int firstFrameNumber, int lastFrameNumber);
+
   /*! Update the number of frames in the header
       This is used primarily by vtkPlusVirtualCapture to update the final tally of frames, as it continually appends new frames to the file
       /param numberOfFrames the new number of frames to write
@@ -84,6 +105,12 @@ protected:
   /*! Read pixel data from the metaimage */
   virtual PlusStatus ReadImagePixels();
 
+  /*! Read pixel data of the frames in the [firstFrameNumber, lastFrameNumber] range */
+  PlusStatus ReadImagePixelsInRange(int firstFrameNumber, int lastFrameNumber);
+
+  /*! Decompress the chunks that contain the frames in the [firstFrameNumber, lastFrameNumber] range */
+  PlusStatus ReadCompressedChunks(int firstFrameNumber, int lastFrameNumber, const std::vector<long long>& chunkOffsets, unsigned long long compressedDataSize, const PlusVideoFrame::FlipInfoType& flipInfo);
+
   /*! Prepare the image file for writing */
   virtual PlusStatus PrepareImageFile();
 
@@ -96,7 +123,30 @@ protected:
     \param aFilename the file where the compressed pixel data will be written to
     \param compressedDataSize returns the size of the total compressed data that is written to the file.
   */
-  virtual PlusStatus WriteCompressedImagePixelsToFile(int& compressedDataSize);
+  virtual PlusStatus WriteCompressedImagePixelsToFile(unsigned long long& compressedDataSize);
+
+  /*!
+    Compress the frames of the tracked frame list into independent chunks (CompressedFramesPerChunk frames each)
+    and write them into the image file. The zlib header is written before the first chunk of the file.
+    Chunks are compressed in parallel and written in order as soon as they are complete; compression is paused
+    when too many chunks wait for being written, so only a few chunks are kept in memory at a time.
+  */
+  PlusStatus CompressChunks();
+
+  /*!
+    Write the compressed chunks into file (compress them now if CompressChunks has not been called yet).
+    \param compressedDataSize returns the number of bytes written to the file.
+  */
+  PlusStatus WriteCompressedChunksToFile(unsigned long long& compressedDataSize);
+
+  /*! Write the end of the zlib stream that was built from chunks */
+  PlusStatus WriteCompressedChunksTrailer();
+
+  /*! Compresses chunks on a worker thread */
+  static VTK_THREAD_RETURN_TYPE CompressChunksThreadFunction(void* arg);
+
+  /*! Decompresses chunks on a worker thread */
+  static VTK_THREAD_RETURN_TYPE DecompressChunksThreadFunction(void* arg);
 
   /*! Conversion between ITK and METAIO pixel types */
   PlusStatus ConvertMetaElementTypeToVtkPixelType(const std::string& elementTypeStr, PlusCommon::VTKScalarPixelType& vtkPixelType);
@@ -110,6 +160,18 @@ private:
   bool Output2DDataWithZDimensionIncluded;
   /*! compression stream handle for compression streaming */
   z_stream CompressionStream;
+  /*! Number of frames in an independently compressed chunk, 0 if all frames are compressed into a single stream */
+  int CompressedFramesPerChunk;
+  /*! Number of bytes that CompressChunks has written to the image file for the current tracked frame list */
+  unsigned long long CompressedChunksBytesWritten;
+  /*! True if the chunks of the current tracked frame list have been compressed and written to file */
+  bool CompressedChunksWritten;
+  /*! Offset of each frame's chunk from the start of the compressed data, for the current tracked frame list */
+  std::vector<unsigned long long> CompressedChunkOffsets;
+  /*! Adler-32 checksum of all the uncompressed pixel data written in chunks */
+  uLong CompressedChunksChecksum;
+  /*! Threads for compressing and decompressing chunks */
+  vtkPlusWorkerPool* WorkerPool;
 
 protected:
   vtkPlusMetaImageSequenceIO(const vtkPlusMetaImageSequenceIO&); //purposely not implemented
@@ -459,7 +459,7 @@ PlusStatus vtkPlusMkvSequenceIO::Close()
 }
 
 //----------------------------------------------------------------------------
-PlusStatus vtkPlusMkvSequenceIO::WriteCompressedImagePixelsToFile(int& compressedDataSize)
+PlusStatus vtkPlusMkvSequenceIO::WriteCompressedImagePixelsToFile(unsigned long long& compressedDataSize)
 {
   return this->WriteImages();
 }
@@ -93,7 +93,7 @@ protected:
     \param aFilename the file where the compressed pixel data will be written to
     \param compressedDataSize returns the size of the total compressed data that is written to the file.
   */
-  virtual PlusStatus WriteCompressedImagePixelsToFile(int& compressedDataSize);
+  virtual PlusStatus WriteCompressedImagePixelsToFile(unsigned long long& compressedDataSize);
 
 public:
   void SetEncodingFourCC(std::string encodingFourCC);
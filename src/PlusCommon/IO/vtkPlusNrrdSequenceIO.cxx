@@ -369,6 +369,16 @@ PlusStatus vtkPlusNrrdSequenceIO::ReadImagePixels()
     return PLUS_SUCCESS;
   }
 
+  if (this->LazyImageLoading)
+  {
+    if (!this->UseCompression)
+    {
+      // Pixel data is read from the file when the image data of the frames is accessed
+      return this->SetUpLazyImageLoading(0, frameCount - 1, SEQUENCE_FIELD_IMG_STATUS);
+    }
+    LOG_INFO("Lazy image loading is not available for compressed pixel data, reading all frames of " << this->FileName);
+  }
+
   int numberOfErrors = 0;
 
   FILE* stream = NULL;
@@ -868,7 +878,7 @@ PlusStatus vtkPlusNrrdSequenceIO::Close()
 }
 
 //----------------------------------------------------------------------------
-PlusStatus vtkPlusNrrdSequenceIO::WriteCompressedImagePixelsToFile(int& compressedDataSize)
+PlusStatus vtkPlusNrrdSequenceIO::WriteCompressedImagePixelsToFile(unsigned long long& compressedDataSize)
 {
   LOG_DEBUG("Writing compressed pixel data into file started");
 
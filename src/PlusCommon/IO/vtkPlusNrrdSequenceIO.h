@@ -107,7 +107,7 @@ protected:
     The compression is performed in chunks, so no excessive memory is used for the compression.
     \param compressedDataSize returns the size of the total compressed data that is written to the file.
   */
-  virtual PlusStatus WriteCompressedImagePixelsToFile( int& compressedDataSize );
+  virtual PlusStatus WriteCompressedImagePixelsToFile( unsigned long long& compressedDataSize );
 
   /*! Conversion between ITK and METAIO pixel types */
   PlusStatus ConvertNrrdTypeToVtkPixelType( const std::string& elementTypeStr, PlusCommon::VTKScalarPixelType& vtkPixelType );
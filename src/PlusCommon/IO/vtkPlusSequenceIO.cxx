@@ -111,6 +111,43 @@ PlusStatus vtkPlusSequenceIO::Read(const std::string& filename, vtkPlusTrackedFr
   return PLUS_FAIL;
 }
 
+//----------------------------------------------------------------------------
+PlusStatus vtkPlusSequenceIO::ReadLazily(const std::string& filename, vtkPlusTrackedFrameList* frameList, int maximumNumberOfResidentFrames/*=100*/)
+{
+  if (!vtksys::SystemTools::FileExists(filename.c_str()))
+  {
+    LOG_ERROR("File: " << filename << " does not exist.");
+    return PLUS_FAIL;
+  }
+
+  vtkSmartPointer<vtkPlusSequenceIOBase> reader;
+  if (vtkPlusMetaImageSequenceIO::CanReadFile(filename))
+  {
+    reader = vtkSmartPointer<vtkPlusMetaImageSequenceIO>::New();
+  }
+  else if (vtkPlusNrrdSequenceIO::CanReadFile(filename))
+  {
+    reader = vtkSmartPointer<vtkPlusNrrdSequenceIO>::New();
+  }
+  else
+  {
+    // Lazy loading is not supported for this format
+    return vtkPlusSequenceIO::Read(filename, frameList);
+  }
+
+  reader->SetFileName(filename);
+  reader->SetTrackedFrameList(frameList);
+  reader->LazyImageLoadingOn();
+  reader->SetMaximumNumberOfResidentFrames(maximumNumberOfResidentFrames);
+  if (reader->Read() != PLUS_SUCCESS)
+  {
+    LOG_ERROR("Failed to read sequence file: " << filename);
+    return PLUS_FAIL;
+  }
+
+  return PLUS_SUCCESS;
+}
+
 //----------------------------------------------------------------------------
 vtkPlusSequenceIOBase* vtkPlusSequenceIO::CreateSequenceHandlerForFile(const std::string& filename)
 {
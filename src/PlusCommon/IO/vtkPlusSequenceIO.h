@@ -28,6 +28,13 @@ public:
   /*! Read file contents into the object */
   static PlusStatus Read(const std::string& filename, vtkPlusTrackedFrameList* frameList);
 
+  /*!
+    Read file contents into the object, but read the pixel data of uncompressed MetaImage and NRRD files only
+    when the image data of a frame is accessed, keeping at most maximumNumberOfResidentFrames frames in memory.
+    Other files are read entirely.
+  */
+  static PlusStatus ReadLazily(const std::string& filename, vtkPlusTrackedFrameList* frameList, int maximumNumberOfResidentFrames = 100);
+
   /*! Create a handler for a given filetype */
   static vtkPlusSequenceIOBase* CreateSequenceHandlerForFile(const std::string& filename);
 
@@ -6,11 +6,15 @@ See License.txt for details.
 
 #include "PlusConfigure.h"
 #include "vtkObjectFactory.h"
+#include "vtkPlusLazyFrameLoader.h"
 #include "vtkPlusSequenceIOBase.h"
 #include "vtkPlusTrackedFrameList.h"
 #include "vtksys/SystemTools.hxx"
 #include "PlusTrackedFrame.h"
 
+// STL includes
+#include <limits>
+
 #if _WIN32
   #include <errno.h>
 
@@ -31,6 +35,8 @@ vtkPlusSequenceIOBase::vtkPlusSequenceIOBase()
   , UseCompression(false)
   , CompressedBytesWritten(0)
   , EnableImageDataWrite(true)
+  , LazyImageLoading(false)
+  , MaximumNumberOfResidentFrames(100)
   , PixelType(VTK_VOID)
   , NumberOfScalarComponents(1)
   , IsDataTimeSeries(true)
@@ -186,6 +192,43 @@ void vtkPlusSequenceIOBase::CreateTrackedFrameIfNonExisting(unsigned int frameNu
   }
 }
 
+//----------------------------------------------------------------------------
+PlusStatus vtkPlusSequenceIOBase::SetUpLazyImageLoading(int firstFrameNumber, int lastFrameNumber, const std::string& imageStatusFieldName)
+{
+  FrameSizeType frameSize = { this->Dimensions[0], this->Dimensions[1], this->Dimensions[2] };
+  vtkSmartPointer<vtkPlusLazyFrameLoader> loader = vtkSmartPointer<vtkPlusLazyFrameLoader>::New();
+  loader->SetMaximumNumberOfResidentFrames(this->MaximumNumberOfResidentFrames);
+  if (loader->Open(this->GetPixelDataFilePath(), this->PixelDataFileOffset, frameSize, this->PixelType, this->NumberOfScalarComponents,
+                   this->ImageType, this->ImageOrientationInFile, this->ImageOrientationInMemory) != PLUS_SUCCESS)
+  {
+    LOG_ERROR("Failed to set up lazy image loading from " << this->GetPixelDataFilePath());
+    return PLUS_FAIL;
+  }
+
+  for (int frameNumber = firstFrameNumber; frameNumber <= lastFrameNumber; frameNumber++)
+  {
+    this->CreateTrackedFrameIfNonExisting(frameNumber);
+    PlusTrackedFrame* trackedFrame = this->TrackedFrameList->GetTrackedFrame(frameNumber);
+
+    // Frames with invalid image status remain without image data, the same way as when all the pixel data is read
+    const char* imgStatus = trackedFrame->GetFrameField(imageStatusFieldName);
+    if (imgStatus != NULL)
+    {
+      bool imageStatusOk = PlusCommon::IsEqualInsensitive(std::string(imgStatus), "OK");
+      trackedFrame->DeleteFrameField(imageStatusFieldName.c_str());
+      if (!imageStatusOk)
+      {
+        LOG_DEBUG("Frame #" << frameNumber << " image data is invalid, no need to load it.");
+        continue;
+      }
+    }
+
+    trackedFrame->SetImageDataLoader(loader, frameNumber);
+  }
+
+  return PLUS_SUCCESS;
+}
+
 //----------------------------------------------------------------------------
 PlusStatus vtkPlusSequenceIOBase::PrepareHeader()
 {
@@ -380,7 +423,7 @@ PlusStatus vtkPlusSequenceIOBase::WriteImages()
   else
   {
     // compressed
-    int compressedDataSize = 0;
+    unsigned long long compressedDataSize = 0;
     if (imageDataAvailable)
     {
       result = WriteCompressedImagePixelsToFile(compressedDataSize);
@@ -399,6 +442,21 @@ PlusStatus vtkPlusSequenceIOBase::WriteImages()
   return result;
 }
 
+//----------------------------------------------------------------------------
+PlusStatus vtkPlusSequenceIOBase::WriteCompressedImagePixelsToFile(int& compressedDataSize)
+{
+  unsigned long long compressedDataSizeLong = 0;
+  PlusStatus result = this->WriteCompressedImagePixelsToFile(compressedDataSizeLong);
+  if (compressedDataSizeLong > static_cast<unsigned long long>(std::numeric_limits<int>::max()))
+  {
+    LOG_ERROR("Compressed data size (" << compressedDataSizeLong << " bytes) does not fit into an int, use WriteCompressedImagePixelsToFile(unsigned long long&) instead");
+    compressedDataSize = std::numeric_limits<int>::max();
+    return PLUS_FAIL;
+  }
+  compressedDataSize = static_cast<int>(compressedDataSizeLong);
+  return result;
+}
+
 //----------------------------------------------------------------------------
 PlusStatus vtkPlusSequenceIOBase::MoveFileInternal(const char* oldname, const char* newname)
 {
@@ -468,6 +526,7 @@ PlusStatus vtkPlusSequenceIOBase::Discard()
 
   this->CurrentFrameOffset = 0;
   this->TotalBytesWritten = 0;
+  this->CompressedBytesWritten = 0;
 
   return PLUS_SUCCESS;
 }
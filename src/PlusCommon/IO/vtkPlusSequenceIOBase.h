@@ -136,6 +136,22 @@ public:
   /*! Flag to enable/disable writing of image data */
   vtkBooleanMacro(EnableImageDataWrite, bool);
 
+  /*!
+    If enabled then Read() only reads the header and the frame fields of uncompressed files. The pixel data of a frame is read
+    from the file when its image data is first accessed, and only the most recently accessed MaximumNumberOfResidentFrames frames
+    are kept in memory (see vtkPlusLazyFrameLoader). The pixel data of compressed files is always read entirely.
+  */
+  vtkGetMacro(LazyImageLoading, bool);
+  /*! Flag to enable/disable lazy loading of image data */
+  vtkSetMacro(LazyImageLoading, bool);
+  /*! Flag to enable/disable lazy loading of image data */
+  vtkBooleanMacro(LazyImageLoading, bool);
+
+  /*! Maximum number of frames whose image data is kept in memory when lazy image loading is enabled */
+  vtkGetMacro(MaximumNumberOfResidentFrames, int);
+  /*! Maximum number of frames whose image data is kept in memory when lazy image loading is enabled */
+  vtkSetMacro(MaximumNumberOfResidentFrames, int);
+
 protected:
   /*! Read all the fields in the image file header */
   virtual PlusStatus ReadImageHeader() = 0;
@@ -160,7 +176,13 @@ protected:
     The compression is performed in chunks, so no excessive memory is used for the compression.
     \param compressedDataSize returns the size of the total compressed data that is written to the file.
   */
-  virtual PlusStatus WriteCompressedImagePixelsToFile(int& compressedDataSize) = 0;
+  virtual PlusStatus WriteCompressedImagePixelsToFile(unsigned long long& compressedDataSize) = 0;
+
+  /*!
+    DEPRECATED: use WriteCompressedImagePixelsToFile(unsigned long long&) instead, the compressed data may be larger than 2GB.
+    Subclasses must implement the unsigned long long version, this overload only forwards to it.
+  */
+  PlusStatus WriteCompressedImagePixelsToFile(int& compressedDataSize);
 
   /*! Opens a file. Doesn't log error if it fails because it may be expected. */
   static PlusStatus FileOpen(FILE** stream, const char* filename, const char* flags);
@@ -192,6 +214,13 @@ protected:
   */
   virtual void CreateTrackedFrameIfNonExisting(unsigned int frameNumber);
 
+  /*!
+    Assign an image data loader to the frames in the range instead of reading their pixel data.
+    The pixel data must be stored uncompressed, frame after frame, starting at PixelDataFileOffset.
+    \param imageStatusFieldName Name of the frame field that marks frames without valid image data
+  */
+  PlusStatus SetUpLazyImageLoading(int firstFrameNumber, int lastFrameNumber, const std::string& imageStatusFieldName);
+
 protected:
 #ifdef _WIN32
   typedef __int64 FilePositionOffsetType;
@@ -216,6 +245,10 @@ protected:
   unsigned long long CompressedBytesWritten;
   /*! Whether to enable pixel writing */
   bool EnableImageDataWrite;
+  /*! Read the pixel data of uncompressed files on first access */
+  bool LazyImageLoading;
+  /*! Maximum number of frames kept in memory in lazy image loading mode */
+  int MaximumNumberOfResidentFrames;
   /*! Integer/float, short/long, signed/unsigned */
   PlusCommon::VTKScalarPixelType PixelType;
   /*! Number of components (or channels) */
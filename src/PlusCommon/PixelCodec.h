@@ -8,6 +8,7 @@ See License.txt for details.
 #define __PixelCodec_h
 
 #include "PlusConfigure.h"
+#include "PlusPixelKernels.h"
 
 #include <iomanip>
 
@@ -292,7 +293,10 @@ public:
   static inline void Rgb24ToGray(int width, int height, unsigned char* s, unsigned char* d)
   {
     int totalLen = width * height;
-    for (int i = 0; i < totalLen; i++)
+    int numberOfVectorizedPixels = PlusPixelKernels::Rgb24ToGray(totalLen, s, d);
+    s += 3 * numberOfVectorizedPixels;
+    d += numberOfVectorizedPixels;
+    for (int i = numberOfVectorizedPixels; i < totalLen; i++)
     {
       *d = ((unsigned short)(s[0]) + s[1] + s[2]) / 3;
       d++;
@@ -309,7 +313,10 @@ public:
   static inline void Rgba32ToGray(int width, int height, unsigned char* s, unsigned char* d)
   {
     int totalLen = width * height;
-    for (int i = 0; i < totalLen; i++)
+    int numberOfVectorizedPixels = PlusPixelKernels::Rgba32ToGray(totalLen, s, d);
+    s += 4 * numberOfVectorizedPixels;
+    d += numberOfVectorizedPixels;
+    for (int i = numberOfVectorizedPixels; i < totalLen; i++)
     {
       *d = ((unsigned short)(s[0]) + s[1] + s[2]) / 3;
       d++;
@@ -387,12 +394,15 @@ public:
     p_dest = d;
 
     int size = height * (width / 2);
-    unsigned long srcIndex = 0;
-    unsigned long dstIndex = 0;
+
+    // Pixel pairs that fill whole vectors are converted by the vectorized kernel, the rest by the loops below
+    int numberOfVectorizedPairs = PlusPixelKernels::Yuy2ToBmp24(outputOrdering == ComponentOrder_BGR, size, s, d);
+    unsigned long srcIndex = 4 * numberOfVectorizedPairs;
+    unsigned long dstIndex = 6 * numberOfVectorizedPairs;
 
     if (outputOrdering == ComponentOrder_BGR)
     {
-      for (int i = 0 ; i < size ; i++)
+      for (int i = numberOfVectorizedPairs ; i < size ; i++)
       {
         y1 = s[srcIndex];
         u = s[srcIndex + 1];
@@ -428,7 +438,7 @@ public:
     }
     else
     {
-      for (int i = 0 ; i < size ; i++)
+      for (int i = numberOfVectorizedPairs ; i < size ; i++)
       {
         y1 = s[srcIndex];
         u = s[srcIndex + 1];
@@ -483,10 +493,13 @@ public:
     p_dest = d;
 
     int size = height * (width / 2);
-    unsigned long srcIndex = 0;
-    unsigned long dstIndex = 0;
 
-    for (i = 0 ; i < size ; i++)
+    // Pixel pairs that fill whole vectors are converted by the vectorized kernel, the rest by the loop below
+    int numberOfVectorizedPairs = PlusPixelKernels::Yuy2ToGray(size, s, d);
+    unsigned long srcIndex = 4 * numberOfVectorizedPairs;
+    unsigned long dstIndex = 2 * numberOfVectorizedPairs;
+
+    for (i = numberOfVectorizedPairs ; i < size ; i++)
     {
       y1 = s[srcIndex];
       u = s[srcIndex + 1];
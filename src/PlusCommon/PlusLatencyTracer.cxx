@@ -0,0 +1,203 @@
+/*=Plus=header=begin======================================================
+  Program: Plus
+  Copyright (c) Laboratory for Percutaneous Surgery. All rights reserved.
+  See License.txt for details.
+=========================================================Plus=header=end*/
+
+#include "PlusConfigure.h"
+#include "PlusLatencyTracer.h"
+#include "vtkPlusAccurateTimer.h"
+
+// STL includes
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <sstream>
+
+namespace
+{
+  // Upper limit of the first histogram bin
+  const double HISTOGRAM_MIN_LATENCY_SEC = 10e-6;
+  const int HISTOGRAM_BINS_PER_OCTAVE = 8;
+  // 20 octaves above the minimum: about 10 sec
+  const int HISTOGRAM_NUMBER_OF_BINS = 20 * HISTOGRAM_BINS_PER_OCTAVE;
+
+  const double DEFAULT_LOG_INTERVAL_SEC = 10.0;
+}
+
+std::atomic<bool> PlusLatencyTracer::Enabled(false);
+
+//----------------------------------------------------------------------------
+PlusLatencyTracer::Histogram::Histogram()
+  : BinCounts(HISTOGRAM_NUMBER_OF_BINS, 0)
+  , NumberOfFrames(0)
+  , MaximumSec(0.0)
+{
+}
+
+//----------------------------------------------------------------------------
+PlusLatencyTracer::PlusLatencyTracer()
+  : LogIntervalSec(DEFAULT_LOG_INTERVAL_SEC)
+  , LastLogTime(0.0)
+{
+}
+
+//----------------------------------------------------------------------------
+PlusLatencyTracer* PlusLatencyTracer::GetInstance()
+{
+  static PlusLatencyTracer instance;
+  return &instance;
+}
+
+//----------------------------------------------------------------------------
+void PlusLatencyTracer::SetEnabled(bool enabled)
+{
+  {
+    std::lock_guard<std::mutex> lock(this->Mutex);
+    this->LastLogTime = vtkPlusAccurateTimer::GetSystemTime();
+  }
+  Enabled.store(enabled, std::memory_order_relaxed);
+  LOG_INFO("Latency tracing " << (enabled ? "enabled" : "disabled"));
+}
+
+//----------------------------------------------------------------------------
+void PlusLatencyTracer::RecordLatency(TraceStage stage, const std::string& sourceName, double acquisitionTime, double stageTime)
+{
+  double latencySec = stageTime - acquisitionTime;
+  bool logNow = false;
+  {
+    std::lock_guard<std::mutex> lock(this->Mutex);
+    Histogram& histogram = this->Histograms[std::make_pair(sourceName, static_cast<int>(stage))];
+    histogram.BinCounts[GetBinIndex(latencySec)]++;
+    histogram.NumberOfFrames++;
+    histogram.MaximumSec = std::max(histogram.MaximumSec, latencySec);
+
+    if (this->LogIntervalSec > 0 && stageTime - this->LastLogTime >= this->LogIntervalSec)
+    {
+      this->LastLogTime = stageTime;
+      logNow = true;
+    }
+  }
+
+  if (logNow)
+  {
+    LOG_INFO("Frame latency: " << this->GetLatencyReport());
+  }
+}
+
+//----------------------------------------------------------------------------
+void PlusLatencyTracer::GetLatencyStatistics(std::vector<LatencyStatistics>& statistics)
+{
+  statistics.clear();
+  std::lock_guard<std::mutex> lock(this->Mutex);
+  for (HistogramMapType::const_iterator it = this->Histograms.begin(); it != this->Histograms.end(); ++it)
+  {
+    LatencyStatistics stageStatistics;
+    stageStatistics.SourceName = it->first.first;
+    stageStatistics.Stage = static_cast<TraceStage>(it->first.second);
+    stageStatistics.NumberOfFrames = it->second.NumberOfFrames;
+    stageStatistics.MedianSec = GetPercentile(it->second, 0.5);
+    stageStatistics.Percentile99Sec = GetPercentile(it->second, 0.99);
+    stageStatistics.MaximumSec = it->second.MaximumSec;
+    statistics.push_back(stageStatistics);
+  }
+}
+
+//----------------------------------------------------------------------------
+std::string PlusLatencyTracer::GetLatencyReport()
+{
+  std::vector<LatencyStatistics> statistics;
+  this->GetLatencyStatistics(statistics);
+  if (statistics.empty())
+  {
+    return "no frames recorded";
+  }
+
+  std::ostringstream report;
+  report << std::fixed << std::setprecision(1);
+  for (std::vector<LatencyStatistics>::iterator it = statistics.begin(); it != statistics.end(); ++it)
+  {
+    if (it != statistics.begin())
+    {
+      report << "; ";
+    }
+    report << it->SourceName << " " << GetStageName(it->Stage)
+           << ": p50=" << it->MedianSec * 1000.0
+           << " p99=" << it->Percentile99Sec * 1000.0
+           << " max=" << it->MaximumSec * 1000.0
+           << "ms (n=" << it->NumberOfFrames << ")";
+  }
+  return report.str();
+}
+
+//----------------------------------------------------------------------------
+void PlusLatencyTracer::Reset()
+{
+  std::lock_guard<std::mutex> lock(this->Mutex);
+  this->Histograms.clear();
+}
+
+//----------------------------------------------------------------------------
+void PlusLatencyTracer::SetLogIntervalSec(double logIntervalSec)
+{
+  std::lock_guard<std::mutex> lock(this->Mutex);
+  this->LogIntervalSec = logIntervalSec;
+}
+
+//----------------------------------------------------------------------------
+double PlusLatencyTracer::GetLogIntervalSec()
+{
+  std::lock_guard<std::mutex> lock(this->Mutex);
+  return this->LogIntervalSec;
+}
+
+//----------------------------------------------------------------------------
+const char* PlusLatencyTracer::GetStageName(TraceStage stage)
+{
+  switch (stage)
+  {
+    case STAGE_ACQUIRED:
+      return "acquired";
+    case STAGE_BUFFERED:
+      return "buffered";
+    case STAGE_CHANNEL_READ:
+      return "channel read";
+    case STAGE_BROADCAST:
+      return "broadcast";
+    default:
+      return "unknown";
+  }
+}
+
+//----------------------------------------------------------------------------
+int PlusLatencyTracer::GetBinIndex(double latencySec)
+{
+  if (latencySec <= HISTOGRAM_MIN_LATENCY_SEC)
+  {
+    return 0;
+  }
+  int binIndex = static_cast<int>(std::floor(HISTOGRAM_BINS_PER_OCTAVE * std::log2(latencySec / HISTOGRAM_MIN_LATENCY_SEC))) + 1;
+  return std::min(binIndex, HISTOGRAM_NUMBER_OF_BINS - 1);
+}
+
+//----------------------------------------------------------------------------
+double PlusLatencyTracer::GetPercentile(const Histogram& histogram, double fraction)
+{
+  if (histogram.NumberOfFrames == 0)
+  {
+    return 0.0;
+  }
+  unsigned long requiredCount = static_cast<unsigned long>(std::ceil(fraction * histogram.NumberOfFrames));
+  unsigned long cumulativeCount = 0;
+  for (int binIndex = 0; binIndex < HISTOGRAM_NUMBER_OF_BINS; ++binIndex)
+  {
+    cumulativeCount += histogram.BinCounts[binIndex];
+    if (cumulativeCount >= requiredCount && binIndex < HISTOGRAM_NUMBER_OF_BINS - 1)
+    {
+      // Upper limit of the bin, but never more than the largest recorded value
+      double binUpperLimitSec = HISTOGRAM_MIN_LATENCY_SEC * std::pow(2.0, static_cast<double>(binIndex) / HISTOGRAM_BINS_PER_OCTAVE);
+      return std::min(binUpperLimitSec, histogram.MaximumSec);
+    }
+  }
+  return histogram.MaximumSec;
+}
@@ -0,0 +1,128 @@
+/*=Plus=header=begin======================================================
+  Program: Plus
+  Copyright (c) Laboratory for Percutaneous Surgery. All rights reserved.
+  See License.txt for details.
+=========================================================Plus=header=end*/
+
+#ifndef __PlusLatencyTracer_h
+#define __PlusLatencyTracer_h
+
+#include "vtkPlusCommonExport.h"
+
+// STL includes
+#include <atomic>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/*!
+  \class PlusLatencyTracer
+  \brief Collects per-frame latency statistics along the data flow, from acquisition to broadcasting
+
+  Frames are stamped with the system time when they reach each stage (added to the buffer of a data source,
+  read from a channel, sent by the OpenIGTLink server). The latency of a frame at a stage is the time elapsed
+  between the acquisition of the frame (its unfiltered timestamp) and the time when the frame reached the stage.
+  Virtual devices keep the timestamp of their input frames, so the latency of their output includes the
+  latency of their inputs.
+
+  Latencies are aggregated into histograms for each stage and source (data source or channel). The histograms
+  have logarithmic bins (8 bins per octave, from 10us to about 10s), which provide the median, 99th percentile,
+  and maximum latency with about 10% resolution using a small, fixed amount of memory.
+
+  Tracing is disabled by default. When disabled, each instrumentation point only checks an atomic flag.
+  A summary line is logged periodically while tracing is enabled.
+
+  \ingroup PlusLibCommon
+*/
+class vtkPlusCommonExport PlusLatencyTracer
+{
+public:
+  enum TraceStage
+  {
+    STAGE_ACQUIRED = 0, /*!< The frame was acquired by the device (unfiltered timestamp of the frame) */
+    STAGE_BUFFERED,     /*!< The frame was added to the buffer of a data source */
+    STAGE_CHANNEL_READ, /*!< The frame was read from a channel (by a virtual device, the server, etc.) */
+    STAGE_BROADCAST,    /*!< All the messages of the frame were sent to a client by the OpenIGTLink server (recorded for each client) */
+    NUMBER_OF_STAGES
+  };
+
+  /*! Latency statistics of a stage of one source */
+  struct LatencyStatistics
+  {
+    std::string SourceName;
+    TraceStage Stage;
+    unsigned long NumberOfFrames;
+    double MedianSec;
+    double Percentile99Sec;
+    double MaximumSec;
+  };
+
+  /*! Get the single instance of the tracer */
+  static PlusLatencyTracer* GetInstance();
+
+  /*! Returns true if tracing is enabled. This is cheap, it can be called for every frame. */
+  static bool IsEnabled() { return Enabled.load(std::memory_order_relaxed); }
+
+  /*! Enable or disable tracing. Collected statistics are kept, use Reset() to clear them. */
+  void SetEnabled(bool enabled);
+
+  /*!
+    Record that a frame of a source reached a stage
+    \param stage The stage that the frame reached
+    \param sourceName Name of the data source or channel that the frame belongs to
+    \param acquisitionTime System time when the frame was acquired
+    \param stageTime System time when the frame reached the stage
+  */
+  void RecordLatency(TraceStage stage, const std::string& sourceName, double acquisitionTime, double stageTime);
+
+  /*! Get the latency statistics of all the stages and sources that have recorded frames */
+  void GetLatencyStatistics(std::vector<LatencyStatistics>& statistics);
+
+  /*! Get the latency statistics as a single line of text */
+  std::string GetLatencyReport();
+
+  /*! Clear all collected statistics */
+  void Reset();
+
+  /*! Set the time between logging the latency statistics. No statistics are logged if the interval is not positive. */
+  void SetLogIntervalSec(double logIntervalSec);
+  double GetLogIntervalSec();
+
+  /*! Get the human readable name of a stage */
+  static const char* GetStageName(TraceStage stage);
+
+protected:
+  PlusLatencyTracer();
+
+  /*! Latency histogram of a stage of one source */
+  struct Histogram
+  {
+    Histogram();
+    std::vector<unsigned long> BinCounts;
+    unsigned long NumberOfFrames;
+    double MaximumSec;
+  };
+
+  /*! Get the bin index of a latency value */
+  static int GetBinIndex(double latencySec);
+
+  /*! Get the latency that is not exceeded by the given fraction of the frames, based on the histogram */
+  static double GetPercentile(const Histogram& histogram, double fraction);
+
+  typedef std::map<std::pair<std::string, int>, Histogram> HistogramMapType;
+
+  static std::atomic<bool> Enabled;
+
+  /*! Protects all the members below */
+  std::mutex Mutex;
+  HistogramMapType Histograms;
+  double LogIntervalSec;
+  double LastLogTime;
+
+private:
+  PlusLatencyTracer(const PlusLatencyTracer&);  // Not implemented.
+  void operator=(const PlusLatencyTracer&);  // Not implemented.
+};
+
+#endif
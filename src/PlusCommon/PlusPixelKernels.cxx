@@ -0,0 +1,809 @@
+/*=Plus=header=begin======================================================
+  Program: Plus
+  Copyright (c) Laboratory for Percutaneous Surgery. All rights reserved.
+  See License.txt for details.
+=========================================================Plus=header=end*/
+
+#include "PlusConfigure.h"
+#include "PlusPixelKernels.h"
+
+// STL includes
+#include <algorithm>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+  #define PLUS_PIXEL_KERNELS_X86
+  #include <immintrin.h>
+  #if defined(_MSC_VER)
+    #include <intrin.h>
+  #endif
+  // MSVC allows using any intrinsics without compiler flags, GCC and Clang need the instruction set enabled for each function
+  #if defined(_MSC_VER) && !defined(__clang__)
+    #define PLUS_TARGET_SSE2
+    #define PLUS_TARGET_AVX2
+  #else
+    #define PLUS_TARGET_SSE2 __attribute__((target("sse2")))
+    #define PLUS_TARGET_AVX2 __attribute__((target("avx2")))
+  #endif
+#endif
+
+namespace
+{
+  PlusPixelKernels::InstructionSet MaximumInstructionSet = PlusPixelKernels::INSTRUCTION_SET_AVX2;
+
+  // Same fixed point constants as in the YUY2 conversion macros of PixelCodec
+  const int FIXNUM_SHIFT = 16;
+  const float YUV_R_V = static_cast<float>(static_cast<int>(1.402 * (1 << FIXNUM_SHIFT)));
+  const float YUV_G_U = static_cast<float>(static_cast<int>(-0.344 * (1 << FIXNUM_SHIFT)));
+  const float YUV_G_V = static_cast<float>(static_cast<int>(-0.714 * (1 << FIXNUM_SHIFT)));
+  // 1.772 * 65536 does not fit into the float mantissa when multiplied by U, so it is split into 65536 + remainder
+  const float YUV_B_U_REMAINDER = static_cast<float>(static_cast<int>(1.772 * (1 << FIXNUM_SHIFT)) - (1 << FIXNUM_SHIFT));
+
+  //----------------------------------------------------------------------------
+  template<int BytesPerPixel>
+  struct PixelBytes
+  {
+    unsigned char Bytes[BytesPerPixel];
+  };
+
+  //----------------------------------------------------------------------------
+  template<int BytesPerPixel>
+  void ReverseRowScalar(const unsigned char* input, unsigned char* output, int numberOfPixels)
+  {
+    const PixelBytes<BytesPerPixel>* inputPixel = reinterpret_cast<const PixelBytes<BytesPerPixel>*>(input);
+    PixelBytes<BytesPerPixel>* outputPixel = reinterpret_cast<PixelBytes<BytesPerPixel>*>(output) + numberOfPixels - 1;
+    for (int i = 0; i < numberOfPixels; ++i)
+    {
+      *(outputPixel--) = *(inputPixel++);
+    }
+  }
+
+  //----------------------------------------------------------------------------
+  void ReverseRowScalar(const unsigned char* input, unsigned char* output, int numberOfPixels, int bytesPerPixel)
+  {
+    switch (bytesPerPixel)
+    {
+      case 1: ReverseRowScalar<1>(input, output, numberOfPixels); return;
+      case 2: ReverseRowScalar<2>(input, output, numberOfPixels); return;
+      case 3: ReverseRowScalar<3>(input, output, numberOfPixels); return;
+      case 4: ReverseRowScalar<4>(input, output, numberOfPixels); return;
+      case 6: ReverseRowScalar<6>(input, output, numberOfPixels); return;
+      case 8: ReverseRowScalar<8>(input, output, numberOfPixels); return;
+      case 12: ReverseRowScalar<12>(input, output, numberOfPixels); return;
+      case 16: ReverseRowScalar<16>(input, output, numberOfPixels); return;
+    }
+    for (int i = 0; i < numberOfPixels; ++i)
+    {
+      memcpy(output + static_cast<size_t>(numberOfPixels - 1 - i) * bytesPerPixel, input + static_cast<size_t>(i) * bytesPerPixel, bytesPerPixel);
+    }
+  }
+
+  //----------------------------------------------------------------------------
+  // Transpose the [rowBegin, rowEnd) x [columnBegin, columnEnd) region in 16x16 tiles, to keep both the input and the output in cache
+  template<int BytesPerPixel>
+  void TransposeRegionScalar(const unsigned char* input, long long inputRowStride, unsigned char* output, long long outputRowStride,
+                             int rowBegin, int rowEnd, int columnBegin, int columnEnd)
+  {
+    const int TILE_SIZE = 16;
+    for (int tileRow = rowBegin; tileRow < rowEnd; tileRow += TILE_SIZE)
+    {
+      int tileRowEnd = std::min(tileRow + TILE_SIZE, rowEnd);
+      for (int tileColumn = columnBegin; tileColumn < columnEnd; tileColumn += TILE_SIZE)
+      {
+        int tileColumnEnd = std::min(tileColumn + TILE_SIZE, columnEnd);
+        for (int row = tileRow; row < tileRowEnd; ++row)
+        {
+          const PixelBytes<BytesPerPixel>* inputPixel = reinterpret_cast<const PixelBytes<BytesPerPixel>*>(input + row * inputRowStride) + tileColumn;
+          for (int column = tileColumn; column < tileColumnEnd; ++column)
+          {
+            *(reinterpret_cast<PixelBytes<BytesPerPixel>*>(output + column * outputRowStride) + row) = *(inputPixel++);
+          }
+        }
+      }
+    }
+  }
+
+  //----------------------------------------------------------------------------
+  void TransposeRegionScalar(const unsigned char* input, long long inputRowStride, unsigned char* output, long long outputRowStride,
+                             int rowBegin, int rowEnd, int columnBegin, int columnEnd, int bytesPerPixel)
+  {
+    if (rowBegin >= rowEnd || columnBegin >= columnEnd)
+    {
+      return;
+    }
+    switch (bytesPerPixel)
+    {
+      case 1: TransposeRegionScalar<1>(input, inputRowStride, output, outputRowStride, rowBegin, rowEnd, columnBegin, columnEnd); return;
+      case 2: TransposeRegionScalar<2>(input, inputRowStride, output, outputRowStride, rowBegin, rowEnd, columnBegin, columnEnd); return;
+      case 3: TransposeRegionScalar<3>(input, inputRowStride, output, outputRowStride, rowBegin, rowEnd, columnBegin, columnEnd); return;
+      case 4: TransposeRegionScalar<4>(input, inputRowStride, output, outputRowStride, rowBegin, rowEnd, columnBegin, columnEnd); return;
+      case 6: TransposeRegionScalar<6>(input, inputRowStride, output, outputRowStride, rowBegin, rowEnd, columnBegin, columnEnd); return;
+      case 8: TransposeRegionScalar<8>(input, inputRowStride, output, outputRowStride, rowBegin, rowEnd, columnBegin, columnEnd); return;
+    }
+    for (int row = rowBegin; row < rowEnd; ++row)
+    {
+      for (int column = columnBegin; column < columnEnd; ++column)
+      {
+        memcpy(output + column * outputRowStride + static_cast<long long>(row) * bytesPerPixel, input + row * inputRowStride + static_cast<long long>(column) * bytesPerPixel, bytesPerPixel);
+      }
+    }
+  }
+
+#if defined(PLUS_PIXEL_KERNELS_X86)
+
+  //----------------------------------------------------------------------------
+  bool IsAvx2Supported()
+  {
+#if defined(_MSC_VER) && !defined(__clang__)
+    int cpuInfo[4] = { 0 };
+    __cpuid(cpuInfo, 0);
+    if (cpuInfo[0] < 7)
+    {
+      return false;
+    }
+    __cpuid(cpuInfo, 1);
+    const int OSXSAVE_BIT = 1 << 27;
+    const int AVX_BIT = 1 << 28;
+    if ((cpuInfo[2] & OSXSAVE_BIT) == 0 || (cpuInfo[2] & AVX_BIT) == 0)
+    {
+      return false;
+    }
+    // The operating system must save the YMM registers at context switches
+    if ((_xgetbv(0) & 0x6) != 0x6)
+    {
+      return false;
+    }
+    __cpuidex(cpuInfo, 7, 0);
+    const int AVX2_BIT = 1 << 5;
+    return (cpuInfo[1] & AVX2_BIT) != 0;
+#else
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2") != 0;
+#endif
+  }
+
+  //----------------------------------------------------------------------------
+  bool IsSse2Supported()
+  {
+#if defined(__x86_64__) || defined(_M_X64)
+    // SSE2 is part of the x86-64 instruction set
+    return true;
+#elif defined(_MSC_VER) && !defined(__clang__)
+    int cpuInfo[4] = { 0 };
+    __cpuid(cpuInfo, 1);
+    const int SSE2_BIT = 1 << 26;
+    return (cpuInfo[3] & SSE2_BIT) != 0;
+#else
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("sse2") != 0;
+#endif
+  }
+
+  //----------------------------------------------------------------------------
+  // Row reversal
+
+  template<int BytesPerPixel> __m128i ReverseVectorSse2(__m128i v);
+
+  template<> PLUS_TARGET_SSE2 inline __m128i ReverseVectorSse2<1>(__m128i v)
+  {
+    v = _mm_shuffle_epi32(v, _MM_SHUFFLE(0, 1, 2, 3));
+    v = _mm_shufflelo_epi16(v, _MM_SHUFFLE(2, 3, 0, 1));
+    v = _mm_shufflehi_epi16(v, _MM_SHUFFLE(2, 3, 0, 1));
+    return _mm_or_si128(_mm_slli_epi16(v, 8), _mm_srli_epi16(v, 8));
+  }
+
+  template<> PLUS_TARGET_SSE2 inline __m128i ReverseVectorSse2<2>(__m128i v)
+  {
+    v = _mm_shuffle_epi32(v, _MM_SHUFFLE(0, 1, 2, 3));
+    v = _mm_shufflelo_epi16(v, _MM_SHUFFLE(2, 3, 0, 1));
+    return _mm_shufflehi_epi16(v, _MM_SHUFFLE(2, 3, 0, 1));
+  }
+
+  template<> PLUS_TARGET_SSE2 inline __m128i ReverseVectorSse2<4>(__m128i v)
+  {
+    return _mm_shuffle_epi32(v, _MM_SHUFFLE(0, 1, 2, 3));
+  }
+
+  template<> PLUS_TARGET_SSE2 inline __m128i ReverseVectorSse2<8>(__m128i v)
+  {
+    return _mm_shuffle_epi32(v, _MM_SHUFFLE(1, 0, 3, 2));
+  }
+
+  //----------------------------------------------------------------------------
+  // Reverse the first pixels of the row that fill whole vectors, returns the number of reversed pixels
+  template<int BytesPerPixel>
+  PLUS_TARGET_SSE2 int ReverseRowSse2(const unsigned char* input, unsigned char* output, int numberOfPixels)
+  {
+    const int PIXELS_PER_VECTOR = 16 / BytesPerPixel;
+    int numberOfVectors = numberOfPixels / PIXELS_PER_VECTOR;
+    unsigned char* outputVector = output + static_cast<size_t>(numberOfPixels - PIXELS_PER_VECTOR) * BytesPerPixel;
+    for (int i = 0; i < numberOfVectors; ++i)
+    {
+      __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(input));
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(outputVector), ReverseVectorSse2<BytesPerPixel>(v));
+      input += 16;
+      outputVector -= 16;
+    }
+    return numberOfVectors * PIXELS_PER_VECTOR;
+  }
+
+  //----------------------------------------------------------------------------
+  template<int BytesPerPixel> __m256i ReverseVectorAvx2(__m256i v);
+
+  template<> PLUS_TARGET_AVX2 inline __m256i ReverseVectorAvx2<1>(__m256i v)
+  {
+    const __m256i reverseBytesInLanes = _mm256_setr_epi8(15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0,
+                                        15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0);
+    v = _mm256_shuffle_epi8(v, reverseBytesInLanes);
+    return _mm256_permute2x128_si256(v, v, 0x01);
+  }
+
+  template<> PLUS_TARGET_AVX2 inline __m256i ReverseVectorAvx2<2>(__m256i v)
+  {
+    const __m256i reverseWordsInLanes = _mm256_setr_epi8(14, 15, 12, 13, 10, 11, 8, 9, 6, 7, 4, 5, 2, 3, 0, 1,
+                                        14, 15, 12, 13, 10, 11, 8, 9, 6, 7, 4, 5, 2, 3, 0, 1);
+    v = _mm256_shuffle_epi8(v, reverseWordsInLanes);
+    return _mm256_permute2x128_si256(v, v, 0x01);
+  }
+
+  template<> PLUS_TARGET_AVX2 inline __m256i ReverseVectorAvx2<4>(__m256i v)
+  {
+    return _mm256_permutevar8x32_epi32(v, _mm256_setr_epi32(7, 6, 5, 4, 3, 2, 1, 0));
+  }
+
+  template<> PLUS_TARGET_AVX2 inline __m256i ReverseVectorAvx2<8>(__m256i v)
+  {
+    return _mm256_permute4x64_epi64(v, _MM_SHUFFLE(0, 1, 2, 3));
+  }
+
+  //----------------------------------------------------------------------------
+  template<int BytesPerPixel>
+  PLUS_TARGET_AVX2 int ReverseRowAvx2(const unsigned char* input, unsigned char* output, int numberOfPixels)
+  {
+    const int PIXELS_PER_VECTOR = 32 / BytesPerPixel;
+    int numberOfVectors = numberOfPixels / PIXELS_PER_VECTOR;
+    unsigned char* outputVector = output + static_cast<size_t>(numberOfPixels - PIXELS_PER_VECTOR) * BytesPerPixel;
+    for (int i = 0; i < numberOfVectors; ++i)
+    {
+      __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(input));
+      _mm256_storeu_si256(reinterpret_cast<__m256i*>(outputVector), ReverseVectorAvx2<BytesPerPixel>(v));
+      input += 32;
+      outputVector -= 32;
+    }
+    return numberOfVectors * PIXELS_PER_VECTOR;
+  }
+
+  //----------------------------------------------------------------------------
+  // RGB24 rows are reversed in blocks of 5 pixels (15 bytes) using byte shuffles.
+  // Each 16-byte store writes one extra byte past the end of its block, which belongs to a pixel that is written later.
+  PLUS_TARGET_AVX2 void ReverseRowRgb24Ssse3(const unsigned char* input, unsigned char* output, int numberOfPixels)
+  {
+    const int PIXELS_PER_BLOCK = 5;
+    // The first block of the input is the last block of the output, it is copied by scalar code to avoid writing past the row.
+    // The last block must leave at least one pixel in the input to avoid reading past the row.
+    int numberOfBlocks = (numberOfPixels >= 2 * PIXELS_PER_BLOCK + 1) ? (numberOfPixels - 1) / PIXELS_PER_BLOCK - 1 : 0;
+    const __m128i reversePixels = _mm_setr_epi8(12, 13, 14, 9, 10, 11, 6, 7, 8, 3, 4, 5, 0, 1, 2, -1);
+    // Process the blocks in increasing output address order, so each extra byte is overwritten by the next block
+    for (int block = numberOfBlocks; block >= 1; --block)
+    {
+      int firstPixel = block * PIXELS_PER_BLOCK;
+      __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(input + firstPixel * 3));
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(output + (numberOfPixels - firstPixel - PIXELS_PER_BLOCK) * 3), _mm_shuffle_epi8(v, reversePixels));
+    }
+    // Remaining pixels at the end of the input row, then the first block
+    int firstRemainingPixel = (numberOfBlocks > 0) ? (numberOfBlocks + 1) * PIXELS_PER_BLOCK : 0;
+    ReverseRowScalar<3>(input + firstRemainingPixel * 3, output, numberOfPixels - firstRemainingPixel);
+    if (numberOfBlocks > 0)
+    {
+      ReverseRowScalar<3>(input, output + (numberOfPixels - PIXELS_PER_BLOCK) * 3, PIXELS_PER_BLOCK);
+    }
+  }
+
+  //----------------------------------------------------------------------------
+  // Transposition
+
+  // Transpose 8x8 pixels of 1 byte
+  PLUS_TARGET_SSE2 inline void TransposeTile8x8x1Sse2(const unsigned char* input, long long inputRowStride, unsigned char* output, long long outputRowStride)
+  {
+    __m128i r0 = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(input));
+    __m128i r1 = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(input + inputRowStride));
+    __m128i r2 = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(input + 2 * inputRowStride));
+    __m128i r3 = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(input + 3 * inputRowStride));
+    __m128i r4 = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(input + 4 * inputRowStride));
+    __m128i r5 = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(input + 5 * inputRowStride));
+    __m128i r6 = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(input + 6 * inputRowStride));
+    __m128i r7 = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(input + 7 * inputRowStride));
+    __m128i a0 = _mm_unpacklo_epi8(r0, r1);
+    __m128i a1 = _mm_unpacklo_epi8(r2, r3);
+    __m128i a2 = _mm_unpacklo_epi8(r4, r5);
+    __m128i a3 = _mm_unpacklo_epi8(r6, r7);
+    __m128i b0 = _mm_unpacklo_epi16(a0, a1);
+    __m128i b1 = _mm_unpackhi_epi16(a0, a1);
+    __m128i b2 = _mm_unpacklo_epi16(a2, a3);
+    __m128i b3 = _mm_unpackhi_epi16(a2, a3);
+    __m128i c0 = _mm_unpacklo_epi32(b0, b2);
+    __m128i c1 = _mm_unpackhi_epi32(b0, b2);
+    __m128i c2 = _mm_unpacklo_epi32(b1, b3);
+    __m128i c3 = _mm_unpackhi_epi32(b1, b3);
+    _mm_storel_epi64(reinterpret_cast<__m128i*>(output), c0);
+    _mm_storel_epi64(reinterpret_cast<__m128i*>(output + outputRowStride), _mm_unpackhi_epi64(c0, c0));
+    _mm_storel_epi64(reinterpret_cast<__m128i*>(output + 2 * outputRowStride), c1);
+    _mm_storel_epi64(reinterpret_cast<__m128i*>(output + 3 * outputRowStride), _mm_unpackhi_epi64(c1, c1));
+    _mm_storel_epi64(reinterpret_cast<__m128i*>(output + 4 * outputRowStride), c2);
+    _mm_storel_epi64(reinterpret_cast<__m128i*>(output + 5 * outputRowStride), _mm_unpackhi_epi64(c2, c2));
+    _mm_storel_epi64(reinterpret_cast<__m128i*>(output + 6 * outputRowStride), c3);
+    _mm_storel_epi64(reinterpret_cast<__m128i*>(output + 7 * outputRowStride), _mm_unpackhi_epi64(c3, c3));
+  }
+
+  // Transpose 8x8 pixels of 2 bytes
+  PLUS_TARGET_SSE2 inline void TransposeTile8x8x2Sse2(const unsigned char* input, long long inputRowStride, unsigned char* output, long long outputRowStride)
+  {
+    __m128i r0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(input));
+    __m128i r1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(input + inputRowStride));
+    __m128i r2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(input + 2 * inputRowStride));
+    __m128i r3 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(input + 3 * inputRowStride));
+    __m128i r4 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(input + 4 * inputRowStride));
+    __m128i r5 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(input + 5 * inputRowStride));
+    __m128i r6 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(input + 6 * inputRowStride));
+    __m128i r7 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(input + 7 * inputRowStride));
+    __m128i a0 = _mm_unpacklo_epi16(r0, r1);
+    __m128i a1 = _mm_unpackhi_epi16(r0, r1);
+    __m128i a2 = _mm_unpacklo_epi16(r2, r3);
+    __m128i a3 = _mm_unpackhi_epi16(r2, r3);
+    __m128i a4 = _mm_unpacklo_epi16(r4, r5);
+    __m128i a5 = _mm_unpackhi_epi16(r4, r5);
+    __m128i a6 = _mm_unpacklo_epi16(r6, r7);
+    __m128i a7 = _mm_unpackhi_epi16(r6, r7);
+    __m128i b0 = _mm_unpacklo_epi32(a0, a2);
+    __m128i b1 = _mm_unpackhi_epi32(a0, a2);
+    __m128i b2 = _mm_unpacklo_epi32(a1, a3);
+    __m128i b3 = _mm_unpackhi_epi32(a1, a3);
+    __m128i b4 = _mm_unpacklo_epi32(a4, a6);
+    __m128i b5 = _mm_unpackhi_epi32(a4, a6);
+    __m128i b6 = _mm_unpacklo_epi32(a5, a7);
+    __m128i b7 = _mm_unpackhi_epi32(a5, a7);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(output), _mm_unpacklo_epi64(b0, b4));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(output + outputRowStride), _mm_unpackhi_epi64(b0, b4));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(output + 2 * outputRowStride), _mm_unpacklo_epi64(b1, b5));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(output + 3 * outputRowStride), _mm_unpackhi_epi64(b1, b5));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(output + 4 * outputRowStride), _mm_unpacklo_epi64(b2, b6));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(output + 5 * outputRowStride), _mm_unpackhi_epi64(b2, b6));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(output + 6 * outputRowStride), _mm_unpacklo_epi64(b3, b7));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(output + 7 * outputRowStride), _mm_unpackhi_epi64(b3, b7));
+  }
+
+  // Transpose 4x4 pixels of 4 bytes
+  PLUS_TARGET_SSE2 inline void TransposeTile4x4x4Sse2(const unsigned char* input, long long inputRowStride, unsigned char* output, long long outputRowStride)
+  {
+    __m128i r0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(input));
+    __m128i r1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(input + inputRowStride));
+    __m128i r2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(input + 2 * inputRowStride));
+    __m128i r3 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(input + 3 * inputRowStride));
+    __m128i a0 = _mm_unpacklo_epi32(r0, r1);
+    __m128i a1 = _mm_unpackhi_epi32(r0, r1);
+    __m128i a2 = _mm_unpacklo_epi32(r2, r3);
+    __m128i a3 = _mm_unpackhi_epi32(r2, r3);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(output), _mm_unpacklo_epi64(a0, a2));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(output + outputRowStride), _mm_unpackhi_epi64(a0, a2));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(output + 2 * outputRowStride), _mm_unpacklo_epi64(a1, a3));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(output + 3 * outputRowStride), _mm_unpackhi_epi64(a1, a3));
+  }
+
+  // Transpose 2x2 pixels of 8 bytes
+  PLUS_TARGET_SSE2 inline void TransposeTile2x2x8Sse2(const unsigned char* input, long long inputRowStride, unsigned char* output, long long outputRowStride)
+  {
+    __m128i r0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(input));
+    __m128i r1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(input + inputRowStride));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(output), _mm_unpacklo_epi64(r0, r1));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(output + outputRowStride), _mm_unpackhi_epi64(r0, r1));
+  }
+
+  //----------------------------------------------------------------------------
+  // Transpose the whole tiles with vector instructions and the remaining edges with scalar code.
+  // Returns false if there is no vectorized implementation for this pixel size.
+  PLUS_TARGET_SSE2 bool TransposeSse2(const unsigned char* input, long long inputRowStride, unsigned char* output, long long outputRowStride,
+                                      int numberOfInputRows, int numberOfInputColumns, int bytesPerPixel)
+  {
+    int tileSize = 0;
+    switch (bytesPerPixel)
+    {
+      case 1: tileSize = 8; break;
+      case 2: tileSize = 8; break;
+      case 4: tileSize = 4; break;
+      case 8: tileSize = 2; break;
+      default:
+        return false;
+    }
+
+    int numberOfTiledRows = numberOfInputRows - numberOfInputRows % tileSize;
+    int numberOfTiledColumns = numberOfInputColumns - numberOfInputColumns % tileSize;
+    for (int row = 0; row < numberOfTiledRows; row += tileSize)
+    {
+      const unsigned char* inputTile = input + row * inputRowStride;
+      unsigned char* outputTile = output + static_cast<long long>(row) * bytesPerPixel;
+      for (int column = 0; column < numberOfTiledColumns; column += tileSize)
+      {
+        switch (bytesPerPixel)
+        {
+          case 1: TransposeTile8x8x1Sse2(inputTile, inputRowStride, outputTile, outputRowStride); break;
+          case 2: TransposeTile8x8x2Sse2(inputTile, inputRowStride, outputTile, outputRowStride); break;
+          case 4: TransposeTile4x4x4Sse2(inputTile, inputRowStride, outputTile, outputRowStride); break;
+          case 8: TransposeTile2x2x8Sse2(inputTile, inputRowStride, outputTile, outputRowStride); break;
+        }
+        inputTile += tileSize * bytesPerPixel;
+        outputTile += tileSize * outputRowStride;
+      }
+    }
+
+    // Right edge (all rows) and bottom edge (tiled columns only)
+    TransposeRegionScalar(input, inputRowStride, output, outputRowStride, 0, numberOfInputRows, numberOfTiledColumns, numberOfInputColumns, bytesPerPixel);
+    TransposeRegionScalar(input, inputRowStride, output, outputRowStride, numberOfTiledRows, numberOfInputRows, 0, numberOfTiledColumns, bytesPerPixel);
+    return true;
+  }
+
+  //----------------------------------------------------------------------------
+  // Color conversion
+
+  // Divide unsigned 16-bit values (at most 765, the sum of three 8-bit values) by 3: x / 3 == (x * 43691) >> 17
+  PLUS_TARGET_SSE2 inline __m128i DivideBy3Sse2(__m128i x)
+  {
+    return _mm_srli_epi16(_mm_mulhi_epu16(x, _mm_set1_epi16(static_cast<short>(43691))), 1);
+  }
+
+  PLUS_TARGET_AVX2 inline __m256i DivideBy3Avx2(__m256i x)
+  {
+    return _mm256_srli_epi16(_mm256_mulhi_epu16(x, _mm256_set1_epi16(static_cast<short>(43691))), 1);
+  }
+
+  //----------------------------------------------------------------------------
+  // Sum of the first three bytes of each 32-bit pixel
+  PLUS_TARGET_SSE2 inline __m128i SumRgbOfRgba32Sse2(__m128i pixels)
+  {
+    const __m128i byteMask = _mm_set1_epi32(0xFF);
+    __m128i sum = _mm_and_si128(pixels, byteMask);
+    sum = _mm_add_epi32(sum, _mm_and_si128(_mm_srli_epi32(pixels, 8), byteMask));
+    return _mm_add_epi32(sum, _mm_and_si128(_mm_srli_epi32(pixels, 16), byteMask));
+  }
+
+  PLUS_TARGET_SSE2 int Rgba32ToGraySse2(int numberOfPixels, const unsigned char* input, unsigned char* output)
+  {
+    const int PIXELS_PER_ITERATION = 16;
+    int numberOfIterations = numberOfPixels / PIXELS_PER_ITERATION;
+    for (int i = 0; i < numberOfIterations; ++i)
+    {
+      __m128i sum0 = SumRgbOfRgba32Sse2(_mm_loadu_si128(reinterpret_cast<const __m128i*>(input)));
+      __m128i sum1 = SumRgbOfRgba32Sse2(_mm_loadu_si128(reinterpret_cast<const __m128i*>(input + 16)));
+      __m128i sum2 = SumRgbOfRgba32Sse2(_mm_loadu_si128(reinterpret_cast<const __m128i*>(input + 32)));
+      __m128i sum3 = SumRgbOfRgba32Sse2(_mm_loadu_si128(reinterpret_cast<const __m128i*>(input + 48)));
+      __m128i gray01 = DivideBy3Sse2(_mm_packs_epi32(sum0, sum1));
+      __m128i gray23 = DivideBy3Sse2(_mm_packs_epi32(sum2, sum3));
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(output), _mm_packus_epi16(gray01, gray23));
+      input += 4 * PIXELS_PER_ITERATION;
+      output += PIXELS_PER_ITERATION;
+    }
+    return numberOfIterations * PIXELS_PER_ITERATION;
+  }
+
+  //----------------------------------------------------------------------------
+  PLUS_TARGET_AVX2 inline __m256i SumRgbOfRgba32Avx2(__m256i pixels)
+  {
+    const __m256i byteMask = _mm256_set1_epi32(0xFF);
+    __m256i sum = _mm256_and_si256(pixels, byteMask);
+    sum = _mm256_add_epi32(sum, _mm256_and_si256(_mm256_srli_epi32(pixels, 8), byteMask));
+    return _mm256_add_epi32(sum, _mm256_and_si256(_mm256_srli_epi32(pixels, 16), byteMask));
+  }
+
+  PLUS_TARGET_AVX2 int Rgba32ToGrayAvx2(int numberOfPixels, const unsigned char* input, unsigned char* output)
+  {
+    const int PIXELS_PER_ITERATION = 32;
+    int numberOfIterations = numberOfPixels / PIXELS_PER_ITERATION;
+    // Packing works within 128-bit lanes, this restores the pixel order
+    const __m256i restoreOrder = _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7);
+    for (int i = 0; i < numberOfIterations; ++i)
+    {
+      __m256i sum0 = SumRgbOfRgba32Avx2(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(input)));
+      __m256i sum1 = SumRgbOfRgba32Avx2(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(input + 32)));
+      __m256i sum2 = SumRgbOfRgba32Avx2(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(input + 64)));
+      __m256i sum3 = SumRgbOfRgba32Avx2(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(input + 96)));
+      __m256i gray01 = DivideBy3Avx2(_mm256_packs_epi32(sum0, sum1));
+      __m256i gray23 = DivideBy3Avx2(_mm256_packs_epi32(sum2, sum3));
+      __m256i gray = _mm256_permutevar8x32_epi32(_mm256_packus_epi16(gray01, gray23), restoreOrder);
+      _mm256_storeu_si256(reinterpret_cast<__m256i*>(output), gray);
+      input += 4 * PIXELS_PER_ITERATION;
+      output += PIXELS_PER_ITERATION;
+    }
+    return numberOfIterations * PIXELS_PER_ITERATION;
+  }
+
+  //----------------------------------------------------------------------------
+  // Gather the R, G, or B bytes of 16 RGB24 pixels with byte shuffles (SSSE3, available on all AVX2 CPUs)
+  PLUS_TARGET_AVX2 int Rgb24ToGraySsse3(int numberOfPixels, const unsigned char* input, unsigned char* output)
+  {
+    const int PIXELS_PER_ITERATION = 16;
+    // shuffleMasks[component][inputVector]: moves the component of each pixel that is in the input vector to the pixel position
+    __m128i shuffleMasks[3][3];
+    for (int component = 0; component < 3; ++component)
+    {
+      for (int inputVector = 0; inputVector < 3; ++inputVector)
+      {
+        char mask[16];
+        for (int pixel = 0; pixel < 16; ++pixel)
+        {
+          int byteIndex = pixel * 3 + component - inputVector * 16;
+          mask[pixel] = (byteIndex >= 0 && byteIndex < 16) ? static_cast<char>(byteIndex) : static_cast<char>(-1);
+        }
+        shuffleMasks[component][inputVector] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(mask));
+      }
+    }
+
+    const __m128i zero = _mm_setzero_si128();
+    int numberOfIterations = numberOfPixels / PIXELS_PER_ITERATION;
+    for (int i = 0; i < numberOfIterations; ++i)
+    {
+      __m128i v0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(input));
+      __m128i v1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(input + 16));
+      __m128i v2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(input + 32));
+      __m128i sumLow = zero;
+      __m128i sumHigh = zero;
+      for (int component = 0; component < 3; ++component)
+      {
+        __m128i c = _mm_or_si128(_mm_or_si128(_mm_shuffle_epi8(v0, shuffleMasks[component][0]), _mm_shuffle_epi8(v1, shuffleMasks[component][1])),
+                                 _mm_shuffle_epi8(v2, shuffleMasks[component][2]));
+        sumLow = _mm_add_epi16(sumLow, _mm_unpacklo_epi8(c, zero));
+        sumHigh = _mm_add_epi16(sumHigh, _mm_unpackhi_epi8(c, zero));
+      }
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(output), _mm_packus_epi16(DivideBy3Sse2(sumLow), DivideBy3Sse2(sumHigh)));
+      input += 3 * PIXELS_PER_ITERATION;
+      output += PIXELS_PER_ITERATION;
+    }
+    return numberOfIterations * PIXELS_PER_ITERATION;
+  }
+
+  //----------------------------------------------------------------------------
+  // Integer division with truncation, as in C. The quotient is at most a few hundred and the divisor is constant,
+  // so the single precision division result is never rounded across an integer.
+  PLUS_TARGET_SSE2 inline __m128i DivideSse2(__m128i numerator, float denominator)
+  {
+    return _mm_cvttps_epi32(_mm_div_ps(_mm_cvtepi32_ps(numerator), _mm_set1_ps(denominator)));
+  }
+
+  // Product of integer values, computed in single precision. Exact if the product is below 2^24.
+  PLUS_TARGET_SSE2 inline __m128i MultiplySse2(__m128i value, float factor)
+  {
+    return _mm_cvttps_epi32(_mm_mul_ps(_mm_cvtepi32_ps(value), _mm_set1_ps(factor)));
+  }
+
+  //----------------------------------------------------------------------------
+  // Convert 4 pixels from YUV (32-bit values) to RGB (32-bit values, not clipped yet), same as GET_*_FROM_YUV in PixelCodec
+  PLUS_TARGET_SSE2 inline void YuvToRgbSse2(__m128i y, __m128i u, __m128i v, __m128i& r, __m128i& g, __m128i& b)
+  {
+    // ICCIRY and ICCIRUV
+    __m128i yScaled = DivideSse2(_mm_slli_epi32(_mm_sub_epi32(y, _mm_set1_epi32(16)), 8), 219.0f);
+    __m128i uScaled = DivideSse2(_mm_slli_epi32(_mm_sub_epi32(u, _mm_set1_epi32(128)), 8), 224.0f);
+    __m128i vScaled = DivideSse2(_mm_slli_epi32(_mm_sub_epi32(v, _mm_set1_epi32(128)), 8), 224.0f);
+
+    // UNFIX
+    __m128i base = _mm_add_epi32(_mm_slli_epi32(yScaled, FIXNUM_SHIFT), _mm_set1_epi32(1 << (FIXNUM_SHIFT - 1)));
+    r = _mm_srai_epi32(_mm_add_epi32(base, MultiplySse2(vScaled, YUV_R_V)), FIXNUM_SHIFT);
+    __m128i gChroma = _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(_mm_cvtepi32_ps(uScaled), _mm_set1_ps(YUV_G_U)), _mm_mul_ps(_mm_cvtepi32_ps(vScaled), _mm_set1_ps(YUV_G_V))));
+    g = _mm_srai_epi32(_mm_add_epi32(base, gChroma), FIXNUM_SHIFT);
+    __m128i bChroma = _mm_add_epi32(_mm_slli_epi32(uScaled, FIXNUM_SHIFT), MultiplySse2(uScaled, YUV_B_U_REMAINDER));
+    b = _mm_srai_epi32(_mm_add_epi32(base, bChroma), FIXNUM_SHIFT);
+  }
+
+  //----------------------------------------------------------------------------
+  // Convert 8 YUY2 pixels (16 bytes) to clipped R, G, B values (16-bit)
+  PLUS_TARGET_SSE2 inline void Yuy2ToRgbSse2(__m128i yuy2, __m128i& r, __m128i& g, __m128i& b)
+  {
+    const __m128i zero = _mm_setzero_si128();
+    __m128i y = _mm_and_si128(yuy2, _mm_set1_epi16(0xFF));
+    __m128i uv = _mm_srli_epi16(yuy2, 8);
+    // Both pixels of a pair use the same U and V values
+    __m128i u = _mm_shufflehi_epi16(_mm_shufflelo_epi16(uv, _MM_SHUFFLE(2, 2, 0, 0)), _MM_SHUFFLE(2, 2, 0, 0));
+    __m128i v = _mm_shufflehi_epi16(_mm_shufflelo_epi16(uv, _MM_SHUFFLE(3, 3, 1, 1)), _MM_SHUFFLE(3, 3, 1, 1));
+
+    __m128i rLow, gLow, bLow, rHigh, gHigh, bHigh;
+    YuvToRgbSse2(_mm_unpacklo_epi16(y, zero), _mm_unpacklo_epi16(u, zero), _mm_unpacklo_epi16(v, zero), rLow, gLow, bLow);
+    YuvToRgbSse2(_mm_unpackhi_epi16(y, zero), _mm_unpackhi_epi16(u, zero), _mm_unpackhi_epi16(v, zero), rHigh, gHigh, bHigh);
+
+    // CLIP
+    const __m128i maxValue = _mm_set1_epi16(255);
+    r = _mm_min_epi16(_mm_max_epi16(_mm_packs_epi32(rLow, rHigh), zero), maxValue);
+    g = _mm_min_epi16(_mm_max_epi16(_mm_packs_epi32(gLow, gHigh), zero), maxValue);
+    b = _mm_min_epi16(_mm_max_epi16(_mm_packs_epi32(bLow, bHigh), zero), maxValue);
+  }
+
+  //----------------------------------------------------------------------------
+  PLUS_TARGET_SSE2 int Yuy2ToBmp24Sse2(bool bgrOutput, int numberOfPixelPairs, const unsigned char* input, unsigned char* output)
+  {
+    const int PIXEL_PAIRS_PER_ITERATION = 8;
+    int numberOfIterations = numberOfPixelPairs / PIXEL_PAIRS_PER_ITERATION;
+    for (int i = 0; i < numberOfIterations; ++i)
+    {
+      __m128i r0, g0, b0, r1, g1, b1;
+      Yuy2ToRgbSse2(_mm_loadu_si128(reinterpret_cast<const __m128i*>(input)), r0, g0, b0);
+      Yuy2ToRgbSse2(_mm_loadu_si128(reinterpret_cast<const __m128i*>(input + 16)), r1, g1, b1);
+      unsigned char first[16];
+      unsigned char second[16];
+      unsigned char third[16];
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(first), _mm_packus_epi16(bgrOutput ? b0 : r0, bgrOutput ? b1 : r1));
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(second), _mm_packus_epi16(g0, g1));
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(third), _mm_packus_epi16(bgrOutput ? r0 : b0, bgrOutput ? r1 : b1));
+      for (int pixel = 0; pixel < 2 * PIXEL_PAIRS_PER_ITERATION; ++pixel)
+      {
+        output[0] = first[pixel];
+        output[1] = second[pixel];
+        output[2] = third[pixel];
+        output += 3;
+      }
+      input += 4 * PIXEL_PAIRS_PER_ITERATION;
+    }
+    return numberOfIterations * PIXEL_PAIRS_PER_ITERATION;
+  }
+
+  //----------------------------------------------------------------------------
+  PLUS_TARGET_SSE2 int Yuy2ToGraySse2(int numberOfPixelPairs, const unsigned char* input, unsigned char* output)
+  {
+    const int PIXEL_PAIRS_PER_ITERATION = 8;
+    int numberOfIterations = numberOfPixelPairs / PIXEL_PAIRS_PER_ITERATION;
+    for (int i = 0; i < numberOfIterations; ++i)
+    {
+      __m128i r0, g0, b0, r1, g1, b1;
+      Yuy2ToRgbSse2(_mm_loadu_si128(reinterpret_cast<const __m128i*>(input)), r0, g0, b0);
+      Yuy2ToRgbSse2(_mm_loadu_si128(reinterpret_cast<const __m128i*>(input + 16)), r1, g1, b1);
+      __m128i gray0 = DivideBy3Sse2(_mm_add_epi16(_mm_add_epi16(r0, g0), b0));
+      __m128i gray1 = DivideBy3Sse2(_mm_add_epi16(_mm_add_epi16(r1, g1), b1));
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(output), _mm_packus_epi16(gray0, gray1));
+      input += 4 * PIXEL_PAIRS_PER_ITERATION;
+      output += 2 * PIXEL_PAIRS_PER_ITERATION;
+    }
+    return numberOfIterations * PIXEL_PAIRS_PER_ITERATION;
+  }
+
+#endif
+}
+
+//----------------------------------------------------------------------------
+PlusPixelKernels::InstructionSet PlusPixelKernels::GetSupportedInstructionSet()
+{
+#if defined(PLUS_PIXEL_KERNELS_X86)
+  static const InstructionSet supportedInstructionSet = IsAvx2Supported() ? INSTRUCTION_SET_AVX2 : (IsSse2Supported() ? INSTRUCTION_SET_SSE2 : INSTRUCTION_SET_SCALAR);
+  return supportedInstructionSet;
+#else
+  return INSTRUCTION_SET_SCALAR;
+#endif
+}
+
+//----------------------------------------------------------------------------
+PlusPixelKernels::InstructionSet PlusPixelKernels::GetInstructionSet()
+{
+  return std::min(GetSupportedInstructionSet(), MaximumInstructionSet);
+}
+
+//----------------------------------------------------------------------------
+void PlusPixelKernels::SetMaximumInstructionSet(InstructionSet instructionSet)
+{
+  MaximumInstructionSet = instructionSet;
+}
+
+//----------------------------------------------------------------------------
+const char* PlusPixelKernels::GetInstructionSetAsString(InstructionSet instructionSet)
+{
+  switch (instructionSet)
+  {
+    case INSTRUCTION_SET_SCALAR:
+      return "Scalar";
+    case INSTRUCTION_SET_SSE2:
+      return "SSE2";
+    case INSTRUCTION_SET_AVX2:
+      return "AVX2";
+  }
+  return "Unknown";
+}
+
+//----------------------------------------------------------------------------
+void PlusPixelKernels::ReverseRow(const void* input, void* output, int numberOfPixels, int bytesPerPixel)
+{
+  const unsigned char* inputBytes = static_cast<const unsigned char*>(input);
+  unsigned char* outputBytes = static_cast<unsigned char*>(output);
+  int numberOfReversedPixels = 0;
+
+#if defined(PLUS_PIXEL_KERNELS_X86)
+  InstructionSet instructionSet = GetInstructionSet();
+  if (instructionSet >= INSTRUCTION_SET_AVX2)
+  {
+    switch (bytesPerPixel)
+    {
+      case 1: numberOfReversedPixels = ReverseRowAvx2<1>(inputBytes, outputBytes, numberOfPixels); break;
+      case 2: numberOfReversedPixels = ReverseRowAvx2<2>(inputBytes, outputBytes, numberOfPixels); break;
+      case 3: ReverseRowRgb24Ssse3(inputBytes, outputBytes, numberOfPixels); return;
+      case 4: numberOfReversedPixels = ReverseRowAvx2<4>(inputBytes, outputBytes, numberOfPixels); break;
+      case 8: numberOfReversedPixels = ReverseRowAvx2<8>(inputBytes, outputBytes, numberOfPixels); break;
+    }
+  }
+  else if (instructionSet >= INSTRUCTION_SET_SSE2)
+  {
+    switch (bytesPerPixel)
+    {
+      case 1: numberOfReversedPixels = ReverseRowSse2<1>(inputBytes, outputBytes, numberOfPixels); break;
+      case 2: numberOfReversedPixels = ReverseRowSse2<2>(inputBytes, outputBytes, numberOfPixels); break;
+      case 4: numberOfReversedPixels = ReverseRowSse2<4>(inputBytes, outputBytes, numberOfPixels); break;
+      case 8: numberOfReversedPixels = ReverseRowSse2<8>(inputBytes, outputBytes, numberOfPixels); break;
+    }
+  }
+#endif
+
+  // The remaining pixels at the end of the input row go to the beginning of the output row
+  ReverseRowScalar(inputBytes + static_cast<size_t>(numberOfReversedPixels) * bytesPerPixel, outputBytes, numberOfPixels - numberOfReversedPixels, bytesPerPixel);
+}
+
+//----------------------------------------------------------------------------
+void PlusPixelKernels::Transpose(const void* input, long long inputRowStride, void* output, long long outputRowStride,
+                                 int numberOfInputRows, int numberOfInputColumns, int bytesPerPixel)
+{
+  const unsigned char* inputBytes = static_cast<const unsigned char*>(input);
+  unsigned char* outputBytes = static_cast<unsigned char*>(output);
+
+#if defined(PLUS_PIXEL_KERNELS_X86)
+  if (GetInstructionSet() >= INSTRUCTION_SET_SSE2
+      && TransposeSse2(inputBytes, inputRowStride, outputBytes, outputRowStride, numberOfInputRows, numberOfInputColumns, bytesPerPixel))
+  {
+    return;
+  }
+#endif
+
+  TransposeRegionScalar(inputBytes, inputRowStride, outputBytes, outputRowStride, 0, numberOfInputRows, 0, numberOfInputColumns, bytesPerPixel);
+}
+
+//----------------------------------------------------------------------------
+int PlusPixelKernels::Rgb24ToGray(int numberOfPixels, const unsigned char* input, unsigned char* output)
+{
+#if defined(PLUS_PIXEL_KERNELS_X86)
+  if (GetInstructionSet() >= INSTRUCTION_SET_AVX2)
+  {
+    return Rgb24ToGraySsse3(numberOfPixels, input, output);
+  }
+#endif
+  return 0;
+}
+
+//----------------------------------------------------------------------------
+int PlusPixelKernels::Rgba32ToGray(int numberOfPixels, const unsigned char* input, unsigned char* output)
+{
+#if defined(PLUS_PIXEL_KERNELS_X86)
+  InstructionSet instructionSet = GetInstructionSet();
+  if (instructionSet >= INSTRUCTION_SET_AVX2)
+  {
+    return Rgba32ToGrayAvx2(numberOfPixels, input, output);
+  }
+  if (instructionSet >= INSTRUCTION_SET_SSE2)
+  {
+    return Rgba32ToGraySse2(numberOfPixels, input, output);
+  }
+#endif
+  return 0;
+}
+
+//----------------------------------------------------------------------------
+int PlusPixelKernels::Yuy2ToBmp24(bool bgrOutput, int numberOfPixelPairs, const unsigned char* input, unsigned char* output)
+{
+#if defined(PLUS_PIXEL_KERNELS_X86)
+  if (GetInstructionSet() >= INSTRUCTION_SET_SSE2)
+  {
+    return Yuy2ToBmp24Sse2(bgrOutput, numberOfPixelPairs, input, output);
+  }
+#endif
+  return 0;
+}
+
+//----------------------------------------------------------------------------
+int PlusPixelKernels::Yuy2ToGray(int numberOfPixelPairs, const unsigned char* input, unsigned char* output)
+{
+#if defined(PLUS_PIXEL_KERNELS_X86)
+  if (GetInstructionSet() >= INSTRUCTION_SET_SSE2)
+  {
+    return Yuy2ToGraySse2(numberOfPixelPairs, input, output);
+  }
+#endif
+  return 0;
+}
@@ -0,0 +1,79 @@
+/*=Plus=header=begin======================================================
+  Program: Plus
+  Copyright (c) Laboratory for Percutaneous Surgery. All rights reserved.
+  See License.txt for details.
+=========================================================Plus=header=end*/
+
+#ifndef __PlusPixelKernels_h
+#define __PlusPixelKernels_h
+
+#include "vtkPlusCommonExport.h"
+
+/*!
+  \class PlusPixelKernels
+  \brief Vectorized implementations of the pixel copy and conversion loops that run on every acquired frame
+
+  The kernels use SSE2 or AVX2 instructions, selected at runtime based on the capabilities of the CPU.
+  The results are exactly the same as the results of the scalar implementations (PlusVideoFrame::FlipClipImage and PixelCodec),
+  which are used on CPUs that do not support these instruction sets.
+
+  The color conversion kernels only process the part of the image that fits into whole vectors and return the number
+  of converted pixels (or pixel pairs). The caller converts the remaining pixels with the scalar implementation.
+
+  \ingroup PlusLibCommon
+*/
+class vtkPlusCommonExport PlusPixelKernels
+{
+public:
+  enum InstructionSet
+  {
+    INSTRUCTION_SET_SCALAR,
+    INSTRUCTION_SET_SSE2,
+    INSTRUCTION_SET_AVX2
+  };
+
+  /*! Get the most capable instruction set that is supported by the CPU */
+  static InstructionSet GetSupportedInstructionSet();
+
+  /*! Get the instruction set that the kernels use: the supported instruction set, limited by the maximum instruction set */
+  static InstructionSet GetInstructionSet();
+
+  /*! Limit the instruction set that the kernels use (for testing and benchmarking). AVX2 by default, i.e., no limit. */
+  static void SetMaximumInstructionSet(InstructionSet instructionSet);
+
+  static const char* GetInstructionSetAsString(InstructionSet instructionSet);
+
+  /*!
+    Copy a row of pixels in reverse order.
+    \param input First pixel of the input row
+    \param output First pixel of the output row, must not overlap with the input row
+  */
+  static void ReverseRow(const void* input, void* output, int numberOfPixels, int bytesPerPixel);
+
+  /*!
+    Transpose a 2D array of pixels: output pixel at (row c, column r) = input pixel at (row r, column c).
+    Strides are in bytes. The output must not overlap with the input.
+  */
+  static void Transpose(const void* input, long long inputRowStride, void* output, long long outputRowStride,
+                        int numberOfInputRows, int numberOfInputColumns, int bytesPerPixel);
+
+  /*! Compute intensity of RGB24 pixels (same as PixelCodec::Rgb24ToGray). Returns the number of converted pixels. */
+  static int Rgb24ToGray(int numberOfPixels, const unsigned char* input, unsigned char* output);
+
+  /*! Compute intensity of RGBA32 pixels (same as PixelCodec::Rgba32ToGray). Returns the number of converted pixels. */
+  static int Rgba32ToGray(int numberOfPixels, const unsigned char* input, unsigned char* output);
+
+  /*!
+    Convert YUY2 pixel pairs to RGB24 or BGR24 (same as PixelCodec::Yuv422pToBmp24).
+    Returns the number of converted pixel pairs.
+  */
+  static int Yuy2ToBmp24(bool bgrOutput, int numberOfPixelPairs, const unsigned char* input, unsigned char* output);
+
+  /*! Convert YUY2 pixel pairs to grayscale (same as PixelCodec::Yuv422pToGray). Returns the number of converted pixel pairs. */
+  static int Yuy2ToGray(int numberOfPixelPairs, const unsigned char* input, unsigned char* output);
+
+private:
+  PlusPixelKernels(); // prevent instantiation
+};
+
+#endif
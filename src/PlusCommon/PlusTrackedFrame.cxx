@@ -12,9 +12,13 @@ See License.txt for details.
 #include "metaImage.h"
 #include "vtkImageData.h"
 #include "vtkMatrix4x4.h"
+#include "vtkPlusLazyFrameLoader.h"
 #include "vtkPoints.h"
 #include "vtkXMLUtilities.h"
 
+// STL includes
+#include <algorithm>
+
 //----------------------------------------------------------------------------
 // ************************* TrackedFrame ************************************
 //----------------------------------------------------------------------------
@@ -24,30 +28,57 @@ const std::string PlusTrackedFrame::TransformPostfix = "Transform";
 const std::string PlusTrackedFrame::TransformStatusPostfix = "TransformStatus";
 const int FLOATING_POINT_PRECISION = 16; // Number of digits used when writing transforms and timestamps
 
+namespace
+{
+  // Get transform field name from transform status field name (e.g., ProbeToTrackerTransformStatus => ProbeToTrackerTransform)
+  std::string GetTransformFieldNameFromStatusFieldName(const std::string& statusFieldName)
+  {
+    return statusFieldName.substr(0, statusFieldName.length() - (PlusTrackedFrame::TransformStatusPostfix.length() - PlusTrackedFrame::TransformPostfix.length()));
+  }
+}
+
+//----------------------------------------------------------------------------
+PlusTrackedFrame::FrameTransformEntry::FrameTransformEntry()
+  : Status(FIELD_INVALID)
+  , MatrixDefined(false)
+  , StatusDefined(false)
+{
+  vtkMatrix4x4::Identity(this->Matrix);
+}
+
 //----------------------------------------------------------------------------
 PlusTrackedFrame::PlusTrackedFrame()
 {
   this->Timestamp = 0;
+  this->FrameTransformFieldsOutOfDate = false;
   this->FrameSize[0] = 0;
   this->FrameSize[1] = 0;
   this->FrameSize[2] = 1; // single-slice frame by default
   this->FiducialPointsCoordinatePx = NULL;
+  this->ImageDataLoader = NULL;
+  this->ImageDataLoaderFrameIndex = 0;
+  std::fill(this->LatencyTraceTimestamps, this->LatencyTraceTimestamps + PlusLatencyTracer::NUMBER_OF_STAGES, 0.0);
 }
 
 //----------------------------------------------------------------------------
 PlusTrackedFrame::~PlusTrackedFrame()
 {
   this->SetFiducialPointsCoordinatePx(NULL);
+  this->SetImageDataLoader(NULL, 0);
 }
 
 //----------------------------------------------------------------------------
 PlusTrackedFrame::PlusTrackedFrame(const PlusTrackedFrame& frame)
 {
   this->Timestamp = 0;
+  this->FrameTransformFieldsOutOfDate = false;
   this->FrameSize[0] = 0;
   this->FrameSize[1] = 0;
   this->FrameSize[2] = 1; // single-slice frame by default
   this->FiducialPointsCoordinatePx = NULL;
+  this->ImageDataLoader = NULL;
+  this->ImageDataLoaderFrameIndex = 0;
+  std::fill(this->LatencyTraceTimestamps, this->LatencyTraceTimestamps + PlusLatencyTracer::NUMBER_OF_STAGES, 0.0);
 
   *this = frame;
 }
@@ -62,8 +93,20 @@ PlusTrackedFrame& PlusTrackedFrame::operator=(PlusTrackedFrame const& trackedFra
   }
 
   this->FrameFields = trackedFrame.FrameFields;
-  this->ImageData = trackedFrame.ImageData;
+  this->FrameTransforms = trackedFrame.FrameTransforms;
+  this->FrameTransformFieldsOutOfDate = trackedFrame.FrameTransformFieldsOutOfDate;
+  this->SetImageDataLoader(trackedFrame.ImageDataLoader, trackedFrame.ImageDataLoaderFrameIndex);
+  if (this->ImageDataLoader != NULL && !trackedFrame.ImageData.IsImageValid())
+  {
+    // The source frame is not loaded, do not keep our previous image, it will be loaded on first access
+    this->ImageData.ReleaseImage();
+  }
+  else
+  {
+    this->ImageData = trackedFrame.ImageData;
+  }
   this->Timestamp = trackedFrame.Timestamp;
+  std::copy(trackedFrame.LatencyTraceTimestamps, trackedFrame.LatencyTraceTimestamps + PlusLatencyTracer::NUMBER_OF_STAGES, this->LatencyTraceTimestamps);
   this->FrameSize[0] = trackedFrame.FrameSize[0];
   this->FrameSize[1] = trackedFrame.FrameSize[1];
   this->FrameSize[2] = trackedFrame.FrameSize[2];
@@ -97,10 +140,13 @@ PlusStatus PlusTrackedFrame::PrintToXML(vtkXMLDataElement* trackedFrame, const s
 
   trackedFrame->SetName("TrackedFrame");
   trackedFrame->SetDoubleAttribute("Timestamp", this->Timestamp);
-  trackedFrame->SetAttribute("ImageDataValid", (this->GetImageData()->IsImageValid() ? "true" : "false"));
+  // The image properties are available from the loader, the pixel data is not needed
+  bool imageDataValid = this->IsImageDataAvailable();
+  trackedFrame->SetAttribute("ImageDataValid", (imageDataValid ? "true" : "false"));
 
-  if (this->GetImageData()->IsImageValid())
+  if (imageDataValid)
   {
+    this->GetFrameSize();
     trackedFrame->SetIntAttribute("NumberOfBits", this->GetNumberOfBitsPerScalar());
     unsigned int numberOfScalarComponents(1);
     if (this->GetNumberOfScalarComponents(numberOfScalarComponents) == PLUS_FAIL)
@@ -120,6 +166,8 @@ PlusStatus PlusTrackedFrame::PrintToXML(vtkXMLDataElement* trackedFrame, const s
     trackedFrame->SetVectorAttribute("FrameSize", 3, frameSizeSigned);
   }
 
+  this->UpdateFrameTransformFields();
+
   for (auto fieldIter = FrameFields.begin(); fieldIter != FrameFields.end(); ++fieldIter)
   {
     // Only use requested transforms mechanism if the vector is not empty
@@ -270,19 +318,92 @@ PlusStatus PlusTrackedFrame::SetTrackedFrameFromXmlData(const char* strXmlData)
 //----------------------------------------------------------------------------
 FrameSizeType PlusTrackedFrame::GetFrameSize()
 {
+  if (this->ImageDataLoader != NULL && !this->ImageData.IsImageValid())
+  {
+    // Not loaded yet, all frames of the loader have the same size
+    this->FrameSize = this->ImageDataLoader->GetFrameSize();
+    return this->FrameSize;
+  }
   this->ImageData.GetFrameSize(this->FrameSize);
   return this->FrameSize;
 }
 
+//----------------------------------------------------------------------------
+bool PlusTrackedFrame::IsImageDataAvailable() const
+{
+  return this->ImageDataLoader != NULL || this->ImageData.IsImageValid();
+}
+
+//----------------------------------------------------------------------------
+PlusVideoFrame* PlusTrackedFrame::GetImageData()
+{
+  if (this->ImageDataLoader != NULL)
+  {
+    this->ImageDataLoader->LoadImageData(this, this->ImageDataLoaderFrameIndex);
+  }
+  return &(this->ImageData);
+}
+
+//----------------------------------------------------------------------------
+PlusStatus PlusTrackedFrame::ShallowCopyImageDataTo(PlusVideoFrame& image)
+{
+  if (this->ImageDataLoader != NULL)
+  {
+    // The copy is made while the loader is locked, so the image cannot be released in between
+    return this->ImageDataLoader->LoadImageData(this, this->ImageDataLoaderFrameIndex, &image);
+  }
+  return image.ShallowCopy(this->ImageData);
+}
+
+//----------------------------------------------------------------------------
+void PlusTrackedFrame::SetImageDataLoader(vtkPlusLazyFrameLoader* loader, int frameIndex)
+{
+  // The frame is always removed from the resident frames of the loader: the caller is about to release
+  // or replace the image, so the loader must not consider it loaded (it is added again at the next load).
+  if (this->ImageDataLoader != NULL)
+  {
+    this->ImageDataLoader->RemoveFrame(this);
+  }
+  if (loader != NULL && (loader != this->ImageDataLoader || frameIndex != this->ImageDataLoaderFrameIndex))
+  {
+    // The current image does not belong to the new frame
+    this->ImageData.ReleaseImage();
+  }
+
+  // Register the new loader first, in case it is the same as the old one
+  if (loader != NULL)
+  {
+    loader->Register(NULL);
+  }
+  if (this->ImageDataLoader != NULL)
+  {
+    this->ImageDataLoader->UnRegister(NULL);
+  }
+  this->ImageDataLoader = loader;
+  this->ImageDataLoaderFrameIndex = frameIndex;
+}
+
 //----------------------------------------------------------------------------
 void PlusTrackedFrame::SetImageData(const PlusVideoFrame& value)
 {
+  // The image is provided by the caller now, it must not be released or replaced by the loader
+  this->SetImageDataLoader(NULL, 0);
   this->ImageData = value;
 
   // Update our cached frame size
   this->ImageData.GetFrameSize(this->FrameSize);
 }
 
+//----------------------------------------------------------------------------
+void PlusTrackedFrame::ShallowCopyImageData(const PlusVideoFrame& value)
+{
+  this->SetImageDataLoader(NULL, 0);
+  this->ImageData.ShallowCopy(value);
+
+  // Update our cached frame size
+  this->ImageData.GetFrameSize(this->FrameSize);
+}
+
 //----------------------------------------------------------------------------
 void PlusTrackedFrame::SetTimestamp(double value)
 {
@@ -296,7 +417,7 @@ void PlusTrackedFrame::SetTimestamp(double value)
 int PlusTrackedFrame::GetNumberOfBitsPerScalar()
 {
   int numberOfBitsPerScalar(0);
-  numberOfBitsPerScalar = this->ImageData.GetNumberOfBytesPerScalar() * 8;
+  numberOfBitsPerScalar = this->GetNumberOfBytesPerScalar() * 8;
   return numberOfBitsPerScalar;
 }
 
@@ -310,13 +431,28 @@ int PlusTrackedFrame::GetNumberOfBitsPerPixel()
     LOG_ERROR("Unable to retrieve number of scalar components.");
     return -1;
   }
-  numberOfBitsPerScalar = this->ImageData.GetNumberOfBytesPerScalar() * 8 * numberOfScalarComponents;
+  numberOfBitsPerScalar = this->GetNumberOfBytesPerScalar() * 8 * numberOfScalarComponents;
   return numberOfBitsPerScalar;
 }
 
+//----------------------------------------------------------------------------
+int PlusTrackedFrame::GetNumberOfBytesPerScalar()
+{
+  if (this->ImageDataLoader != NULL && !this->ImageData.IsImageValid())
+  {
+    return PlusVideoFrame::GetNumberOfBytesPerScalar(this->ImageDataLoader->GetPixelType());
+  }
+  return this->ImageData.GetNumberOfBytesPerScalar();
+}
+
 //----------------------------------------------------------------------------
 PlusStatus PlusTrackedFrame::GetNumberOfScalarComponents(unsigned int& numberOfScalarComponents)
 {
+  if (this->ImageDataLoader != NULL && !this->ImageData.IsImageValid())
+  {
+    numberOfScalarComponents = this->ImageDataLoader->GetNumberOfScalarComponents();
+    return PLUS_SUCCESS;
+  }
   return this->ImageData.GetNumberOfScalarComponents(numberOfScalarComponents);
 }
 
@@ -355,6 +491,24 @@ void PlusTrackedFrame::SetFrameField(std::string name, std::string value)
       this->Timestamp = timestamp;
     }
   }
+  else if (IsTransformStatus(name))
+  {
+    // The string value overrides the binary status
+    TransformMapType::iterator transformIt = this->FrameTransforms.find(GetTransformFieldNameFromStatusFieldName(name));
+    if (transformIt != this->FrameTransforms.end())
+    {
+      transformIt->second.StatusDefined = false;
+    }
+  }
+  else if (IsTransform(name))
+  {
+    // The string value overrides the binary matrix
+    TransformMapType::iterator transformIt = this->FrameTransforms.find(name);
+    if (transformIt != this->FrameTransforms.end())
+    {
+      transformIt->second.MatrixDefined = false;
+    }
+  }
 
   this->FrameFields[name] = value;
 }
@@ -368,6 +522,11 @@ const char* PlusTrackedFrame::GetFrameField(const char* fieldName)
     return NULL;
   }
 
+  if (IsTransform(fieldName) || IsTransformStatus(fieldName))
+  {
+    this->UpdateFrameTransformFields();
+  }
+
   FieldMapType::iterator fieldIterator;
   fieldIterator = this->FrameFields.find(fieldName);
   if (fieldIterator != this->FrameFields.end())
@@ -392,6 +551,26 @@ PlusStatus PlusTrackedFrame::DeleteFrameField(const char* fieldName)
     return PLUS_FAIL;
   }
 
+  this->UpdateFrameTransformFields();
+
+  std::string fieldNameStr(fieldName);
+  if (IsTransformStatus(fieldNameStr))
+  {
+    TransformMapType::iterator transformIt = this->FrameTransforms.find(GetTransformFieldNameFromStatusFieldName(fieldNameStr));
+    if (transformIt != this->FrameTransforms.end())
+    {
+      transformIt->second.StatusDefined = false;
+    }
+  }
+  else if (IsTransform(fieldNameStr))
+  {
+    TransformMapType::iterator transformIt = this->FrameTransforms.find(fieldNameStr);
+    if (transformIt != this->FrameTransforms.end())
+    {
+      transformIt->second.MatrixDefined = false;
+    }
+  }
+
   FieldMapType::iterator field = this->FrameFields.find(fieldName);
   if (field != this->FrameFields.end())
   {
@@ -417,6 +596,12 @@ bool PlusTrackedFrame::IsFrameTransformNameDefined(const PlusTransformName& tran
     toolTransformName.append(TransformPostfix);
   }
 
+  TransformMapType::iterator transformIt = this->FrameTransforms.find(toolTransformName);
+  if (transformIt != this->FrameTransforms.end() && transformIt->second.MatrixDefined)
+  {
+    return true;
+  }
+
   return this->IsFrameFieldDefined(toolTransformName.c_str());
 }
 
@@ -429,6 +614,11 @@ bool PlusTrackedFrame::IsFrameFieldDefined(const char* fieldName)
     return false;
   }
 
+  if (IsTransform(fieldName) || IsTransformStatus(fieldName))
+  {
+    this->UpdateFrameTransformFields();
+  }
+
   FieldMapType::iterator fieldIterator;
   fieldIterator = this->FrameFields.find(fieldName);
   if (fieldIterator != this->FrameFields.end())
@@ -444,27 +634,29 @@ bool PlusTrackedFrame::IsFrameFieldDefined(const char* fieldName)
 PlusStatus PlusTrackedFrame::GetFrameTransform(const PlusTransformName& frameTransformName, double transform[16])
 {
   std::string transformName;
-  if (frameTransformName.GetTransformName(transformName) != PLUS_SUCCESS)
+  if (GetTransformFieldName(frameTransformName, transformName) != PLUS_SUCCESS)
   {
     LOG_ERROR("Unable to get custom transform, transform name is wrong!");
     return PLUS_FAIL;
   }
 
-  // Append Transform to the end of the transform name
-  if (!IsTransform(transformName))
+  TransformMapType::iterator transformIt = this->FrameTransforms.find(transformName);
+  if (transformIt != this->FrameTransforms.end() && transformIt->second.MatrixDefined)
   {
-    transformName.append(TransformPostfix);
+    std::copy(transformIt->second.Matrix, transformIt->second.Matrix + 16, transform);
+    return PLUS_SUCCESS;
   }
 
-  const char* frameTransformStr = GetFrameField(transformName.c_str());
-  if (frameTransformStr == NULL)
+  // Not available in binary form, parse it from the frame field (e.g., read from file)
+  FieldMapType::iterator fieldIt = this->FrameFields.find(transformName);
+  if (fieldIt == this->FrameFields.end())
   {
     LOG_ERROR("Unable to get custom transform from name: " << transformName);
     return PLUS_FAIL;
   }
 
   // Find default frame transform
-  std::istringstream transformFieldValue(frameTransformStr);
+  std::istringstream transformFieldValue(fieldIt->second);
   double item;
   int i = 0;
   while (transformFieldValue >> item && i < 16)
@@ -505,14 +697,22 @@ PlusStatus PlusTrackedFrame::GetFrameTransformStatus(const PlusTransformName& fr
     transformStatusName.append(TransformStatusPostfix);
   }
 
-  const char* strStatus = this->GetFrameField(transformStatusName.c_str());
-  if (strStatus == NULL)
+  TransformMapType::iterator transformIt = this->FrameTransforms.find(GetTransformFieldNameFromStatusFieldName(transformStatusName));
+  if (transformIt != this->FrameTransforms.end() && transformIt->second.StatusDefined)
+  {
+    status = transformIt->second.Status;
+    return PLUS_SUCCESS;
+  }
+
+  // Not available in binary form, get it from the frame field (e.g., read from file)
+  FieldMapType::iterator fieldIt = this->FrameFields.find(transformStatusName);
+  if (fieldIt == this->FrameFields.end())
   {
     LOG_ERROR("Unable to get custom transform status from name: " << transformStatusName);
     return PLUS_FAIL;
   }
 
-  status = PlusTrackedFrame::ConvertFieldStatusFromString(strStatus);
+  status = PlusTrackedFrame::ConvertFieldStatusFromString(fieldIt->second.c_str());
 
   return PLUS_SUCCESS;
 }
@@ -537,9 +737,11 @@ PlusStatus PlusTrackedFrame::SetFrameTransformStatus(const PlusTransformName& fr
     transformStatusName.append(TransformStatusPostfix);
   }
 
-  std::string strStatus = PlusTrackedFrame::ConvertFieldStatusToString(status);
-
-  this->SetFrameField(transformStatusName, strStatus);
+  // The string form is only generated when it is requested
+  FrameTransformEntry& entry = this->FrameTransforms[GetTransformFieldNameFromStatusFieldName(transformStatusName)];
+  entry.Status = status;
+  entry.StatusDefined = true;
+  this->FrameTransformFieldsOutOfDate = true;
 
   return PLUS_SUCCESS;
 }
@@ -547,26 +749,18 @@ PlusStatus PlusTrackedFrame::SetFrameTransformStatus(const PlusTransformName& fr
 //----------------------------------------------------------------------------
 PlusStatus PlusTrackedFrame::SetFrameTransform(const PlusTransformName& frameTransformName, double transform[16])
 {
-  std::ostringstream strTransform;
-  for (int i = 0; i < 16; ++i)
-  {
-    strTransform << std::setprecision(FLOATING_POINT_PRECISION) << transform[ i ] << " ";
-  }
-
   std::string transformName;
-  if (frameTransformName.GetTransformName(transformName) != PLUS_SUCCESS)
+  if (GetTransformFieldName(frameTransformName, transformName) != PLUS_SUCCESS)
   {
     LOG_ERROR("Unable to get custom transform, transform name is wrong!");
     return PLUS_FAIL;
   }
 
-  // Append Transform to the end of the transform name
-  if (!IsTransform(transformName))
-  {
-    transformName.append(TransformPostfix);
-  }
-
-  SetFrameField(transformName, strTransform.str());
+  // The string form is only generated when it is requested
+  FrameTransformEntry& entry = this->FrameTransforms[transformName];
+  std::copy(transform, transform + 16, entry.Matrix);
+  entry.MatrixDefined = true;
+  this->FrameTransformFieldsOutOfDate = true;
 
   return PLUS_SUCCESS;
 }
@@ -579,6 +773,51 @@ PlusStatus PlusTrackedFrame::SetFrameTransform(const PlusTransformName& frameTra
   return SetFrameTransform(frameTransformName, dTransform);
 }
 
+//----------------------------------------------------------------------------
+PlusStatus PlusTrackedFrame::GetTransformFieldName(const PlusTransformName& frameTransformName, std::string& transformFieldName)
+{
+  if (frameTransformName.GetTransformName(transformFieldName) != PLUS_SUCCESS)
+  {
+    return PLUS_FAIL;
+  }
+
+  // Append Transform to the end of the transform name
+  if (!IsTransform(transformFieldName))
+  {
+    transformFieldName.append(TransformPostfix);
+  }
+
+  return PLUS_SUCCESS;
+}
+
+//----------------------------------------------------------------------------
+void PlusTrackedFrame::UpdateFrameTransformFields()
+{
+  if (!this->FrameTransformFieldsOutOfDate)
+  {
+    return;
+  }
+
+  for (TransformMapType::const_iterator it = this->FrameTransforms.begin(); it != this->FrameTransforms.end(); ++it)
+  {
+    if (it->second.MatrixDefined)
+    {
+      std::ostringstream strTransform;
+      for (int i = 0; i < 16; ++i)
+      {
+        strTransform << std::setprecision(FLOATING_POINT_PRECISION) << it->second.Matrix[ i ] << " ";
+      }
+      this->FrameFields[it->first] = strTransform.str();
+    }
+    if (it->second.StatusDefined)
+    {
+      this->FrameFields[it->first + "Status"] = PlusTrackedFrame::ConvertFieldStatusToString(it->second.Status);
+    }
+  }
+
+  this->FrameTransformFieldsOutOfDate = false;
+}
+
 //----------------------------------------------------------------------------
 TrackedFrameFieldStatus PlusTrackedFrame::ConvertFieldStatusFromString(const char* statusStr)
 {
@@ -663,6 +902,7 @@ PlusStatus PlusTrackedFrame::WriteToFile(const std::string& filename, vtkMatrix4
 //----------------------------------------------------------------------------
 void PlusTrackedFrame::GetFrameFieldNameList(std::vector<std::string>& fieldNames)
 {
+  this->UpdateFrameTransformFields();
   fieldNames.clear();
   for (FieldMapType::const_iterator it = this->FrameFields.begin(); it != this->FrameFields.end(); it++)
   {
@@ -674,8 +914,23 @@ void PlusTrackedFrame::GetFrameFieldNameList(std::vector<std::string>& fieldName
 void PlusTrackedFrame::GetFrameTransformNameList(std::vector<PlusTransformName>& transformNames)
 {
   transformNames.clear();
+  for (TransformMapType::const_iterator it = this->FrameTransforms.begin(); it != this->FrameTransforms.end(); it++)
+  {
+    if (it->second.MatrixDefined)
+    {
+      PlusTransformName trName;
+      trName.SetTransformName(it->first.substr(0, it->first.length() - TransformPostfix.length()).c_str());
+      transformNames.push_back(trName);
+    }
+  }
   for (FieldMapType::const_iterator it = this->FrameFields.begin(); it != this->FrameFields.end(); it++)
   {
+    TransformMapType::const_iterator transformIt = this->FrameTransforms.find(it->first);
+    if (transformIt != this->FrameTransforms.end() && transformIt->second.MatrixDefined)
+    {
+      // already added from the binary transforms
+      continue;
+    }
     if (IsTransform(it->first))
     {
       PlusTransformName trName;
@@ -9,9 +9,11 @@
 
 #include "vtkPlusCommonExport.h"
 
+#include "PlusLatencyTracer.h"
 #include "PlusVideoFrame.h"
 
 class vtkMatrix4x4;
+class vtkPlusLazyFrameLoader;
 class vtkPoints;
 
 /*!
@@ -42,6 +44,23 @@ public:
   static const std::string TransformStatusPostfix;
   typedef std::map<std::string, std::string> FieldMapType;
 
+  /*!
+    \struct FrameTransformEntry
+    \brief Transform matrix and status stored in binary form
+    Frame transforms are kept in this form and they are only converted to string frame fields
+    when the string representation is requested (e.g., to write a sequence file).
+  */
+  struct FrameTransformEntry
+  {
+    FrameTransformEntry();
+    double Matrix[16];
+    TrackedFrameFieldStatus Status;
+    bool MatrixDefined;
+    bool StatusDefined;
+  };
+  /*! Frame transforms, the key is the transform field name (e.g., ProbeToTrackerTransform) */
+  typedef std::map<std::string, FrameTransformEntry> TransformMapType;
+
 public:
   PlusTrackedFrame();
   ~PlusTrackedFrame();
@@ -51,9 +70,34 @@ public:
 public:
   /*! Set image data */
   void SetImageData(const PlusVideoFrame& value);
+  /*! Set image data without copying the pixels: the tracked frame shares the image with the provided video frame (see PlusVideoFrame::ShallowCopy) */
+  void ShallowCopyImageData(const PlusVideoFrame& value);
+
+  /*!
+    Get image data. If the frame has an image data loader then the pixel data is read now if it is not in memory yet.
+    The loader releases the image of the frame when other frames are loaded (from any thread) unless a reference to the image
+    is held, so for lazily loaded frames a raw image pointer is only valid until the next load through the same loader.
+    Register the image (e.g., store it in a vtkSmartPointer) or use ShallowCopyImageDataTo to keep an image that is needed
+    while other frames are accessed. Use ShallowCopyImageDataTo when the frames are shared between threads.
+  */
+  PlusVideoFrame* GetImageData();
 
-  /*! Get image data */
-  PlusVideoFrame* GetImageData() { return &(this->ImageData); };
+  /*!
+    Get the image data as a shallow copy (see PlusVideoFrame::ShallowCopy). The copy keeps the image alive even if the
+    image data loader of the frame releases it, so it can be used safely while other threads load frames.
+  */
+  PlusStatus ShallowCopyImageDataTo(PlusVideoFrame& image);
+
+  /*!
+    Set the loader that reads the image data of this frame on first access (see vtkPlusSequenceIOBase::LazyImageLoading).
+    \param loader Image data loader, NULL detaches the frame from its loader (the current image data is kept).
+      If the loader or the frame index is changed then the current image data is released.
+    \param frameIndex Index of the frame in the pixel data file of the loader
+  */
+  void SetImageDataLoader(vtkPlusLazyFrameLoader* loader, int frameIndex);
+
+  /*! Get the loader that reads the image data on first access, NULL if the image data is stored in the frame */
+  vtkPlusLazyFrameLoader* GetImageDataLoader() const { return this->ImageDataLoader; }
 
   /*! Set timestamp */
   void SetTimestamp(double value);
@@ -61,6 +105,12 @@ public:
   /*! Get timestamp */
   double GetTimestamp() { return this->Timestamp; };
 
+  /*! Set the system time when the frame reached a latency tracing stage (see PlusLatencyTracer) */
+  void SetLatencyTraceTimestamp(PlusLatencyTracer::TraceStage stage, double systemTime) { this->LatencyTraceTimestamps[stage] = systemTime; };
+
+  /*! Get the system time when the frame reached a latency tracing stage, 0 if the stage has not been traced */
+  double GetLatencyTraceTimestamp(PlusLatencyTracer::TraceStage stage) const { return this->LatencyTraceTimestamps[stage]; };
+
   /*! Set frame field */
   void SetFrameField(std::string name, std::string value);
 
@@ -105,13 +155,16 @@ public:
   /*! Get the list of the transform name of all frame transforms*/
   void GetFrameTransformNameList(std::vector<PlusTransformName>& transformNames);
 
-  /*! Get tracked frame size in pixel. Returns: FrameSizeType.  */
+  /*! Get tracked frame size in pixel. Returns: FrameSizeType. Lazily loaded frames are not read from the file. */
   FrameSizeType GetFrameSize();
 
   /*! Get tracked frame pixel size in bits (scalar size * number of scalar components) */
   int GetNumberOfBitsPerScalar();
 
-  /*! Get number of scalar components in a pixel */
+  /*! Get the size of a scalar in bytes. Lazily loaded frames are not read from the file. */
+  int GetNumberOfBytesPerScalar();
+
+  /*! Get number of scalar components in a pixel. Lazily loaded frames are not read from the file. */
   PlusStatus GetNumberOfScalarComponents(unsigned int& numberOfScalarComponents);
 
   /*! Get number of bits in a pixel */
@@ -145,8 +198,12 @@ public:
   /*! Convert from field status enum to field status string */
   static std::string ConvertFieldStatusToString(TrackedFrameFieldStatus status);
 
-  /*! Return all custom fields in a map */
-  const FieldMapType& GetCustomFields() { return this->FrameFields; }
+  /*! Return all custom fields in a map (frame transforms are included in string form) */
+  const FieldMapType& GetCustomFields()
+  {
+    this->UpdateFrameTransformFields();
+    return this->FrameFields;
+  }
 
   /*! Returns true if the input string ends with "Transform", else false */
   static bool IsTransform(std::string str);
@@ -162,11 +219,37 @@ public:
   }
 
 protected:
+  /*! Write the string form of all binary frame transforms into the frame fields, if they are not written yet */
+  void UpdateFrameTransformFields();
+
+  /*! Get the frame field name of a transform (e.g., ProbeToTracker => ProbeToTrackerTransform) */
+  static PlusStatus GetTransformFieldName(const PlusTransformName& frameTransformName, std::string& transformFieldName);
+
+protected:
+  friend class vtkPlusLazyFrameLoader;
+
+  /*! Returns true if the frame has image data, either in memory or in the file of the image data loader (without loading it) */
+  bool IsImageDataAvailable() const;
+
   PlusVideoFrame ImageData;
   double Timestamp;
 
+  /*! System time when the frame reached each latency tracing stage */
+  double LatencyTraceTimestamps[PlusLatencyTracer::NUMBER_OF_STAGES];
+
+  /*! Reads the image data on first access, NULL if the image data is stored in ImageData */
+  vtkPlusLazyFrameLoader* ImageDataLoader;
+  /*! Index of the frame in the pixel data file of ImageDataLoader */
+  int ImageDataLoaderFrameIndex;
+
   FieldMapType FrameFields;
 
+  /*! Frame transforms in binary form. These take precedence over the transform values stored in FrameFields. */
+  TransformMapType FrameTransforms;
+
+  /*! If true then FrameFields do not yet contain the string form of all the FrameTransforms */
+  bool FrameTransformFieldsOutOfDate;
+
   FrameSizeType FrameSize;
 
   /*! Stores segmented fiducial point pixel coordinates */
@@ -6,16 +6,19 @@ See License.txt for details.
 
 // Local includes
 #include "PlusConfigure.h"
+#include "PlusPixelKernels.h"
 #include "PlusVideoFrame.h"
 
 // VTK includes
 #include <vtkBMPReader.h>
+#include <vtkDataArray.h>
 #include <vtkExtractVOI.h>
 #include <vtkImageData.h>
 #include <vtkImageImport.h>
 #include <vtkImageReader.h>
 #include <vtkObjectFactory.h>
 #include <vtkPNMReader.h>
+#include <vtkPointData.h>
 #include <vtkTIFFReader.h>
 #include <vtkTrivialProducer.h>
 
@@ -159,23 +162,12 @@ namespace
           // Set the input position to be the first unclipped pixel in the input image
           ScalarType* inputPixel = (ScalarType*)inBuff + (clipRectangleOrigin[2] + z) * inputImageIncrement + clipRectangleOrigin[1] * inputRowIncrement + clipRectangleOrigin[0] * pixelIncrement;
 
-          // Set the target position pointer to the last pixel of the first row of each output image
-          ScalarType* outputPixel = (ScalarType*)outBuff + z * outputImageIncrement + (outputWidth - 1) * pixelIncrement;
           // Copy the image row-by-row, reversing the pixel order in each row
           for (int y = 0; y < outputHeight; y++)
           {
-            for (int x = 0; x < outputWidth; x++)
-            {
-              // For each scalar, copy it
-              for (int s = 0; s < numberOfScalarComponents; ++s)
-              {
-                *(outputPixel + s) = *(inputPixel + s);
-              }
-              inputPixel += pixelIncrement;
-              outputPixel -= pixelIncrement;
-            }
-            // bring the output back to the end of the next row
-            outputPixel += 2 * outputRowIncrement;
+            ScalarType* outputRow = (ScalarType*)outBuff + z * outputImageIncrement + y * outputRowIncrement;
+            PlusPixelKernels::ReverseRow(inputPixel, outputRow, outputWidth, pixelIncrement * sizeof(ScalarType));
+            inputPixel += outputWidth * pixelIncrement;
             // wrap the input to the beginning of the next clipped row
             inputPixel += (inputWidth - localClipRectangleSize[0]) * pixelIncrement;
           }
@@ -221,21 +213,12 @@ namespace
           // Set the input position to be the first unclipped pixel in the input image
           ScalarType* inputPixel = (ScalarType*)inBuff + (clipRectangleOrigin[2] + z) * inputImageIncrement + clipRectangleOrigin[1] * inputRowIncrement + clipRectangleOrigin[0] * pixelIncrement;
 
-          // Set the target position pointer to the last pixel of each output image
-          ScalarType* outputPixel = (ScalarType*)outBuff + outputImageIncrement * (z + 1) - 1 * pixelIncrement;
-          // Copy the image pixel-by-pixel, reversing the pixel order
+          // Copy the image row-by-row, reversing the pixel order: the first input row is the last output row, reversed
           for (int y = 0; y < outputHeight; y++)
           {
-            for (int x = 0; x < outputWidth; x++)
-            {
-              // For each scalar, copy it
-              for (int s = 0; s < numberOfScalarComponents; ++s)
-              {
-                *(outputPixel + s) = *(inputPixel + s);
-              }
-              inputPixel += pixelIncrement;
-              outputPixel -= pixelIncrement;
-            }
+            ScalarType* outputRow = (ScalarType*)outBuff + outputImageIncrement * (z + 1) - (y + 1) * outputWidth * pixelIncrement;
+            PlusPixelKernels::ReverseRow(inputPixel, outputRow, outputWidth, pixelIncrement * sizeof(ScalarType));
+            inputPixel += outputWidth * pixelIncrement;
             // wrap the input to the beginning of the next clipped row
             inputPixel += (inputWidth - localClipRectangleSize[0]) * pixelIncrement;
           }
@@ -298,12 +281,27 @@ namespace
           inputPixel += (inputHeight - localClipRectangleSize[1]) * inputRowIncrement;
         }
       }
-      else
+      else if (!flipInfo.doubleRow)
       {
         // Transpose an image IJK to KIJ
         // Set the input position to the first unclipped pixel
         ScalarType* inputPixel = (ScalarType*)inBuff + clipRectangleOrigin[2] * inputImageIncrement + clipRectangleOrigin[1] * inputRowIncrement + clipRectangleOrigin[0] * pixelIncrement;
 
+        // Each output image is the transpose of the same row of all input images:
+        // input row y of image z, pixel x -> output image y, row x, pixel z
+        for (int y = 0; y < outputDepth; ++y)
+        {
+          PlusPixelKernels::Transpose(inputPixel + y * inputRowIncrement, inputImageIncrement * sizeof(ScalarType),
+                                      (ScalarType*)outBuff + y * outputImageIncrement, outputRowIncrement * sizeof(ScalarType),
+                                      outputWidth, outputHeight, pixelIncrement * sizeof(ScalarType));
+        }
+      }
+      else
+      {
+        // Transpose an image IJK to KIJ, pairs of rows kept together
+        // Set the input position to the first unclipped pixel
+        ScalarType* inputPixel = (ScalarType*)inBuff + clipRectangleOrigin[2] * inputImageIncrement + clipRectangleOrigin[1] * inputRowIncrement + clipRectangleOrigin[0] * pixelIncrement;
+
         for (int z = 0; z < outputWidth; ++z)
         {
           for (int y = 0; y < outputDepth; ++y)
@@ -467,6 +465,12 @@ PlusStatus PlusVideoFrame::AllocateFrame(const FrameSizeType& imageSize, PlusCom
   {
     this->SetImageData(vtkImageData::New());
   }
+  else if (this->IsImageShared())
+  {
+    // The pixels may still be read through a shallow copy of this frame, so don't reuse the image
+    this->Image->Delete();
+    this->SetImageData(vtkImageData::New());
+  }
   PlusStatus allocStatus = PlusVideoFrame::AllocateFrame(this->GetImage(), imageSize, pixType, numberOfScalarComponents);
   return allocStatus;
 }
@@ -536,6 +540,74 @@ PlusStatus PlusVideoFrame::ShallowCopyFrom(vtkImageData* frame)
   return PLUS_SUCCESS;
 }
 
+//----------------------------------------------------------------------------
+PlusStatus PlusVideoFrame::ShallowCopy(const PlusVideoFrame& videoItem)
+{
+  // Handle self-assignment
+  if (this == &videoItem)
+  {
+    return PLUS_SUCCESS;
+  }
+
+  this->ImageType = videoItem.ImageType;
+  this->ImageOrientation = videoItem.ImageOrientation;
+
+  // Register first, in case the two frames already share the same image
+  if (videoItem.Image != NULL)
+  {
+    videoItem.Image->Register(NULL);
+  }
+  DELETE_IF_NOT_NULL(this->Image);
+  this->SetImageData(videoItem.Image);
+
+  return PLUS_SUCCESS;
+}
+
+//----------------------------------------------------------------------------
+bool PlusVideoFrame::IsImageShared() const
+{
+  if (this->Image == NULL)
+  {
+    return false;
+  }
+  if (this->Image->GetReferenceCount() > 1)
+  {
+    return true;
+  }
+  // The pixel array may be shared even if the image object is not (e.g., vtkImageData::ShallowCopy was used)
+  vtkDataArray* scalars = this->Image->GetPointData()->GetScalars();
+  return (scalars != NULL && scalars->GetReferenceCount() > 1);
+}
+
+//----------------------------------------------------------------------------
+PlusStatus PlusVideoFrame::DetachSharedImage()
+{
+  if (!this->IsImageShared())
+  {
+    // already exclusively owned, nothing to do
+    return PLUS_SUCCESS;
+  }
+
+  vtkImageData* sharedImage = this->Image;
+  vtkImageData* newImage = vtkImageData::New();
+  newImage->SetExtent(sharedImage->GetExtent());
+  newImage->SetSpacing(sharedImage->GetSpacing());
+  newImage->SetOrigin(sharedImage->GetOrigin());
+  newImage->AllocateScalars(sharedImage->GetScalarType(), sharedImage->GetNumberOfScalarComponents());
+  this->SetImageData(newImage);
+
+  // Release our reference, the remaining users keep the shared image alive
+  sharedImage->Delete();
+
+  return PLUS_SUCCESS;
+}
+
+//----------------------------------------------------------------------------
+void PlusVideoFrame::ReleaseImage()
+{
+  DELETE_IF_NOT_NULL(this->Image);
+}
+
 //----------------------------------------------------------------------------
 int PlusVideoFrame::GetNumberOfBytesPerScalar() const
 {
@@ -180,6 +180,30 @@ public:
   /*! Sets the pixel buffer content by copying pixel data from a vtkImageData object.*/
   PlusStatus ShallowCopyFrom(vtkImageData* frame);
 
+  /*!
+    Share the image of another frame instead of copying its pixels.
+    The image is reference counted, so it remains valid as long as any of the frames uses it.
+    The shared pixel data must be treated as read-only. Writing to the frame through AllocateFrame,
+    DetachSharedImage or the assignment operator first detaches it from the shared image.
+  */
+  PlusStatus ShallowCopy(const PlusVideoFrame& videoItem);
+
+  /*! Returns true if the image (or its pixel array) is referenced by another object, too */
+  bool IsImageShared() const;
+
+  /*!
+    Make sure that no other frame can see the pixels that are about to be written into this frame.
+    If the image is shared then a new image with the same geometry is allocated for this frame and the
+    shared image is released (remaining users keep it alive). The content of the new image is undefined.
+  */
+  PlusStatus DetachSharedImage();
+
+  /*!
+    Release the image of this frame, after this the frame has no valid image.
+    Other frames that share the image (see ShallowCopy) keep it alive.
+  */
+  void ReleaseImage();
+
   /*! Get US_IMAGE_ORIENTATION enum value from string */
   static US_IMAGE_ORIENTATION GetUsImageOrientationFromString(const char* imgOrientationStr);
   static US_IMAGE_ORIENTATION GetUsImageOrientationFromString(const std::string& imgOrientationStr);
@@ -6,6 +6,8 @@ See License.txt for details.
 
 // Local includes
 #include "PlusConfigure.h"
+#include "PlusTrackedFrame.h"
+#include "PlusVideoFrame.h"
 #include "vtkPlusRecursiveCriticalSection.h"
 
 // VTK includes
@@ -116,6 +118,94 @@ namespace
     return PLUS_SUCCESS;
   }
 
+  PlusStatus TestVideoFrameSharing()
+  {
+    FrameSizeType frameSize = { 4, 3, 1 };
+    PlusVideoFrame source;
+    if (source.AllocateFrame(frameSize, VTK_UNSIGNED_CHAR, 1) != PLUS_SUCCESS)
+    {
+      return PLUS_FAIL;
+    }
+    source.FillBlank();
+
+    PlusVideoFrame view;
+    view.ShallowCopy(source);
+    if (view.GetImage() != source.GetImage() || !source.IsImageShared())
+    {
+      LOG_ERROR("Shallow copied frame does not share the image");
+      return PLUS_FAIL;
+    }
+
+    // Writing into the source must not be visible through the view
+    source.DetachSharedImage();
+    if (view.GetImage() == source.GetImage() || source.IsImageShared() || view.IsImageShared())
+    {
+      LOG_ERROR("Shared image was not detached");
+      return PLUS_FAIL;
+    }
+    static_cast<unsigned char*>(source.GetScalarPointer())[0] = 123;
+    if (static_cast<unsigned char*>(view.GetScalarPointer())[0] != 0)
+    {
+      LOG_ERROR("Writing into the detached frame modified the shared image");
+      return PLUS_FAIL;
+    }
+
+    return PLUS_SUCCESS;
+  }
+
+  PlusStatus TestTrackedFrameTransforms()
+  {
+    PlusTrackedFrame frame;
+    PlusTransformName probeToTracker("Probe", "Tracker");
+    double matrix[16] = { 1, 0, 0, 10.5, 0, 1, 0, -20.25, 0, 0, 1, 1.0 / 3.0, 0, 0, 0, 1 };
+    frame.SetFrameTransform(probeToTracker, matrix);
+    frame.SetFrameTransformStatus(probeToTracker, FIELD_OK);
+
+    double readMatrix[16] = { 0 };
+    TrackedFrameFieldStatus status = FIELD_INVALID;
+    if (frame.GetFrameTransform(probeToTracker, readMatrix) != PLUS_SUCCESS
+        || frame.GetFrameTransformStatus(probeToTracker, status) != PLUS_SUCCESS
+        || status != FIELD_OK)
+    {
+      LOG_ERROR("Failed to get frame transform");
+      return PLUS_FAIL;
+    }
+    for (int i = 0; i < 16; ++i)
+    {
+      if (readMatrix[i] != matrix[i])
+      {
+        LOG_ERROR("Frame transform element " << i << " mismatch: " << readMatrix[i] << " != " << matrix[i]);
+        return PLUS_FAIL;
+      }
+    }
+
+    // String representation is generated on request
+    const char* statusStr = frame.GetFrameField("ProbeToTrackerTransformStatus");
+    if (statusStr == NULL || std::string(statusStr) != "OK" || frame.GetFrameField("ProbeToTrackerTransform") == NULL)
+    {
+      LOG_ERROR("Frame transform fields are not available");
+      return PLUS_FAIL;
+    }
+
+    // String value overrides the binary value
+    frame.SetFrameField("ProbeToTrackerTransformStatus", "INVALID");
+    if (frame.GetFrameTransformStatus(probeToTracker, status) != PLUS_SUCCESS || status != FIELD_INVALID)
+    {
+      LOG_ERROR("Frame transform status was not updated from frame field");
+      return PLUS_FAIL;
+    }
+
+    std::vector<PlusTransformName> transformNames;
+    frame.GetFrameTransformNameList(transformNames);
+    if (transformNames.size() != 1 || !(transformNames[0] == probeToTracker))
+    {
+      LOG_ERROR("Unexpected frame transform name list");
+      return PLUS_FAIL;
+    }
+
+    return PLUS_SUCCESS;
+  }
+
   PlusStatus TestValidTransformName(std::string from, std::string to)
   {
     PlusTransformName transformName;
@@ -286,6 +376,10 @@ int main(int argc, char** argv)
 
   if (TestXMLFunctions() != PLUS_SUCCESS) { exit(EXIT_FAILURE); }
 
+  if (TestVideoFrameSharing() != PLUS_SUCCESS) { exit(EXIT_FAILURE); }
+
+  if (TestTrackedFrameTransforms() != PLUS_SUCCESS) { exit(EXIT_FAILURE); }
+
   LOG_INFO("Test finished successfully!");
   return EXIT_SUCCESS;
 }
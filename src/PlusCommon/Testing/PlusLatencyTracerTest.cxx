@@ -0,0 +1,131 @@
+/*=Plus=header=begin======================================================
+Program: Plus
+Copyright (c) Laboratory for Percutaneous Surgery. All rights reserved.
+See License.txt for details.
+=========================================================Plus=header=end*/
+
+/*!
+  \file PlusLatencyTracerTest.cxx
+  \brief Verifies the latency statistics computed by PlusLatencyTracer from known latency values
+*/
+
+// Local includes
+#include "PlusConfigure.h"
+#include "PlusLatencyTracer.h"
+
+// VTK includes
+#include <vtksys/CommandLineArguments.hxx>
+
+// STL includes
+#include <cmath>
+
+namespace
+{
+  // Histogram bins are 1/8 octave wide, the estimated percentiles are within this relative error
+  const double MAX_RELATIVE_PERCENTILE_ERROR = 0.1;
+
+  //----------------------------------------------------------------------------
+  bool IsPercentileAccurate(double estimatedSec, double expectedSec)
+  {
+    return std::abs(estimatedSec - expectedSec) <= MAX_RELATIVE_PERCENTILE_ERROR * expectedSec;
+  }
+}
+
+int main(int argc, char** argv)
+{
+  bool printHelp(false);
+  int verboseLevel = vtkPlusLogger::LOG_LEVEL_UNDEFINED;
+
+  vtksys::CommandLineArguments args;
+  args.Initialize(argc, argv);
+
+  args.AddArgument("--help", vtksys::CommandLineArguments::NO_ARGUMENT, &printHelp, "Print this help.");
+  args.AddArgument("--verbose", vtksys::CommandLineArguments::EQUAL_ARGUMENT, &verboseLevel, "Verbose level (1=error only, 2=warning, 3=info, 4=debug, 5=trace)");
+
+  if (!args.Parse())
+  {
+    std::cerr << "Problem parsing arguments" << std::endl;
+    std::cout << "Help: " << args.GetHelp() << std::endl;
+    exit(EXIT_FAILURE);
+  }
+
+  if (printHelp)
+  {
+    std::cout << args.GetHelp() << std::endl;
+    exit(EXIT_SUCCESS);
+  }
+
+  vtkPlusLogger::Instance()->SetLogLevel(verboseLevel);
+
+  PlusLatencyTracer* tracer = PlusLatencyTracer::GetInstance();
+  if (PlusLatencyTracer::IsEnabled())
+  {
+    LOG_ERROR("Latency tracing is expected to be disabled by default");
+    exit(EXIT_FAILURE);
+  }
+
+  tracer->SetLogIntervalSec(0);
+  tracer->Reset();
+
+  // Latencies of 1, 2, ..., 100 ms at the buffered stage, and 10 times more at the broadcast stage
+  const double acquisitionTime = 1000.0;
+  const int numberOfFrames = 100;
+  for (int frameIndex = 1; frameIndex <= numberOfFrames; ++frameIndex)
+  {
+    tracer->RecordLatency(PlusLatencyTracer::STAGE_BUFFERED, "Video", acquisitionTime, acquisitionTime + frameIndex * 0.001);
+    tracer->RecordLatency(PlusLatencyTracer::STAGE_BROADCAST, "TrackedVideoStream", acquisitionTime, acquisitionTime + frameIndex * 0.010);
+  }
+
+  std::vector<PlusLatencyTracer::LatencyStatistics> statistics;
+  tracer->GetLatencyStatistics(statistics);
+  if (statistics.size() != 2)
+  {
+    LOG_ERROR("Expected statistics for 2 stages, got " << statistics.size());
+    exit(EXIT_FAILURE);
+  }
+
+  int numberOfErrors = 0;
+  for (std::vector<PlusLatencyTracer::LatencyStatistics>::iterator it = statistics.begin(); it != statistics.end(); ++it)
+  {
+    double latencyScaleSec = (it->Stage == PlusLatencyTracer::STAGE_BUFFERED ? 0.001 : 0.010);
+    if (it->NumberOfFrames != numberOfFrames)
+    {
+      LOG_ERROR(it->SourceName << ": expected " << numberOfFrames << " frames, got " << it->NumberOfFrames);
+      numberOfErrors++;
+    }
+    if (!IsPercentileAccurate(it->MedianSec, 50 * latencyScaleSec))
+    {
+      LOG_ERROR(it->SourceName << ": median latency is " << it->MedianSec << " sec, expected " << 50 * latencyScaleSec);
+      numberOfErrors++;
+    }
+    if (!IsPercentileAccurate(it->Percentile99Sec, 99 * latencyScaleSec))
+    {
+      LOG_ERROR(it->SourceName << ": 99th percentile latency is " << it->Percentile99Sec << " sec, expected " << 99 * latencyScaleSec);
+      numberOfErrors++;
+    }
+    if (std::abs(it->MaximumSec - numberOfFrames * latencyScaleSec) > 1e-6)
+    {
+      LOG_ERROR(it->SourceName << ": maximum latency is " << it->MaximumSec << " sec, expected " << numberOfFrames * latencyScaleSec);
+      numberOfErrors++;
+    }
+  }
+
+  LOG_INFO("Latency report: " << tracer->GetLatencyReport());
+
+  tracer->Reset();
+  tracer->GetLatencyStatistics(statistics);
+  if (!statistics.empty())
+  {
+    LOG_ERROR("Statistics are not cleared by Reset");
+    numberOfErrors++;
+  }
+
+  if (numberOfErrors > 0)
+  {
+    LOG_ERROR("Test failed with " << numberOfErrors << " errors");
+    exit(EXIT_FAILURE);
+  }
+
+  LOG_INFO("Test completed successfully");
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,323 @@
+/*=Plus=header=begin======================================================
+Program: Plus
+Copyright (c) Laboratory for Percutaneous Surgery. All rights reserved.
+See License.txt for details.
+=========================================================Plus=header=end*/
+
+/*!
+  \file PlusPixelKernelsTest.cxx
+  \brief Verifies that the vectorized pixel kernels produce the same output as the scalar implementation
+  on all instruction sets that the CPU supports. With --benchmark the processing time of each kernel is printed.
+*/
+
+// Local includes
+#include "PlusConfigure.h"
+#include "PixelCodec.h"
+#include "PlusPixelKernels.h"
+#include "PlusVideoFrame.h"
+#include "vtkPlusAccurateTimer.h"
+
+// VTK includes
+#include <vtkImageData.h>
+#include <vtkSmartPointer.h>
+#include <vtksys/CommandLineArguments.hxx>
+
+namespace
+{
+  //----------------------------------------------------------------------------
+  void FillTestPattern(unsigned char* data, size_t numberOfBytes, unsigned int seed)
+  {
+    for (size_t i = 0; i < numberOfBytes; ++i)
+    {
+      seed = seed * 1103515245 + 12345;
+      data[i] = static_cast<unsigned char>(seed >> 16);
+    }
+  }
+
+  //----------------------------------------------------------------------------
+  vtkSmartPointer<vtkImageData> CreateTestImage(int width, int height, int depth, int scalarType, int numberOfComponents)
+  {
+    vtkSmartPointer<vtkImageData> image = vtkSmartPointer<vtkImageData>::New();
+    image->SetExtent(0, width - 1, 0, height - 1, 0, depth - 1);
+    image->AllocateScalars(scalarType, numberOfComponents);
+    FillTestPattern(static_cast<unsigned char*>(image->GetScalarPointer()),
+                    static_cast<size_t>(image->GetNumberOfPoints()) * numberOfComponents * image->GetScalarSize(), width * 31 + height);
+    return image;
+  }
+
+  //----------------------------------------------------------------------------
+  bool IsImageEqual(vtkImageData* image1, vtkImageData* image2)
+  {
+    int dims1[3] = { 0, 0, 0 };
+    int dims2[3] = { 0, 0, 0 };
+    image1->GetDimensions(dims1);
+    image2->GetDimensions(dims2);
+    if (dims1[0] != dims2[0] || dims1[1] != dims2[1] || dims1[2] != dims2[2])
+    {
+      return false;
+    }
+    size_t numberOfBytes = static_cast<size_t>(image1->GetNumberOfPoints()) * image1->GetNumberOfScalarComponents() * image1->GetScalarSize();
+    return memcmp(image1->GetScalarPointer(), image2->GetScalarPointer(), numberOfBytes) == 0;
+  }
+
+  //----------------------------------------------------------------------------
+  std::string GetFlipDescription(const PlusVideoFrame::FlipInfoType& flipInfo)
+  {
+    std::ostringstream description;
+    description << (flipInfo.hFlip ? "X" : "") << (flipInfo.vFlip ? "Y" : "") << (flipInfo.tranpose != PlusVideoFrame::TRANSPOSE_NONE ? "T" : "");
+    return description.str();
+  }
+
+  //----------------------------------------------------------------------------
+  PlusStatus TestFlipClip(PlusPixelKernels::InstructionSet instructionSet)
+  {
+    const int scalarTypes[] = { VTK_UNSIGNED_CHAR, VTK_SHORT, VTK_FLOAT, VTK_DOUBLE };
+    const int sizes[][3] = { { 1, 1, 1 }, { 7, 5, 1 }, { 33, 17, 1 }, { 64, 48, 1 }, { 101, 67, 3 } };
+    PlusVideoFrame::FlipInfoType flipInfos[3];
+    flipInfos[0].hFlip = true;
+    flipInfos[1].hFlip = true;
+    flipInfos[1].vFlip = true;
+    flipInfos[2].tranpose = PlusVideoFrame::TRANSPOSE_IJKtoKIJ;
+    const std::array<int, 3> noClipOrigin = { PlusCommon::NO_CLIP, PlusCommon::NO_CLIP, PlusCommon::NO_CLIP };
+    const std::array<int, 3> noClipSize = { PlusCommon::NO_CLIP, PlusCommon::NO_CLIP, PlusCommon::NO_CLIP };
+
+    for (unsigned int scalarTypeIndex = 0; scalarTypeIndex < sizeof(scalarTypes) / sizeof(scalarTypes[0]); ++scalarTypeIndex)
+    {
+      for (int numberOfComponents = 1; numberOfComponents <= 4; ++numberOfComponents)
+      {
+        for (unsigned int sizeIndex = 0; sizeIndex < sizeof(sizes) / sizeof(sizes[0]); ++sizeIndex)
+        {
+          vtkSmartPointer<vtkImageData> inputImage = CreateTestImage(sizes[sizeIndex][0], sizes[sizeIndex][1], sizes[sizeIndex][2],
+              scalarTypes[scalarTypeIndex], numberOfComponents);
+          for (unsigned int flipIndex = 0; flipIndex < sizeof(flipInfos) / sizeof(flipInfos[0]); ++flipIndex)
+          {
+            vtkSmartPointer<vtkImageData> expectedImage = vtkSmartPointer<vtkImageData>::New();
+            PlusPixelKernels::SetMaximumInstructionSet(PlusPixelKernels::INSTRUCTION_SET_SCALAR);
+            PlusVideoFrame::FlipClipImage(inputImage, flipInfos[flipIndex], noClipOrigin, noClipSize, expectedImage);
+
+            vtkSmartPointer<vtkImageData> actualImage = vtkSmartPointer<vtkImageData>::New();
+            PlusPixelKernels::SetMaximumInstructionSet(instructionSet);
+            PlusVideoFrame::FlipClipImage(inputImage, flipInfos[flipIndex], noClipOrigin, noClipSize, actualImage);
+
+            if (!IsImageEqual(expectedImage, actualImage))
+            {
+              LOG_ERROR("Flip " << GetFlipDescription(flipInfos[flipIndex]) << " result mismatch (" << PlusPixelKernels::GetInstructionSetAsString(instructionSet)
+                        << ", scalar type " << scalarTypes[scalarTypeIndex] << ", " << numberOfComponents << " components, size "
+                        << sizes[sizeIndex][0] << "x" << sizes[sizeIndex][1] << "x" << sizes[sizeIndex][2] << ")");
+              return PLUS_FAIL;
+            }
+          }
+        }
+      }
+    }
+    return PLUS_SUCCESS;
+  }
+
+  //----------------------------------------------------------------------------
+  PlusStatus TestPixelCodec(PlusPixelKernels::InstructionSet instructionSet)
+  {
+    const int sizes[][2] = { { 2, 1 }, { 6, 3 }, { 30, 7 }, { 64, 48 }, { 322, 41 } };
+    for (unsigned int sizeIndex = 0; sizeIndex < sizeof(sizes) / sizeof(sizes[0]); ++sizeIndex)
+    {
+      int width = sizes[sizeIndex][0];
+      int height = sizes[sizeIndex][1];
+      std::vector<unsigned char> input(width * height * 4);
+      FillTestPattern(&input[0], input.size(), width + height);
+      std::vector<unsigned char> expected(width * height * 3);
+      std::vector<unsigned char> actual(width * height * 3);
+
+      const PixelCodec::PixelEncoding grayEncodings[] = { PixelCodec::PixelEncoding_RGB24, PixelCodec::PixelEncoding_RGBA32, PixelCodec::PixelEncoding_YUY2 };
+      for (unsigned int encodingIndex = 0; encodingIndex < sizeof(grayEncodings) / sizeof(grayEncodings[0]); ++encodingIndex)
+      {
+        PlusPixelKernels::SetMaximumInstructionSet(PlusPixelKernels::INSTRUCTION_SET_SCALAR);
+        PixelCodec::ConvertToGray(grayEncodings[encodingIndex], width, height, &input[0], &expected[0]);
+        PlusPixelKernels::SetMaximumInstructionSet(instructionSet);
+        PixelCodec::ConvertToGray(grayEncodings[encodingIndex], width, height, &input[0], &actual[0]);
+        if (memcmp(&expected[0], &actual[0], width * height) != 0)
+        {
+          LOG_ERROR("Conversion of " << PixelCodec::GetCompressionModeAsString(grayEncodings[encodingIndex]) << " to grayscale result mismatch ("
+                    << PlusPixelKernels::GetInstructionSetAsString(instructionSet) << ", size " << width << "x" << height << ")");
+          return PLUS_FAIL;
+        }
+      }
+
+      const PixelCodec::ComponentOrdering orderings[] = { PixelCodec::ComponentOrder_RGB, PixelCodec::ComponentOrder_BGR };
+      for (unsigned int orderingIndex = 0; orderingIndex < sizeof(orderings) / sizeof(orderings[0]); ++orderingIndex)
+      {
+        PlusPixelKernels::SetMaximumInstructionSet(PlusPixelKernels::INSTRUCTION_SET_SCALAR);
+        PixelCodec::ConvertToBmp24(orderings[orderingIndex], PixelCodec::PixelEncoding_YUY2, width, height, &input[0], &expected[0]);
+        PlusPixelKernels::SetMaximumInstructionSet(instructionSet);
+        PixelCodec::ConvertToBmp24(orderings[orderingIndex], PixelCodec::PixelEncoding_YUY2, width, height, &input[0], &actual[0]);
+        if (expected != actual)
+        {
+          LOG_ERROR("Conversion of YUY2 to BMP24 result mismatch (" << PlusPixelKernels::GetInstructionSetAsString(instructionSet)
+                    << ", size " << width << "x" << height << ")");
+          return PLUS_FAIL;
+        }
+      }
+    }
+    return PLUS_SUCCESS;
+  }
+
+  //----------------------------------------------------------------------------
+  PlusStatus TestYuy2AllValues(PlusPixelKernels::InstructionSet instructionSet)
+  {
+    // All Y values with all U and V combinations
+    const int width = 256 * 2;
+    const int height = 256 * 256 / 2;
+    std::vector<unsigned char> input(width * height * 2);
+    for (int i = 0; i < width * height / 2; ++i)
+    {
+      input[i * 4] = static_cast<unsigned char>(i);
+      input[i * 4 + 1] = static_cast<unsigned char>(i >> 8);
+      input[i * 4 + 2] = static_cast<unsigned char>(255 - i);
+      input[i * 4 + 3] = static_cast<unsigned char>(i >> 16 | i << 1);
+    }
+    std::vector<unsigned char> expected(width * height * 3);
+    std::vector<unsigned char> actual(width * height * 3);
+    PlusPixelKernels::SetMaximumInstructionSet(PlusPixelKernels::INSTRUCTION_SET_SCALAR);
+    PixelCodec::ConvertToBmp24(PixelCodec::ComponentOrder_RGB, PixelCodec::PixelEncoding_YUY2, width, height, &input[0], &expected[0]);
+    PlusPixelKernels::SetMaximumInstructionSet(instructionSet);
+    PixelCodec::ConvertToBmp24(PixelCodec::ComponentOrder_RGB, PixelCodec::PixelEncoding_YUY2, width, height, &input[0], &actual[0]);
+    if (expected != actual)
+    {
+      LOG_ERROR("Conversion of YUY2 to RGB24 result mismatch (" << PlusPixelKernels::GetInstructionSetAsString(instructionSet) << ")");
+      return PLUS_FAIL;
+    }
+    return PLUS_SUCCESS;
+  }
+
+  //----------------------------------------------------------------------------
+  void PrintBenchmarkResult(const std::string& name, PlusPixelKernels::InstructionSet instructionSet, double startTime, int numberOfIterations)
+  {
+    double elapsedTimeMs = (vtkPlusAccurateTimer::GetSystemTime() - startTime) * 1000.0 / numberOfIterations;
+    LOG_INFO(name << " (" << PlusPixelKernels::GetInstructionSetAsString(instructionSet) << "): " << std::fixed << std::setprecision(3) << elapsedTimeMs << " ms");
+  }
+
+  //----------------------------------------------------------------------------
+  void RunBenchmark(int width, int height, int numberOfIterations)
+  {
+    vtkSmartPointer<vtkImageData> grayImage = CreateTestImage(width, height, 1, VTK_UNSIGNED_CHAR, 1);
+    vtkSmartPointer<vtkImageData> rgbImage = CreateTestImage(width, height, 1, VTK_UNSIGNED_CHAR, 3);
+    vtkSmartPointer<vtkImageData> outputImage = vtkSmartPointer<vtkImageData>::New();
+    std::vector<unsigned char> input(width * height * 4);
+    FillTestPattern(&input[0], input.size(), 1);
+    std::vector<unsigned char> output(width * height * 3);
+    const std::array<int, 3> noClip = { PlusCommon::NO_CLIP, PlusCommon::NO_CLIP, PlusCommon::NO_CLIP };
+    PlusVideoFrame::FlipInfoType flipX;
+    flipX.hFlip = true;
+    PlusVideoFrame::FlipInfoType transpose;
+    transpose.tranpose = PlusVideoFrame::TRANSPOSE_IJKtoKIJ;
+
+    LOG_INFO("Benchmark image size: " << width << "x" << height << ", " << numberOfIterations << " iterations");
+    for (int instructionSet = PlusPixelKernels::INSTRUCTION_SET_SCALAR; instructionSet <= PlusPixelKernels::GetSupportedInstructionSet(); ++instructionSet)
+    {
+      PlusPixelKernels::InstructionSet currentInstructionSet = static_cast<PlusPixelKernels::InstructionSet>(instructionSet);
+      PlusPixelKernels::SetMaximumInstructionSet(currentInstructionSet);
+      double startTime = vtkPlusAccurateTimer::GetSystemTime();
+      for (int i = 0; i < numberOfIterations; ++i)
+      {
+        PlusVideoFrame::FlipClipImage(grayImage, flipX, noClip, noClip, outputImage);
+      }
+      PrintBenchmarkResult("Flip X gray", currentInstructionSet, startTime, numberOfIterations);
+
+      startTime = vtkPlusAccurateTimer::GetSystemTime();
+      for (int i = 0; i < numberOfIterations; ++i)
+      {
+        PlusVideoFrame::FlipClipImage(rgbImage, flipX, noClip, noClip, outputImage);
+      }
+      PrintBenchmarkResult("Flip X RGB", currentInstructionSet, startTime, numberOfIterations);
+
+      startTime = vtkPlusAccurateTimer::GetSystemTime();
+      for (int i = 0; i < numberOfIterations; ++i)
+      {
+        PlusVideoFrame::FlipClipImage(grayImage, transpose, noClip, noClip, outputImage);
+      }
+      PrintBenchmarkResult("Transpose gray", currentInstructionSet, startTime, numberOfIterations);
+
+      startTime = vtkPlusAccurateTimer::GetSystemTime();
+      for (int i = 0; i < numberOfIterations; ++i)
+      {
+        PixelCodec::ConvertToGray(PixelCodec::PixelEncoding_RGB24, width, height, &input[0], &output[0]);
+      }
+      PrintBenchmarkResult("RGB24 to gray", currentInstructionSet, startTime, numberOfIterations);
+
+      startTime = vtkPlusAccurateTimer::GetSystemTime();
+      for (int i = 0; i < numberOfIterations; ++i)
+      {
+        PixelCodec::ConvertToGray(PixelCodec::PixelEncoding_RGBA32, width, height, &input[0], &output[0]);
+      }
+      PrintBenchmarkResult("RGBA32 to gray", currentInstructionSet, startTime, numberOfIterations);
+
+      startTime = vtkPlusAccurateTimer::GetSystemTime();
+      for (int i = 0; i < numberOfIterations; ++i)
+      {
+        PixelCodec::ConvertToBmp24(PixelCodec::ComponentOrder_RGB, PixelCodec::PixelEncoding_YUY2, width, height, &input[0], &output[0]);
+      }
+      PrintBenchmarkResult("YUY2 to RGB24", currentInstructionSet, startTime, numberOfIterations);
+
+      startTime = vtkPlusAccurateTimer::GetSystemTime();
+      for (int i = 0; i < numberOfIterations; ++i)
+      {
+        PixelCodec::ConvertToGray(PixelCodec::PixelEncoding_YUY2, width, height, &input[0], &output[0]);
+      }
+      PrintBenchmarkResult("YUY2 to gray", currentInstructionSet, startTime, numberOfIterations);
+    }
+    PlusPixelKernels::SetMaximumInstructionSet(PlusPixelKernels::INSTRUCTION_SET_AVX2);
+  }
+}
+
+//----------------------------------------------------------------------------
+int main(int argc, char** argv)
+{
+  bool printHelp(false);
+  bool benchmark(false);
+  int benchmarkIterations(100);
+  int verboseLevel = vtkPlusLogger::LOG_LEVEL_UNDEFINED;
+
+  vtksys::CommandLineArguments args;
+  args.Initialize(argc, argv);
+
+  args.AddArgument("--help", vtksys::CommandLineArguments::NO_ARGUMENT, &printHelp, "Print this help.");
+  args.AddArgument("--benchmark", vtksys::CommandLineArguments::NO_ARGUMENT, &benchmark, "Print processing time of each kernel with each supported instruction set.");
+  args.AddArgument("--benchmark-iterations", vtksys::CommandLineArguments::EQUAL_ARGUMENT, &benchmarkIterations, "Number of times each kernel is run in the benchmark (default: 100).");
+  args.AddArgument("--verbose", vtksys::CommandLineArguments::EQUAL_ARGUMENT, &verboseLevel, "Verbose level (1=error only, 2=warning, 3=info, 4=debug, 5=trace)");
+
+  if (!args.Parse())
+  {
+    std::cerr << "Problem parsing arguments" << std::endl;
+    std::cout << "Help: " << args.GetHelp() << std::endl;
+    exit(EXIT_FAILURE);
+  }
+
+  if (printHelp)
+  {
+    std::cout << args.GetHelp() << std::endl;
+    exit(EXIT_SUCCESS);
+  }
+
+  vtkPlusLogger::Instance()->SetLogLevel(verboseLevel);
+
+  LOG_INFO("Supported instruction set: " << PlusPixelKernels::GetInstructionSetAsString(PlusPixelKernels::GetSupportedInstructionSet()));
+  for (int instructionSet = PlusPixelKernels::INSTRUCTION_SET_SCALAR; instructionSet <= PlusPixelKernels::GetSupportedInstructionSet(); ++instructionSet)
+  {
+    PlusPixelKernels::InstructionSet currentInstructionSet = static_cast<PlusPixelKernels::InstructionSet>(instructionSet);
+    if (TestFlipClip(currentInstructionSet) != PLUS_SUCCESS
+        || TestPixelCodec(currentInstructionSet) != PLUS_SUCCESS
+        || TestYuy2AllValues(currentInstructionSet) != PLUS_SUCCESS)
+    {
+      exit(EXIT_FAILURE);
+    }
+    LOG_INFO("Results with " << PlusPixelKernels::GetInstructionSetAsString(currentInstructionSet) << " instruction set match the scalar implementation");
+  }
+  PlusPixelKernels::SetMaximumInstructionSet(PlusPixelKernels::INSTRUCTION_SET_AVX2);
+
+  if (benchmark)
+  {
+    RunBenchmark(640, 480, benchmarkIterations);
+    RunBenchmark(1920, 1080, benchmarkIterations);
+  }
+
+  LOG_INFO("Test completed successfully!");
+  return EXIT_SUCCESS;
+}
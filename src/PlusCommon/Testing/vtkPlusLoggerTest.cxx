@@ -6,8 +6,14 @@
 
 #include "PlusConfigure.h"
 
+#include "vtkCallbackCommand.h"
 #include "vtksys/CommandLineArguments.hxx"
 #include "vtkSmartPointer.h"
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <thread>
+#include <vector>
 
 class vtkLogTestObject : public vtkObject
 {
@@ -28,9 +34,158 @@ protected:
   virtual ~vtkLogTestObject() {}; 
 };
 
+namespace
+{
+  const char ASYNC_TEST_MESSAGE[] = "This is an asynchronous test message";
+  const int NUMBER_OF_ASYNC_TEST_MESSAGES = 200;
+  const char ASYNC_STOP_TEST_MESSAGE[] = "This is a message logged while asynchronous logging is stopped";
+  const int NUMBER_OF_ASYNC_STOP_TEST_THREADS = 4;
+  const int NUMBER_OF_ASYNC_STOP_TEST_MESSAGES_PER_THREAD = 500;
+  const char DROPPED_MESSAGES_REPORT[] = "log messages were dropped";
+
+  //----------------------------------------------------------------------------
+  struct MessageCounter
+  {
+    MessageCounter(const char* text) : Text(text), NumberOfMessages(0) {}
+    const char* Text;
+    std::atomic<int> NumberOfMessages;
+  };
+
+  //----------------------------------------------------------------------------
+  // Count the logged messages that contain a text (called on the asynchronous logging thread or on the logging thread)
+  void CountMessages(vtkObject* caller, unsigned long eventId, void* clientData, void* callData)
+  {
+    MessageCounter* counter = static_cast<MessageCounter*>(clientData);
+    if (strstr(static_cast<const char*>(callData), counter->Text) != NULL)
+    {
+      counter->NumberOfMessages++;
+    }
+  }
+
+  //----------------------------------------------------------------------------
+  unsigned long AddMessageCounter(MessageCounter* counter)
+  {
+    vtkSmartPointer<vtkCallbackCommand> messageCounter = vtkSmartPointer<vtkCallbackCommand>::New();
+    messageCounter->SetCallback(CountMessages);
+    messageCounter->SetClientData(counter);
+    return vtkPlusLogger::Instance()->AddObserver(vtkPlusLogger::MessageLogged, messageCounter);
+  }
+
+  //----------------------------------------------------------------------------
+  // Log a burst of messages in asynchronous mode with a small queue and check that each message is either logged or counted as dropped
+  int TestAsynchronousLogging(vtkPlusLogger::AsynchronousOverflowPolicyType overflowPolicy)
+  {
+    vtkPlusLogger* logger = vtkPlusLogger::Instance();
+
+    MessageCounter loggedMessages(ASYNC_TEST_MESSAGE);
+    unsigned long observerTag = AddMessageCounter(&loggedMessages);
+
+    unsigned long numberOfDroppedMessagesBefore = logger->GetNumberOfDroppedMessages();
+    logger->SetAsynchronousOverflowPolicy(overflowPolicy);
+    logger->SetAsynchronousLogging(true);
+    for (int i = 0; i < NUMBER_OF_ASYNC_TEST_MESSAGES; ++i)
+    {
+      LOG_INFO(ASYNC_TEST_MESSAGE << " " << i);
+    }
+    // Returns when all the queued messages are written
+    logger->SetAsynchronousLogging(false);
+
+    logger->RemoveObserver(observerTag);
+
+    int numberOfDroppedMessages = static_cast<int>(logger->GetNumberOfDroppedMessages() - numberOfDroppedMessagesBefore);
+    if (overflowPolicy == vtkPlusLogger::ASYNC_OVERFLOW_BLOCK && numberOfDroppedMessages != 0)
+    {
+      LOG_ERROR("No messages should be dropped with blocking overflow policy, but " << numberOfDroppedMessages << " messages were dropped");
+      return EXIT_FAILURE;
+    }
+    if (loggedMessages.NumberOfMessages + numberOfDroppedMessages != NUMBER_OF_ASYNC_TEST_MESSAGES)
+    {
+      LOG_ERROR("Asynchronous logging lost messages: " << loggedMessages.NumberOfMessages << " logged, " << numberOfDroppedMessages << " dropped, "
+                << NUMBER_OF_ASYNC_TEST_MESSAGES << " expected in total");
+      return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+  }
+
+  //----------------------------------------------------------------------------
+  // Disable asynchronous logging while several threads are logging and check that no message is lost
+  int TestStopAsynchronousLoggingWhileLogging()
+  {
+    vtkPlusLogger* logger = vtkPlusLogger::Instance();
+
+    MessageCounter loggedMessages(ASYNC_STOP_TEST_MESSAGE);
+    unsigned long observerTag = AddMessageCounter(&loggedMessages);
+
+    // Messages are not dropped with blocking overflow policy, so every message has to be logged
+    logger->SetAsynchronousOverflowPolicy(vtkPlusLogger::ASYNC_OVERFLOW_BLOCK);
+    logger->SetAsynchronousLogging(true);
+    std::vector<std::thread> loggingThreads;
+    for (int threadIndex = 0; threadIndex < NUMBER_OF_ASYNC_STOP_TEST_THREADS; ++threadIndex)
+    {
+      loggingThreads.push_back(std::thread([threadIndex]()
+      {
+        for (int i = 0; i < NUMBER_OF_ASYNC_STOP_TEST_MESSAGES_PER_THREAD; ++i)
+        {
+          LOG_INFO(ASYNC_STOP_TEST_MESSAGE << " " << threadIndex << " " << i);
+        }
+      }));
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    logger->SetAsynchronousLogging(false);
+    for (std::vector<std::thread>::iterator threadIt = loggingThreads.begin(); threadIt != loggingThreads.end(); ++threadIt)
+    {
+      threadIt->join();
+    }
+
+    logger->RemoveObserver(observerTag);
+
+    const int expectedNumberOfMessages = NUMBER_OF_ASYNC_STOP_TEST_THREADS * NUMBER_OF_ASYNC_STOP_TEST_MESSAGES_PER_THREAD;
+    if (loggedMessages.NumberOfMessages != expectedNumberOfMessages)
+    {
+      LOG_ERROR("Messages were lost while asynchronous logging was stopped: " << loggedMessages.NumberOfMessages << " logged, "
+                << expectedNumberOfMessages << " expected");
+      return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+  }
+
+  //----------------------------------------------------------------------------
+  // Drop messages while only errors are logged and check that the report of the dropped messages (a warning) is not logged
+  int TestDroppedMessagesReportRespectsLogLevel()
+  {
+    vtkPlusLogger* logger = vtkPlusLogger::Instance();
+
+    MessageCounter droppedMessagesReports(DROPPED_MESSAGES_REPORT);
+    unsigned long observerTag = AddMessageCounter(&droppedMessagesReports);
+
+    const int originalLogLevel = logger->GetLogLevel();
+    logger->SetLogLevel(vtkPlusLogger::LOG_LEVEL_ERROR);
+    unsigned long numberOfDroppedMessagesBefore = logger->GetNumberOfDroppedMessages();
+    logger->SetAsynchronousOverflowPolicy(vtkPlusLogger::ASYNC_OVERFLOW_DROP);
+    logger->SetAsynchronousLogging(true);
+    for (int i = 0; i < NUMBER_OF_ASYNC_TEST_MESSAGES; ++i)
+    {
+      LOG_ERROR("This is an asynchronous test error message, it is logged on purpose " << i);
+    }
+    logger->SetAsynchronousLogging(false);
+    logger->SetLogLevel(originalLogLevel);
+
+    logger->RemoveObserver(observerTag);
+
+    LOG_INFO("Dropped messages while only errors were logged: " << logger->GetNumberOfDroppedMessages() - numberOfDroppedMessagesBefore);
+    if (droppedMessagesReports.NumberOfMessages != 0)
+    {
+      LOG_ERROR("Dropped messages were reported as a warning while only errors were logged");
+      return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+  }
+}
+
 int main(int argc, char **argv)
 {
   bool printHelp(false);
+  bool testAsync(false);
 
   int verboseLevel = vtkPlusLogger::LOG_LEVEL_UNDEFINED;
 
@@ -39,6 +194,7 @@ int main(int argc, char **argv)
 
   args.AddArgument("--help", vtksys::CommandLineArguments::NO_ARGUMENT, &printHelp, "Print this help.");  
   args.AddArgument("--verbose", vtksys::CommandLineArguments::EQUAL_ARGUMENT, &verboseLevel, "Verbose level (1=error only, 2=warning, 3=info, 4=debug, 5=trace)");  
+  args.AddArgument("--async", vtksys::CommandLineArguments::NO_ARGUMENT, &testAsync, "Test asynchronous logging.");  
   
   if ( !args.Parse() )
   {
@@ -74,5 +230,27 @@ int main(int argc, char **argv)
   logTester->DebugOn();
   logTester->LogMessages();
 
+  if (testAsync)
+  {
+    // Small queue, so that the queue gets full
+    vtkPlusLogger::Instance()->SetAsynchronousQueueSize(16);
+    if (TestAsynchronousLogging(vtkPlusLogger::ASYNC_OVERFLOW_BLOCK) != EXIT_SUCCESS)
+    {
+      return EXIT_FAILURE;
+    }
+    if (TestAsynchronousLogging(vtkPlusLogger::ASYNC_OVERFLOW_DROP) != EXIT_SUCCESS)
+    {
+      return EXIT_FAILURE;
+    }
+    if (TestStopAsynchronousLoggingWhileLogging() != EXIT_SUCCESS)
+    {
+      return EXIT_FAILURE;
+    }
+    if (TestDroppedMessagesReportRespectsLogLevel() != EXIT_SUCCESS)
+    {
+      return EXIT_FAILURE;
+    }
+  }
+
   return EXIT_SUCCESS; 
  }
@@ -365,6 +365,14 @@ int main(int argc, char **argv)
     return EXIT_FAILURE;
   }
 
+  /////////////////////////////////////////////////////////////////////////////
+  // Check that the path through the deleted transform is not used anymore
+  if (transformRepository->IsExistingTransform(tnProbeToTracker)==PLUS_SUCCESS)
+  {
+    LOG_ERROR("ProbeToTracker transform path should not exist after deleting ProbeToTracker");
+    return EXIT_FAILURE;
+  }
+
   /////////////////////////////////////////////////////////////////////////////
   // Check circle detection - after delete
   if (transformRepository->SetTransform(PlusTransformName("Probe", "Phantom"), mxProbeToPhantom)!=PLUS_SUCCESS)
@@ -373,6 +381,37 @@ int main(int argc, char **argv)
     return EXIT_FAILURE;
   }
 
+  /////////////////////////////////////////////////////////////////////////////
+  // Check that the new path is found and the combined transform is recomputed when a transform is updated
+  if (transformRepository->SetTransform(PlusTransformName("Phantom", "Tracker"), mxPhantomToTracker)!=PLUS_SUCCESS)
+  {
+    LOG_ERROR("Set transform should have been succeeded");
+    return EXIT_FAILURE;
+  }
+  vtkSmartPointer<vtkMatrix4x4> mxProbeToTrackerViaPhantom=vtkSmartPointer<vtkMatrix4x4>::New();
+  if (transformRepository->GetTransform(PlusTransformName("Probe", "Tracker"), mxProbeToTrackerViaPhantom, &isValid)!=PLUS_SUCCESS)
+  {
+    LOG_ERROR("ProbeToTracker transform should be computed through the Phantom coordinate frame");
+    return EXIT_FAILURE;
+  }
+  vtkSmartPointer<vtkMatrix4x4> mxProbeToTrackerViaPhantomManual=vtkSmartPointer<vtkMatrix4x4>::New();
+  vtkMatrix4x4::Multiply4x4(mxPhantomToTracker, mxProbeToPhantom, mxProbeToTrackerViaPhantomManual);
+  if (PlusMath::GetPositionDifference(mxProbeToTrackerViaPhantom, mxProbeToTrackerViaPhantomManual)>0.001
+    || PlusMath::GetOrientationDifference(mxProbeToTrackerViaPhantom, mxProbeToTrackerViaPhantomManual)>0.001)
+  {
+    LOG_ERROR("Mismatch between ProbeToTracker computed by transformRepository and manually");
+    return EXIT_FAILURE;
+  }
+  mxProbeToPhantom->Element[0][3]=-12;
+  transformRepository->SetTransform(PlusTransformName("Probe", "Phantom"), mxProbeToPhantom);
+  transformRepository->GetTransform(PlusTransformName("Probe", "Tracker"), mxProbeToTrackerViaPhantom, &isValid);
+  vtkMatrix4x4::Multiply4x4(mxPhantomToTracker, mxProbeToPhantom, mxProbeToTrackerViaPhantomManual);
+  if (PlusMath::GetPositionDifference(mxProbeToTrackerViaPhantom, mxProbeToTrackerViaPhantomManual)>0.001)
+  {
+    LOG_ERROR("ProbeToTracker transform was not updated after ProbeToPhantom changed");
+    return EXIT_FAILURE;
+  }
+
   /////////////////////////////////////////////////////////////////////////////
   // Check clear
   transformRepository->Clear();
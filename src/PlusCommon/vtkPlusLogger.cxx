@@ -12,12 +12,19 @@ See License.txt for details.
 
 #include "PlusConfigure.h"
 #include "vtkCommand.h"
+#include "vtkMultiThreader.h"
 #include "vtkObjectFactory.h"
 #include "vtkPlusLogger.h"
 #include "vtkPlusRecursiveCriticalSection.h"
 #include "vtksys/SystemTools.hxx"
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdlib>
+#include <mutex>
 #include <sstream>
 #include <string>
+#include <thread>
 
 //-----------------------------------------------------------------------------
 
@@ -31,8 +38,184 @@ vtkStandardNewMacro(vtkPlusLoggerOutputWindow);
 namespace
 {
   vtkPlusSimpleRecursiveCriticalSection LoggerCreationCriticalSection;
+
+  static const int DEFAULT_ASYNC_QUEUE_SIZE = 4096;
+  static const int ASYNC_THREAD_WAKEUP_PERIOD_MS = 20; // queued messages are written at least this often
+  static const int ASYNC_BLOCK_RETRY_PERIOD_MS = 1; // a thread waiting for room in the full queue retries this often
 }
 
+//-----------------------------------------------------------------------------
+struct vtkPlusLogger::LogRecord
+{
+  LogLevelType Level;
+  bool Wide;
+  /*! Date and time, written at the beginning of the line in the log file */
+  std::string Timestamp;
+  /*! Formatted message (level, time, message, location), for the log file and the message logged event */
+  std::string Text;
+  std::wstring WideText;
+  /*! Text displayed on the console */
+  std::string ConsoleText;
+  std::wstring WideConsoleText;
+};
+
+//-----------------------------------------------------------------------------
+// Bounded multi-producer queue (D. Vyukov's algorithm): each cell has a sequence number that tells
+// if the cell is ready for writing or reading at a given position, so producers and the consumer
+// only use atomic operations.
+class vtkPlusLogger::AsynchronousQueue
+{
+public:
+  explicit AsynchronousQueue(unsigned int capacity)
+    : Cells(new Cell[capacity])
+    , Mask(capacity - 1)
+    , EnqueuePosition(0)
+    , DequeuePosition(0)
+  {
+    for (size_t i = 0; i < capacity; ++i)
+    {
+      this->Cells[i].Sequence.store(i, std::memory_order_relaxed);
+    }
+  }
+
+  ~AsynchronousQueue()
+  {
+    delete[] this->Cells;
+  }
+
+  /*! Moves the record into the queue, returns false if the queue is full */
+  bool TryPush(LogRecord& record)
+  {
+    Cell* cell = NULL;
+    size_t position = this->EnqueuePosition.load(std::memory_order_relaxed);
+    while (true)
+    {
+      cell = &this->Cells[position & this->Mask];
+      const size_t sequence = cell->Sequence.load(std::memory_order_acquire);
+      const std::intptr_t difference = static_cast<std::intptr_t>(sequence) - static_cast<std::intptr_t>(position);
+      if (difference == 0)
+      {
+        if (this->EnqueuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+        {
+          break;
+        }
+      }
+      else if (difference < 0)
+      {
+        // full
+        return false;
+      }
+      else
+      {
+        position = this->EnqueuePosition.load(std::memory_order_relaxed);
+      }
+    }
+    cell->Record = std::move(record);
+    cell->Sequence.store(position + 1, std::memory_order_release);
+    return true;
+  }
+
+  /*! Moves the oldest record out of the queue, returns false if the queue is empty */
+  bool TryPop(LogRecord& record)
+  {
+    Cell* cell = NULL;
+    size_t position = this->DequeuePosition.load(std::memory_order_relaxed);
+    while (true)
+    {
+      cell = &this->Cells[position & this->Mask];
+      const size_t sequence = cell->Sequence.load(std::memory_order_acquire);
+      const std::intptr_t difference = static_cast<std::intptr_t>(sequence) - static_cast<std::intptr_t>(position + 1);
+      if (difference == 0)
+      {
+        if (this->DequeuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+        {
+          break;
+        }
+      }
+      else if (difference < 0)
+      {
+        // empty
+        return false;
+      }
+      else
+      {
+        position = this->DequeuePosition.load(std::memory_order_relaxed);
+      }
+    }
+    record = std::move(cell->Record);
+    cell->Sequence.store(position + this->Mask + 1, std::memory_order_release);
+    return true;
+  }
+
+  /*! Returns true if there is no record that is ready to be popped */
+  bool IsEmpty() const
+  {
+    const size_t position = this->DequeuePosition.load(std::memory_order_relaxed);
+    return this->Cells[position & this->Mask].Sequence.load(std::memory_order_acquire) != position + 1;
+  }
+
+private:
+  struct Cell
+  {
+    std::atomic<size_t> Sequence;
+    LogRecord Record;
+  };
+
+  Cell* const Cells;
+  const size_t Mask;
+  // Producers and the consumer update different positions, keep them on different cache lines
+  char PaddingBeforeEnqueuePosition[64];
+  std::atomic<size_t> EnqueuePosition;
+  char PaddingBeforeDequeuePosition[64];
+  std::atomic<size_t> DequeuePosition;
+
+  AsynchronousQueue(const AsynchronousQueue&); // Not implemented
+  void operator=(const AsynchronousQueue&); // Not implemented
+};
+
+//-----------------------------------------------------------------------------
+class vtkPlusLogger::AsynchronousLogging
+{
+public:
+  AsynchronousLogging()
+    : Queue(NULL)
+    , Threader(NULL)
+    , ThreaderId(-1)
+    , NumberOfProducersInFlight(0)
+  {
+  }
+
+  ~AsynchronousLogging()
+  {
+    delete this->Queue;
+    if (this->Threader != NULL)
+    {
+      this->Threader->Delete();
+    }
+  }
+
+  /*! Thread that writes the messages of the queue */
+  static void* LoggingThread(vtkMultiThreader::ThreadInfo* data);
+
+  /*! Created when asynchronous logging is enabled the first time and kept until destruction */
+  AsynchronousQueue* Queue;
+  /*! Serializes enabling and disabling of asynchronous logging */
+  std::mutex ControlMutex;
+  /*! Used for waking up the logging thread when messages are queued or stop is requested */
+  std::mutex WakeupMutex;
+  std::condition_variable Wakeup;
+  vtkMultiThreader* Threader;
+  int ThreaderId;
+  /*! Identifies the logging thread, it must not block on the full queue when observers log messages. Protected by m_CriticalSection. */
+  std::thread::id LoggingThreadId;
+  /*! Number of threads that are pushing a message into the queue, stopping waits for them before writing the last queued messages */
+  std::atomic<int> NumberOfProducersInFlight;
+
+private:
+  AsynchronousLogging(const AsynchronousLogging&); // Not implemented
+  void operator=(const AsynchronousLogging&); // Not implemented
+};
+
 //-----------------------------------------------------------------------------
 
 void vtkPlusLoggerOutputWindow::ReplaceNewlineBySeparator(std::string& str)
@@ -130,6 +313,14 @@ void vtkPlusLoggerOutputWindow::PrintSelf(ostream& os, vtkIndent indent)
 
 //-------------------------------------------------------
 vtkPlusLogger::vtkPlusLogger()
+  : m_Async(new AsynchronousLogging)
+  , m_AsyncQueueSize(DEFAULT_ASYNC_QUEUE_SIZE)
+  , m_AsyncEnabled(false)
+  , m_AsyncOverflowPolicy(ASYNC_OVERFLOW_DROP)
+  , m_NumberOfDroppedMessages(0)
+  , m_NumberOfReportedDroppedMessages(0)
+  , m_AsyncStopRequested(false)
+  , m_AtExitRegistered(false)
 {
   m_CriticalSection = vtkPlusRecursiveCriticalSection::New();
 
@@ -145,6 +336,13 @@ vtkPlusLogger::vtkPlusLogger()
 //-------------------------------------------------------
 vtkPlusLogger::~vtkPlusLogger()
 {
+  {
+    std::lock_guard<std::mutex> asyncControlLock(m_Async->ControlMutex);
+    this->StopAsynchronousLogging();
+  }
+  delete m_Async;
+  m_Async = NULL;
+
   // Disconnect VTK error logging from the Plus logger (restore default VTK logging)
   vtkOutputWindow::SetInstance(NULL);
 
@@ -299,6 +497,28 @@ void vtkPlusLogger::LogMessage(LogLevelType level, const char* msg, const char*
     return;
   }
 
+  LogRecord record;
+  this->FormatRecord(record, level, msg, fileName, lineNumber, optionalPrefix);
+  this->OutputRecord(record);
+}
+
+//----------------------------------------------------------------------------
+void vtkPlusLogger::LogMessage(LogLevelType level, const wchar_t* msg, const char* fileName, int lineNumber, const wchar_t* optionalPrefix /*= NULL*/)
+{
+  if (m_LogLevel < level)
+  {
+    // no need to log
+    return;
+  }
+
+  LogRecord record;
+  this->FormatRecord(record, level, msg, fileName, lineNumber, optionalPrefix);
+  this->OutputRecord(record);
+}
+
+//-------------------------------------------------------
+void vtkPlusLogger::FormatRecord(LogRecord& record, LogLevelType level, const char* msg, const char* fileName, int lineNumber, const char* optionalPrefix)
+{
   // If log level is not debug then only print messages for INFO logs (skip the INFO prefix, line numbers, etc.)
   bool onlyShowMessage = (level == LOG_LEVEL_INFO && m_LogLevel <= LOG_LEVEL_INFO);
 
@@ -349,99 +569,16 @@ void vtkPlusLogger::LogMessage(LogLevelType level, const char* msg, const char*
     log << "| in " << fileName << "(" << lineNumber << ")"; // add filename and line number
   }
 
-  {
-    PlusLockGuard<vtkPlusRecursiveCriticalSection> critSectionGuard(this->m_CriticalSection);
-
-    if (m_LogLevel >= level)
-    {
-
-#ifdef _WIN32
-
-      // Set the text color to highlight error and warning messages (supported only on windows)
-      switch (level)
-      {
-        case LOG_LEVEL_ERROR:
-        {
-          HANDLE hStdout = GetStdHandle(STD_ERROR_HANDLE);
-          SetConsoleTextAttribute(hStdout, FOREGROUND_RED | FOREGROUND_INTENSITY);
-        }
-        break;
-        case LOG_LEVEL_WARNING:
-        {
-          HANDLE hStdout = GetStdHandle(STD_ERROR_HANDLE);
-          SetConsoleTextAttribute(hStdout, FOREGROUND_RED | FOREGROUND_GREEN | FOREGROUND_INTENSITY);
-        }
-        break;
-        default:
-        {
-          HANDLE hStdout = GetStdHandle(STD_OUTPUT_HANDLE);
-          SetConsoleTextAttribute(hStdout, FOREGROUND_RED | FOREGROUND_GREEN | FOREGROUND_BLUE);
-        }
-        break;
-      }
-#endif
-
-      if (level > LOG_LEVEL_WARNING)
-      {
-        if (onlyShowMessage)
-        {
-          std::cout << msg << std::endl;
-        }
-        else
-        {
-          std::cout << log.str() << std::endl;
-        }
-      }
-      else
-      {
-        if (onlyShowMessage)
-        {
-          std::cerr << msg << std::endl;
-        }
-        else
-        {
-          std::cerr << log.str() << std::endl;
-        }
-      }
-
-#ifdef _WIN32
-      // Revert the text color (supported only on windows)
-      if (level == LOG_LEVEL_ERROR || level == LOG_LEVEL_WARNING)
-      {
-        HANDLE hStdout = GetStdHandle(STD_ERROR_HANDLE);
-        SetConsoleTextAttribute(hStdout, FOREGROUND_RED | FOREGROUND_GREEN | FOREGROUND_BLUE);
-      }
-#endif
-
-      // Call display message callbacks if higher priority than trace
-      if (level < LOG_LEVEL_TRACE)
-      {
-        std::ostringstream callDataStream;
-        callDataStream << level << "|" << log.str();
-
-        InvokeEvent(vtkPlusLogger::MessageLogged, (void*)(callDataStream.str().c_str()));
-      }
-
-      // Add to log stream (file)
-      std::string logStr(log.str());
-      std::wstring logWStr(logStr.begin(), logStr.end());
-      this->m_LogStream << std::setw(17) << std::left << std::wstring(timestamp.begin(), timestamp.end()) << logWStr;
-      this->m_LogStream << std::endl;
-    }
-  }
-
-  this->Flush();
+  record.Level = level;
+  record.Wide = false;
+  record.Timestamp = timestamp;
+  record.Text = log.str();
+  record.ConsoleText = (onlyShowMessage ? std::string(msg) : record.Text);
 }
 
 //----------------------------------------------------------------------------
-void vtkPlusLogger::LogMessage(LogLevelType level, const wchar_t* msg, const char* fileName, int lineNumber, const wchar_t* optionalPrefix /*= NULL*/)
+void vtkPlusLogger::FormatRecord(LogRecord& record, LogLevelType level, const wchar_t* msg, const char* fileName, int lineNumber, const wchar_t* optionalPrefix)
 {
-  if (m_LogLevel < level)
-  {
-    // no need to log
-    return;
-  }
-
   // If log level is not debug then only print messages for INFO logs (skip the INFO prefix, line numbers, etc.)
   bool onlyShowMessage = (level == LOG_LEVEL_INFO && m_LogLevel <= LOG_LEVEL_INFO);
 
@@ -492,84 +629,356 @@ void vtkPlusLogger::LogMessage(LogLevelType level, const wchar_t* msg, const cha
     log << L"| in " << fileName << L"(" << lineNumber << L")"; // add filename and line number
   }
 
+  record.Level = level;
+  record.Wide = true;
+  record.Timestamp = timestamp;
+  record.WideText = log.str();
+  record.WideConsoleText = (onlyShowMessage ? std::wstring(msg) : record.WideText);
+}
+
+//----------------------------------------------------------------------------
+void vtkPlusLogger::OutputRecord(LogRecord& record)
+{
+  if (m_AsyncEnabled.load(std::memory_order_acquire))
+  {
+    // Asynchronous logging is checked again after registering as a producer: either stopping sees this producer
+    // and waits for it before writing the last queued messages, or this producer sees that logging is stopped.
+    m_Async->NumberOfProducersInFlight++;
+    bool queued = m_AsyncEnabled.load() && this->PushAsynchronousRecord(record);
+    m_Async->NumberOfProducersInFlight--;
+    if (queued)
+    {
+      return;
+    }
+  }
+
   {
     PlusLockGuard<vtkPlusRecursiveCriticalSection> critSectionGuard(this->m_CriticalSection);
+    this->WriteRecord(record);
+  }
+
+  this->Flush();
+}
 
-    if (m_LogLevel >= level)
+//----------------------------------------------------------------------------
+bool vtkPlusLogger::PushAsynchronousRecord(LogRecord& record)
+{
+  while (!m_Async->Queue->TryPush(record))
+  {
+    if (m_AsyncOverflowPolicy.load(std::memory_order_relaxed) == ASYNC_OVERFLOW_DROP)
     {
-#ifdef _WIN32
-      // Set the text color to highlight error and warning messages (supported only on windows)
-      switch (level)
+      m_NumberOfDroppedMessages++;
+      return true;
+    }
+    {
+      PlusLockGuard<vtkPlusRecursiveCriticalSection> critSectionGuard(this->m_CriticalSection);
+      if (std::this_thread::get_id() == m_Async->LoggingThreadId)
       {
-        case LOG_LEVEL_ERROR:
-        {
-          HANDLE hStdout = GetStdHandle(STD_ERROR_HANDLE);
-          SetConsoleTextAttribute(hStdout, FOREGROUND_RED | FOREGROUND_INTENSITY);
-        }
-        break;
-        case LOG_LEVEL_WARNING:
-        {
-          HANDLE hStdout = GetStdHandle(STD_ERROR_HANDLE);
-          SetConsoleTextAttribute(hStdout, FOREGROUND_RED | FOREGROUND_GREEN | FOREGROUND_INTENSITY);
-        }
-        break;
-        default:
-        {
-          HANDLE hStdout = GetStdHandle(STD_OUTPUT_HANDLE);
-          SetConsoleTextAttribute(hStdout, FOREGROUND_RED | FOREGROUND_GREEN | FOREGROUND_BLUE);
-        }
-        break;
+        // A message logged by an observer of the message logged event, the queue would never get empty while waiting
+        m_NumberOfDroppedMessages++;
+        return true;
       }
+    }
+    if (!m_AsyncEnabled.load(std::memory_order_acquire))
+    {
+      // asynchronous logging has been disabled while waiting
+      return false;
+    }
+    m_Async->Wakeup.notify_one();
+    std::this_thread::sleep_for(std::chrono::milliseconds(ASYNC_BLOCK_RETRY_PERIOD_MS));
+  }
+  m_Async->Wakeup.notify_one();
+  return true;
+}
+
+//----------------------------------------------------------------------------
+void vtkPlusLogger::WriteRecord(const LogRecord& record)
+{
+  const LogLevelType level = record.Level;
+
+#ifdef _WIN32
+  // Set the text color to highlight error and warning messages (supported only on windows)
+  switch (level)
+  {
+    case LOG_LEVEL_ERROR:
+    {
+      HANDLE hStdout = GetStdHandle(STD_ERROR_HANDLE);
+      SetConsoleTextAttribute(hStdout, FOREGROUND_RED | FOREGROUND_INTENSITY);
+    }
+    break;
+    case LOG_LEVEL_WARNING:
+    {
+      HANDLE hStdout = GetStdHandle(STD_ERROR_HANDLE);
+      SetConsoleTextAttribute(hStdout, FOREGROUND_RED | FOREGROUND_GREEN | FOREGROUND_INTENSITY);
+    }
+    break;
+    default:
+    {
+      HANDLE hStdout = GetStdHandle(STD_OUTPUT_HANDLE);
+      SetConsoleTextAttribute(hStdout, FOREGROUND_RED | FOREGROUND_GREEN | FOREGROUND_BLUE);
+    }
+    break;
+  }
 #endif
 
-      if (level > LOG_LEVEL_WARNING)
-      {
-        if (onlyShowMessage)
-        {
-          std::wcout << msg << std::endl;
-        }
-        else
-        {
-          std::wcout << log.str() << std::endl;
-        }
-      }
-      else
-      {
-        if (onlyShowMessage)
-        {
-          std::wcerr << msg << std::endl;
-        }
-        else
-        {
-          std::wcerr << log.str() << std::endl;
-        }
-      }
+  if (level > LOG_LEVEL_WARNING)
+  {
+    if (record.Wide)
+    {
+      std::wcout << record.WideConsoleText << std::endl;
+    }
+    else
+    {
+      std::cout << record.ConsoleText << std::endl;
+    }
+  }
+  else
+  {
+    if (record.Wide)
+    {
+      std::wcerr << record.WideConsoleText << std::endl;
+    }
+    else
+    {
+      std::cerr << record.ConsoleText << std::endl;
+    }
+  }
 
 #ifdef _WIN32
-      // Revert the text color (supported only on windows)
-      if (level == LOG_LEVEL_ERROR || level == LOG_LEVEL_WARNING)
-      {
-        HANDLE hStdout = GetStdHandle(STD_ERROR_HANDLE);
-        SetConsoleTextAttribute(hStdout, FOREGROUND_RED | FOREGROUND_GREEN | FOREGROUND_BLUE);
-      }
+  // Revert the text color (supported only on windows)
+  if (level == LOG_LEVEL_ERROR || level == LOG_LEVEL_WARNING)
+  {
+    HANDLE hStdout = GetStdHandle(STD_ERROR_HANDLE);
+    SetConsoleTextAttribute(hStdout, FOREGROUND_RED | FOREGROUND_GREEN | FOREGROUND_BLUE);
+  }
 #endif
 
-      // Call display message callbacks if higher priority than trace
-      if (level < LOG_LEVEL_TRACE)
-      {
-        std::wostringstream callDataStream;
-        callDataStream << level << L"|" << log.str();
+  // Call display message callbacks if higher priority than trace
+  if (level < LOG_LEVEL_TRACE)
+  {
+    if (record.Wide)
+    {
+      std::wostringstream callDataStream;
+      callDataStream << level << L"|" << record.WideText;
+      InvokeEvent(vtkPlusLogger::WideMessageLogged, (void*)(callDataStream.str().c_str()));
+    }
+    else
+    {
+      std::ostringstream callDataStream;
+      callDataStream << level << "|" << record.Text;
+      InvokeEvent(vtkPlusLogger::MessageLogged, (void*)(callDataStream.str().c_str()));
+    }
+  }
+
+  // Add to log stream (file), this may introduce conversion issues going from wstring to string
+  this->m_LogStream << std::setw(17) << std::left << std::wstring(record.Timestamp.begin(), record.Timestamp.end());
+  if (record.Wide)
+  {
+    this->m_LogStream << record.WideText;
+  }
+  else
+  {
+    this->m_LogStream << std::wstring(record.Text.begin(), record.Text.end());
+  }
+  this->m_LogStream << std::endl;
+}
+
+//----------------------------------------------------------------------------
+void vtkPlusLogger::WriteQueuedRecords()
+{
+  LogRecord record;
+  bool written = false;
+  {
+    PlusLockGuard<vtkPlusRecursiveCriticalSection> critSectionGuard(this->m_CriticalSection);
+    while (m_Async->Queue->TryPop(record))
+    {
+      this->WriteRecord(record);
+      written = true;
+    }
 
-        InvokeEvent(vtkPlusLogger::WideMessageLogged, (void*)(callDataStream.str().c_str()));
+    unsigned long numberOfDroppedMessages = m_NumberOfDroppedMessages.load();
+    if (numberOfDroppedMessages != m_NumberOfReportedDroppedMessages)
+    {
+      if (m_LogLevel >= LOG_LEVEL_WARNING)
+      {
+        std::ostringstream msg;
+        msg << (numberOfDroppedMessages - m_NumberOfReportedDroppedMessages) << " log messages were dropped because the asynchronous log queue was full ("
+            << numberOfDroppedMessages << " in total)";
+        this->FormatRecord(record, LOG_LEVEL_WARNING, msg.str().c_str(), NULL, -1, NULL);
+        this->WriteRecord(record);
+        written = true;
       }
+      m_NumberOfReportedDroppedMessages = numberOfDroppedMessages;
+    }
+  }
+
+  if (written)
+  {
+    this->Flush();
+  }
+}
+
+//----------------------------------------------------------------------------
+void vtkPlusLogger::SetAsynchronousLogging(bool enable)
+{
+  std::lock_guard<std::mutex> asyncControlLock(m_Async->ControlMutex);
+  if (!enable)
+  {
+    this->StopAsynchronousLogging();
+    return;
+  }
+  if (m_Async->ThreaderId >= 0)
+  {
+    // already running
+    return;
+  }
+
+  if (m_Async->Queue == NULL)
+  {
+    m_Async->Queue = new AsynchronousQueue(m_AsyncQueueSize);
+  }
+  if (m_Async->Threader == NULL)
+  {
+    m_Async->Threader = vtkMultiThreader::New();
+  }
+  if (!m_AtExitRegistered)
+  {
+    // The logger is never deleted, so the queued messages have to be written when the application exits
+    std::atexit(&vtkPlusLogger::StopAsynchronousLoggingAtExit);
+    m_AtExitRegistered = true;
+  }
+
+  m_AsyncStopRequested = false;
+  m_Async->ThreaderId = m_Async->Threader->SpawnThread((vtkThreadFunctionType)&AsynchronousLogging::LoggingThread, this);
+  if (m_Async->ThreaderId < 0)
+  {
+    LOG_ERROR("Failed to start asynchronous logging thread, messages are logged synchronously");
+    return;
+  }
+  m_AsyncEnabled.store(true, std::memory_order_release);
+}
+
+//----------------------------------------------------------------------------
+bool vtkPlusLogger::GetAsynchronousLogging()
+{
+  return m_AsyncEnabled.load(std::memory_order_acquire);
+}
+
+//----------------------------------------------------------------------------
+void vtkPlusLogger::StopAsynchronousLogging()
+{
+  if (m_Async->ThreaderId < 0)
+  {
+    // not running
+    return;
+  }
+
+  // New messages are written synchronously from now on
+  m_AsyncEnabled.store(false);
+  {
+    std::lock_guard<std::mutex> wakeupLock(m_Async->WakeupMutex);
+    m_AsyncStopRequested = true;
+  }
+  m_Async->Wakeup.notify_all();
+
+  // Waits until the thread exits, it writes all the queued messages before exiting
+  m_Async->Threader->TerminateThread(m_Async->ThreaderId);
+  m_Async->ThreaderId = -1;
+
+  // Producers that saw asynchronous logging enabled may still be pushing messages (or waiting for room in the
+  // full queue, until they notice that asynchronous logging is disabled), their messages must not be left in the queue
+  while (m_Async->NumberOfProducersInFlight > 0)
+  {
+    std::this_thread::sleep_for(std::chrono::milliseconds(ASYNC_BLOCK_RETRY_PERIOD_MS));
+  }
+
+  // Write the messages that were queued while the thread was exiting
+  this->WriteQueuedRecords();
+}
+
+//----------------------------------------------------------------------------
+void vtkPlusLogger::StopAsynchronousLoggingAtExit()
+{
+  if (m_pInstance != NULL)
+  {
+    m_pInstance->SetAsynchronousLogging(false);
+  }
+}
+
+//----------------------------------------------------------------------------
+void* vtkPlusLogger::AsynchronousLogging::LoggingThread(vtkMultiThreader::ThreadInfo* data)
+{
+  vtkPlusLogger* self = (vtkPlusLogger*)(data->UserData);
+  {
+    PlusLockGuard<vtkPlusRecursiveCriticalSection> critSectionGuard(self->m_CriticalSection);
+    self->m_Async->LoggingThreadId = std::this_thread::get_id();
+  }
 
-      // Add to log stream (file), this may introduce conversion issues going from wstring to string
-      this->m_LogStream << std::setw(17) << std::left << std::wstring(timestamp.begin(), timestamp.end()) << log.str();
-      this->m_LogStream << std::endl;
+  while (true)
+  {
+    // Check the stop request before writing, so all the messages queued before the request are written
+    bool stopRequested = self->m_AsyncStopRequested.load();
+    self->WriteQueuedRecords();
+    if (stopRequested)
+    {
+      break;
     }
+
+    std::unique_lock<std::mutex> wakeupLock(self->m_Async->WakeupMutex);
+    self->m_Async->Wakeup.wait_for(wakeupLock, std::chrono::milliseconds(ASYNC_THREAD_WAKEUP_PERIOD_MS), [self]()
+    {
+      return self->m_AsyncStopRequested.load() || !self->m_Async->Queue->IsEmpty();
+    });
   }
 
-  this->Flush();
+  {
+    PlusLockGuard<vtkPlusRecursiveCriticalSection> critSectionGuard(self->m_CriticalSection);
+    self->m_Async->LoggingThreadId = std::thread::id();
+  }
+  return NULL;
+}
+
+//----------------------------------------------------------------------------
+void vtkPlusLogger::SetAsynchronousQueueSize(int queueSize)
+{
+  std::lock_guard<std::mutex> asyncControlLock(m_Async->ControlMutex);
+  if (m_Async->Queue != NULL)
+  {
+    LOG_WARNING("The asynchronous log queue size cannot be changed after asynchronous logging has been enabled");
+    return;
+  }
+  // Round up to power of two
+  int roundedQueueSize = 2;
+  while (roundedQueueSize < queueSize && roundedQueueSize < (1 << 30))
+  {
+    roundedQueueSize *= 2;
+  }
+  m_AsyncQueueSize = roundedQueueSize;
+}
+
+//----------------------------------------------------------------------------
+int vtkPlusLogger::GetAsynchronousQueueSize()
+{
+  std::lock_guard<std::mutex> asyncControlLock(m_Async->ControlMutex);
+  return m_AsyncQueueSize;
+}
+
+//----------------------------------------------------------------------------
+void vtkPlusLogger::SetAsynchronousOverflowPolicy(AsynchronousOverflowPolicyType policy)
+{
+  m_AsyncOverflowPolicy = policy;
+}
+
+//----------------------------------------------------------------------------
+vtkPlusLogger::AsynchronousOverflowPolicyType vtkPlusLogger::GetAsynchronousOverflowPolicy()
+{
+  return static_cast<AsynchronousOverflowPolicyType>(m_AsyncOverflowPolicy.load());
+}
+
+//----------------------------------------------------------------------------
+unsigned long vtkPlusLogger::GetNumberOfDroppedMessages()
+{
+  return m_NumberOfDroppedMessages.load();
 }
 
 //-------------------------------------------------------
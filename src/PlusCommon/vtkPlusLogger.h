@@ -11,6 +11,7 @@
 
 #include "vtkObject.h"
 #include "vtkOutputWindow.h"
+#include <atomic>
 #include <fstream>
 #include <sstream>
 
@@ -78,6 +79,12 @@ private:
   \class vtkPlusLogger
   \brief This singleton class provides logging into file and/or the console
   with adjustable verbosity.
+
+  By default messages are written synchronously by the thread that logs them.
+  In asynchronous mode (see SetAsynchronousLogging) the logging thread only formats
+  the message and pushes it into a bounded lock-free queue, and a background thread
+  writes the messages to the console and the log file. This keeps threads that log
+  bursts of messages (e.g., acquisition threads under overload) from waiting for I/O.
   \ingroup PlusLibCommon
 */
 class vtkPlusCommonExport vtkPlusLogger : public vtkObject
@@ -122,6 +129,13 @@ public:
     LOG_LEVEL_UNDEFINED = 100
   };
 
+  /*! Policy when the queue of asynchronous logging is full */
+  enum AsynchronousOverflowPolicyType
+  {
+    ASYNC_OVERFLOW_DROP,  /*!< The message is discarded and counted, the number of dropped messages is logged */
+    ASYNC_OVERFLOW_BLOCK  /*!< The logging thread waits until there is room in the queue */
+  };
+
   static int UnlimitedLogMessages() { return -1; };
 
   /*!  Get a pointer to the single existing object instance */
@@ -175,6 +189,31 @@ public:
   /*! Get the name of the file where the messages are logged to */
   std::string GetLogFileName();
 
+  /*!
+    Enable or disable asynchronous logging. If enabled, messages are written to the console and the log file
+    by a background thread, which also invokes the MessageLogged events (so observers are called on that thread).
+    Disabling returns after all the queued messages are written. The queued messages are also written at exit.
+  */
+  void SetAsynchronousLogging(bool enable);
+  /*! Returns true if asynchronous logging is enabled */
+  bool GetAsynchronousLogging();
+
+  /*!
+    Set the maximum number of messages in the queue of asynchronous logging (rounded up to a power of two).
+    It can be changed only until asynchronous logging is enabled the first time.
+  */
+  void SetAsynchronousQueueSize(int queueSize);
+  /*! Get the maximum number of messages in the queue of asynchronous logging */
+  int GetAsynchronousQueueSize();
+
+  /*! Set what happens when a message is logged and the queue of asynchronous logging is full */
+  void SetAsynchronousOverflowPolicy(AsynchronousOverflowPolicyType policy);
+  /*! Get what happens when a message is logged and the queue of asynchronous logging is full */
+  AsynchronousOverflowPolicyType GetAsynchronousOverflowPolicy();
+
+  /*! Get the number of messages discarded because the queue of asynchronous logging was full */
+  unsigned long GetNumberOfDroppedMessages();
+
 protected:
   vtkPlusLogger();
   ~vtkPlusLogger();
@@ -186,6 +225,37 @@ private:
   vtkPlusLogger(vtkPlusLogger const&);
   vtkPlusLogger& operator=(vtkPlusLogger const&);
 
+  /*! Formatted message, ready to be written to the console and the log file */
+  struct LogRecord;
+
+  /*! Bounded lock-free queue of formatted messages, used for asynchronous logging */
+  class AsynchronousQueue;
+
+  /*! Queue, thread and synchronization objects of asynchronous logging */
+  class AsynchronousLogging;
+
+  /*! Format a message */
+  void FormatRecord(LogRecord& record, LogLevelType level, const char* msg, const char* fileName, int lineNumber, const char* optionalPrefix);
+  void FormatRecord(LogRecord& record, LogLevelType level, const wchar_t* msg, const char* fileName, int lineNumber, const wchar_t* optionalPrefix);
+
+  /*! Write a formatted message, or queue it if asynchronous logging is enabled */
+  void OutputRecord(LogRecord& record);
+
+  /*! Push a formatted message into the asynchronous queue. Returns false if the message has to be written synchronously. */
+  bool PushAsynchronousRecord(LogRecord& record);
+
+  /*! Write a formatted message to the console and the log stream and invoke the message logged event. m_CriticalSection must be locked. */
+  void WriteRecord(const LogRecord& record);
+
+  /*! Write all the messages in the asynchronous queue and report the dropped messages */
+  void WriteQueuedRecords();
+
+  /*! Stop the asynchronous logging thread and write all the queued messages. The control mutex of asynchronous logging must be locked. */
+  void StopAsynchronousLogging();
+
+  /*! Write the queued messages at exit */
+  static void StopAsynchronousLoggingAtExit();
+
   /*! Pointer to the singleton instance */
   static vtkPlusLogger*   m_pInstance;
   /*! Log level used for controlling the verbosity of the logging */
@@ -203,6 +273,19 @@ private:
     threads simultaneously.
   */
   vtkPlusRecursiveCriticalSection* m_CriticalSection;
+
+  /*! Queue, thread and synchronization objects of asynchronous logging */
+  AsynchronousLogging*    m_Async;
+  /*! Maximum number of messages in the asynchronous queue */
+  int                     m_AsyncQueueSize;
+  /*! If set, messages are pushed into the asynchronous queue */
+  std::atomic<bool>       m_AsyncEnabled;
+  std::atomic<int>        m_AsyncOverflowPolicy;
+  std::atomic<unsigned long> m_NumberOfDroppedMessages;
+  /*! Number of dropped messages that has been logged already */
+  unsigned long           m_NumberOfReportedDroppedMessages;
+  std::atomic<bool>       m_AsyncStopRequested;
+  bool                    m_AtExitRegistered;
 };
 
 #endif
\ No newline at end of file
@@ -73,9 +73,18 @@ vtkPlusTransformRepository::TransformInfo& vtkPlusTransformRepository::Transform
   return *this;
 }
 
+//----------------------------------------------------------------------------
+vtkPlusTransformRepository::CachedPath::CachedPath()
+  : Generation(0)
+  , IsValid(false)
+{
+  vtkMatrix4x4::Identity(this->Matrix);
+}
+
 //----------------------------------------------------------------------------
 vtkPlusTransformRepository::vtkPlusTransformRepository()
-  : CriticalSection(vtkPlusRecursiveCriticalSection::New())
+  : UpdateGeneration(1)
+  , CriticalSection(vtkPlusRecursiveCriticalSection::New())
 {
 
 }
@@ -218,6 +227,8 @@ PlusStatus vtkPlusTransformRepository::SetTransform(const PlusTransformName& aTr
     }
     // Set the status of the original transform
     fromToTransformInfo->m_IsValid = isValid;
+    // Cached combined transforms have to be recomputed, but the paths remain the same
+    this->UpdateGeneration++;
 
     // Set the same status for the computed inverse transform
     PlusTransformName toFromTransformName(aTransformName.To(), aTransformName.From());
@@ -243,6 +254,9 @@ PlusStatus vtkPlusTransformRepository::SetTransform(const PlusTransformName& aTr
     return PLUS_FAIL;
   }
 
+  // A new path may be available between coordinate frames that were not connected before
+  this->InvalidatePathCache();
+
   // Create the from->to transform
   CoordFrameToTransformMapType& fromCoordFrame = this->CoordinateFrames[aTransformName.From()];
   fromCoordFrame[aTransformName.To()].m_IsComputed = false;
@@ -298,35 +312,53 @@ PlusStatus vtkPlusTransformRepository::GetTransform(const PlusTransformName& aTr
   PlusLockGuard<vtkPlusRecursiveCriticalSection> accessGuard(this->CriticalSection);
 
   // Check if we can find the transform by combining the input transforms
-  // To improve performance the already found paths could be stored in a map of transform name -> transformInfoList
-  TransformInfoListType transformInfoList;
-  if (FindPath(aTransformName, transformInfoList) != PLUS_SUCCESS)
+  std::pair<std::string, std::string> pathKey(aTransformName.From(), aTransformName.To());
+  PathCacheMapType::iterator cachedPathIt = this->PathCache.find(pathKey);
+  if (cachedPathIt == this->PathCache.end())
   {
-    // the transform cannot be computed, error has been already logged by FindPath
-    *isValid = false;
-    return PLUS_FAIL;
+    TransformInfoListType transformInfoList;
+    if (FindPath(aTransformName, transformInfoList) != PLUS_SUCCESS)
+    {
+      // the transform cannot be computed, error has been already logged by FindPath
+      if (isValid != NULL)
+      {
+        (*isValid) = false;
+      }
+      return PLUS_FAIL;
+    }
+    cachedPathIt = this->PathCache.insert(std::make_pair(pathKey, CachedPath())).first;
+    cachedPathIt->second.Path.swap(transformInfoList);
   }
+  CachedPath& cachedPath = cachedPathIt->second;
 
-  // Create transform chain and compute transform status
-  vtkSmartPointer<vtkTransform> combinedTransform = vtkSmartPointer<vtkTransform>::New();
-  bool combinedTransformValid(true);
-  for (TransformInfoListType::iterator transformInfo = transformInfoList.begin(); transformInfo != transformInfoList.end(); ++transformInfo)
+  if (cachedPath.Generation != this->UpdateGeneration)
   {
-    combinedTransform->Concatenate((*transformInfo)->m_Transform);
-    if (!(*transformInfo)->m_IsValid)
+    // Stored transforms changed since the last query, combine the transforms along the path and compute transform status
+    vtkSmartPointer<vtkMatrix4x4> combinedMatrix = vtkSmartPointer<vtkMatrix4x4>::New();
+    bool combinedTransformValid(true);
+    for (TransformInfoListType::iterator transformInfo = cachedPath.Path.begin(); transformInfo != cachedPath.Path.end(); ++transformInfo)
     {
-      combinedTransformValid = false;
+      // Same order as vtkTransform::Concatenate in PreMultiply mode
+      vtkMatrix4x4::Multiply4x4(combinedMatrix, (*transformInfo)->m_Transform->GetMatrix(), combinedMatrix);
+      if (!(*transformInfo)->m_IsValid)
+      {
+        combinedTransformValid = false;
+      }
     }
+    vtkMatrix4x4::DeepCopy(cachedPath.Matrix, combinedMatrix);
+    cachedPath.IsValid = combinedTransformValid;
+    cachedPath.Generation = this->UpdateGeneration;
   }
+
   // Save the results
   if (matrix != NULL)
   {
-    matrix->DeepCopy(combinedTransform->GetMatrix());
+    matrix->DeepCopy(cachedPath.Matrix);
   }
 
   if (isValid != NULL)
   {
-    (*isValid) = combinedTransformValid;
+    (*isValid) = cachedPath.IsValid;
   }
 
   return PLUS_SUCCESS;
@@ -552,10 +584,20 @@ PlusStatus vtkPlusTransformRepository::IsExistingTransform(PlusTransformName aTr
     return PLUS_SUCCESS;
   }
   PlusLockGuard<vtkPlusRecursiveCriticalSection> accessGuard(this->CriticalSection);
+  if (this->PathCache.find(std::make_pair(aTransformName.From(), aTransformName.To())) != this->PathCache.end())
+  {
+    return PLUS_SUCCESS;
+  }
   TransformInfoListType transformInfoList;
   return FindPath(aTransformName, transformInfoList, NULL, aSilent);
 }
 
+//----------------------------------------------------------------------------
+void vtkPlusTransformRepository::InvalidatePathCache()
+{
+  this->PathCache.clear();
+}
+
 //----------------------------------------------------------------------------
 PlusStatus vtkPlusTransformRepository::DeleteTransform(const PlusTransformName& aTransformName)
 {
@@ -581,6 +623,8 @@ PlusStatus vtkPlusTransformRepository::DeleteTransform(const PlusTransformName&
                 << aTransformName.From() << " to " << aTransformName.To() << ")");
       return PLUS_FAIL;
     }
+    // Cached paths may refer to the removed transforms
+    this->InvalidatePathCache();
     fromCoordFrame.erase(fromToTransformInfoIt);
   }
   else
@@ -608,6 +652,8 @@ PlusStatus vtkPlusTransformRepository::DeleteTransform(const PlusTransformName&
 //----------------------------------------------------------------------------
 void vtkPlusTransformRepository::Clear()
 {
+  PlusLockGuard<vtkPlusRecursiveCriticalSection> accessGuard(this->CriticalSection);
+  this->InvalidatePathCache();
   this->CoordinateFrames.clear();
 }
 
@@ -12,6 +12,7 @@ See License.txt for details.
 #include "vtkObject.h"
 #include <list>
 #include <map>
+#include <utility>
 
 class PlusTrackedFrame;
 class vtkMatrix4x4;
@@ -36,6 +37,10 @@ Example usage:
   transformRepository->GetTransform("Image", "Tracker", mxImageToTracker, &status);
 \endcode
 
+Transform paths between coordinate frames are cached, the cache is invalidated when transforms are added or deleted.
+The combined transform of a path is computed once after each update of the stored transforms (see UpdateGeneration),
+so repeated queries of the same transform are fast.
+
 The following coordinate frames are used commonly:
   \li Image: image frame coordinate system, origin is the bottom-left corner, unit is pixel
   \li Tool: coordinate system of the DRB attached to the probe, unit is mm
@@ -202,8 +207,38 @@ protected:
   */
   PlusStatus FindPath(const PlusTransformName& aTransformName, TransformInfoListType& transformInfoList, const char* skipCoordFrameName = NULL, bool silent = false);
 
+  /*! Remove all cached paths. Must be called when a transform is added or removed. */
+  void InvalidatePathCache();
+
+  /*!
+    \struct CachedPath
+    \brief Stores a transform path found by FindPath and the transform combined from the path
+    \ingroup PlusLibCommon
+  */
+  struct CachedPath
+  {
+    CachedPath();
+    /*! Transforms to concatenate, pointers remain valid until a transform is removed from CoordinateFrames */
+    TransformInfoListType Path;
+    /*! Value of UpdateGeneration when Matrix and IsValid were computed */
+    unsigned long Generation;
+    /*! Combined transform matrix elements */
+    double Matrix[16];
+    /*! Combined transform valid status */
+    bool IsValid;
+  };
+
+  /*! For each (from, to) coordinate frame name pair stores the path between them */
+  typedef std::map<std::pair<std::string, std::string>, CachedPath> PathCacheMapType;
+
   CoordFrameToCoordFrameToTransformMapType CoordinateFrames;
 
+  /*! Previously found transform paths */
+  PathCacheMapType PathCache;
+
+  /*! Incremented each time a stored transform matrix or status changes, cached combined transforms of older generations are recomputed */
+  unsigned long UpdateGeneration;
+
   vtkPlusRecursiveCriticalSection* CriticalSection;
 
   TransformInfo TransformToSelf;
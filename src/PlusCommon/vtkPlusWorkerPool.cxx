@@ -0,0 +1,170 @@
+/*=Plus=header=begin======================================================
+  Program: Plus
+  Copyright (c) Laboratory for Percutaneous Surgery. All rights reserved.
+  See License.txt for details.
+=========================================================Plus=header=end*/
+
+#include "PlusConfigure.h"
+#include "vtkPlusWorkerPool.h"
+
+// VTK includes
+#include <vtkObjectFactory.h>
+
+// STL includes
+#include <algorithm>
+
+vtkStandardNewMacro(vtkPlusWorkerPool);
+
+//----------------------------------------------------------------------------
+vtkPlusWorkerPool::vtkPlusWorkerPool()
+  : NumberOfThreads(0)
+  , Method(NULL)
+  , UserData(NULL)
+  , ExecutionNumberOfThreads(0)
+  , Generation(0)
+  , NumberOfBusyWorkers(0)
+  , StopRequested(false)
+{
+}
+
+//----------------------------------------------------------------------------
+vtkPlusWorkerPool::~vtkPlusWorkerPool()
+{
+  this->StopWorkers();
+}
+
+//----------------------------------------------------------------------------
+void vtkPlusWorkerPool::PrintSelf(ostream& os, vtkIndent indent)
+{
+  this->Superclass::PrintSelf(os, indent);
+  os << indent << "NumberOfThreads: " << this->GetNumberOfThreads() << std::endl;
+  os << indent << "NumberOfRunningWorkers: " << this->Workers.size() << std::endl;
+}
+
+//----------------------------------------------------------------------------
+void vtkPlusWorkerPool::SetNumberOfThreads(int numberOfThreads)
+{
+  std::lock_guard<std::mutex> executeLock(this->ExecuteMutex);
+  if (this->NumberOfThreads == numberOfThreads)
+  {
+    return;
+  }
+  this->NumberOfThreads = numberOfThreads;
+  this->Modified();
+}
+
+//----------------------------------------------------------------------------
+int vtkPlusWorkerPool::GetNumberOfThreads()
+{
+  if (this->NumberOfThreads > 0)
+  {
+    return this->NumberOfThreads;
+  }
+  return std::max(vtkMultiThreader::GetGlobalDefaultNumberOfThreads(), 1);
+}
+
+//----------------------------------------------------------------------------
+void vtkPlusWorkerPool::SingleMethodExecute(vtkThreadFunctionType method, void* userData)
+{
+  std::lock_guard<std::mutex> executeLock(this->ExecuteMutex);
+
+  int numberOfThreads = this->GetNumberOfThreads();
+  if (static_cast<int>(this->Workers.size()) != numberOfThreads - 1)
+  {
+    this->StopWorkers();
+    this->StartWorkers(numberOfThreads - 1);
+  }
+
+  // Wake up the workers
+  {
+    std::lock_guard<std::mutex> lock(this->Mutex);
+    this->Method = method;
+    this->UserData = userData;
+    this->ExecutionNumberOfThreads = numberOfThreads;
+    this->NumberOfBusyWorkers = static_cast<int>(this->Workers.size());
+    this->Generation++;
+  }
+  this->WorkAvailable.notify_all();
+
+  // The calling thread does its share of the work as thread 0
+  vtkMultiThreader::ThreadInfo threadInfo;
+  threadInfo.ThreadID = 0;
+  threadInfo.NumberOfThreads = numberOfThreads;
+  threadInfo.ActiveFlag = NULL;
+  threadInfo.ActiveFlagLock = NULL;
+  threadInfo.UserData = userData;
+  method(&threadInfo);
+
+  // Wait for all the workers to complete
+  std::unique_lock<std::mutex> lock(this->Mutex);
+  this->WorkDone.wait(lock, [this] { return this->NumberOfBusyWorkers == 0; });
+  this->Method = NULL;
+  this->UserData = NULL;
+}
+
+//----------------------------------------------------------------------------
+void vtkPlusWorkerPool::StartWorkers(int numberOfWorkers)
+{
+  unsigned long currentGeneration = 0;
+  {
+    std::lock_guard<std::mutex> lock(this->Mutex);
+    this->StopRequested = false;
+    currentGeneration = this->Generation;
+  }
+  for (int i = 0; i < numberOfWorkers; ++i)
+  {
+    // Worker threads are numbered from 1, thread 0 is the calling thread
+    this->Workers.push_back(std::thread(&vtkPlusWorkerPool::WorkerLoop, this, i + 1, currentGeneration));
+  }
+}
+
+//----------------------------------------------------------------------------
+void vtkPlusWorkerPool::StopWorkers()
+{
+  {
+    std::lock_guard<std::mutex> lock(this->Mutex);
+    this->StopRequested = true;
+  }
+  this->WorkAvailable.notify_all();
+  for (std::vector<std::thread>::iterator it = this->Workers.begin(); it != this->Workers.end(); ++it)
+  {
+    it->join();
+  }
+  this->Workers.clear();
+}
+
+//----------------------------------------------------------------------------
+void vtkPlusWorkerPool::WorkerLoop(int threadId, unsigned long processedGeneration)
+{
+  while (true)
+  {
+    vtkMultiThreader::ThreadInfo threadInfo;
+    vtkThreadFunctionType method = NULL;
+    {
+      std::unique_lock<std::mutex> lock(this->Mutex);
+      this->WorkAvailable.wait(lock, [this, processedGeneration] { return this->StopRequested || this->Generation != processedGeneration; });
+      if (this->StopRequested)
+      {
+        return;
+      }
+      processedGeneration = this->Generation;
+      method = this->Method;
+      threadInfo.ThreadID = threadId;
+      threadInfo.NumberOfThreads = this->ExecutionNumberOfThreads;
+      threadInfo.ActiveFlag = NULL;
+      threadInfo.ActiveFlagLock = NULL;
+      threadInfo.UserData = this->UserData;
+    }
+
+    method(&threadInfo);
+
+    {
+      std::lock_guard<std::mutex> lock(this->Mutex);
+      this->NumberOfBusyWorkers--;
+      if (this->NumberOfBusyWorkers == 0)
+      {
+        this->WorkDone.notify_one();
+      }
+    }
+  }
+}
@@ -0,0 +1,95 @@
+/*=Plus=header=begin======================================================
+  Program: Plus
+  Copyright (c) Laboratory for Percutaneous Surgery. All rights reserved.
+  See License.txt for details.
+=========================================================Plus=header=end*/
+
+#ifndef __vtkPlusWorkerPool_h
+#define __vtkPlusWorkerPool_h
+
+#include "vtkPlusCommonExport.h"
+
+// VTK includes
+#include <vtkMultiThreader.h>
+#include <vtkObject.h>
+
+// STL includes
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/*!
+  \class vtkPlusWorkerPool
+  \brief Executes a method on multiple threads, using worker threads that are kept alive between executions
+
+  The interface is the same as vtkMultiThreader's SingleMethodExecute, but vtkMultiThreader creates and joins
+  the threads at each execution. For short tasks that are executed at a high rate (such as pasting
+  a slice into a volume) the thread creation overhead is significant, therefore this class starts the worker threads
+  once and wakes them up for each execution. The calling thread executes the method as thread 0 and the call returns
+  when all threads have finished, so each execution acts as a barrier.
+
+  \ingroup PlusLibCommon
+*/
+class vtkPlusCommonExport vtkPlusWorkerPool : public vtkObject
+{
+public:
+  static vtkPlusWorkerPool* New();
+  vtkTypeMacro(vtkPlusWorkerPool, vtkObject);
+  virtual void PrintSelf(ostream& os, vtkIndent indent) VTK_OVERRIDE;
+
+  /*!
+    Set the number of threads (including the calling thread) that execute the method.
+    0 means that vtkMultiThreader's global default number of threads is used.
+    The worker threads are restarted at the next execution if the number of threads is changed.
+  */
+  void SetNumberOfThreads(int numberOfThreads);
+  /*! Get the number of threads that execute the method */
+  int GetNumberOfThreads();
+
+  /*!
+    Execute the method on all threads. The method receives a vtkMultiThreader::ThreadInfo structure,
+    with ThreadID, NumberOfThreads, and UserData set. Returns when all threads have completed the method.
+  */
+  void SingleMethodExecute(vtkThreadFunctionType method, void* userData);
+
+protected:
+  vtkPlusWorkerPool();
+  virtual ~vtkPlusWorkerPool();
+
+  /*! Start numberOfWorkers threads that wait for work */
+  void StartWorkers(int numberOfWorkers);
+
+  /*! Stop and join all worker threads */
+  void StopWorkers();
+
+  /*! Main loop of a worker thread, processedGeneration is the generation at the time the worker was started */
+  void WorkerLoop(int threadId, unsigned long processedGeneration);
+
+  int NumberOfThreads;
+
+  std::vector<std::thread> Workers;
+
+  /*! Protects the work description and the counters below */
+  std::mutex Mutex;
+  std::condition_variable WorkAvailable;
+  std::condition_variable WorkDone;
+
+  vtkThreadFunctionType Method;
+  void* UserData;
+  int ExecutionNumberOfThreads;
+
+  /*! Incremented at each execution, workers compare it to the last generation they processed */
+  unsigned long Generation;
+  int NumberOfBusyWorkers;
+  bool StopRequested;
+
+  /*! Only one execution can run at a time */
+  std::mutex ExecuteMutex;
+
+private:
+  vtkPlusWorkerPool(const vtkPlusWorkerPool&);
+  void operator=(const vtkPlusWorkerPool&);
+};
+
+#endif
@@ -17,10 +17,69 @@ See License.txt for details.
 #include "vtkPlusTransformRepository.h"
 #include "vtksys/SystemTools.hxx"
 
+// STL includes
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+
 //----------------------------------------------------------------------------
 
 vtkStandardNewMacro(vtkPlusImageProcessorVideoSource);
 
+namespace
+{
+  // Weight of the most recent measurement in the averaged latency values
+  const double LATENCY_AVERAGING_WEIGHT = 0.1;
+
+  //----------------------------------------------------------------------------
+  void UpdateAverage(double& average, double newValue, bool firstValue)
+  {
+    average = firstValue ? newValue : (1.0 - LATENCY_AVERAGING_WEIGHT) * average + LATENCY_AVERAGING_WEIGHT * newValue;
+  }
+}
+
+//----------------------------------------------------------------------------
+struct vtkPlusImageProcessorVideoSource::ProcessingStage
+{
+  struct QueuedFrame
+  {
+    vtkPlusTrackedFrameList* Frames;
+    /*! System time when the frame entered the first stage, used for computing the pipeline latency */
+    double PipelineEntryTime;
+  };
+
+  ProcessingStage()
+    : Owner(NULL)
+    , Processor(NULL)
+    , NextStage(NULL)
+    , ThreadId(-1)
+    , Active(false)
+    , LatencySec(0.0)
+    , NumberOfProcessedFrames(0)
+  {
+  }
+
+  vtkPlusImageProcessorVideoSource* Owner;
+  vtkPlusTrackedFrameProcessor* Processor;
+  /*! Stage that receives the output of this stage, NULL for the last stage */
+  ProcessingStage* NextStage;
+  int ThreadId;
+
+  /*! Frames waiting to be processed, in acquisition order */
+  std::deque<QueuedFrame> Queue;
+  /*! Protects the queue, the active flag, and the statistics */
+  std::mutex Mutex;
+  /*! Signaled when a frame is added to the queue or the stage is stopped */
+  std::condition_variable FrameQueued;
+  /*! Signaled when a frame is removed from the queue or the stage is stopped */
+  std::condition_variable FrameDequeued;
+  bool Active;
+
+  double LatencySec;
+  long NumberOfProcessedFrames;
+};
+
 //----------------------------------------------------------------------------
 vtkPlusImageProcessorVideoSource::vtkPlusImageProcessorVideoSource()
   : vtkPlusDevice()
@@ -28,7 +87,12 @@ vtkPlusImageProcessorVideoSource::vtkPlusImageProcessorVideoSource()
   , EnableProcessing(true)
   , ProcessingAlgorithmAccessMutex(vtkSmartPointer<vtkPlusRecursiveCriticalSection>::New())
   , GracePeriodLogLevel(vtkPlusLogger::LOG_LEVEL_DEBUG)
-  , ProcessorAlgorithm(NULL)
+  , ProcessingStagesMutex(vtkSmartPointer<vtkPlusRecursiveCriticalSection>::New())
+  , MaxStageQueueSize(3)
+  , StatisticsMutex(vtkSmartPointer<vtkPlusRecursiveCriticalSection>::New())
+  , PipelineLatencySec(0.0)
+  , NumberOfDroppedFrames(0)
+  , NumberOfInputFrames(0)
 {
   this->MissingInputGracePeriodSec = 2.0;
 
@@ -42,22 +106,33 @@ vtkPlusImageProcessorVideoSource::vtkPlusImageProcessorVideoSource()
 //----------------------------------------------------------------------------
 vtkPlusImageProcessorVideoSource::~vtkPlusImageProcessorVideoSource()
 {
+  this->StopProcessingStages();
   if (this->TransformRepository)
   {
     this->TransformRepository->Delete();
     this->TransformRepository = NULL;
   }
-  if (this->ProcessorAlgorithm)
+  for (std::vector<vtkPlusTrackedFrameProcessor*>::iterator processorIt = this->ProcessorAlgorithms.begin(); processorIt != this->ProcessorAlgorithms.end(); ++processorIt)
   {
-    this->ProcessorAlgorithm->Delete();
-    this->ProcessorAlgorithm = NULL;
+    (*processorIt)->Delete();
   }
+  this->ProcessorAlgorithms.clear();
 }
 
 //----------------------------------------------------------------------------
 void vtkPlusImageProcessorVideoSource::PrintSelf(ostream& os, vtkIndent indent)
 {
   this->Superclass::PrintSelf(os, indent);
+  os << indent << "MaxStageQueueSize: " << this->MaxStageQueueSize << std::endl;
+  for (int stageIndex = 0; stageIndex < this->GetNumberOfProcessingStages(); ++stageIndex)
+  {
+    os << indent << "Stage " << stageIndex << " (" << this->ProcessorAlgorithms[stageIndex]->GetProcessorTypeName() << "): "
+       << "latency: " << this->GetProcessingStageLatencySec(stageIndex) << " sec, "
+       << "queue depth: " << this->GetProcessingStageQueueDepth(stageIndex) << std::endl;
+  }
+  os << indent << "PipelineLatencySec: " << this->GetPipelineLatencySec() << std::endl;
+  os << indent << "NumberOfDroppedFrames: " << this->GetNumberOfDroppedFrames() << std::endl;
+  os << indent << "NumberOfInputFrames: " << this->GetNumberOfInputFrames() << std::endl;
 }
 
 //----------------------------------------------------------------------------
@@ -65,6 +140,7 @@ PlusStatus vtkPlusImageProcessorVideoSource::ReadConfiguration(vtkXMLDataElement
 {
   XML_FIND_DEVICE_ELEMENT_REQUIRED_FOR_READING(deviceConfig, rootConfigElement);
   XML_READ_BOOL_ATTRIBUTE_OPTIONAL(EnableProcessing, deviceConfig);
+  XML_READ_SCALAR_ATTRIBUTE_OPTIONAL(int, MaxStageQueueSize, deviceConfig);
 
   // Read transform repository configuration
   if (this->TransformRepository->ReadConfiguration(rootConfigElement) != PLUS_SUCCESS)
@@ -73,12 +149,12 @@ PlusStatus vtkPlusImageProcessorVideoSource::ReadConfiguration(vtkXMLDataElement
     return PLUS_FAIL;
   }
 
-  // Instantiate processor(s)
-  if (this->ProcessorAlgorithm)
+  // Instantiate processors, they will process the frames in the order as they are listed
+  for (std::vector<vtkPlusTrackedFrameProcessor*>::iterator processorIt = this->ProcessorAlgorithms.begin(); processorIt != this->ProcessorAlgorithms.end(); ++processorIt)
   {
-    this->ProcessorAlgorithm->Delete();
-    this->ProcessorAlgorithm = NULL;
+    (*processorIt)->Delete();
   }
+  this->ProcessorAlgorithms.clear();
   int numberOfNestedElements = deviceConfig->GetNumberOfNestedElements();
   for (int nestedElemIndex = 0; nestedElemIndex < numberOfNestedElements; ++nestedElemIndex)
   {
@@ -90,12 +166,6 @@ PlusStatus vtkPlusImageProcessorVideoSource::ReadConfiguration(vtkXMLDataElement
       continue;
     }
 
-    if (this->ProcessorAlgorithm != NULL)
-    {
-      LOG_WARNING("Multiple " << processorElement->GetName() << " elements found in ImageProcessor configuration. Only the first one is used, all others are ignored");
-      break;
-    }
-
     // Verify type
     const char* processorType = processorElement->GetAttribute("Type");
     if (processorType == NULL)
@@ -111,17 +181,15 @@ PlusStatus vtkPlusImageProcessorVideoSource::ReadConfiguration(vtkXMLDataElement
     {
       boneEnhancer->SetTransformRepository(this->TransformRepository);
       boneEnhancer->ReadConfiguration(processorElement);
-      this->ProcessorAlgorithm = boneEnhancer;
-      this->ProcessorAlgorithm->Register(this);
-      break;                  // If only one processor is allowed per ImageProcessor class, we can break out when we find it.
+      boneEnhancer->Register(this);
+      this->ProcessorAlgorithms.push_back(boneEnhancer);
     }
     else if (!(STRCASECMP(TransverseProcessEnhancer->GetProcessorTypeName(), processorType)))
     {
       TransverseProcessEnhancer->SetTransformRepository(this->TransformRepository);
       TransverseProcessEnhancer->ReadConfiguration(processorElement);
-      this->ProcessorAlgorithm = TransverseProcessEnhancer;
-      this->ProcessorAlgorithm->Register(this);
-      break;
+      TransverseProcessEnhancer->Register(this);
+      this->ProcessorAlgorithms.push_back(TransverseProcessEnhancer);
     }
     else
     {
@@ -138,17 +206,26 @@ PlusStatus vtkPlusImageProcessorVideoSource::WriteConfiguration(vtkXMLDataElemen
 {
   XML_FIND_DEVICE_ELEMENT_REQUIRED_FOR_WRITING(deviceElement, rootConfig);
   deviceElement->SetAttribute("EnableCapturing", this->EnableProcessing ? "TRUE" : "FALSE");
+  deviceElement->SetIntAttribute("MaxStageQueueSize", this->MaxStageQueueSize);
 
-  // Write processor elements
-  if (this->ProcessorAlgorithm != NULL)
+  // Write processor elements, in the order of processing
+  if (!this->ProcessorAlgorithms.empty())
   {
-    vtkXMLDataElement* processorElement = PlusXmlUtils::GetNestedElementWithName(deviceElement, vtkPlusTrackedFrameProcessor::GetTagName());
-    if (processorElement == NULL)
+    unsigned int processorIndex = 0;
+    for (int nestedElemIndex = 0; nestedElemIndex < deviceElement->GetNumberOfNestedElements() && processorIndex < this->ProcessorAlgorithms.size(); ++nestedElemIndex)
+    {
+      vtkXMLDataElement* processorElement = deviceElement->GetNestedElement(nestedElemIndex);
+      if ((processorElement == NULL) || (STRCASECMP(vtkPlusTrackedFrameProcessor::GetTagName(), processorElement->GetName())))
+      {
+        continue;
+      }
+      this->ProcessorAlgorithms[processorIndex++]->WriteConfiguration(processorElement);
+    }
+    if (processorIndex < this->ProcessorAlgorithms.size())
     {
-      LOG_ERROR("Cannot find " << vtkPlusTrackedFrameProcessor::GetTagName() << " element in XML tree!");
+      LOG_ERROR("Cannot find " << vtkPlusTrackedFrameProcessor::GetTagName() << " element for each processor in XML tree!");
       return PLUS_FAIL;
     }
-    this->ProcessorAlgorithm->WriteConfiguration(processorElement);
   }
   else
   {
@@ -188,7 +265,7 @@ PlusStatus vtkPlusImageProcessorVideoSource::InternalConnect()
 
   this->LastProcessedInputDataTimestamp = 0;
 
-  return PLUS_SUCCESS;
+  return this->StartProcessingStages();
 }
 
 //----------------------------------------------------------------------------
@@ -196,6 +273,7 @@ PlusStatus vtkPlusImageProcessorVideoSource::InternalDisconnect()
 {
   PlusLockGuard<vtkPlusRecursiveCriticalSection> writerLock(this->ProcessingAlgorithmAccessMutex);
   this->EnableProcessing = false;
+  this->StopProcessingStages();
   return PLUS_SUCCESS;
 }
 
@@ -261,14 +339,42 @@ PlusStatus vtkPlusImageProcessorVideoSource::InternalUpdate()
     return PLUS_SUCCESS;
   }
 
-  vtkSmartPointer<vtkPlusTrackedFrameList> trackingFrames = vtkSmartPointer<vtkPlusTrackedFrameList>::New();
-  trackingFrames->AddTrackedFrame(&trackedFrame);
-  this->ProcessorAlgorithm->SetInputFrames(trackingFrames);
-  if (this->ProcessorAlgorithm->Update() != PLUS_SUCCESS)
+  if (frameTimestamp <= this->LastProcessedInputDataTimestamp)
+  {
+    // this frame has been already sent for processing
+    return PLUS_SUCCESS;
+  }
+  this->LastProcessedInputDataTimestamp = frameTimestamp;
+
+  PlusLockGuard<vtkPlusRecursiveCriticalSection> stagesLock(this->ProcessingStagesMutex);
+  if (this->ProcessingStages.empty())
   {
+    LOG_ERROR("No processors are running in the image processor device. Device ID: " << this->GetDeviceId());
     return PLUS_FAIL;
   }
 
+  // Hand over the frame to the first processing stage. The processed frame is added to the output by the last stage.
+  vtkPlusTrackedFrameList* inputFrames = vtkPlusTrackedFrameList::New();
+  inputFrames->AddTrackedFrame(&trackedFrame);
+  {
+    PlusLockGuard<vtkPlusRecursiveCriticalSection> statisticsLock(this->StatisticsMutex);
+    this->NumberOfInputFrames++;
+  }
+  this->EnqueueFrame(this->ProcessingStages.front(), inputFrames, vtkPlusAccurateTimer::GetSystemTime(), true);
+
+  return PLUS_SUCCESS;
+}
+
+//----------------------------------------------------------------------------
+PlusStatus vtkPlusImageProcessorVideoSource::AddProcessedFrameToOutput(PlusTrackedFrame* processedTrackedFrame, double pipelineEntryTime)
+{
+  if (this->OutputChannels.empty())
+  {
+    LOG_ERROR("No output channels defined");
+    return PLUS_FAIL;
+  }
+  vtkPlusChannel* outputChannel = this->OutputChannels[0];
+
   vtkPlusDataSource* aSource(NULL);
   if (outputChannel->GetVideoSource(aSource) != PLUS_SUCCESS)
   {
@@ -278,14 +384,7 @@ PlusStatus vtkPlusImageProcessorVideoSource::InternalUpdate()
 
   PlusStatus status = PLUS_SUCCESS;
 
-  vtkPlusTrackedFrameList* processedFrames = this->ProcessorAlgorithm->GetOutputFrames();
-  if (processedFrames == NULL || processedFrames->GetNumberOfTrackedFrames() < 1)
-  {
-    LOG_ERROR("Failed to retrieve processed frame");
-    return PLUS_FAIL;
-  }
-
-  PlusTrackedFrame* processedTrackedFrame = processedFrames->GetTrackedFrame(0);
+  double frameTimestamp = processedTrackedFrame->GetTimestamp();
   // Generate unique frame number (not used for filtering, so the actual increment value does not matter)
   this->FrameNumber++;
 
@@ -316,10 +415,262 @@ PlusStatus vtkPlusImageProcessorVideoSource::InternalUpdate()
     status = PLUS_FAIL;
   }
 
+  {
+    PlusLockGuard<vtkPlusRecursiveCriticalSection> statisticsLock(this->StatisticsMutex);
+    UpdateAverage(this->PipelineLatencySec, vtkPlusAccurateTimer::GetSystemTime() - pipelineEntryTime, this->PipelineLatencySec == 0.0);
+  }
+
   this->Modified();
   return status;
 }
 
+//----------------------------------------------------------------------------
+PlusStatus vtkPlusImageProcessorVideoSource::StartProcessingStages()
+{
+  PlusLockGuard<vtkPlusRecursiveCriticalSection> stagesLock(this->ProcessingStagesMutex);
+  this->StopProcessingStages();
+
+  if (this->ProcessorAlgorithms.empty())
+  {
+    LOG_ERROR("No " << vtkPlusTrackedFrameProcessor::GetTagName() << " element is defined for ImageProcessor device " << this->GetDeviceId());
+    return PLUS_FAIL;
+  }
+
+  {
+    PlusLockGuard<vtkPlusRecursiveCriticalSection> statisticsLock(this->StatisticsMutex);
+    this->PipelineLatencySec = 0.0;
+    this->NumberOfDroppedFrames = 0;
+    this->NumberOfInputFrames = 0;
+  }
+
+  for (std::vector<vtkPlusTrackedFrameProcessor*>::iterator processorIt = this->ProcessorAlgorithms.begin(); processorIt != this->ProcessorAlgorithms.end(); ++processorIt)
+  {
+    ProcessingStage* stage = new ProcessingStage;
+    stage->Owner = this;
+    stage->Processor = *processorIt;
+    stage->Active = true;
+    if (!this->ProcessingStages.empty())
+    {
+      this->ProcessingStages.back()->NextStage = stage;
+    }
+    this->ProcessingStages.push_back(stage);
+  }
+
+  for (std::vector<ProcessingStage*>::iterator stageIt = this->ProcessingStages.begin(); stageIt != this->ProcessingStages.end(); ++stageIt)
+  {
+    (*stageIt)->ThreadId = this->Threader->SpawnThread((vtkThreadFunctionType)&ProcessingStageThread, *stageIt);
+    if ((*stageIt)->ThreadId < 0)
+    {
+      LOG_ERROR(this->GetDeviceId() << ": Failed to start processing thread for " << (*stageIt)->Processor->GetProcessorTypeName());
+      this->StopProcessingStages();
+      return PLUS_FAIL;
+    }
+  }
+
+  return PLUS_SUCCESS;
+}
+
+//----------------------------------------------------------------------------
+void vtkPlusImageProcessorVideoSource::StopProcessingStages()
+{
+  // Stage threads never lock the stage list, so they can be joined while it is locked
+  PlusLockGuard<vtkPlusRecursiveCriticalSection> stagesLock(this->ProcessingStagesMutex);
+
+  // Deactivate all the stages first, so that no stage is left waiting for room in the queue of a stopped stage
+  for (std::vector<ProcessingStage*>::iterator stageIt = this->ProcessingStages.begin(); stageIt != this->ProcessingStages.end(); ++stageIt)
+  {
+    {
+      std::lock_guard<std::mutex> queueLock((*stageIt)->Mutex);
+      (*stageIt)->Active = false;
+    }
+    (*stageIt)->FrameQueued.notify_all();
+    (*stageIt)->FrameDequeued.notify_all();
+  }
+
+  for (std::vector<ProcessingStage*>::iterator stageIt = this->ProcessingStages.begin(); stageIt != this->ProcessingStages.end(); ++stageIt)
+  {
+    if ((*stageIt)->ThreadId >= 0)
+    {
+      // Waits until the thread exits
+      this->Threader->TerminateThread((*stageIt)->ThreadId);
+    }
+  }
+
+  for (std::vector<ProcessingStage*>::iterator stageIt = this->ProcessingStages.begin(); stageIt != this->ProcessingStages.end(); ++stageIt)
+  {
+    for (std::deque<ProcessingStage::QueuedFrame>::iterator frameIt = (*stageIt)->Queue.begin(); frameIt != (*stageIt)->Queue.end(); ++frameIt)
+    {
+      frameIt->Frames->Delete();
+    }
+    delete *stageIt;
+  }
+  this->ProcessingStages.clear();
+}
+
+//----------------------------------------------------------------------------
+void vtkPlusImageProcessorVideoSource::EnqueueFrame(ProcessingStage* stage, vtkPlusTrackedFrameList* frames, double pipelineEntryTime, bool dropOldestIfFull)
+{
+  {
+    std::unique_lock<std::mutex> queueLock(stage->Mutex);
+    const int maxQueueSize = std::max(this->MaxStageQueueSize, 1);
+    if (dropOldestIfFull)
+    {
+      while (static_cast<int>(stage->Queue.size()) >= maxQueueSize)
+      {
+        stage->Queue.front().Frames->Delete();
+        stage->Queue.pop_front();
+        PlusLockGuard<vtkPlusRecursiveCriticalSection> statisticsLock(this->StatisticsMutex);
+        this->NumberOfDroppedFrames++;
+      }
+    }
+    else
+    {
+      stage->FrameDequeued.wait(queueLock, [stage, maxQueueSize]
+      {
+        return !stage->Active || static_cast<int>(stage->Queue.size()) < maxQueueSize;
+      });
+    }
+    if (!stage->Active)
+    {
+      frames->Delete();
+      return;
+    }
+    ProcessingStage::QueuedFrame queuedFrame = { frames, pipelineEntryTime };
+    stage->Queue.push_back(queuedFrame);
+  }
+  stage->FrameQueued.notify_one();
+}
+
+//----------------------------------------------------------------------------
+void* vtkPlusImageProcessorVideoSource::ProcessingStageThread(vtkMultiThreader::ThreadInfo* data)
+{
+  ProcessingStage* stage = (ProcessingStage*)(data->UserData);
+  vtkPlusImageProcessorVideoSource* self = stage->Owner;
+
+  while (true)
+  {
+    ProcessingStage::QueuedFrame queuedFrame;
+    {
+      std::unique_lock<std::mutex> queueLock(stage->Mutex);
+      stage->FrameQueued.wait(queueLock, [stage]
+      {
+        return !stage->Active || !stage->Queue.empty();
+      });
+      if (!stage->Active)
+      {
+        break;
+      }
+      queuedFrame = stage->Queue.front();
+      stage->Queue.pop_front();
+    }
+    // Let the previous stage continue if it is waiting for room in the queue
+    stage->FrameDequeued.notify_one();
+
+    double processingStartTime = vtkPlusAccurateTimer::GetSystemTime();
+    stage->Processor->SetInputFrames(queuedFrame.Frames);
+    PlusStatus status = stage->Processor->Update();
+    stage->Processor->SetInputFrames(NULL);
+    queuedFrame.Frames->Delete();
+    {
+      std::lock_guard<std::mutex> queueLock(stage->Mutex);
+      UpdateAverage(stage->LatencySec, vtkPlusAccurateTimer::GetSystemTime() - processingStartTime, stage->NumberOfProcessedFrames == 0);
+      stage->NumberOfProcessedFrames++;
+    }
+
+    vtkPlusTrackedFrameList* processedFrames = stage->Processor->GetOutputFrames();
+    if (status != PLUS_SUCCESS || processedFrames == NULL || processedFrames->GetNumberOfTrackedFrames() < 1)
+    {
+      LOG_ERROR("Failed to process frame by " << stage->Processor->GetProcessorTypeName() << " processor in device " << self->GetDeviceId());
+      continue;
+    }
+
+    if (stage->NextStage != NULL)
+    {
+      vtkPlusTrackedFrameList* nextStageInputFrames = vtkPlusTrackedFrameList::New();
+      nextStageInputFrames->AddTrackedFrameList(processedFrames);
+      self->EnqueueFrame(stage->NextStage, nextStageInputFrames, queuedFrame.PipelineEntryTime, false);
+    }
+    else
+    {
+      self->AddProcessedFrameToOutput(processedFrames->GetTrackedFrame(0), queuedFrame.PipelineEntryTime);
+    }
+  }
+
+  return NULL;
+}
+
+//----------------------------------------------------------------------------
+PlusStatus vtkPlusImageProcessorVideoSource::AddProcessor(vtkPlusTrackedFrameProcessor* processor)
+{
+  if (processor == NULL)
+  {
+    LOG_ERROR("Cannot add processor to ImageProcessor device " << this->GetDeviceId() << ": invalid processor");
+    return PLUS_FAIL;
+  }
+  if (this->Connected)
+  {
+    LOG_ERROR("Cannot add processor to ImageProcessor device " << this->GetDeviceId() << " while it is connected");
+    return PLUS_FAIL;
+  }
+  processor->SetTransformRepository(this->TransformRepository);
+  processor->Register(this);
+  this->ProcessorAlgorithms.push_back(processor);
+  return PLUS_SUCCESS;
+}
+
+//----------------------------------------------------------------------------
+int vtkPlusImageProcessorVideoSource::GetNumberOfProcessingStages()
+{
+  return static_cast<int>(this->ProcessorAlgorithms.size());
+}
+
+//----------------------------------------------------------------------------
+double vtkPlusImageProcessorVideoSource::GetProcessingStageLatencySec(int stageIndex)
+{
+  PlusLockGuard<vtkPlusRecursiveCriticalSection> stagesLock(this->ProcessingStagesMutex);
+  if (stageIndex < 0 || stageIndex >= static_cast<int>(this->ProcessingStages.size()))
+  {
+    return 0.0;
+  }
+  ProcessingStage* stage = this->ProcessingStages[stageIndex];
+  std::lock_guard<std::mutex> queueLock(stage->Mutex);
+  return stage->LatencySec;
+}
+
+//----------------------------------------------------------------------------
+int vtkPlusImageProcessorVideoSource::GetProcessingStageQueueDepth(int stageIndex)
+{
+  PlusLockGuard<vtkPlusRecursiveCriticalSection> stagesLock(this->ProcessingStagesMutex);
+  if (stageIndex < 0 || stageIndex >= static_cast<int>(this->ProcessingStages.size()))
+  {
+    return 0;
+  }
+  ProcessingStage* stage = this->ProcessingStages[stageIndex];
+  std::lock_guard<std::mutex> queueLock(stage->Mutex);
+  return static_cast<int>(stage->Queue.size());
+}
+
+//----------------------------------------------------------------------------
+double vtkPlusImageProcessorVideoSource::GetPipelineLatencySec()
+{
+  PlusLockGuard<vtkPlusRecursiveCriticalSection> statisticsLock(this->StatisticsMutex);
+  return this->PipelineLatencySec;
+}
+
+//----------------------------------------------------------------------------
+long vtkPlusImageProcessorVideoSource::GetNumberOfDroppedFrames()
+{
+  PlusLockGuard<vtkPlusRecursiveCriticalSection> statisticsLock(this->StatisticsMutex);
+  return this->NumberOfDroppedFrames;
+}
+
+//----------------------------------------------------------------------------
+long vtkPlusImageProcessorVideoSource::GetNumberOfInputFrames()
+{
+  PlusLockGuard<vtkPlusRecursiveCriticalSection> statisticsLock(this->StatisticsMutex);
+  return this->NumberOfInputFrames;
+}
+
 //-----------------------------------------------------------------------------
 PlusStatus vtkPlusImageProcessorVideoSource::NotifyConfigured()
 {
@@ -10,8 +10,13 @@ See License.txt for details.
 #include "vtkPlusDataCollectionExport.h"
 
 #include "vtkPlusDevice.h"
+
+// STL includes
 #include <string>
+#include <vector>
 
+class PlusTrackedFrame;
+class vtkPlusTrackedFrameList;
 class vtkPlusTransformRepository;
 class vtkPlusTrackedFrameProcessor;
 
@@ -19,6 +24,12 @@ class vtkPlusTrackedFrameProcessor;
 \class vtkPlusImageProcessorVideoSource 
 \brief Virtual device that performs real-time image processing on the input channel
 
+The input frames are processed by a chain of processors, in the order they are listed in the configuration.
+Each processor runs on its own thread and the stages are connected by bounded queues, so that the throughput
+is limited by the slowest stage and not by the sum of the processing times of all the stages.
+If the first stage cannot keep up with the input then the oldest waiting input frames are dropped.
+Later stages wait for room in the queue of the next stage.
+
 \ingroup PlusLibDataCollection
 */
 class vtkPlusDataCollectionExport vtkPlusImageProcessorVideoSource : public vtkPlusDevice
@@ -45,6 +56,36 @@ public:
   virtual bool IsTracker() const { return false; }
   virtual bool IsVirtual() const { return true; }
 
+  /*! Maximum number of frames that may wait for processing in the input queue of each stage. Default is 3. */
+  vtkSetMacro(MaxStageQueueSize, int);
+  vtkGetMacro(MaxStageQueueSize, int);
+
+  /*!
+    Add a processor to the end of the processing chain. Processors are normally created from the Processor elements
+    of the device configuration, this method allows adding processors that the configuration reader does not know about.
+    The processor list is rebuilt by ReadConfiguration, therefore processors must be added after the configuration is read
+    and before the device is connected.
+  */
+  PlusStatus AddProcessor(vtkPlusTrackedFrameProcessor* processor);
+
+  /*! Get the number of processing stages (processors in the chain) */
+  int GetNumberOfProcessingStages();
+
+  /*! Get the average time [s] that a processing stage spends on processing a frame (waiting in the queue is not included) */
+  double GetProcessingStageLatencySec(int stageIndex);
+
+  /*! Get the number of frames waiting in the input queue of a processing stage */
+  int GetProcessingStageQueueDepth(int stageIndex);
+
+  /*! Get the average time [s] between receiving an input frame and adding the processed frame to the output buffer */
+  double GetPipelineLatencySec();
+
+  /*! Get the number of input frames that were dropped because the first processing stage could not keep up with the input */
+  long GetNumberOfDroppedFrames();
+
+  /*! Get the number of input frames that were handed over to the first processing stage since the device was connected (including the dropped frames) */
+  long GetNumberOfInputFrames();
+
 protected:
   virtual PlusStatus InternalConnect();
   virtual PlusStatus InternalDisconnect();
@@ -52,6 +93,24 @@ protected:
   vtkPlusImageProcessorVideoSource();
   virtual ~vtkPlusImageProcessorVideoSource();
 
+  /*! A processor in the chain, with its input queue and worker thread. Defined in the implementation file. */
+  struct ProcessingStage;
+
+  /*! Create the processing stages and start their threads */
+  PlusStatus StartProcessingStages();
+
+  /*! Stop the stage threads and discard all frames that are still in the queues */
+  void StopProcessingStages();
+
+  /*! Add a frame to the input queue of a stage. If the queue is full then either the oldest frame is dropped or the call waits until there is room. */
+  void EnqueueFrame(ProcessingStage* stage, vtkPlusTrackedFrameList* frames, double pipelineEntryTime, bool dropOldestIfFull);
+
+  /*! Add the result of the last processing stage to the output buffer */
+  PlusStatus AddProcessedFrameToOutput(PlusTrackedFrame* processedTrackedFrame, double pipelineEntryTime);
+
+  /*! Thread function of a processing stage */
+  static void* ProcessingStageThread(vtkMultiThreader::ThreadInfo* data);
+
   double LastProcessedInputDataTimestamp;
 
   bool EnableProcessing;
@@ -67,7 +126,22 @@ protected:
 
   vtkPlusLogger::LogLevelType GracePeriodLogLevel;
 
-  vtkPlusTrackedFrameProcessor* ProcessorAlgorithm;
+  /*! Processors in the order of processing */
+  std::vector<vtkPlusTrackedFrameProcessor*> ProcessorAlgorithms;
+
+  /*! Processing stages, one for each processor (only exist while the device is connected) */
+  std::vector<ProcessingStage*> ProcessingStages;
+
+  /*! Protects the list of processing stages. If the mutex of a stage is needed as well, this mutex must be locked first. */
+  vtkSmartPointer<vtkPlusRecursiveCriticalSection> ProcessingStagesMutex;
+
+  int MaxStageQueueSize;
+
+  /*! Protects the pipeline statistics */
+  vtkSmartPointer<vtkPlusRecursiveCriticalSection> StatisticsMutex;
+  double PipelineLatencySec;
+  long NumberOfDroppedFrames;
+  long NumberOfInputFrames;
 
 private:
   vtkPlusImageProcessorVideoSource(const vtkPlusImageProcessorVideoSource&);  // Not implemented.
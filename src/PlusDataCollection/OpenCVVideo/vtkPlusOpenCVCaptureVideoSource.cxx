@@ -32,6 +32,9 @@ vtkPlusOpenCVCaptureVideoSource::vtkPlusOpenCVCaptureVideoSource()
   , UndistortedFrame(nullptr)
   , CameraMatrix(nullptr)
   , DistortionCoefficients(nullptr)
+  , UndistortRegionOfInterest(nullptr)
+  , UndistortMap1(nullptr)
+  , UndistortMap2(nullptr)
   , AutofocusEnabled(false)
   , AutoexposureEnabled(false)
 {
@@ -54,6 +57,7 @@ void vtkPlusOpenCVCaptureVideoSource::PrintSelf(ostream& os, vtkIndent indent)
   os << indent << "DeviceIndex: " << this->DeviceIndex << std::endl;
   os << indent << "RequestedCaptureAPI: " << vtkPlusOpenCVCaptureVideoSource::StringFromCaptureAPI(this->RequestedCaptureAPI) << std::endl;
 
+  std::lock_guard<std::mutex> undistortLock(this->UndistortMutex);
   if (this->CameraMatrix != nullptr)
   {
     os << indent << "CamerMatrix: " << *this->CameraMatrix << std::endl;
@@ -62,6 +66,10 @@ void vtkPlusOpenCVCaptureVideoSource::PrintSelf(ostream& os, vtkIndent indent)
   {
     os << indent << "DistortionCoefficients: " << *this->DistortionCoefficients << std::endl;
   }
+  if (this->UndistortRegionOfInterest != nullptr)
+  {
+    os << indent << "UndistortRegionOfInterest: " << *this->UndistortRegionOfInterest << std::endl;
+  }
 }
 
 //-----------------------------------------------------------------------------
@@ -86,6 +94,9 @@ PlusStatus vtkPlusOpenCVCaptureVideoSource::ReadConfiguration(vtkXMLDataElement*
     std::copy(std::begin(frameSize), std::end(frameSize), this->FrameSize.begin());
   }
 
+  // The internal update thread may be undistorting a frame, the calibration must not change under it
+  std::lock_guard<std::mutex> undistortLock(this->UndistortMutex);
+
   std::vector<double> camMat;
   camMat.resize(9);
   XML_READ_STD_ARRAY_ATTRIBUTE_NONMEMBER_EXACT_OPTIONAL(double, CameraMatrix, 9, camMat, deviceConfig);
@@ -108,6 +119,24 @@ PlusStatus vtkPlusOpenCVCaptureVideoSource::ReadConfiguration(vtkXMLDataElement*
     }
   }
 
+  // Region of interest is removed if it is not defined in the new configuration
+  this->UndistortRegionOfInterest = nullptr;
+  int roi[4] = { 0, 0, 0, 0 };
+  XML_READ_VECTOR_ATTRIBUTE_NONMEMBER_OPTIONAL(int, 4, UndistortRegionOfInterest, roi, deviceConfig);
+  if (deviceConfig->GetAttribute("UndistortRegionOfInterest") != NULL)
+  {
+    if (roi[0] < 0 || roi[1] < 0 || roi[2] <= 0 || roi[3] <= 0)
+    {
+      LOG_ERROR("Invalid UndistortRegionOfInterest, expected x, y, width, height with non-negative origin and positive size.");
+      return PLUS_FAIL;
+    }
+    this->UndistortRegionOfInterest = std::make_shared<cv::Rect>(roi[0], roi[1], roi[2], roi[3]);
+  }
+
+  // Calibration may have changed, recompute the undistortion maps
+  this->UndistortMap1 = nullptr;
+  this->UndistortMap2 = nullptr;
+
   XML_READ_BOOL_ATTRIBUTE_OPTIONAL(AutofocusEnabled, deviceConfig);
   XML_READ_BOOL_ATTRIBUTE_OPTIONAL(AutoexposureEnabled, deviceConfig);
 
@@ -129,6 +158,7 @@ PlusStatus vtkPlusOpenCVCaptureVideoSource::WriteConfiguration(vtkXMLDataElement
   {
     deviceConfig->SetIntAttribute("DeviceIndex", this->DeviceIndex);
   }
+  std::lock_guard<std::mutex> undistortLock(this->UndistortMutex);
   if (this->CameraMatrix != nullptr)
   {
     deviceConfig->SetVectorAttribute("CameraMatrix", 9, this->CameraMatrix->ptr<double>(0));
@@ -137,6 +167,11 @@ PlusStatus vtkPlusOpenCVCaptureVideoSource::WriteConfiguration(vtkXMLDataElement
   {
     deviceConfig->SetVectorAttribute("DistortionCoefficients", this->DistortionCoefficients->rows, this->DistortionCoefficients->ptr<double>(0));
   }
+  if (this->UndistortRegionOfInterest != nullptr)
+  {
+    int roi[4] = { this->UndistortRegionOfInterest->x, this->UndistortRegionOfInterest->y, this->UndistortRegionOfInterest->width, this->UndistortRegionOfInterest->height };
+    deviceConfig->SetVectorAttribute("UndistortRegionOfInterest", 4, roi);
+  }
 
   XML_WRITE_BOOL_ATTRIBUTE(AutofocusEnabled, deviceConfig);
   XML_WRITE_BOOL_ATTRIBUTE(AutoexposureEnabled, deviceConfig);
@@ -217,13 +252,19 @@ PlusStatus vtkPlusOpenCVCaptureVideoSource::InternalConnect()
 
   this->Frame = std::make_shared<cv::Mat>(this->FrameSize[1], this->FrameSize[0], CV_8UC3);
 
-  if (this->CameraMatrix != nullptr && this->DistortionCoefficients != nullptr)
   {
-    this->UndistortedFrame = std::make_shared<cv::Mat>(this->FrameSize[1], this->FrameSize[0], CV_8UC3);
-  }
-  else
-  {
-    this->UndistortedFrame = this->Frame;
+    std::lock_guard<std::mutex> undistortLock(this->UndistortMutex);
+    if (this->CameraMatrix != nullptr && this->DistortionCoefficients != nullptr)
+    {
+      if (this->UpdateUndistortMaps() != PLUS_SUCCESS)
+      {
+        return PLUS_FAIL;
+      }
+    }
+    else
+    {
+      this->UndistortedFrame = this->Frame;
+    }
   }
 
   if (!this->Capture->isOpened())
@@ -247,7 +288,41 @@ PlusStatus vtkPlusOpenCVCaptureVideoSource::InternalDisconnect()
 {
   this->Capture = nullptr; // automatically closes resources/connections
   this->Frame = nullptr;
+
+  std::lock_guard<std::mutex> undistortLock(this->UndistortMutex);
   this->UndistortedFrame = nullptr;
+  this->UndistortMap1 = nullptr;
+  this->UndistortMap2 = nullptr;
+
+  return PLUS_SUCCESS;
+}
+
+//----------------------------------------------------------------------------
+PlusStatus vtkPlusOpenCVCaptureVideoSource::UpdateUndistortMaps()
+{
+  cv::Rect frameRect(0, 0, this->FrameSize[0], this->FrameSize[1]);
+  cv::Rect roi(frameRect);
+  if (this->UndistortRegionOfInterest != nullptr)
+  {
+    roi = *this->UndistortRegionOfInterest & frameRect;
+    if (roi.area() == 0)
+    {
+      LOG_ERROR("UndistortRegionOfInterest " << *this->UndistortRegionOfInterest << " is outside of the " << frameRect.width << "x" << frameRect.height << " frame.");
+      return PLUS_FAIL;
+    }
+  }
+
+  // Same mapping as cv::undistort (the undistorted image keeps the camera matrix), with the principal point
+  // shifted so that only the region of interest is mapped
+  cv::Mat newCameraMatrix = this->CameraMatrix->clone();
+  newCameraMatrix.at<double>(0, 2) -= roi.x;
+  newCameraMatrix.at<double>(1, 2) -= roi.y;
+
+  this->UndistortMap1 = std::make_shared<cv::Mat>();
+  this->UndistortMap2 = std::make_shared<cv::Mat>();
+  cv::initUndistortRectifyMap(*this->CameraMatrix, *this->DistortionCoefficients, cv::Mat(), newCameraMatrix, roi.size(), CV_16SC2, *this->UndistortMap1, *this->UndistortMap2);
+
+  this->UndistortedFrame = std::make_shared<cv::Mat>(roi.height, roi.width, CV_8UC3);
 
   return PLUS_SUCCESS;
 }
@@ -270,9 +345,16 @@ PlusStatus vtkPlusOpenCVCaptureVideoSource::InternalUpdate()
     return PLUS_FAIL;
   }
 
+  // Kept locked while the undistorted frame is used, the configuration may be changed meanwhile
+  std::lock_guard<std::mutex> undistortLock(this->UndistortMutex);
   if (this->CameraMatrix != nullptr && this->DistortionCoefficients != nullptr)
   {
-    cv::undistort(*this->Frame, *this->UndistortedFrame, *this->CameraMatrix, *this->DistortionCoefficients);
+    if (this->UndistortMap1 == nullptr && this->UpdateUndistortMaps() != PLUS_SUCCESS)
+    {
+      return PLUS_FAIL;
+    }
+    // Writes into the preallocated undistorted frame
+    cv::remap(*this->Frame, *this->UndistortedFrame, *this->UndistortMap1, *this->UndistortMap2, cv::INTER_LINEAR);
   }
 
   // BGR -> RGB color
@@ -13,6 +13,9 @@ See License.txt for details.
 // OpenCV includes
 #include <opencv2/videoio.hpp>
 
+// STL includes
+#include <mutex>
+
 /*!
 \class vtkPlusOpenCVCaptureVideoSource
 \brief Class for interfacing an OpenCVC capture device and recording frames into a Plus buffer
@@ -20,6 +23,11 @@ See License.txt for details.
 Requires the PLUS_USE_OpenCVCapture_VIDEO option in CMake.
 Requires OpenCV with FFMPEG built (for RTSP support)
 
+If CameraMatrix and DistortionCoefficients are defined then the frames are undistorted. The undistortion maps are
+computed once (on connect or when the calibration changes) and applied to each frame by a fixed-point remap.
+If UndistortRegionOfInterest (x, y, width, height in pixels) is defined then only that region is undistorted
+and recorded.
+
 \ingroup PlusLibDataCollection
 */
 
@@ -75,6 +83,12 @@ protected:
   virtual PlusStatus InternalConnect();
   virtual PlusStatus InternalDisconnect();
 
+  /*!
+    Compute the undistortion maps for the current frame size, calibration and region of interest, and allocate the undistorted frame.
+    The caller must hold UndistortMutex.
+  */
+  PlusStatus UpdateUndistortMaps();
+
 protected:
   std::string                       VideoURL;
   int                               DeviceIndex;
@@ -89,6 +103,17 @@ protected:
 
   std::shared_ptr<cv::Mat>          CameraMatrix;
   std::shared_ptr<cv::Mat>          DistortionCoefficients;
+  std::shared_ptr<cv::Rect>         UndistortRegionOfInterest;
+
+  // Cached undistortion maps in fixed-point representation (see cv::convertMaps), nullptr if they need to be recomputed
+  std::shared_ptr<cv::Mat>          UndistortMap1;
+  std::shared_ptr<cv::Mat>          UndistortMap2;
+
+  /*!
+    Protects the calibration, the undistortion maps and the undistorted frame.
+    The configuration may be read again while the internal update thread undistorts frames.
+  */
+  std::mutex                        UndistortMutex;
 };
 
 #endif // __vtkPlusOpenCVCaptureVideoSource_h
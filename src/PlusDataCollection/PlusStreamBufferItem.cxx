@@ -14,6 +14,7 @@
 StreamBufferItem::StreamBufferItem()
   : FilteredTimeStamp( 0 )
   , UnfilteredTimeStamp( 0 )
+  , BufferedSystemTime( 0 )
   , Index( 0 )
   , Uid( 0 )
   , ValidTransformData( false )
@@ -47,6 +48,7 @@ StreamBufferItem& StreamBufferItem::operator=( StreamBufferItem const& dataItem
   this->Frame = dataItem.Frame;
   this->FilteredTimeStamp = dataItem.FilteredTimeStamp;
   this->UnfilteredTimeStamp = dataItem.UnfilteredTimeStamp;
+  this->BufferedSystemTime = dataItem.BufferedSystemTime;
   this->Index = dataItem.Index;
   this->Uid = dataItem.Uid;
   this->FrameFields = dataItem.FrameFields;
@@ -77,6 +79,35 @@ PlusStatus StreamBufferItem::DeepCopy( StreamBufferItem* dataItem )
   return PLUS_SUCCESS;
 }
 
+//----------------------------------------------------------------------------
+PlusStatus StreamBufferItem::ShallowCopy( StreamBufferItem* dataItem )
+{
+  if ( dataItem == NULL )
+  {
+    LOG_ERROR( "Failed to shallow copy data buffer item - buffer item NULL!" );
+    return PLUS_FAIL;
+  }
+
+  // Handle self-assignment
+  if ( this == dataItem )
+  {
+    return PLUS_SUCCESS;
+  }
+
+  this->Frame.ShallowCopy( dataItem->Frame );
+  this->FilteredTimeStamp = dataItem->FilteredTimeStamp;
+  this->UnfilteredTimeStamp = dataItem->UnfilteredTimeStamp;
+  this->BufferedSystemTime = dataItem->BufferedSystemTime;
+  this->Index = dataItem->Index;
+  this->Uid = dataItem->Uid;
+  this->FrameFields = dataItem->FrameFields;
+  this->Status = dataItem->Status;
+  this->Matrix->DeepCopy( dataItem->Matrix );
+  this->ValidTransformData = dataItem->ValidTransformData;
+
+  return PLUS_SUCCESS;
+}
+
 //----------------------------------------------------------------------------
 PlusStatus StreamBufferItem::SetMatrix( vtkMatrix4x4* matrix )
 {
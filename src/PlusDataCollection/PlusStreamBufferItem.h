@@ -74,6 +74,12 @@ public:
   /*! Set unfiltered timestamp */
   void SetUnfilteredTimestamp( double unfilteredTimestamp ) { this->UnfilteredTimeStamp = unfilteredTimestamp; }
 
+  /*! Get system time when the item was added to the buffer, 0 if latency tracing was disabled (see PlusLatencyTracer) */
+  double GetBufferedSystemTime() { return this->BufferedSystemTime; }
+
+  /*! Set system time when the item was added to the buffer */
+  void SetBufferedSystemTime( double bufferedSystemTime ) { this->BufferedSystemTime = bufferedSystemTime; }
+
   /*!
     Set/get index assigned by the data acquisition system (usually a counter)
     If frames are skipped then the counter should be increased by the number of skipped frames, therefore
@@ -133,6 +139,12 @@ public:
   /*! Copy stream buffer item */
   PlusStatus DeepCopy( StreamBufferItem* dataItem );
 
+  /*!
+    Copy stream buffer item without copying the pixel data: the video frame shares the
+    reference counted image of the source item. The image content must not be modified.
+  */
+  PlusStatus ShallowCopy( StreamBufferItem* dataItem );
+
   PlusVideoFrame& GetFrame() { return this->Frame; };
 
   /*! Set tracker matrix */
@@ -156,6 +168,7 @@ public:
 protected:
   double FilteredTimeStamp;
   double UnfilteredTimeStamp;
+  double BufferedSystemTime;
 
   /*! index assigned by the data acquisition system (usually a counter) */
   unsigned long Index;
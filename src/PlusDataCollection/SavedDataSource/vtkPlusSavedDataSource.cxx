@@ -16,8 +16,21 @@ See License.txt for details.
 #include "vtkPlusTrackedFrameList.h"
 #include "vtksys/SystemTools.hxx"
 
+// STL includes
+#include <algorithm>
+#include <chrono>
+
 vtkStandardNewMacro(vtkPlusSavedDataSource);
 
+namespace
+{
+  static const char FRAME_INDEX_FIELD_NAME[] = "SavedDataSourceFrameIndex"; // index of the frame in the file, stored in the local video buffer items
+  static const int DEFAULT_READ_AHEAD_FRAMES = 16;
+  static const int READ_AHEAD_THREAD_WAKEUP_PERIOD_MS = 100; // the read-ahead thread checks for stop requests at least this often
+  static const int READ_AHEAD_TIMEOUT_MS = 5000; // replay fails if a frame cannot be read from the file within this time
+  static const double DROPPED_FRAMES_REPORT_PERIOD_SEC = 5.0; // dropped frames are reported at most this often
+}
+
 //----------------------------------------------------------------------------
 vtkPlusSavedDataSource::vtkPlusSavedDataSource()
   : FrameBufferRowAlignment(1)
@@ -31,6 +44,20 @@ vtkPlusSavedDataSource::vtkPlusSavedDataSource()
   , LastAddedFrameUid(0)
   , LastAddedLoopIndex(0)
   , SimulatedStream(VIDEO_STREAM)
+  , StreamFromFile(false)
+  , ReadAheadFrames(DEFAULT_READ_AHEAD_FRAMES)
+  , StreamedFrames(NULL)
+  , ReadAheadStartUid(0)
+  , ReadAheadThreadActive(false)
+  , ReadAheadThreadRunning(false)
+  , ReadAheadThreadId(-1)
+  , ReplaySpeed(1.0)
+  , ReplayAtMaximumRate(false)
+  , NumberOfReplayedFrames(0)
+  , NumberOfRejectedFrames(0)
+  , OutputItemsOverwrittenBeforeReadAtConnect(0)
+  , LastReportedNumberOfDroppedFrames(0)
+  , LastDropReportTime(0.0)
 {
   // No callback function provided by the device, so the data capture thread will be used to poll the hardware and add new items to the buffer
   this->StartThreadForInternalUpdates = true;
@@ -57,6 +84,7 @@ void vtkPlusSavedDataSource::PrintSelf(ostream& os, vtkIndent indent)
 PlusStatus vtkPlusSavedDataSource::InternalUpdate()
 {
   //LOG_TRACE("vtkPlusSavedDataSource::InternalUpdate");
+  // UpdateMutex is locked during InternalUpdate, so the loop range cannot be changed by SetLoopTimeRange meanwhile
   const int numberOfFramesInTheLoop = this->LoopLastFrameUid - this->LoopFirstFrameUid + 1;
 
   // Determine the UID and loop index of the next frame that will be added
@@ -69,7 +97,11 @@ PlusStatus vtkPlusSavedDataSource::InternalUpdate()
   }
 
   PlusStatus status = PLUS_FAIL;
-  if (this->UseOriginalTimestamps)
+  if (this->ReplayAtMaximumRate)
+  {
+    status = InternalUpdateMaximumRate(frameToBeAddedUid, frameToBeAddedLoopIndex);
+  }
+  else if (this->UseOriginalTimestamps)
   {
     status = InternalUpdateOriginalTimestamp(frameToBeAddedUid, frameToBeAddedLoopIndex);
   }
@@ -78,14 +110,16 @@ PlusStatus vtkPlusSavedDataSource::InternalUpdate()
     status = InternalUpdateCurrentTimestamp(frameToBeAddedUid, frameToBeAddedLoopIndex);
   }
 
+  this->ReportDroppedFrames();
+
   return status;
 }
 
 //----------------------------------------------------------------------------
 PlusStatus vtkPlusSavedDataSource::InternalUpdateOriginalTimestamp(BufferItemUidType frameToBeAddedUid, int frameToBeAddedLoopIndex)
 {
-  // Compute elapsed time since we started the acquisition
-  double elapsedTime = vtkPlusAccurateTimer::GetSystemTime() - this->GetOutputDataSource()->GetStartTime();
+  // Compute elapsed time since we started the acquisition, in the time reference of the recording
+  double elapsedTime = (vtkPlusAccurateTimer::GetSystemTime() - this->GetOutputDataSource()->GetStartTime()) * this->ReplaySpeed;
   double loopTime = this->LoopStopTime_Local - this->LoopStartTime_Local;
 
   const int numberOfFramesInTheLoop = this->LoopLastFrameUid - this->LoopFirstFrameUid + 1;
@@ -155,98 +189,107 @@ PlusStatus vtkPlusSavedDataSource::InternalUpdateOriginalTimestamp(BufferItemUid
     // TODO: use the UID difference as increment
     this->FrameNumber++;
 
-    StreamBufferItem dataBufferItemToBeAdded;
-    if (GetLocalBuffer()->GetStreamBufferItem(frameToBeAddedUid, &dataBufferItemToBeAdded) != ITEM_OK)
+    PlusStatus frameStatus = this->AddReplayedFrame(frameToBeAddedUid, frameToBeAddedLoopIndex, this->ReplaySpeed);
+    this->UpdateReplayStatistics(frameStatus == PLUS_SUCCESS);
+    if (frameStatus != PLUS_SUCCESS)
     {
-      LOG_ERROR("vtkPlusSavedDataSource: Failed to retrieve item from the buffer, UID=" << frameToBeAddedUid);
       status = PLUS_FAIL;
-      continue;
     }
 
-    // Compute the system time corresponding to this frame
-    // Get the filtered timestamp from the buffer without any local time offset. Offset will be applied when it is copied to the output stream's buffer.
-    double filteredTimestamp = dataBufferItemToBeAdded.GetFilteredTimestamp(0.0) + frameToBeAddedLoopIndex * loopTime -
-                               this->LoopStartTime_Local + this->GetOutputDataSource()->GetStartTime();
-    double unfilteredTimestamp = filteredTimestamp; // we ignore unfiltered timestamps
+    this->LastAddedFrameUid = frameToBeAddedUid;
+    this->LastAddedLoopIndex = frameToBeAddedLoopIndex;
+
+    frameToBeAddedUid++;
+    if (frameToBeAddedUid > this->LoopLastFrameUid)
+    {
+      frameToBeAddedLoopIndex++;
+      frameToBeAddedUid -= numberOfFramesInTheLoop;
+    }
+  }
+
+  this->Modified();
+  return status;
+}
+
+//----------------------------------------------------------------------------
+PlusStatus vtkPlusSavedDataSource::AddReplayedFrame(BufferItemUidType frameUid, int loopIndex, double replaySpeed)
+{
+  StreamBufferItem dataBufferItemToBeAdded;
+  if (GetLocalBuffer()->GetStreamBufferItem(frameUid, &dataBufferItemToBeAdded) != ITEM_OK)
+  {
+    LOG_ERROR("vtkPlusSavedDataSource: Failed to retrieve item from the buffer, UID=" << frameUid);
+    return PLUS_FAIL;
+  }
+
+  // Compute the system time corresponding to this frame, the time elapsed in the recording is scaled by the replay speed
+  // Get the filtered timestamp from the buffer without any local time offset. Offset will be applied when it is copied to the output stream's buffer.
+  double loopTime = this->LoopStopTime_Local - this->LoopStartTime_Local;
+  double filteredTimestamp = (dataBufferItemToBeAdded.GetFilteredTimestamp(0.0) + loopIndex * loopTime - this->LoopStartTime_Local) / replaySpeed
+                             + this->GetOutputDataSource()->GetStartTime();
+  double unfilteredTimestamp = filteredTimestamp; // we ignore unfiltered timestamps
 
-    switch (this->SimulatedStream)
+  PlusStatus status = PLUS_SUCCESS;
+  switch (this->SimulatedStream)
+  {
+    case VIDEO_STREAM:
     {
-      case VIDEO_STREAM:
+      if (this->AddLocalVideoItemToVideoSources(frameUid, dataBufferItemToBeAdded, unfilteredTimestamp, filteredTimestamp) != PLUS_SUCCESS)
       {
-        StreamBufferItem::FieldMapType fieldMap;
-        if (this->UseAllFrameFields)
-        {
-          fieldMap = dataBufferItemToBeAdded.GetFrameFieldMap();
-        }
-        if (this->AddVideoItemToVideoSources(this->GetVideoSources(), dataBufferItemToBeAdded.GetFrame(), this->FrameNumber, unfilteredTimestamp, filteredTimestamp, &fieldMap) != PLUS_SUCCESS)
-        {
-          status = PLUS_FAIL;
-        }
-        break;
+        status = PLUS_FAIL;
       }
-      case TRACKER_STREAM:
-      {
-        // retrieve timestamp from the first active tool and add all the tool matrices corresponding to that timestamp
-        double nextFrameTimestamp = dataBufferItemToBeAdded.GetFilteredTimestamp(0.0);
+      break;
+    }
+    case TRACKER_STREAM:
+    {
+      // retrieve timestamp from the first active tool and add all the tool matrices corresponding to that timestamp
+      double nextFrameTimestamp = dataBufferItemToBeAdded.GetFilteredTimestamp(0.0);
 
-        for (DataSourceContainerConstIterator it = this->GetToolIteratorBegin(); it != this->GetToolIteratorEnd(); ++it)
+      for (DataSourceContainerConstIterator it = this->GetToolIteratorBegin(); it != this->GetToolIteratorEnd(); ++it)
+      {
+        vtkPlusDataSource* tool = it->second;
+        StreamBufferItem bufferItem;
+        ItemStatus itemStatus = this->LocalTrackerBuffers[tool->GetId()]->GetStreamBufferItemFromTime(nextFrameTimestamp, &bufferItem, vtkPlusBuffer::INTERPOLATED);
+        if (itemStatus != ITEM_OK)
         {
-          vtkPlusDataSource* tool = it->second;
-          StreamBufferItem bufferItem;
-          ItemStatus itemStatus = this->LocalTrackerBuffers[tool->GetId()]->GetStreamBufferItemFromTime(nextFrameTimestamp, &bufferItem, vtkPlusBuffer::INTERPOLATED);
-          if (itemStatus != ITEM_OK)
+          if (itemStatus == ITEM_NOT_AVAILABLE_YET)
           {
-            if (itemStatus == ITEM_NOT_AVAILABLE_YET)
-            {
-              LOG_ERROR("vtkPlusSavedDataSource: Unable to get next item from local buffer from time for tool " << tool->GetId() << " - frame not available yet!");
-            }
-            else if (itemStatus == ITEM_NOT_AVAILABLE_ANYMORE)
-            {
-              LOG_ERROR("vtkPlusSavedDataSource: Unable to get next item from local buffer from time for tool " << tool->GetId() << " - frame not available anymore!");
-            }
-            else
-            {
-              LOG_ERROR("vtkPlusSavedDataSource: Unable to get next item from local buffer from time for tool " << tool->GetId() << "!");
-            }
-            status = PLUS_FAIL;
-            continue;
+            LOG_ERROR("vtkPlusSavedDataSource: Unable to get next item from local buffer from time for tool " << tool->GetId() << " - frame not available yet!");
           }
-          // Get default transform
-          vtkSmartPointer<vtkMatrix4x4> toolTransMatrix = vtkSmartPointer<vtkMatrix4x4>::New();
-          if (bufferItem.GetMatrix(toolTransMatrix) != PLUS_SUCCESS)
+          else if (itemStatus == ITEM_NOT_AVAILABLE_ANYMORE)
           {
-            LOG_ERROR("Failed to get toolTransMatrix for tool " << tool->GetId());
-            status = PLUS_FAIL;
-            continue;
+            LOG_ERROR("vtkPlusSavedDataSource: Unable to get next item from local buffer from time for tool " << tool->GetId() << " - frame not available anymore!");
           }
-          // Get flags
-          ToolStatus toolStatus = bufferItem.GetStatus();
-          // This device has no frame numbering, just auto increment tool frame number if new frame received
-          // send the transformation matrix and flags to the tool
-          if (this->ToolTimeStampedUpdateWithoutFiltering(tool->GetId(), toolTransMatrix, toolStatus, unfilteredTimestamp, filteredTimestamp) != PLUS_SUCCESS)
+          else
           {
-            status = PLUS_FAIL;
+            LOG_ERROR("vtkPlusSavedDataSource: Unable to get next item from local buffer from time for tool " << tool->GetId() << "!");
           }
+          status = PLUS_FAIL;
+          continue;
+        }
+        // Get default transform
+        vtkSmartPointer<vtkMatrix4x4> toolTransMatrix = vtkSmartPointer<vtkMatrix4x4>::New();
+        if (bufferItem.GetMatrix(toolTransMatrix) != PLUS_SUCCESS)
+        {
+          LOG_ERROR("Failed to get toolTransMatrix for tool " << tool->GetId());
+          status = PLUS_FAIL;
+          continue;
+        }
+        // Get flags
+        ToolStatus toolStatus = bufferItem.GetStatus();
+        // This device has no frame numbering, just auto increment tool frame number if new frame received
+        // send the transformation matrix and flags to the tool
+        if (this->ToolTimeStampedUpdateWithoutFiltering(tool->GetId(), toolTransMatrix, toolStatus, unfilteredTimestamp, filteredTimestamp) != PLUS_SUCCESS)
+        {
+          status = PLUS_FAIL;
         }
       }
-      break;
-      default:
-        LOG_ERROR("Unknown stream type: " << this->SimulatedStream);
-        return PLUS_FAIL;
-    }
-
-    this->LastAddedFrameUid = frameToBeAddedUid;
-    this->LastAddedLoopIndex = frameToBeAddedLoopIndex;
-
-    frameToBeAddedUid++;
-    if (frameToBeAddedUid > this->LoopLastFrameUid)
-    {
-      frameToBeAddedLoopIndex++;
-      frameToBeAddedUid -= numberOfFramesInTheLoop;
     }
+    break;
+    default:
+      LOG_ERROR("Unknown stream type: " << this->SimulatedStream);
+      return PLUS_FAIL;
   }
 
-  this->Modified();
   return status;
 }
 
@@ -274,12 +317,7 @@ PlusStatus vtkPlusSavedDataSource::InternalUpdateCurrentTimestamp(BufferItemUidT
   {
     case VIDEO_STREAM:
     {
-      StreamBufferItem::FieldMapType fieldMap;
-      if (this->UseAllFrameFields)
-      {
-        fieldMap = dataBufferItemToBeAdded.GetFrameFieldMap();
-      }
-      if (this->AddVideoItemToVideoSources(this->GetVideoSources(), dataBufferItemToBeAdded.GetFrame(), this->FrameNumber, UNDEFINED_TIMESTAMP, UNDEFINED_TIMESTAMP, &fieldMap) != PLUS_SUCCESS)
+      if (this->AddLocalVideoItemToVideoSources(frameToBeAddedUid, dataBufferItemToBeAdded, UNDEFINED_TIMESTAMP, UNDEFINED_TIMESTAMP) != PLUS_SUCCESS)
       {
         // UNDEFINED_TIMESTAMP => use current timestamp
         status = PLUS_FAIL;
@@ -342,6 +380,7 @@ PlusStatus vtkPlusSavedDataSource::InternalUpdateCurrentTimestamp(BufferItemUidT
       LOG_ERROR("Unknown stream type: " << this->SimulatedStream);
       return PLUS_FAIL;
   }
+  this->UpdateReplayStatistics(status == PLUS_SUCCESS);
 
   this->LastAddedFrameUid = frameToBeAddedUid;
   this->LastAddedLoopIndex = frameToBeAddedLoopIndex;
@@ -349,6 +388,369 @@ PlusStatus vtkPlusSavedDataSource::InternalUpdateCurrentTimestamp(BufferItemUidT
   return status;
 }
 
+//----------------------------------------------------------------------------
+PlusStatus vtkPlusSavedDataSource::InternalUpdateMaximumRate(BufferItemUidType frameToBeAddedUid, int frameToBeAddedLoopIndex)
+{
+  vtkPlusDataSource* outputDataSource = this->GetOutputDataSource();
+  if (outputDataSource == NULL)
+  {
+    return PLUS_FAIL;
+  }
+
+  // Frames are added back-to-back until the update period is used up or the output buffer is full of frames
+  // that the slowest consumer (reading thread) has not read yet, so that no frame is overwritten before it is read.
+  // If no thread reads the output (e.g., no consumer is connected yet, or the consumers only wait for new items)
+  // then there is nothing to pace the replay, so at most half of the buffer is filled in each update. Otherwise replay
+  // would stop for good when the buffer is full, because waiting consumers would never get a new item to read.
+  const double updateStartTime = vtkPlusAccurateTimer::GetSystemTime();
+  const double updatePeriodSec = (this->AcquisitionRate > 0 ? 1.0 / this->AcquisitionRate : 0.0);
+  const int numberOfFramesInTheLoop = this->LoopLastFrameUid - this->LoopFirstFrameUid + 1;
+  const int maximumNumberOfFramesWithoutReader = std::max(outputDataSource->GetBufferSize() / 2, 1);
+  int numberOfFramesAdded = 0;
+
+  PlusStatus status = PLUS_SUCCESS;
+  while (true)
+  {
+    if (!this->RepeatEnabled && frameToBeAddedLoopIndex > 0)
+    {
+      // there is no repeat and we already played the loop once, so don't add any more frames
+      break;
+    }
+
+    BufferItemUidType slowestReaderLatestItemUid = 0;
+    if (outputDataSource->GetSlowestReaderLatestItemUid(slowestReaderLatestItemUid))
+    {
+      BufferItemUidType latestOutputItemUid = outputDataSource->GetLatestItemUidInBuffer();
+      long numberOfUnreadFrames = (latestOutputItemUid > slowestReaderLatestItemUid ? static_cast<long>(latestOutputItemUid - slowestReaderLatestItemUid) : 0);
+      if (numberOfUnreadFrames >= outputDataSource->GetBufferSize())
+      {
+        // adding a frame would overwrite a frame that has not been read yet
+        break;
+      }
+    }
+    else if (numberOfFramesAdded >= maximumNumberOfFramesWithoutReader)
+    {
+      break;
+    }
+
+    // The timestamps keep the time differences of the recording (not scaled by the replay speed)
+    this->FrameNumber++;
+    PlusStatus frameStatus = this->AddReplayedFrame(frameToBeAddedUid, frameToBeAddedLoopIndex, 1.0);
+    this->UpdateReplayStatistics(frameStatus == PLUS_SUCCESS);
+    if (frameStatus != PLUS_SUCCESS)
+    {
+      status = PLUS_FAIL;
+    }
+
+    this->LastAddedFrameUid = frameToBeAddedUid;
+    this->LastAddedLoopIndex = frameToBeAddedLoopIndex;
+    numberOfFramesAdded++;
+
+    frameToBeAddedUid++;
+    if (frameToBeAddedUid > this->LoopLastFrameUid)
+    {
+      frameToBeAddedLoopIndex++;
+      frameToBeAddedUid -= numberOfFramesInTheLoop;
+    }
+
+    if (vtkPlusAccurateTimer::GetSystemTime() - updateStartTime >= updatePeriodSec)
+    {
+      break;
+    }
+  }
+
+  this->Modified();
+  return status;
+}
+
+//----------------------------------------------------------------------------
+void vtkPlusSavedDataSource::UpdateReplayStatistics(bool frameAccepted)
+{
+  if (frameAccepted)
+  {
+    this->NumberOfReplayedFrames++;
+  }
+  else
+  {
+    this->NumberOfRejectedFrames++;
+  }
+}
+
+//----------------------------------------------------------------------------
+long vtkPlusSavedDataSource::GetNumberOfDroppedFrames()
+{
+  long numberOfDroppedFrames = this->NumberOfRejectedFrames;
+  vtkPlusDataSource* outputDataSource = this->GetOutputDataSource();
+  if (outputDataSource != NULL)
+  {
+    numberOfDroppedFrames += static_cast<long>(outputDataSource->GetNumberOfItemsOverwrittenBeforeRead() - this->OutputItemsOverwrittenBeforeReadAtConnect);
+  }
+  return numberOfDroppedFrames;
+}
+
+//----------------------------------------------------------------------------
+void vtkPlusSavedDataSource::ReportDroppedFrames()
+{
+  double currentTimeSec = vtkPlusAccurateTimer::GetSystemTime();
+  if (currentTimeSec - this->LastDropReportTime <= DROPPED_FRAMES_REPORT_PERIOD_SEC)
+  {
+    return;
+  }
+  long numberOfDroppedFrames = this->GetNumberOfDroppedFrames();
+  if (numberOfDroppedFrames > this->LastReportedNumberOfDroppedFrames)
+  {
+    LOG_WARNING(this->GetDeviceId() << ": " << numberOfDroppedFrames << " of " << this->NumberOfReplayedFrames + this->NumberOfRejectedFrames
+                << " replayed frames have been dropped before the consumers read them. Reduce ReplaySpeed or AcquisitionRate to find the sustainable rate.");
+    this->LastReportedNumberOfDroppedFrames = numberOfDroppedFrames;
+    this->LastDropReportTime = currentTimeSec;
+  }
+}
+
+//----------------------------------------------------------------------------
+PlusStatus vtkPlusSavedDataSource::AddLocalVideoItemToVideoSources(BufferItemUidType itemUid, StreamBufferItem& item, double unfilteredTimestamp, double filteredTimestamp)
+{
+  StreamBufferItem::FieldMapType fieldMap;
+  if (this->UseAllFrameFields)
+  {
+    fieldMap = item.GetFrameFieldMap();
+  }
+
+  if (this->StreamedFrames == NULL)
+  {
+    return this->AddVideoItemToVideoSources(this->GetVideoSources(), item.GetFrame(), this->FrameNumber, unfilteredTimestamp, filteredTimestamp, &fieldMap);
+  }
+
+  // The image is not stored in the local buffer, get it from the read-ahead window
+  fieldMap.erase(FRAME_INDEX_FIELD_NAME);
+  PlusVideoFrame frame;
+  if (this->GetStreamedFrame(itemUid, frame) != PLUS_SUCCESS)
+  {
+    return PLUS_FAIL;
+  }
+  return this->AddVideoItemToVideoSources(this->GetVideoSources(), frame, this->FrameNumber, unfilteredTimestamp, filteredTimestamp, &fieldMap);
+}
+
+//----------------------------------------------------------------------------
+PlusStatus vtkPlusSavedDataSource::GetStreamedFrame(BufferItemUidType itemUid, PlusVideoFrame& frame)
+{
+  std::unique_lock<std::mutex> readAheadLock(this->ReadAheadMutex);
+  if (this->ReadAheadStartUid != itemUid)
+  {
+    // Replay did not continue with the expected frame (e.g., the loop range changed), move the window
+    this->ReadAheadStartUid = itemUid;
+    this->ReadAheadRequested.notify_all();
+  }
+
+  std::map<BufferItemUidType, PlusVideoFrame>::iterator frameIt = this->ReadAheadWindow.find(itemUid);
+  if (frameIt == this->ReadAheadWindow.end())
+  {
+    const bool frameRead = this->ReadAheadFrameRead.wait_for(readAheadLock, std::chrono::milliseconds(READ_AHEAD_TIMEOUT_MS), [this, itemUid]()
+    {
+      return this->ReadAheadWindow.find(itemUid) != this->ReadAheadWindow.end() || !this->ReadAheadThreadRunning;
+    });
+    if (!frameRead)
+    {
+      LOG_ERROR(this->GetDeviceId() << ": Timed out while reading frame from file, UID=" << itemUid);
+      return PLUS_FAIL;
+    }
+    frameIt = this->ReadAheadWindow.find(itemUid);
+    if (frameIt == this->ReadAheadWindow.end())
+    {
+      LOG_ERROR(this->GetDeviceId() << ": Read-ahead thread is not running, frame is not available, UID=" << itemUid);
+      return PLUS_FAIL;
+    }
+  }
+
+  PlusStatus status = PLUS_SUCCESS;
+  if (frameIt->second.IsImageValid())
+  {
+    frame.ShallowCopy(frameIt->second);
+  }
+  else
+  {
+    // The read-ahead thread has already logged the error
+    status = PLUS_FAIL;
+  }
+  this->ReadAheadWindow.erase(frameIt);
+
+  // The window continues with the next frame of the loop
+  this->ReadAheadStartUid = (itemUid < this->LoopLastFrameUid ? itemUid + 1 : this->LoopFirstFrameUid);
+  this->ReadAheadRequested.notify_all();
+  return status;
+}
+
+//----------------------------------------------------------------------------
+PlusStatus vtkPlusSavedDataSource::ReadStreamedFrame(BufferItemUidType itemUid, PlusVideoFrame& frame)
+{
+  StreamBufferItem item;
+  if (this->LocalVideoBuffer->GetStreamBufferItem(itemUid, &item) != ITEM_OK)
+  {
+    LOG_ERROR(this->GetDeviceId() << ": Failed to retrieve item from the local buffer, UID=" << itemUid);
+    return PLUS_FAIL;
+  }
+  int frameIndex = -1;
+  const char* strFrameIndex = item.GetFrameField(FRAME_INDEX_FIELD_NAME);
+  if (strFrameIndex == NULL || PlusCommon::StringToInt(strFrameIndex, frameIndex) != PLUS_SUCCESS
+      || frameIndex < 0 || frameIndex >= static_cast<int>(this->StreamedFrames->GetNumberOfTrackedFrames()))
+  {
+    LOG_ERROR(this->GetDeviceId() << ": Invalid frame index in the local buffer, UID=" << itemUid);
+    return PLUS_FAIL;
+  }
+
+  // The image is read from the file here. The shallow copy is taken while the loader is locked, it keeps the image
+  // alive when the frame list releases it (also if the release happens in another thread).
+  if (this->StreamedFrames->GetTrackedFrame(frameIndex)->ShallowCopyImageDataTo(frame) != PLUS_SUCCESS || !frame.IsImageValid())
+  {
+    LOG_ERROR(this->GetDeviceId() << ": Failed to read frame " << frameIndex << " from file " << this->SequenceFile);
+    return PLUS_FAIL;
+  }
+  return PLUS_SUCCESS;
+}
+
+//----------------------------------------------------------------------------
+bool vtkPlusSavedDataSource::GetNextItemUidToReadAhead(BufferItemUidType& itemUid)
+{
+  if (this->LoopLastFrameUid < this->LoopFirstFrameUid)
+  {
+    return false;
+  }
+  const BufferItemUidType numberOfFramesInTheLoop = this->LoopLastFrameUid - this->LoopFirstFrameUid + 1;
+  const BufferItemUidType windowSize = std::min<BufferItemUidType>(std::max(this->ReadAheadFrames, 1), numberOfFramesInTheLoop);
+  BufferItemUidType startUid = this->ReadAheadStartUid;
+  if (startUid < this->LoopFirstFrameUid || startUid > this->LoopLastFrameUid)
+  {
+    startUid = this->LoopFirstFrameUid;
+  }
+
+  // Remove the frames that are not in the window (already replayed, or skipped)
+  for (std::map<BufferItemUidType, PlusVideoFrame>::iterator frameIt = this->ReadAheadWindow.begin(); frameIt != this->ReadAheadWindow.end();)
+  {
+    const BufferItemUidType uid = frameIt->first;
+    bool inWindow = false;
+    if (uid >= this->LoopFirstFrameUid && uid <= this->LoopLastFrameUid)
+    {
+      // distance from the start of the window in replay order, wrapping around at the end of the loop
+      const BufferItemUidType distance = (uid + numberOfFramesInTheLoop - startUid) % numberOfFramesInTheLoop;
+      inWindow = (distance < windowSize);
+    }
+    if (inWindow)
+    {
+      ++frameIt;
+    }
+    else
+    {
+      this->ReadAheadWindow.erase(frameIt++);
+    }
+  }
+
+  // Find the first frame in replay order that has not been read yet
+  for (BufferItemUidType offset = 0; offset < windowSize; ++offset)
+  {
+    const BufferItemUidType uid = this->LoopFirstFrameUid + (startUid - this->LoopFirstFrameUid + offset) % numberOfFramesInTheLoop;
+    if (this->ReadAheadWindow.find(uid) == this->ReadAheadWindow.end())
+    {
+      itemUid = uid;
+      return true;
+    }
+  }
+  return false;
+}
+
+//----------------------------------------------------------------------------
+PlusStatus vtkPlusSavedDataSource::StartReadAheadThread()
+{
+  if (this->ReadAheadThreadId >= 0)
+  {
+    // already running
+    return PLUS_SUCCESS;
+  }
+
+  this->ReadAheadThreadActive = true;
+  {
+    std::lock_guard<std::mutex> readAheadLock(this->ReadAheadMutex);
+    this->ReadAheadThreadRunning = true;
+  }
+  this->ReadAheadThreadId = this->Threader->SpawnThread((vtkThreadFunctionType)&ReadAheadThread, this);
+  if (this->ReadAheadThreadId < 0)
+  {
+    LOG_ERROR(this->GetDeviceId() << ": Failed to start read-ahead thread");
+    this->ReadAheadThreadActive = false;
+    std::lock_guard<std::mutex> readAheadLock(this->ReadAheadMutex);
+    this->ReadAheadThreadRunning = false;
+    return PLUS_FAIL;
+  }
+
+  return PLUS_SUCCESS;
+}
+
+//----------------------------------------------------------------------------
+void vtkPlusSavedDataSource::StopReadAheadThread()
+{
+  if (this->ReadAheadThreadId < 0)
+  {
+    // not running
+    return;
+  }
+
+  {
+    // The flag is cleared under the lock, so that the thread cannot miss the notification between checking the flag and waiting
+    std::lock_guard<std::mutex> readAheadLock(this->ReadAheadMutex);
+    this->ReadAheadThreadActive = false;
+  }
+  this->ReadAheadRequested.notify_all();
+
+  // Waits until the thread exits
+  this->Threader->TerminateThread(this->ReadAheadThreadId);
+  this->ReadAheadThreadId = -1;
+}
+
+//----------------------------------------------------------------------------
+void* vtkPlusSavedDataSource::ReadAheadThread(vtkMultiThreader::ThreadInfo* data)
+{
+  vtkPlusSavedDataSource* self = (vtkPlusSavedDataSource*)(data->UserData);
+
+  while (self->ReadAheadThreadActive)
+  {
+    BufferItemUidType uidToRead = 0;
+    {
+      std::unique_lock<std::mutex> readAheadLock(self->ReadAheadMutex);
+      if (!self->ReadAheadThreadActive)
+      {
+        break;
+      }
+      if (!self->GetNextItemUidToReadAhead(uidToRead))
+      {
+        // The window is full, wait until replay consumes a frame
+        self->ReadAheadRequested.wait_for(readAheadLock, std::chrono::milliseconds(READ_AHEAD_THREAD_WAKEUP_PERIOD_MS));
+        continue;
+      }
+    }
+
+    // Only this thread accesses the images of the frame list, so the file is read without holding the lock
+    PlusVideoFrame frame;
+    PlusStatus status = self->ReadStreamedFrame(uidToRead, frame);
+
+    {
+      std::lock_guard<std::mutex> readAheadLock(self->ReadAheadMutex);
+      // An invalid frame is stored on failure, so that replay does not wait for it
+      PlusVideoFrame& windowFrame = self->ReadAheadWindow[uidToRead];
+      if (status == PLUS_SUCCESS)
+      {
+        windowFrame.ShallowCopy(frame);
+      }
+    }
+    self->ReadAheadFrameRead.notify_all();
+  }
+
+  {
+    std::lock_guard<std::mutex> readAheadLock(self->ReadAheadMutex);
+    self->ReadAheadThreadRunning = false;
+  }
+  // Release the update thread if it is waiting for a frame
+  self->ReadAheadFrameRead.notify_all();
+  return NULL;
+}
+
 //----------------------------------------------------------------------------
 PlusStatus vtkPlusSavedDataSource::Probe()
 {
@@ -382,7 +784,15 @@ PlusStatus vtkPlusSavedDataSource::InternalConnect()
   vtkSmartPointer<vtkPlusTrackedFrameList> savedDataBuffer = vtkSmartPointer<vtkPlusTrackedFrameList>::New();
 
   // Read sequence file into tracked frame list
-  vtkPlusSequenceIO::Read(foundAbsoluteImagePath, savedDataBuffer);
+  if (this->StreamFromFile)
+  {
+    // Keep only the frame that is being read in memory, the read-ahead window holds the images that will be replayed
+    vtkPlusSequenceIO::ReadLazily(foundAbsoluteImagePath, savedDataBuffer, 1);
+  }
+  else
+  {
+    vtkPlusSequenceIO::Read(foundAbsoluteImagePath, savedDataBuffer);
+  }
 
   if (savedDataBuffer->GetNumberOfTrackedFrames() < 1)
   {
@@ -453,6 +863,26 @@ PlusStatus vtkPlusSavedDataSource::InternalConnect()
   this->LastAddedFrameUid = this->LoopFirstFrameUid - 1;
   this->LastAddedLoopIndex = 0;
 
+  this->NumberOfReplayedFrames = 0;
+  this->NumberOfRejectedFrames = 0;
+  this->LastReportedNumberOfDroppedFrames = 0;
+  vtkPlusDataSource* outputDataSource = this->GetOutputDataSource();
+  if (outputDataSource != NULL)
+  {
+    // Needed for pacing maximum rate replay and for counting the frames that the consumers missed
+    outputDataSource->SetReaderTrackingEnabled(true);
+  }
+  this->OutputItemsOverwrittenBeforeReadAtConnect = (outputDataSource != NULL ? outputDataSource->GetNumberOfItemsOverwrittenBeforeRead() : 0);
+
+  if (this->StreamedFrames != NULL)
+  {
+    this->ReadAheadStartUid = this->LoopFirstFrameUid;
+    if (this->StartReadAheadThread() != PLUS_SUCCESS)
+    {
+      return PLUS_FAIL;
+    }
+  }
+
   return PLUS_SUCCESS;
 }
 
@@ -471,30 +901,46 @@ PlusStatus vtkPlusSavedDataSource::InternalConnectVideo(vtkPlusTrackedFrameList*
     return PLUS_FAIL;
   }
 
-  // Saved data buffer contains data read directly from file, set up a new local buffer
-  DeleteLocalBuffers();
-  this->LocalVideoBuffer = vtkPlusBuffer::New();
-  this->LocalVideoBuffer->SetImageOrientation(savedDataBuffer->GetImageOrientation());
-  this->LocalVideoBuffer->SetImageType(savedDataBuffer->GetImageType());
+  // Image properties are taken from the first frame
   FrameSizeType frameSize;
   if (savedDataBuffer->GetFrameSize(frameSize) != PLUS_SUCCESS)
   {
     LOG_ERROR("Unable to retrieve frame size.");
     return PLUS_FAIL;
   }
-  this->LocalVideoBuffer->SetFrameSize(frameSize);
   unsigned int numberOfScalarComponents;
   if (savedDataBuffer->GetTrackedFrame(0)->GetNumberOfScalarComponents(numberOfScalarComponents) != PLUS_SUCCESS)
   {
     LOG_ERROR("Unable to retrieve number of scalar components.");
     return PLUS_FAIL;
   }
-  this->LocalVideoBuffer->SetNumberOfScalarComponents(numberOfScalarComponents);
-  this->LocalVideoBuffer->SetPixelType(savedDataBuffer->GetTrackedFrame(0)->GetImageData()->GetVTKScalarPixelType());
-  this->LocalVideoBuffer->SetBufferSize(savedDataBuffer->GetNumberOfTrackedFrames());
+  PlusCommon::VTKScalarPixelType pixelType = savedDataBuffer->GetTrackedFrame(0)->GetImageData()->GetVTKScalarPixelType();
+
+  // Saved data buffer contains data read directly from file, set up a new local buffer
+  DeleteLocalBuffers();
+  this->LocalVideoBuffer = vtkPlusBuffer::New();
+  this->LocalVideoBuffer->SetImageOrientation(savedDataBuffer->GetImageOrientation());
+  this->LocalVideoBuffer->SetImageType(savedDataBuffer->GetImageType());
   this->LocalVideoBuffer->SetLocalTimeOffsetSec(0.0);   // the time offset is copied from the output, so reset it to 0
-  this->LocalVideoBuffer->CopyImagesFromTrackedFrameList(savedDataBuffer, vtkPlusBuffer::READ_FILTERED_IGNORE_UNFILTERED_TIMESTAMPS, this->UseAllFrameFields);
-  savedDataBuffer->Clear();
+  if (this->StreamFromFile)
+  {
+    // The local buffer has no images, they are read from the file during replay
+    if (this->AddStreamedFramesToLocalVideoBuffer(savedDataBuffer) != PLUS_SUCCESS)
+    {
+      return PLUS_FAIL;
+    }
+    savedDataBuffer->Register(this);
+    this->StreamedFrames = savedDataBuffer;
+  }
+  else
+  {
+    this->LocalVideoBuffer->SetFrameSize(frameSize);
+    this->LocalVideoBuffer->SetNumberOfScalarComponents(numberOfScalarComponents);
+    this->LocalVideoBuffer->SetPixelType(pixelType);
+    this->LocalVideoBuffer->SetBufferSize(savedDataBuffer->GetNumberOfTrackedFrames());
+    this->LocalVideoBuffer->CopyImagesFromTrackedFrameList(savedDataBuffer, vtkPlusBuffer::READ_FILTERED_IGNORE_UNFILTERED_TIMESTAMPS, this->UseAllFrameFields);
+    savedDataBuffer->Clear();
+  }
 
   PlusStatus result(PLUS_SUCCESS);
   for (DataSourceContainerIterator it = this->VideoSources.begin(); it != this->VideoSources.end(); ++it)
@@ -508,14 +954,14 @@ PlusStatus vtkPlusSavedDataSource::InternalConnectVideo(vtkPlusTrackedFrameList*
       continue;
     }
 
-    if (source->SetInputFrameSize(this->LocalVideoBuffer->GetFrameSize()) != PLUS_SUCCESS)
+    if (source->SetInputFrameSize(frameSize) != PLUS_SUCCESS)
     {
       LOG_ERROR(source->GetId() << ": Failed to set video image orientation");
       result = PLUS_FAIL;
       continue;
     }
 
-    if (source->SetNumberOfScalarComponents(this->LocalVideoBuffer->GetNumberOfScalarComponents()) != PLUS_SUCCESS)
+    if (source->SetNumberOfScalarComponents(numberOfScalarComponents) != PLUS_SUCCESS)
     {
       LOG_ERROR(source->GetId() << ": Failed to set video image orientation");
       result = PLUS_FAIL;
@@ -524,14 +970,14 @@ PlusStatus vtkPlusSavedDataSource::InternalConnectVideo(vtkPlusTrackedFrameList*
 
     source->Clear();
 
-    if (source->SetInputFrameSize(this->LocalVideoBuffer->GetFrameSize()) != PLUS_SUCCESS)
+    if (source->SetInputFrameSize(frameSize) != PLUS_SUCCESS)
     {
       LOG_ERROR(source->GetId() << ": Failed to set video image orientation");
       result = PLUS_FAIL;
       continue;
     }
 
-    if (source->SetPixelType(this->LocalVideoBuffer->GetPixelType()) != PLUS_SUCCESS)
+    if (source->SetPixelType(pixelType) != PLUS_SUCCESS)
     {
       LOG_ERROR(source->GetId() << ": Failed to set video image orientation");
       result = PLUS_FAIL;
@@ -542,6 +988,58 @@ PlusStatus vtkPlusSavedDataSource::InternalConnectVideo(vtkPlusTrackedFrameList*
   return result;
 }
 
+//----------------------------------------------------------------------------
+PlusStatus vtkPlusSavedDataSource::AddStreamedFramesToLocalVideoBuffer(vtkPlusTrackedFrameList* savedDataBuffer)
+{
+  const int numberOfFrames = savedDataBuffer->GetNumberOfTrackedFrames();
+  if (this->LocalVideoBuffer->SetBufferSize(numberOfFrames) != PLUS_SUCCESS)
+  {
+    LOG_ERROR("Failed to set local video buffer size!");
+    return PLUS_FAIL;
+  }
+
+  int numberOfErrors = 0;
+  for (int frameIndex = 0; frameIndex < numberOfFrames; frameIndex++)
+  {
+    PlusTrackedFrame* trackedFrame = savedDataBuffer->GetTrackedFrame(frameIndex);
+
+    double timestamp(0);
+    const char* strTimestamp = trackedFrame->GetFrameField("Timestamp");
+    if (strTimestamp == NULL || PlusCommon::StringToDouble(strTimestamp, timestamp) != PLUS_SUCCESS)
+    {
+      LOG_ERROR("Unable to read Timestamp field of frame #" << frameIndex);
+      numberOfErrors++;
+      continue;
+    }
+
+    PlusTrackedFrame::FieldMapType fields;
+    if (this->UseAllFrameFields)
+    {
+      PlusTrackedFrame::FieldMapType sourceCustomFields = trackedFrame->GetCustomFields();
+      for (PlusTrackedFrame::FieldMapType::iterator fieldIterator = sourceCustomFields.begin(); fieldIterator != sourceCustomFields.end(); ++fieldIterator)
+      {
+        // skip special fields
+        if (PlusCommon::IsEqualInsensitive(fieldIterator->first, "TimeStamp")
+            || PlusCommon::IsEqualInsensitive(fieldIterator->first, "UnfilteredTimestamp")
+            || PlusCommon::IsEqualInsensitive(fieldIterator->first, "FrameNumber"))
+        {
+          continue;
+        }
+        fields[fieldIterator->first] = fieldIterator->second;
+      }
+    }
+    // The frame index is always stored, so that the image can be found in the file (and the item is not empty)
+    fields[FRAME_INDEX_FIELD_NAME] = PlusCommon::ToString(frameIndex);
+
+    if (this->LocalVideoBuffer->AddItem(fields, frameIndex, timestamp, timestamp) != PLUS_SUCCESS)
+    {
+      LOG_WARNING("Failed to add frame #" << frameIndex << " to the local video buffer");
+    }
+  }
+
+  return (numberOfErrors > 0 ? PLUS_FAIL : PLUS_SUCCESS);
+}
+
 //----------------------------------------------------------------------------
 PlusStatus vtkPlusSavedDataSource::InternalConnectTracker(vtkPlusTrackedFrameList* savedDataBuffer)
 {
@@ -607,6 +1105,11 @@ PlusStatus vtkPlusSavedDataSource::InternalConnectTracker(vtkPlusTrackedFrameLis
 //----------------------------------------------------------------------------
 PlusStatus vtkPlusSavedDataSource::InternalDisconnect()
 {
+  vtkPlusDataSource* outputDataSource = this->GetOutputDataSource();
+  if (outputDataSource != NULL)
+  {
+    outputDataSource->SetReaderTrackingEnabled(false);
+  }
   DeleteLocalBuffers();
   return PLUS_SUCCESS;
 }
@@ -664,6 +1167,31 @@ PlusStatus vtkPlusSavedDataSource::ReadConfiguration(vtkXMLDataElement* rootConf
 
   XML_READ_BOOL_ATTRIBUTE_OPTIONAL(RepeatEnabled, deviceConfig);
   XML_READ_BOOL_ATTRIBUTE_OPTIONAL(UseOriginalTimestamps, deviceConfig);
+  XML_READ_BOOL_ATTRIBUTE_OPTIONAL(StreamFromFile, deviceConfig);
+  XML_READ_SCALAR_ATTRIBUTE_OPTIONAL(int, ReadAheadFrames, deviceConfig);
+  if (this->ReadAheadFrames < 1)
+  {
+    LOG_WARNING("ReadAheadFrames must be positive, using default value: " << DEFAULT_READ_AHEAD_FRAMES);
+    this->ReadAheadFrames = DEFAULT_READ_AHEAD_FRAMES;
+  }
+  XML_READ_SCALAR_ATTRIBUTE_OPTIONAL(double, ReplaySpeed, deviceConfig);
+  if (this->ReplaySpeed <= 0)
+  {
+    LOG_WARNING("ReplaySpeed must be positive, using original speed (1.0)");
+    this->ReplaySpeed = 1.0;
+  }
+  XML_READ_BOOL_ATTRIBUTE_OPTIONAL(ReplayAtMaximumRate, deviceConfig);
+  if (this->ReplaySpeed != 1.0)
+  {
+    if (this->ReplayAtMaximumRate)
+    {
+      LOG_WARNING("ReplaySpeed is ignored because ReplayAtMaximumRate is enabled");
+    }
+    else if (!this->UseOriginalTimestamps)
+    {
+      LOG_WARNING("ReplaySpeed is ignored because UseOriginalTimestamps is disabled");
+    }
+  }
 
   const char* useData = deviceConfig->GetAttribute("UseData");
   if (useData != NULL)
@@ -701,6 +1229,16 @@ PlusStatus vtkPlusSavedDataSource::WriteConfiguration(vtkXMLDataElement* rootCon
   XML_WRITE_CSTRING_ATTRIBUTE_IF_NOT_NULL(SequenceFile, imageAcquisitionConfig);
   XML_WRITE_BOOL_ATTRIBUTE(RepeatEnabled, imageAcquisitionConfig);
   XML_WRITE_BOOL_ATTRIBUTE(UseOriginalTimestamps, imageAcquisitionConfig);
+  XML_WRITE_BOOL_ATTRIBUTE(StreamFromFile, imageAcquisitionConfig);
+  if (this->StreamFromFile)
+  {
+    imageAcquisitionConfig->SetIntAttribute("ReadAheadFrames", this->ReadAheadFrames);
+  }
+  if (this->ReplaySpeed != 1.0)
+  {
+    imageAcquisitionConfig->SetDoubleAttribute("ReplaySpeed", this->ReplaySpeed);
+  }
+  XML_WRITE_BOOL_ATTRIBUTE(ReplayAtMaximumRate, imageAcquisitionConfig);
 
   if (this->UseAllFrameFields)
   {
@@ -755,6 +1293,7 @@ PlusStatus vtkPlusSavedDataSource::NotifyConfigured()
 //-----------------------------------------------------------------------------
 void vtkPlusSavedDataSource::GetLoopTimeRange(double& loopStartTime, double& loopStopTime)
 {
+  PlusLockGuard<vtkPlusRecursiveCriticalSection> updateMutexGuardedLock(this->UpdateMutex);
   loopStartTime = this->LoopStartTime_Local;
   loopStopTime = this->LoopStopTime_Local;
 }
@@ -762,11 +1301,22 @@ void vtkPlusSavedDataSource::GetLoopTimeRange(double& loopStartTime, double& loo
 //-----------------------------------------------------------------------------
 void vtkPlusSavedDataSource::SetLoopTimeRange(double loopStartTime, double loopStopTime)
 {
+  // Pause the data capture thread, InternalUpdate reads the loop range and the last added frame without further locking
+  PlusLockGuard<vtkPlusRecursiveCriticalSection> updateMutexGuardedLock(this->UpdateMutex);
+
   this->LoopStartTime_Local = loopStartTime;
   this->LoopStopTime_Local = loopStopTime;
 
-  this->LoopFirstFrameUid = GetClosestFrameUidWithinTimeRange(this->LoopStartTime_Local, this->LoopStartTime_Local, this->LoopStopTime_Local);
-  this->LoopLastFrameUid = GetClosestFrameUidWithinTimeRange(this->LoopStopTime_Local, this->LoopStartTime_Local, this->LoopStopTime_Local);
+  BufferItemUidType loopFirstFrameUid = GetClosestFrameUidWithinTimeRange(this->LoopStartTime_Local, this->LoopStartTime_Local, this->LoopStopTime_Local);
+  BufferItemUidType loopLastFrameUid = GetClosestFrameUidWithinTimeRange(this->LoopStopTime_Local, this->LoopStartTime_Local, this->LoopStopTime_Local);
+  {
+    // the read-ahead thread follows the loop range
+    std::lock_guard<std::mutex> readAheadLock(this->ReadAheadMutex);
+    this->LoopFirstFrameUid = loopFirstFrameUid;
+    this->LoopLastFrameUid = loopLastFrameUid;
+    this->ReadAheadStartUid = loopFirstFrameUid;
+  }
+  this->ReadAheadRequested.notify_all();
 
   this->LastAddedFrameUid = this->LoopFirstFrameUid - 1;
   this->LastAddedLoopIndex = 0;
@@ -839,6 +1389,15 @@ vtkPlusBuffer* vtkPlusSavedDataSource::GetLocalTrackerBuffer()
 //----------------------------------------------------------------------------
 void vtkPlusSavedDataSource::DeleteLocalBuffers()
 {
+  // The read-ahead thread uses the local video buffer and the streamed frames
+  StopReadAheadThread();
+  this->ReadAheadWindow.clear();
+  if (this->StreamedFrames != NULL)
+  {
+    this->StreamedFrames->UnRegister(this);
+    this->StreamedFrames = NULL;
+  }
+
   if (this->LocalVideoBuffer != NULL)
   {
     this->LocalVideoBuffer->Delete();
@@ -11,6 +11,12 @@ See License.txt for details.
 
 #include "vtkPlusDevice.h"
 
+// STL includes
+#include <atomic>
+#include <condition_variable>
+#include <map>
+#include <mutex>
+
 class vtkPlusBuffer;
 
 class vtkPlusDataCollectionExport vtkPlusSavedDataSource;
@@ -27,6 +33,24 @@ Attributes:
 \li UseOriginalTimestamps: if true then the original timestamps (recorded originally in the source file)
   will be replayed exactly, otherwise only the timestamp difference will be replayed exactly,
   starting from the current time (TRUE|FALSE)
+\li StreamFromFile: if true then only the timestamps and fields are read on connect and the images are read from the file
+  during replay, a few frames ahead, so that connect is fast and memory usage does not grow with the length of the
+  recording. Requires an uncompressed MetaImage or NRRD file, other files are read entirely. Connect time is still
+  linear in the number of frames, because the timestamps and fields of every frame are read on connect, only reading
+  of the pixel data is deferred (TRUE|FALSE, default: FALSE)
+\li ReadAheadFrames: number of frames read from the file ahead of replay if StreamFromFile is enabled (default: 16)
+\li ReplaySpeed: replay speed relative to the recording, for example 10 replays ten times faster than recorded.
+  The output timestamps are scaled accordingly. Only used if UseOriginalTimestamps is enabled and ReplayAtMaximumRate
+  is disabled, it is ignored (with a warning) otherwise (default: 1.0)
+\li ReplayAtMaximumRate: if true then the frames are replayed back-to-back, as fast as the consumers read them.
+  The output timestamps keep the time differences of the recording. A frame is added only if it does not overwrite
+  a frame that the slowest thread reading the output buffer has not read yet, so replay pauses while the output
+  buffer is full of unread frames. A thread that has not read any frame for 2 seconds is not considered a reader anymore.
+  If there is no reader then at most half of the output buffer is filled per update (TRUE|FALSE, default: FALSE)
+
+The number of dropped frames (see GetNumberOfDroppedFrames) includes the frames that were overwritten in the output
+buffer before the slowest reading thread read them. It is reported periodically with a warning. The reads are only
+tracked on the output buffer of this device (see vtkPlusTimestampedCircularBuffer::SetReaderTrackingEnabled).
 
 */
 class vtkPlusDataCollectionExport vtkPlusSavedDataSource : public vtkPlusDevice
@@ -46,7 +70,10 @@ public:
   /*! Get SequenceMetafile name with path with tracking buffer data  */
   vtkGetStringMacro( SequenceFile );
 
-  /*! Set the time range of the loaded buffer that will be replayed */
+  /*!
+    Set the time range of the loaded buffer that will be replayed.
+    May be called during acquisition, the data capture thread is paused while the range is changed.
+  */
   void SetLoopTimeRange( double loopStartTime, double loopStopTime );
 
   /*! Get the time range of the loaded buffer that will be replayed. It is initialized to the full range of the loaded data set on Connect(). */
@@ -73,6 +100,39 @@ public:
   /*! Read the timestamps from the file and use provide them in the output (instead of the current time) */
   vtkBooleanMacro( UseOriginalTimestamps, bool );
 
+  /*! Read the images from the file during replay instead of reading the whole file on connect */
+  vtkGetMacro( StreamFromFile, bool );
+  /*! Read the images from the file during replay instead of reading the whole file on connect */
+  vtkSetMacro( StreamFromFile, bool );
+  /*! Read the images from the file during replay instead of reading the whole file on connect */
+  vtkBooleanMacro( StreamFromFile, bool );
+
+  /*! Number of frames read from the file ahead of replay if StreamFromFile is enabled */
+  vtkGetMacro( ReadAheadFrames, int );
+  /*! Number of frames read from the file ahead of replay if StreamFromFile is enabled */
+  vtkSetMacro( ReadAheadFrames, int );
+
+  /*! Replay speed relative to the recording, ignored unless the original timestamps are used */
+  vtkGetMacro( ReplaySpeed, double );
+  /*! Replay speed relative to the recording, ignored unless the original timestamps are used */
+  vtkSetMacro( ReplaySpeed, double );
+
+  /*! Replay the frames back-to-back, as fast as the consumers read them */
+  vtkGetMacro( ReplayAtMaximumRate, bool );
+  /*! Replay the frames back-to-back, as fast as the consumers read them */
+  vtkSetMacro( ReplayAtMaximumRate, bool );
+  /*! Replay the frames back-to-back, as fast as the consumers read them */
+  vtkBooleanMacro( ReplayAtMaximumRate, bool );
+
+  /*! Number of frames added to the output since connect */
+  long GetNumberOfReplayedFrames() const { return this->NumberOfReplayedFrames; }
+
+  /*!
+    Number of frames since connect that did not reach the consumers: frames that were not accepted by the output buffer
+    and frames that were overwritten in the output buffer before the slowest reading thread read them
+  */
+  long GetNumberOfDroppedFrames();
+
   /*! Get local video buffer */
   vtkGetObjectMacro( LocalVideoBuffer, vtkPlusBuffer );
 
@@ -98,6 +158,12 @@ protected:
   /*! Connect to device, in case the output is a video stream */
   virtual PlusStatus InternalConnectVideo( vtkPlusTrackedFrameList* savedDataBuffer );
 
+  /*!
+    Add the timestamps and fields of the frames to the local video buffer, without the images.
+    The frame index in the file is stored in each item, the images are read by the read-ahead thread during replay.
+  */
+  PlusStatus AddStreamedFramesToLocalVideoBuffer( vtkPlusTrackedFrameList* savedDataBuffer );
+
   /*! Connect to device, in case the output is a tracker stream */
   virtual PlusStatus InternalConnectTracker( vtkPlusTrackedFrameList* savedDataBuffer );
 
@@ -113,6 +179,39 @@ protected:
   /*! Internal update, called when the original timestamps are used */
   PlusStatus InternalUpdateOriginalTimestamp( BufferItemUidType frameToBeAddedUid, int frameToBeAddedLoopIndex );
 
+  /*! Internal update, called when the frames are replayed at maximum rate */
+  PlusStatus InternalUpdateMaximumRate( BufferItemUidType frameToBeAddedUid, int frameToBeAddedLoopIndex );
+
+  /*! Add a local buffer item to the output, with the original timestamp (relative to the start of the loop) divided by the replay speed */
+  PlusStatus AddReplayedFrame( BufferItemUidType frameUid, int loopIndex, double replaySpeed );
+
+  /*! Count the replayed frames and the frames that were not accepted by the output buffer */
+  void UpdateReplayStatistics( bool frameAccepted );
+
+  /*! Report periodically if frames have been dropped since the last report */
+  void ReportDroppedFrames();
+
+  /*! Add the image and fields of a local video buffer item to the video sources */
+  PlusStatus AddLocalVideoItemToVideoSources( BufferItemUidType itemUid, StreamBufferItem& item, double unfilteredTimestamp, double filteredTimestamp );
+
+  /*! Get the image of a local video buffer item that is read by the read-ahead thread, waits until it is available */
+  PlusStatus GetStreamedFrame( BufferItemUidType itemUid, PlusVideoFrame& frame );
+
+  /*! Read the image of a local video buffer item from the file. Called only from the read-ahead thread. */
+  PlusStatus ReadStreamedFrame( BufferItemUidType itemUid, PlusVideoFrame& frame );
+
+  /*!
+    Remove the frames from the read-ahead window that will not be replayed soon and get the next item that should be read.
+    Returns false if the window is full. ReadAheadMutex must be locked.
+  */
+  bool GetNextItemUidToReadAhead( BufferItemUidType& itemUid );
+
+  PlusStatus StartReadAheadThread();
+  void StopReadAheadThread();
+
+  /*! Thread that reads the images from the file ahead of replay */
+  static void* ReadAheadThread( vtkMultiThreader::ThreadInfo* data );
+
   BufferItemUidType GetClosestFrameUidWithinTimeRange( double time_Local, double startTime_Local, double stopTime_Local );
 
   /*! Get local tracker buffer */
@@ -167,10 +266,14 @@ protected:
   /*! Index of the loop when the last frame was added. Used for making sure we add each frame only once in one loop period. */
   int LastAddedLoopIndex;
 
-  /*! Frames before this item (identified by the buffer item UID) in the local buffer are ignored, not replayed */
+  /*!
+    Frames before this item (identified by the buffer item UID) in the local buffer are ignored, not replayed.
+    Changed only while both UpdateMutex and ReadAheadMutex are locked, so that the data capture thread
+    (which holds UpdateMutex during InternalUpdate) and the read-ahead thread see a consistent loop range.
+  */
   BufferItemUidType LoopFirstFrameUid;
 
-  /*! Frames after this item (identified by the buffer item UID) in the local buffer are ignored, not replayed */
+  /*! Frames after this item (identified by the buffer item UID) in the local buffer are ignored, not replayed. \sa LoopFirstFrameUid */
   BufferItemUidType LoopLastFrameUid;
 
   enum SimulatedStreamType
@@ -181,6 +284,51 @@ protected:
 
   SimulatedStreamType SimulatedStream;
 
+  /*! Read the images from the file during replay instead of reading the whole file on connect */
+  bool StreamFromFile;
+
+  /*! Number of frames read from the file ahead of replay */
+  int ReadAheadFrames;
+
+  /*! Frames of the file if StreamFromFile is enabled. The image of a frame is read from the file when it is accessed. */
+  vtkPlusTrackedFrameList* StreamedFrames;
+
+  /*! Images that have been read ahead of replay, indexed by the local video buffer item UID */
+  std::map<BufferItemUidType, PlusVideoFrame> ReadAheadWindow;
+
+  /*! Local video buffer item UID of the next frame to be replayed, the read-ahead window starts at this item */
+  BufferItemUidType ReadAheadStartUid;
+
+  /*! Protects the read-ahead window, its start, the running flag of the read-ahead thread, and the loop range while the read-ahead thread is running */
+  std::mutex ReadAheadMutex;
+
+  /*! Signaled when the read-ahead window is moved or a frame is removed from it */
+  std::condition_variable ReadAheadRequested;
+
+  /*! Signaled when a frame is added to the read-ahead window */
+  std::condition_variable ReadAheadFrameRead;
+
+  /*! Requests the read-ahead thread to keep running, checked by the thread in every iteration */
+  std::atomic<bool> ReadAheadThreadActive;
+
+  /*! True until the read-ahead thread exits, protected by ReadAheadMutex */
+  bool ReadAheadThreadRunning;
+  int ReadAheadThreadId;
+
+  /*! Replay speed relative to the recording, used if the original timestamps are used */
+  double ReplaySpeed;
+
+  /*! Replay the frames back-to-back, as fast as the output buffers accept them */
+  bool ReplayAtMaximumRate;
+
+  /*! Replay statistics, updated on the data capture thread and may be read from any thread */
+  std::atomic<long> NumberOfReplayedFrames;
+  std::atomic<long> NumberOfRejectedFrames;
+  /*! Number of frames overwritten in the output buffer before they were read, at connect */
+  unsigned long OutputItemsOverwrittenBeforeReadAtConnect;
+  long LastReportedNumberOfDroppedFrames;
+  double LastDropReportTime;
+
 private:
   static vtkPlusSavedDataSource* Instance;
   vtkPlusSavedDataSource( const vtkPlusSavedDataSource& ); // Not implemented.
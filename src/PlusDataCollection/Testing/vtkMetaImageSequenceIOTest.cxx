@@ -6,17 +6,274 @@ See License.txt for details.
 
 #include "PlusConfigure.h"
 #include "vtksys/CommandLineArguments.hxx"
+#include "vtksys/SystemTools.hxx"
 #include <iomanip>
 
 #include "vtkSmartPointer.h"
+#include "vtkImageData.h"
 #include "vtkMatrix4x4.h"
 
 #include "vtkPlusMetaImageSequenceIO.h"
+#include "vtkPlusLazyFrameLoader.h"
 #include "itkImage.h"
 
 #include "vtkPlusTrackedFrameList.h"
 #include "PlusTrackedFrame.h"
 
+#include <atomic>
+#include <fstream>
+#include <sstream>
+#include <thread>
+
+
+///////////////////////////////////////////////////////////////////
+
+// Returns true if the images are both invalid or they are both valid and have the same pixels
+bool IsImageDataEqual(PlusVideoFrame* expectedImage, PlusVideoFrame* actualImage)
+{
+  if (expectedImage->IsImageValid() != actualImage->IsImageValid())
+  {
+    return false;
+  }
+  if (!expectedImage->IsImageValid())
+  {
+    return true;
+  }
+  return expectedImage->GetFrameSizeInBytes() == actualImage->GetFrameSizeInBytes()
+         && memcmp(expectedImage->GetScalarPointer(), actualImage->GetScalarPointer(), expectedImage->GetFrameSizeInBytes()) == 0;
+}
+
+// Returns the number of frames with different image data (valid images are compared pixel by pixel)
+int CompareImageData(vtkPlusTrackedFrameList* expectedFrames, int expectedFirstFrameNumber, vtkPlusTrackedFrameList* actualFrames)
+{
+  int numberOfDifferences = 0;
+  for (unsigned int i = 0; i < actualFrames->GetNumberOfTrackedFrames(); i++)
+  {
+    PlusVideoFrame* expectedImage = expectedFrames->GetTrackedFrame(expectedFirstFrameNumber + i)->GetImageData();
+    PlusVideoFrame* actualImage = actualFrames->GetTrackedFrame(i)->GetImageData();
+    if (!IsImageDataEqual(expectedImage, actualImage))
+    {
+      LOG_ERROR("Image data mismatch at frame #" << expectedFirstFrameNumber + i);
+      numberOfDifferences++;
+    }
+  }
+  return numberOfDifferences;
+}
+
+// Copies lazily loaded frames while other frames of the same loader are loaded, so the source frames are released in between.
+// Returns the number of copies with wrong image data.
+int TestLazyFrameCopy(vtkPlusTrackedFrameList* expectedFrames, vtkPlusTrackedFrameList* lazyFrames)
+{
+  int numberOfDifferences = 0;
+  int numberOfFrames = static_cast<int>(lazyFrames->GetNumberOfTrackedFrames());
+  for (int i = 0; i < numberOfFrames; i++)
+  {
+    PlusVideoFrame* expectedImage = expectedFrames->GetTrackedFrame(i)->GetImageData();
+    PlusTrackedFrame* sourceFrame = lazyFrames->GetTrackedFrame(i);
+
+    // Copy of a frame that is not in memory, it is loaded (and the source frame is released) on first access
+    PlusTrackedFrame copiedFrame(*sourceFrame);
+    if (!IsImageDataEqual(expectedImage, copiedFrame.GetImageData()))
+    {
+      LOG_ERROR("Image data mismatch in the copy of lazily loaded frame #" << i);
+      numberOfDifferences++;
+    }
+
+    // Assign the same frame again: the copy is already loaded from the same loader and frame index,
+    // while the source frame was released. The copy must be loaded again at the next access.
+    copiedFrame = *sourceFrame;
+    if (!IsImageDataEqual(expectedImage, copiedFrame.GetImageData()))
+    {
+      LOG_ERROR("Image data mismatch after assigning lazily loaded frame #" << i << " to its own copy");
+      numberOfDifferences++;
+    }
+
+    // Assign another frame of the same loader after it was loaded and released
+    int otherFrameIndex = (i + 1) % numberOfFrames;
+    lazyFrames->GetTrackedFrame(otherFrameIndex)->GetImageData();
+    sourceFrame->GetImageData();
+    copiedFrame = *lazyFrames->GetTrackedFrame(otherFrameIndex);
+    if (!IsImageDataEqual(expectedFrames->GetTrackedFrame(otherFrameIndex)->GetImageData(), copiedFrame.GetImageData()))
+    {
+      LOG_ERROR("Image data mismatch after assigning lazily loaded frame #" << otherFrameIndex << " to the copy of frame #" << i);
+      numberOfDifferences++;
+    }
+  }
+  return numberOfDifferences;
+}
+
+// Reads the lazily loaded frames from two threads at the same time, in opposite order, so frames are released while the other thread uses them.
+// Returns the number of frames with wrong image data.
+int TestLazyFrameConcurrentRead(vtkPlusTrackedFrameList* expectedFrames, vtkPlusTrackedFrameList* lazyFrames, int numberOfIterations)
+{
+  int numberOfFrames = static_cast<int>(lazyFrames->GetNumberOfTrackedFrames());
+
+  // Expected images are fully in memory, get them before the threads are started
+  std::vector<PlusVideoFrame*> expectedImages;
+  for (int i = 0; i < numberOfFrames; i++)
+  {
+    expectedImages.push_back(expectedFrames->GetTrackedFrame(i)->GetImageData());
+  }
+
+  std::atomic<int> numberOfDifferences(0);
+  auto readFrames = [&](bool reverse)
+  {
+    for (int iteration = 0; iteration < numberOfIterations; iteration++)
+    {
+      for (int i = 0; i < numberOfFrames; i++)
+      {
+        int frameIndex = reverse ? numberOfFrames - 1 - i : i;
+        PlusVideoFrame image;
+        if (lazyFrames->GetTrackedFrame(frameIndex)->ShallowCopyImageDataTo(image) != PLUS_SUCCESS
+            || !IsImageDataEqual(expectedImages[frameIndex], &image))
+        {
+          LOG_ERROR("Image data mismatch at lazily loaded frame #" << frameIndex << " read from multiple threads");
+          numberOfDifferences++;
+        }
+      }
+    }
+  };
+
+  std::thread forwardReader(readFrames, false);
+  std::thread reverseReader(readFrames, true);
+  forwardReader.join();
+  reverseReader.join();
+
+  return numberOfDifferences;
+}
+
+// Holds references to the images of all lazily loaded frames (more than the resident frame limit) while they are loaded one after the other,
+// the images must stay valid. Frame properties must be available without loading the pixel data.
+// Returns the number of failures.
+int TestLazyFrameHeldImages(vtkPlusTrackedFrameList* expectedFrames, vtkPlusTrackedFrameList* lazyFrames)
+{
+  int numberOfFailures = 0;
+  int numberOfFrames = static_cast<int>(lazyFrames->GetNumberOfTrackedFrames());
+  vtkPlusLazyFrameLoader* loader = lazyFrames->GetTrackedFrame(0)->GetImageDataLoader();
+  if (loader == NULL)
+  {
+    LOG_ERROR("Frames read lazily have no image data loader");
+    return 1;
+  }
+  if (numberOfFrames <= loader->GetMaximumNumberOfResidentFrames())
+  {
+    LOG_ERROR("Test requires more frames (" << numberOfFrames << ") than the resident frame limit (" << loader->GetMaximumNumberOfResidentFrames() << ")");
+    return 1;
+  }
+
+  int numberOfResidentFrames = loader->GetNumberOfResidentFrames();
+  for (int i = 0; i < numberOfFrames; i++)
+  {
+    PlusTrackedFrame* expectedFrame = expectedFrames->GetTrackedFrame(i);
+    PlusTrackedFrame* lazyFrame = lazyFrames->GetTrackedFrame(i);
+    unsigned int expectedNumberOfScalarComponents(0);
+    unsigned int numberOfScalarComponents(0);
+    expectedFrame->GetNumberOfScalarComponents(expectedNumberOfScalarComponents);
+    lazyFrame->GetNumberOfScalarComponents(numberOfScalarComponents);
+    if (lazyFrame->GetFrameSize() != expectedFrame->GetFrameSize()
+        || lazyFrame->GetNumberOfBitsPerScalar() != expectedFrame->GetNumberOfBitsPerScalar()
+        || numberOfScalarComponents != expectedNumberOfScalarComponents)
+    {
+      LOG_ERROR("Image properties mismatch at lazily loaded frame #" << i);
+      numberOfFailures++;
+    }
+  }
+  if (loader->GetNumberOfResidentFrames() != numberOfResidentFrames)
+  {
+    LOG_ERROR("Querying image properties loaded pixel data: " << loader->GetNumberOfResidentFrames() << " frames in memory, expected " << numberOfResidentFrames);
+    numberOfFailures++;
+  }
+
+  std::vector< vtkSmartPointer<vtkImageData> > heldImages;
+  for (int i = 0; i < numberOfFrames; i++)
+  {
+    heldImages.push_back(lazyFrames->GetTrackedFrame(i)->GetImageData()->GetImage());
+  }
+  for (int i = 0; i < numberOfFrames; i++)
+  {
+    PlusVideoFrame* expectedImage = expectedFrames->GetTrackedFrame(i)->GetImageData();
+    if (heldImages[i].GetPointer() == NULL
+        || memcmp(expectedImage->GetScalarPointer(), heldImages[i]->GetScalarPointer(), expectedImage->GetFrameSizeInBytes()) != 0)
+    {
+      LOG_ERROR("Held image of lazily loaded frame #" << i << " changed while other frames were loaded");
+      numberOfFailures++;
+    }
+  }
+
+  if (loader->GetNumberOfResidentFrames() != numberOfFrames)
+  {
+    LOG_ERROR("Number of frames in memory is " << loader->GetNumberOfResidentFrames() << " while their images are held, expected " << numberOfFrames);
+    numberOfFailures++;
+  }
+
+  // Once the references are given up the frames are released at the next load (all frames are in memory, so a copy is loaded)
+  heldImages.clear();
+  PlusTrackedFrame copiedFrame(*lazyFrames->GetTrackedFrame(0));
+  copiedFrame.GetImageData();
+  if (loader->GetNumberOfResidentFrames() > loader->GetMaximumNumberOfResidentFrames())
+  {
+    LOG_ERROR("Number of frames in memory is " << loader->GetNumberOfResidentFrames() << " after the images were released, expected at most " << loader->GetMaximumNumberOfResidentFrames());
+    numberOfFailures++;
+  }
+
+  return numberOfFailures;
+}
+
+// Copies a sequence metafile without the chunk offset frame fields, so that the copy can only be read as a single compressed stream,
+// the way it is read by readers that do not know about chunks
+PlusStatus WriteFileWithoutChunkOffsets(const std::string& inputFileName, const std::string& outputFileName)
+{
+  std::ifstream input(inputFileName.c_str(), std::ios::binary);
+  if (!input)
+  {
+    LOG_ERROR("Couldn't open " << inputFileName << " for reading");
+    return PLUS_FAIL;
+  }
+  std::ostringstream inputContent;
+  inputContent << input.rdbuf();
+  std::string content = inputContent.str();
+
+  // The header is text, it ends with the line that specifies that the pixel data follows
+  const std::string headerEnd = "ElementDataFile = LOCAL";
+  size_t headerEndPos = content.find(headerEnd);
+  if (headerEndPos == std::string::npos || content.find('\n', headerEndPos) == std::string::npos)
+  {
+    LOG_ERROR("Pixel data is not stored in " << inputFileName);
+    return PLUS_FAIL;
+  }
+  size_t pixelDataPos = content.find('\n', headerEndPos) + 1;
+
+  std::ofstream output(outputFileName.c_str(), std::ios::binary);
+  if (!output)
+  {
+    LOG_ERROR("Couldn't open " << outputFileName << " for writing");
+    return PLUS_FAIL;
+  }
+  int numberOfRemovedFields = 0;
+  size_t lineStartPos = 0;
+  while (lineStartPos < pixelDataPos)
+  {
+    size_t lineEndPos = content.find('\n', lineStartPos) + 1;
+    std::string line = content.substr(lineStartPos, lineEndPos - lineStartPos);
+    if (line.find("_CompressedDataOffset =") == std::string::npos)
+    {
+      output << line;
+    }
+    else
+    {
+      numberOfRemovedFields++;
+    }
+    lineStartPos = lineEndPos;
+  }
+  output.write(content.data() + pixelDataPos, content.size() - pixelDataPos);
+
+  if (numberOfRemovedFields == 0)
+  {
+    LOG_ERROR("No chunk offsets found in " << inputFileName);
+    return PLUS_FAIL;
+  }
+  return PLUS_SUCCESS;
+}
 
 ///////////////////////////////////////////////////////////////////
 
@@ -209,6 +466,151 @@ int main(int argc, char** argv)
 
   }
 
+  // ******************************************************************************
+  // Test writing and reading of chunk-compressed data
+
+  std::string chunkedImageSequenceFileName = vtksys::SystemTools::GetFilenamePath(outputImageSequenceFileName) + "/"
+      + vtksys::SystemTools::GetFilenameWithoutLastExtension(outputImageSequenceFileName) + "Chunked.mha";
+
+  vtkSmartPointer<vtkPlusMetaImageSequenceIO> writerChunked = vtkSmartPointer<vtkPlusMetaImageSequenceIO>::New();
+  writerChunked->UseCompressionOn();
+  writerChunked->SetCompressedFramesPerChunk(3);
+  writerChunked->SetFileName(chunkedImageSequenceFileName.c_str());
+  writerChunked->SetTrackedFrameList(trackedFrameList);
+  if (writerChunked->Write() != PLUS_SUCCESS)
+  {
+    LOG_ERROR("Couldn't write chunk-compressed sequence metafile: " <<  chunkedImageSequenceFileName);
+    return EXIT_FAILURE;
+  }
+
+  LOG_INFO("Test reading all frames of chunk-compressed data ...");
+  vtkSmartPointer<vtkPlusMetaImageSequenceIO> readerChunked = vtkSmartPointer<vtkPlusMetaImageSequenceIO>::New();
+  readerChunked->SetFileName(chunkedImageSequenceFileName.c_str());
+  if (readerChunked->Read() != PLUS_SUCCESS)
+  {
+    LOG_ERROR("Couldn't read chunk-compressed sequence metafile: " <<  chunkedImageSequenceFileName);
+    return EXIT_FAILURE;
+  }
+  if (static_cast<int>(readerChunked->GetTrackedFrameList()->GetNumberOfTrackedFrames()) != numberOfFrames)
+  {
+    LOG_ERROR("Number of frames read from chunk-compressed file is " << readerChunked->GetTrackedFrameList()->GetNumberOfTrackedFrames() << ", expected " << numberOfFrames);
+    numberOfFailures++;
+  }
+  else
+  {
+    numberOfFailures += CompareImageData(trackedFrameList, 0, readerChunked->GetTrackedFrameList());
+  }
+
+  LOG_INFO("Test reading a range of frames of chunk-compressed data ...");
+  int firstFrameNumber = numberOfFrames / 3;
+  int lastFrameNumber = (2 * numberOfFrames) / 3;
+  vtkSmartPointer<vtkPlusMetaImageSequenceIO> readerChunkedRange = vtkSmartPointer<vtkPlusMetaImageSequenceIO>::New();
+  readerChunkedRange->SetFileName(chunkedImageSequenceFileName.c_str());
+  if (readerChunkedRange->ReadFrames(firstFrameNumber, lastFrameNumber) != PLUS_SUCCESS)
+  {
+    LOG_ERROR("Couldn't read frames " << firstFrameNumber << "-" << lastFrameNumber << " from chunk-compressed sequence metafile: " <<  chunkedImageSequenceFileName);
+    return EXIT_FAILURE;
+  }
+  if (static_cast<int>(readerChunkedRange->GetTrackedFrameList()->GetNumberOfTrackedFrames()) != lastFrameNumber - firstFrameNumber + 1)
+  {
+    LOG_ERROR("Number of frames read from chunk-compressed file is " << readerChunkedRange->GetTrackedFrameList()->GetNumberOfTrackedFrames() << ", expected " << lastFrameNumber - firstFrameNumber + 1);
+    numberOfFailures++;
+  }
+  else
+  {
+    numberOfFailures += CompareImageData(trackedFrameList, firstFrameNumber, readerChunkedRange->GetTrackedFrameList());
+    if (fabs(readerChunkedRange->GetTrackedFrameList()->GetTrackedFrame(0)->GetTimestamp() - trackedFrameList->GetTrackedFrame(firstFrameNumber)->GetTimestamp()) > 1e-12)
+    {
+      LOG_ERROR("Timestamp mismatch at the first frame of the range read from chunk-compressed file");
+      numberOfFailures++;
+    }
+  }
+
+  LOG_INFO("Test reading chunk-compressed data as a single compressed stream ...");
+  std::string chunkedLegacyImageSequenceFileName = vtksys::SystemTools::GetFilenamePath(outputImageSequenceFileName) + "/"
+      + vtksys::SystemTools::GetFilenameWithoutLastExtension(outputImageSequenceFileName) + "ChunkedLegacy.mha";
+  if (WriteFileWithoutChunkOffsets(chunkedImageSequenceFileName, chunkedLegacyImageSequenceFileName) != PLUS_SUCCESS)
+  {
+    LOG_ERROR("Couldn't remove the chunk offsets from chunk-compressed sequence metafile: " <<  chunkedImageSequenceFileName);
+    return EXIT_FAILURE;
+  }
+  vtkSmartPointer<vtkPlusMetaImageSequenceIO> readerChunkedLegacy = vtkSmartPointer<vtkPlusMetaImageSequenceIO>::New();
+  readerChunkedLegacy->SetFileName(chunkedLegacyImageSequenceFileName.c_str());
+  if (readerChunkedLegacy->Read() != PLUS_SUCCESS)
+  {
+    LOG_ERROR("Couldn't read chunk-compressed sequence metafile as a single compressed stream: " <<  chunkedLegacyImageSequenceFileName);
+    return EXIT_FAILURE;
+  }
+  if (static_cast<int>(readerChunkedLegacy->GetTrackedFrameList()->GetNumberOfTrackedFrames()) != numberOfFrames)
+  {
+    LOG_ERROR("Number of frames read from chunk-compressed file as a single compressed stream is " << readerChunkedLegacy->GetTrackedFrameList()->GetNumberOfTrackedFrames() << ", expected " << numberOfFrames);
+    numberOfFailures++;
+  }
+  else
+  {
+    numberOfFailures += CompareImageData(trackedFrameList, 0, readerChunkedLegacy->GetTrackedFrameList());
+  }
+
+  // ******************************************************************************
+  // Test lazy loading of uncompressed data
+
+  std::string uncompressedImageSequenceFileName = vtksys::SystemTools::GetFilenamePath(outputImageSequenceFileName) + "/"
+      + vtksys::SystemTools::GetFilenameWithoutLastExtension(outputImageSequenceFileName) + "Uncompressed.mha";
+
+  vtkSmartPointer<vtkPlusMetaImageSequenceIO> writerUncompressed = vtkSmartPointer<vtkPlusMetaImageSequenceIO>::New();
+  writerUncompressed->UseCompressionOff();
+  writerUncompressed->SetFileName(uncompressedImageSequenceFileName.c_str());
+  writerUncompressed->SetTrackedFrameList(trackedFrameList);
+  if (writerUncompressed->Write() != PLUS_SUCCESS)
+  {
+    LOG_ERROR("Couldn't write uncompressed sequence metafile: " <<  uncompressedImageSequenceFileName);
+    return EXIT_FAILURE;
+  }
+
+  LOG_INFO("Test lazy loading of uncompressed data ...");
+  vtkSmartPointer<vtkPlusMetaImageSequenceIO> readerLazy = vtkSmartPointer<vtkPlusMetaImageSequenceIO>::New();
+  readerLazy->SetFileName(uncompressedImageSequenceFileName.c_str());
+  readerLazy->LazyImageLoadingOn();
+  readerLazy->SetMaximumNumberOfResidentFrames(2);
+  if (readerLazy->Read() != PLUS_SUCCESS)
+  {
+    LOG_ERROR("Couldn't read uncompressed sequence metafile: " <<  uncompressedImageSequenceFileName);
+    return EXIT_FAILURE;
+  }
+  if (static_cast<int>(readerLazy->GetTrackedFrameList()->GetNumberOfTrackedFrames()) != numberOfFrames)
+  {
+    LOG_ERROR("Number of frames read lazily from uncompressed file is " << readerLazy->GetTrackedFrameList()->GetNumberOfTrackedFrames() << ", expected " << numberOfFrames);
+    numberOfFailures++;
+  }
+  else
+  {
+    // Frames are released and loaded again when they are accessed the second time
+    numberOfFailures += CompareImageData(trackedFrameList, 0, readerLazy->GetTrackedFrameList());
+    numberOfFailures += CompareImageData(trackedFrameList, 0, readerLazy->GetTrackedFrameList());
+    numberOfFailures += TestLazyFrameHeldImages(trackedFrameList, readerLazy->GetTrackedFrameList());
+  }
+
+  LOG_INFO("Test copying and concurrent reading of lazily loaded frames ...");
+  vtkSmartPointer<vtkPlusMetaImageSequenceIO> readerLazySingleFrame = vtkSmartPointer<vtkPlusMetaImageSequenceIO>::New();
+  readerLazySingleFrame->SetFileName(uncompressedImageSequenceFileName.c_str());
+  readerLazySingleFrame->LazyImageLoadingOn();
+  readerLazySingleFrame->SetMaximumNumberOfResidentFrames(1);
+  if (readerLazySingleFrame->Read() != PLUS_SUCCESS)
+  {
+    LOG_ERROR("Couldn't read uncompressed sequence metafile: " <<  uncompressedImageSequenceFileName);
+    return EXIT_FAILURE;
+  }
+  if (static_cast<int>(readerLazySingleFrame->GetTrackedFrameList()->GetNumberOfTrackedFrames()) != numberOfFrames)
+  {
+    LOG_ERROR("Number of frames read lazily from uncompressed file is " << readerLazySingleFrame->GetTrackedFrameList()->GetNumberOfTrackedFrames() << ", expected " << numberOfFrames);
+    numberOfFailures++;
+  }
+  else
+  {
+    numberOfFailures += TestLazyFrameCopy(trackedFrameList, readerLazySingleFrame->GetTrackedFrameList());
+    numberOfFailures += TestLazyFrameConcurrentRead(trackedFrameList, readerLazySingleFrame->GetTrackedFrameList(), 5);
+  }
+
   // ******************************************************************************
   // Test image status
 
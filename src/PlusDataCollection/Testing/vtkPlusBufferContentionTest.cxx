@@ -0,0 +1,323 @@
+/*=Plus=header=begin======================================================
+  Program: Plus
+  Copyright (c) Laboratory for Percutaneous Surgery. All rights reserved.
+  See License.txt for details.
+=========================================================Plus=header=end*/
+
+/*!
+  \file vtkPlusBufferContentionTest.cxx
+  \brief Stress test of concurrent buffer access
+
+  A writer thread adds transforms to a buffer as fast as it can while several reader threads
+  continuously query the buffer (latest item UID, timestamps, frame index, item lookup by time)
+  and copy items from it. The test fails if any reader gets inconsistent data: each item
+  stores its frame index in its timestamp and in its transform, so all of them must match.
+  The time spent by the writer in adding items is reported.
+  Waiting for new items is tested as well: a waiting thread must be woken up by a new item and by an interrupt,
+  must not miss an item or interrupt that comes before it starts waiting, and must return when the timeout expires.
+*/
+
+#include "PlusConfigure.h"
+#include "vtkMatrix4x4.h"
+#include "vtkPlusBuffer.h"
+#include "vtksys/CommandLineArguments.hxx"
+
+// STL includes
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+namespace
+{
+  // Time between consecutive items, in seconds
+  const double ITEM_PERIOD_SEC = 0.001;
+  const double TIMESTAMP_TOLERANCE_SEC = 1e-9;
+  // Waits that are expected to be ended by an item or an interrupt must end well before this timeout
+  const double WAIT_TIMEOUT_SEC = 5.0;
+  // Timeout of the waits that are expected to time out
+  const double SHORT_WAIT_TIMEOUT_SEC = 0.2;
+  // Delay before the item or the interrupt that ends a wait in another thread
+  const double WAKE_UP_DELAY_SEC = 0.05;
+
+  struct TestState
+  {
+    vtkPlusBuffer* Buffer;
+    std::atomic<bool> WriterDone;
+    std::atomic<long> NumberOfReads;
+    std::atomic<long> NumberOfInconsistentReads;
+  };
+
+  //----------------------------------------------------------------------------
+  void WriteItems(TestState* state, unsigned long numberOfItems, double* maxAddTimeSec, double* totalAddTimeSec)
+  {
+    vtkSmartPointer<vtkMatrix4x4> matrix = vtkSmartPointer<vtkMatrix4x4>::New();
+    for (unsigned long frameNumber = 1; frameNumber <= numberOfItems; ++frameNumber)
+    {
+      matrix->SetElement(0, 3, frameNumber);
+      const double timestamp = frameNumber * ITEM_PERIOD_SEC;
+      const double addStartTime = vtkPlusAccurateTimer::GetSystemTime();
+      if (state->Buffer->AddTimeStampedItem(matrix, TOOL_OK, frameNumber, timestamp, timestamp) != PLUS_SUCCESS)
+      {
+        LOG_ERROR("Failed to add item " << frameNumber << " to the buffer");
+      }
+      const double addTimeSec = vtkPlusAccurateTimer::GetSystemTime() - addStartTime;
+      *maxAddTimeSec = std::max(*maxAddTimeSec, addTimeSec);
+      *totalAddTimeSec += addTimeSec;
+    }
+    state->WriterDone = true;
+  }
+
+  //----------------------------------------------------------------------------
+  void ReadItems(TestState* state)
+  {
+    vtkSmartPointer<vtkMatrix4x4> matrix = vtkSmartPointer<vtkMatrix4x4>::New();
+    long numberOfReads = 0;
+    while (!state->WriterDone)
+    {
+      BufferItemUidType uid = state->Buffer->GetLatestItemUidInBuffer();
+      if (uid == 0)
+      {
+        continue;
+      }
+
+      // Items may be overwritten while they are read, only the consistency of the successfully read values is checked
+      bool consistent = true;
+      double timestamp = 0;
+      unsigned long frameNumber = 0;
+      if (state->Buffer->GetTimeStamp(uid, timestamp) == ITEM_OK && state->Buffer->GetIndex(uid, frameNumber) == ITEM_OK)
+      {
+        consistent &= (fabs(timestamp - frameNumber * ITEM_PERIOD_SEC) < TIMESTAMP_TOLERANCE_SEC);
+      }
+
+      BufferItemUidType foundUid = 0;
+      if (timestamp > 0 && state->Buffer->GetItemUidFromTime(timestamp, foundUid) == ITEM_OK)
+      {
+        consistent &= (foundUid == uid);
+      }
+
+      double oldestTimestamp = 0;
+      double latestTimestamp = 0;
+      if (state->Buffer->GetOldestTimeStamp(oldestTimestamp) == ITEM_OK && state->Buffer->GetLatestTimeStamp(latestTimestamp) == ITEM_OK)
+      {
+        consistent &= (oldestTimestamp <= latestTimestamp);
+      }
+
+      if (numberOfReads % 16 == 0)
+      {
+        // Copy the item data, which locks the buffer
+        StreamBufferItem item;
+        if (state->Buffer->GetStreamBufferItem(uid, &item) == ITEM_OK && item.GetMatrix(matrix) == PLUS_SUCCESS)
+        {
+          consistent &= (matrix->GetElement(0, 3) == item.GetIndex());
+          consistent &= (fabs(item.GetFilteredTimestamp(0) - item.GetIndex() * ITEM_PERIOD_SEC) < TIMESTAMP_TOLERANCE_SEC);
+        }
+      }
+
+      if (!consistent)
+      {
+        state->NumberOfInconsistentReads++;
+      }
+      numberOfReads++;
+    }
+    state->NumberOfReads += numberOfReads;
+  }
+
+  //----------------------------------------------------------------------------
+  PlusStatus AddItem(vtkPlusBuffer* buffer, unsigned long frameNumber)
+  {
+    vtkSmartPointer<vtkMatrix4x4> matrix = vtkSmartPointer<vtkMatrix4x4>::New();
+    const double timestamp = frameNumber * ITEM_PERIOD_SEC;
+    return buffer->AddTimeStampedItem(matrix, TOOL_OK, frameNumber, timestamp, timestamp);
+  }
+
+  //----------------------------------------------------------------------------
+  // Returns the number of failures
+  int TestWaitForNewItem()
+  {
+    int numberOfFailures = 0;
+    vtkSmartPointer<vtkPlusBuffer> buffer = vtkSmartPointer<vtkPlusBuffer>::New();
+    buffer->SetBufferSize(10);
+
+    // Timeout: no items are added
+    double lastItemTimestamp = UNDEFINED_TIMESTAMP;
+    unsigned long lastInterruptCount = buffer->GetWaitInterruptCount();
+    double waitStartTime = vtkPlusAccurateTimer::GetSystemTime();
+    bool newItemAvailable = buffer->WaitForNewItem(lastItemTimestamp, SHORT_WAIT_TIMEOUT_SEC, &lastInterruptCount);
+    double waitTimeSec = vtkPlusAccurateTimer::GetSystemTime() - waitStartTime;
+    if (newItemAvailable || waitTimeSec < SHORT_WAIT_TIMEOUT_SEC * 0.9 || waitTimeSec > WAIT_TIMEOUT_SEC)
+    {
+      LOG_ERROR("Wait without new items returned " << (newItemAvailable ? "true" : "false") << " after " << waitTimeSec << " sec, expected false after " << SHORT_WAIT_TIMEOUT_SEC << " sec");
+      numberOfFailures++;
+    }
+
+    // Wake-up: an item is added while the other thread waits. The thread waits for an item newer than the
+    // newest one now, so the test does not depend on whether the thread starts waiting before the item is added.
+    lastItemTimestamp = UNDEFINED_TIMESTAMP;
+    buffer->WaitForNewItem(lastItemTimestamp, 0);
+    std::atomic<bool> waiterNewItemAvailable(false);
+    std::atomic<double> waiterWaitTimeSec(0);
+    std::thread waiter([&]()
+    {
+      double waiterLastItemTimestamp = lastItemTimestamp;
+      double waiterStartTime = vtkPlusAccurateTimer::GetSystemTime();
+      waiterNewItemAvailable = buffer->WaitForNewItem(waiterLastItemTimestamp, WAIT_TIMEOUT_SEC);
+      waiterWaitTimeSec = vtkPlusAccurateTimer::GetSystemTime() - waiterStartTime;
+    });
+    vtkPlusAccurateTimer::Delay(WAKE_UP_DELAY_SEC);
+    AddItem(buffer, 1);
+    waiter.join();
+    if (!waiterNewItemAvailable || waiterWaitTimeSec > WAIT_TIMEOUT_SEC / 2)
+    {
+      LOG_ERROR("Waiting thread was not woken up by a new item (returned " << (waiterNewItemAvailable ? "true" : "false") << " after " << waiterWaitTimeSec.load() << " sec)");
+      numberOfFailures++;
+    }
+
+    // No lost wake-up: the item is added after the caller got the timestamp of the newest item but before it waits
+    lastItemTimestamp = UNDEFINED_TIMESTAMP;
+    buffer->WaitForNewItem(lastItemTimestamp, 0);
+    AddItem(buffer, 2);
+    waitStartTime = vtkPlusAccurateTimer::GetSystemTime();
+    newItemAvailable = buffer->WaitForNewItem(lastItemTimestamp, WAIT_TIMEOUT_SEC);
+    waitTimeSec = vtkPlusAccurateTimer::GetSystemTime() - waitStartTime;
+    if (!newItemAvailable || waitTimeSec > WAIT_TIMEOUT_SEC / 2 || fabs(lastItemTimestamp - 2 * ITEM_PERIOD_SEC) > TIMESTAMP_TOLERANCE_SEC)
+    {
+      LOG_ERROR("Item added before the wait was missed (returned " << (newItemAvailable ? "true" : "false") << " after " << waitTimeSec << " sec, newest timestamp: " << lastItemTimestamp << ")");
+      numberOfFailures++;
+    }
+
+    // Interrupt wake-up: the other thread is interrupted while it waits
+    std::atomic<bool> waiterInterrupted(false);
+    waiterWaitTimeSec = 0;
+    lastInterruptCount = buffer->GetWaitInterruptCount();
+    std::thread interruptedWaiter([&]()
+    {
+      double waiterLastItemTimestamp = lastItemTimestamp;
+      unsigned long waiterLastInterruptCount = lastInterruptCount;
+      double waiterStartTime = vtkPlusAccurateTimer::GetSystemTime();
+      bool waiterNewItem = buffer->WaitForNewItem(waiterLastItemTimestamp, WAIT_TIMEOUT_SEC, &waiterLastInterruptCount);
+      waiterWaitTimeSec = vtkPlusAccurateTimer::GetSystemTime() - waiterStartTime;
+      waiterInterrupted = !waiterNewItem && waiterLastInterruptCount == buffer->GetWaitInterruptCount();
+    });
+    vtkPlusAccurateTimer::Delay(WAKE_UP_DELAY_SEC);
+    buffer->InterruptWaitForNewItem();
+    interruptedWaiter.join();
+    if (!waiterInterrupted || waiterWaitTimeSec > WAIT_TIMEOUT_SEC / 2)
+    {
+      LOG_ERROR("Waiting thread was not woken up by an interrupt (waited " << waiterWaitTimeSec.load() << " sec)");
+      numberOfFailures++;
+    }
+
+    // No lost interrupt: the interrupt comes after the caller got the interrupt counter but before it waits
+    lastInterruptCount = buffer->GetWaitInterruptCount();
+    buffer->InterruptWaitForNewItem();
+    waitStartTime = vtkPlusAccurateTimer::GetSystemTime();
+    newItemAvailable = buffer->WaitForNewItem(lastItemTimestamp, WAIT_TIMEOUT_SEC, &lastInterruptCount);
+    waitTimeSec = vtkPlusAccurateTimer::GetSystemTime() - waitStartTime;
+    if (newItemAvailable || waitTimeSec > WAIT_TIMEOUT_SEC / 2 || lastInterruptCount != buffer->GetWaitInterruptCount())
+    {
+      LOG_ERROR("Interrupt before the wait was missed (returned " << (newItemAvailable ? "true" : "false") << " after " << waitTimeSec << " sec)");
+      numberOfFailures++;
+    }
+
+    // Interrupts that happened before the counter was initialized do not end the wait
+    buffer->InterruptWaitForNewItem();
+    lastInterruptCount = buffer->GetWaitInterruptCount();
+    waitStartTime = vtkPlusAccurateTimer::GetSystemTime();
+    newItemAvailable = buffer->WaitForNewItem(lastItemTimestamp, SHORT_WAIT_TIMEOUT_SEC, &lastInterruptCount);
+    waitTimeSec = vtkPlusAccurateTimer::GetSystemTime() - waitStartTime;
+    if (newItemAvailable || waitTimeSec < SHORT_WAIT_TIMEOUT_SEC * 0.9)
+    {
+      LOG_ERROR("Wait was ended by an earlier interrupt after " << waitTimeSec << " sec, expected timeout after " << SHORT_WAIT_TIMEOUT_SEC << " sec");
+      numberOfFailures++;
+    }
+
+    return numberOfFailures;
+  }
+}
+
+//----------------------------------------------------------------------------
+int main(int argc, char** argv)
+{
+  bool printHelp(false);
+  int numberOfItems = 200000;
+  int numberOfReaders = 4;
+  int bufferSize = 1000;
+  int verboseLevel = vtkPlusLogger::LOG_LEVEL_UNDEFINED;
+
+  vtksys::CommandLineArguments args;
+  args.Initialize(argc, argv);
+
+  args.AddArgument("--help", vtksys::CommandLineArguments::NO_ARGUMENT, &printHelp, "Print this help.");
+  args.AddArgument("--number-of-items", vtksys::CommandLineArguments::EQUAL_ARGUMENT, &numberOfItems, "Number of items added by the writer (Default: 200000).");
+  args.AddArgument("--number-of-readers", vtksys::CommandLineArguments::EQUAL_ARGUMENT, &numberOfReaders, "Number of reader threads (Default: 4).");
+  args.AddArgument("--buffer-size", vtksys::CommandLineArguments::EQUAL_ARGUMENT, &bufferSize, "Number of items in the buffer (Default: 1000).");
+  args.AddArgument("--verbose", vtksys::CommandLineArguments::EQUAL_ARGUMENT, &verboseLevel, "Verbose level (1=error only, 2=warning, 3=info, 4=debug, 5=trace)");
+
+  if (!args.Parse())
+  {
+    std::cerr << "Problem parsing arguments" << std::endl;
+    std::cout << "Help: " << args.GetHelp() << std::endl;
+    exit(EXIT_FAILURE);
+  }
+
+  if (printHelp)
+  {
+    std::cout << args.GetHelp() << std::endl;
+    exit(EXIT_SUCCESS);
+  }
+
+  vtkPlusLogger::Instance()->SetLogLevel(verboseLevel);
+
+  vtkSmartPointer<vtkPlusBuffer> buffer = vtkSmartPointer<vtkPlusBuffer>::New();
+  buffer->SetBufferSize(bufferSize);
+
+  TestState state;
+  state.Buffer = buffer;
+  state.WriterDone = false;
+  state.NumberOfReads = 0;
+  state.NumberOfInconsistentReads = 0;
+
+  double maxAddTimeSec = 0;
+  double totalAddTimeSec = 0;
+  const double testStartTime = vtkPlusAccurateTimer::GetSystemTime();
+
+  std::vector<std::thread> readers;
+  for (int readerIndex = 0; readerIndex < numberOfReaders; ++readerIndex)
+  {
+    readers.push_back(std::thread(ReadItems, &state));
+  }
+  std::thread writer(WriteItems, &state, static_cast<unsigned long>(numberOfItems), &maxAddTimeSec, &totalAddTimeSec);
+
+  writer.join();
+  for (std::vector<std::thread>::iterator it = readers.begin(); it != readers.end(); ++it)
+  {
+    it->join();
+  }
+
+  const double testTimeSec = vtkPlusAccurateTimer::GetSystemTime() - testStartTime;
+  LOG_INFO("Added " << numberOfItems << " items in " << testTimeSec << " sec while " << numberOfReaders << " readers performed " << state.NumberOfReads << " reads");
+  LOG_INFO("Time spent by the writer in adding an item: average " << (numberOfItems > 0 ? 1e6 * totalAddTimeSec / numberOfItems : 0) << " us, maximum " << 1e6 * maxAddTimeSec << " us");
+
+  if (buffer->GetLatestItemUidInBuffer() != static_cast<BufferItemUidType>(numberOfItems))
+  {
+    LOG_ERROR("Unexpected latest item UID: " << buffer->GetLatestItemUidInBuffer() << " (expected: " << numberOfItems << ")");
+    return EXIT_FAILURE;
+  }
+
+  if (state.NumberOfInconsistentReads > 0)
+  {
+    LOG_ERROR(state.NumberOfInconsistentReads << " of " << state.NumberOfReads << " reads returned inconsistent data");
+    return EXIT_FAILURE;
+  }
+
+  int numberOfWaitFailures = TestWaitForNewItem();
+  if (numberOfWaitFailures > 0)
+  {
+    LOG_ERROR(numberOfWaitFailures << " waiting for new items tests failed");
+    return EXIT_FAILURE;
+  }
+
+  LOG_INFO("vtkPlusBufferContentionTest completed successfully");
+  return EXIT_SUCCESS;
+}
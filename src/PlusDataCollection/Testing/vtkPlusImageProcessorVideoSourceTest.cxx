@@ -0,0 +1,552 @@
+/*=Plus=header=begin======================================================
+Program: Plus
+Copyright (c) Laboratory for Percutaneous Surgery. All rights reserved.
+See License.txt for details.
+=========================================================Plus=header=end*/
+
+/*!
+  \file vtkPlusImageProcessorVideoSourceTest.cxx
+  \brief Runs a chain of synthetic processors in an image processor device, with one stage that is slower than the input
+
+  The middle stage of the chain cannot keep up with the replayed video, so the queues in front of it fill up and input frames are dropped.
+  The test verifies that the queues stay within their limit, frames are processed by all the stages in acquisition order,
+  the dropped frame count and the per-stage latencies are consistent with the processing, and the device disconnects cleanly
+  while the slow stage is busy.
+
+  A second chain of two equally slow stages verifies that the throughput is limited by the slowest stage and not by the sum
+  of the processing times of the stages.
+*/
+
+// Local includes
+#include "PlusConfigure.h"
+#include "PlusTrackedFrame.h"
+#include "vtkPlusChannel.h"
+#include "vtkPlusDataCollector.h"
+#include "vtkPlusDataSource.h"
+#include "vtkPlusImageProcessorVideoSource.h"
+#include "vtkPlusTrackedFrameProcessor.h"
+
+// VTK includes
+#include <vtkObjectFactory.h>
+#include <vtkSmartPointer.h>
+#include <vtkXMLDataElement.h>
+#include <vtkXMLUtilities.h>
+#include <vtksys/CommandLineArguments.hxx>
+#include <vtksys/SystemTools.hxx>
+
+// STL includes
+#include <atomic>
+#include <sstream>
+
+//----------------------------------------------------------------------------
+/*!
+  \class vtkPlusSyntheticStageProcessor
+  \brief Processor that only waits for a configurable time and records the stages that have processed the frame
+
+  Each frame gets a field that lists the indices of the stages that processed it, so every stage can verify that
+  the frame has already passed all the previous stages. Frames must arrive in increasing timestamp order.
+*/
+class vtkPlusSyntheticStageProcessor : public vtkPlusTrackedFrameProcessor
+{
+public:
+  static vtkPlusSyntheticStageProcessor* New();
+  vtkTypeMacro(vtkPlusSyntheticStageProcessor, vtkPlusTrackedFrameProcessor);
+
+  virtual const char* GetProcessorTypeName() { return "SyntheticStageProcessor"; };
+
+  void SetStageIndex(int stageIndex) { this->StageIndex = stageIndex; }
+  void SetProcessingTimeMs(double processingTimeMs) { this->ProcessingTimeMs = processingTimeMs; }
+
+  virtual PlusStatus Update()
+  {
+    this->NumberOfActiveUpdates++;
+    PlusStatus status = this->Superclass::Update();
+    this->NumberOfActiveUpdates--;
+    return status;
+  }
+
+  int GetNumberOfProcessedFrames() { return this->NumberOfProcessedFrames; }
+  int GetNumberOfActiveUpdates() { return this->NumberOfActiveUpdates; }
+  int GetNumberOfOrderErrors() { return this->NumberOfOrderErrors; }
+  int GetNumberOfStageTraceErrors() { return this->NumberOfStageTraceErrors; }
+
+  static const char* GetStageTraceFieldName() { return "ProcessingStageTrace"; }
+
+protected:
+  vtkPlusSyntheticStageProcessor()
+    : StageIndex(0)
+    , ProcessingTimeMs(0)
+    , LastTimestamp(0)
+    , NumberOfProcessedFrames(0)
+    , NumberOfActiveUpdates(0)
+    , NumberOfOrderErrors(0)
+    , NumberOfStageTraceErrors(0)
+  {
+  }
+
+  virtual PlusStatus ProcessFrame(PlusTrackedFrame* inputFrame, PlusTrackedFrame* outputFrame)
+  {
+    // Each stage has a single thread, so the frames of a stage are processed one at a time
+    if (inputFrame->GetTimestamp() <= this->LastTimestamp)
+    {
+      LOG_ERROR("Stage " << this->StageIndex << " received frame " << std::fixed << inputFrame->GetTimestamp() << " after frame " << this->LastTimestamp);
+      this->NumberOfOrderErrors++;
+    }
+    this->LastTimestamp = inputFrame->GetTimestamp();
+
+    std::ostringstream expectedStageTrace;
+    for (int stageIndex = 0; stageIndex < this->StageIndex; ++stageIndex)
+    {
+      expectedStageTrace << stageIndex << " ";
+    }
+    const char* stageTrace = inputFrame->GetFrameField(GetStageTraceFieldName());
+    std::string actualStageTrace = (stageTrace != NULL) ? stageTrace : "";
+    if (actualStageTrace != expectedStageTrace.str())
+    {
+      LOG_ERROR("Stage " << this->StageIndex << " received a frame that was processed by stages '" << actualStageTrace << "', expected '" << expectedStageTrace.str() << "'");
+      this->NumberOfStageTraceErrors++;
+    }
+
+    if (this->ProcessingTimeMs > 0)
+    {
+      vtksys::SystemTools::Delay(static_cast<unsigned int>(this->ProcessingTimeMs));
+    }
+
+    std::ostringstream outputStageTrace;
+    outputStageTrace << actualStageTrace << this->StageIndex << " ";
+    outputFrame->SetFrameField(GetStageTraceFieldName(), outputStageTrace.str());
+    this->NumberOfProcessedFrames++;
+    return PLUS_SUCCESS;
+  }
+
+  int StageIndex;
+  double ProcessingTimeMs;
+  double LastTimestamp;
+  std::atomic<int> NumberOfProcessedFrames;
+  std::atomic<int> NumberOfActiveUpdates;
+  std::atomic<int> NumberOfOrderErrors;
+  std::atomic<int> NumberOfStageTraceErrors;
+
+private:
+  vtkPlusSyntheticStageProcessor(const vtkPlusSyntheticStageProcessor&);
+  void operator=(const vtkPlusSyntheticStageProcessor&);
+};
+
+vtkStandardNewMacro(vtkPlusSyntheticStageProcessor);
+
+namespace
+{
+  const int NUMBER_OF_STAGES = 3;
+  const int SLOW_STAGE_INDEX = 1;
+
+  //----------------------------------------------------------------------------
+  std::string GetDeviceSetConfiguration(const std::string& sequenceFileName, int maxStageQueueSize)
+  {
+    std::ostringstream config;
+    config << "<PlusConfiguration version=\"2.1\">" << std::endl
+           << "  <DataCollection StartupDelaySec=\"1.0\">" << std::endl
+           << "    <DeviceSet Name=\"Image processor test\" Description=\"Processes replayed video with a chain of synthetic processors\" />" << std::endl
+           << "    <Device Id=\"VideoDevice\" Type=\"SavedDataSource\" SequenceFile=\"" << sequenceFileName << "\" UseData=\"IMAGE\" UseOriginalTimestamps=\"TRUE\" RepeatEnabled=\"TRUE\">" << std::endl
+           << "      <DataSources>" << std::endl
+           << "        <DataSource Type=\"Video\" Id=\"Video\" BufferSize=\"200\" PortUsImageOrientation=\"MF\" />" << std::endl
+           << "      </DataSources>" << std::endl
+           << "      <OutputChannels>" << std::endl
+           << "        <OutputChannel Id=\"VideoStream\" VideoDataSourceId=\"Video\" />" << std::endl
+           << "      </OutputChannels>" << std::endl
+           << "    </Device>" << std::endl
+           << "    <Device Id=\"ProcessorDevice\" Type=\"ImageProcessor\" MaxStageQueueSize=\"" << maxStageQueueSize << "\">" << std::endl
+           << "      <InputChannels>" << std::endl
+           << "        <InputChannel Id=\"VideoStream\" />" << std::endl
+           << "      </InputChannels>" << std::endl
+           << "      <DataSources>" << std::endl
+           << "        <DataSource Type=\"Video\" Id=\"ProcessedVideo\" BufferSize=\"5000\" PortUsImageOrientation=\"MF\" />" << std::endl
+           << "      </DataSources>" << std::endl
+           << "      <OutputChannels>" << std::endl
+           << "        <OutputChannel Id=\"ProcessedVideoStream\" VideoDataSourceId=\"ProcessedVideo\" />" << std::endl
+           << "      </OutputChannels>" << std::endl
+           << "    </Device>" << std::endl
+           << "  </DataCollection>" << std::endl
+           << "</PlusConfiguration>" << std::endl;
+    return config.str();
+  }
+
+  //----------------------------------------------------------------------------
+  // Returns true if no frame is waiting in a queue or being processed
+  bool IsPipelineIdle(vtkPlusImageProcessorVideoSource* processorDevice, const std::vector< vtkSmartPointer<vtkPlusSyntheticStageProcessor> >& processors)
+  {
+    for (int stageIndex = 0; stageIndex < NUMBER_OF_STAGES; ++stageIndex)
+    {
+      if (processorDevice->GetProcessingStageQueueDepth(stageIndex) > 0 || processors[stageIndex]->GetNumberOfActiveUpdates() > 0)
+      {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  //----------------------------------------------------------------------------
+  // Run the acquisition for the specified time, while checking the queue depths
+  int RunAcquisition(vtkPlusImageProcessorVideoSource* processorDevice, double acqTimeLengthSec, int maxStageQueueSize)
+  {
+    int numberOfFailures = 0;
+    const double acqStartTime = vtkPlusAccurateTimer::GetSystemTime();
+    while (acqStartTime + acqTimeLengthSec > vtkPlusAccurateTimer::GetSystemTime())
+    {
+      for (int stageIndex = 0; stageIndex < NUMBER_OF_STAGES; ++stageIndex)
+      {
+        int queueDepth = processorDevice->GetProcessingStageQueueDepth(stageIndex);
+        if (queueDepth > maxStageQueueSize)
+        {
+          LOG_ERROR("Queue of stage " << stageIndex << " contains " << queueDepth << " frames, limit is " << maxStageQueueSize);
+          numberOfFailures++;
+        }
+      }
+      vtksys::SystemTools::Delay(10);
+    }
+    return numberOfFailures;
+  }
+
+  //----------------------------------------------------------------------------
+  // Run two stages that take the same time to process a frame and check that the output frame period is close to
+  // the processing time of one stage, not to the sum of the processing times
+  int TestThroughput(const std::string& sequenceFileName, double stageProcessingTimeMs, int maxStageQueueSize)
+  {
+    const int numberOfThroughputStages = 2;
+    const double measurementTimeSec = 3.0;
+
+    vtkSmartPointer<vtkXMLDataElement> configRootElement = vtkSmartPointer<vtkXMLDataElement>::Take(
+          vtkXMLUtilities::ReadElementFromString(GetDeviceSetConfiguration(sequenceFileName, maxStageQueueSize).c_str()));
+    if (configRootElement.GetPointer() == NULL)
+    {
+      LOG_ERROR("Unable to parse the device set configuration");
+      return 1;
+    }
+    vtkPlusConfig::GetInstance()->SetDeviceSetConfigurationData(configRootElement);
+
+    vtkSmartPointer<vtkPlusDataCollector> dataCollector = vtkSmartPointer<vtkPlusDataCollector>::New();
+    vtkPlusDevice* device = NULL;
+    if (dataCollector->ReadConfiguration(configRootElement) != PLUS_SUCCESS || dataCollector->GetDevice(device, "ProcessorDevice") != PLUS_SUCCESS)
+    {
+      LOG_ERROR("Unable to configure data collector for the throughput test");
+      return 1;
+    }
+    vtkPlusImageProcessorVideoSource* processorDevice = vtkPlusImageProcessorVideoSource::SafeDownCast(device);
+    if (processorDevice == NULL)
+    {
+      LOG_ERROR("Unable to cast device to vtkPlusImageProcessorVideoSource");
+      return 1;
+    }
+
+    std::vector< vtkSmartPointer<vtkPlusSyntheticStageProcessor> > processors;
+    for (int stageIndex = 0; stageIndex < numberOfThroughputStages; ++stageIndex)
+    {
+      vtkSmartPointer<vtkPlusSyntheticStageProcessor> processor = vtkSmartPointer<vtkPlusSyntheticStageProcessor>::New();
+      processor->SetStageIndex(stageIndex);
+      processor->SetProcessingTimeMs(stageProcessingTimeMs);
+      if (processorDevice->AddProcessor(processor) != PLUS_SUCCESS)
+      {
+        LOG_ERROR("Unable to add processor to the image processor device");
+        return 1;
+      }
+      processors.push_back(processor);
+    }
+
+    if (dataCollector->Connect() != PLUS_SUCCESS || dataCollector->Start() != PLUS_SUCCESS)
+    {
+      LOG_ERROR("Failed to start data collection for the throughput test");
+      return 1;
+    }
+
+    // Wait until the queues are filled, so that all the stages are busy during the measurement
+    vtksys::SystemTools::Delay(static_cast<unsigned int>((maxStageQueueSize + 1) * numberOfThroughputStages * stageProcessingTimeMs + 1000));
+
+    const int numberOfOutputFramesAtStart = processors[numberOfThroughputStages - 1]->GetNumberOfProcessedFrames();
+    const double measurementStartTime = vtkPlusAccurateTimer::GetSystemTime();
+    vtksys::SystemTools::Delay(static_cast<unsigned int>(measurementTimeSec * 1000));
+    const int numberOfOutputFrames = processors[numberOfThroughputStages - 1]->GetNumberOfProcessedFrames() - numberOfOutputFramesAtStart;
+    const double measuredTimeSec = vtkPlusAccurateTimer::GetSystemTime() - measurementStartTime;
+
+    dataCollector->Stop();
+    dataCollector->Disconnect();
+
+    if (numberOfOutputFrames <= 0)
+    {
+      LOG_ERROR("No frames were processed by the last stage in " << measuredTimeSec << " sec");
+      return 1;
+    }
+    const double outputFramePeriodSec = measuredTimeSec / numberOfOutputFrames;
+    const double stageProcessingTimeSec = stageProcessingTimeMs / 1000.0;
+    LOG_INFO("Throughput: " << numberOfOutputFrames << " frames in " << measuredTimeSec << " sec, output frame period: " << outputFramePeriodSec
+             << " sec (processing time of a stage: " << stageProcessingTimeSec << " sec, sum of all stages: " << numberOfThroughputStages * stageProcessingTimeSec << " sec)");
+
+    int numberOfFailures = 0;
+    // Running the stages one after the other would give a frame period of at least the sum of the stage processing times
+    if (outputFramePeriodSec > 0.75 * numberOfThroughputStages * stageProcessingTimeSec)
+    {
+      LOG_ERROR("Output frame period (" << outputFramePeriodSec << " sec) is close to the sum of the stage processing times ("
+                << numberOfThroughputStages * stageProcessingTimeSec << " sec), the stages are not processing frames in parallel");
+      numberOfFailures++;
+    }
+    if (outputFramePeriodSec < 0.9 * stageProcessingTimeSec)
+    {
+      LOG_ERROR("Output frame period (" << outputFramePeriodSec << " sec) is shorter than the processing time of a stage (" << stageProcessingTimeSec << " sec)");
+      numberOfFailures++;
+    }
+    return numberOfFailures;
+  }
+}
+
+//----------------------------------------------------------------------------
+int main(int argc, char** argv)
+{
+  bool printHelp(false);
+  std::string inputSequenceFileName;
+  double inputAcqTimeLength(4.0);
+  double slowStageProcessingTimeMs(250.0);
+  double throughputStageProcessingTimeMs(150.0);
+  int maxStageQueueSize(2);
+  int verboseLevel = vtkPlusLogger::LOG_LEVEL_UNDEFINED;
+
+  vtksys::CommandLineArguments args;
+  args.Initialize(argc, argv);
+
+  args.AddArgument("--help", vtksys::CommandLineArguments::NO_ARGUMENT, &printHelp, "Print this help.");
+  args.AddArgument("--seq-file", vtksys::CommandLineArguments::EQUAL_ARGUMENT, &inputSequenceFileName, "Sequence file that is replayed as input of the processing.");
+  args.AddArgument("--acq-time-length", vtksys::CommandLineArguments::EQUAL_ARGUMENT, &inputAcqTimeLength, "Length of acquisition in seconds (Default: 4s)");
+  args.AddArgument("--slow-stage-processing-time-ms", vtksys::CommandLineArguments::EQUAL_ARGUMENT, &slowStageProcessingTimeMs, "Processing time of a frame in the slow stage, it must be longer than the frame period of the input (Default: 250ms)");
+  args.AddArgument("--throughput-stage-processing-time-ms", vtksys::CommandLineArguments::EQUAL_ARGUMENT, &throughputStageProcessingTimeMs, "Processing time of a frame in each stage of the throughput test, it must be longer than the frame period of the input (Default: 150ms)");
+  args.AddArgument("--max-stage-queue-size", vtksys::CommandLineArguments::EQUAL_ARGUMENT, &maxStageQueueSize, "Maximum number of frames in the queue of each stage (Default: 2)");
+  args.AddArgument("--verbose", vtksys::CommandLineArguments::EQUAL_ARGUMENT, &verboseLevel, "Verbose level (1=error only, 2=warning, 3=info, 4=debug, 5=trace)");
+
+  if (!args.Parse())
+  {
+    std::cerr << "Problem parsing arguments" << std::endl;
+    std::cout << "Help: " << args.GetHelp() << std::endl;
+    exit(EXIT_FAILURE);
+  }
+
+  if (printHelp)
+  {
+    std::cout << args.GetHelp() << std::endl;
+    exit(EXIT_SUCCESS);
+  }
+
+  vtkPlusLogger::Instance()->SetLogLevel(verboseLevel);
+
+  if (inputSequenceFileName.empty())
+  {
+    std::cerr << "--seq-file is required" << std::endl;
+    exit(EXIT_FAILURE);
+  }
+
+  vtkSmartPointer<vtkXMLDataElement> configRootElement = vtkSmartPointer<vtkXMLDataElement>::Take(
+        vtkXMLUtilities::ReadElementFromString(GetDeviceSetConfiguration(inputSequenceFileName, maxStageQueueSize).c_str()));
+  if (configRootElement.GetPointer() == NULL)
+  {
+    LOG_ERROR("Unable to parse the device set configuration");
+    exit(EXIT_FAILURE);
+  }
+  vtkPlusConfig::GetInstance()->SetDeviceSetConfigurationData(configRootElement);
+
+  vtkSmartPointer<vtkPlusDataCollector> dataCollector = vtkSmartPointer<vtkPlusDataCollector>::New();
+  if (dataCollector->ReadConfiguration(configRootElement) != PLUS_SUCCESS)
+  {
+    LOG_ERROR("Unable to configure data collector");
+    exit(EXIT_FAILURE);
+  }
+
+  vtkPlusDevice* device = NULL;
+  if (dataCollector->GetDevice(device, "ProcessorDevice") != PLUS_SUCCESS)
+  {
+    LOG_ERROR("Unable to locate the device with Id=\"ProcessorDevice\"");
+    exit(EXIT_FAILURE);
+  }
+  vtkPlusImageProcessorVideoSource* processorDevice = vtkPlusImageProcessorVideoSource::SafeDownCast(device);
+  if (processorDevice == NULL)
+  {
+    LOG_ERROR("Unable to cast device to vtkPlusImageProcessorVideoSource");
+    exit(EXIT_FAILURE);
+  }
+
+  // Fast - slow - fast processing chain
+  std::vector< vtkSmartPointer<vtkPlusSyntheticStageProcessor> > processors;
+  for (int stageIndex = 0; stageIndex < NUMBER_OF_STAGES; ++stageIndex)
+  {
+    vtkSmartPointer<vtkPlusSyntheticStageProcessor> processor = vtkSmartPointer<vtkPlusSyntheticStageProcessor>::New();
+    processor->SetStageIndex(stageIndex);
+    processor->SetProcessingTimeMs(stageIndex == SLOW_STAGE_INDEX ? slowStageProcessingTimeMs : 0.0);
+    if (processorDevice->AddProcessor(processor) != PLUS_SUCCESS)
+    {
+      LOG_ERROR("Unable to add processor to the image processor device");
+      exit(EXIT_FAILURE);
+    }
+    processors.push_back(processor);
+  }
+
+  if (dataCollector->Connect() != PLUS_SUCCESS)
+  {
+    LOG_ERROR("Failed to connect to data collector!");
+    exit(EXIT_FAILURE);
+  }
+
+  if (dataCollector->Start() != PLUS_SUCCESS)
+  {
+    LOG_ERROR("Failed to start data collection");
+    exit(EXIT_FAILURE);
+  }
+
+  int numberOfFailures(0);
+
+  if (processorDevice->GetNumberOfProcessingStages() != NUMBER_OF_STAGES)
+  {
+    LOG_ERROR("Number of processing stages is " << processorDevice->GetNumberOfProcessingStages() << ", expected " << NUMBER_OF_STAGES);
+    numberOfFailures++;
+  }
+
+  numberOfFailures += RunAcquisition(processorDevice, inputAcqTimeLength, maxStageQueueSize);
+
+  // Stop feeding the pipeline and wait until all the frames that are already in the pipeline are processed
+  processorDevice->SetEnableProcessing(false);
+  const double drainTimeoutSec = (maxStageQueueSize + 1) * NUMBER_OF_STAGES * slowStageProcessingTimeMs / 1000.0 + 5.0;
+  const double drainStartTime = vtkPlusAccurateTimer::GetSystemTime();
+  int numberOfIdleChecks = 0;
+  while (numberOfIdleChecks < 3 && drainStartTime + drainTimeoutSec > vtkPlusAccurateTimer::GetSystemTime())
+  {
+    numberOfIdleChecks = IsPipelineIdle(processorDevice, processors) ? numberOfIdleChecks + 1 : 0;
+    vtksys::SystemTools::Delay(50);
+  }
+  if (numberOfIdleChecks < 3)
+  {
+    LOG_ERROR("Frames are still being processed " << drainTimeoutSec << " sec after the input was stopped");
+    numberOfFailures++;
+  }
+
+  long numberOfInputFrames = processorDevice->GetNumberOfInputFrames();
+  long numberOfDroppedFrames = processorDevice->GetNumberOfDroppedFrames();
+  LOG_INFO("Input frames: " << numberOfInputFrames << ", dropped frames: " << numberOfDroppedFrames
+           << ", pipeline latency: " << processorDevice->GetPipelineLatencySec() << " sec");
+  for (int stageIndex = 0; stageIndex < NUMBER_OF_STAGES; ++stageIndex)
+  {
+    LOG_INFO("Stage " << stageIndex << ": processed frames: " << processors[stageIndex]->GetNumberOfProcessedFrames()
+             << ", latency: " << processorDevice->GetProcessingStageLatencySec(stageIndex) << " sec");
+  }
+
+  // Order of processing
+  for (int stageIndex = 0; stageIndex < NUMBER_OF_STAGES; ++stageIndex)
+  {
+    if (processors[stageIndex]->GetNumberOfOrderErrors() > 0 || processors[stageIndex]->GetNumberOfStageTraceErrors() > 0)
+    {
+      LOG_ERROR("Stage " << stageIndex << " received " << processors[stageIndex]->GetNumberOfOrderErrors() << " frames out of order and "
+                << processors[stageIndex]->GetNumberOfStageTraceErrors() << " frames that skipped a previous stage");
+      numberOfFailures++;
+    }
+  }
+
+  // Frame counts: only the input of the first stage may drop frames, the later stages wait for room in the queue
+  if (numberOfDroppedFrames <= 0)
+  {
+    LOG_ERROR("No frames were dropped, although stage " << SLOW_STAGE_INDEX << " is slower than the input");
+    numberOfFailures++;
+  }
+  if (processors[0]->GetNumberOfProcessedFrames() + numberOfDroppedFrames != numberOfInputFrames)
+  {
+    LOG_ERROR("Processed (" << processors[0]->GetNumberOfProcessedFrames() << ") and dropped (" << numberOfDroppedFrames
+              << ") frames of the first stage do not add up to the number of input frames (" << numberOfInputFrames << ")");
+    numberOfFailures++;
+  }
+  for (int stageIndex = 1; stageIndex < NUMBER_OF_STAGES; ++stageIndex)
+  {
+    if (processors[stageIndex]->GetNumberOfProcessedFrames() != processors[0]->GetNumberOfProcessedFrames())
+    {
+      LOG_ERROR("Stage " << stageIndex << " processed " << processors[stageIndex]->GetNumberOfProcessedFrames() << " frames, expected "
+                << processors[0]->GetNumberOfProcessedFrames() << " (all the frames processed by the first stage)");
+      numberOfFailures++;
+    }
+  }
+  vtkPlusChannel* outputChannel = NULL;
+  vtkPlusDataSource* outputSource = NULL;
+  if (processorDevice->GetOutputChannelByName(outputChannel, "ProcessedVideoStream") != PLUS_SUCCESS || outputChannel->GetVideoSource(outputSource) != PLUS_SUCCESS)
+  {
+    LOG_ERROR("Unable to get the output video source of the image processor device");
+    numberOfFailures++;
+  }
+  else if (outputSource->GetNumberOfItems() != processors[NUMBER_OF_STAGES - 1]->GetNumberOfProcessedFrames())
+  {
+    LOG_ERROR("Output buffer contains " << outputSource->GetNumberOfItems() << " frames, expected " << processors[NUMBER_OF_STAGES - 1]->GetNumberOfProcessedFrames());
+    numberOfFailures++;
+  }
+
+  // Latencies
+  double slowStageLatencySec = processorDevice->GetProcessingStageLatencySec(SLOW_STAGE_INDEX);
+  if (slowStageLatencySec < 0.8 * slowStageProcessingTimeMs / 1000.0)
+  {
+    LOG_ERROR("Latency of the slow stage is " << slowStageLatencySec << " sec, expected at least " << 0.8 * slowStageProcessingTimeMs / 1000.0 << " sec");
+    numberOfFailures++;
+  }
+  for (int stageIndex = 0; stageIndex < NUMBER_OF_STAGES; ++stageIndex)
+  {
+    if (stageIndex != SLOW_STAGE_INDEX && processorDevice->GetProcessingStageLatencySec(stageIndex) >= slowStageLatencySec)
+    {
+      LOG_ERROR("Latency of fast stage " << stageIndex << " (" << processorDevice->GetProcessingStageLatencySec(stageIndex)
+                << " sec) is not lower than the latency of the slow stage (" << slowStageLatencySec << " sec)");
+      numberOfFailures++;
+    }
+  }
+  if (processorDevice->GetPipelineLatencySec() < slowStageLatencySec)
+  {
+    LOG_ERROR("Pipeline latency (" << processorDevice->GetPipelineLatencySec() << " sec) is lower than the latency of the slow stage (" << slowStageLatencySec << " sec)");
+    numberOfFailures++;
+  }
+
+  // Fill the pipeline again and disconnect while the slow stage is busy and the other stages wait for it
+  processorDevice->SetEnableProcessing(true);
+  numberOfFailures += RunAcquisition(processorDevice, 1.0, maxStageQueueSize);
+
+  const double disconnectStartTime = vtkPlusAccurateTimer::GetSystemTime();
+  if (dataCollector->Stop() != PLUS_SUCCESS)
+  {
+    LOG_ERROR("Failed to stop data collection!");
+    numberOfFailures++;
+  }
+  dataCollector->Disconnect();
+  const double disconnectTimeSec = vtkPlusAccurateTimer::GetSystemTime() - disconnectStartTime;
+  LOG_INFO("Disconnect time: " << disconnectTimeSec << " sec");
+
+  // Disconnecting may wait for the frame that is being processed, but not for the frames in the queues
+  if (disconnectTimeSec > slowStageProcessingTimeMs / 1000.0 + 2.0)
+  {
+    LOG_ERROR("Disconnecting took " << disconnectTimeSec << " sec, the frames in the queues were probably processed instead of discarded");
+    numberOfFailures++;
+  }
+
+  std::vector<int> numberOfProcessedFramesAtDisconnect;
+  for (int stageIndex = 0; stageIndex < NUMBER_OF_STAGES; ++stageIndex)
+  {
+    if (processors[stageIndex]->GetNumberOfActiveUpdates() > 0)
+    {
+      LOG_ERROR("Stage " << stageIndex << " is still processing after the device is disconnected");
+      numberOfFailures++;
+    }
+    numberOfProcessedFramesAtDisconnect.push_back(processors[stageIndex]->GetNumberOfProcessedFrames());
+  }
+  vtksys::SystemTools::Delay(static_cast<unsigned int>(2 * slowStageProcessingTimeMs));
+  for (int stageIndex = 0; stageIndex < NUMBER_OF_STAGES; ++stageIndex)
+  {
+    if (processors[stageIndex]->GetNumberOfProcessedFrames() != numberOfProcessedFramesAtDisconnect[stageIndex])
+    {
+      LOG_ERROR("Stage " << stageIndex << " processed frames after the device was disconnected");
+      numberOfFailures++;
+    }
+  }
+
+  numberOfFailures += TestThroughput(inputSequenceFileName, throughputStageProcessingTimeMs, maxStageQueueSize);
+
+  if (numberOfFailures > 0)
+  {
+    LOG_ERROR("Number of failures: " << numberOfFailures);
+    return EXIT_FAILURE;
+  }
+
+  std::cout << "Test completed successfully!" << std::endl;
+  return EXIT_SUCCESS;
+}
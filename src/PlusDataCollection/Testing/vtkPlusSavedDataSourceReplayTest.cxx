@@ -0,0 +1,329 @@
+/*=Plus=header=begin======================================================
+Program: Plus
+Copyright (c) Laboratory for Percutaneous Surgery. All rights reserved.
+See License.txt for details.
+=========================================================Plus=header=end*/
+
+/*!
+  \file vtkPlusSavedDataSourceReplayTest.cxx
+  \brief Verifies the replay rate and the replay statistics of the saved data source
+
+  A sequence is replayed by a saved data source with the original timestamps, either at ReplaySpeed or at maximum rate,
+  while a consumer thread reads every frame of the output buffer (optionally slowly) and counts the frames that it missed.
+  The test checks that the replay rate matches ReplaySpeed, that the number of dropped frames reported by the device
+  equals the number of frames missed by the consumer, and that at maximum rate no frame is overwritten before it is read.
+*/
+
+// Local includes
+#include "PlusConfigure.h"
+#include "vtkPlusAccurateTimer.h"
+#include "vtkPlusBuffer.h"
+#include "vtkPlusDataCollector.h"
+#include "vtkPlusDataSource.h"
+#include "vtkPlusSavedDataSource.h"
+
+// VTK includes
+#include <vtkSmartPointer.h>
+#include <vtkXMLDataElement.h>
+#include <vtkXMLUtilities.h>
+#include <vtksys/CommandLineArguments.hxx>
+#include <vtksys/SystemTools.hxx>
+
+// STL includes
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <thread>
+
+namespace
+{
+  const double RATE_MEASUREMENT_START_SEC = 1.0; // the replay rate is measured after this time, when replay is in steady state
+  const double REPLAY_RATE_TOLERANCE = 0.25;
+
+  //----------------------------------------------------------------------------
+  std::string GetDeviceSetConfiguration(const std::string& sequenceFileName, bool replayAtMaximumRate, double replaySpeed, int bufferSize)
+  {
+    std::ostringstream config;
+    config << "<PlusConfiguration version=\"2.1\">" << std::endl
+           << "  <DataCollection StartupDelaySec=\"1.0\">" << std::endl
+           << "    <DeviceSet Name=\"Saved data source replay test\" Description=\"Replays a sequence at ReplaySpeed or at maximum rate\" />" << std::endl
+           << "    <Device Id=\"ReplayDevice\" Type=\"SavedDataSource\" SequenceFile=\"" << sequenceFileName << "\" UseData=\"IMAGE\" UseOriginalTimestamps=\"TRUE\" RepeatEnabled=\"TRUE\"";
+    if (replayAtMaximumRate)
+    {
+      config << " ReplayAtMaximumRate=\"TRUE\"";
+    }
+    else
+    {
+      config << " ReplaySpeed=\"" << replaySpeed << "\"";
+    }
+    config << ">" << std::endl
+           << "      <DataSources>" << std::endl
+           << "        <DataSource Type=\"Video\" Id=\"Video\" BufferSize=\"" << bufferSize << "\" PortUsImageOrientation=\"MF\" />" << std::endl
+           << "      </DataSources>" << std::endl
+           << "      <OutputChannels>" << std::endl
+           << "        <OutputChannel Id=\"VideoStream\" VideoDataSourceId=\"Video\" />" << std::endl
+           << "      </OutputChannels>" << std::endl
+           << "    </Device>" << std::endl
+           << "  </DataCollection>" << std::endl
+           << "</PlusConfiguration>" << std::endl;
+    return config.str();
+  }
+
+  //----------------------------------------------------------------------------
+  struct ConsumerState
+  {
+    ConsumerState() : StopRequested(false), NumberOfReadFrames(0), NumberOfMissedFrames(0) {}
+    std::atomic<bool> StopRequested;
+    long NumberOfReadFrames;
+    long NumberOfMissedFrames;
+  };
+
+  //----------------------------------------------------------------------------
+  // Reads every frame of the output buffer in order, until stop is requested and all the frames have been read.
+  // Frames that were overwritten before they could be read are counted as missed.
+  void ConsumeFrames(vtkPlusDataSource* videoSource, double frameDelaySec, ConsumerState* state)
+  {
+    BufferItemUidType nextUid = 0;
+    bool firstFrame = true;
+    while (true)
+    {
+      if (videoSource->GetNumberOfItems() == 0 || (!firstFrame && nextUid > videoSource->GetLatestItemUidInBuffer()))
+      {
+        // all the frames have been read
+        if (state->StopRequested)
+        {
+          break;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        continue;
+      }
+
+      BufferItemUidType oldestUid = videoSource->GetOldestItemUidInBuffer();
+      if (firstFrame)
+      {
+        // start from the oldest frame that is available when the consumer starts
+        nextUid = oldestUid;
+      }
+      else if (nextUid < oldestUid)
+      {
+        state->NumberOfMissedFrames += static_cast<long>(oldestUid - nextUid);
+        nextUid = oldestUid;
+      }
+
+      StreamBufferItem item;
+      if (videoSource->GetStreamBufferItemView(nextUid, &item) != ITEM_OK)
+      {
+        // the frame has been overwritten meanwhile, it is counted as missed in the next iteration
+        continue;
+      }
+      firstFrame = false;
+      state->NumberOfReadFrames++;
+      nextUid++;
+
+      if (frameDelaySec > 0)
+      {
+        std::this_thread::sleep_for(std::chrono::duration<double>(frameDelaySec));
+      }
+    }
+  }
+}
+
+//----------------------------------------------------------------------------
+int main(int argc, char** argv)
+{
+  bool printHelp(false);
+  std::string inputSequenceFileName;
+  double acqTimeLength(3.0);
+  double replaySpeed(1.0);
+  bool replayAtMaximumRate(false);
+  int bufferSize(100);
+  int consumerDelayMs(0);
+  bool slowConsumer(false);
+  int verboseLevel = vtkPlusLogger::LOG_LEVEL_UNDEFINED;
+
+  vtksys::CommandLineArguments args;
+  args.Initialize(argc, argv);
+
+  args.AddArgument("--help", vtksys::CommandLineArguments::NO_ARGUMENT, &printHelp, "Print this help.");
+  args.AddArgument("--seq-file", vtksys::CommandLineArguments::EQUAL_ARGUMENT, &inputSequenceFileName, "Sequence file that is replayed.");
+  args.AddArgument("--acq-time-length", vtksys::CommandLineArguments::EQUAL_ARGUMENT, &acqTimeLength, "Length of replay in seconds (Default: 3s)");
+  args.AddArgument("--replay-speed", vtksys::CommandLineArguments::EQUAL_ARGUMENT, &replaySpeed, "Replay speed relative to the recording (Default: 1.0)");
+  args.AddArgument("--maximum-rate", vtksys::CommandLineArguments::NO_ARGUMENT, &replayAtMaximumRate, "Replay the frames at maximum rate instead of at replay speed.");
+  args.AddArgument("--buffer-size", vtksys::CommandLineArguments::EQUAL_ARGUMENT, &bufferSize, "Size of the output buffer (Default: 100)");
+  args.AddArgument("--consumer-delay-ms", vtksys::CommandLineArguments::EQUAL_ARGUMENT, &consumerDelayMs, "Time the consumer spends on each frame, in milliseconds (Default: 0)");
+  args.AddArgument("--slow-consumer", vtksys::CommandLineArguments::NO_ARGUMENT, &slowConsumer, "The consumer reads the frames at a quarter of the replay rate, so frames are expected to be dropped.");
+  args.AddArgument("--verbose", vtksys::CommandLineArguments::EQUAL_ARGUMENT, &verboseLevel, "Verbose level (1=error only, 2=warning, 3=info, 4=debug, 5=trace)");
+
+  if (!args.Parse())
+  {
+    std::cerr << "Problem parsing arguments" << std::endl;
+    std::cout << "Help: " << args.GetHelp() << std::endl;
+    exit(EXIT_FAILURE);
+  }
+
+  if (printHelp)
+  {
+    std::cout << args.GetHelp() << std::endl;
+    exit(EXIT_SUCCESS);
+  }
+
+  vtkPlusLogger::Instance()->SetLogLevel(verboseLevel);
+
+  if (inputSequenceFileName.empty())
+  {
+    std::cerr << "--seq-file is required" << std::endl;
+    exit(EXIT_FAILURE);
+  }
+  if (slowConsumer && replayAtMaximumRate)
+  {
+    std::cerr << "--slow-consumer cannot be used with --maximum-rate, replay at maximum rate follows the consumer" << std::endl;
+    exit(EXIT_FAILURE);
+  }
+
+  vtkSmartPointer<vtkXMLDataElement> configRootElement = vtkSmartPointer<vtkXMLDataElement>::Take(
+        vtkXMLUtilities::ReadElementFromString(GetDeviceSetConfiguration(inputSequenceFileName, replayAtMaximumRate, replaySpeed, bufferSize).c_str()));
+  if (configRootElement.GetPointer() == NULL)
+  {
+    LOG_ERROR("Unable to parse the device set configuration");
+    exit(EXIT_FAILURE);
+  }
+  vtkPlusConfig::GetInstance()->SetDeviceSetConfigurationData(configRootElement);
+
+  vtkSmartPointer<vtkPlusDataCollector> dataCollector = vtkSmartPointer<vtkPlusDataCollector>::New();
+  if (dataCollector->ReadConfiguration(configRootElement) != PLUS_SUCCESS)
+  {
+    LOG_ERROR("Unable to configure data collector");
+    exit(EXIT_FAILURE);
+  }
+
+  vtkPlusDevice* device = NULL;
+  if (dataCollector->GetDevice(device, "ReplayDevice") != PLUS_SUCCESS)
+  {
+    LOG_ERROR("Unable to locate the device with Id=\"ReplayDevice\"");
+    exit(EXIT_FAILURE);
+  }
+  vtkPlusSavedDataSource* savedDataSource = vtkPlusSavedDataSource::SafeDownCast(device);
+  if (savedDataSource == NULL)
+  {
+    LOG_ERROR("Unable to cast device ReplayDevice to vtkPlusSavedDataSource");
+    exit(EXIT_FAILURE);
+  }
+  vtkPlusDataSource* videoSource = NULL;
+  if (savedDataSource->GetFirstVideoSource(videoSource) != PLUS_SUCCESS)
+  {
+    LOG_ERROR("No video source in device ReplayDevice");
+    exit(EXIT_FAILURE);
+  }
+
+  if (dataCollector->Connect() != PLUS_SUCCESS)
+  {
+    LOG_ERROR("Failed to connect to data collector!");
+    exit(EXIT_FAILURE);
+  }
+
+  const double recordedFrameRate = savedDataSource->GetLocalVideoBuffer()->GetFrameRate();
+  if (recordedFrameRate <= 0)
+  {
+    LOG_ERROR("Invalid frame rate of the recording: " << recordedFrameRate);
+    exit(EXIT_FAILURE);
+  }
+  double consumerFrameDelaySec = consumerDelayMs * 0.001;
+  if (slowConsumer)
+  {
+    consumerFrameDelaySec = 4.0 / (recordedFrameRate * replaySpeed);
+  }
+  LOG_INFO("Recorded frame rate: " << recordedFrameRate << " fps, consumer time per frame: " << consumerFrameDelaySec * 1000.0 << " ms");
+
+  // The consumer is started first, so that it reads from the first replayed frame. Until it has read a frame,
+  // replay at maximum rate is not paced by it and could overwrite frames.
+  ConsumerState consumerState;
+  std::thread consumerThread(ConsumeFrames, videoSource, consumerFrameDelaySec, &consumerState);
+
+  if (dataCollector->Start() != PLUS_SUCCESS)
+  {
+    LOG_ERROR("Failed to start data collection!");
+    consumerState.StopRequested = true;
+    consumerThread.join();
+    exit(EXIT_FAILURE);
+  }
+
+  // Measure the replay rate in steady state
+  vtksys::SystemTools::Delay(static_cast<unsigned int>(RATE_MEASUREMENT_START_SEC * 1000));
+  const long replayedFramesAtMeasurementStart = savedDataSource->GetNumberOfReplayedFrames();
+  const double measurementStartTime = vtkPlusAccurateTimer::GetSystemTime();
+  vtksys::SystemTools::Delay(static_cast<unsigned int>(std::max(acqTimeLength - RATE_MEASUREMENT_START_SEC, 1.0) * 1000));
+  const double replayRate = (savedDataSource->GetNumberOfReplayedFrames() - replayedFramesAtMeasurementStart) / (vtkPlusAccurateTimer::GetSystemTime() - measurementStartTime);
+
+  if (dataCollector->Stop() != PLUS_SUCCESS)
+  {
+    LOG_ERROR("Failed to stop data collection!");
+    exit(EXIT_FAILURE);
+  }
+
+  // Let the consumer read the rest of the frames
+  consumerState.StopRequested = true;
+  consumerThread.join();
+
+  const long numberOfReplayedFrames = savedDataSource->GetNumberOfReplayedFrames();
+  const long numberOfDroppedFrames = savedDataSource->GetNumberOfDroppedFrames();
+  LOG_INFO("Replay rate: " << replayRate << " fps, replayed frames: " << numberOfReplayedFrames << ", dropped frames: " << numberOfDroppedFrames
+           << ", frames read by the consumer: " << consumerState.NumberOfReadFrames << ", frames missed by the consumer: " << consumerState.NumberOfMissedFrames);
+
+  int numberOfFailures(0);
+
+  if (numberOfDroppedFrames != consumerState.NumberOfMissedFrames)
+  {
+    LOG_ERROR("The number of dropped frames (" << numberOfDroppedFrames << ") differs from the number of frames missed by the consumer (" << consumerState.NumberOfMissedFrames << ")");
+    numberOfFailures++;
+  }
+  if (slowConsumer && numberOfDroppedFrames == 0)
+  {
+    LOG_ERROR("Frames are expected to be dropped with a slow consumer");
+    numberOfFailures++;
+  }
+  if (!slowConsumer && numberOfDroppedFrames != 0)
+  {
+    LOG_ERROR("No frames are expected to be dropped, dropped frames: " << numberOfDroppedFrames);
+    numberOfFailures++;
+  }
+
+  if (replayAtMaximumRate)
+  {
+    // Replay waits for the consumer, so the consumer reads every replayed frame
+    if (consumerState.NumberOfReadFrames != numberOfReplayedFrames)
+    {
+      LOG_ERROR("The consumer read " << consumerState.NumberOfReadFrames << " of the " << numberOfReplayedFrames << " frames replayed at maximum rate");
+      numberOfFailures++;
+    }
+    if (replayRate <= recordedFrameRate)
+    {
+      LOG_ERROR("Replay rate at maximum rate (" << replayRate << " fps) is not faster than the recorded frame rate (" << recordedFrameRate << " fps)");
+      numberOfFailures++;
+    }
+  }
+  else
+  {
+    const double expectedReplayRate = recordedFrameRate * replaySpeed;
+    if (fabs(replayRate - expectedReplayRate) > expectedReplayRate * REPLAY_RATE_TOLERANCE)
+    {
+      LOG_ERROR("Replay rate (" << replayRate << " fps) differs from the expected replay rate (" << expectedReplayRate << " fps)");
+      numberOfFailures++;
+    }
+  }
+
+  if (dataCollector->Disconnect() != PLUS_SUCCESS)
+  {
+    LOG_ERROR("Failed to disconnect from data collector!");
+    numberOfFailures++;
+  }
+
+  if (numberOfFailures > 0)
+  {
+    LOG_ERROR("Number of failures: " << numberOfFailures);
+    return EXIT_FAILURE;
+  }
+
+  std::cout << "Test completed successfully!" << std::endl;
+  return EXIT_SUCCESS;
+}
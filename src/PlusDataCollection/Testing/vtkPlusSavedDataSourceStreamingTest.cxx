@@ -0,0 +1,309 @@
+/*=Plus=header=begin======================================================
+Program: Plus
+Copyright (c) Laboratory for Percutaneous Surgery. All rights reserved.
+See License.txt for details.
+=========================================================Plus=header=end*/
+
+/*!
+  \file vtkPlusSavedDataSourceStreamingTest.cxx
+  \brief Verifies that replay with StreamFromFile produces the same frames as replay of the fully read file
+
+  The same sequence is replayed by two saved data source devices with RepeatEnabled, one of them reads the whole file
+  on connect, the other one reads the images from the file during replay, through a read-ahead window that is smaller
+  than the sequence. The devices are updated one frame at a time, so the replayed frame sequences are deterministic.
+  The test checks that the outputs are identical, that replay continues with the first frame after the last one,
+  and that after SetLoopTimeRange only the frames of the new range are replayed, also repeatedly.
+*/
+
+// Local includes
+#include "PlusConfigure.h"
+#include "PlusTrackedFrame.h"
+#include "vtkPlusDataCollector.h"
+#include "vtkPlusDataSource.h"
+#include "vtkPlusSavedDataSource.h"
+#include "vtkPlusSequenceIO.h"
+#include "vtkPlusTrackedFrameList.h"
+
+// VTK includes
+#include <vtkSmartPointer.h>
+#include <vtkXMLDataElement.h>
+#include <vtkXMLUtilities.h>
+#include <vtksys/CommandLineArguments.hxx>
+#include <vtksys/SystemTools.hxx>
+
+// STL includes
+#include <cstring>
+
+namespace
+{
+  //----------------------------------------------------------------------------
+  std::string GetSavedDataSourceConfiguration(const std::string& deviceId, const std::string& sequenceFileName, bool streamFromFile, int readAheadFrames, int bufferSize)
+  {
+    std::ostringstream config;
+    config << "    <Device Id=\"" << deviceId << "\" Type=\"SavedDataSource\" SequenceFile=\"" << sequenceFileName << "\" UseData=\"IMAGE\" UseOriginalTimestamps=\"FALSE\" RepeatEnabled=\"TRUE\""
+           << " StreamFromFile=\"" << (streamFromFile ? "TRUE" : "FALSE") << "\" ReadAheadFrames=\"" << readAheadFrames << "\">" << std::endl
+           << "      <DataSources>" << std::endl
+           << "        <DataSource Type=\"Video\" Id=\"" << deviceId << "Video\" BufferSize=\"" << bufferSize << "\" AveragedItemsForFiltering=\"1\" PortUsImageOrientation=\"MF\" />" << std::endl
+           << "      </DataSources>" << std::endl
+           << "      <OutputChannels>" << std::endl
+           << "        <OutputChannel Id=\"" << deviceId << "Stream\" VideoDataSourceId=\"" << deviceId << "Video\" />" << std::endl
+           << "      </OutputChannels>" << std::endl
+           << "    </Device>" << std::endl;
+    return config.str();
+  }
+
+  //----------------------------------------------------------------------------
+  std::string GetDeviceSetConfiguration(const std::string& sequenceFileName, int readAheadFrames, int bufferSize)
+  {
+    std::ostringstream config;
+    config << "<PlusConfiguration version=\"2.1\">" << std::endl
+           << "  <DataCollection StartupDelaySec=\"1.0\">" << std::endl
+           << "    <DeviceSet Name=\"Saved data source streaming test\" Description=\"Replays the same sequence with and without streaming from file\" />" << std::endl
+           << GetSavedDataSourceConfiguration("FullReadDevice", sequenceFileName, false, readAheadFrames, bufferSize)
+           << GetSavedDataSourceConfiguration("StreamedDevice", sequenceFileName, true, readAheadFrames, bufferSize)
+           << "  </DataCollection>" << std::endl
+           << "</PlusConfiguration>" << std::endl;
+    return config.str();
+  }
+
+  //----------------------------------------------------------------------------
+  vtkPlusSavedDataSource* GetSavedDataSource(vtkPlusDataCollector* dataCollector, const std::string& deviceId)
+  {
+    vtkPlusDevice* device = NULL;
+    if (dataCollector->GetDevice(device, deviceId) != PLUS_SUCCESS)
+    {
+      LOG_ERROR("Unable to locate the device with Id=\"" << deviceId << "\"");
+      return NULL;
+    }
+    vtkPlusSavedDataSource* savedDataSource = vtkPlusSavedDataSource::SafeDownCast(device);
+    if (savedDataSource == NULL)
+    {
+      LOG_ERROR("Unable to cast device " << deviceId << " to vtkPlusSavedDataSource");
+    }
+    return savedDataSource;
+  }
+
+  //----------------------------------------------------------------------------
+  // Adds one frame to the output of each device per update
+  int ReplayFrames(vtkPlusSavedDataSource* fullReadDevice, vtkPlusSavedDataSource* streamedDevice, int numberOfFrames)
+  {
+    int numberOfFailures = 0;
+    for (int i = 0; i < numberOfFrames; ++i)
+    {
+      if (fullReadDevice->ForceUpdate() != PLUS_SUCCESS || streamedDevice->ForceUpdate() != PLUS_SUCCESS)
+      {
+        LOG_ERROR("Failed to replay frame " << i);
+        numberOfFailures++;
+      }
+      // The output items are timestamped with the current time, which must increase between the items
+      vtksys::SystemTools::Delay(2);
+    }
+    return numberOfFailures;
+  }
+
+  //----------------------------------------------------------------------------
+  PlusStatus GetOutputFrame(vtkPlusSavedDataSource* device, int outputIndex, StreamBufferItem& item)
+  {
+    vtkPlusDataSource* videoSource = NULL;
+    if (device->GetFirstVideoSource(videoSource) != PLUS_SUCCESS)
+    {
+      LOG_ERROR("No video source in device " << device->GetDeviceId());
+      return PLUS_FAIL;
+    }
+    if (videoSource->GetStreamBufferItem(videoSource->GetOldestItemUidInBuffer() + outputIndex, &item) != ITEM_OK || !item.GetFrame().IsImageValid())
+    {
+      LOG_ERROR("Unable to get output frame " << outputIndex << " of device " << device->GetDeviceId());
+      return PLUS_FAIL;
+    }
+    return PLUS_SUCCESS;
+  }
+
+  //----------------------------------------------------------------------------
+  bool IsImageDataEqual(PlusVideoFrame& frame1, PlusVideoFrame& frame2)
+  {
+    return frame1.GetFrameSizeInBytes() == frame2.GetFrameSizeInBytes()
+           && memcmp(frame1.GetScalarPointer(), frame2.GetScalarPointer(), frame1.GetFrameSizeInBytes()) == 0;
+  }
+
+  //----------------------------------------------------------------------------
+  // Compares the output frame at outputIndex with the output frame at expectedOutputIndex
+  int CompareOutputFrames(vtkPlusSavedDataSource* device, int outputIndex, vtkPlusSavedDataSource* expectedDevice, int expectedOutputIndex)
+  {
+    StreamBufferItem item;
+    StreamBufferItem expectedItem;
+    if (GetOutputFrame(device, outputIndex, item) != PLUS_SUCCESS || GetOutputFrame(expectedDevice, expectedOutputIndex, expectedItem) != PLUS_SUCCESS)
+    {
+      return 1;
+    }
+    if (!IsImageDataEqual(item.GetFrame(), expectedItem.GetFrame()))
+    {
+      LOG_ERROR("Output frame " << outputIndex << " of " << device->GetDeviceId() << " differs from output frame " << expectedOutputIndex << " of " << expectedDevice->GetDeviceId());
+      return 1;
+    }
+    return 0;
+  }
+}
+
+//----------------------------------------------------------------------------
+int main(int argc, char** argv)
+{
+  bool printHelp(false);
+  std::string inputSequenceFileName;
+  int readAheadFrames(4);
+  int verboseLevel = vtkPlusLogger::LOG_LEVEL_UNDEFINED;
+
+  vtksys::CommandLineArguments args;
+  args.Initialize(argc, argv);
+
+  args.AddArgument("--help", vtksys::CommandLineArguments::NO_ARGUMENT, &printHelp, "Print this help.");
+  args.AddArgument("--seq-file", vtksys::CommandLineArguments::EQUAL_ARGUMENT, &inputSequenceFileName, "Uncompressed sequence file that is replayed.");
+  args.AddArgument("--read-ahead-frames", vtksys::CommandLineArguments::EQUAL_ARGUMENT, &readAheadFrames, "Number of frames read ahead of replay by the streaming device (Default: 4)");
+  args.AddArgument("--verbose", vtksys::CommandLineArguments::EQUAL_ARGUMENT, &verboseLevel, "Verbose level (1=error only, 2=warning, 3=info, 4=debug, 5=trace)");
+
+  if (!args.Parse())
+  {
+    std::cerr << "Problem parsing arguments" << std::endl;
+    std::cout << "Help: " << args.GetHelp() << std::endl;
+    exit(EXIT_FAILURE);
+  }
+
+  if (printHelp)
+  {
+    std::cout << args.GetHelp() << std::endl;
+    exit(EXIT_SUCCESS);
+  }
+
+  vtkPlusLogger::Instance()->SetLogLevel(verboseLevel);
+
+  if (inputSequenceFileName.empty())
+  {
+    std::cerr << "--seq-file is required" << std::endl;
+    exit(EXIT_FAILURE);
+  }
+
+  // The timestamps of the file are needed for setting the loop range
+  vtkSmartPointer<vtkPlusTrackedFrameList> inputFrames = vtkSmartPointer<vtkPlusTrackedFrameList>::New();
+  if (vtkPlusSequenceIO::Read(inputSequenceFileName, inputFrames) != PLUS_SUCCESS)
+  {
+    LOG_ERROR("Unable to read the sequence file: " << inputSequenceFileName);
+    exit(EXIT_FAILURE);
+  }
+  const int numberOfInputFrames = inputFrames->GetNumberOfTrackedFrames();
+  if (numberOfInputFrames < 3)
+  {
+    LOG_ERROR("The sequence file must contain at least 3 frames, found: " << numberOfInputFrames);
+    exit(EXIT_FAILURE);
+  }
+
+  // Loop range in the middle of the sequence, it starts and ends exactly at a frame
+  const int loopFirstFrameIndex = numberOfInputFrames / 4;
+  const int loopLastFrameIndex = numberOfInputFrames - 1 - numberOfInputFrames / 4;
+  const int numberOfLoopFrames = loopLastFrameIndex - loopFirstFrameIndex + 1;
+
+  // Full sequence replayed twice and one more frame, then the loop range replayed twice and one more frame
+  const int numberOfFullReplayFrames = 2 * numberOfInputFrames + 1;
+  const int numberOfLoopReplayFrames = 2 * numberOfLoopFrames + 1;
+  const int bufferSize = numberOfFullReplayFrames + numberOfLoopReplayFrames;
+
+  vtkSmartPointer<vtkXMLDataElement> configRootElement = vtkSmartPointer<vtkXMLDataElement>::Take(
+        vtkXMLUtilities::ReadElementFromString(GetDeviceSetConfiguration(inputSequenceFileName, readAheadFrames, bufferSize).c_str()));
+  if (configRootElement.GetPointer() == NULL)
+  {
+    LOG_ERROR("Unable to parse the device set configuration");
+    exit(EXIT_FAILURE);
+  }
+  vtkPlusConfig::GetInstance()->SetDeviceSetConfigurationData(configRootElement);
+
+  vtkSmartPointer<vtkPlusDataCollector> dataCollector = vtkSmartPointer<vtkPlusDataCollector>::New();
+  if (dataCollector->ReadConfiguration(configRootElement) != PLUS_SUCCESS)
+  {
+    LOG_ERROR("Unable to configure data collector");
+    exit(EXIT_FAILURE);
+  }
+
+  vtkPlusSavedDataSource* fullReadDevice = GetSavedDataSource(dataCollector, "FullReadDevice");
+  vtkPlusSavedDataSource* streamedDevice = GetSavedDataSource(dataCollector, "StreamedDevice");
+  if (fullReadDevice == NULL || streamedDevice == NULL)
+  {
+    exit(EXIT_FAILURE);
+  }
+
+  if (dataCollector->Connect() != PLUS_SUCCESS)
+  {
+    LOG_ERROR("Failed to connect to data collector!");
+    exit(EXIT_FAILURE);
+  }
+
+  int numberOfFailures(0);
+
+  // Replay the full sequence, data acquisition is not started so that the devices are only updated here
+  LOG_INFO("Replay " << numberOfFullReplayFrames << " frames of the sequence of " << numberOfInputFrames << " frames");
+  numberOfFailures += ReplayFrames(fullReadDevice, streamedDevice, numberOfFullReplayFrames);
+
+  // Change the loop range and replay it
+  LOG_INFO("Replay " << numberOfLoopReplayFrames << " frames of the loop range of frames " << loopFirstFrameIndex << "-" << loopLastFrameIndex);
+  const double loopStartTime = inputFrames->GetTrackedFrame(loopFirstFrameIndex)->GetTimestamp();
+  const double loopStopTime = inputFrames->GetTrackedFrame(loopLastFrameIndex)->GetTimestamp();
+  fullReadDevice->SetLoopTimeRange(loopStartTime, loopStopTime);
+  streamedDevice->SetLoopTimeRange(loopStartTime, loopStopTime);
+  numberOfFailures += ReplayFrames(fullReadDevice, streamedDevice, numberOfLoopReplayFrames);
+
+  vtkPlusDataSource* fullReadVideoSource = NULL;
+  vtkPlusDataSource* streamedVideoSource = NULL;
+  if (fullReadDevice->GetFirstVideoSource(fullReadVideoSource) != PLUS_SUCCESS || streamedDevice->GetFirstVideoSource(streamedVideoSource) != PLUS_SUCCESS)
+  {
+    LOG_ERROR("Unable to get the output video sources");
+    exit(EXIT_FAILURE);
+  }
+  if (fullReadVideoSource->GetNumberOfItems() != bufferSize || streamedVideoSource->GetNumberOfItems() != bufferSize)
+  {
+    LOG_ERROR("Unexpected number of replayed frames: " << fullReadVideoSource->GetNumberOfItems() << " without and " << streamedVideoSource->GetNumberOfItems()
+              << " with streaming from file (expected: " << bufferSize << ")");
+    numberOfFailures++;
+  }
+  else
+  {
+    int numberOfDifferences = 0;
+    for (int outputIndex = 0; outputIndex < bufferSize; ++outputIndex)
+    {
+      // Streaming from file must not change the replayed images
+      numberOfDifferences += CompareOutputFrames(streamedDevice, outputIndex, fullReadDevice, outputIndex);
+
+      if (outputIndex < numberOfFullReplayFrames)
+      {
+        // After the last frame replay continues with the first frame
+        if (outputIndex >= numberOfInputFrames)
+        {
+          numberOfDifferences += CompareOutputFrames(streamedDevice, outputIndex, streamedDevice, outputIndex - numberOfInputFrames);
+        }
+      }
+      else
+      {
+        // Only the frames of the loop range are replayed, starting from the first frame of the range.
+        // The first numberOfInputFrames output frames are the frames of the file in order.
+        const int loopReplayIndex = outputIndex - numberOfFullReplayFrames;
+        numberOfDifferences += CompareOutputFrames(streamedDevice, outputIndex, streamedDevice, loopFirstFrameIndex + loopReplayIndex % numberOfLoopFrames);
+      }
+    }
+    if (numberOfDifferences > 0)
+    {
+      LOG_ERROR("Number of differing output frames: " << numberOfDifferences);
+      numberOfFailures++;
+    }
+  }
+
+  if (dataCollector->Disconnect() != PLUS_SUCCESS)
+  {
+    LOG_ERROR("Failed to disconnect from data collector!");
+    numberOfFailures++;
+  }
+
+  if (numberOfFailures > 0)
+  {
+    LOG_ERROR("Number of failures: " << numberOfFailures);
+    return EXIT_FAILURE;
+  }
+
+  std::cout << "Test completed successfully!" << std::endl;
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,145 @@
+/*=Plus=header=begin======================================================
+Program: Plus
+Copyright (c) Laboratory for Percutaneous Surgery. All rights reserved.
+See License.txt for details.
+=========================================================Plus=header=end*/
+
+/*!
+  \file vtkPlusV4L2VideoSourceTest.cxx
+  \brief Acquires frames from a V4L2 device with the requested I/O method and checks that frames are added to the video source.
+  Intended to be run against the vivid virtual video test driver (modprobe vivid), so no real capture hardware is needed.
+*/
+
+// Local includes
+#include "PlusConfigure.h"
+#include "vtkPlusDataCollector.h"
+#include "vtkPlusDataSource.h"
+#include "vtkPlusDevice.h"
+
+// VTK includes
+#include <vtkSmartPointer.h>
+#include <vtkXMLUtilities.h>
+#include <vtksys/CommandLineArguments.hxx>
+#include <vtksys/SystemTools.hxx>
+
+namespace
+{
+  //----------------------------------------------------------------------------
+  std::string GetConfiguration(const std::string& deviceName, const std::string& ioMethod, int queueDepth)
+  {
+    std::ostringstream config;
+    config << "<PlusConfiguration version=\"2.1\">" << std::endl
+           << "  <DataCollection StartupDelaySec=\"0\">" << std::endl
+           << "    <DeviceSet Name=\"V4L2 video source test\" Description=\"Acquisition from a V4L2 device using " << ioMethod << "\" />" << std::endl
+           << "    <Device Id=\"VideoDevice\" Type=\"V4L2Video\" DeviceName=\"" << deviceName << "\" IOMethod=\"" << ioMethod << "\" QueueDepth=\"" << queueDepth << "\">" << std::endl
+           << "      <DataSources>" << std::endl
+           << "        <DataSource Type=\"Video\" Id=\"Video\" PortUsImageOrientation=\"MF\" BufferSize=\"50\" />" << std::endl
+           << "      </DataSources>" << std::endl
+           << "      <OutputChannels>" << std::endl
+           << "        <OutputChannel Id=\"VideoStream\" VideoDataSourceId=\"Video\" />" << std::endl
+           << "      </OutputChannels>" << std::endl
+           << "    </Device>" << std::endl
+           << "  </DataCollection>" << std::endl
+           << "</PlusConfiguration>" << std::endl;
+    return config.str();
+  }
+}
+
+//----------------------------------------------------------------------------
+int main(int argc, char** argv)
+{
+  bool printHelp(false);
+  std::string deviceName("/dev/video0");
+  std::string ioMethod("IO_METHOD_READ");
+  int queueDepth(4);
+  double acquisitionTimeSec(2.0);
+  int verboseLevel = vtkPlusLogger::LOG_LEVEL_UNDEFINED;
+
+  vtksys::CommandLineArguments args;
+  args.Initialize(argc, argv);
+
+  args.AddArgument("--help", vtksys::CommandLineArguments::NO_ARGUMENT, &printHelp, "Print this help.");
+  args.AddArgument("--device-name", vtksys::CommandLineArguments::EQUAL_ARGUMENT, &deviceName, "V4L2 device node (Default: /dev/video0)");
+  args.AddArgument("--io-method", vtksys::CommandLineArguments::EQUAL_ARGUMENT, &ioMethod, "I/O method: IO_METHOD_READ, IO_METHOD_MMAP, IO_METHOD_USERPTR or IO_METHOD_DMABUF (Default: IO_METHOD_READ)");
+  args.AddArgument("--queue-depth", vtksys::CommandLineArguments::EQUAL_ARGUMENT, &queueDepth, "Number of buffers requested in the streaming I/O methods (Default: 4)");
+  args.AddArgument("--acquisition-time-sec", vtksys::CommandLineArguments::EQUAL_ARGUMENT, &acquisitionTimeSec, "Duration of the acquisition (Default: 2)");
+  args.AddArgument("--verbose", vtksys::CommandLineArguments::EQUAL_ARGUMENT, &verboseLevel, "Verbose level (1=error only, 2=warning, 3=info, 4=debug, 5=trace)");
+
+  if (!args.Parse())
+  {
+    std::cerr << "Problem parsing arguments" << std::endl;
+    std::cout << "Help: " << args.GetHelp() << std::endl;
+    exit(EXIT_FAILURE);
+  }
+
+  if (printHelp)
+  {
+    std::cout << args.GetHelp() << std::endl;
+    exit(EXIT_SUCCESS);
+  }
+
+  vtkPlusLogger::Instance()->SetLogLevel(verboseLevel);
+
+  vtkSmartPointer<vtkXMLDataElement> configRootElement = vtkSmartPointer<vtkXMLDataElement>::Take(vtkXMLUtilities::ReadElementFromString(GetConfiguration(deviceName, ioMethod, queueDepth).c_str()));
+  if (configRootElement.GetPointer() == NULL)
+  {
+    LOG_ERROR("Unable to parse the device set configuration");
+    exit(EXIT_FAILURE);
+  }
+  vtkPlusConfig::GetInstance()->SetDeviceSetConfigurationData(configRootElement);
+
+  vtkSmartPointer<vtkPlusDataCollector> dataCollector = vtkSmartPointer<vtkPlusDataCollector>::New();
+  if (dataCollector->ReadConfiguration(configRootElement) != PLUS_SUCCESS)
+  {
+    LOG_ERROR("Unable to configure data collector");
+    exit(EXIT_FAILURE);
+  }
+  if (dataCollector->Connect() != PLUS_SUCCESS)
+  {
+    LOG_ERROR("Failed to connect to " << deviceName << " using " << ioMethod);
+    exit(EXIT_FAILURE);
+  }
+  if (dataCollector->Start() != PLUS_SUCCESS)
+  {
+    LOG_ERROR("Failed to start data collection!");
+    exit(EXIT_FAILURE);
+  }
+
+  vtksys::SystemTools::Delay(static_cast<unsigned int>(acquisitionTimeSec * 1000));
+
+  int numberOfFailures(0);
+
+  vtkPlusDevice* videoDevice = NULL;
+  vtkPlusDataSource* videoSource = NULL;
+  if (dataCollector->GetDevice(videoDevice, "VideoDevice") != PLUS_SUCCESS || videoDevice->GetVideoSource("Video", videoSource) != PLUS_SUCCESS)
+  {
+    LOG_ERROR("Unable to find the video source of the V4L2 device");
+    numberOfFailures++;
+  }
+  else
+  {
+    if (videoSource->GetNumberOfItems() < 2)
+    {
+      LOG_ERROR("Only " << videoSource->GetNumberOfItems() << " frames were acquired in " << acquisitionTimeSec << " seconds using " << ioMethod);
+      numberOfFailures++;
+    }
+    FrameSizeType frameSize = videoSource->GetInputFrameSize();
+    if (frameSize[0] == 0 || frameSize[1] == 0)
+    {
+      LOG_ERROR("Invalid frame size: " << frameSize[0] << "x" << frameSize[1]);
+      numberOfFailures++;
+    }
+    LOG_INFO("Acquired " << videoSource->GetNumberOfItems() << " frames of " << frameSize[0] << "x" << frameSize[1] << " pixels using " << ioMethod);
+  }
+
+  dataCollector->Stop();
+  dataCollector->Disconnect();
+
+  if (numberOfFailures > 0)
+  {
+    LOG_ERROR("Number of failures: " << numberOfFailures);
+    return EXIT_FAILURE;
+  }
+  LOG_INFO("Test completed successfully");
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,208 @@
+/*=Plus=header=begin======================================================
+Program: Plus
+Copyright (c) Laboratory for Percutaneous Surgery. All rights reserved.
+See License.txt for details.
+=========================================================Plus=header=end*/
+
+/*!
+  \file vtkPlusVirtualCaptureTest.cxx
+  \brief Records a replayed sequence with a virtual capture device and verifies that all acquired frames are written to the output file
+
+  The capture device writes through a small write queue with BLOCK policy, so that no frames are dropped and frames are still
+  queued when recording stops. The frames that are queued at stop must be written to the file when the device is disconnected.
+*/
+
+// Local includes
+#include "PlusConfigure.h"
+#include "vtkPlusChannel.h"
+#include "vtkPlusDataCollector.h"
+#include "vtkPlusSequenceIO.h"
+#include "vtkPlusTrackedFrameList.h"
+#include "vtkPlusVirtualCapture.h"
+
+// VTK includes
+#include <vtkSmartPointer.h>
+#include <vtkXMLDataElement.h>
+#include <vtkXMLUtilities.h>
+#include <vtksys/CommandLineArguments.hxx>
+#include <vtksys/SystemTools.hxx>
+
+// STL includes
+#include <algorithm>
+
+namespace
+{
+  //----------------------------------------------------------------------------
+  std::string GetDeviceSetConfiguration(const std::string& sequenceFileName, int maxWriteQueueSize)
+  {
+    std::ostringstream config;
+    config << "<PlusConfiguration version=\"2.1\">" << std::endl
+           << "  <DataCollection StartupDelaySec=\"1.0\">" << std::endl
+           << "    <DeviceSet Name=\"Virtual capture test\" Description=\"Records replayed video to a file\" />" << std::endl
+           << "    <Device Id=\"VideoDevice\" Type=\"SavedDataSource\" SequenceFile=\"" << sequenceFileName << "\" UseData=\"IMAGE\" UseOriginalTimestamps=\"TRUE\" RepeatEnabled=\"TRUE\">" << std::endl
+           << "      <DataSources>" << std::endl
+           << "        <DataSource Type=\"Video\" Id=\"Video\" BufferSize=\"200\" PortUsImageOrientation=\"MF\" />" << std::endl
+           << "      </DataSources>" << std::endl
+           << "      <OutputChannels>" << std::endl
+           << "        <OutputChannel Id=\"VideoStream\" VideoDataSourceId=\"Video\" />" << std::endl
+           << "      </OutputChannels>" << std::endl
+           << "    </Device>" << std::endl
+           << "    <Device Id=\"CaptureDevice\" Type=\"VirtualCapture\" BaseFilename=\"vtkPlusVirtualCaptureTest.nrrd\" EnableFileCompression=\"TRUE\"" << std::endl
+           << "      EnableCapturingOnStart=\"TRUE\" AcquisitionRate=\"50\" RequestedFrameRate=\"100\" MaxWriteQueueSize=\"" << maxWriteQueueSize << "\" WriteQueueFullPolicy=\"BLOCK\">" << std::endl
+           << "      <InputChannels>" << std::endl
+           << "        <InputChannel Id=\"VideoStream\" />" << std::endl
+           << "      </InputChannels>" << std::endl
+           << "    </Device>" << std::endl
+           << "  </DataCollection>" << std::endl
+           << "</PlusConfiguration>" << std::endl;
+    return config.str();
+  }
+}
+
+//----------------------------------------------------------------------------
+int main(int argc, char** argv)
+{
+  bool printHelp(false);
+  std::string inputSequenceFileName;
+  double inputAcqTimeLength(3.0);
+  int maxWriteQueueSize(5);
+  int verboseLevel = vtkPlusLogger::LOG_LEVEL_UNDEFINED;
+
+  vtksys::CommandLineArguments args;
+  args.Initialize(argc, argv);
+
+  args.AddArgument("--help", vtksys::CommandLineArguments::NO_ARGUMENT, &printHelp, "Print this help.");
+  args.AddArgument("--seq-file", vtksys::CommandLineArguments::EQUAL_ARGUMENT, &inputSequenceFileName, "Sequence file that is replayed and recorded.");
+  args.AddArgument("--acq-time-length", vtksys::CommandLineArguments::EQUAL_ARGUMENT, &inputAcqTimeLength, "Length of recording in seconds (Default: 3s)");
+  args.AddArgument("--max-write-queue-size", vtksys::CommandLineArguments::EQUAL_ARGUMENT, &maxWriteQueueSize, "Maximum number of frames in the write queue (Default: 5)");
+  args.AddArgument("--verbose", vtksys::CommandLineArguments::EQUAL_ARGUMENT, &verboseLevel, "Verbose level (1=error only, 2=warning, 3=info, 4=debug, 5=trace)");
+
+  if (!args.Parse())
+  {
+    std::cerr << "Problem parsing arguments" << std::endl;
+    std::cout << "Help: " << args.GetHelp() << std::endl;
+    exit(EXIT_FAILURE);
+  }
+
+  if (printHelp)
+  {
+    std::cout << args.GetHelp() << std::endl;
+    exit(EXIT_SUCCESS);
+  }
+
+  vtkPlusLogger::Instance()->SetLogLevel(verboseLevel);
+
+  if (inputSequenceFileName.empty())
+  {
+    std::cerr << "--seq-file is required" << std::endl;
+    exit(EXIT_FAILURE);
+  }
+
+  vtkSmartPointer<vtkXMLDataElement> configRootElement = vtkSmartPointer<vtkXMLDataElement>::Take(
+        vtkXMLUtilities::ReadElementFromString(GetDeviceSetConfiguration(inputSequenceFileName, maxWriteQueueSize).c_str()));
+  if (configRootElement.GetPointer() == NULL)
+  {
+    LOG_ERROR("Unable to parse the device set configuration");
+    exit(EXIT_FAILURE);
+  }
+  vtkPlusConfig::GetInstance()->SetDeviceSetConfigurationData(configRootElement);
+
+  vtkSmartPointer<vtkPlusDataCollector> dataCollector = vtkSmartPointer<vtkPlusDataCollector>::New();
+  if (dataCollector->ReadConfiguration(configRootElement) != PLUS_SUCCESS)
+  {
+    LOG_ERROR("Unable to configure data collector");
+    exit(EXIT_FAILURE);
+  }
+
+  vtkPlusDevice* captureDevice = NULL;
+  if (dataCollector->GetDevice(captureDevice, "CaptureDevice") != PLUS_SUCCESS)
+  {
+    LOG_ERROR("Unable to locate the device with Id=\"CaptureDevice\"");
+    exit(EXIT_FAILURE);
+  }
+  vtkPlusVirtualCapture* capture = vtkPlusVirtualCapture::SafeDownCast(captureDevice);
+  if (capture == NULL)
+  {
+    LOG_ERROR("Unable to cast device to vtkPlusVirtualCapture");
+    exit(EXIT_FAILURE);
+  }
+
+  if (dataCollector->Connect() != PLUS_SUCCESS)
+  {
+    LOG_ERROR("Failed to connect to data collector!");
+    exit(EXIT_FAILURE);
+  }
+
+  if (dataCollector->Start() != PLUS_SUCCESS)
+  {
+    LOG_ERROR("Failed to start data collection");
+    exit(EXIT_FAILURE);
+  }
+
+  const double acqStartTime = vtkPlusAccurateTimer::GetSystemTime();
+  while (acqStartTime + inputAcqTimeLength > vtkPlusAccurateTimer::GetSystemTime())
+  {
+    vtksys::SystemTools::Delay(100);
+  }
+
+  int numberOfFailures(0);
+
+  // Stop sampling, so that the number of acquired frames does not change anymore.
+  // Frames that are still in the write queue are written when the capture device is disconnected.
+  capture->StopRecording();
+  long numberOfAcquiredFrames = capture->GetTotalFramesRecorded();
+  LOG_INFO("Acquired frames: " << numberOfAcquiredFrames << ", frames in the write queue at stop: " << capture->GetWriteQueueDepth()
+           << ", write queue high water mark: " << capture->GetWriteQueueHighWaterMark());
+  if (numberOfAcquiredFrames <= 0)
+  {
+    LOG_ERROR("No frames were acquired");
+    numberOfFailures++;
+  }
+  if (capture->GetNumberOfDroppedFrames() != 0)
+  {
+    LOG_ERROR("Frames were dropped with BLOCK write queue policy: " << capture->GetNumberOfDroppedFrames());
+    numberOfFailures++;
+  }
+  // A batch of frames that is larger than the limit is accepted into an empty queue, so the limit may only be exceeded by such a batch
+  int writeQueueSizeBound = std::max(maxWriteQueueSize, capture->GetLargestWriteBatchSize());
+  if (capture->GetWriteQueueHighWaterMark() > writeQueueSizeBound)
+  {
+    LOG_ERROR("Write queue size limit exceeded: " << capture->GetWriteQueueHighWaterMark() << " frames were queued (limit: " << maxWriteQueueSize
+              << ", largest batch: " << capture->GetLargestWriteBatchSize() << ")");
+    numberOfFailures++;
+  }
+
+  std::string outputFileName = capture->GetOutputFileName();
+  if (dataCollector->Stop() != PLUS_SUCCESS)
+  {
+    LOG_ERROR("Failed to stop data collection!");
+    numberOfFailures++;
+  }
+  dataCollector->Disconnect();
+
+  vtkSmartPointer<vtkPlusTrackedFrameList> writtenFrames = vtkSmartPointer<vtkPlusTrackedFrameList>::New();
+  if (vtkPlusSequenceIO::Read(outputFileName, writtenFrames) != PLUS_SUCCESS)
+  {
+    LOG_ERROR("Unable to read the recorded file: " << outputFileName);
+    numberOfFailures++;
+  }
+  else if (static_cast<long>(writtenFrames->GetNumberOfTrackedFrames()) != numberOfAcquiredFrames)
+  {
+    LOG_ERROR("Number of frames in the recorded file (" << writtenFrames->GetNumberOfTrackedFrames() << ") does not match the number of acquired frames (" << numberOfAcquiredFrames << ")");
+    numberOfFailures++;
+  }
+
+  // Remove the recorded file and the configuration file that is saved with it
+  std::string configFileName = vtksys::SystemTools::GetFilenamePath(outputFileName) + "/" + vtksys::SystemTools::GetFilenameWithoutExtension(outputFileName) + "_config.xml";
+  vtksys::SystemTools::RemoveFile(outputFileName.c_str());
+  vtksys::SystemTools::RemoveFile(configFileName.c_str());
+
+  if (numberOfFailures > 0)
+  {
+    LOG_ERROR("Number of failures: " << numberOfFailures);
+    return EXIT_FAILURE;
+  }
+
+  std::cout << "Test completed successfully!" << std::endl;
+  return EXIT_SUCCESS;
+}
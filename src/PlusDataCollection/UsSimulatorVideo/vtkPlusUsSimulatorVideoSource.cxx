@@ -217,6 +217,23 @@ PlusStatus vtkPlusUsSimulatorVideoSource::ReadConfiguration(vtkXMLDataElement* r
   return PLUS_SUCCESS;
 }
 
+//-----------------------------------------------------------------------------
+PlusStatus vtkPlusUsSimulatorVideoSource::WriteConfiguration(vtkXMLDataElement* rootConfigElement)
+{
+  LOG_TRACE("vtkPlusUsSimulatorVideoSource::WriteConfiguration");
+  XML_FIND_DEVICE_ELEMENT_REQUIRED_FOR_WRITING(deviceConfig, rootConfigElement);
+
+  // Write US simulator configuration
+  if (!this->UsSimulator
+      || this->UsSimulator->WriteConfiguration(deviceConfig) != PLUS_SUCCESS)
+  {
+    LOG_ERROR("Failed to write US simulator configuration!");
+    return PLUS_FAIL;
+  }
+
+  return PLUS_SUCCESS;
+}
+
 //----------------------------------------------------------------------------
 PlusStatus vtkPlusUsSimulatorVideoSource::NotifyConfigured()
 {
@@ -31,6 +31,9 @@ public:
   /*! Read configuration from xml data */
   virtual PlusStatus ReadConfiguration(vtkXMLDataElement* config);
 
+  /*! Write configuration to xml data */
+  virtual PlusStatus WriteConfiguration(vtkXMLDataElement* config);
+
   /*! Get ultrasound simulator */
   vtkGetObjectMacro(UsSimulator, vtkPlusUsSimulatorAlgo);
 
@@ -21,6 +21,11 @@
 #include <sys/ioctl.h>
 #include <sys/mman.h>
 
+// DMABUF includes
+#ifdef PLUS_HAVE_LINUX_DMA_BUF_H
+  #include <linux/dma-buf.h>
+#endif
+
 //----------------------------------------------------------------------------
 
 vtkStandardNewMacro(vtkPlusV4L2VideoSource);
@@ -41,6 +46,9 @@ namespace
 
     return r;
   }
+
+  const unsigned int DEFAULT_QUEUE_DEPTH = 4;
+  const unsigned int MINIMUM_QUEUE_DEPTH = 2;
 }
 
 #define CLEAR(x) memset(&(x), 0, sizeof(x))
@@ -49,7 +57,9 @@ namespace
 vtkPlusV4L2VideoSource::vtkPlusV4L2VideoSource()
   : DeviceName("")
   , IOMethod(IO_METHOD_READ)
+  , QueueDepth(DEFAULT_QUEUE_DEPTH)
   , FileDescriptor(-1)
+  , BufferType(V4L2_BUF_TYPE_VIDEO_CAPTURE)
   , FrameBuffers(nullptr)
   , BufferCount(0)
   , DeviceFormat(std::make_shared<v4l2_format>())
@@ -76,7 +86,9 @@ void vtkPlusV4L2VideoSource::PrintSelf(ostream& os, vtkIndent indent)
 
   os << indent << "DeviceName: " << this->DeviceName << std::endl;
   os << indent << "IOMethod: " << this->IOMethodToString(this->IOMethod) << std::endl;
+  os << indent << "QueueDepth: " << this->QueueDepth << std::endl;
   os << indent << "BufferCount: " << this->BufferCount << std::endl;
+  os << indent << "MultiPlanar: " << (this->IsMultiPlanar() ? "TRUE" : "FALSE") << std::endl;
 
   if (this->FileDescriptor != -1)
   {
@@ -84,7 +96,7 @@ void vtkPlusV4L2VideoSource::PrintSelf(ostream& os, vtkIndent indent)
 
     struct v4l2_fmtdesc fmtdesc;
     CLEAR(fmtdesc);
-    fmtdesc.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    fmtdesc.type = this->BufferType;
     while (ioctl(this->FileDescriptor, VIDIOC_ENUM_FMT, &fmtdesc) == 0)
     {
       os << indent << fmtdesc.description << std::endl;
@@ -109,11 +121,20 @@ PlusStatus vtkPlusV4L2VideoSource::ReadConfiguration(vtkXMLDataElement* rootConf
   {
     this->IOMethod = vtkPlusV4L2VideoSource::StringToIOMethod(ioMethod);
   }
-  else
+  else if (deviceConfig->GetAttribute("IOMethod") != nullptr)
   {
     LOG_WARNING("Unknown method: " << ioMethod << ". Defaulting to " << vtkPlusV4L2VideoSource::IOMethodToString(this->IOMethod));
   }
 
+  int queueDepth(static_cast<int>(this->QueueDepth));
+  XML_READ_SCALAR_ATTRIBUTE_NONMEMBER_OPTIONAL(int, QueueDepth, queueDepth, deviceConfig);
+  if (queueDepth < static_cast<int>(MINIMUM_QUEUE_DEPTH))
+  {
+    LOG_WARNING("QueueDepth must be at least " << MINIMUM_QUEUE_DEPTH << ". Using " << MINIMUM_QUEUE_DEPTH << ".");
+    queueDepth = MINIMUM_QUEUE_DEPTH;
+  }
+  this->QueueDepth = static_cast<unsigned int>(queueDepth);
+
   int frameSize[2];
   XML_READ_VECTOR_ATTRIBUTE_NONMEMBER_OPTIONAL(int, 2, FrameSize, frameSize, deviceConfig);
   if (deviceConfig->GetAttribute("FrameSize") != nullptr)
@@ -154,13 +175,18 @@ PlusStatus vtkPlusV4L2VideoSource::WriteConfiguration(vtkXMLDataElement* rootCon
   XML_WRITE_STRING_ATTRIBUTE_IF_NOT_EMPTY(DeviceName, deviceConfig);
 
   deviceConfig->SetAttribute("IOMethod", vtkPlusV4L2VideoSource::IOMethodToString(this->IOMethod).c_str());
+  deviceConfig->SetIntAttribute("QueueDepth", static_cast<int>(this->QueueDepth));
 
-  int frameSize[2] = { static_cast<int>(this->DeviceFormat->fmt.pix.width), static_cast<int>(this->DeviceFormat->fmt.pix.height) };
+  unsigned int width(0), height(0), pixelFormat(0), imageSize(0);
+  v4l2_field fieldOrder(V4L2_FIELD_ANY);
+  this->GetFormat(width, height, pixelFormat, fieldOrder, imageSize);
+
+  int frameSize[2] = { static_cast<int>(width), static_cast<int>(height) };
   deviceConfig->SetVectorAttribute("FrameSize", 2, frameSize);
 
-  deviceConfig->SetAttribute("PixelFormat", vtkPlusV4L2VideoSource::PixelFormatToString(this->DeviceFormat->fmt.pix.pixelformat).c_str());
+  deviceConfig->SetAttribute("PixelFormat", vtkPlusV4L2VideoSource::PixelFormatToString(pixelFormat).c_str());
 
-  deviceConfig->SetAttribute("FieldOrder", vtkPlusV4L2VideoSource::FieldOrderToString(static_cast<v4l2_field>(this->DeviceFormat->fmt.pix.field)).c_str());
+  deviceConfig->SetAttribute("FieldOrder", vtkPlusV4L2VideoSource::FieldOrderToString(fieldOrder).c_str());
 
   return PLUS_SUCCESS;
 }
@@ -178,6 +204,7 @@ PlusStatus vtkPlusV4L2VideoSource::InitRead(unsigned int bufferSize)
 
   this->FrameBuffers[0].length = bufferSize;
   this->FrameBuffers[0].start = malloc(bufferSize);
+  this->FrameBuffers[0].dmabufFileDescriptor = -1;
 
   if (!this->FrameBuffers[0].start)
   {
@@ -197,8 +224,8 @@ PlusStatus vtkPlusV4L2VideoSource::InitMmap()
 
   CLEAR(req);
 
-  req.count = 4;
-  req.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+  req.count = this->QueueDepth;
+  req.type = this->BufferType;
   req.memory = V4L2_MEMORY_MMAP;
 
   if (-1 == xioctl(this->FileDescriptor, VIDIOC_REQBUFS, &req))
@@ -214,11 +241,15 @@ PlusStatus vtkPlusV4L2VideoSource::InitMmap()
     return PLUS_FAIL;
   }
 
-  if (req.count < 2)
+  if (req.count < MINIMUM_QUEUE_DEPTH)
   {
     LOG_ERROR("Insufficient buffer memory on " << this->DeviceName);
     return PLUS_FAIL;
   }
+  if (req.count != this->QueueDepth)
+  {
+    LOG_INFO(this->DeviceName << " allocated " << req.count << " buffers instead of the requested " << this->QueueDepth);
+  }
 
   this->FrameBuffers = (FrameBuffer*) calloc(req.count, sizeof(FrameBuffer));
 
@@ -231,11 +262,8 @@ PlusStatus vtkPlusV4L2VideoSource::InitMmap()
   for (this->BufferCount = 0; this->BufferCount < req.count; ++this->BufferCount)
   {
     v4l2_buffer buf;
-    CLEAR(buf);
-
-    buf.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
-    buf.memory = V4L2_MEMORY_MMAP;
-    buf.index = this->BufferCount;
+    v4l2_plane plane;
+    this->PrepareBuffer(buf, plane, this->BufferCount);
 
     if (-1 == xioctl(this->FileDescriptor, VIDIOC_QUERYBUF, &buf))
     {
@@ -243,12 +271,41 @@ PlusStatus vtkPlusV4L2VideoSource::InitMmap()
       return PLUS_FAIL;
     }
 
-    this->FrameBuffers[this->BufferCount].length = buf.length;
-    this->FrameBuffers[this->BufferCount].start = mmap(NULL /* start anywhere */, buf.length, PROT_READ | PROT_WRITE /* required */, MAP_SHARED /* recommended */, this->FileDescriptor, buf.m.offset);
+    FrameBuffer& frameBuffer = this->FrameBuffers[this->BufferCount];
+    frameBuffer.length = this->IsMultiPlanar() ? plane.length : buf.length;
+    frameBuffer.dmabufFileDescriptor = -1;
 
-    if (MAP_FAILED == this->FrameBuffers[this->BufferCount].start)
+    if (this->IOMethod == IO_METHOD_DMABUF)
+    {
+      // Export the buffer and access its content through the DMABUF instead of the device
+      v4l2_exportbuffer expbuf;
+      CLEAR(expbuf);
+      expbuf.type = this->BufferType;
+      expbuf.index = this->BufferCount;
+      expbuf.plane = 0;
+      expbuf.flags = O_RDONLY | O_CLOEXEC;
+
+      if (-1 == xioctl(this->FileDescriptor, VIDIOC_EXPBUF, &expbuf))
+      {
+        LOG_ERROR("VIDIOC_EXPBUF" << ": " << strerror(errno));
+        frameBuffer.start = MAP_FAILED;
+        return PLUS_FAIL;
+      }
+
+      frameBuffer.dmabufFileDescriptor = expbuf.fd;
+      frameBuffer.start = mmap(NULL /* start anywhere */, frameBuffer.length, PROT_READ, MAP_SHARED, expbuf.fd, 0);
+    }
+    else
+    {
+      off_t offset = this->IsMultiPlanar() ? plane.m.mem_offset : buf.m.offset;
+      frameBuffer.start = mmap(NULL /* start anywhere */, frameBuffer.length, PROT_READ | PROT_WRITE /* required */, MAP_SHARED /* recommended */, this->FileDescriptor, offset);
+    }
+
+    if (MAP_FAILED == frameBuffer.start)
     {
       LOG_ERROR("mmap" << ": " << strerror(errno));
+      ++this->BufferCount;
+      return PLUS_FAIL;
     }
   }
 
@@ -262,8 +319,8 @@ PlusStatus vtkPlusV4L2VideoSource::InitUserp(unsigned int bufferSize)
 
   CLEAR(req);
 
-  req.count = 4;
-  req.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+  req.count = this->QueueDepth;
+  req.type = this->BufferType;
   req.memory = V4L2_MEMORY_USERPTR;
 
   if (-1 == xioctl(this->FileDescriptor, VIDIOC_REQBUFS, &req))
@@ -279,7 +336,13 @@ PlusStatus vtkPlusV4L2VideoSource::InitUserp(unsigned int bufferSize)
     return PLUS_FAIL;
   }
 
-  this->FrameBuffers = (FrameBuffer*) calloc(4, sizeof(FrameBuffer));
+  if (req.count < MINIMUM_QUEUE_DEPTH)
+  {
+    LOG_ERROR("Insufficient buffer memory on " << this->DeviceName);
+    return PLUS_FAIL;
+  }
+
+  this->FrameBuffers = (FrameBuffer*) calloc(req.count, sizeof(FrameBuffer));
 
   if (!this->FrameBuffers)
   {
@@ -287,10 +350,11 @@ PlusStatus vtkPlusV4L2VideoSource::InitUserp(unsigned int bufferSize)
     return PLUS_FAIL;
   }
 
-  for (this->BufferCount = 0; this->BufferCount < 4; ++this->BufferCount)
+  for (this->BufferCount = 0; this->BufferCount < req.count; ++this->BufferCount)
   {
     this->FrameBuffers[this->BufferCount].length = bufferSize;
     this->FrameBuffers[this->BufferCount].start = malloc(bufferSize);
+    this->FrameBuffers[this->BufferCount].dmabufFileDescriptor = -1;
 
     if (!this->FrameBuffers[this->BufferCount].start)
     {
@@ -341,7 +405,19 @@ PlusStatus vtkPlusV4L2VideoSource::InternalConnect()
     return PLUS_FAIL;
   }
 
-  if (!(cap.capabilities & V4L2_CAP_VIDEO_CAPTURE))
+  // Capabilities of the opened device node (capabilities may contain those of the whole physical device)
+  uint32_t deviceCapabilities = (cap.capabilities & V4L2_CAP_DEVICE_CAPS) ? cap.device_caps : cap.capabilities;
+
+  // Prefer the single-planar API, use the multi-planar API if that is the only one the device supports (e.g. HDMI receivers)
+  if (deviceCapabilities & V4L2_CAP_VIDEO_CAPTURE)
+  {
+    this->BufferType = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+  }
+  else if (deviceCapabilities & V4L2_CAP_VIDEO_CAPTURE_MPLANE)
+  {
+    this->BufferType = V4L2_BUF_TYPE_VIDEO_CAPTURE_MPLANE;
+  }
+  else
   {
     LOG_ERROR(this->DeviceName << " is not a video capture device");
     return PLUS_FAIL;
@@ -351,19 +427,26 @@ PlusStatus vtkPlusV4L2VideoSource::InternalConnect()
   {
     case IO_METHOD_READ:
     {
-      if (!(cap.capabilities & V4L2_CAP_READWRITE))
+      if (!(deviceCapabilities & V4L2_CAP_READWRITE))
       {
         LOG_ERROR(this->DeviceName << " does not support read i/o");
         return PLUS_FAIL;
       }
       break;
     }
+    case IO_METHOD_DMABUF:
+#ifndef PLUS_HAVE_LINUX_DMA_BUF_H
+    {
+      LOG_ERROR(vtkPlusV4L2VideoSource::IOMethodToString(IO_METHOD_DMABUF) << " is not available: Plus was built without linux/dma-buf.h");
+      return PLUS_FAIL;
+    }
+#endif
     case IO_METHOD_MMAP:
     case IO_METHOD_USERPTR:
     {
-      if (!(cap.capabilities & V4L2_CAP_STREAMING))
+      if (!(deviceCapabilities & V4L2_CAP_STREAMING))
       {
-        LOG_ERROR(this->DeviceName << " does not support streaming i/o");
+        LOG_ERROR(this->DeviceName << " does not support streaming i/o. Set IOMethod to " << vtkPlusV4L2VideoSource::IOMethodToString(IO_METHOD_READ) << ".");
         return PLUS_FAIL;
       }
       break;
@@ -378,12 +461,12 @@ PlusStatus vtkPlusV4L2VideoSource::InternalConnect()
   // Select video input, video standard and tune here
   struct v4l2_cropcap cropcap;
   CLEAR(cropcap);
-  cropcap.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+  cropcap.type = this->BufferType;
   if (0 == xioctl(this->FileDescriptor, VIDIOC_CROPCAP, &cropcap))
   {
     struct v4l2_crop crop;
     CLEAR(crop);
-    crop.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    crop.type = this->BufferType;
     crop.c = cropcap.defrect;
 
     // TODO : get clip information from data source and set to device
@@ -399,28 +482,50 @@ PlusStatus vtkPlusV4L2VideoSource::InternalConnect()
   }
 
   // Retrieve current v4l2 format settings
-  this->DeviceFormat->type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+  this->DeviceFormat->type = this->BufferType;
   if (-1 == xioctl(this->FileDescriptor, VIDIOC_G_FMT, this->DeviceFormat.get()))
   {
     LOG_ERROR("VIDIOC_G_FMT" << ": " << strerror(errno));
     return PLUS_FAIL;
   }
 
-  if (this->FormatWidth != nullptr)
-  {
-    this->DeviceFormat->fmt.pix.width = *this->FormatWidth;
-  }
-  if (this->FormatHeight != nullptr)
-  {
-    this->DeviceFormat->fmt.pix.height = *this->FormatHeight;
-  }
-  if (this->PixelFormat != nullptr)
+  if (this->IsMultiPlanar())
   {
-    this->DeviceFormat->fmt.pix.pixelformat = *this->PixelFormat;
+    if (this->FormatWidth != nullptr)
+    {
+      this->DeviceFormat->fmt.pix_mp.width = *this->FormatWidth;
+    }
+    if (this->FormatHeight != nullptr)
+    {
+      this->DeviceFormat->fmt.pix_mp.height = *this->FormatHeight;
+    }
+    if (this->PixelFormat != nullptr)
+    {
+      this->DeviceFormat->fmt.pix_mp.pixelformat = *this->PixelFormat;
+    }
+    if (this->FieldOrder != nullptr)
+    {
+      this->DeviceFormat->fmt.pix_mp.field = *this->FieldOrder;
+    }
   }
-  if (this->FieldOrder != nullptr)
+  else
   {
-    this->DeviceFormat->fmt.pix.field = *this->FieldOrder;
+    if (this->FormatWidth != nullptr)
+    {
+      this->DeviceFormat->fmt.pix.width = *this->FormatWidth;
+    }
+    if (this->FormatHeight != nullptr)
+    {
+      this->DeviceFormat->fmt.pix.height = *this->FormatHeight;
+    }
+    if (this->PixelFormat != nullptr)
+    {
+      this->DeviceFormat->fmt.pix.pixelformat = *this->PixelFormat;
+    }
+    if (this->FieldOrder != nullptr)
+    {
+      this->DeviceFormat->fmt.pix.field = *this->FieldOrder;
+    }
   }
 
   if (-1 == xioctl(this->FileDescriptor, VIDIOC_S_FMT, this->DeviceFormat.get()))
@@ -433,32 +538,44 @@ PlusStatus vtkPlusV4L2VideoSource::InternalConnect()
     }
   }
 
+  if (this->IsMultiPlanar() && this->DeviceFormat->fmt.pix_mp.num_planes != 1)
+  {
+    LOG_ERROR("Pixel format " << vtkPlusV4L2VideoSource::PixelFormatToString(this->DeviceFormat->fmt.pix_mp.pixelformat) << " of " << this->DeviceName
+              << " uses " << static_cast<int>(this->DeviceFormat->fmt.pix_mp.num_planes) << " planes. Only single-plane pixel formats are supported.");
+    return PLUS_FAIL;
+  }
+
+  unsigned int width(0), height(0), pixelFormat(0), imageSize(0);
+  v4l2_field fieldOrder(V4L2_FIELD_ANY);
+  this->GetFormat(width, height, pixelFormat, fieldOrder, imageSize);
+
   assert(this->DataSource != nullptr);
 
-  this->DataSource->SetInputFrameSize(this->DeviceFormat->fmt.pix.width, this->DeviceFormat->fmt.pix.height, 1);
-  this->ImageSize[0] = this->DeviceFormat->fmt.pix.width;
-  this->ImageSize[1] = this->DeviceFormat->fmt.pix.height;
+  this->DataSource->SetInputFrameSize(width, height, 1);
+  this->ImageSize[0] = width;
+  this->ImageSize[1] = height;
   this->ImageSize[2] = 1;
   this->DataSource->SetPixelType(VTK_UNSIGNED_CHAR);
-  this->NumberOfScalarComponents = this->DeviceFormat->fmt.pix.sizeimage / this->DeviceFormat->fmt.pix.width / this->DeviceFormat->fmt.pix.height;
+  this->NumberOfScalarComponents = imageSize / width / height;
   this->DataSource->SetNumberOfScalarComponents(this->NumberOfScalarComponents);
 
-  this->FrameFields["pixelformat"] = vtkPlusV4L2VideoSource::PixelFormatToString(this->DeviceFormat->fmt.pix.pixelformat);
+  this->FrameFields["pixelformat"] = vtkPlusV4L2VideoSource::PixelFormatToString(pixelFormat);
 
   // Use this->DeviceFormat to initialize data source
   switch (this->IOMethod)
   {
     case IO_METHOD_READ:
     {
-      return this->InitRead(this->DeviceFormat->fmt.pix.sizeimage);
+      return this->InitRead(imageSize);
     }
     case IO_METHOD_MMAP:
+    case IO_METHOD_DMABUF:
     {
       return this->InitMmap();
     }
     case IO_METHOD_USERPTR:
     {
-      return this->InitUserp(this->DeviceFormat->fmt.pix.sizeimage);
+      return this->InitUserp(imageSize);
     }
     default:
     {
@@ -470,36 +587,46 @@ PlusStatus vtkPlusV4L2VideoSource::InternalConnect()
 //----------------------------------------------------------------------------
 PlusStatus vtkPlusV4L2VideoSource::InternalDisconnect()
 {
-  switch (this->IOMethod)
+  if (this->FrameBuffers != nullptr)
   {
-    case IO_METHOD_READ:
-    {
-      free(this->FrameBuffers[0].start);
-      break;
-    }
-    case IO_METHOD_MMAP:
+    switch (this->IOMethod)
     {
-      for (unsigned int i = 0; i < this->BufferCount; ++i)
+      case IO_METHOD_READ:
+      {
+        free(this->FrameBuffers[0].start);
+        break;
+      }
+      case IO_METHOD_MMAP:
+      case IO_METHOD_DMABUF:
       {
-        if (-1 == munmap(this->FrameBuffers[i].start, this->FrameBuffers[i].length))
+        for (unsigned int i = 0; i < this->BufferCount; ++i)
         {
-          LOG_ERROR("munmap" << ": " << strerror(errno));
-          return PLUS_FAIL;
+          if (MAP_FAILED != this->FrameBuffers[i].start && -1 == munmap(this->FrameBuffers[i].start, this->FrameBuffers[i].length))
+          {
+            LOG_ERROR("munmap" << ": " << strerror(errno));
+          }
+          if (this->FrameBuffers[i].dmabufFileDescriptor != -1)
+          {
+            close(this->FrameBuffers[i].dmabufFileDescriptor);
+          }
         }
+        break;
       }
-      break;
-    }
-    case IO_METHOD_USERPTR:
-    {
-      for (unsigned int i = 0; i < this->BufferCount; ++i)
+      case IO_METHOD_USERPTR:
       {
-        free(this->FrameBuffers[i].start);
+        for (unsigned int i = 0; i < this->BufferCount; ++i)
+        {
+          free(this->FrameBuffers[i].start);
+        }
+        break;
       }
-      break;
+      default:
+      {}
     }
-  }
 
-  free(this->FrameBuffers);
+    free(this->FrameBuffers);
+    this->FrameBuffers = nullptr;
+  }
 
   if (-1 == close(this->FileDescriptor))
   {
@@ -543,12 +670,46 @@ PlusStatus vtkPlusV4L2VideoSource::InternalUpdate()
 
   unsigned int currentBufferIndex;
   unsigned int bytesUsed;
-  if (this->ReadFrame(currentBufferIndex, bytesUsed) != PLUS_SUCCESS)
+  unsigned int dataOffset;
+  if (this->ReadFrame(currentBufferIndex, bytesUsed, dataOffset) != PLUS_SUCCESS)
   {
     return PLUS_FAIL;
   }
 
-  if (this->DataSource->AddItem(this->FrameBuffers[currentBufferIndex].start, this->ImageSize, bytesUsed, US_IMG_BRIGHTNESS, this->FrameNumber, UNDEFINED_TIMESTAMP, UNDEFINED_TIMESTAMP, &this->FrameFields) != PLUS_SUCCESS)
+  const FrameBuffer& frameBuffer = this->FrameBuffers[currentBufferIndex];
+
+#ifdef PLUS_HAVE_LINUX_DMA_BUF_H
+  // CPU access to a DMABUF must be bracketed by sync calls to keep caches coherent with the device
+  struct dma_buf_sync sync;
+  CLEAR(sync);
+  if (frameBuffer.dmabufFileDescriptor != -1)
+  {
+    sync.flags = DMA_BUF_SYNC_START | DMA_BUF_SYNC_READ;
+    if (-1 == xioctl(frameBuffer.dmabufFileDescriptor, DMA_BUF_IOCTL_SYNC, &sync))
+    {
+      LOG_WARNING("DMA_BUF_IOCTL_SYNC" << ": " << strerror(errno));
+    }
+  }
+#endif
+
+  // The frame is copied from the device buffer directly into the stream buffer of the data source
+  PlusStatus addItemStatus = this->DataSource->AddItem(static_cast<unsigned char*>(frameBuffer.start) + dataOffset, this->ImageSize, bytesUsed, US_IMG_BRIGHTNESS, this->FrameNumber, UNDEFINED_TIMESTAMP, UNDEFINED_TIMESTAMP, &this->FrameFields);
+
+#ifdef PLUS_HAVE_LINUX_DMA_BUF_H
+  if (frameBuffer.dmabufFileDescriptor != -1)
+  {
+    sync.flags = DMA_BUF_SYNC_END | DMA_BUF_SYNC_READ;
+    xioctl(frameBuffer.dmabufFileDescriptor, DMA_BUF_IOCTL_SYNC, &sync);
+  }
+#endif
+
+  // The driver may only reuse the buffer once its content has been added
+  if (this->IOMethod != IO_METHOD_READ && this->QueueBuffer(currentBufferIndex) != PLUS_SUCCESS)
+  {
+    return PLUS_FAIL;
+  }
+
+  if (addItemStatus != PLUS_SUCCESS)
   {
     LOG_ERROR("vtkPlusV4L2VideoSource::Unable to add item to the buffer.");
     return PLUS_FAIL;
@@ -559,29 +720,29 @@ PlusStatus vtkPlusV4L2VideoSource::InternalUpdate()
 }
 
 //----------------------------------------------------------------------------
-PlusStatus vtkPlusV4L2VideoSource::ReadFrame(unsigned int& currentBufferIndex, unsigned int& bytesUsed)
+PlusStatus vtkPlusV4L2VideoSource::ReadFrame(unsigned int& currentBufferIndex, unsigned int& bytesUsed, unsigned int& dataOffset)
 {
   switch (this->IOMethod)
   {
     case IO_METHOD_READ:
     {
-      return ReadFrameFileDescriptor(currentBufferIndex, bytesUsed);
+      return ReadFrameFileDescriptor(currentBufferIndex, bytesUsed, dataOffset);
     }
     case IO_METHOD_MMAP:
-    {
-      return ReadFrameMemoryMap(currentBufferIndex, bytesUsed);
-    }
     case IO_METHOD_USERPTR:
+    case IO_METHOD_DMABUF:
     {
-      return ReadFrameUserPtr(currentBufferIndex, bytesUsed);
+      return ReadFrameStreaming(currentBufferIndex, bytesUsed, dataOffset);
     }
+    default:
+    {}
   }
 
   return PLUS_FAIL;
 }
 
 //----------------------------------------------------------------------------
-PlusStatus vtkPlusV4L2VideoSource::ReadFrameFileDescriptor(unsigned int& currentBufferIndex, unsigned int& bytesUsed)
+PlusStatus vtkPlusV4L2VideoSource::ReadFrameFileDescriptor(unsigned int& currentBufferIndex, unsigned int& bytesUsed, unsigned int& dataOffset)
 {
   if (-1 == read(this->FileDescriptor, this->FrameBuffers[0].start, this->FrameBuffers[0].length))
   {
@@ -605,18 +766,17 @@ PlusStatus vtkPlusV4L2VideoSource::ReadFrameFileDescriptor(unsigned int& current
 
   currentBufferIndex = 0;
   bytesUsed = this->FrameBuffers[0].length;
+  dataOffset = 0;
 
   return PLUS_SUCCESS;
 }
 
 //----------------------------------------------------------------------------
-PlusStatus vtkPlusV4L2VideoSource::ReadFrameMemoryMap(unsigned int& currentBufferIndex, unsigned int& bytesUsed)
+PlusStatus vtkPlusV4L2VideoSource::ReadFrameStreaming(unsigned int& currentBufferIndex, unsigned int& bytesUsed, unsigned int& dataOffset)
 {
-  struct v4l2_buffer buf;
-  CLEAR(buf);
-
-  buf.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
-  buf.memory = V4L2_MEMORY_MMAP;
+  v4l2_buffer buf;
+  v4l2_plane plane;
+  this->PrepareBuffer(buf, plane, 0);
 
   if (-1 == xioctl(this->FileDescriptor, VIDIOC_DQBUF, &buf))
   {
@@ -638,52 +798,45 @@ PlusStatus vtkPlusV4L2VideoSource::ReadFrameMemoryMap(unsigned int& currentBuffe
     }
   }
 
-  if (-1 == xioctl(this->FileDescriptor, VIDIOC_QBUF, &buf))
+  if (buf.index >= this->BufferCount)
   {
-    LOG_ERROR("VIDIOC_QBUF" << ": " << strerror(errno));
+    LOG_ERROR("VIDIOC_DQBUF returned invalid buffer index: " << buf.index);
     return PLUS_FAIL;
   }
 
   currentBufferIndex = buf.index;
-  bytesUsed = buf.length;
+  if (this->IsMultiPlanar())
+  {
+    dataOffset = plane.data_offset;
+    bytesUsed = plane.bytesused - plane.data_offset;
+  }
+  else
+  {
+    dataOffset = 0;
+    bytesUsed = buf.bytesused;
+  }
 
   return PLUS_SUCCESS;
 }
 
 //----------------------------------------------------------------------------
-PlusStatus vtkPlusV4L2VideoSource::ReadFrameUserPtr(unsigned int& currentBufferIndex, unsigned int& bytesUsed)
+PlusStatus vtkPlusV4L2VideoSource::QueueBuffer(unsigned int bufferIndex)
 {
   v4l2_buffer buf;
-  CLEAR(buf);
-
-  buf.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
-  buf.memory = V4L2_MEMORY_USERPTR;
+  v4l2_plane plane;
+  this->PrepareBuffer(buf, plane, bufferIndex);
 
-  if (-1 == xioctl(this->FileDescriptor, VIDIOC_DQBUF, &buf))
+  if (this->IOMethod == IO_METHOD_USERPTR)
   {
-    switch (errno)
+    if (this->IsMultiPlanar())
     {
-      case EAGAIN:
-      {
-        return PLUS_FAIL;
-      }
-      case EIO:
-      {
-        // Could ignore EIO, see spec
-      }
-      default:
-      {
-        LOG_ERROR("VIDIOC_DQBUF" << ": " << strerror(errno));
-        return PLUS_FAIL;
-      }
+      plane.m.userptr = (unsigned long) this->FrameBuffers[bufferIndex].start;
+      plane.length = this->FrameBuffers[bufferIndex].length;
     }
-  }
-
-  for (currentBufferIndex = 0; currentBufferIndex < this->BufferCount; ++currentBufferIndex)
-  {
-    if (buf.m.userptr == (unsigned long) this->FrameBuffers[currentBufferIndex].start && buf.length == this->FrameBuffers[currentBufferIndex].length)
+    else
     {
-      break;
+      buf.m.userptr = (unsigned long) this->FrameBuffers[bufferIndex].start;
+      buf.length = this->FrameBuffers[bufferIndex].length;
     }
   }
 
@@ -693,11 +846,54 @@ PlusStatus vtkPlusV4L2VideoSource::ReadFrameUserPtr(unsigned int& currentBufferI
     return PLUS_FAIL;
   }
 
-  bytesUsed = buf.bytesused;
-
   return PLUS_SUCCESS;
 }
 
+//----------------------------------------------------------------------------
+void vtkPlusV4L2VideoSource::PrepareBuffer(v4l2_buffer& buf, v4l2_plane& plane, unsigned int bufferIndex) const
+{
+  CLEAR(buf);
+  CLEAR(plane);
+
+  buf.type = this->BufferType;
+  // Exported DMABUFs are allocated by the driver, so they are queued the same way as memory mapped buffers
+  buf.memory = (this->IOMethod == IO_METHOD_USERPTR) ? V4L2_MEMORY_USERPTR : V4L2_MEMORY_MMAP;
+  buf.index = bufferIndex;
+
+  if (this->IsMultiPlanar())
+  {
+    buf.m.planes = &plane;
+    buf.length = 1;
+  }
+}
+
+//----------------------------------------------------------------------------
+bool vtkPlusV4L2VideoSource::IsMultiPlanar() const
+{
+  return this->BufferType == V4L2_BUF_TYPE_VIDEO_CAPTURE_MPLANE;
+}
+
+//----------------------------------------------------------------------------
+void vtkPlusV4L2VideoSource::GetFormat(unsigned int& width, unsigned int& height, unsigned int& pixelFormat, v4l2_field& fieldOrder, unsigned int& imageSize) const
+{
+  if (this->IsMultiPlanar())
+  {
+    width = this->DeviceFormat->fmt.pix_mp.width;
+    height = this->DeviceFormat->fmt.pix_mp.height;
+    pixelFormat = this->DeviceFormat->fmt.pix_mp.pixelformat;
+    fieldOrder = static_cast<v4l2_field>(this->DeviceFormat->fmt.pix_mp.field);
+    imageSize = this->DeviceFormat->fmt.pix_mp.plane_fmt[0].sizeimage;
+  }
+  else
+  {
+    width = this->DeviceFormat->fmt.pix.width;
+    height = this->DeviceFormat->fmt.pix.height;
+    pixelFormat = this->DeviceFormat->fmt.pix.pixelformat;
+    fieldOrder = static_cast<v4l2_field>(this->DeviceFormat->fmt.pix.field);
+    imageSize = this->DeviceFormat->fmt.pix.sizeimage;
+  }
+}
+
 //----------------------------------------------------------------------------
 PlusStatus vtkPlusV4L2VideoSource::NotifyConfigured()
 {
@@ -731,14 +927,17 @@ PlusStatus vtkPlusV4L2VideoSource::InternalStopRecording()
     }
     case IO_METHOD_MMAP:
     case IO_METHOD_USERPTR:
+    case IO_METHOD_DMABUF:
     {
-      type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+      type = this->BufferType;
       if (-1 == xioctl(this->FileDescriptor, VIDIOC_STREAMOFF, &type))
       {
         LOG_ERROR("VIDIOC_STREAMOFF" << ": " << strerror(errno));
-        break;
       }
+      break;
     }
+    default:
+    {}
   }
 
   return PLUS_SUCCESS;
@@ -752,48 +951,17 @@ PlusStatus vtkPlusV4L2VideoSource::InternalStartRecording()
   switch (this->IOMethod)
   {
     case IO_METHOD_MMAP:
-    {
-      for (unsigned int i = 0; i < this->BufferCount; ++i)
-      {
-        struct v4l2_buffer buf;
-        CLEAR(buf);
-        buf.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
-        buf.memory = V4L2_MEMORY_MMAP;
-        buf.index = i;
-
-        if (-1 == xioctl(this->FileDescriptor, VIDIOC_QBUF, &buf))
-        {
-          LOG_ERROR("VIDIOC_QBUF" << ": " << strerror(errno));
-          return PLUS_FAIL;
-        }
-      }
-      type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
-      if (-1 == xioctl(this->FileDescriptor, VIDIOC_STREAMON, &type))
-      {
-        LOG_ERROR("VIDIOC_STREAMON" << ": " << strerror(errno));
-        return PLUS_FAIL;
-      }
-      break;
-    }
     case IO_METHOD_USERPTR:
+    case IO_METHOD_DMABUF:
     {
       for (unsigned int i = 0; i < this->BufferCount; ++i)
       {
-        struct v4l2_buffer buf;
-        CLEAR(buf);
-        buf.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
-        buf.memory = V4L2_MEMORY_USERPTR;
-        buf.index = i;
-        buf.m.userptr = (unsigned long) this->FrameBuffers[i].start;
-        buf.length = this->FrameBuffers[i].length;
-
-        if (-1 == xioctl(this->FileDescriptor, VIDIOC_QBUF, &buf))
+        if (this->QueueBuffer(i) != PLUS_SUCCESS)
         {
-          LOG_ERROR("VIDIOC_QBUF" << ": " << strerror(errno));
           return PLUS_FAIL;
         }
       }
-      type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+      type = this->BufferType;
       if (-1 == xioctl(this->FileDescriptor, VIDIOC_STREAMON, &type))
       {
         LOG_ERROR("VIDIOC_STREAMON" << ": " << strerror(errno));
@@ -819,6 +987,8 @@ std::string vtkPlusV4L2VideoSource::IOMethodToString(V4L2_IO_METHOD ioMethod)
       return "IO_METHOD_MMAP";
     case IO_METHOD_USERPTR:
       return "IO_METHOD_USERPTR";
+    case IO_METHOD_DMABUF:
+      return "IO_METHOD_DMABUF";
     default:
       return "IO_METHOD_UNKNOWN";
   }
@@ -839,6 +1009,10 @@ vtkPlusV4L2VideoSource::V4L2_IO_METHOD vtkPlusV4L2VideoSource::StringToIOMethod(
   {
     return IO_METHOD_USERPTR;
   }
+  else if (PlusCommon::IsEqualInsensitive(method, "IO_METHOD_DMABUF"))
+  {
+    return IO_METHOD_DMABUF;
+  }
   else
   {
     return IO_METHOD_UNKNOWN;
@@ -21,6 +21,15 @@ class vtkPlusDataSource;
 
  Requires the PLUS_USE_V4L2 option in CMake.
 
+ The streaming I/O methods (IO_METHOD_MMAP, IO_METHOD_USERPTR, IO_METHOD_DMABUF) keep QueueDepth buffers queued
+ in the driver. A dequeued buffer is copied directly into the stream buffer of the data source and is given back
+ to the driver only after that, so the driver cannot overwrite a frame while it is being added.
+ IO_METHOD_DMABUF exports the driver buffers as DMABUF file descriptors and reads the frames through the mapped
+ DMABUF, synchronized with DMA_BUF_IOCTL_SYNC. It is only available if linux/dma-buf.h was found at configure time.
+ The default IOMethod is IO_METHOD_READ. The streaming methods save a copy per frame, set IOMethod explicitly to use them.
+ Both the single-planar and the multi-planar V4L2 API are supported (the latter is selected if the device only
+ supports multi-planar capture), but only pixel formats that store the image in a single plane.
+
  \ingroup PlusLibDataCollection
  */
 
@@ -31,13 +40,15 @@ class vtkPlusDataCollectionExport vtkPlusV4L2VideoSource : public vtkPlusDevice
     IO_METHOD_UNKNOWN,
     IO_METHOD_READ,
     IO_METHOD_MMAP,
-    IO_METHOD_USERPTR
+    IO_METHOD_USERPTR,
+    IO_METHOD_DMABUF
   };
 
   struct FrameBuffer
   {
     void* start;
     size_t length;
+    int dmabufFileDescriptor; // Only used in IO_METHOD_DMABUF
   };
 
 public:
@@ -63,15 +74,33 @@ public:
   vtkSetStdStringMacro(DeviceName);
   vtkGetStdStringMacro(DeviceName);
 
+  /*! Number of buffers requested from the driver in the streaming I/O methods. The driver may adjust it on connect. */
+  vtkSetMacro(QueueDepth, unsigned int);
+  vtkGetMacro(QueueDepth, unsigned int);
+
 protected:
   vtkPlusV4L2VideoSource();
   ~vtkPlusV4L2VideoSource();
 
-  PlusStatus ReadFrame(unsigned int& currentBufferIndex, unsigned int& bytesUsed);
+  /*!
+    Get the next frame from the device. In the streaming I/O methods the buffer is dequeued and remains owned by
+    this class until QueueBuffer is called with currentBufferIndex. The frame starts at dataOffset in the buffer.
+  */
+  PlusStatus ReadFrame(unsigned int& currentBufferIndex, unsigned int& bytesUsed, unsigned int& dataOffset);
+
+  PlusStatus ReadFrameFileDescriptor(unsigned int& currentBufferIndex, unsigned int& bytesUsed, unsigned int& dataOffset);
+  PlusStatus ReadFrameStreaming(unsigned int& currentBufferIndex, unsigned int& bytesUsed, unsigned int& dataOffset);
+
+  /*! Give a buffer to the driver for capturing (streaming I/O methods only) */
+  PlusStatus QueueBuffer(unsigned int bufferIndex);
+
+  /*! Initialize a buffer descriptor for this->BufferType and this->IOMethod (plane is used by the multi-planar API) */
+  void PrepareBuffer(v4l2_buffer& buf, v4l2_plane& plane, unsigned int bufferIndex) const;
+
+  bool IsMultiPlanar() const;
 
-  PlusStatus ReadFrameFileDescriptor(unsigned int& currentBufferIndex, unsigned int& bytesUsed);
-  PlusStatus ReadFrameMemoryMap(unsigned int& currentBufferIndex, unsigned int& bytesUsed);
-  PlusStatus ReadFrameUserPtr(unsigned int& currentBufferIndex, unsigned int& bytesUsed);
+  /*! Get the image format parameters of this->DeviceFormat, regardless of single- or multi-planar buffer type */
+  void GetFormat(unsigned int& width, unsigned int& height, unsigned int& pixelFormat, v4l2_field& fieldOrder, unsigned int& imageSize) const;
 
   PlusStatus InitRead(unsigned int bufferSize);
   PlusStatus InitMmap();
@@ -97,6 +126,7 @@ protected:
   // Configuration variables
   std::string                         DeviceName;
   V4L2_IO_METHOD                      IOMethod;
+  unsigned int                        QueueDepth;
   // If not nullptr, override these settings in InternalConnect
   std::shared_ptr<unsigned int>       FormatWidth;
   std::shared_ptr<unsigned int>       FormatHeight;
@@ -105,6 +135,7 @@ protected:
 
   // State variables
   int                                 FileDescriptor;
+  v4l2_buf_type                       BufferType; // Single- or multi-planar video capture, determined in InternalConnect
   FrameBuffer*                        FrameBuffers;
   unsigned int                        BufferCount;
   vtkPlusDataSource*                  DataSource;
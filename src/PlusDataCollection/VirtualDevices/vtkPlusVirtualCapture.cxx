@@ -15,6 +15,10 @@ See License.txt for details.
 #include "vtkPlusVirtualCapture.h"
 #include "vtksys/SystemTools.hxx"
 
+// STL includes
+#include <algorithm>
+#include <chrono>
+
 #ifdef PLUS_USE_VTKVIDEOIO_MKV
 #include "vtkPlusMkvSequenceIO.h"
 #endif
@@ -30,6 +34,9 @@ namespace
   static const double WARNING_RECORDING_LAG_SEC = 1.0; // if the recording lags more than this then a warning message will be displayed
   static const double MAX_ALLOWED_RECORDING_LAG_SEC = 3.0; // if the recording lags more than this then it'll skip frames to catch up
   static const unsigned int DISABLE_FRAME_BUFFER = std::numeric_limits<unsigned int>::max();
+  static const int WRITER_THREAD_WAKEUP_PERIOD_MS = 100; // the writer thread checks for stop requests at least this often
+  static const double DROPPED_FRAMES_REPORT_PERIOD_SEC = 5.0; // dropped frames are reported at most this often
+  static const double WRITE_RATE_AVERAGING_WEIGHT = 0.2; // weight of the latest write operation in the average write rate
 }
 
 //----------------------------------------------------------------------------
@@ -54,6 +61,18 @@ vtkPlusVirtualCapture::vtkPlusVirtualCapture()
   , FrameBufferSize(DISABLE_FRAME_BUFFER)
   , IsData3D(false)
   , WriterAccessMutex(vtkSmartPointer<vtkPlusRecursiveCriticalSection>::New())
+  , RecordingMutex(vtkSmartPointer<vtkPlusRecursiveCriticalSection>::New())
+  , MaxWriteQueueSize(300)
+  , WriteQueueFullPolicy(WRITE_QUEUE_DROP_OLDEST)
+  , WriteQueueDepth(0)
+  , WriteQueueHighWaterMark(0)
+  , LargestWriteBatchSize(0)
+  , NumberOfDroppedFrames(0)
+  , WriteRateBytesPerSec(0.0)
+  , LastDropReportTime(0.0)
+  , WriteFailed(false)
+  , WriterThreadActive(std::make_pair(false, false))
+  , WriterThreadId(-1)
   , GracePeriodLogLevel(vtkPlusLogger::LOG_LEVEL_DEBUG)
 {
   this->AcquisitionRate = 30.0;
@@ -67,11 +86,15 @@ vtkPlusVirtualCapture::vtkPlusVirtualCapture()
 //----------------------------------------------------------------------------
 vtkPlusVirtualCapture::~vtkPlusVirtualCapture()
 {
-  if (IsHeaderPrepared)
+  this->StopWriterThread();
+
+  if (this->HasUnsavedData())
   {
     this->CloseFile();
   }
 
+  this->ClearWriteQueue();
+
   if (RecordedFrames != NULL)
   {
     this->RecordedFrames->Delete();
@@ -89,6 +112,14 @@ vtkPlusVirtualCapture::~vtkPlusVirtualCapture()
 void vtkPlusVirtualCapture::PrintSelf(ostream& os, vtkIndent indent)
 {
   this->Superclass::PrintSelf(os, indent);
+  os << indent << "MaxWriteQueueSize: " << this->MaxWriteQueueSize << std::endl;
+  os << indent << "WriteQueueFullPolicy: "
+     << (this->WriteQueueFullPolicy == WRITE_QUEUE_BLOCK ? "BLOCK" : (this->WriteQueueFullPolicy == WRITE_QUEUE_DROP_NEWEST ? "DROP_NEWEST" : "DROP_OLDEST")) << std::endl;
+  os << indent << "WriteQueueDepth: " << this->GetWriteQueueDepth() << std::endl;
+  os << indent << "WriteQueueHighWaterMark: " << this->GetWriteQueueHighWaterMark() << std::endl;
+  os << indent << "LargestWriteBatchSize: " << this->GetLargestWriteBatchSize() << std::endl;
+  os << indent << "NumberOfDroppedFrames: " << this->GetNumberOfDroppedFrames() << std::endl;
+  os << indent << "WriteRateBytesPerSec: " << this->GetWriteRateBytesPerSec() << std::endl;
 }
 
 //----------------------------------------------------------------------------
@@ -108,6 +139,11 @@ PlusStatus vtkPlusVirtualCapture::ReadConfiguration(vtkXMLDataElement* rootConfi
   XML_READ_SCALAR_ATTRIBUTE_OPTIONAL(double, RequestedFrameRate, deviceConfig);
   XML_READ_SCALAR_ATTRIBUTE_OPTIONAL(int, FrameBufferSize, deviceConfig);
   XML_READ_STRING_ATTRIBUTE_OPTIONAL(CodecFourCC, deviceConfig);
+  XML_READ_SCALAR_ATTRIBUTE_OPTIONAL(int, MaxWriteQueueSize, deviceConfig);
+  XML_READ_ENUM3_ATTRIBUTE_OPTIONAL(WriteQueueFullPolicy, deviceConfig,
+                                    "DROP_OLDEST", WRITE_QUEUE_DROP_OLDEST,
+                                    "DROP_NEWEST", WRITE_QUEUE_DROP_NEWEST,
+                                    "BLOCK", WRITE_QUEUE_BLOCK);
 
   return PLUS_SUCCESS;
 }
@@ -120,6 +156,9 @@ PlusStatus vtkPlusVirtualCapture::WriteConfiguration(vtkXMLDataElement* rootConf
   deviceElement->SetAttribute("EnableFileCompression", this->EnableFileCompression ? "TRUE" : "FALSE");
   deviceElement->SetAttribute("EnableCaptureOnStart", this->EnableCapturingOnStart ? "TRUE" : "FALSE");
   deviceElement->SetDoubleAttribute("RequestedFrameRate", this->GetRequestedFrameRate());
+  deviceElement->SetIntAttribute("MaxWriteQueueSize", this->MaxWriteQueueSize);
+  deviceElement->SetAttribute("WriteQueueFullPolicy",
+                              this->WriteQueueFullPolicy == WRITE_QUEUE_BLOCK ? "BLOCK" : (this->WriteQueueFullPolicy == WRITE_QUEUE_DROP_NEWEST ? "DROP_NEWEST" : "DROP_OLDEST"));
 
   return PLUS_SUCCESS;
 }
@@ -133,6 +172,11 @@ PlusStatus vtkPlusVirtualCapture::InternalConnect()
     return PLUS_FAIL;
   }
 
+  if (this->StartWriterThread() != PLUS_SUCCESS)
+  {
+    return PLUS_FAIL;
+  }
+
   if (this->GetEnableCapturingOnStart())
   {
     this->SetEnableCapturing(true);
@@ -148,24 +192,8 @@ PlusStatus vtkPlusVirtualCapture::InternalDisconnect()
 {
   this->EnableCapturing = false;
 
-  // If outstanding frames to be written, deal with them
-  if (this->RecordedFrames->GetNumberOfTrackedFrames() != 0 && this->IsHeaderPrepared)
-  {
-    if (this->Writer->AppendImagesToHeader() != PLUS_SUCCESS)
-    {
-      LOG_ERROR("Unable to append image data to header.");
-      this->Disconnect();
-      return PLUS_FAIL;
-    }
-    if (this->Writer->WriteImages() != PLUS_SUCCESS)
-    {
-      LOG_ERROR("Unable to append images. Stopping recording at timestamp: " << this->LastAlreadyRecordedFrameTimestamp);
-      this->Disconnect();
-      return PLUS_FAIL;
-    }
-
-    this->ClearRecordedFrames();
-  }
+  // Outstanding frames are written to disk by CloseFile
+  this->StopWriterThread();
   PlusStatus status = this->CloseFile();
   return status;
 }
@@ -220,6 +248,15 @@ PlusStatus vtkPlusVirtualCapture::OpenFile(const char* aFilename)
 #endif
 
   this->Writer->SetTrackedFrameList(this->RecordedFrames);
+
+  {
+    std::lock_guard<std::mutex> queueLock(this->WriteQueueMutex);
+    this->WriteFailed = false;
+    this->WriteQueueHighWaterMark = this->WriteQueueDepth;
+    this->LargestWriteBatchSize = 0;
+    this->NumberOfDroppedFrames = 0;
+  }
+
   // Need to set the filename before finalizing header, because the pixel data file name depends on the file extension
   this->Writer->SetFileName(vtkPlusConfig::GetInstance()->GetOutputPath(aFilename));
 
@@ -230,11 +267,12 @@ PlusStatus vtkPlusVirtualCapture::OpenFile(const char* aFilename)
 PlusStatus vtkPlusVirtualCapture::CloseFile(const char* aFilename /* = NULL */, std::string* resultFilename /* = NULL */)
 {
   // Fix the header to write the correct number of frames
+  PlusLockGuard<vtkPlusRecursiveCriticalSection> recordingLock(this->RecordingMutex);
   PlusLockGuard<vtkPlusRecursiveCriticalSection> writerLock(this->WriterAccessMutex);
 
-  if (!this->IsHeaderPrepared)
+  if (!this->HasUnsavedData())
   {
-    // nothing has been prepared, so nothing to finalize
+    // nothing has been recorded, so nothing to finalize
     return PLUS_SUCCESS;
   }
 
@@ -245,10 +283,14 @@ PlusStatus vtkPlusVirtualCapture::CloseFile(const char* aFilename /* = NULL */,
     this->CurrentFilename = aFilename;
   }
 
-  // Do we have any outstanding unwritten data?
-  if (this->RecordedFrames->GetNumberOfTrackedFrames() != 0)
+  // Write all the outstanding recorded and queued frames
+  this->WriteFrames(true);
+
+  if (!this->IsHeaderPrepared)
   {
-    this->WriteFrames(true);
+    // no frames could be written, so there is nothing to finalize
+    this->TotalFramesRecorded = 0;
+    return PLUS_FAIL;
   }
 
   this->Writer->UpdateDimensionsCustomStrings(this->TotalFramesRecorded, this->GetIsData3D());
@@ -315,8 +357,17 @@ PlusStatus vtkPlusVirtualCapture::InternalUpdate()
 
   if (this->TimeWaited < samplingPeriodSec)
   {
-    // Nothing to do yet
-    return PLUS_SUCCESS;
+    // The update thread is woken up when new input data arrives, so record the data right away if the next frame is already available
+    double latestInputTimestamp = 0;
+    bool nextFrameAvailable = !this->OutputChannels.empty()
+                              && (!this->OutputChannels[0]->HasVideoSource() || this->OutputChannels[0]->GetVideoDataAvailable())
+                              && this->OutputChannels[0]->GetLatestTimestamp(latestInputTimestamp) == PLUS_SUCCESS
+                              && latestInputTimestamp >= this->NextFrameToBeRecordedTimestamp;
+    if (!nextFrameAvailable)
+    {
+      // Nothing to do yet
+      return PLUS_SUCCESS;
+    }
   }
 
   this->TimeWaited = 0.0;
@@ -337,7 +388,8 @@ PlusStatus vtkPlusVirtualCapture::InternalUpdate()
     this->GracePeriodLogLevel = vtkPlusLogger::LOG_LEVEL_WARNING;
   }
 
-  PlusLockGuard<vtkPlusRecursiveCriticalSection> writerLock(this->WriterAccessMutex);
+  // Only the recording is locked, so that sampling does not have to wait for the writer thread
+  PlusLockGuard<vtkPlusRecursiveCriticalSection> recordingLock(this->RecordingMutex);
   if (!this->EnableCapturing)
   {
     // While this thread was waiting for the unlock, capturing was disabled, so cancel the update now
@@ -350,6 +402,7 @@ PlusStatus vtkPlusVirtualCapture::InternalUpdate()
     LOG_ERROR("Error while getting tracked frame list from data collector during capturing. Last recorded timestamp: " << std::fixed << this->NextFrameToBeRecordedTimestamp);
   }
   int nbFramesAfter = this->RecordedFrames->GetNumberOfTrackedFrames();
+  this->TotalFramesRecorded += nbFramesAfter - nbFramesBefore;
 
   // Compute the average frame rate from the ratio of recently acquired frames
   int frame1Index = this->RecordedFrames->GetNumberOfTrackedFrames() - 1; // index of the latest frame
@@ -383,8 +436,6 @@ PlusStatus vtkPlusVirtualCapture::InternalUpdate()
     return PLUS_FAIL;
   }
 
-  this->TotalFramesRecorded += nbFramesAfter - nbFramesBefore;
-
   if (this->TotalFramesRecorded == 0)
   {
     // We haven't received any data so far
@@ -457,7 +508,8 @@ PlusStatus vtkPlusVirtualCapture::NotifyConfigured()
 //-----------------------------------------------------------------------------
 bool vtkPlusVirtualCapture::HasUnsavedData() const
 {
-  return this->IsHeaderPrepared;
+  // Frames may be recorded or queued before the header is prepared
+  return this->IsHeaderPrepared || this->TotalFramesRecorded > 0;
 }
 
 //-----------------------------------------------------------------------------
@@ -505,6 +557,7 @@ void vtkPlusVirtualCapture::SetEnableCapturing(bool aValue)
 PlusStatus vtkPlusVirtualCapture::Reset()
 {
   {
+    PlusLockGuard<vtkPlusRecursiveCriticalSection> recordingLock(this->RecordingMutex);
     PlusLockGuard<vtkPlusRecursiveCriticalSection> writerLock(this->WriterAccessMutex);
 
     this->SetEnableCapturing(false);
@@ -515,6 +568,7 @@ PlusStatus vtkPlusVirtualCapture::Reset()
     }
 
     this->ClearRecordedFrames();
+    this->ClearWriteQueue();
     this->Writer->GetTrackedFrameList()->Clear();
     this->IsHeaderPrepared = false;
     this->TotalFramesRecorded = 0;
@@ -546,6 +600,8 @@ PlusStatus vtkPlusVirtualCapture::TakeSnapshot()
     return PLUS_FAIL;
   }
 
+  PlusLockGuard<vtkPlusRecursiveCriticalSection> recordingLock(this->RecordingMutex);
+
   PlusTrackedFrame trackedFrame;
   if (this->GetInputTrackedFrame(trackedFrame) != PLUS_SUCCESS)
   {
@@ -590,6 +646,7 @@ PlusStatus vtkPlusVirtualCapture::TakeSnapshot()
     LOG_WARNING(this->GetDeviceId() << ": Frame could not be added because validation failed");
     return PLUS_FAIL;
   }
+  this->TotalFramesRecorded += 1;
 
   if (this->WriteFrames() != PLUS_SUCCESS)
   {
@@ -597,54 +654,372 @@ PlusStatus vtkPlusVirtualCapture::TakeSnapshot()
     return PLUS_FAIL;
   }
 
-  this->TotalFramesRecorded += 1;
-
   return PLUS_SUCCESS;
 }
 
 //-----------------------------------------------------------------------------
 PlusStatus vtkPlusVirtualCapture::WriteFrames(bool force)
 {
-  if (!this->IsHeaderPrepared && this->RecordedFrames->GetNumberOfTrackedFrames() != 0)
+  bool writeFailed = false;
   {
-    if (this->Writer->PrepareHeader() != PLUS_SUCCESS)
+    std::lock_guard<std::mutex> queueLock(this->WriteQueueMutex);
+    writeFailed = this->WriteFailed;
+  }
+  if (writeFailed)
+  {
+    // The writer thread could not write the queued frames
+    LOG_ERROR("Unable to write recorded frames. Stopping recording at timestamp: " << LastAlreadyRecordedFrameTimestamp);
+    this->ClearRecordedFrames();
+    this->StopRecording();
+    return PLUS_FAIL;
+  }
+
+  if (this->RecordedFrames->GetNumberOfTrackedFrames() != 0)
+  {
+    this->SetIsData3D(this->RecordedFrames->GetTrackedFrame(0)->GetFrameSize()[2] > 1);
+  }
+
+  if (force || !this->IsFrameBuffered() ||
+      (this->IsFrameBuffered() && this->RecordedFrames->GetNumberOfTrackedFrames() > this->GetFrameBufferSize()))
+  {
+    // All frames must be written when forced, so no frames are dropped
+    this->QueueRecordedFrames(force);
+  }
+
+  if (force)
+  {
+    // Write immediately on this thread instead of waiting for the writer thread (which may not even run)
+    PlusLockGuard<vtkPlusRecursiveCriticalSection> writerLock(this->WriterAccessMutex);
+    if (this->WriteQueuedFrames() != PLUS_SUCCESS)
     {
-      LOG_ERROR("Unable to prepare header");
       this->StopRecording();
       return PLUS_FAIL;
     }
-    this->IsHeaderPrepared = true;
   }
 
-  if (this->RecordedFrames->GetNumberOfTrackedFrames() == 0)
+  return PLUS_SUCCESS;
+}
+
+//-----------------------------------------------------------------------------
+PlusStatus vtkPlusVirtualCapture::QueueRecordedFrames(bool ignoreQueueLimit)
+{
+  int numberOfFrames = static_cast<int>(this->RecordedFrames->GetNumberOfTrackedFrames());
+  if (numberOfFrames == 0)
   {
     return PLUS_SUCCESS;
   }
 
-  this->SetIsData3D(this->RecordedFrames->GetTrackedFrame(0)->GetFrameSize()[2] > 1);
+  int numberOfDroppedFrames = 0;
+  {
+    std::unique_lock<std::mutex> queueLock(this->WriteQueueMutex);
 
-  if (force || !this->IsFrameBuffered() ||
-      (this->IsFrameBuffered() && this->RecordedFrames->GetNumberOfTrackedFrames() > this->GetFrameBufferSize()))
+    if (!ignoreQueueLimit && this->MaxWriteQueueSize > 0 && this->WriteQueueDepth > 0
+        && this->WriteQueueDepth + numberOfFrames > this->MaxWriteQueueSize)
+    {
+      switch (this->WriteQueueFullPolicy)
+      {
+        case WRITE_QUEUE_BLOCK:
+          this->FramesDequeued.wait(queueLock, [this, numberOfFrames]
+          {
+            return this->WriteFailed || !this->WriterThreadActive.second || this->WriteQueueDepth == 0
+            || this->WriteQueueDepth + numberOfFrames <= this->MaxWriteQueueSize;
+          });
+          break;
+        case WRITE_QUEUE_DROP_OLDEST:
+          while (!this->WriteQueue.empty() && this->WriteQueueDepth + numberOfFrames > this->MaxWriteQueueSize)
+          {
+            vtkPlusTrackedFrameList* oldestFrames = this->WriteQueue.front();
+            int numberOfOldestFrames = static_cast<int>(oldestFrames->GetNumberOfTrackedFrames());
+            int numberOfExcessFrames = this->WriteQueueDepth + numberOfFrames - this->MaxWriteQueueSize;
+            if (numberOfExcessFrames >= numberOfOldestFrames)
+            {
+              oldestFrames->Delete();
+              this->WriteQueue.pop_front();
+              this->WriteQueueDepth -= numberOfOldestFrames;
+              numberOfDroppedFrames += numberOfOldestFrames;
+            }
+            else
+            {
+              oldestFrames->RemoveTrackedFrameRange(0, numberOfExcessFrames - 1);
+              this->WriteQueueDepth -= numberOfExcessFrames;
+              numberOfDroppedFrames += numberOfExcessFrames;
+            }
+          }
+          break;
+        case WRITE_QUEUE_DROP_NEWEST:
+        {
+          int numberOfFramesToKeep = std::max(this->MaxWriteQueueSize - this->WriteQueueDepth, 0);
+          if (numberOfFramesToKeep == 0)
+          {
+            this->RecordedFrames->Clear();
+          }
+          else
+          {
+            this->RecordedFrames->RemoveTrackedFrameRange(numberOfFramesToKeep, numberOfFrames - 1);
+          }
+          numberOfDroppedFrames = numberOfFrames - numberOfFramesToKeep;
+          numberOfFrames = numberOfFramesToKeep;
+        }
+        break;
+      }
+    }
+
+    if (numberOfFrames > 0)
+    {
+      // The write queue takes over the recorded frame list and recording continues in a new list
+      this->WriteQueue.push_back(this->RecordedFrames);
+      this->WriteQueueDepth += numberOfFrames;
+      this->WriteQueueHighWaterMark = std::max(this->WriteQueueHighWaterMark, this->WriteQueueDepth);
+      this->LargestWriteBatchSize = std::max(this->LargestWriteBatchSize, numberOfFrames);
+
+      vtkPlusTrackedFrameList* recordedFrames = vtkPlusTrackedFrameList::New();
+      recordedFrames->SetValidationRequirements(this->RecordedFrames->GetValidationRequirements());
+      this->RecordedFrames = recordedFrames;
+    }
+
+    this->NumberOfDroppedFrames += numberOfDroppedFrames;
+  }
+  this->FramesQueued.notify_one();
+
+  if (numberOfDroppedFrames > 0)
   {
-    if (this->Writer->AppendImagesToHeader() != PLUS_SUCCESS)
+    this->TotalFramesRecorded -= numberOfDroppedFrames;
+    double currentTimeSec = vtkPlusAccurateTimer::GetSystemTime();
+    if (currentTimeSec - this->LastDropReportTime > DROPPED_FRAMES_REPORT_PERIOD_SEC)
     {
-      LOG_ERROR("Unable to append image data to header.");
-      this->StopRecording();
+      LOG_WARNING(this->GetDeviceId() << ": Writing to disk cannot keep up with the recording, " << this->GetNumberOfDroppedFrames()
+                  << " frames have been dropped. Increase MaxWriteQueueSize or reduce RequestedFrameRate to resolve the problem.");
+      this->LastDropReportTime = currentTimeSec;
+    }
+  }
+
+  return PLUS_SUCCESS;
+}
+
+//-----------------------------------------------------------------------------
+PlusStatus vtkPlusVirtualCapture::WriteQueuedFrames()
+{
+  while (true)
+  {
+    vtkPlusTrackedFrameList* frames = NULL;
+    {
+      std::lock_guard<std::mutex> queueLock(this->WriteQueueMutex);
+      if (this->WriteFailed)
+      {
+        return PLUS_FAIL;
+      }
+      if (this->WriteQueue.empty())
+      {
+        return PLUS_SUCCESS;
+      }
+      frames = this->WriteQueue.front();
+      this->WriteQueue.pop_front();
+      this->WriteQueueDepth -= static_cast<int>(frames->GetNumberOfTrackedFrames());
+    }
+    this->FramesDequeued.notify_all();
+
+    PlusStatus status = this->WriteFrameList(frames);
+    frames->Delete();
+    if (status != PLUS_SUCCESS)
+    {
+      // Recording is stopped when WriteFrames is called next time
+      {
+        std::lock_guard<std::mutex> queueLock(this->WriteQueueMutex);
+        this->WriteFailed = true;
+      }
+      this->ClearWriteQueue();
       return PLUS_FAIL;
     }
-    if (this->Writer->WriteImages() != PLUS_SUCCESS)
+  }
+}
+
+//-----------------------------------------------------------------------------
+PlusStatus vtkPlusVirtualCapture::WriteFrameList(vtkPlusTrackedFrameList* frames)
+{
+  this->Writer->SetTrackedFrameList(frames);
+
+  if (!this->IsHeaderPrepared)
+  {
+    if (this->Writer->PrepareHeader() != PLUS_SUCCESS)
     {
-      LOG_ERROR("Unable to append images. Stopping recording at timestamp: " << LastAlreadyRecordedFrameTimestamp);
-      this->StopRecording();
+      LOG_ERROR("Unable to prepare header");
       return PLUS_FAIL;
     }
+    this->IsHeaderPrepared = true;
+  }
 
-    this->ClearRecordedFrames();
+  double startTimeSec = vtkPlusAccurateTimer::GetSystemTime();
+  if (this->Writer->AppendImagesToHeader() != PLUS_SUCCESS)
+  {
+    LOG_ERROR("Unable to append image data to header.");
+    return PLUS_FAIL;
+  }
+  if (this->Writer->WriteImages() != PLUS_SUCCESS)
+  {
+    LOG_ERROR("Unable to append images. Last frame timestamp: " << std::fixed << frames->GetMostRecentTimestamp());
+    return PLUS_FAIL;
+  }
+  double writeTimeSec = vtkPlusAccurateTimer::GetSystemTime() - startTimeSec;
+
+  unsigned long numberOfBytesWritten = 0;
+  for (unsigned int frameIndex = 0; frameIndex < frames->GetNumberOfTrackedFrames(); ++frameIndex)
+  {
+    numberOfBytesWritten += frames->GetTrackedFrame(frameIndex)->GetImageData()->GetFrameSizeInBytes();
+  }
+
+  // Release the image data right away, the writer keeps a reference to the list until the next write
+  frames->Clear();
+
+  if (writeTimeSec > 0)
+  {
+    double writeRateBytesPerSec = numberOfBytesWritten / writeTimeSec;
+    std::lock_guard<std::mutex> queueLock(this->WriteQueueMutex);
+    if (this->WriteRateBytesPerSec > 0)
+    {
+      this->WriteRateBytesPerSec = (1.0 - WRITE_RATE_AVERAGING_WEIGHT) * this->WriteRateBytesPerSec + WRITE_RATE_AVERAGING_WEIGHT * writeRateBytesPerSec;
+    }
+    else
+    {
+      this->WriteRateBytesPerSec = writeRateBytesPerSec;
+    }
+  }
+
+  return PLUS_SUCCESS;
+}
+
+//-----------------------------------------------------------------------------
+void vtkPlusVirtualCapture::ClearWriteQueue()
+{
+  {
+    std::lock_guard<std::mutex> queueLock(this->WriteQueueMutex);
+    for (std::deque<vtkPlusTrackedFrameList*>::iterator it = this->WriteQueue.begin(); it != this->WriteQueue.end(); ++it)
+    {
+      (*it)->Delete();
+    }
+    this->WriteQueue.clear();
+    this->WriteQueueDepth = 0;
+  }
+  this->FramesDequeued.notify_all();
+}
+
+//-----------------------------------------------------------------------------
+PlusStatus vtkPlusVirtualCapture::StartWriterThread()
+{
+  if (this->WriterThreadId >= 0)
+  {
+    // already running
+    return PLUS_SUCCESS;
+  }
+
+  {
+    std::lock_guard<std::mutex> queueLock(this->WriteQueueMutex);
+    this->WriterThreadActive.first = true;
+  }
+  this->WriterThreadId = this->Threader->SpawnThread((vtkThreadFunctionType)&WriterThread, this);
+  if (this->WriterThreadId < 0)
+  {
+    LOG_ERROR(this->GetDeviceId() << ": Failed to start writer thread");
+    std::lock_guard<std::mutex> queueLock(this->WriteQueueMutex);
+    this->WriterThreadActive.first = false;
+    return PLUS_FAIL;
   }
 
   return PLUS_SUCCESS;
 }
 
+//-----------------------------------------------------------------------------
+void vtkPlusVirtualCapture::StopWriterThread()
+{
+  if (this->WriterThreadId < 0)
+  {
+    // not running
+    return;
+  }
+
+  {
+    std::lock_guard<std::mutex> queueLock(this->WriteQueueMutex);
+    this->WriterThreadActive.first = false;
+  }
+  this->FramesQueued.notify_all();
+
+  // Waits until the thread exits
+  this->Threader->TerminateThread(this->WriterThreadId);
+  this->WriterThreadId = -1;
+}
+
+//-----------------------------------------------------------------------------
+void* vtkPlusVirtualCapture::WriterThread(vtkMultiThreader::ThreadInfo* data)
+{
+  vtkPlusVirtualCapture* self = (vtkPlusVirtualCapture*)(data->UserData);
+  {
+    std::lock_guard<std::mutex> queueLock(self->WriteQueueMutex);
+    self->WriterThreadActive.second = true;
+  }
+
+  while (true)
+  {
+    {
+      std::unique_lock<std::mutex> queueLock(self->WriteQueueMutex);
+      if (!self->WriterThreadActive.first)
+      {
+        break;
+      }
+      if (self->WriteQueue.empty() || self->WriteFailed)
+      {
+        self->FramesQueued.wait_for(queueLock, std::chrono::milliseconds(WRITER_THREAD_WAKEUP_PERIOD_MS));
+        continue;
+      }
+    }
+
+    // Only the writer is locked while writing to disk, so that sampling of new frames can continue
+    PlusLockGuard<vtkPlusRecursiveCriticalSection> writerLock(self->WriterAccessMutex);
+    self->WriteQueuedFrames();
+  }
+
+  {
+    std::lock_guard<std::mutex> queueLock(self->WriteQueueMutex);
+    self->WriterThreadActive.second = false;
+  }
+  // Release the recording thread if it is waiting for room in the queue
+  self->FramesDequeued.notify_all();
+  return NULL;
+}
+
+//-----------------------------------------------------------------------------
+int vtkPlusVirtualCapture::GetWriteQueueDepth()
+{
+  std::lock_guard<std::mutex> queueLock(this->WriteQueueMutex);
+  return this->WriteQueueDepth;
+}
+
+//-----------------------------------------------------------------------------
+int vtkPlusVirtualCapture::GetWriteQueueHighWaterMark()
+{
+  std::lock_guard<std::mutex> queueLock(this->WriteQueueMutex);
+  return this->WriteQueueHighWaterMark;
+}
+
+//-----------------------------------------------------------------------------
+int vtkPlusVirtualCapture::GetLargestWriteBatchSize()
+{
+  std::lock_guard<std::mutex> queueLock(this->WriteQueueMutex);
+  return this->LargestWriteBatchSize;
+}
+
+//-----------------------------------------------------------------------------
+long vtkPlusVirtualCapture::GetNumberOfDroppedFrames()
+{
+  std::lock_guard<std::mutex> queueLock(this->WriteQueueMutex);
+  return this->NumberOfDroppedFrames;
+}
+
+//-----------------------------------------------------------------------------
+double vtkPlusVirtualCapture::GetWriteRateBytesPerSec()
+{
+  std::lock_guard<std::mutex> queueLock(this->WriteQueueMutex);
+  return this->WriteRateBytesPerSec;
+}
+
 //-----------------------------------------------------------------------------
 int vtkPlusVirtualCapture::OutputChannelCount() const
 {
@@ -10,19 +10,37 @@ See License.txt for details.
 #include "vtkPlusDataCollectionExport.h"
 #include "vtkPlusDevice.h"
 #include "vtkPlusSequenceIOBase.h"
+
+// STL includes
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
 #include <string>
 
 class vtkPlusTrackedFrameList;
 
 /*!
 \class vtkPlusVirtualCapture
-\brief
+\brief Records the data of its input channel to a sequence file
+
+Frames are sampled on the internal update thread and handed over to a dedicated writer thread through a bounded
+write queue, so that slow disk operations do not delay the sampling of the input data. If the queue is full then
+frames are dropped or sampling is paused, as defined by the WriteQueueFullPolicy.
 
 \ingroup PlusLibDataCollection
 */
 class vtkPlusDataCollectionExport vtkPlusVirtualCapture : public vtkPlusDevice
 {
 public:
+  /*! Action to take when the write queue is full */
+  enum WriteQueueFullPolicyType
+  {
+    WRITE_QUEUE_DROP_OLDEST, /*!< Discard the oldest queued frames to make room for the new frames */
+    WRITE_QUEUE_DROP_NEWEST, /*!< Discard the new frames that do not fit into the queue */
+    WRITE_QUEUE_BLOCK        /*!< Wait until the writer makes room, sampling is slowed down to the speed of the disk */
+  };
+
   static vtkPlusVirtualCapture* New();
   vtkTypeMacro(vtkPlusVirtualCapture, vtkPlusDevice);
   void PrintSelf(ostream& os, vtkIndent indent);
@@ -87,6 +105,35 @@ public:
   vtkSetMacro(FrameBufferSize, unsigned int);
   vtkGetMacro(FrameBufferSize, unsigned int);
 
+  /*!
+    Maximum number of frames waiting to be written to disk, 0 means unlimited.
+    A batch of frames that is larger than the limit is still accepted if the queue is empty.
+  */
+  vtkSetMacro(MaxWriteQueueSize, int);
+  vtkGetMacro(MaxWriteQueueSize, int);
+
+  /*! Action to take when the write queue is full */
+  vtkSetMacro(WriteQueueFullPolicy, WriteQueueFullPolicyType);
+  vtkGetMacro(WriteQueueFullPolicy, WriteQueueFullPolicyType);
+
+  /*! Number of frames waiting in the write queue */
+  int GetWriteQueueDepth();
+
+  /*! Largest number of frames that waited in the write queue since the output file was opened */
+  int GetWriteQueueHighWaterMark();
+
+  /*!
+    Largest number of frames that were added to the write queue at once since the output file was opened.
+    The write queue high water mark may exceed MaxWriteQueueSize by up to this many frames.
+  */
+  int GetLargestWriteBatchSize();
+
+  /*! Number of frames discarded since the output file was opened, because the write queue was full */
+  long GetNumberOfDroppedFrames();
+
+  /*! Rate of writing image data to disk (bytes per second), averaged over recent write operations */
+  double GetWriteRateBytesPerSec();
+
   virtual vtkPlusDataCollector* GetDataCollector() { return this->DataCollector; }
 
   virtual bool IsTracker() const { return false; }
@@ -114,6 +161,33 @@ protected:
   */
   virtual PlusStatus WriteFrames(bool force = false);
 
+  /*!
+    Move the recorded frames to the write queue, applying the WriteQueueFullPolicy.
+    If ignoreQueueLimit is true then all the frames are queued, regardless of the queue size.
+  */
+  PlusStatus QueueRecordedFrames(bool ignoreQueueLimit);
+
+  /*! Write all the queued frames to disk. WriterAccessMutex must be locked by the caller. */
+  PlusStatus WriteQueuedFrames();
+
+  /*! Write the frames to the output file and release the image data. WriterAccessMutex must be locked by the caller. */
+  PlusStatus WriteFrameList(vtkPlusTrackedFrameList* frames);
+
+  /*! Discard all the frames in the write queue */
+  void ClearWriteQueue();
+
+  /*! Start the thread that writes the queued frames to disk */
+  PlusStatus StartWriterThread();
+
+  /*!
+    Stop the writer thread. Frames that are still in the queue are kept there, they are written to disk
+    by the next CloseFile call (or discarded by Reset).
+  */
+  void StopWriterThread();
+
+  /*! Thread that writes the queued frames to disk */
+  static void* WriterThread(vtkMultiThreader::ThreadInfo* data);
+
 protected:
   /*! Recorded tracked frame list */
   vtkPlusTrackedFrameList* RecordedFrames;
@@ -159,11 +233,14 @@ protected:
   /*! FourCC code represending the codec to use when writing the file*/
   std::string CodecFourCC;
 
-  /*! Preparing the header requires image data already collected, this flag makes the header preparation wait until valid data is collected */
-  bool IsHeaderPrepared;
+  /*!
+    Preparing the header requires image data already collected, this flag makes the header preparation wait until valid data is collected.
+    Atomic, because it is set on the writer thread and read by HasUnsavedData from other threads.
+  */
+  std::atomic<bool> IsHeaderPrepared;
 
-  /*! Record the number of frames captured */
-  long int TotalFramesRecorded;  // hard drive will probably fill up before a regular int is hit, but still...
+  /*! Record the number of frames captured. Atomic, because it is read by HasUnsavedData from other threads. */
+  std::atomic<long> TotalFramesRecorded;  // hard drive will probably fill up before a regular int is hit, but still...
 
   /*! Whether to start capturing on connect */
   bool EnableCapturingOnStart;
@@ -175,9 +252,45 @@ protected:
 
   bool IsData3D;
 
-  /*! Mutex instance simultaneous access of writer (writer may be accessed from command processing thread and also the internal update thread) */
+  /*! Mutex instance simultaneous access of writer (writer may be accessed from command processing thread, the internal update thread, and the writer thread) */
   vtkSmartPointer<vtkPlusRecursiveCriticalSection> WriterAccessMutex;
 
+  /*!
+    Mutex protecting the recorded frames and the sampling state (accessed from command processing thread and the internal update thread).
+    If both are needed, RecordingMutex must be locked before WriterAccessMutex.
+  */
+  vtkSmartPointer<vtkPlusRecursiveCriticalSection> RecordingMutex;
+
+  /*! Frame lists waiting to be written to disk, in recording order */
+  std::deque<vtkPlusTrackedFrameList*> WriteQueue;
+
+  /*! Protects the write queue and the write statistics */
+  std::mutex WriteQueueMutex;
+
+  /*! Signaled when frames are added to the write queue */
+  std::condition_variable FramesQueued;
+
+  /*! Signaled when frames are removed from the write queue */
+  std::condition_variable FramesDequeued;
+
+  int MaxWriteQueueSize;
+  WriteQueueFullPolicyType WriteQueueFullPolicy;
+
+  /*! Number of frames in the write queue */
+  int WriteQueueDepth;
+  int WriteQueueHighWaterMark;
+  int LargestWriteBatchSize;
+  long NumberOfDroppedFrames;
+  double WriteRateBytesPerSec;
+  double LastDropReportTime;
+
+  /*! Set if writing failed on the writer thread, recording is stopped on the internal update thread */
+  bool WriteFailed;
+
+  /*! Active flag for the writer thread (first: request, second: respond), protected by WriteQueueMutex */
+  std::pair<bool, bool> WriterThreadActive;
+  int WriterThreadId;
+
   vtkPlusLogger::LogLevelType GracePeriodLogLevel;
 
   PlusStatus GetInputTrackedFrame(PlusTrackedFrame& aFrame);
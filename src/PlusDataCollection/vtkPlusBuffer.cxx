@@ -6,6 +6,7 @@ See License.txt for details.
 
 // Local includes
 #include "PlusConfigure.h"
+#include "PlusLatencyTracer.h"
 #include "PlusMath.h"
 #include "PlusTrackedFrame.h"
 #include "vtkPlusBuffer.h"
@@ -326,6 +327,7 @@ PlusStatus vtkPlusBuffer::AddItem(const PlusTrackedFrame::FieldMapType& fields,
     std::string name(it->first);
   }
 
+  this->StreamBuffer->CommitNewItem(bufferIndex);
   return PLUS_SUCCESS;
 }
 
@@ -438,6 +440,9 @@ PlusStatus vtkPlusBuffer::AddItem(void* imageDataPtr,
     return PLUS_FAIL;
   }
 
+  // The image in this slot may still be used by a reader (see GetStreamBufferItemView), don't overwrite it in that case
+  newObjectInBuffer->GetFrame().DetachSharedImage();
+
   // Skip the numberOfBytesToSkip bytes, e.g. header size
   unsigned char* byteImageDataPtr = reinterpret_cast<unsigned char*>(imageDataPtr);
   byteImageDataPtr += numberOfBytesToSkip;
@@ -453,6 +458,7 @@ PlusStatus vtkPlusBuffer::AddItem(void* imageDataPtr,
   newObjectInBuffer->SetIndex(frameNumber);
   newObjectInBuffer->SetUid(itemUid);
   newObjectInBuffer->GetFrame().SetImageType(imageType);
+  this->TraceBufferedItem(newObjectInBuffer, unfilteredTimestamp);
 
   // Add custom fields
   if (customFields != NULL)
@@ -468,6 +474,7 @@ PlusStatus vtkPlusBuffer::AddItem(void* imageDataPtr,
     }
   }
 
+  this->StreamBuffer->CommitNewItem(bufferIndex);
   return PLUS_SUCCESS;
 }
 
@@ -541,6 +548,9 @@ PlusStatus vtkPlusBuffer::AddItem(void* imageDataPtr, const FrameSizeType& frame
   newObjectInBuffer->SetIndex(frameNumber);
   newObjectInBuffer->SetUid(itemUid);
   newObjectInBuffer->GetFrame().SetImageType(imageType);
+  this->TraceBufferedItem(newObjectInBuffer, unfilteredTimestamp);
+  // The image in this slot may still be used by a reader (see GetStreamBufferItemView), don't overwrite it in that case
+  newObjectInBuffer->GetFrame().DetachSharedImage();
   memcpy(newObjectInBuffer->GetFrame().GetImage()->GetScalarPointer(), imageDataPtr, inputFrameSizeInBytes);
 
   // Add custom fields
@@ -559,9 +569,23 @@ PlusStatus vtkPlusBuffer::AddItem(void* imageDataPtr, const FrameSizeType& frame
 
   newObjectInBuffer->SetFrameField("FrameSizeInBytes", PlusCommon::ToString<unsigned int>(inputFrameSizeInBytes));
 
+  this->StreamBuffer->CommitNewItem(bufferIndex);
   return PLUS_SUCCESS;
 }
 
+//----------------------------------------------------------------------------
+void vtkPlusBuffer::TraceBufferedItem(StreamBufferItem* bufferItem, double unfilteredTimestamp)
+{
+  if (!PlusLatencyTracer::IsEnabled())
+  {
+    bufferItem->SetBufferedSystemTime(0);
+    return;
+  }
+  double bufferedSystemTime = vtkPlusAccurateTimer::GetSystemTime();
+  bufferItem->SetBufferedSystemTime(bufferedSystemTime);
+  PlusLatencyTracer::GetInstance()->RecordLatency(PlusLatencyTracer::STAGE_BUFFERED, this->DescriptiveName ? this->DescriptiveName : "", unfilteredTimestamp, bufferedSystemTime);
+}
+
 //----------------------------------------------------------------------------
 PlusStatus vtkPlusBuffer::AddTimeStampedItem(vtkMatrix4x4* matrix, ToolStatus status, unsigned long frameNumber, double unfilteredTimestamp, double filteredTimestamp/*=UNDEFINED_TIMESTAMP*/, const PlusTrackedFrame::FieldMapType* customFields /*= NULL*/)
 {
@@ -633,6 +657,7 @@ PlusStatus vtkPlusBuffer::AddTimeStampedItem(vtkMatrix4x4* matrix, ToolStatus st
     }
   }
 
+  this->StreamBuffer->CommitNewItem(bufferIndex);
   return itemStatus;
 }
 
@@ -715,6 +740,7 @@ ItemStatus vtkPlusBuffer::GetStreamBufferItem(BufferItemUidType uid, StreamBuffe
     LOCAL_LOG_WARNING("Failed to retrieve data item");
     return itemStatus;
   }
+  this->StreamBuffer->RecordItemRead(uid);
 
   if (bufferItem->DeepCopy(dataItem) != PLUS_SUCCESS)
   {
@@ -725,6 +751,58 @@ ItemStatus vtkPlusBuffer::GetStreamBufferItem(BufferItemUidType uid, StreamBuffe
   return ITEM_OK;
 }
 
+//----------------------------------------------------------------------------
+ItemStatus vtkPlusBuffer::GetStreamBufferItemView(BufferItemUidType uid, StreamBufferItem* bufferItem)
+{
+  if (bufferItem == NULL)
+  {
+    LOCAL_LOG_ERROR("Unable to copy data buffer item into a NULL data buffer item!");
+    return ITEM_UNKNOWN_ERROR;
+  }
+
+  PlusLockGuard<StreamItemCircularBuffer> dataBufferGuardedLock(this->StreamBuffer);
+
+  StreamBufferItem* dataItem = NULL;
+  ItemStatus itemStatus = this->StreamBuffer->GetBufferItemPointerFromUid(uid, dataItem);
+  if (itemStatus != ITEM_OK)
+  {
+    LOCAL_LOG_WARNING("Failed to retrieve data item");
+    return itemStatus;
+  }
+  this->StreamBuffer->RecordItemRead(uid);
+
+  if (bufferItem->ShallowCopy(dataItem) != PLUS_SUCCESS)
+  {
+    LOCAL_LOG_WARNING("Failed to copy data item");
+    return ITEM_UNKNOWN_ERROR;
+  }
+
+  return ITEM_OK;
+}
+
+//----------------------------------------------------------------------------
+bool vtkPlusBuffer::WaitForNewItem(double& lastItemTimestamp, double timeoutSec, unsigned long* lastInterruptCount /*=NULL*/)
+{
+  // The circular buffer works in local time
+  const double localTimeOffsetSec = this->StreamBuffer->GetLocalTimeOffsetSec();
+  double lastItemLocalTimestamp = (lastItemTimestamp == UNDEFINED_TIMESTAMP ? UNDEFINED_TIMESTAMP : lastItemTimestamp - localTimeOffsetSec);
+  bool newItemAvailable = this->StreamBuffer->WaitForNewItem(lastItemLocalTimestamp, timeoutSec, lastInterruptCount);
+  lastItemTimestamp = lastItemLocalTimestamp + localTimeOffsetSec;
+  return newItemAvailable;
+}
+
+//----------------------------------------------------------------------------
+void vtkPlusBuffer::InterruptWaitForNewItem()
+{
+  this->StreamBuffer->InterruptWaitForNewItem();
+}
+
+//----------------------------------------------------------------------------
+unsigned long vtkPlusBuffer::GetWaitInterruptCount()
+{
+  return this->StreamBuffer->GetWaitInterruptCount();
+}
+
 //----------------------------------------------------------------------------
 void vtkPlusBuffer::DeepCopy(vtkPlusBuffer* buffer)
 {
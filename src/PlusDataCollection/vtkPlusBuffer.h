@@ -151,6 +151,23 @@ public:
 
   /*! Get a frame with the specified frame uid from the buffer */
   virtual ItemStatus GetStreamBufferItem(BufferItemUidType uid, StreamBufferItem* bufferItem);
+  /*!
+    Get a frame with the specified frame uid from the buffer without copying the pixel data.
+    The returned item shares the image with the buffer. The buffer never overwrites an image that is
+    still referenced by a view (a new image is allocated for the slot instead), therefore the view
+    remains valid even after the item is removed from the buffer. The image must be treated as read-only.
+  */
+  virtual ItemStatus GetStreamBufferItemView(BufferItemUidType uid, StreamBufferItem* bufferItem);
+  /*!
+    Block the calling thread until an item newer than lastItemTimestamp (in global time) is added to the buffer or the timeout expires.
+    See vtkPlusTimestampedCircularBuffer::WaitForNewItem for details.
+    \return true if a new item is available, false if the timeout expired or the wait was interrupted
+  */
+  virtual bool WaitForNewItem(double& lastItemTimestamp, double timeoutSec, unsigned long* lastInterruptCount = NULL);
+  /*! Wake up the threads that wait for a new item (see vtkPlusTimestampedCircularBuffer::InterruptWaitForNewItem) */
+  virtual void InterruptWaitForNewItem();
+  /*! Get the current interrupt counter value (see vtkPlusTimestampedCircularBuffer::GetWaitInterruptCount) */
+  virtual unsigned long GetWaitInterruptCount();
   /*! Get the most recent frame from the buffer */
   virtual ItemStatus GetLatestStreamBufferItem(StreamBufferItem* bufferItem)
   {
@@ -217,6 +234,22 @@ public:
     return this->StreamBuffer->GetNumberOfItems();
   }
 
+  /*! Enable tracking of the read progress of the reading threads (see vtkPlusTimestampedCircularBuffer::SetReaderTrackingEnabled) */
+  virtual void SetReaderTrackingEnabled(bool enabled)
+  {
+    this->StreamBuffer->SetReaderTrackingEnabled(enabled);
+  }
+  /*! Get the UID of the newest item that the slowest reading thread has read. Returns false if no thread reads the buffer or reader tracking is disabled. */
+  virtual bool GetSlowestReaderLatestItemUid(BufferItemUidType& uid)
+  {
+    return this->StreamBuffer->GetSlowestReaderLatestItemUid(uid);
+  }
+  /*! Get the number of items that were overwritten before the slowest reading thread read them */
+  virtual unsigned long GetNumberOfItemsOverwrittenBeforeRead()
+  {
+    return this->StreamBuffer->GetNumberOfItemsOverwrittenBeforeRead();
+  }
+
   /*!
     Get the frame rate from the buffer based on the number of frames in the buffer and the elapsed time.
     Ideal frame rate shows the mean of the frame periods in the buffer based on the frame
@@ -344,6 +377,9 @@ protected:
   /*! Get tracker buffer item from the closest timestamp */
   virtual ItemStatus GetStreamBufferItemFromClosestTime(double time, StreamBufferItem* bufferItem);
 
+  /*! Set the buffered time of a newly added video item and record its latency if latency tracing is enabled */
+  void TraceBufferedItem(StreamBufferItem* bufferItem, double unfilteredTimestamp);
+
 protected:
   /*! Image frame size in pixel */
   FrameSizeType FrameSize;
@@ -6,6 +6,7 @@ See License.txt for details.
 
 // Local includes
 #include "PlusConfigure.h"
+#include "PlusLatencyTracer.h"
 #include "PlusPlotter.h"
 #include "vtkPlusBuffer.h"
 #include "vtkPlusChannel.h"
@@ -560,16 +561,16 @@ PlusStatus vtkPlusChannel::GetTrackedFrame(double timestamp, PlusTrackedFrame& a
       return PLUS_FAIL;
     }
 
+    // Get a view of the buffer item, the pixel data is shared with the buffer (no copy is made)
     StreamBufferItem CurrentStreamBufferItem;
-    if (this->VideoSource->GetStreamBufferItem(frameUID, &CurrentStreamBufferItem) != ITEM_OK)
+    if (this->VideoSource->GetStreamBufferItemView(frameUID, &CurrentStreamBufferItem) != ITEM_OK)
     {
       LOG_ERROR("Couldn't get video buffer item by frame UID: " << frameUID);
       return PLUS_FAIL;
     }
 
-    // Copy frame
-    PlusVideoFrame frame = CurrentStreamBufferItem.GetFrame();
-    aTrackedFrame.SetImageData(frame);
+    // Share frame
+    aTrackedFrame.ShallowCopyImageData(CurrentStreamBufferItem.GetFrame());
 
     // Copy all custom fields
     StreamBufferItem::FieldMapType fieldMap = CurrentStreamBufferItem.GetFrameFieldMap();
@@ -580,6 +581,16 @@ PlusStatus vtkPlusChannel::GetTrackedFrame(double timestamp, PlusTrackedFrame& a
     }
 
     synchronizedTimestamp = CurrentStreamBufferItem.GetTimestamp(this->VideoSource->GetLocalTimeOffsetSec());
+
+    if (PlusLatencyTracer::IsEnabled())
+    {
+      double acquisitionTime = CurrentStreamBufferItem.GetUnfilteredTimestamp(0);
+      double channelReadTime = vtkPlusAccurateTimer::GetSystemTime();
+      aTrackedFrame.SetLatencyTraceTimestamp(PlusLatencyTracer::STAGE_ACQUIRED, acquisitionTime);
+      aTrackedFrame.SetLatencyTraceTimestamp(PlusLatencyTracer::STAGE_BUFFERED, CurrentStreamBufferItem.GetBufferedSystemTime());
+      aTrackedFrame.SetLatencyTraceTimestamp(PlusLatencyTracer::STAGE_CHANNEL_READ, channelReadTime);
+      PlusLatencyTracer::GetInstance()->RecordLatency(PlusLatencyTracer::STAGE_CHANNEL_READ, this->GetChannelId() ? this->GetChannelId() : "", acquisitionTime, channelReadTime);
+    }
   }
 
   if (synchronizedTimestamp == 0)
@@ -1259,6 +1270,60 @@ PlusStatus vtkPlusChannel::GetOldestTimestamp(double& ts)
   return PLUS_SUCCESS;
 }
 
+//----------------------------------------------------------------------------
+vtkPlusDataSource* vtkPlusChannel::GetNewDataNotifyingSource()
+{
+  vtkPlusDataSource* notifyingSource = NULL;
+  if (this->HasVideoSource())
+  {
+    notifyingSource = this->VideoSource;
+  }
+  else if (this->GetTrackingEnabled())
+  {
+    this->GetTimestampMasterTool(notifyingSource);
+  }
+  else if (this->FieldCount() > 0)
+  {
+    notifyingSource = this->GetFieldDataSourcesStartIterator()->second;
+  }
+  return notifyingSource;
+}
+
+//----------------------------------------------------------------------------
+bool vtkPlusChannel::WaitForNewData(double& lastDataTimestamp, double timeoutSec, unsigned long* lastInterruptCount /*=NULL*/)
+{
+  vtkPlusDataSource* notifyingSource = this->GetNewDataNotifyingSource();
+  if (notifyingSource == NULL)
+  {
+    // No buffer to wait for
+    vtkPlusAccurateTimer::Delay(timeoutSec);
+    return false;
+  }
+
+  return notifyingSource->WaitForNewItem(lastDataTimestamp, timeoutSec, lastInterruptCount);
+}
+
+//----------------------------------------------------------------------------
+void vtkPlusChannel::InterruptWaitForNewData()
+{
+  vtkPlusDataSource* notifyingSource = this->GetNewDataNotifyingSource();
+  if (notifyingSource != NULL)
+  {
+    notifyingSource->InterruptWaitForNewItem();
+  }
+}
+
+//----------------------------------------------------------------------------
+unsigned long vtkPlusChannel::GetWaitForNewDataInterruptCount()
+{
+  vtkPlusDataSource* notifyingSource = this->GetNewDataNotifyingSource();
+  if (notifyingSource == NULL)
+  {
+    return 0;
+  }
+  return notifyingSource->GetWaitInterruptCount();
+}
+
 //----------------------------------------------------------------------------
 PlusStatus vtkPlusChannel::GetMostRecentTimestamp(double& ts)
 {
@@ -139,6 +139,28 @@ public:
   /*! Return the most recent synchronized timestamp in the buffers */
   virtual PlusStatus GetMostRecentTimestamp(double& ts);
 
+  /*!
+    Block the calling thread until new data arrives to the channel or the timeout expires.
+    New data is signaled by the buffer that drives the channel sampling: the video source if there is one,
+    otherwise the timestamp master tool, otherwise the first field data source.
+    \param lastDataTimestamp In: timestamp of the newest data that the caller has already been notified about
+      (UNDEFINED_TIMESTAMP to wait for the next item). Out: timestamp of the newest item in the buffer.
+    \param timeoutSec Maximum waiting time
+    \param lastInterruptCount If not NULL then the function also returns when InterruptWaitForNewData is called
+      (see vtkPlusTimestampedCircularBuffer::WaitForNewItem)
+    \return true if new data is available, false if the timeout expired or the wait was interrupted
+  */
+  virtual bool WaitForNewData(double& lastDataTimestamp, double timeoutSec, unsigned long* lastInterruptCount = NULL);
+
+  /*! Wake up the threads that wait for new data with an interrupt counter (see WaitForNewData) */
+  virtual void InterruptWaitForNewData();
+
+  /*!
+    Get the current interrupt counter value, for initializing the lastInterruptCount of WaitForNewData
+    (see vtkPlusTimestampedCircularBuffer::GetWaitInterruptCount). Returns 0 if there is no buffer to wait for.
+  */
+  virtual unsigned long GetWaitForNewDataInterruptCount();
+
   /*! Return the oldest synchronized timestamp in the buffers */
   virtual PlusStatus GetOldestTimestamp(double& ts);
 
@@ -174,6 +196,9 @@ protected:
   /*! Get number of tracked frames between two given timestamps (inclusive) */
   virtual int GetNumberOfFramesBetweenTimestamps(double aTimestampFrom, double aTimestampTo);
 
+  /*! Get the source whose buffer signals new data in the channel (see WaitForNewData), NULL if there is none */
+  vtkPlusDataSource* GetNewDataNotifyingSource();
+
 protected:
   DataSourceContainer       FieldDataSources;
   DataSourceContainer       Tools;
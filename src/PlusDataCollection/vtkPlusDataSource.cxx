@@ -772,6 +772,24 @@ int vtkPlusDataSource::GetNumberOfItems()
   return this->GetBuffer()->GetNumberOfItems();
 }
 
+//-----------------------------------------------------------------------------
+void vtkPlusDataSource::SetReaderTrackingEnabled(bool enabled)
+{
+  this->GetBuffer()->SetReaderTrackingEnabled(enabled);
+}
+
+//-----------------------------------------------------------------------------
+bool vtkPlusDataSource::GetSlowestReaderLatestItemUid(BufferItemUidType& uid)
+{
+  return this->GetBuffer()->GetSlowestReaderLatestItemUid(uid);
+}
+
+//-----------------------------------------------------------------------------
+unsigned long vtkPlusDataSource::GetNumberOfItemsOverwrittenBeforeRead()
+{
+  return this->GetBuffer()->GetNumberOfItemsOverwrittenBeforeRead();
+}
+
 //-----------------------------------------------------------------------------
 BufferItemUidType vtkPlusDataSource::GetOldestItemUidInBuffer()
 {
@@ -814,6 +832,30 @@ ItemStatus vtkPlusDataSource::GetStreamBufferItem(BufferItemUidType uid, StreamB
   return this->GetBuffer()->GetStreamBufferItem(uid, bufferItem);
 }
 
+//-----------------------------------------------------------------------------
+ItemStatus vtkPlusDataSource::GetStreamBufferItemView(BufferItemUidType uid, StreamBufferItem* bufferItem)
+{
+  return this->GetBuffer()->GetStreamBufferItemView(uid, bufferItem);
+}
+
+//-----------------------------------------------------------------------------
+bool vtkPlusDataSource::WaitForNewItem(double& lastItemTimestamp, double timeoutSec, unsigned long* lastInterruptCount /*=NULL*/)
+{
+  return this->GetBuffer()->WaitForNewItem(lastItemTimestamp, timeoutSec, lastInterruptCount);
+}
+
+//-----------------------------------------------------------------------------
+void vtkPlusDataSource::InterruptWaitForNewItem()
+{
+  this->GetBuffer()->InterruptWaitForNewItem();
+}
+
+//-----------------------------------------------------------------------------
+unsigned long vtkPlusDataSource::GetWaitInterruptCount()
+{
+  return this->GetBuffer()->GetWaitInterruptCount();
+}
+
 //-----------------------------------------------------------------------------
 ItemStatus vtkPlusDataSource::GetLatestStreamBufferItem(StreamBufferItem* bufferItem)
 {
@@ -106,6 +106,13 @@ public:
   /*! Get the number of items in the buffer */
   virtual int GetNumberOfItems();
 
+  /*! Enable tracking of the read progress of the threads that read the buffer (disabled by default) */
+  virtual void SetReaderTrackingEnabled(bool enabled);
+  /*! Get the UID of the newest item that the slowest reading thread has read. Returns false if no thread reads the buffer or reader tracking is disabled. */
+  virtual bool GetSlowestReaderLatestItemUid(BufferItemUidType& uid);
+  /*! Get the number of items that were overwritten before the slowest reading thread read them */
+  virtual unsigned long GetNumberOfItemsOverwrittenBeforeRead();
+
   /*! Get the index assigned by the data acquisition system (usually a counter) from the buffer by frame UID. */
   virtual ItemStatus GetIndex(const BufferItemUidType uid, unsigned long& index);
 
@@ -134,6 +141,14 @@ public:
 
   /*! Get a frame with the specified frame uid from the buffer */
   virtual ItemStatus GetStreamBufferItem(BufferItemUidType uid, StreamBufferItem* bufferItem);
+  /*! Get a frame with the specified frame uid from the buffer, sharing the pixel data with the buffer (see vtkPlusBuffer::GetStreamBufferItemView) */
+  virtual ItemStatus GetStreamBufferItemView(BufferItemUidType uid, StreamBufferItem* bufferItem);
+  /*! Block the calling thread until a new item is added to the buffer or the timeout expires (see vtkPlusBuffer::WaitForNewItem) */
+  virtual bool WaitForNewItem(double& lastItemTimestamp, double timeoutSec, unsigned long* lastInterruptCount = NULL);
+  /*! Wake up the threads that wait for a new item (see vtkPlusBuffer::InterruptWaitForNewItem) */
+  virtual void InterruptWaitForNewItem();
+  /*! Get the current interrupt counter value (see vtkPlusBuffer::GetWaitInterruptCount) */
+  virtual unsigned long GetWaitInterruptCount();
   /*! Get the most recent frame from the buffer */
   virtual ItemStatus GetLatestStreamBufferItem(StreamBufferItem* bufferItem);
   /*! Get the oldest frame from buffer */
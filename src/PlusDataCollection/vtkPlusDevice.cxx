@@ -1323,6 +1323,8 @@ void* vtkPlusDevice::vtkDataCaptureThread(vtkMultiThreader::ThreadInfo* data)
   double rate = self->GetAcquisitionRate();
   double currtime[FRAME_RATE_AVERAGING] = {0};
   unsigned long updatecount = 0;
+  // Timestamp of the newest input item that we have been notified about
+  double lastInputDataTimestamp = UNDEFINED_TIMESTAMP;
   self->ThreadAlive = true;
 
   while (self->IsRecording() && self->GetCorrectlyConfigured())
@@ -1351,7 +1353,15 @@ void* vtkPlusDevice::vtkDataCaptureThread(vtkMultiThreader::ThreadInfo* data)
     double delay = (newtime + 1.0 / rate - vtkPlusAccurateTimer::GetSystemTime());
     if (delay > 0)
     {
-      vtkPlusAccurateTimer::Delay(delay);
+      if (!self->InputChannels.empty())
+      {
+        // Devices that process the data of other devices are updated as soon as new input data arrives
+        self->InputChannels[0]->WaitForNewData(lastInputDataTimestamp, delay);
+      }
+      else
+      {
+        vtkPlusAccurateTimer::Delay(delay);
+      }
     }
 
     updatecount++;
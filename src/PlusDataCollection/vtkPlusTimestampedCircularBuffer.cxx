@@ -8,19 +8,106 @@ See License.txt for details.
 #include "vtkPlusTimestampedCircularBuffer.h"
 
 #include "vtkDoubleArray.h"
+#include "vtkPlusAccurateTimer.h"
 #include "vtkPlusRecursiveCriticalSection.h"
 #include "vtkTable.h"
 #include "vtkVariantArray.h"
 
+#include <algorithm>
+#include <chrono>
+#include <thread>
+
 vtkStandardNewMacro(vtkPlusTimestampedCircularBuffer);
 
+namespace
+{
+  // Number of times a lock-free search is restarted because the writer overwrote the searched items,
+  // before the search is performed with the buffer locked
+  const int MAX_LOCK_FREE_SEARCH_ATTEMPTS = 10;
+
+  // A reader that has not read any item for this long is not taken into account when looking for the slowest reader
+  const double READER_INACTIVITY_TIMEOUT_SEC = 2.0;
+}
+
+//----------------------------------------------------------------------------
+// Metadata of an item, protected by a sequence lock: the writer makes the sequence number odd while
+// it updates the values, and readers retry until they read the same even sequence number before and
+// after reading the values.
+struct vtkPlusTimestampedCircularBuffer::ItemMetadataSlot
+{
+  ItemMetadataSlot()
+    : Sequence(0)
+    , Uid(0)
+    , FilteredTimestamp(0.0)
+    , UnfilteredTimestamp(0.0)
+    , Index(0)
+    , Flags(0)
+  {
+  }
+
+  void Write(const ItemMetadata& metadata)
+  {
+    const unsigned int sequence = this->Sequence.load(std::memory_order_relaxed);
+    this->Sequence.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    this->Uid.store(metadata.Uid, std::memory_order_relaxed);
+    this->FilteredTimestamp.store(metadata.FilteredTimestamp, std::memory_order_relaxed);
+    this->UnfilteredTimestamp.store(metadata.UnfilteredTimestamp, std::memory_order_relaxed);
+    this->Index.store(metadata.Index, std::memory_order_relaxed);
+    this->Flags.store(metadata.Flags, std::memory_order_relaxed);
+    this->Sequence.store(sequence + 2, std::memory_order_release);
+  }
+
+  void Read(ItemMetadata& metadata) const
+  {
+    while (true)
+    {
+      const unsigned int sequence = this->Sequence.load(std::memory_order_acquire);
+      if (sequence & 1)
+      {
+        // The writer is updating the slot
+        std::this_thread::yield();
+        continue;
+      }
+      metadata.Uid = this->Uid.load(std::memory_order_relaxed);
+      metadata.FilteredTimestamp = this->FilteredTimestamp.load(std::memory_order_relaxed);
+      metadata.UnfilteredTimestamp = this->UnfilteredTimestamp.load(std::memory_order_relaxed);
+      metadata.Index = this->Index.load(std::memory_order_relaxed);
+      metadata.Flags = this->Flags.load(std::memory_order_relaxed);
+      std::atomic_thread_fence(std::memory_order_acquire);
+      if (this->Sequence.load(std::memory_order_relaxed) == sequence)
+      {
+        return;
+      }
+    }
+  }
+
+  std::atomic<unsigned int> Sequence;
+  std::atomic<BufferItemUidType> Uid;
+  std::atomic<double> FilteredTimestamp;
+  std::atomic<double> UnfilteredTimestamp;
+  std::atomic<unsigned long> Index;
+  std::atomic<int> Flags;
+};
+
 //----------------------------------------------------------------------------
 vtkPlusTimestampedCircularBuffer::vtkPlusTimestampedCircularBuffer()
   : Mutex(vtkPlusRecursiveCriticalSection::New())
+  , NumberOfItems(0)
   , WritePointer(0)
   , CurrentTimeStamp(0.0)
   , LocalTimeOffsetSec(0.0)
   , LatestItemUid(0)
+  , PublishedStateSequence(0)
+  , PublishedLatestItemUid(0)
+  , PublishedNumberOfItems(0)
+  , PublishedWritePointer(0)
+  , PublishedBufferSize(0)
+  , PublishedSlots(NULL)
+  , NewestItemTimestamp(0.0)
+  , WaitInterruptCount(0)
+  , ReaderTrackingEnabled(false)
+  , NumberOfItemsOverwrittenBeforeRead(0)
   , AveragedItemsForFiltering(20)
   , MaxAllowedFilteringTimeDifference(0.5)
   , TimeStampReportTable(NULL)
@@ -54,6 +141,11 @@ vtkPlusTimestampedCircularBuffer::~vtkPlusTimestampedCircularBuffer()
     this->TimeStampReportTable = NULL;
   }
 
+  for (std::vector<ItemMetadataSlot*>::iterator it = this->ItemMetadataSlotArrays.begin(); it != this->ItemMetadataSlotArrays.end(); ++it)
+  {
+    delete[] *it;
+  }
+  this->ItemMetadataSlotArrays.clear();
 }
 
 //----------------------------------------------------------------------------
@@ -79,6 +171,17 @@ PlusStatus vtkPlusTimestampedCircularBuffer::PrepareForNewItem(const double time
     return PLUS_FAIL;
   }
 
+  if (this->ReaderTrackingEnabled && this->NumberOfItems >= this->GetBufferSize() && !this->ReaderProgressMap.empty())
+  {
+    // The oldest item is overwritten, check if the slowest reader has got it already
+    const BufferItemUidType overwrittenItemUid = this->LatestItemUid - (this->NumberOfItems - 1);
+    BufferItemUidType slowestReaderLatestItemUid = 0;
+    if (this->FindSlowestReaderLatestItemUid(slowestReaderLatestItemUid) && overwrittenItemUid > slowestReaderLatestItemUid)
+    {
+      this->NumberOfItemsOverwrittenBeforeRead++;
+    }
+  }
+
   // Increase frame unique ID
   newFrameUid = ++this->LatestItemUid;
   bufferIndex = this->WritePointer;
@@ -95,9 +198,304 @@ PlusStatus vtkPlusTimestampedCircularBuffer::PrepareForNewItem(const double time
     this->WritePointer = 0;
   }
 
+  // The slot is overwritten first, so that readers that still see the previous state detect that the item in this slot is gone
+  ItemMetadata metadata = { newFrameUid, timestamp, timestamp, 0, 0 };
+  this->WriteItemMetadata(bufferIndex, metadata);
+  this->PublishState();
+
   return PLUS_SUCCESS;
 }
 
+//----------------------------------------------------------------------------
+void vtkPlusTimestampedCircularBuffer::CommitNewItem(const int bufferIndex)
+{
+  PlusLockGuard< vtkPlusTimestampedCircularBuffer > bufferGuardedLock(this);
+  StreamBufferItem* item = this->GetBufferItemPointerFromBufferIndex(bufferIndex);
+  if (item == NULL)
+  {
+    return;
+  }
+
+  ItemMetadata metadata = { item->GetUid(), item->GetFilteredTimestamp(0), item->GetUnfilteredTimestamp(0), item->GetIndex(), ITEM_COMMITTED };
+  metadata.Flags |= (item->HasValidVideoData() ? ITEM_HAS_VALID_VIDEO_DATA : 0);
+  metadata.Flags |= (item->HasValidTransformData() ? ITEM_HAS_VALID_TRANSFORM_DATA : 0);
+  metadata.Flags |= (item->HasValidFieldData() ? ITEM_HAS_VALID_FIELD_DATA : 0);
+  this->WriteItemMetadata(bufferIndex, metadata);
+
+  this->NotifyNewItem(metadata.FilteredTimestamp);
+}
+
+//----------------------------------------------------------------------------
+void vtkPlusTimestampedCircularBuffer::ReadPublishedState(PublishedState& state)
+{
+  while (true)
+  {
+    const unsigned int sequence = this->PublishedStateSequence.load(std::memory_order_acquire);
+    if (sequence & 1)
+    {
+      // The writer is updating the state
+      std::this_thread::yield();
+      continue;
+    }
+    state.LatestItemUid = this->PublishedLatestItemUid.load(std::memory_order_relaxed);
+    state.NumberOfItems = this->PublishedNumberOfItems.load(std::memory_order_relaxed);
+    state.WritePointer = this->PublishedWritePointer.load(std::memory_order_relaxed);
+    state.BufferSize = this->PublishedBufferSize.load(std::memory_order_relaxed);
+    state.Slots = this->PublishedSlots.load(std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (this->PublishedStateSequence.load(std::memory_order_relaxed) == sequence)
+    {
+      return;
+    }
+  }
+}
+
+//----------------------------------------------------------------------------
+void vtkPlusTimestampedCircularBuffer::PublishState()
+{
+  // the caller must have locked the buffer
+  const unsigned int sequence = this->PublishedStateSequence.load(std::memory_order_relaxed);
+  this->PublishedStateSequence.store(sequence + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  this->PublishedLatestItemUid.store(this->LatestItemUid, std::memory_order_relaxed);
+  this->PublishedNumberOfItems.store(this->NumberOfItems, std::memory_order_relaxed);
+  this->PublishedWritePointer.store(this->WritePointer, std::memory_order_relaxed);
+  this->PublishedBufferSize.store(this->GetBufferSize(), std::memory_order_relaxed);
+  this->PublishedSlots.store(this->ItemMetadataSlotArrays.empty() ? NULL : this->ItemMetadataSlotArrays.back(), std::memory_order_relaxed);
+  this->PublishedStateSequence.store(sequence + 2, std::memory_order_release);
+}
+
+//----------------------------------------------------------------------------
+void vtkPlusTimestampedCircularBuffer::WriteItemMetadata(const int bufferIndex, const ItemMetadata& metadata)
+{
+  // the caller must have locked the buffer
+  if (this->ItemMetadataSlotArrays.empty() || bufferIndex < 0 || bufferIndex >= this->GetBufferSize())
+  {
+    return;
+  }
+  this->ItemMetadataSlotArrays.back()[bufferIndex].Write(metadata);
+}
+
+//----------------------------------------------------------------------------
+void vtkPlusTimestampedCircularBuffer::PublishAllItems()
+{
+  // the caller must have locked the buffer
+  const int bufferSize = this->GetBufferSize();
+  if (bufferSize > 0 && (this->ItemMetadataSlotArrays.empty() || this->PublishedBufferSize.load(std::memory_order_relaxed) != bufferSize))
+  {
+    // Readers may still use the current array, so a new one is allocated
+    this->ItemMetadataSlotArrays.push_back(new ItemMetadataSlot[bufferSize]);
+  }
+  for (int bufferIndex = 0; bufferIndex < bufferSize; ++bufferIndex)
+  {
+    StreamBufferItem& item = this->BufferItemContainer[bufferIndex];
+    ItemMetadata metadata = { item.GetUid(), item.GetFilteredTimestamp(0), item.GetUnfilteredTimestamp(0), item.GetIndex(), ITEM_COMMITTED };
+    metadata.Flags |= (item.HasValidVideoData() ? ITEM_HAS_VALID_VIDEO_DATA : 0);
+    metadata.Flags |= (item.HasValidTransformData() ? ITEM_HAS_VALID_TRANSFORM_DATA : 0);
+    metadata.Flags |= (item.HasValidFieldData() ? ITEM_HAS_VALID_FIELD_DATA : 0);
+    this->WriteItemMetadata(bufferIndex, metadata);
+  }
+  this->PublishState();
+}
+
+//----------------------------------------------------------------------------
+ItemStatus vtkPlusTimestampedCircularBuffer::ReadItemMetadata(const PublishedState& state, const BufferItemUidType uid, ItemMetadata& metadata)
+{
+  BufferItemUidType oldestUid = state.LatestItemUid - (state.NumberOfItems - 1);
+  if (uid < oldestUid || state.Slots == NULL)
+  {
+    return ITEM_NOT_AVAILABLE_ANYMORE;
+  }
+  else if (uid > state.LatestItemUid)
+  {
+    return ITEM_NOT_AVAILABLE_YET;
+  }
+  int bufferIndex = (state.WritePointer - 1) - (state.LatestItemUid - uid);
+  if (bufferIndex < 0)
+  {
+    bufferIndex += state.BufferSize;
+  }
+  state.Slots[bufferIndex].Read(metadata);
+  if (metadata.Uid != uid)
+  {
+    // The slot has been reused for a newer item since the state was read
+    return ITEM_NOT_AVAILABLE_ANYMORE;
+  }
+  return ITEM_OK;
+}
+
+//----------------------------------------------------------------------------
+ItemStatus vtkPlusTimestampedCircularBuffer::GetItemMetadata(const BufferItemUidType uid, ItemMetadata& metadata, bool committedOnly)
+{
+  PublishedState state;
+  this->ReadPublishedState(state);
+  ItemStatus status = this->ReadItemMetadata(state, uid, metadata);
+  if (status == ITEM_OK && committedOnly && !(metadata.Flags & ITEM_COMMITTED))
+  {
+    // The writer is still adding this item, it holds the lock until the item is committed
+    PlusLockGuard< vtkPlusTimestampedCircularBuffer > bufferGuardedLock(this);
+    this->ReadPublishedState(state);
+    status = this->ReadItemMetadata(state, uid, metadata);
+  }
+  if (status != ITEM_OK)
+  {
+    LOG_WARNING("Buffer item is not in the buffer (Uid: " << uid << ")!");
+  }
+  return status;
+}
+
+//----------------------------------------------------------------------------
+int vtkPlusTimestampedCircularBuffer::GetNumberOfItems()
+{
+  return this->PublishedNumberOfItems.load(std::memory_order_acquire);
+}
+
+//----------------------------------------------------------------------------
+BufferItemUidType vtkPlusTimestampedCircularBuffer::GetLatestItemUidInBuffer()
+{
+  PublishedState state;
+  this->ReadPublishedState(state);
+  return state.LatestItemUid;
+}
+
+//----------------------------------------------------------------------------
+BufferItemUidType vtkPlusTimestampedCircularBuffer::GetOldestItemUidInBuffer()
+{
+  PublishedState state;
+  this->ReadPublishedState(state);
+  // LatestItemUid - ( NumberOfItems - 1 ) is the oldest element in the buffer
+  return state.LatestItemUid - (state.NumberOfItems - 1);
+}
+
+//----------------------------------------------------------------------------
+ItemStatus vtkPlusTimestampedCircularBuffer::GetOldestTimeStamp(double& timestamp)
+{
+  // The oldest item may be removed from the buffer at any moment,
+  // therefore retry with the new oldest item if it is overwritten while it is read
+  while (true)
+  {
+    PublishedState state;
+    this->ReadPublishedState(state);
+    // LatestItemUid - ( NumberOfItems - 1 ) is the oldest element in the buffer
+    BufferItemUidType oldestUid = state.LatestItemUid - (state.NumberOfItems - 1);
+    ItemMetadata metadata;
+    ItemStatus status = this->ReadItemMetadata(state, oldestUid, metadata);
+    if (status == ITEM_OK)
+    {
+      timestamp = metadata.FilteredTimestamp + this->LocalTimeOffsetSec;
+      return ITEM_OK;
+    }
+    if (state.NumberOfItems < 1 || state.Slots == NULL)
+    {
+      LOG_WARNING("Buffer item is not in the buffer (Uid: " << oldestUid << ")!");
+      timestamp = 0;
+      return status;
+    }
+  }
+}
+
+//----------------------------------------------------------------------------
+void vtkPlusTimestampedCircularBuffer::NotifyNewItem(double timestamp)
+{
+  {
+    std::lock_guard<std::mutex> newItemLock(this->NewItemMutex);
+    this->NewestItemTimestamp = timestamp;
+  }
+  this->NewItemCondition.notify_all();
+}
+
+//----------------------------------------------------------------------------
+bool vtkPlusTimestampedCircularBuffer::WaitForNewItem(double& lastItemTimestamp, double timeoutSec, unsigned long* lastInterruptCount /*=NULL*/)
+{
+  std::unique_lock<std::mutex> newItemLock(this->NewItemMutex);
+  const double waitAfterTimestamp = (lastItemTimestamp == UNDEFINED_TIMESTAMP ? this->NewestItemTimestamp : lastItemTimestamp);
+  this->NewItemCondition.wait_for(newItemLock, std::chrono::duration<double>(std::max(timeoutSec, 0.0)),
+                                  [this, waitAfterTimestamp, lastInterruptCount]
+  {
+    return this->NewestItemTimestamp > waitAfterTimestamp
+           || (lastInterruptCount != NULL && this->WaitInterruptCount != *lastInterruptCount);
+  });
+  bool newItemAvailable = (this->NewestItemTimestamp > waitAfterTimestamp);
+  lastItemTimestamp = this->NewestItemTimestamp;
+  if (lastInterruptCount != NULL)
+  {
+    *lastInterruptCount = this->WaitInterruptCount;
+  }
+  return newItemAvailable;
+}
+
+//----------------------------------------------------------------------------
+void vtkPlusTimestampedCircularBuffer::InterruptWaitForNewItem()
+{
+  {
+    std::lock_guard<std::mutex> newItemLock(this->NewItemMutex);
+    this->WaitInterruptCount++;
+  }
+  this->NewItemCondition.notify_all();
+}
+
+//----------------------------------------------------------------------------
+unsigned long vtkPlusTimestampedCircularBuffer::GetWaitInterruptCount()
+{
+  std::lock_guard<std::mutex> newItemLock(this->NewItemMutex);
+  return this->WaitInterruptCount;
+}
+
+//----------------------------------------------------------------------------
+void vtkPlusTimestampedCircularBuffer::SetReaderTrackingEnabled(bool enabled)
+{
+  PlusLockGuard< vtkPlusTimestampedCircularBuffer > bufferGuardedLock(this);
+  this->ReaderTrackingEnabled = enabled;
+  if (!enabled)
+  {
+    this->ReaderProgressMap.clear();
+  }
+}
+
+//----------------------------------------------------------------------------
+void vtkPlusTimestampedCircularBuffer::RecordItemRead(const BufferItemUidType uid)
+{
+  // the caller must have locked the buffer
+  if (!this->ReaderTrackingEnabled)
+  {
+    return;
+  }
+  ReaderProgress& progress = this->ReaderProgressMap[std::this_thread::get_id()];
+  progress.LatestReadItemUid = std::max(progress.LatestReadItemUid, uid);
+  progress.LastReadTime = vtkPlusAccurateTimer::GetSystemTime();
+}
+
+//----------------------------------------------------------------------------
+bool vtkPlusTimestampedCircularBuffer::GetSlowestReaderLatestItemUid(BufferItemUidType& uid)
+{
+  PlusLockGuard< vtkPlusTimestampedCircularBuffer > bufferGuardedLock(this);
+  return this->FindSlowestReaderLatestItemUid(uid);
+}
+
+//----------------------------------------------------------------------------
+bool vtkPlusTimestampedCircularBuffer::FindSlowestReaderLatestItemUid(BufferItemUidType& uid)
+{
+  // the caller must have locked the buffer
+  const double currentTime = vtkPlusAccurateTimer::GetSystemTime();
+  bool readerFound = false;
+  for (std::map<std::thread::id, ReaderProgress>::iterator readerIt = this->ReaderProgressMap.begin(); readerIt != this->ReaderProgressMap.end();)
+  {
+    if (currentTime - readerIt->second.LastReadTime > READER_INACTIVITY_TIMEOUT_SEC)
+    {
+      // the reader has stopped reading (or the thread has exited)
+      this->ReaderProgressMap.erase(readerIt++);
+      continue;
+    }
+    if (!readerFound || readerIt->second.LatestReadItemUid < uid)
+    {
+      uid = readerIt->second.LatestReadItemUid;
+      readerFound = true;
+    }
+    ++readerIt;
+  }
+  return readerFound;
+}
+
 //----------------------------------------------------------------------------
 // Sets the buffer size, and copies the maximum number of the most current old
 // frames and timestamps
@@ -160,6 +558,8 @@ PlusStatus vtkPlusTimestampedCircularBuffer::SetBufferSize(int newBufferSize)
     this->NumberOfItems = this->GetBufferSize();
   }
 
+  this->PublishAllItems();
+
   this->Modified();
 
   return PLUS_SUCCESS;
@@ -208,81 +608,78 @@ StreamBufferItem* vtkPlusTimestampedCircularBuffer::GetBufferItemPointerFromBuff
 //----------------------------------------------------------------------------
 ItemStatus vtkPlusTimestampedCircularBuffer::GetFilteredTimeStamp(const BufferItemUidType uid, double& filteredTimestamp)
 {
-  PlusLockGuard< vtkPlusTimestampedCircularBuffer > bufferGuardedLock(this);
-  StreamBufferItem* itemPtr = NULL;
-  ItemStatus status = GetBufferItemPointerFromUid(uid, itemPtr);
+  // The filtered timestamp is published when the item is prepared, no need to wait for the commit
+  ItemMetadata metadata;
+  ItemStatus status = this->GetItemMetadata(uid, metadata, false);
   if (status != ITEM_OK)
   {
     filteredTimestamp = 0;
     return status;
   }
-  filteredTimestamp = itemPtr->GetFilteredTimestamp(this->LocalTimeOffsetSec);
+  filteredTimestamp = metadata.FilteredTimestamp + this->LocalTimeOffsetSec;
   return status;
 }
 
 //----------------------------------------------------------------------------
 ItemStatus vtkPlusTimestampedCircularBuffer::GetUnfilteredTimeStamp(const BufferItemUidType uid, double& unfilteredTimestamp)
 {
-  PlusLockGuard< vtkPlusTimestampedCircularBuffer > bufferGuardedLock(this);
-  StreamBufferItem* itemPtr = NULL;
-  ItemStatus status = GetBufferItemPointerFromUid(uid, itemPtr);
+  ItemMetadata metadata;
+  ItemStatus status = this->GetItemMetadata(uid, metadata, true);
   if (status != ITEM_OK)
   {
     unfilteredTimestamp = 0;
     return status;
   }
-  unfilteredTimestamp = itemPtr->GetUnfilteredTimestamp(this->LocalTimeOffsetSec);
+  unfilteredTimestamp = metadata.UnfilteredTimestamp + this->LocalTimeOffsetSec;
   return status;
 }
 
 //----------------------------------------------------------------------------
 bool vtkPlusTimestampedCircularBuffer::GetLatestItemHasValidVideoData()
 {
-  PlusLockGuard< vtkPlusTimestampedCircularBuffer > bufferGuardedLock(this);
-  if (this->NumberOfItems < 1)
-  {
-    return false;
-  }
-  int latestItemBufferIndex = (this->WritePointer > 0) ? (this->WritePointer - 1) : (this->BufferItemContainer.size() - 1);
-  return this->BufferItemContainer[latestItemBufferIndex].HasValidVideoData();
+  return this->GetLatestItemHasFlags(ITEM_HAS_VALID_VIDEO_DATA);
 }
 
 //----------------------------------------------------------------------------
 bool vtkPlusTimestampedCircularBuffer::GetLatestItemHasValidTransformData()
 {
-  PlusLockGuard< vtkPlusTimestampedCircularBuffer > bufferGuardedLock(this);
-  if (this->NumberOfItems < 1)
-  {
-    return false;
-  }
-  int latestItemBufferIndex = (this->WritePointer > 0) ? (this->WritePointer - 1) : (this->BufferItemContainer.size() - 1);
-  return this->BufferItemContainer[latestItemBufferIndex].HasValidTransformData();
+  return this->GetLatestItemHasFlags(ITEM_HAS_VALID_TRANSFORM_DATA);
 }
 
 //----------------------------------------------------------------------------
 bool vtkPlusTimestampedCircularBuffer::GetLatestItemHasValidFieldData()
 {
-  PlusLockGuard< vtkPlusTimestampedCircularBuffer > bufferGuardedLock(this);
-  if (this->NumberOfItems < 1)
+  return this->GetLatestItemHasFlags(ITEM_HAS_VALID_FIELD_DATA);
+}
+
+//----------------------------------------------------------------------------
+bool vtkPlusTimestampedCircularBuffer::GetLatestItemHasFlags(int flags)
+{
+  PublishedState state;
+  this->ReadPublishedState(state);
+  if (state.NumberOfItems < 1)
   {
     return false;
   }
-  int latestItemBufferIndex = (this->WritePointer > 0) ? (this->WritePointer - 1) : (this->BufferItemContainer.size() - 1);
-  return this->BufferItemContainer[latestItemBufferIndex].HasValidFieldData();
+  ItemMetadata metadata;
+  if (this->GetItemMetadata(state.LatestItemUid, metadata, true) != ITEM_OK)
+  {
+    return false;
+  }
+  return (metadata.Flags & flags) != 0;
 }
 
 //----------------------------------------------------------------------------
 ItemStatus vtkPlusTimestampedCircularBuffer::GetIndex(const BufferItemUidType uid, unsigned long& index)
 {
-  PlusLockGuard< vtkPlusTimestampedCircularBuffer > bufferGuardedLock(this);
-  StreamBufferItem* itemPtr = NULL;
-  ItemStatus status = GetBufferItemPointerFromUid(uid, itemPtr);
+  ItemMetadata metadata;
+  ItemStatus status = this->GetItemMetadata(uid, metadata, true);
   if (status != ITEM_OK)
   {
     index = 0;
     return status;
   }
-  index = itemPtr->GetIndex();
+  index = metadata.Index;
   return status;
 }
 
@@ -313,34 +710,66 @@ ItemStatus vtkPlusTimestampedCircularBuffer::GetBufferIndexFromTime(const double
 // that best matches the given timestamp
 ItemStatus vtkPlusTimestampedCircularBuffer::GetItemUidFromTime(const double time, BufferItemUidType& uid)
 {
-  PlusLockGuard< vtkPlusTimestampedCircularBuffer > bufferGuardedLock(this);
+  // The search does not lock the buffer. If the writer overwrites an item that the search needs
+  // then the search is restarted. If it happens too many times (the buffer is very small compared to
+  // the acquisition rate) then the search is performed with the buffer locked, so that it completes.
+  for (int attempt = 0; ; ++attempt)
+  {
+    if (attempt < MAX_LOCK_FREE_SEARCH_ATTEMPTS)
+    {
+      bool itemOverwritten = false;
+      ItemStatus status = this->FindItemUidFromTime(time, uid, itemOverwritten);
+      if (!itemOverwritten)
+      {
+        return status;
+      }
+    }
+    else
+    {
+      PlusLockGuard< vtkPlusTimestampedCircularBuffer > bufferGuardedLock(this);
+      bool itemOverwritten = false;
+      return this->FindItemUidFromTime(time, uid, itemOverwritten);
+    }
+  }
+}
+
+//----------------------------------------------------------------------------
+ItemStatus vtkPlusTimestampedCircularBuffer::FindItemUidFromTime(const double time, BufferItemUidType& uid, bool& itemOverwritten)
+{
+  itemOverwritten = false;
+  PublishedState state;
+  this->ReadPublishedState(state);
 
-  if (this->NumberOfItems == 1)
+  if (state.NumberOfItems < 1)
+  {
+    return ITEM_NOT_AVAILABLE_YET;
+  }
+
+  if (state.NumberOfItems == 1)
   {
     // There is only one item, it's the closest one to any timestamp
-    uid = this->LatestItemUid;
+    uid = state.LatestItemUid;
     return ITEM_OK;
   }
 
-  BufferItemUidType lo = this->LatestItemUid - (this->NumberOfItems - 1);   // oldest item UID
-  BufferItemUidType hi = this->LatestItemUid; // latest item UID
+  BufferItemUidType lo = state.LatestItemUid - (state.NumberOfItems - 1);   // oldest item UID
+  BufferItemUidType hi = state.LatestItemUid; // latest item UID
 
   // minimum time
-  // This method is called often, therefore instead of calling this->GetTimeStamp(lo, tlo) we perform low-level operations to get the timestamp
-  int loBufferIndex = (this->WritePointer - 1) - (this->LatestItemUid - lo);
-  if (loBufferIndex < 0)
+  ItemMetadata metadata;
+  if (this->ReadItemMetadata(state, lo, metadata) != ITEM_OK)
   {
-    loBufferIndex += this->BufferItemContainer.size();
+    itemOverwritten = true;
+    return ITEM_NOT_AVAILABLE_ANYMORE;
   }
-  double tlo = this->BufferItemContainer[loBufferIndex].GetFilteredTimestamp(this->LocalTimeOffsetSec);
+  double tlo = metadata.FilteredTimestamp + this->LocalTimeOffsetSec;
 
-  // This method is called often, therefore instead of calling this->GetTimeStamp(hi, thi) we perform low-level operations to get the timestamp
-  int hiBufferIndex = (this->WritePointer - 1) - (this->LatestItemUid - hi);
-  if (hiBufferIndex < 0)
+  if (this->ReadItemMetadata(state, hi, metadata) != ITEM_OK)
   {
-    hiBufferIndex += this->BufferItemContainer.size();
+    itemOverwritten = true;
+    return ITEM_NOT_AVAILABLE_ANYMORE;
   }
-  double thi = this->BufferItemContainer[hiBufferIndex].GetFilteredTimestamp(this->LocalTimeOffsetSec);
+  double thi = metadata.FilteredTimestamp + this->LocalTimeOffsetSec;
 
   // If the timestamp is slightly out of range then still accept it
   // (due to errors in conversions there could be slight differences)
@@ -369,15 +798,14 @@ ItemStatus vtkPlusTimestampedCircularBuffer::GetItemUidFromTime(const double tim
       }
     }
 
-    int mid = (lo + hi) / 2;
+    BufferItemUidType mid = (lo + hi) / 2;
 
-    // This is a hot loop, therefore instead of calling this->GetTimeStamp(mid, tmid) we perform low-level operations to get the timestamp
-    int midBufferIndex = (this->WritePointer - 1) - (this->LatestItemUid - mid);
-    if (midBufferIndex < 0)
+    if (this->ReadItemMetadata(state, mid, metadata) != ITEM_OK)
     {
-      midBufferIndex += this->BufferItemContainer.size();
+      itemOverwritten = true;
+      return ITEM_NOT_AVAILABLE_ANYMORE;
     }
-    double tmid = this->BufferItemContainer[midBufferIndex].GetFilteredTimestamp(this->LocalTimeOffsetSec);
+    double tmid = metadata.FilteredTimestamp + this->LocalTimeOffsetSec;
 
     if (time < tmid)
     {
@@ -390,7 +818,6 @@ ItemStatus vtkPlusTimestampedCircularBuffer::GetItemUidFromTime(const double tim
       tlo = tmid;
     }
   }
-
 }
 
 //----------------------------------------------------------------------------
@@ -411,8 +838,11 @@ void vtkPlusTimestampedCircularBuffer::DeepCopy(vtkPlusTimestampedCircularBuffer
   this->FilterContainerIndexVector = buffer->FilterContainerIndexVector;
 
   this->BufferItemContainer = buffer->BufferItemContainer;
+  this->PublishAllItems();
   this->Unlock();
   buffer->Unlock();
+
+  this->NotifyNewItem(this->CurrentTimeStamp);
 }
 
 //----------------------------------------------------------------------------
@@ -423,7 +853,13 @@ void vtkPlusTimestampedCircularBuffer::Clear()
   this->NumberOfItems = 0;
   this->CurrentTimeStamp = 0;
   this->LatestItemUid = 0;
+  // UIDs start again from the beginning, the read progress is not valid anymore
+  this->ReaderProgressMap.clear();
+  this->PublishState();
   this->Unlock();
+
+  std::lock_guard<std::mutex> newItemLock(this->NewItemMutex);
+  this->NewestItemTimestamp = 0;
 }
 
 //----------------------------------------------------------------------------
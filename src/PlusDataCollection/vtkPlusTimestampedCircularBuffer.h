@@ -10,7 +10,13 @@
 #include "PlusConfigure.h"
 #include "PlusStreamBufferItem.h"
 #include "vtkObject.h"
+#include <atomic>
+#include <condition_variable>
 #include <deque>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <vector>
 
 #include "vnl/vnl_matrix.h"
 #include "vnl/vnl_vector.h"
@@ -32,6 +38,16 @@ enum ItemStatus { ITEM_OK, ITEM_NOT_AVAILABLE_YET, ITEM_NOT_AVAILABLE_ANYMORE, I
   \class vtkPlusTimestampedCircularBuffer
   \brief This class stores an fixed number of timestamped items.
   It provides element retrieval based on timestamp, temporal filtering and interpolation, etc.
+
+  Items are added by a single writer at a time, which locks the buffer. Queries that only need the UID,
+  timestamps, or index of items (GetLatestItemUidInBuffer, GetTimeStamp, GetItemUidFromTime, GetIndex, ...)
+  do not lock the buffer, so they never block the writer. They read a copy of the item metadata that the writer
+  publishes in sequence-locked slots. Accessing the item data (GetBufferItemPointerFromUid, ...) still requires
+  locking the buffer.
+
+  If reader tracking is enabled (see SetReaderTrackingEnabled) then the buffer also tracks the read progress of each thread
+  that reads item data (see RecordItemRead), so that producers can find out how far the slowest consumer is behind
+  and how many items it has missed. It is disabled by default, because it adds work to every item read and write.
   \ingroup PlusLibCommon
 */
 class vtkPlusTimestampedCircularBuffer: public vtkObject
@@ -53,7 +69,7 @@ public:
     have been added to the list).  This will never be greater than
     the BufferSize.
   */
-  vtkGetMacro( NumberOfItems, int );
+  virtual int GetNumberOfItems();
 
   /*!
     Given a timestamp, compute the nearest frame UID
@@ -62,23 +78,10 @@ public:
   virtual ItemStatus GetItemUidFromTime( const double time, BufferItemUidType& uid );
 
   /*! Get the most recent frame UID that is already in the buffer */
-  virtual BufferItemUidType GetLatestItemUidInBuffer()
-  {
-    this->Lock();
-    BufferItemUidType latestUid = this->LatestItemUid;
-    this->Unlock();
-    return latestUid;
-  }
+  virtual BufferItemUidType GetLatestItemUidInBuffer();
 
   /*! Get the oldest frame UID in the buffer  */
-  virtual BufferItemUidType GetOldestItemUidInBuffer()
-  {
-    this->Lock();
-    // LatestItemUid - ( NumberOfItems - 1 ) is the oldest element in the buffer
-    BufferItemUidType oldestUid = this->LatestItemUid - ( this->NumberOfItems - 1 );
-    this->Unlock();
-    return oldestUid;
-  }
+  virtual BufferItemUidType GetOldestItemUidInBuffer();
 
   /*! Get timestamp by frame UID associated with the buffer item  */
   virtual ItemStatus GetLatestTimeStamp( double& timestamp )
@@ -86,17 +89,7 @@ public:
     return this->GetTimeStamp( this->GetLatestItemUidInBuffer(), timestamp );
   }
 
-  virtual ItemStatus GetOldestTimeStamp( double& timestamp )
-  {
-    // The oldest item may be removed from the buffer at any moment
-    // therefore we need to retrieve its UID and timestamp within a single lock
-    this->Lock();
-    // LatestItemUid - ( NumberOfItems - 1 ) is the oldest element in the buffer
-    BufferItemUidType oldestUid = ( this->LatestItemUid - ( this->NumberOfItems - 1 ) );
-    ItemStatus status = this->GetTimeStamp( oldestUid, timestamp );
-    this->Unlock();
-    return status;
-  }
+  virtual ItemStatus GetOldestTimeStamp( double& timestamp );
 
   virtual ItemStatus GetTimeStamp( const BufferItemUidType uid, double& timestamp ) { return this->GetFilteredTimeStamp( uid, timestamp ); }
   virtual ItemStatus GetFilteredTimeStamp( const BufferItemUidType uid, double& filteredTimestamp );
@@ -166,8 +159,72 @@ public:
   */
   virtual ItemStatus GetBufferItemPointerFromUid( const BufferItemUidType uid, StreamBufferItem*& itemPtr );
 
+  /*!
+    Reserve the buffer slot of a new item. The item becomes visible to readers with the specified (filtered) timestamp,
+    but its other metadata is only available after the item is committed.
+    The buffer must be locked until the item is committed.
+  */
   virtual PlusStatus PrepareForNewItem( const double timestamp, BufferItemUidType& newFrameUid, int& bufferIndex );
 
+  /*!
+    Publish the metadata of a new item to the readers after all of its data has been written into the buffer slot
+    (see PrepareForNewItem) and wake up all threads that wait for a new item.
+    The buffer must be locked by the caller.
+  */
+  virtual void CommitNewItem( const int bufferIndex );
+
+  /*!
+    Block the calling thread until an item newer than lastItemTimestamp is added to the buffer or the timeout expires.
+    If lastItemTimestamp is UNDEFINED_TIMESTAMP then the function waits for the next item that is added.
+    On return lastItemTimestamp is set to the timestamp of the newest item in the buffer, so it can be passed
+    to the next call without missing any items that were added in the meantime.
+    The buffer does not have to be locked by the caller (and it must not be locked, as the writer could not add new items then).
+    Timestamps are in local time.
+    \param lastInterruptCount If not NULL then the function also returns when InterruptWaitForNewItem has been called
+      since this counter was set. On return it is set to the current counter value.
+    \return true if a new item is available, false if the timeout expired or the wait was interrupted
+  */
+  virtual bool WaitForNewItem( double& lastItemTimestamp, double timeoutSec, unsigned long* lastInterruptCount = NULL );
+
+  /*!
+    Wake up the threads that wait for a new item with an interrupt counter (see WaitForNewItem),
+    even if no new item is added. A thread that is not waiting yet returns immediately from its next wait.
+  */
+  virtual void InterruptWaitForNewItem();
+
+  /*!
+    Get the current value of the interrupt counter. A waiting thread should initialize its lastInterruptCount
+    from this, otherwise interrupts that happened before it started waiting end its first wait immediately.
+  */
+  unsigned long GetWaitInterruptCount();
+
+  /*!
+    Enable tracking of the read progress of the threads that read item data. Only producers that need to know
+    how far the consumers are behind (e.g., replay of recorded data) should enable it. Disabling it forgets all readers.
+  */
+  virtual void SetReaderTrackingEnabled( bool enabled );
+  virtual bool GetReaderTrackingEnabled() { return this->ReaderTrackingEnabled; }
+
+  /*!
+    Record that the calling thread has read the data of an item. Each thread that reads item data is treated as
+    a separate reader (consumer) of the buffer. Only the newest item that a thread has read counts, so reading older items
+    (e.g., for interpolation) does not make the reader fall behind. A reader that has not read any item for
+    2 seconds is forgotten (e.g., its thread has exited). Does nothing if reader tracking is disabled. The buffer must be locked by the caller.
+  */
+  virtual void RecordItemRead( const BufferItemUidType uid );
+
+  /*!
+    Get the UID of the newest item that the slowest reader has read. Readers that have not read any item
+    recently are not taken into account. Returns false if there is no such reader.
+  */
+  virtual bool GetSlowestReaderLatestItemUid( BufferItemUidType& uid );
+
+  /*!
+    Get the number of items that were overwritten by new items before the slowest reader read them.
+    Items are only counted while there is a reader. The counter is not reset by Clear().
+  */
+  virtual unsigned long GetNumberOfItemsOverwrittenBeforeRead() { return this->NumberOfItemsOverwrittenBeforeRead; }
+
   /*!
     Create filtered and unfiltered timestamp for accurate timing of the buffer item.
     The timing may be inaccurate because the timestamp is attached to the item when Plus receives it
@@ -210,6 +267,84 @@ protected:
   vtkPlusTimestampedCircularBuffer();
   ~vtkPlusTimestampedCircularBuffer();
 
+  /*! Update the newest item timestamp and wake up all threads that wait for a new item */
+  void NotifyNewItem( double timestamp );
+
+  struct ItemMetadataSlot;
+
+  /*! Copy of the metadata of an item, which can be read without locking the buffer */
+  struct ItemMetadata
+  {
+    BufferItemUidType Uid;
+    double FilteredTimestamp;
+    double UnfilteredTimestamp;
+    unsigned long Index;
+    /*! Combination of ItemMetadataFlags */
+    int Flags;
+  };
+
+  enum ItemMetadataFlags
+  {
+    ITEM_HAS_VALID_VIDEO_DATA = 0x01,
+    ITEM_HAS_VALID_TRANSFORM_DATA = 0x02,
+    ITEM_HAS_VALID_FIELD_DATA = 0x04,
+    /*! All the data of the item has been written, see CommitNewItem */
+    ITEM_COMMITTED = 0x08
+  };
+
+  /*! State of the buffer as seen by the readers that don't lock the buffer */
+  struct PublishedState
+  {
+    BufferItemUidType LatestItemUid;
+    int NumberOfItems;
+    int WritePointer;
+    int BufferSize;
+    ItemMetadataSlot* Slots;
+  };
+
+  /*! Get a consistent snapshot of the published buffer state. Does not lock the buffer. */
+  void ReadPublishedState( PublishedState& state );
+
+  /*! Publish the current buffer state to the readers. The buffer must be locked by the caller. */
+  void PublishState();
+
+  /*! Copy the metadata of an item to its metadata slot. The buffer must be locked by the caller. */
+  void WriteItemMetadata( const int bufferIndex, const ItemMetadata& metadata );
+
+  /*! Copy the metadata of all the items in the buffer to the metadata slots and publish the buffer state. The buffer must be locked by the caller. */
+  void PublishAllItems();
+
+  /*!
+    Read the metadata of an item without locking the buffer. Returns ITEM_NOT_AVAILABLE_ANYMORE if the item
+    has been overwritten after the state was published.
+  */
+  ItemStatus ReadItemMetadata( const PublishedState& state, const BufferItemUidType uid, ItemMetadata& metadata );
+
+  /*!
+    Read the metadata of an item without locking the buffer. If committedOnly is true and the item is being written
+    then waits until the writer finishes (by locking the buffer).
+  */
+  ItemStatus GetItemMetadata( const BufferItemUidType uid, ItemMetadata& metadata, bool committedOnly );
+
+  /*! Returns true if the latest item has any of the specified data flags */
+  bool GetLatestItemHasFlags( int flags );
+
+  /*!
+    Search for the item that is the closest to the specified time without locking the buffer.
+    itemOverwritten is set to true if the search could not be completed because the writer overwrote an item that was needed.
+  */
+  ItemStatus FindItemUidFromTime( const double time, BufferItemUidType& uid, bool& itemOverwritten );
+
+  /*! Get the UID of the newest item that the slowest active reader has read, removes the inactive readers. The buffer must be locked by the caller. */
+  bool FindSlowestReaderLatestItemUid( BufferItemUidType& uid );
+
+  /*! Read progress of a thread that reads item data */
+  struct ReaderProgress
+  {
+    BufferItemUidType LatestReadItemUid;
+    double LastReadTime;
+  };
+
 protected:
   vtkPlusRecursiveCriticalSection* Mutex;
 
@@ -231,6 +366,39 @@ protected:
 
   std::deque<StreamBufferItem> BufferItemContainer;
 
+  /*!
+    Buffer state for the readers that don't lock the buffer (see ReadPublishedState).
+    The values are only consistent if they are read while PublishedStateSequence is even and unchanged.
+  */
+  std::atomic<unsigned int> PublishedStateSequence;
+  std::atomic<BufferItemUidType> PublishedLatestItemUid;
+  std::atomic<int> PublishedNumberOfItems;
+  std::atomic<int> PublishedWritePointer;
+  std::atomic<int> PublishedBufferSize;
+  std::atomic<ItemMetadataSlot*> PublishedSlots;
+
+  /*!
+    All the metadata slot arrays that have been allocated. Arrays are only deleted with the buffer,
+    as readers may still access the previous array for a short time after the buffer is resized.
+  */
+  std::vector<ItemMetadataSlot*> ItemMetadataSlotArrays;
+
+  /*! Timestamp of the newest item, protected by NewItemMutex (so that waiting threads don't need to lock the buffer) */
+  double NewestItemTimestamp;
+  std::mutex NewItemMutex;
+  /*! Signaled when a new item is added to the buffer */
+  std::condition_variable NewItemCondition;
+  /*! Number of InterruptWaitForNewItem calls, protected by NewItemMutex */
+  unsigned long WaitInterruptCount;
+
+  /*! If false then the reads are not tracked, it is only changed while the buffer is locked */
+  std::atomic<bool> ReaderTrackingEnabled;
+  /*! Read progress of each thread that reads item data, protected by the buffer lock */
+  std::map<std::thread::id, ReaderProgress> ReaderProgressMap;
+
+  /*! Number of items that were overwritten before the slowest reader read them */
+  std::atomic<unsigned long> NumberOfItemsOverwrittenBeforeRead;
+
   /*! Matrix used for storing the last number of AveragedItemsForFiltering frame index */
   vnl_vector<double> FilterContainerIndexVector;
 
@@ -0,0 +1,215 @@
+/*=Plus=header=begin======================================================
+Program: Plus
+Copyright (c) Laboratory for Percutaneous Surgery. All rights reserved.
+See License.txt for details.
+=========================================================Plus=header=end*/
+
+/*!
+\file vtkPlusBoneEnhancerTest.cxx
+\brief Verifies that the fused processing of vtkPlusBoneEnhancer produces exactly the same output as the step-by-step processing
+
+Each frame of the input sequence is processed by one enhancer through ProcessFrame (fused processing in reused buffers)
+and by another enhancer through the individual processing steps (the same path as when intermediate results are saved).
+The output images are compared byte by byte, with the default and with a modified binarization threshold range.
+*/
+
+#include "PlusConfigure.h"
+#include "PlusTrackedFrame.h"
+#include "vtkPlusBoneEnhancer.h"
+#include "vtkPlusTrackedFrameList.h"
+
+// VTK includes
+#include <vtkImageData.h>
+#include <vtkImageThreshold.h>
+#include <vtkObjectFactory.h>
+#include <vtkSmartPointer.h>
+#include <vtksys/CommandLineArguments.hxx>
+
+//----------------------------------------------------------------------------
+/*! Bone enhancer that allows changing the binarization thresholds, which are not configurable otherwise */
+class vtkPlusBoneEnhancerWithBinarizationThresholds : public vtkPlusBoneEnhancer
+{
+public:
+  static vtkPlusBoneEnhancerWithBinarizationThresholds* New();
+  vtkTypeMacro(vtkPlusBoneEnhancerWithBinarizationThresholds, vtkPlusBoneEnhancer);
+
+  void SetBinarizationThresholds(double lowerThreshold, double upperThreshold)
+  {
+    this->ImageBinarizer->ThresholdBetween(lowerThreshold, upperThreshold);
+  }
+
+protected:
+  vtkPlusBoneEnhancerWithBinarizationThresholds() {}
+};
+
+vtkStandardNewMacro(vtkPlusBoneEnhancerWithBinarizationThresholds);
+
+namespace
+{
+  //----------------------------------------------------------------------------
+  vtkSmartPointer<vtkPlusBoneEnhancerWithBinarizationThresholds> CreateEnhancer(vtkXMLDataElement* processorElement, double lowerThreshold, double upperThreshold)
+  {
+    vtkSmartPointer<vtkPlusBoneEnhancerWithBinarizationThresholds> enhancer = vtkSmartPointer<vtkPlusBoneEnhancerWithBinarizationThresholds>::New();
+    if (enhancer->ReadConfiguration(processorElement) != PLUS_SUCCESS)
+    {
+      LOG_ERROR("Unable to read the bone enhancer configuration");
+      return NULL;
+    }
+    // Intermediate results are not saved in either case, the step-by-step processing is called directly
+    enhancer->SetSaveIntermediateResults(false);
+    enhancer->SetBinarizationThresholds(lowerThreshold, upperThreshold);
+    return enhancer;
+  }
+
+  //----------------------------------------------------------------------------
+  // Returns the number of frames where the fused and step-by-step outputs differ
+  int CompareFusedAndStepByStepProcessing(vtkPlusTrackedFrameList* inputFrames, vtkXMLDataElement* processorElement, double lowerThreshold, double upperThreshold)
+  {
+    LOG_INFO("Compare fused and step-by-step processing with binarization threshold range " << lowerThreshold << "-" << upperThreshold);
+
+    vtkSmartPointer<vtkPlusBoneEnhancerWithBinarizationThresholds> fusedEnhancer = CreateEnhancer(processorElement, lowerThreshold, upperThreshold);
+    vtkSmartPointer<vtkPlusBoneEnhancerWithBinarizationThresholds> stepByStepEnhancer = CreateEnhancer(processorElement, lowerThreshold, upperThreshold);
+    if (fusedEnhancer.GetPointer() == NULL || stepByStepEnhancer.GetPointer() == NULL)
+    {
+      return 1;
+    }
+
+    int numberOfDifferences = 0;
+    int numberOfNonEmptyOutputs = 0;
+    for (unsigned int frameIndex = 0; frameIndex < inputFrames->GetNumberOfTrackedFrames(); ++frameIndex)
+    {
+      PlusTrackedFrame* inputFrame = inputFrames->GetTrackedFrame(frameIndex);
+
+      PlusTrackedFrame fusedOutputFrame(*inputFrame);
+      if (fusedEnhancer->ProcessFrame(inputFrame, &fusedOutputFrame) != PLUS_SUCCESS)
+      {
+        LOG_ERROR("Fused processing failed for frame " << frameIndex);
+        numberOfDifferences++;
+        continue;
+      }
+
+      PlusTrackedFrame stepByStepOutputFrame(*inputFrame);
+      vtkSmartPointer<vtkImageData> intermediateImage = stepByStepEnhancer->UnprocessedFrameToLinearImage(inputFrame);
+      stepByStepEnhancer->RemoveNoise(intermediateImage);
+      stepByStepEnhancer->LinearToFanImage(intermediateImage, &stepByStepOutputFrame);
+
+      PlusVideoFrame* fusedImage = fusedOutputFrame.GetImageData();
+      PlusVideoFrame* stepByStepImage = stepByStepOutputFrame.GetImageData();
+      if (!fusedImage->IsImageValid() || !stepByStepImage->IsImageValid())
+      {
+        LOG_ERROR("Missing output image for frame " << frameIndex);
+        numberOfDifferences++;
+        continue;
+      }
+      if (fusedImage->GetVTKScalarPixelType() != stepByStepImage->GetVTKScalarPixelType()
+          || fusedImage->GetFrameSizeInBytes() != stepByStepImage->GetFrameSizeInBytes())
+      {
+        LOG_ERROR("Output image geometry mismatch at frame " << frameIndex << ": fused output is " << fusedImage->GetFrameSizeInBytes()
+                  << " bytes, step-by-step output is " << stepByStepImage->GetFrameSizeInBytes() << " bytes");
+        numberOfDifferences++;
+        continue;
+      }
+      const unsigned char* fusedPixels = static_cast<const unsigned char*>(fusedImage->GetScalarPointer());
+      const unsigned char* stepByStepPixels = static_cast<const unsigned char*>(stepByStepImage->GetScalarPointer());
+      unsigned long numberOfDifferentBytes = 0;
+      bool nonEmptyOutput = false;
+      for (unsigned long i = 0; i < fusedImage->GetFrameSizeInBytes(); ++i)
+      {
+        if (fusedPixels[i] != stepByStepPixels[i])
+        {
+          numberOfDifferentBytes++;
+        }
+        if (stepByStepPixels[i] != 0)
+        {
+          nonEmptyOutput = true;
+        }
+      }
+      if (numberOfDifferentBytes > 0)
+      {
+        LOG_ERROR("Fused and step-by-step outputs differ in " << numberOfDifferentBytes << " bytes at frame " << frameIndex);
+        numberOfDifferences++;
+      }
+      if (nonEmptyOutput)
+      {
+        numberOfNonEmptyOutputs++;
+      }
+    }
+
+    LOG_INFO("Frames with non-empty output: " << numberOfNonEmptyOutputs << " of " << inputFrames->GetNumberOfTrackedFrames());
+    return numberOfDifferences;
+  }
+}
+
+//----------------------------------------------------------------------------
+int main(int argc, char** argv)
+{
+  bool printHelp = false;
+  std::string inputFileName;
+  std::string inputConfigFileName;
+  int verboseLevel = vtkPlusLogger::LOG_LEVEL_UNDEFINED;
+
+  vtksys::CommandLineArguments args;
+  args.Initialize(argc, argv);
+  args.AddArgument("--help", vtksys::CommandLineArguments::NO_ARGUMENT, &printHelp, "Print this help");
+  args.AddArgument("--input-seq-file", vtksys::CommandLineArguments::EQUAL_ARGUMENT, &inputFileName, "The filename for the input ultrasound sequence to process.");
+  args.AddArgument("--input-config-file", vtksys::CommandLineArguments::EQUAL_ARGUMENT, &inputConfigFileName, "The filename for input config file that contains the Processor element.");
+  args.AddArgument("--verbose", vtksys::CommandLineArguments::EQUAL_ARGUMENT, &verboseLevel, "Verbose level (1=error only, 2=warning, 3=info, 4=debug, 5=trace)");
+
+  if (!args.Parse())
+  {
+    std::cerr << "Problem parsing arguments" << std::endl;
+    std::cout << "Help: " << args.GetHelp() << std::endl;
+    exit(EXIT_FAILURE);
+  }
+
+  if (printHelp)
+  {
+    std::cout << args.GetHelp() << std::endl;
+    exit(EXIT_SUCCESS);
+  }
+
+  vtkPlusLogger::Instance()->SetLogLevel(verboseLevel);
+
+  if (inputFileName.empty() || inputConfigFileName.empty())
+  {
+    LOG_ERROR("The arguments --input-seq-file and --input-config-file are required");
+    exit(EXIT_FAILURE);
+  }
+
+  vtkSmartPointer<vtkPlusTrackedFrameList> trackedFrameList = vtkSmartPointer<vtkPlusTrackedFrameList>::New();
+  if (trackedFrameList->ReadFromSequenceMetafile(inputFileName) != PLUS_SUCCESS)
+  {
+    LOG_ERROR("Unable to read input sequence " << inputFileName);
+    exit(EXIT_FAILURE);
+  }
+
+  vtkSmartPointer<vtkXMLDataElement> configRootElement = vtkSmartPointer<vtkXMLDataElement>::New();
+  if (PlusXmlUtils::ReadDeviceSetConfigurationFromFile(configRootElement, inputConfigFileName.c_str()) != PLUS_SUCCESS)
+  {
+    LOG_ERROR("Unable to read configuration from file " << inputConfigFileName);
+    exit(EXIT_FAILURE);
+  }
+  vtkXMLDataElement* processorElement = configRootElement->LookupElementWithName("Processor");
+  if (processorElement == NULL || processorElement->FindNestedElementWithName("ScanConversion") == NULL)
+  {
+    LOG_ERROR("Cannot find Processor element with ScanConversion in " << inputConfigFileName);
+    exit(EXIT_FAILURE);
+  }
+
+  int numberOfFailures = 0;
+
+  // Default binarization threshold range
+  numberOfFailures += CompareFusedAndStepByStepProcessing(trackedFrameList, processorElement, 55, 255);
+
+  // The fused processing must follow the binarizer settings, including the upper threshold
+  numberOfFailures += CompareFusedAndStepByStepProcessing(trackedFrameList, processorElement, 30, 120);
+
+  if (numberOfFailures > 0)
+  {
+    LOG_ERROR("Number of failures: " << numberOfFailures);
+    return EXIT_FAILURE;
+  }
+
+  LOG_INFO("Completed Test Successfully.");
+  return EXIT_SUCCESS;
+}
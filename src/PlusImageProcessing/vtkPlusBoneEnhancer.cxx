@@ -24,11 +24,66 @@ See License.txt for details.
 
 #include "vtkImageAlgorithm.h"
 
+#include <algorithm>
 #include <cmath>
 
 //----------------------------------------------------------------------------
 vtkStandardNewMacro(vtkPlusBoneEnhancer);
 
+namespace
+{
+  // The area of fat too close to the transducer should not be considered
+  const int FAT_LAYER_TO_CUT_PX = 20;
+
+  //----------------------------------------------------------------------------
+  // Thresholds one scan line of the lines image based on its standard deviation.
+  // Computes exactly the same result for the line as vtkPlusBoneEnhancer::ThresholdViaStdDeviation.
+  void ThresholdScanLineViaStdDeviation(unsigned char* line, int lineLengthPx)
+  {
+    float vInput = 0;
+    int max = 0;
+
+    //values used to calculate the standard deviation
+    int pixelSum = 0;
+    int squearSum = 0;
+    float pixelAverage = 0;
+    float meanDiffSum;
+    float meanDiffAverage;
+    float thresholdValue;
+
+    //determine the average, sum, and max of the line
+    for (int x = lineLengthPx - 1; x >= FAT_LAYER_TO_CUT_PX; --x)
+    {
+      vInput = line[x];
+      pixelSum += vInput;
+      squearSum += vInput * vInput;
+
+      if (vInput > max)
+      {
+        max = vInput;
+      }
+    }
+    pixelAverage = pixelSum / (lineLengthPx - FAT_LAYER_TO_CUT_PX);
+
+    //determine the standard deviation of the line
+    meanDiffSum = squearSum + (lineLengthPx - FAT_LAYER_TO_CUT_PX) * pixelAverage * pixelAverage + (-2 * pixelAverage * pixelSum);
+    meanDiffAverage = meanDiffSum / (lineLengthPx - FAT_LAYER_TO_CUT_PX);
+    thresholdValue = max - 3 * pow(meanDiffAverage, 0.5f);
+
+    //if a pixel's value is too low, remove it
+    if (pixelSum != 0)
+    {
+      for (int x = lineLengthPx - 1; x >= 0; --x)
+      {
+        if (line[x] < thresholdValue && line[x] != 0)
+        {
+          line[x] = 0;
+        }
+      }
+    }
+  }
+}
+
 //----------------------------------------------------------------------------
 vtkPlusBoneEnhancer::vtkPlusBoneEnhancer()
 : ScanConverter(NULL),
@@ -55,6 +110,8 @@ vtkPlusBoneEnhancer::vtkPlusBoneEnhancer()
 
   LinesImage(NULL),
   ProcessedLinesImage(NULL),
+  FanImage(NULL),
+  ScanLineSampleOffsetsNumberOfComponents(0),
   FirstFrame(true),
 
   SaveIntermediateResults(false)
@@ -102,6 +159,12 @@ vtkPlusBoneEnhancer::vtkPlusBoneEnhancer()
   this->LinesImage->SetExtent(0, 0, 0, 0, 0, 0);
   this->ProcessedLinesImage->SetExtent(0, 0, 0, 0, 0, 0);
 
+  this->FanImage = vtkSmartPointer<vtkImageData>::New();
+  for (int i = 0; i < 6; ++i)
+  {
+    this->ScanLineSampleOffsetsInputExtent[i] = 0;
+  }
+
   this->IntermediateImageMap.clear();
 }
 
@@ -241,6 +304,9 @@ PlusStatus vtkPlusBoneEnhancer::ReadConfiguration(vtkSmartPointer<vtkXMLDataElem
   int rfImageExtent[6] = { 0, this->NumberOfSamplesPerScanLine - 1, 0, this->NumberOfScanLines - 1, 0, 0 };
   this->ScanConverter->SetInputImageExtent(rfImageExtent);
 
+  // Scan line geometry may have changed
+  this->ScanLineSampleOffsets.clear();
+
   return PLUS_SUCCESS;
 }
 
@@ -301,6 +367,9 @@ PlusStatus vtkPlusBoneEnhancer::ProcessImageExtents()
   this->LinesImage->SetExtent(linesImageExtent);
   this->LinesImage->AllocateScalars(VTK_UNSIGNED_CHAR, 1);
 
+  this->ProcessedLinesImage->SetExtent(linesImageExtent);
+  this->ProcessedLinesImage->AllocateScalars(VTK_UNSIGNED_CHAR, 1);
+
   //Set up variables related to image extents
   int dims[3] = { 0, 0, 0 };
   this->LinesImage->GetDimensions(dims);
@@ -421,9 +490,10 @@ void vtkPlusBoneEnhancer::MarkShadowOutline(vtkSmartPointer<vtkImageData> inputI
     keepInfoCounter = this->BoneOutlineDepthPx + this->BonePushBackPx;
     foundBone = false;
 
+    unsigned char* rowPointer = static_cast<unsigned char*>(inputImage->GetScalarPointer(0, y, 0));
     for (int x = dims[0] - 1; x >= 0; --x)
     {
-      vOutput = static_cast<unsigned char*>(inputImage->GetScalarPointer(x, y, 0));
+      vOutput = rowPointer + x;
 
       //If an image is detected
       if (*vOutput != 0)
@@ -623,6 +693,11 @@ void vtkPlusBoneEnhancer::ImageConjunction(vtkSmartPointer<vtkImageData> InputIm
 // Processes a given frame and marks potential bone areas.
 PlusStatus vtkPlusBoneEnhancer::ProcessFrame(PlusTrackedFrame* inputFrame, PlusTrackedFrame* outputFrame)
 {
+  if (!this->SaveIntermediateResults)
+  {
+    return this->ProcessFrameFused(inputFrame, outputFrame);
+  }
+
   //Process the input into a linear image
   vtkSmartPointer<vtkImageData> intermediateImage = this->UnprocessedFrameToLinearImage(inputFrame);
   //Remove noise and mark all possible bones
@@ -632,6 +707,196 @@ PlusStatus vtkPlusBoneEnhancer::ProcessFrame(PlusTrackedFrame* inputFrame, PlusT
   return PLUS_SUCCESS;
 }
 
+//----------------------------------------------------------------------------
+PlusStatus vtkPlusBoneEnhancer::ProcessFrameFused(PlusTrackedFrame* inputFrame, PlusTrackedFrame* outputFrame)
+{
+  if (this->FirstFrame == true)
+  {
+    //set up variables for future loops
+    this->ProcessImageExtents();
+    this->FirstFrame = false;
+  }
+  this->BoneAreasInfo.clear();
+
+  vtkImageData* inputImage = inputFrame->GetImageData()->GetImage();
+  if (inputImage == NULL)
+  {
+    LOG_ERROR("Bone enhancer received a frame without image data");
+    return PLUS_FAIL;
+  }
+
+  // Sample the input image along the scan lines and threshold each line
+  this->FillAndThresholdLinesImage(inputImage);
+
+  // Gaussian smoothing and edge detection
+  this->GaussianSmooth->SetInputData(this->LinesImage);
+  this->EdgeDetector->SetInputConnection(this->GaussianSmooth->GetOutputPort());
+  this->EdgeDetector->Update();
+  if (this->EdgeImageToBinaryImage(this->EdgeDetector->GetOutput()) != PLUS_SUCCESS)
+  {
+    return PLUS_FAIL;
+  }
+
+  // Island removal, erosion, and dilation
+  this->IslandRemover->SetInputData(this->BinaryImageForMorphology);
+  this->ImageEroder->SetKernelSize(this->ErosionKernelSize[0], this->ErosionKernelSize[1], 1);
+  this->ImageEroder->SetInputConnection(this->IslandRemover->GetOutputPort());
+  this->ImageDialator->SetKernelSize(this->DilationKernelSize[0], this->DilationKernelSize[1], 1);
+  this->ImageDialator->SetInputConnection(this->ImageEroder->GetOutputPort());
+  this->ImageDialator->Update();
+
+  // Copy into the preallocated processed lines image. Filters keep reusing their own output buffers
+  // for the next frames as long as no other object holds a reference to them.
+  vtkImageData* dilatedImage = this->ImageDialator->GetOutput();
+  if (dilatedImage->GetScalarType() != VTK_UNSIGNED_CHAR || dilatedImage->GetNumberOfPoints() != this->ProcessedLinesImage->GetNumberOfPoints())
+  {
+    LOG_ERROR("Unexpected morphological filter output: scalar type " << dilatedImage->GetScalarTypeAsString() << " with " << dilatedImage->GetNumberOfPoints() << " pixels");
+    return PLUS_FAIL;
+  }
+  memcpy(this->ProcessedLinesImage->GetScalarPointer(), dilatedImage->GetScalarPointer(), this->ProcessedLinesImage->GetNumberOfPoints() * sizeof(unsigned char));
+
+  //Detect each possible bone area, then subject it to various tests to confirm if it is valid
+  this->MarkShadowOutline(this->ProcessedLinesImage);
+  this->ProcessedLinesImage->Modified();
+
+  // Convert back to a fan image
+  this->ScanConverter->SetInputData(this->ProcessedLinesImage);
+  this->ScanConverter->SetOutput(this->FanImage);
+  this->ScanConverter->Update();
+
+  return outputFrame->GetImageData()->DeepCopyFrom(this->FanImage);
+}
+
+//----------------------------------------------------------------------------
+void vtkPlusBoneEnhancer::UpdateScanLineSampleOffsets(vtkImageData* inputImage)
+{
+  int* inputExtent = inputImage->GetExtent();
+  int numberOfComponents = inputImage->GetNumberOfScalarComponents();
+  if (!this->ScanLineSampleOffsets.empty()
+      && std::equal(inputExtent, inputExtent + 6, this->ScanLineSampleOffsetsInputExtent)
+      && numberOfComponents == this->ScanLineSampleOffsetsNumberOfComponents)
+  {
+    // up-to-date
+    return;
+  }
+
+  int* linesImageExtent = this->ScanConverter->GetInputImageExtent();
+  int lineLengthPx = linesImageExtent[1] - linesImageExtent[0] + 1;
+  int numScanLines = linesImageExtent[3] - linesImageExtent[2] + 1;
+  this->ScanLineSampleOffsets.resize(lineLengthPx * numScanLines);
+
+  // Sample positions are computed the same way as in FillLinesImage
+  for (int scanLine = 0; scanLine < numScanLines; ++scanLine)
+  {
+    double start[4] = { 0, 0, 0, 0 };
+    double end[4] = { 0, 0, 0, 0 };
+    this->ScanConverter->GetScanLineEndPoints(scanLine, start, end);
+
+    double directionVectorX = static_cast<double>(end[0] - start[0]) / (lineLengthPx - 1);
+    double directionVectorY = static_cast<double>(end[1] - start[1]) / (lineLengthPx - 1);
+    vtkIdType* lineOffsets = &this->ScanLineSampleOffsets[scanLine * lineLengthPx];
+    for (int pointIndex = 0; pointIndex < lineLengthPx; ++pointIndex)
+    {
+      int pixelCoord[3] = { 0, 0, 0 };
+      pixelCoord[0] = start[0] + directionVectorX * pointIndex;
+      pixelCoord[1] = start[1] + directionVectorY * pointIndex;
+      if (pixelCoord[0] < inputExtent[0] || pixelCoord[0] > inputExtent[1]
+          || pixelCoord[1] < inputExtent[2] || pixelCoord[1] > inputExtent[3])
+      {
+        lineOffsets[pointIndex] = -1; // outside of the specified extent
+        continue;
+      }
+      lineOffsets[pointIndex] = inputImage->ComputePointId(pixelCoord) * numberOfComponents;
+    }
+  }
+
+  std::copy(inputExtent, inputExtent + 6, this->ScanLineSampleOffsetsInputExtent);
+  this->ScanLineSampleOffsetsNumberOfComponents = numberOfComponents;
+}
+
+//----------------------------------------------------------------------------
+void vtkPlusBoneEnhancer::FillAndThresholdLinesImage(vtkImageData* inputImage)
+{
+  int dims[3] = { 0, 0, 0 };
+  this->LinesImage->GetDimensions(dims);
+
+  if (inputImage->GetScalarType() != VTK_UNSIGNED_CHAR)
+  {
+    // Pixel values have to be converted, sample them the same way as the step-by-step processing
+    this->FillLinesImage(inputImage);
+    for (int y = dims[1] - 1; y >= 0; --y)
+    {
+      ThresholdScanLineViaStdDeviation(static_cast<unsigned char*>(this->LinesImage->GetScalarPointer(0, y, 0)), dims[0]);
+    }
+    this->LinesImage->Modified();
+    return;
+  }
+
+  this->UpdateScanLineSampleOffsets(inputImage);
+
+  const unsigned char* inputPixels = static_cast<unsigned char*>(inputImage->GetScalarPointer());
+  for (int y = dims[1] - 1; y >= 0; --y)
+  {
+    unsigned char* line = static_cast<unsigned char*>(this->LinesImage->GetScalarPointer(0, y, 0));
+    const vtkIdType* lineOffsets = &this->ScanLineSampleOffsets[y * dims[0]];
+    for (int x = 0; x < dims[0]; ++x)
+    {
+      line[x] = (lineOffsets[x] < 0 ? 0 : inputPixels[lineOffsets[x]]);
+    }
+    ThresholdScanLineViaStdDeviation(line, dims[0]);
+  }
+  this->LinesImage->Modified();
+}
+
+//----------------------------------------------------------------------------
+PlusStatus vtkPlusBoneEnhancer::EdgeImageToBinaryImage(vtkImageData* edgeImage)
+{
+  if (edgeImage->GetScalarType() != VTK_DOUBLE || edgeImage->GetNumberOfScalarComponents() < 2)
+  {
+    LOG_ERROR("Unexpected edge detector output: scalar type " << edgeImage->GetScalarTypeAsString() << " with " << edgeImage->GetNumberOfScalarComponents() << " components");
+    return PLUS_FAIL;
+  }
+
+  int dims[3] = { 0, 0, 0 };
+  this->LinesImage->GetDimensions(dims);
+  int numberOfComponents = edgeImage->GetNumberOfScalarComponents();
+
+  // Binarize the same way as ImageBinarizer, using its current settings. Input and output scalar type is unsigned char,
+  // vtkImageThreshold clamps the thresholds and values to the scalar type range.
+  const unsigned char lowerThreshold = static_cast<unsigned char>(std::max(0.0, std::min(255.0, this->ImageBinarizer->GetLowerThreshold())));
+  const unsigned char upperThreshold = static_cast<unsigned char>(std::max(0.0, std::min(255.0, this->ImageBinarizer->GetUpperThreshold())));
+  const bool replaceIn = (this->ImageBinarizer->GetReplaceIn() != 0);
+  const bool replaceOut = (this->ImageBinarizer->GetReplaceOut() != 0);
+  const unsigned char inValue = static_cast<unsigned char>(std::max(0.0, std::min(255.0, this->ImageBinarizer->GetInValue())));
+  const unsigned char outValue = static_cast<unsigned char>(std::max(0.0, std::min(255.0, this->ImageBinarizer->GetOutValue())));
+
+  for (int y = dims[1] - 1; y >= 0; --y)
+  {
+    const double* edgeLine = static_cast<double*>(edgeImage->GetScalarPointer(0, y, 0));
+    unsigned char* binaryLine = static_cast<unsigned char*>(this->BinaryImageForMorphology->GetScalarPointer(0, y, 0));
+    for (int x = dims[0] - 1; x >= 0; --x)
+    {
+      // Same conversion as in VectorImageToUchar
+      unsigned char edgeDetectorOutput0 = static_cast<unsigned char>(static_cast<float>(edgeLine[x * numberOfComponents]));
+      unsigned char edgeDetectorOutput1 = static_cast<unsigned char>(static_cast<float>(edgeLine[x * numberOfComponents + 1]));
+      float output = (float)(edgeDetectorOutput0 + edgeDetectorOutput1) / (float)2;
+      int edgeMagnitude = std::max(0, std::min(255, (int)output));
+      if (edgeMagnitude >= lowerThreshold && edgeMagnitude <= upperThreshold)
+      {
+        binaryLine[x] = (replaceIn ? inValue : static_cast<unsigned char>(edgeMagnitude));
+      }
+      else
+      {
+        binaryLine[x] = (replaceOut ? outValue : static_cast<unsigned char>(edgeMagnitude));
+      }
+    }
+  }
+  this->BinaryImageForMorphology->Modified();
+
+  return PLUS_SUCCESS;
+}
+
+//----------------------------------------------------------------------------
 void vtkPlusBoneEnhancer::LinearToFanImage(vtkSmartPointer<vtkImageData> inputImage, PlusTrackedFrame* outputFrame)
 {
 
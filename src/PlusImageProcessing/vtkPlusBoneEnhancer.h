@@ -27,6 +27,12 @@ class vtkPlusUsScanConvert;
 /*!
 \class vtkPlusBoneEnhancer
 \brief Localize bone surfaces in ultrasound images
+
+If intermediate results are not saved then the frames are processed in scan line image buffers
+that are allocated once and reused for all frames. Sampling along the scan lines is fused with the
+thresholding and edge magnitude computation is fused with the binarization. The output is identical
+to the output of the step-by-step processing that is used for saving intermediate results.
+
 \ingroup PlusLibImageProcessingAlgo
 */
 class vtkPlusImageProcessingExport vtkPlusBoneEnhancer : public vtkPlusTrackedFrameProcessor
@@ -117,6 +123,18 @@ protected:
 
   virtual PlusStatus ProcessImageExtents();
 
+  /*! Process a frame in the preallocated scan line image buffers, without storing intermediate results */
+  PlusStatus ProcessFrameFused(PlusTrackedFrame* inputFrame, PlusTrackedFrame* outputFrame);
+
+  /*! Compute the input pixel sampled by each pixel of the lines image, if the input image geometry has changed */
+  void UpdateScanLineSampleOffsets(vtkImageData* inputImage);
+
+  /*! Fill the lines image from the input image and threshold each scan line based on its standard deviation */
+  void FillAndThresholdLinesImage(vtkImageData* inputImage);
+
+  /*! Compute the edge magnitude from the edge detector output and binarize it into BinaryImageForMorphology */
+  PlusStatus EdgeImageToBinaryImage(vtkImageData* edgeImage);
+
 protected:
   vtkSmartPointer<vtkPlusUsScanConvert>     ScanConverter;
   vtkSmartPointer<vtkImageGaussianSmooth>   GaussianSmooth; // Trying to incorporate existing GaussianSmooth vtkThreadedAlgorithm class
@@ -161,6 +179,14 @@ protected:
   vtkSmartPointer<vtkImageData> LinesImage;
   /*! Pixels (float) store probability of belonging to shadow */
   vtkSmartPointer<vtkImageData> ProcessedLinesImage;
+  /*! Scan converted image of the fused processing, reused between frames */
+  vtkSmartPointer<vtkImageData> FanImage;
+
+  /*! Offset of the input scalar sampled by each lines image pixel, -1 if the sample is outside of the input image */
+  std::vector<vtkIdType> ScanLineSampleOffsets;
+  /*! Extent and number of components of the input image that ScanLineSampleOffsets was computed for */
+  int ScanLineSampleOffsetsInputExtent[6];
+  int ScanLineSampleOffsetsNumberOfComponents;
 
   std::vector<std::map<std::string, int> > BoneAreasInfo;
   bool FirstFrame;
@@ -336,6 +336,32 @@ void PlusIgtlClientInfo::PrintSelf(ostream& os, vtkIndent indent)
   }
 }
 
+//----------------------------------------------------------------------------
+bool PlusIgtlClientInfo::HasSameSubscription(const PlusIgtlClientInfo& otherClientInfo) const
+{
+  return this->ClientHeaderVersion == otherClientInfo.ClientHeaderVersion
+         && this->TDATARequested == otherClientInfo.TDATARequested
+         && this->TDATAResolution == otherClientInfo.TDATAResolution
+         && this->LastTDATASentTimeStamp == otherClientInfo.LastTDATASentTimeStamp
+         && this->IgtlMessageTypes == otherClientInfo.IgtlMessageTypes
+         && this->TransformNames == otherClientInfo.TransformNames
+         && this->StringNames == otherClientInfo.StringNames
+         && this->ImageStreams == otherClientInfo.ImageStreams;
+}
+
+//----------------------------------------------------------------------------
+bool PlusIgtlClientInfo::HasEncodedImageStream() const
+{
+  for (std::vector<ImageStream>::const_iterator it = this->ImageStreams.begin(); it != this->ImageStreams.end(); ++it)
+  {
+    if (!it->EncodingType.empty())
+    {
+      return true;
+    }
+  }
+  return false;
+}
+
 //----------------------------------------------------------------------------
 int PlusIgtlClientInfo::GetClientHeaderVersion() const
 {
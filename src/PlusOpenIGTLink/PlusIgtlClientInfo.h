@@ -43,6 +43,11 @@ public:
     If the string is not empty, then it will be compressed and sent as an igtl::VideoMessage using the encoding specified by the FourCC value
     */
     std::string EncodingType;
+
+    bool operator==(const ImageStream& other) const
+    {
+      return this->Name == other.Name && this->EmbeddedTransformToFrame == other.EmbeddedTransformToFrame && this->EncodingType == other.EncodingType;
+    }
   };
 
   PlusIgtlClientInfo();
@@ -58,6 +63,15 @@ public:
 
   virtual void PrintSelf(ostream& os, vtkIndent indent);
 
+  /*!
+    Returns true if the other client receives exactly the same messages for a tracked frame as this client
+    (same message types, image streams, transform and string names, header version and TDATA state)
+  */
+  bool HasSameSubscription(const PlusIgtlClientInfo& otherClientInfo) const;
+
+  /*! Returns true if any of the image streams are sent as compressed video. Video encoders hold per-client state. */
+  bool HasEncodedImageStream() const;
+
   /*! IGTL header version supported by the client */
   int GetClientHeaderVersion() const;
   /*! IGTL header version supported by the client */
@@ -0,0 +1,174 @@
+/*=Plus=header=begin======================================================
+Program: Plus
+Copyright (c) Laboratory for Percutaneous Surgery. All rights reserved.
+See License.txt for details.
+=========================================================Plus=header=end*/
+
+/*!
+  \file PlusIgtlClientInfoTest.cxx
+  \brief Verifies that PlusIgtlClientInfo::HasSameSubscription only groups clients that receive the same messages
+*/
+
+// Local includes
+#include "PlusConfigure.h"
+#include "PlusIgtlClientInfo.h"
+
+// IGTL includes
+#include <igtl_header.h>
+
+// VTK includes
+#include <vtksys/CommandLineArguments.hxx>
+
+namespace
+{
+  //----------------------------------------------------------------------------
+  PlusIgtlClientInfo CreateClientInfo()
+  {
+    PlusIgtlClientInfo clientInfo;
+    clientInfo.IgtlMessageTypes.push_back("TRANSFORM");
+    clientInfo.IgtlMessageTypes.push_back("IMAGE");
+    clientInfo.IgtlMessageTypes.push_back("STRING");
+    clientInfo.TransformNames.push_back(PlusTransformName("Probe", "Tracker"));
+    clientInfo.TransformNames.push_back(PlusTransformName("Stylus", "Reference"));
+    PlusIgtlClientInfo::ImageStream imageStream;
+    imageStream.Name = "Image";
+    imageStream.EmbeddedTransformToFrame = "Reference";
+    clientInfo.ImageStreams.push_back(imageStream);
+    clientInfo.StringNames.push_back("SequenceName");
+    clientInfo.SetClientHeaderVersion(IGTL_HEADER_VERSION_1);
+    clientInfo.SetTDATARequested(true);
+    clientInfo.SetTDATAResolution(50);
+    return clientInfo;
+  }
+
+  //----------------------------------------------------------------------------
+  PlusStatus CheckSubscription(const std::string& description, const PlusIgtlClientInfo& clientInfo, const PlusIgtlClientInfo& otherClientInfo, bool expectedSame)
+  {
+    // The relation must be symmetric, as the server groups clients by comparing them in either order
+    if (clientInfo.HasSameSubscription(otherClientInfo) != expectedSame || otherClientInfo.HasSameSubscription(clientInfo) != expectedSame)
+    {
+      LOG_ERROR(description << ": subscriptions are expected to be " << (expectedSame ? "the same" : "different"));
+      return PLUS_FAIL;
+    }
+    LOG_DEBUG(description << ": OK");
+    return PLUS_SUCCESS;
+  }
+}
+
+//----------------------------------------------------------------------------
+int main(int argc, char** argv)
+{
+  bool printHelp(false);
+  int verboseLevel = vtkPlusLogger::LOG_LEVEL_UNDEFINED;
+
+  vtksys::CommandLineArguments args;
+  args.Initialize(argc, argv);
+
+  args.AddArgument("--help", vtksys::CommandLineArguments::NO_ARGUMENT, &printHelp, "Print this help.");
+  args.AddArgument("--verbose", vtksys::CommandLineArguments::EQUAL_ARGUMENT, &verboseLevel, "Verbose level (1=error only, 2=warning, 3=info, 4=debug, 5=trace)");
+
+  if (!args.Parse())
+  {
+    std::cerr << "Problem parsing arguments" << std::endl;
+    std::cout << "Help: " << args.GetHelp() << std::endl;
+    exit(EXIT_FAILURE);
+  }
+
+  if (printHelp)
+  {
+    std::cout << args.GetHelp() << std::endl;
+    exit(EXIT_SUCCESS);
+  }
+
+  vtkPlusLogger::Instance()->SetLogLevel(verboseLevel);
+
+  int numberOfFailures(0);
+  const PlusIgtlClientInfo clientInfo = CreateClientInfo();
+
+  // Equal subscriptions
+  if (CheckSubscription("Identical client info", clientInfo, CreateClientInfo(), true) != PLUS_SUCCESS) { numberOfFailures++; }
+  if (CheckSubscription("Default client info", PlusIgtlClientInfo(), PlusIgtlClientInfo(), true) != PLUS_SUCCESS) { numberOfFailures++; }
+
+  // Transform names
+  {
+    PlusIgtlClientInfo otherClientInfo = CreateClientInfo();
+    otherClientInfo.TransformNames[1] = PlusTransformName("Needle", "Reference");
+    if (CheckSubscription("Different transform name", clientInfo, otherClientInfo, false) != PLUS_SUCCESS) { numberOfFailures++; }
+  }
+  {
+    PlusIgtlClientInfo otherClientInfo = CreateClientInfo();
+    otherClientInfo.TransformNames.pop_back();
+    if (CheckSubscription("Missing transform name", clientInfo, otherClientInfo, false) != PLUS_SUCCESS) { numberOfFailures++; }
+  }
+
+  // Image streams
+  {
+    PlusIgtlClientInfo otherClientInfo = CreateClientInfo();
+    otherClientInfo.ImageStreams[0].Name = "OtherImage";
+    if (CheckSubscription("Different image stream name", clientInfo, otherClientInfo, false) != PLUS_SUCCESS) { numberOfFailures++; }
+  }
+  {
+    PlusIgtlClientInfo otherClientInfo = CreateClientInfo();
+    otherClientInfo.ImageStreams[0].EmbeddedTransformToFrame = "Tracker";
+    if (CheckSubscription("Different image stream embedded transform", clientInfo, otherClientInfo, false) != PLUS_SUCCESS) { numberOfFailures++; }
+  }
+  {
+    PlusIgtlClientInfo otherClientInfo = CreateClientInfo();
+    otherClientInfo.ImageStreams[0].EncodingType = "VP90";
+    if (CheckSubscription("Different image stream encoding", clientInfo, otherClientInfo, false) != PLUS_SUCCESS) { numberOfFailures++; }
+  }
+  {
+    PlusIgtlClientInfo otherClientInfo = CreateClientInfo();
+    otherClientInfo.ImageStreams.clear();
+    if (CheckSubscription("Missing image stream", clientInfo, otherClientInfo, false) != PLUS_SUCCESS) { numberOfFailures++; }
+  }
+
+  // String names
+  {
+    PlusIgtlClientInfo otherClientInfo = CreateClientInfo();
+    otherClientInfo.StringNames[0] = "FrameNumber";
+    if (CheckSubscription("Different string name", clientInfo, otherClientInfo, false) != PLUS_SUCCESS) { numberOfFailures++; }
+  }
+  {
+    PlusIgtlClientInfo otherClientInfo = CreateClientInfo();
+    otherClientInfo.StringNames.push_back("FrameNumber");
+    if (CheckSubscription("Additional string name", clientInfo, otherClientInfo, false) != PLUS_SUCCESS) { numberOfFailures++; }
+  }
+
+  // Message types and header version
+  {
+    PlusIgtlClientInfo otherClientInfo = CreateClientInfo();
+    otherClientInfo.IgtlMessageTypes[0] = "POSITION";
+    if (CheckSubscription("Different message type", clientInfo, otherClientInfo, false) != PLUS_SUCCESS) { numberOfFailures++; }
+  }
+  {
+    PlusIgtlClientInfo otherClientInfo = CreateClientInfo();
+    otherClientInfo.SetClientHeaderVersion(IGTL_HEADER_VERSION_2);
+    if (CheckSubscription("Different header version", clientInfo, otherClientInfo, false) != PLUS_SUCCESS) { numberOfFailures++; }
+  }
+
+  // TDATA fields
+  {
+    PlusIgtlClientInfo otherClientInfo = CreateClientInfo();
+    otherClientInfo.SetTDATARequested(false);
+    if (CheckSubscription("Different TDATA requested state", clientInfo, otherClientInfo, false) != PLUS_SUCCESS) { numberOfFailures++; }
+  }
+  {
+    PlusIgtlClientInfo otherClientInfo = CreateClientInfo();
+    otherClientInfo.SetTDATAResolution(100);
+    if (CheckSubscription("Different TDATA resolution", clientInfo, otherClientInfo, false) != PLUS_SUCCESS) { numberOfFailures++; }
+  }
+  {
+    PlusIgtlClientInfo otherClientInfo = CreateClientInfo();
+    otherClientInfo.SetLastTDATASentTimeStamp(12.5);
+    if (CheckSubscription("Different last TDATA sent time", clientInfo, otherClientInfo, false) != PLUS_SUCCESS) { numberOfFailures++; }
+  }
+
+  if (numberOfFailures > 0)
+  {
+    LOG_ERROR("Number of failures: " << numberOfFailures);
+    return EXIT_FAILURE;
+  }
+  LOG_INFO("Test completed successfully!");
+  return EXIT_SUCCESS;
+}
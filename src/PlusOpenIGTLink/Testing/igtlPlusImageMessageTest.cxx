@@ -0,0 +1,179 @@
+/*=Plus=header=begin======================================================
+Program: Plus
+Copyright (c) Laboratory for Percutaneous Surgery. All rights reserved.
+See License.txt for details.
+=========================================================Plus=header=end*/
+
+/*!
+  \file igtlPlusImageMessageTest.cxx
+  \brief Verifies that igtl::PlusImageMessage produces the same bytes as a packed igtl::ImageMessage
+*/
+
+// Local includes
+#include "PlusConfigure.h"
+#include "PlusTrackedFrame.h"
+#include "igtlPlusImageMessage.h"
+#include "vtkPlusIgtlMessageCommon.h"
+
+// VTK includes
+#include <vtkImageData.h>
+#include <vtkMatrix4x4.h>
+#include <vtkSmartPointer.h>
+#include <vtksys/CommandLineArguments.hxx>
+
+namespace
+{
+  //----------------------------------------------------------------------------
+  PlusStatus CreateTestFrame(PlusTrackedFrame& trackedFrame, PlusCommon::VTKScalarPixelType pixelType, unsigned int numberOfComponents)
+  {
+    PlusVideoFrame videoFrame;
+    FrameSizeType frameSize = { 37, 21, 3 };
+    if (videoFrame.AllocateFrame(frameSize, pixelType, numberOfComponents) != PLUS_SUCCESS)
+    {
+      LOG_ERROR("Failed to allocate test frame");
+      return PLUS_FAIL;
+    }
+    vtkImageData* image = videoFrame.GetImage();
+    image->SetSpacing(0.2, 0.3, 0.5);
+    image->SetOrigin(10.0, -5.0, 2.5);
+    unsigned char* pixels = static_cast<unsigned char*>(image->GetScalarPointer());
+    size_t numberOfBytes = static_cast<size_t>(image->GetNumberOfPoints()) * image->GetNumberOfScalarComponents() * image->GetScalarSize();
+    for (size_t i = 0; i < numberOfBytes; ++i)
+    {
+      pixels[i] = static_cast<unsigned char>((i * 7 + 3) % 251);
+    }
+    trackedFrame.SetImageData(videoFrame);
+    trackedFrame.SetTimestamp(1234.5678);
+    trackedFrame.SetFrameField("FrameNumber", "12");
+    trackedFrame.SetFrameField("SequenceName", "ZeroCopyTest");
+    return PLUS_SUCCESS;
+  }
+
+  //----------------------------------------------------------------------------
+  void SetMetaData(igtl::ImageMessage* imageMessage, PlusTrackedFrame& trackedFrame)
+  {
+#if OpenIGTLink_HEADER_VERSION >= 2
+    std::vector<std::string> frameFields;
+    trackedFrame.GetFrameFieldNameList(frameFields);
+    for (std::vector<std::string>::const_iterator fieldIt = frameFields.begin(); fieldIt != frameFields.end(); ++fieldIt)
+    {
+      imageMessage->SetMetaDataElement(*fieldIt, IANA_TYPE_US_ASCII, trackedFrame.GetFrameField(*fieldIt));
+    }
+#endif
+  }
+
+  //----------------------------------------------------------------------------
+  PlusStatus TestPackedMessage(int headerVersion, PlusCommon::VTKScalarPixelType pixelType, unsigned int numberOfComponents)
+  {
+    PlusTrackedFrame trackedFrame;
+    if (CreateTestFrame(trackedFrame, pixelType, numberOfComponents) != PLUS_SUCCESS)
+    {
+      return PLUS_FAIL;
+    }
+    vtkSmartPointer<vtkMatrix4x4> imageToReference = vtkSmartPointer<vtkMatrix4x4>::New();
+    imageToReference->SetElement(0, 3, 15.0);
+    imageToReference->SetElement(1, 3, -25.0);
+
+    igtl::ImageMessage::Pointer referenceMessage = igtl::ImageMessage::New();
+    referenceMessage->SetHeaderVersion(headerVersion);
+    referenceMessage->SetDeviceName("Image_Reference");
+    if (headerVersion >= 2)
+    {
+      SetMetaData(referenceMessage, trackedFrame);
+    }
+    if (vtkPlusIgtlMessageCommon::PackImageMessage(referenceMessage, trackedFrame, *imageToReference) != PLUS_SUCCESS)
+    {
+      LOG_ERROR("Failed to pack reference image message");
+      return PLUS_FAIL;
+    }
+
+    igtl::PlusImageMessage::Pointer zeroCopyMessage = igtl::PlusImageMessage::New();
+    zeroCopyMessage->SetHeaderVersion(headerVersion);
+    zeroCopyMessage->SetDeviceName("Image_Reference");
+    if (headerVersion >= 2)
+    {
+      SetMetaData(zeroCopyMessage.GetPointer(), trackedFrame);
+    }
+    if (vtkPlusIgtlMessageCommon::PackImageMessage(zeroCopyMessage.GetPointer(), trackedFrame, *imageToReference) != PLUS_SUCCESS)
+    {
+      LOG_ERROR("Failed to pack zero-copy image message");
+      return PLUS_FAIL;
+    }
+
+    std::vector<unsigned char> zeroCopyBytes;
+    zeroCopyMessage->GetPackedMessage(zeroCopyBytes);
+    if (zeroCopyBytes.size() != zeroCopyMessage->GetPackedMessageSize()
+        || zeroCopyBytes.size() != static_cast<size_t>(referenceMessage->GetBufferSize()))
+    {
+      LOG_ERROR("Packed message size mismatch (header version " << headerVersion << "): " << zeroCopyBytes.size()
+                << " bytes instead of " << referenceMessage->GetBufferSize());
+      return PLUS_FAIL;
+    }
+    const unsigned char* referenceBytes = static_cast<const unsigned char*>(referenceMessage->GetBufferPointer());
+    for (size_t i = 0; i < zeroCopyBytes.size(); ++i)
+    {
+      if (zeroCopyBytes[i] != referenceBytes[i])
+      {
+        LOG_ERROR("Packed message mismatch (header version " << headerVersion << ") at byte " << i);
+        return PLUS_FAIL;
+      }
+    }
+
+    // The receiver must be able to unpack the message and verify the CRC
+    igtl::ImageMessage::Pointer receivedMessage = igtl::ImageMessage::New();
+    igtl::MessageHeader::Pointer receivedHeader = igtl::MessageHeader::New();
+    receivedHeader->InitBuffer();
+    memcpy(receivedHeader->GetBufferPointer(), &zeroCopyBytes[0], IGTL_HEADER_SIZE);
+    receivedHeader->Unpack();
+    receivedMessage->SetMessageHeader(receivedHeader);
+    receivedMessage->AllocateBuffer();
+    memcpy(receivedMessage->GetBufferBodyPointer(), &zeroCopyBytes[IGTL_HEADER_SIZE], receivedMessage->GetBufferBodySize());
+    if (!(receivedMessage->Unpack(1) & igtl::MessageHeader::UNPACK_BODY))
+    {
+      LOG_ERROR("Failed to unpack zero-copy image message (header version " << headerVersion << ")");
+      return PLUS_FAIL;
+    }
+
+    LOG_INFO("Zero-copy image message matches the packed image message (header version " << headerVersion << ", "
+             << zeroCopyBytes.size() << " bytes)");
+    return PLUS_SUCCESS;
+  }
+}
+
+//----------------------------------------------------------------------------
+int main(int argc, char** argv)
+{
+  bool printHelp(false);
+  int verboseLevel = vtkPlusLogger::LOG_LEVEL_UNDEFINED;
+
+  vtksys::CommandLineArguments args;
+  args.Initialize(argc, argv);
+
+  args.AddArgument("--help", vtksys::CommandLineArguments::NO_ARGUMENT, &printHelp, "Print this help.");
+  args.AddArgument("--verbose", vtksys::CommandLineArguments::EQUAL_ARGUMENT, &verboseLevel, "Verbose level (1=error only, 2=warning, 3=info, 4=debug, 5=trace)");
+
+  if (!args.Parse())
+  {
+    std::cerr << "Problem parsing arguments" << std::endl;
+    std::cout << "Help: " << args.GetHelp() << std::endl;
+    exit(EXIT_FAILURE);
+  }
+
+  if (printHelp)
+  {
+    std::cout << args.GetHelp() << std::endl;
+    exit(EXIT_SUCCESS);
+  }
+
+  vtkPlusLogger::Instance()->SetLogLevel(verboseLevel);
+
+  if (TestPackedMessage(IGTL_HEADER_VERSION_1, VTK_UNSIGNED_CHAR, 1) != PLUS_SUCCESS) { exit(EXIT_FAILURE); }
+  if (TestPackedMessage(IGTL_HEADER_VERSION_1, VTK_SHORT, 3) != PLUS_SUCCESS) { exit(EXIT_FAILURE); }
+#if OpenIGTLink_HEADER_VERSION >= 2
+  if (TestPackedMessage(IGTL_HEADER_VERSION_2, VTK_UNSIGNED_CHAR, 1) != PLUS_SUCCESS) { exit(EXIT_FAILURE); }
+  if (TestPackedMessage(IGTL_HEADER_VERSION_2, VTK_FLOAT, 1) != PLUS_SUCCESS) { exit(EXIT_FAILURE); }
+#endif
+
+  LOG_INFO("Test completed successfully!");
+  return EXIT_SUCCESS;
+}
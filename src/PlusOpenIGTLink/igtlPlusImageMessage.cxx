@@ -0,0 +1,291 @@
+/*=Plus=header=begin======================================================
+Program: Plus
+Copyright (c) Laboratory for Percutaneous Surgery. All rights reserved.
+See License.txt for details.
+=========================================================Plus=header=end*/
+
+#if defined(_WIN32)
+  #include <winsock2.h>
+  #pragma comment(lib, "Ws2_32.lib")
+#else
+  #include <errno.h>
+  #include <sys/socket.h>
+  #include <sys/uio.h>
+#endif
+
+#include "PlusConfigure.h"
+#include "igtlPlusImageMessage.h"
+#include "igtl_header.h"
+#include "igtl_image.h"
+#include "igtl_util.h"
+
+namespace
+{
+  //----------------------------------------------------------------------------
+  // igtl::Socket does not provide access to its descriptor, but derived classes may read the protected member
+  class SocketDescriptorAccessor : public igtl::Socket
+  {
+  public:
+    static int GetDescriptor(igtl::Socket* socket)
+    {
+      return socket->*(&SocketDescriptorAccessor::m_SocketDescriptor);
+    }
+  };
+
+  //----------------------------------------------------------------------------
+  struct SendBuffer
+  {
+    const unsigned char* Data;
+    size_t Size;
+  };
+
+  //----------------------------------------------------------------------------
+  // Send all the buffers, as few system calls as possible. Returns 1 on success, 0 on failure.
+  int SendBuffers(int socketDescriptor, SendBuffer* buffers, int numberOfBuffers)
+  {
+    int firstBuffer = 0;
+    while (firstBuffer < numberOfBuffers)
+    {
+#if defined(_WIN32)
+      WSABUF wsaBuffers[3];
+      int wsaBufferCount = 0;
+      for (int i = firstBuffer; i < numberOfBuffers && wsaBufferCount < 3; ++i, ++wsaBufferCount)
+      {
+        wsaBuffers[wsaBufferCount].buf = (char*)buffers[i].Data;
+        wsaBuffers[wsaBufferCount].len = static_cast<ULONG>(buffers[i].Size);
+      }
+      DWORD bytesSentDword = 0;
+      if (WSASend(static_cast<SOCKET>(socketDescriptor), wsaBuffers, wsaBufferCount, &bytesSentDword, 0, NULL, NULL) != 0)
+      {
+        return 0;
+      }
+      size_t bytesSent = bytesSentDword;
+#else
+      struct iovec ioBuffers[3];
+      int ioBufferCount = 0;
+      for (int i = firstBuffer; i < numberOfBuffers && ioBufferCount < 3; ++i, ++ioBufferCount)
+      {
+        ioBuffers[ioBufferCount].iov_base = (void*)buffers[i].Data;
+        ioBuffers[ioBufferCount].iov_len = buffers[i].Size;
+      }
+      struct msghdr message;
+      memset(&message, 0, sizeof(message));
+      message.msg_iov = ioBuffers;
+      message.msg_iovlen = ioBufferCount;
+#if defined(MSG_NOSIGNAL)
+      // Report a closed connection as an error instead of raising SIGPIPE, the same way as igtl::Socket::Send
+      ssize_t result = sendmsg(socketDescriptor, &message, MSG_NOSIGNAL);
+#else
+      ssize_t result = sendmsg(socketDescriptor, &message, 0);
+#endif
+      if (result < 0)
+      {
+        if (errno == EINTR)
+        {
+          continue;
+        }
+        return 0;
+      }
+      size_t bytesSent = static_cast<size_t>(result);
+#endif
+
+      // Skip the buffers that are completely sent, continue from the first byte that is not sent yet
+      while (firstBuffer < numberOfBuffers && bytesSent >= buffers[firstBuffer].Size)
+      {
+        bytesSent -= buffers[firstBuffer].Size;
+        firstBuffer++;
+      }
+      if (firstBuffer < numberOfBuffers)
+      {
+        buffers[firstBuffer].Data += bytesSent;
+        buffers[firstBuffer].Size -= bytesSent;
+      }
+    }
+    return 1;
+  }
+}
+
+namespace igtl
+{
+
+  //----------------------------------------------------------------------------
+  PlusImageMessage::PlusImageMessage()
+    : ImageMessage()
+    , PixelDataSize(0)
+  {
+  }
+
+  //----------------------------------------------------------------------------
+  PlusImageMessage::~PlusImageMessage()
+  {
+  }
+
+  //----------------------------------------------------------------------------
+  void PlusImageMessage::SetPixelData(vtkImageData* image)
+  {
+    this->PixelData = image;
+  }
+
+  //----------------------------------------------------------------------------
+  int PlusImageMessage::PackHeaders()
+  {
+    this->PackedHeaders.clear();
+    this->PackedMetaData.clear();
+    this->PixelDataSize = 0;
+
+    if (this->PixelData == NULL)
+    {
+      LOG_ERROR("Failed to pack image message headers: pixel data is not set");
+      return 0;
+    }
+    igtlUint64 pixelDataSize = this->GetSubVolumeImageSize();
+    igtlUint64 imageDataSize = static_cast<igtlUint64>(this->PixelData->GetNumberOfPoints()) * this->PixelData->GetNumberOfScalarComponents() * this->PixelData->GetScalarSize();
+    if (pixelDataSize != imageDataSize)
+    {
+      LOG_ERROR("Failed to pack image message headers: message pixel data size (" << pixelDataSize << " bytes) does not match the image size (" << imageDataSize << " bytes)");
+      return 0;
+    }
+
+    // Pack a single-voxel image with the same header fields and metadata: this provides the message header, extended header,
+    // image header, and metadata in exactly the same form as igtl::ImageMessage::Pack(). Only the image size and the
+    // CRC have to be updated, which is done below.
+    igtl::ImageMessage::Pointer headerMessage = igtl::ImageMessage::New();
+    headerMessage->SetHeaderVersion(this->GetHeaderVersion());
+    headerMessage->SetDeviceName(this->GetDeviceName());
+    unsigned int timestampSec = 0;
+    unsigned int timestampFraction = 0;
+    this->GetTimeStamp(&timestampSec, &timestampFraction);
+    headerMessage->SetTimeStamp(timestampSec, timestampFraction);
+#if OpenIGTLink_HEADER_VERSION >= 2
+    for (auto metaDataIt = this->m_MetaDataMap.begin(); metaDataIt != this->m_MetaDataMap.end(); ++metaDataIt)
+    {
+      headerMessage->SetMetaDataElement(metaDataIt->first, metaDataIt->second.first, metaDataIt->second.second);
+    }
+#endif
+    float spacing[3] = { 0 };
+    this->GetSpacing(spacing);
+    headerMessage->SetSpacing(spacing);
+    igtl::Matrix4x4 matrix;
+    this->GetMatrix(matrix);
+    headerMessage->SetMatrix(matrix);
+    headerMessage->SetNumComponents(this->GetNumComponents());
+    headerMessage->SetScalarType(this->GetScalarType());
+    headerMessage->SetEndian(this->GetEndian());
+    headerMessage->SetCoordinateSystem(this->GetCoordinateSystem());
+    headerMessage->SetDimensions(1, 1, 1);
+    headerMessage->SetSubVolume(1, 1, 1, 0, 0, 0);
+    headerMessage->AllocateScalars();
+    memset(headerMessage->GetScalarPointer(), 0, headerMessage->GetSubVolumeImageSize());
+    headerMessage->Pack();
+
+    const unsigned char* packedBuffer = static_cast<const unsigned char*>(headerMessage->GetBufferPointer());
+    igtlUint64 packedBufferSize = headerMessage->GetBufferSize();
+    igtlUint64 extendedHeaderSize = 0;
+    if (this->GetHeaderVersion() >= 2)
+    {
+      if (packedBufferSize < IGTL_HEADER_SIZE + 2)
+      {
+        LOG_ERROR("Failed to pack image message headers: invalid packed message size");
+        return 0;
+      }
+      // The extended header starts with its own size, stored in network byte order
+      extendedHeaderSize = (static_cast<igtlUint64>(packedBuffer[IGTL_HEADER_SIZE]) << 8) | packedBuffer[IGTL_HEADER_SIZE + 1];
+    }
+    igtlUint64 imageHeaderOffset = IGTL_HEADER_SIZE + extendedHeaderSize;
+    igtlUint64 metaDataOffset = imageHeaderOffset + IGTL_IMAGE_HEADER_SIZE + headerMessage->GetSubVolumeImageSize();
+    if (metaDataOffset > packedBufferSize)
+    {
+      LOG_ERROR("Failed to pack image message headers: invalid packed message size");
+      return 0;
+    }
+    this->PixelDataSize = pixelDataSize;
+    this->PackedHeaders.assign(packedBuffer, packedBuffer + imageHeaderOffset + IGTL_IMAGE_HEADER_SIZE);
+    this->PackedMetaData.assign(packedBuffer + metaDataOffset, packedBuffer + packedBufferSize);
+
+    // Set the real image size in the image header
+    int dimensions[3] = { 0 };
+    this->GetDimensions(dimensions);
+    int subVolumeDimensions[3] = { 0 };
+    int subVolumeOffset[3] = { 0 };
+    this->GetSubVolume(subVolumeDimensions, subVolumeOffset);
+    igtl_image_header imageHeader;
+    memcpy(&imageHeader, &this->PackedHeaders[imageHeaderOffset], IGTL_IMAGE_HEADER_SIZE);
+    igtl_image_convert_byte_order(&imageHeader);
+    for (int i = 0; i < 3; ++i)
+    {
+      imageHeader.size[i] = static_cast<igtl_uint16>(dimensions[i]);
+      imageHeader.subvol_size[i] = static_cast<igtl_uint16>(subVolumeDimensions[i]);
+      imageHeader.subvol_offset[i] = static_cast<igtl_uint16>(subVolumeOffset[i]);
+    }
+    igtl_image_convert_byte_order(&imageHeader);
+    memcpy(&this->PackedHeaders[imageHeaderOffset], &imageHeader, IGTL_IMAGE_HEADER_SIZE);
+
+    // The body is everything after the message header: the CRC is computed incrementally over the parts
+    igtl_uint64 crc = igtl_crc64(&this->PackedHeaders[IGTL_HEADER_SIZE], this->PackedHeaders.size() - IGTL_HEADER_SIZE, 0);
+    crc = igtl_crc64(static_cast<unsigned char*>(this->PixelData->GetScalarPointer()), pixelDataSize, crc);
+    if (!this->PackedMetaData.empty())
+    {
+      crc = igtl_crc64(&this->PackedMetaData[0], this->PackedMetaData.size(), crc);
+    }
+
+    igtl_header header;
+    memcpy(&header, &this->PackedHeaders[0], IGTL_HEADER_SIZE);
+    igtl_header_convert_byte_order(&header);
+    header.body_size = this->GetPackedMessageSize() - IGTL_HEADER_SIZE;
+    header.crc = crc;
+    igtl_header_convert_byte_order(&header);
+    memcpy(&this->PackedHeaders[0], &header, IGTL_HEADER_SIZE);
+
+    return 1;
+  }
+
+  //----------------------------------------------------------------------------
+  int PlusImageMessage::Send(igtl::Socket* socket)
+  {
+    if (socket == NULL || this->PackedHeaders.empty() || this->PixelData == NULL)
+    {
+      return 0;
+    }
+
+    SendBuffer buffers[3];
+    int numberOfBuffers = 0;
+    buffers[numberOfBuffers].Data = &this->PackedHeaders[0];
+    buffers[numberOfBuffers].Size = this->PackedHeaders.size();
+    numberOfBuffers++;
+    buffers[numberOfBuffers].Data = static_cast<const unsigned char*>(this->PixelData->GetScalarPointer());
+    buffers[numberOfBuffers].Size = this->PixelDataSize;
+    numberOfBuffers++;
+    if (!this->PackedMetaData.empty())
+    {
+      buffers[numberOfBuffers].Data = &this->PackedMetaData[0];
+      buffers[numberOfBuffers].Size = this->PackedMetaData.size();
+      numberOfBuffers++;
+    }
+
+    return SendBuffers(SocketDescriptorAccessor::GetDescriptor(socket), buffers, numberOfBuffers);
+  }
+
+  //----------------------------------------------------------------------------
+  igtlUint64 PlusImageMessage::GetPackedMessageSize() const
+  {
+    if (this->PackedHeaders.empty())
+    {
+      return 0;
+    }
+    return this->PackedHeaders.size() + this->PixelDataSize + this->PackedMetaData.size();
+  }
+
+  //----------------------------------------------------------------------------
+  void PlusImageMessage::GetPackedMessage(std::vector<unsigned char>& packedMessage) const
+  {
+    packedMessage.clear();
+    if (this->PackedHeaders.empty() || this->PixelData == NULL)
+    {
+      return;
+    }
+    const unsigned char* pixels = static_cast<const unsigned char*>(this->PixelData->GetScalarPointer());
+    packedMessage.insert(packedMessage.end(), this->PackedHeaders.begin(), this->PackedHeaders.end());
+    packedMessage.insert(packedMessage.end(), pixels, pixels + this->PixelDataSize);
+    packedMessage.insert(packedMessage.end(), this->PackedMetaData.begin(), this->PackedMetaData.end());
+  }
+}
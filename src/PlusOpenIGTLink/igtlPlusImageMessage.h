@@ -0,0 +1,85 @@
+/*=Plus=header=begin======================================================
+Program: Plus
+Copyright (c) Laboratory for Percutaneous Surgery. All rights reserved.
+See License.txt for details.
+=========================================================Plus=header=end*/
+
+#ifndef __igtlPlusImageMessage_h
+#define __igtlPlusImageMessage_h
+
+#include "vtkPlusOpenIGTLinkExport.h"
+
+#include "igtlImageMessage.h"
+#include "igtlSocket.h"
+
+#include <vtkImageData.h>
+#include <vtkSmartPointer.h>
+
+#include <vector>
+
+namespace igtl
+{
+  /*!
+  \class PlusImageMessage
+  \brief IMAGE message that is sent directly from the pixel buffer of a vtkImageData
+
+  igtl::ImageMessage::Pack() requires the pixels to be copied into the message buffer. This message only packs the
+  message header, the image header and the metadata (see PackHeaders) and keeps a reference to the image.
+  Send() transmits the headers and the pixel data with a single vectored write, so the pixels are never copied.
+  The CRC is computed over the headers and the pixel data, therefore the transmitted bytes are the same as the ones
+  produced by igtl::ImageMessage::Pack().
+
+  The pixels must not be modified while the message is in use. PlusVideoFrame detaches shared images before
+  writing into them, so it is safe to reference the image of a tracked frame.
+
+  \ingroup PlusLibOpenIGTLink
+  */
+  class vtkPlusOpenIGTLinkExport PlusImageMessage: public igtl::ImageMessage
+  {
+  public:
+    typedef PlusImageMessage                Self;
+    typedef igtl::ImageMessage              Superclass;
+    typedef igtl::SmartPointer<Self>        Pointer;
+    typedef igtl::SmartPointer<const Self>  ConstPointer;
+
+    igtlTypeMacro(igtl::PlusImageMessage, igtl::ImageMessage);
+    igtlNewMacro(igtl::PlusImageMessage);
+
+  public:
+    /*!
+      Set the image that provides the pixel data. The image is referenced, not copied.
+      Dimensions, scalar type and number of components of the message must match the image.
+    */
+    void SetPixelData(vtkImageData* image);
+
+    /*! Pack the message header, the image header and the metadata. Use this instead of Pack(). Returns 1 on success, 0 on failure. */
+    int PackHeaders();
+
+    /*! Send the packed message through the socket. Returns 1 on success, 0 on failure (same as igtl::Socket::Send). */
+    int Send(igtl::Socket* socket);
+
+    /*! Get the size of the packed message in bytes, including the pixel data */
+    igtlUint64 GetPackedMessageSize() const;
+
+    /*! Copy the packed message, including the pixel data, into a contiguous buffer (for testing) */
+    void GetPackedMessage(std::vector<unsigned char>& packedMessage) const;
+
+  protected:
+    PlusImageMessage();
+    ~PlusImageMessage();
+
+    /*! Image that contains the pixel data of the message */
+    vtkSmartPointer<vtkImageData> PixelData;
+
+    /*! Message header, extended header (header version 2 and later) and image header */
+    std::vector<unsigned char> PackedHeaders;
+
+    /*! Metadata header and metadata (header version 2 and later), sent after the pixel data */
+    std::vector<unsigned char> PackedMetaData;
+
+    /*! Number of pixel data bytes sent from PixelData, set by PackHeaders */
+    igtlUint64 PixelDataSize;
+  };
+}
+
+#endif
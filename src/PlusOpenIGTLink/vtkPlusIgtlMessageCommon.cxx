@@ -8,6 +8,7 @@ See License.txt for details.
 #include "PlusConfigure.h"
 #include "PlusTrackedFrame.h"
 #include "PlusVideoFrame.h"
+#include "igtlPlusImageMessage.h"
 #include "vtkPlusIgtlMessageCommon.h"
 #include "vtkPlusTrackedFrameList.h"
 #include "vtkPlusTransformRepository.h"
@@ -263,12 +264,6 @@ PlusStatus vtkPlusIgtlMessageCommon::PackImageMessage(igtl::ImageMessage::Pointe
   imageMessage->SetScalarType(scalarType);
   imageMessage->SetEndian(igtl_is_little_endian() ? igtl::ImageMessage::ENDIAN_LITTLE : igtl::ImageMessage::ENDIAN_BIG);
   imageMessage->SetSubVolume(subSizePixels, subOffset);
-  imageMessage->AllocateScalars();
-
-  unsigned char* igtlImagePointer = (unsigned char*)(imageMessage->GetScalarPointer());
-  unsigned char* vtkImagePointer = (unsigned char*)(frameImage->GetScalarPointer());
-
-  memcpy(igtlImagePointer, vtkImagePointer, imageMessage->GetImageSize());
 
   // Convert VTK transform to IGTL transform.
   if (igtlioImageConverter::VTKTransformToIGTLImage(matrix, imageSizePixels, imageSpacingMm, imageOriginMm, imageMessage) != 1)
@@ -278,6 +273,27 @@ PlusStatus vtkPlusIgtlMessageCommon::PackImageMessage(igtl::ImageMessage::Pointe
   }
 
   imageMessage->SetTimeStamp(igtlFrameTime);
+
+  // The pixels of a PlusImageMessage are sent directly from the frame image, only the headers are packed
+  igtl::PlusImageMessage* plusImageMessage = dynamic_cast<igtl::PlusImageMessage*>(imageMessage.GetPointer());
+  if (plusImageMessage != NULL)
+  {
+    plusImageMessage->SetPixelData(frameImage);
+    if (!plusImageMessage->PackHeaders())
+    {
+      LOG_ERROR("Failed to pack image message headers");
+      return PLUS_FAIL;
+    }
+    return PLUS_SUCCESS;
+  }
+
+  imageMessage->AllocateScalars();
+
+  unsigned char* igtlImagePointer = (unsigned char*)(imageMessage->GetScalarPointer());
+  unsigned char* vtkImagePointer = (unsigned char*)(frameImage->GetScalarPointer());
+
+  memcpy(igtlImagePointer, vtkImagePointer, imageMessage->GetImageSize());
+
   imageMessage->Pack();
 
   return PLUS_SUCCESS;
@@ -23,6 +23,7 @@ See License.txt for details.
 #include "igtlCommandMessage.h"
 #include "igtlImageMessage.h"
 #include "igtlPlusClientInfoMessage.h"
+#include "igtlPlusImageMessage.h"
 #include "igtlPlusTrackedFrameMessage.h"
 #include "igtlPlusUsMessage.h"
 #include "igtlPositionMessage.h"
@@ -49,6 +50,7 @@ vtkStandardNewMacro(vtkPlusIgtlMessageFactory);
 //----------------------------------------------------------------------------
 vtkPlusIgtlMessageFactory::vtkPlusIgtlMessageFactory()
   : IgtlFactory(igtl::MessageFactory::New())
+  , ZeroCopyImageMessages(false)
 {
   this->IgtlFactory->AddMessageType("CLIENTINFO", (PointerToMessageBaseNew)&igtl::PlusClientInfoMessage::New);
   this->IgtlFactory->AddMessageType("TRACKEDFRAME", (PointerToMessageBaseNew)&igtl::PlusTrackedFrameMessage::New);
@@ -65,6 +67,7 @@ vtkPlusIgtlMessageFactory::~vtkPlusIgtlMessageFactory()
 void vtkPlusIgtlMessageFactory::PrintSelf(ostream& os, vtkIndent indent)
 {
   this->Superclass::PrintSelf(os, indent);
+  os << indent << "ZeroCopyImageMessages: " << (this->ZeroCopyImageMessages ? "TRUE" : "FALSE") << std::endl;
   this->PrintAvailableMessageTypes(os, indent);
 }
 
@@ -193,7 +196,17 @@ PlusStatus vtkPlusIgtlMessageFactory::PackMessages(int clientId, const PlusIgtlC
 
         if (imageStream.EncodingType.empty())
         {
-          igtl::ImageMessage::Pointer imageMessage = dynamic_cast<igtl::ImageMessage*>(igtlMessage->Clone().GetPointer());
+          igtl::ImageMessage::Pointer imageMessage;
+          if (this->ZeroCopyImageMessages)
+          {
+            // Pixels are sent directly from the frame image, see igtl::PlusImageMessage::Send
+            imageMessage = igtl::PlusImageMessage::New();
+            imageMessage->SetHeaderVersion(igtlMessage->GetHeaderVersion());
+          }
+          else
+          {
+            imageMessage = dynamic_cast<igtl::ImageMessage*>(igtlMessage->Clone().GetPointer());
+          }
           if (trackedFrame.IsFrameFieldDefined(PlusTrackedFrame::FIELD_FRIENDLY_DEVICE_NAME))
           {
             // Allow overriding of device name with something human readable
@@ -203,17 +216,11 @@ PlusStatus vtkPlusIgtlMessageFactory::PackMessages(int clientId, const PlusIgtlC
           imageMessage->SetDeviceName(deviceName.c_str());
 
           // Send PlusTrackedFrame::CustomFrameFields as meta data in the image message.
-          std::vector<std::string> frameFields;
-          trackedFrame.GetFrameFieldNameList(frameFields);
-          for (std::vector<std::string>::const_iterator stringNameIterator = frameFields.begin(); stringNameIterator != frameFields.end(); ++stringNameIterator)
+          // The fields are read directly, so the frame transforms are converted to strings once and no name list is built.
+          const PlusTrackedFrame::FieldMapType& frameFields = trackedFrame.GetCustomFields();
+          for (PlusTrackedFrame::FieldMapType::const_iterator fieldIterator = frameFields.begin(); fieldIterator != frameFields.end(); ++fieldIterator)
           {
-            if (trackedFrame.GetFrameField(*stringNameIterator) == NULL)
-            {
-              // No value is available, do not send anything
-              LOG_WARNING("No metadata value for: " << *stringNameIterator)
-              continue;
-            }
-            imageMessage->SetMetaDataElement(*stringNameIterator, IANA_TYPE_US_ASCII, trackedFrame.GetFrameField(*stringNameIterator));
+            imageMessage->SetMetaDataElement(fieldIterator->first, IANA_TYPE_US_ASCII, fieldIterator->second);
           }
 
           if (vtkPlusIgtlMessageCommon::PackImageMessage(imageMessage, trackedFrame, *matrix) != PLUS_SUCCESS)
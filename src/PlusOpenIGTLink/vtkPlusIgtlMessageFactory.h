@@ -84,6 +84,14 @@ public:
   PlusStatus PackMessages(int clientId, const PlusIgtlClientInfo& clientInfo, std::vector<igtl::MessageBase::Pointer>& igtMessages, PlusTrackedFrame& trackedFrame,
     bool packValidTransformsOnly, vtkPlusTransformRepository* transformRepository=NULL);
 
+  /*!
+  If enabled then IMAGE messages are created as igtl::PlusImageMessage: only the headers are packed and the
+  pixels are sent directly from the frame image by igtl::PlusImageMessage::Send. Disabled by default.
+  */
+  vtkGetMacro(ZeroCopyImageMessages, bool);
+  vtkSetMacro(ZeroCopyImageMessages, bool);
+  vtkBooleanMacro(ZeroCopyImageMessages, bool);
+
 #if defined(OpenIGTLink_ENABLE_VIDEOSTREAMING)
   /*!
   Remove all encoders with matching clientId from this->IgtlVideoEncoders
@@ -98,6 +106,8 @@ protected:
 
   igtl::MessageFactory::Pointer IgtlFactory;
 
+  bool ZeroCopyImageMessages;
+
 #if defined(OpenIGTLink_ENABLE_VIDEOSTREAMING)
   struct ClientEncoderKeyType
   {
@@ -0,0 +1,90 @@
+/*=Plus=header=begin======================================================
+Program: Plus
+Copyright (c) Laboratory for Percutaneous Surgery. All rights reserved.
+See License.txt for details.
+=========================================================Plus=header=end*/
+
+#include "PlusConfigure.h"
+#include "vtkPlusCommandProcessor.h"
+#include "vtkPlusGetSendQueueStatusCommand.h"
+#include "vtkPlusOpenIGTLinkServer.h"
+
+// STL includes
+#include <sstream>
+
+vtkStandardNewMacro(vtkPlusGetSendQueueStatusCommand);
+
+namespace
+{
+  static const std::string GET_SEND_QUEUE_STATUS_CMD = "GetSendQueueStatus";
+}
+
+//----------------------------------------------------------------------------
+vtkPlusGetSendQueueStatusCommand::vtkPlusGetSendQueueStatusCommand()
+{
+  // It handles only one command, set its name by default
+  this->SetName(GET_SEND_QUEUE_STATUS_CMD);
+}
+
+//----------------------------------------------------------------------------
+vtkPlusGetSendQueueStatusCommand::~vtkPlusGetSendQueueStatusCommand()
+{
+}
+
+//----------------------------------------------------------------------------
+void vtkPlusGetSendQueueStatusCommand::SetNameToGetSendQueueStatus()
+{
+  this->SetName(GET_SEND_QUEUE_STATUS_CMD);
+}
+
+//----------------------------------------------------------------------------
+void vtkPlusGetSendQueueStatusCommand::GetCommandNames(std::list<std::string>& cmdNames)
+{
+  cmdNames.clear();
+  cmdNames.push_back(GET_SEND_QUEUE_STATUS_CMD);
+}
+
+//----------------------------------------------------------------------------
+std::string vtkPlusGetSendQueueStatusCommand::GetDescription(const std::string& commandName)
+{
+  std::string desc;
+  if (commandName.empty() || PlusCommon::IsEqualInsensitive(commandName, GET_SEND_QUEUE_STATUS_CMD))
+  {
+    desc += GET_SEND_QUEUE_STATUS_CMD;
+    desc += ": Return the number of messages waiting in the send queue of the client and the number of messages dropped because the client could not keep up.";
+  }
+  return desc;
+}
+
+//----------------------------------------------------------------------------
+PlusStatus vtkPlusGetSendQueueStatusCommand::Execute()
+{
+  if (this->CommandProcessor == NULL || this->CommandProcessor->GetPlusServer() == NULL)
+  {
+    this->QueueCommandResponse(PLUS_FAIL, "Command failed. See error message.", "No OpenIGTLink server is available.");
+    return PLUS_FAIL;
+  }
+
+  unsigned int queueDepth = 0;
+  unsigned long numberOfDroppedMessages = 0;
+  if (this->CommandProcessor->GetPlusServer()->GetClientSendQueueStatus(this->GetClientId(), queueDepth, numberOfDroppedMessages) != PLUS_SUCCESS)
+  {
+    std::ostringstream error;
+    error << "Unable to locate client data for client id: " << this->GetClientId();
+    this->QueueCommandResponse(PLUS_FAIL, "Command failed. See error message.", error.str());
+    return PLUS_FAIL;
+  }
+
+  std::ostringstream queueDepthStr;
+  queueDepthStr << queueDepth;
+  std::ostringstream numberOfDroppedMessagesStr;
+  numberOfDroppedMessagesStr << numberOfDroppedMessages;
+  igtl::MessageBase::MetaDataMap metadata;
+  metadata["SendQueueDepth"] = std::pair<IANA_ENCODING_TYPE, std::string>(IANA_TYPE_US_ASCII, queueDepthStr.str());
+  metadata["DroppedMessages"] = std::pair<IANA_ENCODING_TYPE, std::string>(IANA_TYPE_US_ASCII, numberOfDroppedMessagesStr.str());
+
+  std::ostringstream response;
+  response << "Send queue depth: " << queueDepth << ", dropped messages: " << numberOfDroppedMessages;
+  this->QueueCommandResponse(PLUS_SUCCESS, response.str(), "", &metadata);
+  return PLUS_SUCCESS;
+}
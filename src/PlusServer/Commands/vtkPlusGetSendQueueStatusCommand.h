@@ -0,0 +1,51 @@
+/*=Plus=header=begin======================================================
+  Program: Plus
+  Copyright (c) Laboratory for Percutaneous Surgery. All rights reserved.
+  See License.txt for details.
+=========================================================Plus=header=end*/
+
+#ifndef __vtkPlusGetSendQueueStatusCommand_h
+#define __vtkPlusGetSendQueueStatusCommand_h
+
+#include "vtkPlusServerExport.h"
+
+#include "vtkPlusCommand.h"
+
+/*!
+  \class vtkPlusGetSendQueueStatusCommand
+  \brief This command reports the state of the send queue of the requesting client
+
+  The response metadata contains the number of messages waiting in the client's send queue (SendQueueDepth)
+  and the number of messages dropped since the client connected because it could not keep up (DroppedMessages).
+
+  \ingroup PlusLibPlusServer
+ */
+class vtkPlusServerExport vtkPlusGetSendQueueStatusCommand : public vtkPlusCommand
+{
+public:
+
+  static vtkPlusGetSendQueueStatusCommand* New();
+  vtkTypeMacro(vtkPlusGetSendQueueStatusCommand, vtkPlusCommand);
+  virtual vtkPlusCommand* Clone() { return New(); }
+
+  /*! Executes the command  */
+  virtual PlusStatus Execute();
+
+  /*! Get all the command names that this class can execute */
+  virtual void GetCommandNames(std::list<std::string>& cmdNames);
+
+  /*! Gets the description for the specified command name. */
+  virtual std::string GetDescription(const std::string& commandName);
+
+  void SetNameToGetSendQueueStatus();
+
+protected:
+  vtkPlusGetSendQueueStatusCommand();
+  virtual ~vtkPlusGetSendQueueStatusCommand();
+
+private:
+  vtkPlusGetSendQueueStatusCommand(const vtkPlusGetSendQueueStatusCommand&);
+  void operator=(const vtkPlusGetSendQueueStatusCommand&);
+};
+
+#endif
@@ -0,0 +1,104 @@
+/*=Plus=header=begin======================================================
+Program: Plus
+Copyright (c) Laboratory for Percutaneous Surgery. All rights reserved.
+See License.txt for details.
+=========================================================Plus=header=end*/
+
+#include "PlusConfigure.h"
+#include "PlusLatencyTracer.h"
+#include "vtkPlusLatencyTraceCommand.h"
+
+// STL includes
+#include <sstream>
+
+vtkStandardNewMacro(vtkPlusLatencyTraceCommand);
+
+namespace
+{
+  static const std::string START_CMD = "StartLatencyTrace";
+  static const std::string STOP_CMD = "StopLatencyTrace";
+  static const std::string GET_CMD = "GetLatencyTrace";
+}
+
+//----------------------------------------------------------------------------
+vtkPlusLatencyTraceCommand::vtkPlusLatencyTraceCommand()
+{
+}
+
+//----------------------------------------------------------------------------
+vtkPlusLatencyTraceCommand::~vtkPlusLatencyTraceCommand()
+{
+}
+
+//----------------------------------------------------------------------------
+void vtkPlusLatencyTraceCommand::SetNameToStart() { SetName(START_CMD); }
+void vtkPlusLatencyTraceCommand::SetNameToStop() { SetName(STOP_CMD); }
+void vtkPlusLatencyTraceCommand::SetNameToGet() { SetName(GET_CMD); }
+
+//----------------------------------------------------------------------------
+void vtkPlusLatencyTraceCommand::GetCommandNames(std::list<std::string>& cmdNames)
+{
+  cmdNames.clear();
+  cmdNames.push_back(START_CMD);
+  cmdNames.push_back(STOP_CMD);
+  cmdNames.push_back(GET_CMD);
+}
+
+//----------------------------------------------------------------------------
+std::string vtkPlusLatencyTraceCommand::GetDescription(const std::string& commandName)
+{
+  std::string desc;
+  if (commandName.empty() || PlusCommon::IsEqualInsensitive(commandName, START_CMD))
+  {
+    desc += START_CMD;
+    desc += ": Clear the collected latency statistics and start per-frame latency tracing.";
+  }
+  if (commandName.empty() || PlusCommon::IsEqualInsensitive(commandName, STOP_CMD))
+  {
+    desc += STOP_CMD;
+    desc += ": Stop per-frame latency tracing and return the collected latency statistics.";
+  }
+  if (commandName.empty() || PlusCommon::IsEqualInsensitive(commandName, GET_CMD))
+  {
+    desc += GET_CMD;
+    desc += ": Return the collected latency statistics (median, 99th percentile, and maximum latency for each source and stage).";
+  }
+  return desc;
+}
+
+//----------------------------------------------------------------------------
+PlusStatus vtkPlusLatencyTraceCommand::Execute()
+{
+  PlusLatencyTracer* tracer = PlusLatencyTracer::GetInstance();
+
+  if (PlusCommon::IsEqualInsensitive(this->Name, START_CMD))
+  {
+    tracer->Reset();
+    tracer->SetEnabled(true);
+    this->QueueCommandResponse(PLUS_SUCCESS, "Latency tracing started.");
+    return PLUS_SUCCESS;
+  }
+
+  if (PlusCommon::IsEqualInsensitive(this->Name, STOP_CMD))
+  {
+    tracer->SetEnabled(false);
+  }
+  else if (!PlusCommon::IsEqualInsensitive(this->Name, GET_CMD))
+  {
+    this->QueueCommandResponse(PLUS_FAIL, "Command failed. See error message.", "Unknown command: " + this->Name);
+    return PLUS_FAIL;
+  }
+
+  igtl::MessageBase::MetaDataMap metadata;
+  std::vector<PlusLatencyTracer::LatencyStatistics> statistics;
+  tracer->GetLatencyStatistics(statistics);
+  for (std::vector<PlusLatencyTracer::LatencyStatistics>::iterator it = statistics.begin(); it != statistics.end(); ++it)
+  {
+    std::ostringstream value;
+    value << it->MedianSec << " " << it->Percentile99Sec << " " << it->MaximumSec << " " << it->NumberOfFrames;
+    metadata[it->SourceName + " " + PlusLatencyTracer::GetStageName(it->Stage)] = std::pair<IANA_ENCODING_TYPE, std::string>(IANA_TYPE_US_ASCII, value.str());
+  }
+
+  this->QueueCommandResponse(PLUS_SUCCESS, tracer->GetLatencyReport(), "", &metadata);
+  return PLUS_SUCCESS;
+}
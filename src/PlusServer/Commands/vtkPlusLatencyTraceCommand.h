@@ -0,0 +1,54 @@
+/*=Plus=header=begin======================================================
+  Program: Plus
+  Copyright (c) Laboratory for Percutaneous Surgery. All rights reserved.
+  See License.txt for details.
+=========================================================Plus=header=end*/
+
+#ifndef __vtkPlusLatencyTraceCommand_h
+#define __vtkPlusLatencyTraceCommand_h
+
+#include "vtkPlusServerExport.h"
+
+#include "vtkPlusCommand.h"
+
+/*!
+  \class vtkPlusLatencyTraceCommand
+  \brief This command starts, stops per-frame latency tracing and reports the collected latency statistics
+
+  The response message of the GetLatencyTrace command contains the latency statistics as a single line of text.
+  The response metadata contains one entry for each traced source and stage: the key is the source name
+  and the stage name, the value is the median, 99th percentile, and maximum latency (in seconds) and the number of frames.
+
+  \ingroup PlusLibPlusServer
+ */
+class vtkPlusServerExport vtkPlusLatencyTraceCommand : public vtkPlusCommand
+{
+public:
+
+  static vtkPlusLatencyTraceCommand* New();
+  vtkTypeMacro(vtkPlusLatencyTraceCommand, vtkPlusCommand);
+  virtual vtkPlusCommand* Clone() { return New(); }
+
+  /*! Executes the command  */
+  virtual PlusStatus Execute();
+
+  /*! Get all the command names that this class can execute */
+  virtual void GetCommandNames(std::list<std::string>& cmdNames);
+
+  /*! Gets the description for the specified command name. */
+  virtual std::string GetDescription(const std::string& commandName);
+
+  void SetNameToStart();
+  void SetNameToStop();
+  void SetNameToGet();
+
+protected:
+  vtkPlusLatencyTraceCommand();
+  virtual ~vtkPlusLatencyTraceCommand();
+
+private:
+  vtkPlusLatencyTraceCommand(const vtkPlusLatencyTraceCommand&);
+  void operator=(const vtkPlusLatencyTraceCommand&);
+};
+
+#endif
@@ -358,6 +358,7 @@ PlusStatus vtkPlusStartStopRecordingCommand::Execute()
     }
 
     long numberOfFramesRecorded = captureDevice->GetTotalFramesRecorded();
+    long numberOfFramesDropped = captureDevice->GetNumberOfDroppedFrames();
     std::string actualOutputFilename;
     if (captureDevice->CloseFile(this->OutputFilename.c_str(), &actualOutputFilename) != PLUS_SUCCESS)
     {
@@ -366,6 +367,10 @@ PlusStatus vtkPlusStartStopRecordingCommand::Execute()
     }
     std::ostringstream ss;
     ss << "Recording " << numberOfFramesRecorded << " frames successful to file " << actualOutputFilename;
+    if (numberOfFramesDropped > 0)
+    {
+      ss << " (" << numberOfFramesDropped << " frames were dropped because writing to disk could not keep up with the recording)";
+    }
     this->QueueCommandResponse(PLUS_SUCCESS, responseMessageBase + ss.str());
     return PLUS_SUCCESS;
   }
@@ -0,0 +1,297 @@
+/*=Plus=header=begin======================================================
+Program: Plus
+Copyright (c) Laboratory for Percutaneous Surgery. All rights reserved.
+See License.txt for details.
+=========================================================Plus=header=end*/
+
+/*!
+  \file vtkPlusServerLatencyTraceTest.cxx
+  \brief Streams tracking data from a fake tracker through the buffer, the channel, and the OpenIGTLink server to a client,
+  controls latency tracing with the latency trace commands, and checks that the latency of every stage is recorded
+*/
+
+// Local includes
+#include "PlusConfigure.h"
+#include "PlusLatencyTracer.h"
+#include "vtkPlusAccurateTimer.h"
+#include "vtkPlusCommandResponse.h"
+#include "vtkPlusDataCollector.h"
+#include "vtkPlusLatencyTraceCommand.h"
+#include "vtkPlusOpenIGTLinkServer.h"
+#include "vtkPlusTransformRepository.h"
+
+// VTK includes
+#include <vtkSmartPointer.h>
+#include <vtkXMLUtilities.h>
+#include <vtksys/CommandLineArguments.hxx>
+#include <vtksys/SystemTools.hxx>
+
+// IGTL includes
+#include <igtlClientSocket.h>
+#include <igtlMessageHeader.h>
+
+namespace
+{
+  const double NO_CLIENT_PERIOD_SEC = 0.5;
+  const double STREAMING_PERIOD_SEC = 1.0;
+
+  //----------------------------------------------------------------------------
+  std::string GetConfiguration(int listeningPort)
+  {
+    std::ostringstream config;
+    config << "<PlusConfiguration version=\"2.1\">" << std::endl
+           << "  <DataCollection StartupDelaySec=\"0\">" << std::endl
+           << "    <DeviceSet Name=\"Latency trace test\" Description=\"Fake tracker streamed by the OpenIGTLink server\" />" << std::endl
+           << "    <Device Id=\"TrackerDevice\" Type=\"FakeTracker\" AcquisitionRate=\"50\" Mode=\"SmoothMove\">" << std::endl
+           << "      <DataSources>" << std::endl
+           << "        <DataSource Type=\"Tool\" Id=\"Probe\" />" << std::endl
+           << "        <DataSource Type=\"Tool\" Id=\"Reference\" />" << std::endl
+           << "        <DataSource Type=\"Tool\" Id=\"MissingTool\" />" << std::endl
+           << "      </DataSources>" << std::endl
+           << "      <OutputChannels>" << std::endl
+           << "        <OutputChannel Id=\"TrackerStream\">" << std::endl
+           << "          <DataSource Id=\"Probe\" />" << std::endl
+           << "          <DataSource Id=\"Reference\" />" << std::endl
+           << "          <DataSource Id=\"MissingTool\" />" << std::endl
+           << "        </OutputChannel>" << std::endl
+           << "      </OutputChannels>" << std::endl
+           << "    </Device>" << std::endl
+           << "  </DataCollection>" << std::endl
+           << "  <PlusOpenIGTLinkServer ListeningPort=\"" << listeningPort << "\" OutputChannelId=\"TrackerStream\" SendValidTransformsOnly=\"FALSE\">" << std::endl
+           << "    <DefaultClientInfo>" << std::endl
+           << "      <MessageTypes>" << std::endl
+           << "        <Message Type=\"TRANSFORM\" />" << std::endl
+           << "      </MessageTypes>" << std::endl
+           << "      <TransformNames>" << std::endl
+           << "        <Transform Name=\"ProbeToTracker\" />" << std::endl
+           << "      </TransformNames>" << std::endl
+           << "    </DefaultClientInfo>" << std::endl
+           << "  </PlusOpenIGTLinkServer>" << std::endl
+           << "</PlusConfiguration>" << std::endl;
+    return config.str();
+  }
+
+  //----------------------------------------------------------------------------
+  // Executes a latency trace command and returns its response
+  PlusStatus ExecuteLatencyTraceCommand(const std::string& commandName, vtkSmartPointer<vtkPlusCommandRTSCommandResponse>& response)
+  {
+    vtkSmartPointer<vtkPlusLatencyTraceCommand> command = vtkSmartPointer<vtkPlusLatencyTraceCommand>::New();
+    command->SetName(commandName);
+    if (command->Execute() != PLUS_SUCCESS)
+    {
+      LOG_ERROR("Command " << commandName << " failed");
+      return PLUS_FAIL;
+    }
+    PlusCommandResponseList responses;
+    command->PopCommandResponses(responses);
+    if (responses.size() != 1)
+    {
+      LOG_ERROR("Command " << commandName << " returned " << responses.size() << " responses, expected 1");
+      return PLUS_FAIL;
+    }
+    response = vtkPlusCommandRTSCommandResponse::SafeDownCast(responses.front());
+    if (response.GetPointer() == NULL || response->GetStatus() != PLUS_SUCCESS)
+    {
+      LOG_ERROR("Command " << commandName << " did not return a successful command response");
+      return PLUS_FAIL;
+    }
+    return PLUS_SUCCESS;
+  }
+
+  //----------------------------------------------------------------------------
+  // Returns the number of frames recorded for a stage (summed over all sources)
+  unsigned long GetNumberOfTracedFrames(PlusLatencyTracer::TraceStage stage)
+  {
+    std::vector<PlusLatencyTracer::LatencyStatistics> statistics;
+    PlusLatencyTracer::GetInstance()->GetLatencyStatistics(statistics);
+    unsigned long numberOfFrames = 0;
+    for (std::vector<PlusLatencyTracer::LatencyStatistics>::iterator it = statistics.begin(); it != statistics.end(); ++it)
+    {
+      if (it->Stage == stage)
+      {
+        numberOfFrames += it->NumberOfFrames;
+      }
+    }
+    return numberOfFrames;
+  }
+
+  //----------------------------------------------------------------------------
+  // Receives messages until the period elapses, returns the number of TRANSFORM messages
+  int ReceiveMessages(igtl::ClientSocket::Pointer clientSocket, double periodSec)
+  {
+    int numberOfTransformMessages = 0;
+    double startTime = vtkPlusAccurateTimer::GetSystemTime();
+    while (vtkPlusAccurateTimer::GetSystemTime() - startTime < periodSec)
+    {
+      igtl::MessageHeader::Pointer headerMsg = igtl::MessageHeader::New();
+      headerMsg->InitBuffer();
+      if (clientSocket->Receive(headerMsg->GetBufferPointer(), headerMsg->GetBufferSize()) != headerMsg->GetBufferSize())
+      {
+        // receive timeout
+        continue;
+      }
+      headerMsg->Unpack();
+      if (std::string(headerMsg->GetDeviceType()) == "TRANSFORM")
+      {
+        numberOfTransformMessages++;
+      }
+      clientSocket->Skip(headerMsg->GetBodySizeToRead(), 0);
+    }
+    return numberOfTransformMessages;
+  }
+}
+
+//----------------------------------------------------------------------------
+int main(int argc, char** argv)
+{
+  bool printHelp(false);
+  int listeningPort(18960);
+  int verboseLevel = vtkPlusLogger::LOG_LEVEL_UNDEFINED;
+
+  vtksys::CommandLineArguments args;
+  args.Initialize(argc, argv);
+
+  args.AddArgument("--help", vtksys::CommandLineArguments::NO_ARGUMENT, &printHelp, "Print this help.");
+  args.AddArgument("--port", vtksys::CommandLineArguments::EQUAL_ARGUMENT, &listeningPort, "Port of the OpenIGTLink server (Default: 18960)");
+  args.AddArgument("--verbose", vtksys::CommandLineArguments::EQUAL_ARGUMENT, &verboseLevel, "Verbose level (1=error only, 2=warning, 3=info, 4=debug, 5=trace)");
+
+  if (!args.Parse())
+  {
+    std::cerr << "Problem parsing arguments" << std::endl;
+    std::cout << "Help: " << args.GetHelp() << std::endl;
+    exit(EXIT_FAILURE);
+  }
+
+  if (printHelp)
+  {
+    std::cout << args.GetHelp() << std::endl;
+    exit(EXIT_SUCCESS);
+  }
+
+  vtkPlusLogger::Instance()->SetLogLevel(verboseLevel);
+
+  vtkSmartPointer<vtkXMLDataElement> configRootElement = vtkSmartPointer<vtkXMLDataElement>::Take(vtkXMLUtilities::ReadElementFromString(GetConfiguration(listeningPort).c_str()));
+  if (configRootElement.GetPointer() == NULL)
+  {
+    LOG_ERROR("Unable to parse the device set configuration");
+    exit(EXIT_FAILURE);
+  }
+  vtkPlusConfig::GetInstance()->SetDeviceSetConfigurationData(configRootElement);
+
+  vtkSmartPointer<vtkPlusDataCollector> dataCollector = vtkSmartPointer<vtkPlusDataCollector>::New();
+  if (dataCollector->ReadConfiguration(configRootElement) != PLUS_SUCCESS)
+  {
+    LOG_ERROR("Unable to configure data collector");
+    exit(EXIT_FAILURE);
+  }
+  vtkSmartPointer<vtkPlusTransformRepository> transformRepository = vtkSmartPointer<vtkPlusTransformRepository>::New();
+  if (transformRepository->ReadConfiguration(configRootElement) != PLUS_SUCCESS)
+  {
+    LOG_ERROR("Unable to configure transform repository");
+    exit(EXIT_FAILURE);
+  }
+  if (dataCollector->Connect() != PLUS_SUCCESS)
+  {
+    LOG_ERROR("Failed to connect to data collector!");
+    exit(EXIT_FAILURE);
+  }
+  if (dataCollector->Start() != PLUS_SUCCESS)
+  {
+    LOG_ERROR("Failed to start data collection!");
+    exit(EXIT_FAILURE);
+  }
+
+  int numberOfFailures(0);
+
+  vtkSmartPointer<vtkPlusCommandRTSCommandResponse> response;
+  if (ExecuteLatencyTraceCommand("StartLatencyTrace", response) != PLUS_SUCCESS)
+  {
+    numberOfFailures++;
+  }
+  if (!PlusLatencyTracer::IsEnabled())
+  {
+    LOG_ERROR("Latency tracing is not enabled by StartLatencyTrace");
+    numberOfFailures++;
+  }
+
+  vtkSmartPointer<vtkPlusOpenIGTLinkServer> server = vtkSmartPointer<vtkPlusOpenIGTLinkServer>::New();
+  if (server->Start(dataCollector, transformRepository, configRootElement->FindNestedElementWithName("PlusOpenIGTLinkServer"), "vtkPlusServerLatencyTraceTest.xml") != PLUS_SUCCESS)
+  {
+    LOG_ERROR("Failed to start OpenIGTLink server");
+    exit(EXIT_FAILURE);
+  }
+
+  // Frames are not broadcast while no client is connected
+  vtksys::SystemTools::Delay(static_cast<unsigned int>(NO_CLIENT_PERIOD_SEC * 1000));
+  if (GetNumberOfTracedFrames(PlusLatencyTracer::STAGE_BROADCAST) != 0)
+  {
+    LOG_ERROR("Broadcast latency is recorded for " << GetNumberOfTracedFrames(PlusLatencyTracer::STAGE_BROADCAST) << " frames while no client is connected");
+    numberOfFailures++;
+  }
+
+  igtl::ClientSocket::Pointer clientSocket = igtl::ClientSocket::New();
+  if (clientSocket->ConnectToServer("127.0.0.1", listeningPort) != 0)
+  {
+    LOG_ERROR("Failed to connect to the OpenIGTLink server on port " << listeningPort);
+    exit(EXIT_FAILURE);
+  }
+  clientSocket->SetReceiveTimeout(100);
+  int numberOfTransformMessages = ReceiveMessages(clientSocket, STREAMING_PERIOD_SEC);
+  if (numberOfTransformMessages == 0)
+  {
+    LOG_ERROR("No TRANSFORM messages were received from the server");
+    numberOfFailures++;
+  }
+
+  // Every stage from the acquisition to the broadcast must have a latency recorded
+  if (ExecuteLatencyTraceCommand("GetLatencyTrace", response) != PLUS_SUCCESS)
+  {
+    numberOfFailures++;
+  }
+  else
+  {
+    const PlusLatencyTracer::TraceStage tracedStages[] = { PlusLatencyTracer::STAGE_BUFFERED, PlusLatencyTracer::STAGE_CHANNEL_READ, PlusLatencyTracer::STAGE_BROADCAST };
+    for (int i = 0; i < 3; i++)
+    {
+      std::string stageName = PlusLatencyTracer::GetStageName(tracedStages[i]);
+      bool stageReported = false;
+      const igtl::MessageBase::MetaDataMap& parameters = response->GetParameters();
+      for (igtl::MessageBase::MetaDataMap::const_iterator it = parameters.begin(); it != parameters.end(); ++it)
+      {
+        if (it->first.length() > stageName.length() && it->first.compare(it->first.length() - stageName.length(), stageName.length(), stageName) == 0)
+        {
+          stageReported = true;
+        }
+      }
+      if (!stageReported || GetNumberOfTracedFrames(tracedStages[i]) == 0)
+      {
+        LOG_ERROR("No latency is reported for stage " << stageName << ". Report: " << response->GetResultString());
+        numberOfFailures++;
+      }
+    }
+    LOG_INFO("Latency trace: " << response->GetResultString());
+  }
+
+  if (ExecuteLatencyTraceCommand("StopLatencyTrace", response) != PLUS_SUCCESS)
+  {
+    numberOfFailures++;
+  }
+  if (PlusLatencyTracer::IsEnabled())
+  {
+    LOG_ERROR("Latency tracing is not disabled by StopLatencyTrace");
+    numberOfFailures++;
+  }
+
+  clientSocket->CloseSocket();
+  server->Stop();
+  dataCollector->Stop();
+  dataCollector->Disconnect();
+
+  if (numberOfFailures > 0)
+  {
+    LOG_ERROR("Number of failures: " << numberOfFailures);
+    return EXIT_FAILURE;
+  }
+  LOG_INFO("Test completed successfully");
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,301 @@
+/*=Plus=header=begin======================================================
+Program: Plus
+Copyright (c) Laboratory for Percutaneous Surgery. All rights reserved.
+See License.txt for details.
+=========================================================Plus=header=end*/
+
+/*!
+  \file vtkPlusServerSendQueueTest.cxx
+  \brief Test the per-client send queue of the OpenIGTLink server: queue size limit, drop policies, and a slow client
+*/
+
+// Local includes
+#include "PlusConfigure.h"
+#include "vtkPlusOpenIGTLinkServer.h"
+
+// VTK includes
+#include <vtksys/CommandLineArguments.hxx>
+
+// IGTL includes
+#include <igtlImageMessage.h>
+#include <igtlStringMessage.h>
+#include <igtlTransformMessage.h>
+
+// STL includes
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+namespace
+{
+  const int MAX_NUMBER_OF_FRAME_MESSAGES = 4;
+
+  //----------------------------------------------------------------------------
+  // Messages of a tracked frame: an IMAGE and a TRANSFORM message, the device name identifies the frame
+  std::vector<igtl::MessageBase::Pointer> CreateFrameMessages(int frameIndex)
+  {
+    std::string deviceName = PlusCommon::ToString<int>(frameIndex);
+    igtl::ImageMessage::Pointer imageMessage = igtl::ImageMessage::New();
+    imageMessage->SetDeviceName(deviceName.c_str());
+    igtl::TransformMessage::Pointer transformMessage = igtl::TransformMessage::New();
+    transformMessage->SetDeviceName(deviceName.c_str());
+    std::vector<igtl::MessageBase::Pointer> messages;
+    messages.push_back(imageMessage.GetPointer());
+    messages.push_back(transformMessage.GetPointer());
+    return messages;
+  }
+
+  //----------------------------------------------------------------------------
+  igtl::MessageBase::Pointer CreateResponseMessage(const std::string& deviceName)
+  {
+    igtl::StringMessage::Pointer responseMessage = igtl::StringMessage::New();
+    responseMessage->SetDeviceName(deviceName.c_str());
+    return responseMessage.GetPointer();
+  }
+
+  //----------------------------------------------------------------------------
+  // Compare the queued messages to the expected list of "type:device name" strings
+  PlusStatus CheckQueueContents(ClientSendQueue& sendQueue, const std::vector<std::string>& expectedMessages)
+  {
+    std::vector<std::string> queuedMessages;
+    ClientSendQueue::QueuedMessage queuedMessage;
+    while (sendQueue.PopMessage(queuedMessage, 0))
+    {
+      queuedMessages.push_back(std::string(queuedMessage.Message->GetMessageType()) + ":" + queuedMessage.Message->GetDeviceName());
+    }
+    if (queuedMessages != expectedMessages)
+    {
+      std::ostringstream queued;
+      std::ostringstream expected;
+      for (std::vector<std::string>::iterator it = queuedMessages.begin(); it != queuedMessages.end(); ++it)
+      {
+        queued << " " << *it;
+      }
+      for (std::vector<std::string>::const_iterator it = expectedMessages.begin(); it != expectedMessages.end(); ++it)
+      {
+        expected << " " << *it;
+      }
+      LOG_ERROR("Unexpected send queue contents:" << queued.str() << " (expected:" << expected.str() << ")");
+      return PLUS_FAIL;
+    }
+    return PLUS_SUCCESS;
+  }
+
+  //----------------------------------------------------------------------------
+  // The oldest image messages are dropped first, other frame data and responses are kept
+  PlusStatus TestDropOldestImage()
+  {
+    ClientSendQueue sendQueue;
+    sendQueue.PushMessage(CreateResponseMessage("Response"));
+    unsigned long numberOfDroppedMessages = 0;
+    for (int frameIndex = 0; frameIndex < 3; ++frameIndex)
+    {
+      numberOfDroppedMessages += sendQueue.PushFrameMessages(CreateFrameMessages(frameIndex), MAX_NUMBER_OF_FRAME_MESSAGES, false);
+    }
+    if (numberOfDroppedMessages != 2 || sendQueue.NumberOfDroppedMessages != 2 || sendQueue.NumberOfQueuedFrameMessages != MAX_NUMBER_OF_FRAME_MESSAGES)
+    {
+      LOG_ERROR("DROP_OLDEST_IMAGE: unexpected number of dropped (" << numberOfDroppedMessages << ") or queued (" << sendQueue.NumberOfQueuedFrameMessages << ") messages");
+      return PLUS_FAIL;
+    }
+    std::vector<std::string> expectedMessages;
+    expectedMessages.push_back("STRING:Response");
+    expectedMessages.push_back("TRANSFORM:0");
+    expectedMessages.push_back("TRANSFORM:1");
+    expectedMessages.push_back("IMAGE:2");
+    expectedMessages.push_back("TRANSFORM:2");
+    if (CheckQueueContents(sendQueue, expectedMessages) != PLUS_SUCCESS)
+    {
+      LOG_ERROR("DROP_OLDEST_IMAGE policy test failed");
+      return PLUS_FAIL;
+    }
+
+    // Without image messages the oldest frame data is dropped
+    std::vector<igtl::MessageBase::Pointer> transformMessages;
+    for (int frameIndex = 0; frameIndex < MAX_NUMBER_OF_FRAME_MESSAGES + 1; ++frameIndex)
+    {
+      transformMessages.push_back(CreateFrameMessages(frameIndex)[1]);
+    }
+    if (sendQueue.PushFrameMessages(transformMessages, MAX_NUMBER_OF_FRAME_MESSAGES, false) != 1)
+    {
+      LOG_ERROR("DROP_OLDEST_IMAGE: oldest transform message was not dropped");
+      return PLUS_FAIL;
+    }
+    expectedMessages.clear();
+    for (int frameIndex = 1; frameIndex < MAX_NUMBER_OF_FRAME_MESSAGES + 1; ++frameIndex)
+    {
+      expectedMessages.push_back("TRANSFORM:" + PlusCommon::ToString<int>(frameIndex));
+    }
+    return CheckQueueContents(sendQueue, expectedMessages);
+  }
+
+  //----------------------------------------------------------------------------
+  // All queued frame data is replaced by the new frame, responses are kept
+  PlusStatus TestKeepLatestOnly()
+  {
+    ClientSendQueue sendQueue;
+    sendQueue.PushFrameMessages(CreateFrameMessages(0), MAX_NUMBER_OF_FRAME_MESSAGES, true);
+    sendQueue.PushMessage(CreateResponseMessage("Response"));
+    unsigned long numberOfDroppedMessages = sendQueue.PushFrameMessages(CreateFrameMessages(1), MAX_NUMBER_OF_FRAME_MESSAGES, true);
+    if (numberOfDroppedMessages != 2 || sendQueue.NumberOfQueuedFrameMessages != 2)
+    {
+      LOG_ERROR("KEEP_LATEST_ONLY: unexpected number of dropped (" << numberOfDroppedMessages << ") or queued (" << sendQueue.NumberOfQueuedFrameMessages << ") messages");
+      return PLUS_FAIL;
+    }
+    std::vector<std::string> expectedMessages;
+    expectedMessages.push_back("STRING:Response");
+    expectedMessages.push_back("IMAGE:1");
+    expectedMessages.push_back("TRANSFORM:1");
+    if (CheckQueueContents(sendQueue, expectedMessages) != PLUS_SUCCESS)
+    {
+      LOG_ERROR("KEEP_LATEST_ONLY policy test failed");
+      return PLUS_FAIL;
+    }
+    return PLUS_SUCCESS;
+  }
+
+  //----------------------------------------------------------------------------
+  // A client that receives messages slower than frames are produced: the queue size stays within the limit,
+  // frames are received in order, responses are never dropped, and each frame message is either received or counted as dropped
+  PlusStatus TestSlowClient(bool keepLatestFrameOnly)
+  {
+    const int numberOfFrames = 200;
+    const int responsePeriodFrames = 10;
+    ClientSendQueue sendQueue;
+
+    std::atomic<bool> producerFinished(false);
+    std::atomic<int> numberOfReceivedFrameMessages(0);
+    std::atomic<int> numberOfReceivedResponses(0);
+    std::atomic<bool> outOfOrder(false);
+    std::thread slowClient([&]()
+    {
+      int lastFrameIndex = -1;
+      ClientSendQueue::QueuedMessage queuedMessage;
+      while (true)
+      {
+        if (!sendQueue.PopMessage(queuedMessage, 10))
+        {
+          if (producerFinished)
+          {
+            break;
+          }
+          continue;
+        }
+        if (!queuedMessage.FrameData)
+        {
+          numberOfReceivedResponses++;
+          continue;
+        }
+        numberOfReceivedFrameMessages++;
+        int frameIndex = atoi(queuedMessage.Message->GetDeviceName());
+        if (frameIndex < lastFrameIndex)
+        {
+          outOfOrder = true;
+        }
+        lastFrameIndex = frameIndex;
+        // Slow network
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+      }
+    });
+
+    int numberOfErrors = 0;
+    unsigned long numberOfDroppedMessages = 0;
+    for (int frameIndex = 0; frameIndex < numberOfFrames; ++frameIndex)
+    {
+      if (frameIndex % responsePeriodFrames == 0)
+      {
+        sendQueue.PushMessage(CreateResponseMessage("Response"));
+      }
+      numberOfDroppedMessages += sendQueue.PushFrameMessages(CreateFrameMessages(frameIndex), MAX_NUMBER_OF_FRAME_MESSAGES, keepLatestFrameOnly);
+      {
+        std::lock_guard<std::mutex> sendQueueLock(sendQueue.Mutex);
+        if (sendQueue.NumberOfQueuedFrameMessages > static_cast<unsigned int>(MAX_NUMBER_OF_FRAME_MESSAGES))
+        {
+          LOG_ERROR("Send queue size limit exceeded: " << sendQueue.NumberOfQueuedFrameMessages << " frame messages are queued");
+          numberOfErrors++;
+        }
+      }
+      std::this_thread::sleep_for(std::chrono::microseconds(500));
+    }
+    producerFinished = true;
+    slowClient.join();
+
+    if (numberOfDroppedMessages == 0)
+    {
+      LOG_ERROR("No messages were dropped, the client was not slow enough to test the send queue limit");
+      numberOfErrors++;
+    }
+    if (numberOfReceivedFrameMessages + static_cast<int>(numberOfDroppedMessages) != 2 * numberOfFrames)
+    {
+      LOG_ERROR("Frame messages were lost: " << numberOfReceivedFrameMessages << " received, " << numberOfDroppedMessages << " dropped, "
+                << 2 * numberOfFrames << " expected in total");
+      numberOfErrors++;
+    }
+    if (numberOfReceivedResponses != numberOfFrames / responsePeriodFrames)
+    {
+      LOG_ERROR("Responses were dropped: " << numberOfReceivedResponses << " received out of " << numberOfFrames / responsePeriodFrames);
+      numberOfErrors++;
+    }
+    if (outOfOrder)
+    {
+      LOG_ERROR("Frames were received out of order");
+      numberOfErrors++;
+    }
+    LOG_INFO((keepLatestFrameOnly ? "KEEP_LATEST_ONLY" : "DROP_OLDEST_IMAGE") << " slow client: " << numberOfReceivedFrameMessages
+             << " frame messages received, " << numberOfDroppedMessages << " dropped");
+    return (numberOfErrors == 0 ? PLUS_SUCCESS : PLUS_FAIL);
+  }
+}
+
+//-----------------------------------------------------------------------------
+int main(int argc, char** argv)
+{
+  bool printHelp(false);
+  int verboseLevel = vtkPlusLogger::LOG_LEVEL_UNDEFINED;
+
+  vtksys::CommandLineArguments args;
+  args.Initialize(argc, argv);
+
+  args.AddArgument("--help", vtksys::CommandLineArguments::NO_ARGUMENT, &printHelp, "Print this help.");
+  args.AddArgument("--verbose", vtksys::CommandLineArguments::EQUAL_ARGUMENT, &verboseLevel, "Verbose level (1=error only, 2=warning, 3=info, 4=debug, 5=trace)");
+
+  if (!args.Parse())
+  {
+    std::cerr << "Problem parsing arguments." << std::endl;
+    std::cout << "Help: " << args.GetHelp() << std::endl;
+    exit(EXIT_FAILURE);
+  }
+
+  if (printHelp)
+  {
+    std::cout << args.GetHelp() << std::endl;
+    exit(EXIT_SUCCESS);
+  }
+
+  vtkPlusLogger::Instance()->SetLogLevel(verboseLevel);
+
+  int numberOfFailures = 0;
+  if (TestDropOldestImage() != PLUS_SUCCESS)
+  {
+    numberOfFailures++;
+  }
+  if (TestKeepLatestOnly() != PLUS_SUCCESS)
+  {
+    numberOfFailures++;
+  }
+  if (TestSlowClient(false) != PLUS_SUCCESS)
+  {
+    numberOfFailures++;
+  }
+  if (TestSlowClient(true) != PLUS_SUCCESS)
+  {
+    numberOfFailures++;
+  }
+
+  if (numberOfFailures > 0)
+  {
+    LOG_ERROR("Send queue test failed");
+    return EXIT_FAILURE;
+  }
+  LOG_INFO("Send queue test completed successfully");
+  return EXIT_SUCCESS;
+}
@@ -45,6 +45,7 @@ int main(int argc, char** argv)
   std::string testingConfigFileName;
   int verboseLevel = vtkPlusLogger::LOG_LEVEL_UNDEFINED;
   double runTimeSec = 0.0;
+  bool asyncLogging(false);
 
   const int numOfTestClientsToConnect = 5; // only if testing is enabled S
 
@@ -55,6 +56,7 @@ int main(int argc, char** argv)
   args.AddArgument("--config-file", vtksys::CommandLineArguments::EQUAL_ARGUMENT, &inputConfigFileName, "Name of the input configuration file.");
   args.AddArgument("--running-time", vtksys::CommandLineArguments::EQUAL_ARGUMENT, &runTimeSec, "Server running time period in seconds. If the parameter is not defined or 0 then the server runs infinitely.");
   args.AddArgument("--verbose", vtksys::CommandLineArguments::EQUAL_ARGUMENT, &verboseLevel, "Verbose level (1=error only, 2=warning, 3=info, 4=debug, 5=trace)");
+  args.AddArgument("--async-logging", vtksys::CommandLineArguments::NO_ARGUMENT, &asyncLogging, "Write log messages on a background thread, so that acquisition and broadcasting threads do not wait for console and file output. Messages are dropped (and counted) if they are logged faster than they can be written.");
 
   if (!args.Parse())
   {
@@ -70,6 +72,10 @@ int main(int argc, char** argv)
   }
 
   vtkPlusLogger::Instance()->SetLogLevel(verboseLevel);
+  if (asyncLogging)
+  {
+    vtkPlusLogger::Instance()->SetAsynchronousLogging(true);
+  }
 
   if (inputConfigFileName.empty())
   {
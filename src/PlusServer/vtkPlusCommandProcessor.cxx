@@ -21,8 +21,10 @@ See License.txt for details.
 #endif
 #include "vtkPlusAddRecordingDeviceCommand.h"
 #include "vtkPlusGetPolydataCommand.h"
+#include "vtkPlusGetSendQueueStatusCommand.h"
 #include "vtkPlusGetTransformCommand.h"
 #include "vtkPlusGetUsParameterCommand.h"
+#include "vtkPlusLatencyTraceCommand.h"
 #include "vtkPlusRequestIdsCommand.h"
 #include "vtkPlusSaveConfigCommand.h"
 #include "vtkPlusSendTextCommand.h"
@@ -64,6 +66,8 @@ vtkPlusCommandProcessor::vtkPlusCommandProcessor()
   RegisterPlusCommand(vtkSmartPointer<vtkPlusSetUsParameterCommand>::New());
   RegisterPlusCommand(vtkSmartPointer<vtkPlusGetUsParameterCommand>::New());
   RegisterPlusCommand(vtkSmartPointer<vtkPlusAddRecordingDeviceCommand>::New());
+  RegisterPlusCommand(vtkSmartPointer<vtkPlusLatencyTraceCommand>::New());
+  RegisterPlusCommand(vtkSmartPointer<vtkPlusGetSendQueueStatusCommand>::New());
 #ifdef PLUS_USE_STEALTHLINK
   RegisterPlusCommand(vtkSmartPointer<vtkPlusStealthLinkCommand>::New());
 #endif
@@ -175,6 +179,7 @@ int vtkPlusCommandProcessor::ExecuteCommands()
       PlusLockGuard<vtkPlusRecursiveCriticalSection> updateMutexGuardedLock(this->Mutex);
       cmd->PopCommandResponses(this->CommandResponseQueue);
     }
+    this->WakeUpResponseSender();
 
     numberOfExecutedCommands++;
   }
@@ -304,8 +309,11 @@ PlusStatus vtkPlusCommandProcessor::QueueStringResponse(PlusStatus status, const
   response->SetStatus(status);
 
   // Add response to the command response queue
-  PlusLockGuard<vtkPlusRecursiveCriticalSection> updateMutexGuardedLock(this->Mutex);
-  this->CommandResponseQueue.push_back(response);
+  {
+    PlusLockGuard<vtkPlusRecursiveCriticalSection> updateMutexGuardedLock(this->Mutex);
+    this->CommandResponseQueue.push_back(response);
+  }
+  this->WakeUpResponseSender();
 
   return PLUS_SUCCESS;
 }
@@ -322,8 +330,11 @@ PlusStatus vtkPlusCommandProcessor::QueueCommandResponse(PlusStatus status, cons
   response->SetStatus(status);
 
   // Add response to the command response queue
-  PlusLockGuard<vtkPlusRecursiveCriticalSection> updateMutexGuardedLock(this->Mutex);
-  this->CommandResponseQueue.push_back(response);
+  {
+    PlusLockGuard<vtkPlusRecursiveCriticalSection> updateMutexGuardedLock(this->Mutex);
+    this->CommandResponseQueue.push_back(response);
+  }
+  this->WakeUpResponseSender();
 
   return PLUS_SUCCESS;
 }
@@ -363,6 +374,15 @@ PlusStatus vtkPlusCommandProcessor::QueueGetImage(unsigned int clientId, const s
   return PLUS_SUCCESS;
 }
 
+//------------------------------------------------------------------------------
+void vtkPlusCommandProcessor::WakeUpResponseSender()
+{
+  if (this->PlusServer != NULL)
+  {
+    this->PlusServer->WakeUpDataSender();
+  }
+}
+
 //------------------------------------------------------------------------------
 void vtkPlusCommandProcessor::PopCommandResponses(PlusCommandResponseList& responses)
 {
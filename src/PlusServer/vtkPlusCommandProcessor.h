@@ -97,6 +97,9 @@ protected:
   /*! Thread for client connection handling */
   static void* CommandExecutionThread(vtkMultiThreader::ThreadInfo* data);
 
+  /*! Wake up the data sender thread of the server, so that the queued responses are sent without delay */
+  void WakeUpResponseSender();
+
   vtkPlusCommandProcessor();
   virtual ~vtkPlusCommandProcessor();
 
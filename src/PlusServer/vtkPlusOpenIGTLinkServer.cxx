@@ -6,6 +6,7 @@ See License.txt for details.
 
 // Local includes
 #include "PlusConfigure.h"
+#include "PlusLatencyTracer.h"
 #include "PlusTrackedFrame.h"
 #include "vtkPlusChannel.h"
 #include "vtkPlusCommand.h"
@@ -31,6 +32,7 @@ See License.txt for details.
 #include <igtlImageMetaMessage.h>
 #include <igtlMessageHeader.h>
 #include <igtlPlusClientInfoMessage.h>
+#include <igtlPlusImageMessage.h>
 #include <igtlStatusMessage.h>
 #include <igtlStringMessage.h>
 #include <igtlPolyDataMessage.h>
@@ -39,6 +41,9 @@ See License.txt for details.
 // OpenIGTLinkIO includes
 #include <igtlioPolyDataConverter.h>
 
+// STL includes
+#include <chrono>
+
 #if defined(WIN32)
   #include "vtkPlusOpenIGTLinkServerWin32.cxx"
 #elif defined(__APPLE__)
@@ -48,9 +53,17 @@ See License.txt for details.
 #endif
 
 static const double DELAY_ON_SENDING_ERROR_SEC = 0.02;
+// Polling period for new frames if the broadcast channel has no buffer that signals new data
 static const double DELAY_ON_NO_NEW_FRAMES_SEC = 0.005;
+// Maximum time to wait for new frames if the data sender thread is woken up when new data arrives or a
+// response is queued (see WakeUpDataSender). It only has to be short compared to the keep-alive interval.
+static const double MAX_WAIT_FOR_NEW_FRAMES_SEC = 0.1;
 static const int NUMBER_OF_RECENT_COMMAND_IDS_STORED = 10;
 static const int IGTL_EMPTY_DATA_SIZE = -1;
+// Client sender threads wake up periodically to check if they are requested to stop
+static const int CLIENT_SENDER_WAKEUP_PERIOD_MS = 100;
+// Minimum time between warnings about dropped messages of a client
+static const double DROPPED_MESSAGES_REPORT_PERIOD_SEC = 5.0;
 
 const float vtkPlusOpenIGTLinkServer::CLIENT_SOCKET_TIMEOUT_SEC = 0.5;
 
@@ -76,6 +89,8 @@ vtkPlusOpenIGTLinkServer::vtkPlusOpenIGTLinkServer()
   , NumberOfRetryAttempts(10)
   , DelayBetweenRetryAttemptsSec(0.05)
   , MaxNumberOfIgtlMessagesToSend(100)
+  , MaxClientSendQueueSize(50)
+  , ClientSendQueueDropPolicy(SEND_QUEUE_DROP_OLDEST_IMAGE)
   , ConnectionActive(std::make_pair(false, false))
   , DataSenderActive(std::make_pair(false, false))
   , ConnectionReceiverThreadId(-1)
@@ -83,15 +98,22 @@ vtkPlusOpenIGTLinkServer::vtkPlusOpenIGTLinkServer()
   , IgtlMessageFactory(vtkSmartPointer<vtkPlusIgtlMessageFactory>::New())
   , IgtlClientsMutex(vtkSmartPointer<vtkPlusRecursiveCriticalSection>::New())
   , LastSentTrackedFrameTimestamp(0)
+  , LastNotifiedDataTimestamp(UNDEFINED_TIMESTAMP)
   , MaxTimeSpentWithProcessingMs(50)
   , LastProcessingTimePerFrameMs(-1)
   , SendValidTransformsOnly(true)
+  , ZeroCopyImageSend(false)
+  , EnableLatencyTracing(false)
+  , LatencyTraceLogIntervalSec(10.0)
   , DefaultClientSendTimeoutSec(CLIENT_SOCKET_TIMEOUT_SEC)
   , DefaultClientReceiveTimeoutSec(CLIENT_SOCKET_TIMEOUT_SEC)
   , IgtlMessageCrcCheckEnabled(0)
   , PlusCommandProcessor(vtkSmartPointer<vtkPlusCommandProcessor>::New())
   , MessageResponseQueueMutex(vtkSmartPointer<vtkPlusRecursiveCriticalSection>::New())
   , BroadcastChannel(NULL)
+  , DataSenderWakeUpCount(0)
+  , LastDataSenderWakeUpCount(0)
+  , BroadcastChannelInterruptCount(0)
   , LogWarningOnNoDataAvailable(true)
   , KeepAliveIntervalSec(CLIENT_SOCKET_TIMEOUT_SEC / 2.0)
   , GracePeriodLogLevel(vtkPlusLogger::LOG_LEVEL_DEBUG)
@@ -132,8 +154,11 @@ PlusStatus vtkPlusOpenIGTLinkServer::QueueMessageResponseForClient(int clientId,
     return PLUS_FAIL;
   }
 
-  PlusLockGuard<vtkPlusRecursiveCriticalSection> mutexGuardedLock(this->MessageResponseQueueMutex);
-  this->MessageResponseQueue[clientId].push_back(message);
+  {
+    PlusLockGuard<vtkPlusRecursiveCriticalSection> mutexGuardedLock(this->MessageResponseQueueMutex);
+    this->MessageResponseQueue[clientId].push_back(message);
+  }
+  this->WakeUpDataSender();
 
   return PLUS_SUCCESS;
 }
@@ -142,6 +167,20 @@ PlusStatus vtkPlusOpenIGTLinkServer::QueueMessageResponseForClient(int clientId,
 void vtkPlusOpenIGTLinkServer::PrintSelf(ostream& os, vtkIndent indent)
 {
   this->Superclass::PrintSelf(os, indent);
+
+  os << indent << "MaxClientSendQueueSize: " << this->MaxClientSendQueueSize << std::endl;
+  os << indent << "ClientSendQueueDropPolicy: " << (this->ClientSendQueueDropPolicy == SEND_QUEUE_KEEP_LATEST_ONLY ? "KEEP_LATEST_ONLY" : "DROP_OLDEST_IMAGE") << std::endl;
+  os << indent << "ZeroCopyImageSend: " << (this->ZeroCopyImageSend ? "TRUE" : "FALSE") << std::endl;
+  os << indent << "EnableLatencyTracing: " << (this->EnableLatencyTracing ? "TRUE" : "FALSE") << std::endl;
+  os << indent << "LatencyTraceLogIntervalSec: " << this->LatencyTraceLogIntervalSec << std::endl;
+
+  PlusLockGuard<vtkPlusRecursiveCriticalSection> igtlClientsMutexGuardedLock(this->IgtlClientsMutex);
+  for (std::list<ClientData>::iterator clientIterator = this->IgtlClients.begin(); clientIterator != this->IgtlClients.end(); ++clientIterator)
+  {
+    std::lock_guard<std::mutex> sendQueueLock(clientIterator->SendQueue->Mutex);
+    os << indent << "Client " << clientIterator->ClientId << ": send queue depth: " << clientIterator->SendQueue->Messages.size()
+       << ", dropped messages: " << clientIterator->SendQueue->NumberOfDroppedMessages << std::endl;
+  }
 }
 
 //----------------------------------------------------------------------------
@@ -153,6 +192,14 @@ PlusStatus vtkPlusOpenIGTLinkServer::StartOpenIGTLinkService()
     return PLUS_FAIL;
   }
 
+  this->IgtlMessageFactory->SetZeroCopyImageMessages(this->ZeroCopyImageSend);
+
+  if (this->EnableLatencyTracing)
+  {
+    PlusLatencyTracer::GetInstance()->SetLogIntervalSec(this->LatencyTraceLogIntervalSec);
+    PlusLatencyTracer::GetInstance()->SetEnabled(true);
+  }
+
   if (this->ConnectionReceiverThreadId < 0)
   {
     this->ConnectionActive.first = true;
@@ -177,6 +224,18 @@ PlusStatus vtkPlusOpenIGTLinkServer::StartOpenIGTLinkService()
   return PLUS_SUCCESS;
 }
 
+//----------------------------------------------------------------------------
+void vtkPlusOpenIGTLinkServer::WakeUpDataSender()
+{
+  std::lock_guard<std::mutex> wakeUpLock(this->DataSenderWakeUpMutex);
+  this->DataSenderWakeUpCount++;
+  this->DataSenderWakeUpCondition.notify_all();
+  if (this->BroadcastChannel != NULL)
+  {
+    this->BroadcastChannel->InterruptWaitForNewData();
+  }
+}
+
 //----------------------------------------------------------------------------
 PlusStatus vtkPlusOpenIGTLinkServer::StopOpenIGTLinkService()
 {
@@ -184,6 +243,8 @@ PlusStatus vtkPlusOpenIGTLinkServer::StopOpenIGTLinkService()
   if (this->ConnectionReceiverThreadId >= 0)
   {
     this->ConnectionActive.first = false;
+    // The data sender thread stops too, wake it up so that it does not wait for new data
+    this->WakeUpDataSender();
     while (this->ConnectionActive.second)
     {
       // Wait until the thread stops
@@ -258,6 +319,9 @@ void* vtkPlusOpenIGTLinkServer::ConnectionReceiverThread(vtkMultiThreader::Threa
 
       client->DataReceiverActive.first = true;
       client->DataReceiverThreadId = self->Threader->SpawnThread((vtkThreadFunctionType)&DataReceiverThread, client);
+
+      client->ClientSenderActive.first = true;
+      client->ClientSenderThreadId = self->Threader->SpawnThread((vtkThreadFunctionType)&ClientSenderThread, client);
     }
   }
 
@@ -327,7 +391,12 @@ void* vtkPlusOpenIGTLinkServer::DataSenderThread(vtkMultiThreader::ThreadInfo* d
     LOG_WARNING("There are no channels to broadcast. Only command processing is available.");
   }
 
-  self->BroadcastChannel = aChannel;
+  {
+    std::lock_guard<std::mutex> wakeUpLock(self->DataSenderWakeUpMutex);
+    self->BroadcastChannel = aChannel;
+    // Interrupts that happened before this thread started must not end its first wait
+    self->BroadcastChannelInterruptCount = (aChannel != NULL ? aChannel->GetWaitForNewDataInterruptCount() : 0);
+  }
   if (self->BroadcastChannel)
   {
     self->BroadcastChannel->GetMostRecentTimestamp(self->LastSentTrackedFrameTimestamp);
@@ -357,6 +426,8 @@ void* vtkPlusOpenIGTLinkServer::DataSenderThread(vtkMultiThreader::ThreadInfo* d
       self->GracePeriodLogLevel = vtkPlusLogger::LOG_LEVEL_WARNING;
     }
 
+    self->DisconnectFailedClients();
+
     SendMessageResponses(*self);
 
     // Send remote command execution replies to clients before sending any images/transforms/etc...
@@ -418,7 +489,18 @@ PlusStatus vtkPlusOpenIGTLinkServer::SendLatestFramesToClients(vtkPlusOpenIGTLin
   // There is no new frame in the buffer
   if (trackedFrameList->GetNumberOfTrackedFrames() == 0)
   {
-    vtkPlusAccurateTimer::Delay(DELAY_ON_NO_NEW_FRAMES_SEC);
+    if (self.BroadcastChannel != NULL)
+    {
+      const double waitTimeoutSec = (self.BroadcastChannel->GetNewDataNotifyingSource() != NULL ? MAX_WAIT_FOR_NEW_FRAMES_SEC : DELAY_ON_NO_NEW_FRAMES_SEC);
+      self.BroadcastChannel->WaitForNewData(self.LastNotifiedDataTimestamp, waitTimeoutSec, &self.BroadcastChannelInterruptCount);
+    }
+    else
+    {
+      std::unique_lock<std::mutex> wakeUpLock(self.DataSenderWakeUpMutex);
+      self.DataSenderWakeUpCondition.wait_for(wakeUpLock, std::chrono::duration<double>(MAX_WAIT_FOR_NEW_FRAMES_SEC),
+                                              [&self] { return self.DataSenderWakeUpCount != self.LastDataSenderWakeUpCount; });
+      self.LastDataSenderWakeUpCount = self.DataSenderWakeUpCount;
+    }
     elapsedTimeSinceLastPacketSentSec += vtkPlusAccurateTimer::GetSystemTime() - startTimeSec;
 
     // Send keep alive packet to clients
@@ -459,17 +541,15 @@ PlusStatus vtkPlusOpenIGTLinkServer::SendMessageResponses(vtkPlusOpenIGTLinkServ
     for (ClientIdToMessageListMap::iterator it = self.MessageResponseQueue.begin(); it != self.MessageResponseQueue.end(); ++it)
     {
       PlusLockGuard<vtkPlusRecursiveCriticalSection> igtlClientsMutexGuardedLock(self.IgtlClientsMutex);
-      igtl::ClientSocket::Pointer clientSocket = NULL;
-
-      for (std::list<ClientData>::iterator clientIterator = self.IgtlClients.begin(); clientIterator != self.IgtlClients.end(); ++clientIterator)
+      std::list<ClientData>::iterator clientIterator = self.IgtlClients.begin();
+      for (; clientIterator != self.IgtlClients.end(); ++clientIterator)
       {
         if (clientIterator->ClientId == it->first)
         {
-          clientSocket = clientIterator->ClientSocket;
           break;
         }
       }
-      if (clientSocket.IsNull())
+      if (clientIterator == self.IgtlClients.end())
       {
         LOG_WARNING("Message reply cannot be sent to client " << it->first << ", probably client has been disconnected.");
         continue;
@@ -477,7 +557,7 @@ PlusStatus vtkPlusOpenIGTLinkServer::SendMessageResponses(vtkPlusOpenIGTLinkServ
 
       for (std::vector<igtl::MessageBase::Pointer>::iterator messageIt = it->second.begin(); messageIt != it->second.end(); ++messageIt)
       {
-        clientSocket->Send((*messageIt)->GetBufferPointer(), (*messageIt)->GetBufferSize());
+        self.QueueMessageForClient(*clientIterator, *messageIt);
       }
     }
     self.MessageResponseQueue.clear();
@@ -506,22 +586,21 @@ PlusStatus vtkPlusOpenIGTLinkServer::SendCommandResponses(vtkPlusOpenIGTLinkServ
       // Only send the response to the client that requested the command
       LOG_DEBUG("Send command reply to client " << (*responseIt)->GetClientId() << ": " << igtlResponseMessage->GetDeviceName());
       PlusLockGuard<vtkPlusRecursiveCriticalSection> igtlClientsMutexGuardedLock(self.IgtlClientsMutex);
-      igtl::ClientSocket::Pointer clientSocket = NULL;
-      for (std::list<ClientData>::iterator clientIterator = self.IgtlClients.begin(); clientIterator != self.IgtlClients.end(); ++clientIterator)
+      std::list<ClientData>::iterator clientIterator = self.IgtlClients.begin();
+      for (; clientIterator != self.IgtlClients.end(); ++clientIterator)
       {
         if (clientIterator->ClientId == (*responseIt)->GetClientId())
         {
-          clientSocket = clientIterator->ClientSocket;
           break;
         }
       }
 
-      if (clientSocket.IsNull())
+      if (clientIterator == self.IgtlClients.end())
       {
         LOG_WARNING("Message reply cannot be sent to client " << (*responseIt)->GetClientId() << ", probably client has been disconnected");
         continue;
       }
-      clientSocket->Send(igtlResponseMessage->GetBufferPointer(), igtlResponseMessage->GetBufferSize());
+      self.QueueMessageForClient(*clientIterator, igtlResponseMessage);
     }
   }
 
@@ -597,10 +676,11 @@ void* vtkPlusOpenIGTLinkServer::DataReceiverThread(vtkMultiThreader::ThreadInfo*
       // Just ping server, we can skip message and respond
       clientSocket->Skip(headerMsg->GetBodySizeToRead(), 0);
 
+      PlusLockGuard<vtkPlusRecursiveCriticalSection> igtlClientsMutexGuardedLock(self->IgtlClientsMutex);
       igtl::StatusMessage::Pointer replyMsg = dynamic_cast<igtl::StatusMessage*>(self->IgtlMessageFactory->CreateSendMessage("STATUS", client->ClientInfo.GetClientHeaderVersion()).GetPointer());
       replyMsg->SetCode(igtl::StatusMessage::STATUS_OK);
       replyMsg->Pack();
-      clientSocket->Send(replyMsg->GetBufferPointer(), replyMsg->GetBufferSize());
+      self->QueueMessageForClient(*client, replyMsg.GetPointer());
     }
     else if (typeid(*bodyMessage) == typeid(igtl::StringMessage)
              && vtkPlusCommand::IsCommandDeviceName(headerMsg->GetDeviceName()))
@@ -876,54 +956,62 @@ PlusStatus vtkPlusOpenIGTLinkServer::SendTrackedFrame(PlusTrackedFrame& trackedF
   double timestampUniversal = vtkPlusAccurateTimer::GetUniversalTimeFromSystemTime(timestampSystem);
   trackedFrame.SetTimestamp(timestampUniversal);
 
-  std::vector<int> disconnectedClientIds;
+  // The broadcast latency is recorded by the sender thread of each client, when the messages of the frame are sent
+  const double latencyTraceAcquisitionTime = PlusLatencyTracer::IsEnabled() ? trackedFrame.GetLatencyTraceTimestamp(PlusLatencyTracer::STAGE_ACQUIRED) : 0.0;
+
   {
+    // Messages that are already packed for a client subscription. Clients with the same subscription
+    // receive the same messages, so each message is packed (and its CRC computed) only once and the
+    // reference counted message is sent to all the clients in the group.
+    std::vector<PackedMessageGroup> packedMessageGroups;
+
     // Lock before we send message to the clients
     PlusLockGuard<vtkPlusRecursiveCriticalSection> igtlClientsMutexGuardedLock(this->IgtlClientsMutex);
     for (std::list<ClientData>::iterator clientIterator = this->IgtlClients.begin(); clientIterator != this->IgtlClients.end(); ++clientIterator)
     {
-      igtl::ClientSocket::Pointer clientSocket = (*clientIterator).ClientSocket;
-
       // Create IGT messages
       std::vector<igtl::MessageBase::Pointer> igtlMessages;
-      std::vector<igtl::MessageBase::Pointer>::iterator igtlMessageIterator;
 
-      if (this->IgtlMessageFactory->PackMessages(clientIterator->ClientId, clientIterator->ClientInfo, igtlMessages, trackedFrame, this->SendValidTransformsOnly, this->TransformRepository) != PLUS_SUCCESS)
+      // Video encoders are stored per client, therefore encoded image streams cannot be shared between clients
+      bool shareableSubscription = !clientIterator->ClientInfo.HasEncodedImageStream();
+      std::vector<PackedMessageGroup>::iterator groupIterator = packedMessageGroups.end();
+      if (shareableSubscription)
       {
-        LOG_WARNING("Failed to pack all IGT messages");
+        for (groupIterator = packedMessageGroups.begin(); groupIterator != packedMessageGroups.end(); ++groupIterator)
+        {
+          if (groupIterator->ClientInfo.HasSameSubscription(clientIterator->ClientInfo))
+          {
+            break;
+          }
+        }
       }
 
-      // Send all messages to a client
-      for (igtlMessageIterator = igtlMessages.begin(); igtlMessageIterator != igtlMessages.end(); ++igtlMessageIterator)
+      if (groupIterator != packedMessageGroups.end())
+      {
+        igtlMessages = groupIterator->IgtlMessages;
+      }
+      else
       {
-        igtl::MessageBase::Pointer igtlMessage = (*igtlMessageIterator);
-        if (igtlMessage.IsNull())
+        if (this->IgtlMessageFactory->PackMessages(clientIterator->ClientId, clientIterator->ClientInfo, igtlMessages, trackedFrame, this->SendValidTransformsOnly, this->TransformRepository) != PLUS_SUCCESS)
         {
-          continue;
+          LOG_WARNING("Failed to pack all IGT messages");
         }
-
-        int retValue = 0;
-        RETRY_UNTIL_TRUE((retValue = clientSocket->Send(igtlMessage->GetBufferPointer(), igtlMessage->GetBufferSize())) != 0, this->NumberOfRetryAttempts, this->DelayBetweenRetryAttemptsSec);
-        if (retValue == 0)
+        if (shareableSubscription)
         {
-          disconnectedClientIds.push_back(clientIterator->ClientId);
-          igtl::TimeStamp::Pointer ts = igtl::TimeStamp::New();
-          igtlMessage->GetTimeStamp(ts);
-          LOG_INFO("Client disconnected - could not send " << igtlMessage->GetMessageType() << " message to client (device name: " << igtlMessage->GetDeviceName()
-                   << "  Timestamp: " << std::fixed << ts->GetTimeStamp() << ").");
-          break;
+          // Store a copy of the client info, as the client's info is updated when the messages are sent
+          PackedMessageGroup group;
+          group.ClientInfo = clientIterator->ClientInfo;
+          group.IgtlMessages = igtlMessages;
+          packedMessageGroups.push_back(group);
         }
-
-        // Update the TDATA timestamp, even if TDATA isn't sent (cheaper than checking for existing TDATA message type)
-        clientIterator->ClientInfo.SetLastTDATASentTimeStamp(trackedFrame.GetTimestamp());
       }
-    }
-  }
 
-  // Clean up disconnected clients
-  for (std::vector< int >::iterator it = disconnectedClientIds.begin(); it != disconnectedClientIds.end(); ++it)
-  {
-    DisconnectClient(*it);
+      // Queue all messages for the client, they are sent by the client's sender thread
+      this->QueueFrameMessagesForClient(*clientIterator, igtlMessages, latencyTraceAcquisitionTime);
+
+      // Update the TDATA timestamp, even if TDATA isn't sent (cheaper than checking for existing TDATA message type)
+      clientIterator->ClientInfo.SetLastTDATASentTimeStamp(trackedFrame.GetTimestamp());
+    }
   }
 
   // restore original timestamp
@@ -935,7 +1023,7 @@ PlusStatus vtkPlusOpenIGTLinkServer::SendTrackedFrame(PlusTrackedFrame& trackedF
 //----------------------------------------------------------------------------
 void vtkPlusOpenIGTLinkServer::DisconnectClient(int clientId)
 {
-  // Stop the client's data receiver thread
+  // Stop the client's data receiver and sender threads
   {
     // Request thread stop
     PlusLockGuard<vtkPlusRecursiveCriticalSection> igtlClientsMutexGuardedLock(this->IgtlClientsMutex);
@@ -946,17 +1034,22 @@ void vtkPlusOpenIGTLinkServer::DisconnectClient(int clientId)
         continue;
       }
       clientIterator->DataReceiverActive.first = false;
+      {
+        std::lock_guard<std::mutex> sendQueueLock(clientIterator->SendQueue->Mutex);
+        clientIterator->ClientSenderActive.first = false;
+      }
+      clientIterator->SendQueue->MessageQueued.notify_all();
       break;
     }
   }
 
-  // Wait for the thread to stop
-  bool clientDataReceiverThreadStillActive = false;
+  // Wait for the threads to stop
+  bool clientThreadStillActive = false;
   do
   {
-    clientDataReceiverThreadStillActive = false;
+    clientThreadStillActive = false;
     {
-      // check if any of the receiver threads are still active
+      // check if any of the client threads are still active
       PlusLockGuard<vtkPlusRecursiveCriticalSection> igtlClientsMutexGuardedLock(this->IgtlClientsMutex);
       for (std::list<ClientData>::iterator clientIterator = this->IgtlClients.begin(); clientIterator != this->IgtlClients.end(); ++clientIterator)
       {
@@ -969,24 +1062,37 @@ void vtkPlusOpenIGTLinkServer::DisconnectClient(int clientId)
           if (clientIterator->DataReceiverActive.second)
           {
             // thread still running
-            clientDataReceiverThreadStillActive = true;
+            clientThreadStillActive = true;
           }
           else
           {
             // thread stopped
             clientIterator->DataReceiverThreadId = -1;
           }
-          break;
         }
+        if (clientIterator->ClientSenderThreadId > 0)
+        {
+          if (clientIterator->ClientSenderActive.second)
+          {
+            // thread still running
+            clientThreadStillActive = true;
+          }
+          else
+          {
+            // thread stopped
+            clientIterator->ClientSenderThreadId = -1;
+          }
+        }
+        break;
       }
     }
-    if (clientDataReceiverThreadStillActive)
+    if (clientThreadStillActive)
     {
       // give some time for the threads to finish
       vtkPlusAccurateTimer::DelayWithEventProcessing(0.2);
     }
   }
-  while (clientDataReceiverThreadStillActive);
+  while (clientThreadStillActive);
 
   // Close socket and remove client from the list
   int port = 0;
@@ -1023,33 +1129,261 @@ void vtkPlusOpenIGTLinkServer::KeepAlive()
 {
   LOG_TRACE("Keep alive packet sent to clients...");
 
-  std::vector< int > disconnectedClientIds;
+  // The same packed message can be queued for all clients
+  igtl::StatusMessage::Pointer replyMsg = igtl::StatusMessage::New();
+  replyMsg->SetCode(igtl::StatusMessage::STATUS_OK);
+  replyMsg->Pack();
 
+  PlusLockGuard<vtkPlusRecursiveCriticalSection> igtlClientsMutexGuardedLock(this->IgtlClientsMutex);
+  for (std::list<ClientData>::iterator clientIterator = this->IgtlClients.begin(); clientIterator != this->IgtlClients.end(); ++clientIterator)
   {
-    // Lock before we send message to the clients
-    PlusLockGuard<vtkPlusRecursiveCriticalSection> igtlClientsMutexGuardedLock(this->IgtlClientsMutex);
+    this->QueueMessageForClient(*clientIterator, replyMsg.GetPointer());
+  }
+}
 
-    for (std::list<ClientData>::iterator clientIterator = this->IgtlClients.begin(); clientIterator != this->IgtlClients.end(); ++clientIterator)
+//----------------------------------------------------------------------------
+void* vtkPlusOpenIGTLinkServer::ClientSenderThread(vtkMultiThreader::ThreadInfo* data)
+{
+  ClientData* client = (ClientData*)(data->UserData);
+  client->ClientSenderActive.second = true;
+  vtkPlusOpenIGTLinkServer* self = client->Server;
+
+  // Make copy of frequently used data to avoid locking of client data
+  igtl::ClientSocket::Pointer clientSocket = client->ClientSocket;
+  std::shared_ptr<ClientSendQueue> sendQueue = client->SendQueue;
+  std::string latencyTraceSourceName = (self->BroadcastChannel != NULL && self->BroadcastChannel->GetChannelId() != NULL) ? self->BroadcastChannel->GetChannelId() : "";
+
+  while (client->ClientSenderActive.first)
+  {
+    ClientSendQueue::QueuedMessage queuedMessage;
+    if (!sendQueue->PopMessage(queuedMessage, CLIENT_SENDER_WAKEUP_PERIOD_MS))
     {
-      igtl::StatusMessage::Pointer replyMsg = igtl::StatusMessage::New();
-      replyMsg->SetCode(igtl::StatusMessage::STATUS_OK);
-      replyMsg->Pack();
+      continue;
+    }
+
+    // Send without holding any lock, so that new messages can be queued in the meantime
+    igtl::MessageBase::Pointer igtlMessage = queuedMessage.Message;
+    int retValue = 0;
+    igtl::PlusImageMessage* plusImageMessage = dynamic_cast<igtl::PlusImageMessage*>(igtlMessage.GetPointer());
+    if (plusImageMessage != NULL)
+    {
+      // Pixels are sent directly from the frame image
+      RETRY_UNTIL_TRUE((retValue = plusImageMessage->Send(clientSocket)) != 0, self->NumberOfRetryAttempts, self->DelayBetweenRetryAttemptsSec);
+    }
+    else
+    {
+      RETRY_UNTIL_TRUE((retValue = clientSocket->Send(igtlMessage->GetBufferPointer(), igtlMessage->GetBufferSize())) != 0, self->NumberOfRetryAttempts, self->DelayBetweenRetryAttemptsSec);
+    }
+    if (retValue == 0)
+    {
+      igtl::TimeStamp::Pointer ts = igtl::TimeStamp::New();
+      igtlMessage->GetTimeStamp(ts);
+      LOG_INFO("Client disconnected - could not send " << igtlMessage->GetMessageType() << " message to client (device name: " << igtlMessage->GetDeviceName()
+               << "  Timestamp: " << std::fixed << ts->GetTimeStamp() << ").");
+
+      // The client is removed by the data sender thread
+      sendQueue->SetSendFailed();
+      break;
+    }
+
+    if (queuedMessage.LatencyTraceAcquisitionTime > 0 && PlusLatencyTracer::IsEnabled())
+    {
+      // All the messages of the frame have been sent to this client
+      PlusLatencyTracer::GetInstance()->RecordLatency(PlusLatencyTracer::STAGE_BROADCAST, latencyTraceSourceName,
+          queuedMessage.LatencyTraceAcquisitionTime, vtkPlusAccurateTimer::GetSystemTime());
+    }
+  }
+
+  // Close thread
+  client->ClientSenderActive.second = false;
+  return NULL;
+}
 
-      int retValue = 0;
-      RETRY_UNTIL_TRUE(
-        (retValue = clientIterator->ClientSocket->Send(replyMsg->GetPackPointer(), replyMsg->GetPackSize())) != 0,
-        this->NumberOfRetryAttempts, this->DelayBetweenRetryAttemptsSec);
-      if (retValue == 0)
+//----------------------------------------------------------------------------
+bool ClientSendQueue::PushMessage(igtl::MessageBase::Pointer message)
+{
+  if (message.IsNull())
+  {
+    return false;
+  }
+
+  {
+    std::lock_guard<std::mutex> sendQueueLock(this->Mutex);
+    if (this->SendFailed)
+    {
+      return false;
+    }
+    QueuedMessage queuedMessage;
+    queuedMessage.Message = message;
+    queuedMessage.FrameData = false;
+    queuedMessage.ImageData = false;
+    queuedMessage.LatencyTraceAcquisitionTime = 0.0;
+    this->Messages.push_back(queuedMessage);
+  }
+  this->MessageQueued.notify_one();
+  return true;
+}
+
+//----------------------------------------------------------------------------
+unsigned long ClientSendQueue::PushFrameMessages(const std::vector<igtl::MessageBase::Pointer>& messages, int maxNumberOfFrameMessages, bool keepLatestFrameOnly,
+    double latencyTraceAcquisitionTime)
+{
+  unsigned long numberOfDroppedMessages = 0;
+  {
+    std::lock_guard<std::mutex> sendQueueLock(this->Mutex);
+    if (this->SendFailed)
+    {
+      return 0;
+    }
+
+    if (keepLatestFrameOnly)
+    {
+      // Remove all frame data that has not been sent yet, only the new frame will be sent
+      for (std::deque<QueuedMessage>::iterator it = this->Messages.begin(); it != this->Messages.end();)
       {
-        disconnectedClientIds.push_back(clientIterator->ClientId);
-        igtl::TimeStamp::Pointer ts = igtl::TimeStamp::New();
-        replyMsg->GetTimeStamp(ts);
+        if (it->FrameData)
+        {
+          it = this->Messages.erase(it);
+          this->NumberOfQueuedFrameMessages--;
+          numberOfDroppedMessages++;
+        }
+        else
+        {
+          ++it;
+        }
+      }
+    }
+
+    bool frameMessageQueued = false;
+    for (std::vector<igtl::MessageBase::Pointer>::const_iterator messageIt = messages.begin(); messageIt != messages.end(); ++messageIt)
+    {
+      if (messageIt->IsNull())
+      {
+        continue;
+      }
+      QueuedMessage queuedMessage;
+      queuedMessage.Message = *messageIt;
+      queuedMessage.FrameData = true;
+      std::string messageType = (*messageIt)->GetMessageType();
+      queuedMessage.ImageData = (messageType == "IMAGE" || messageType == "VIDEO" || messageType == "TRACKEDFRAME" || messageType == "USMESSAGE");
+      queuedMessage.LatencyTraceAcquisitionTime = 0.0;
+      this->Messages.push_back(queuedMessage);
+      this->NumberOfQueuedFrameMessages++;
+      frameMessageQueued = true;
+    }
+    if (frameMessageQueued)
+    {
+      // The frame is broadcast to this client when its last message is sent
+      this->Messages.back().LatencyTraceAcquisitionTime = latencyTraceAcquisitionTime;
+    }
+
+    // Enforce the queue size limit by dropping the oldest image messages (or the oldest frame data if there are no images)
+    while (maxNumberOfFrameMessages > 0 && this->NumberOfQueuedFrameMessages > static_cast<unsigned int>(maxNumberOfFrameMessages))
+    {
+      std::deque<QueuedMessage>::iterator messageToDrop = this->Messages.end();
+      for (std::deque<QueuedMessage>::iterator it = this->Messages.begin(); it != this->Messages.end(); ++it)
+      {
+        if (it->ImageData)
+        {
+          messageToDrop = it;
+          break;
+        }
+        if (it->FrameData && messageToDrop == this->Messages.end())
+        {
+          messageToDrop = it;
+        }
+      }
+      if (messageToDrop == this->Messages.end())
+      {
+        break;
+      }
+      this->Messages.erase(messageToDrop);
+      this->NumberOfQueuedFrameMessages--;
+      numberOfDroppedMessages++;
+    }
+    this->NumberOfDroppedMessages += numberOfDroppedMessages;
+  }
+  this->MessageQueued.notify_one();
+  return numberOfDroppedMessages;
+}
+
+//----------------------------------------------------------------------------
+bool ClientSendQueue::PopMessage(QueuedMessage& message, int timeoutMs)
+{
+  std::unique_lock<std::mutex> sendQueueLock(this->Mutex);
+  if (this->Messages.empty())
+  {
+    this->MessageQueued.wait_for(sendQueueLock, std::chrono::milliseconds(timeoutMs));
+    if (this->Messages.empty())
+    {
+      return false;
+    }
+  }
+  message = this->Messages.front();
+  this->Messages.pop_front();
+  if (message.FrameData)
+  {
+    this->NumberOfQueuedFrameMessages--;
+  }
+  return true;
+}
+
+//----------------------------------------------------------------------------
+void ClientSendQueue::SetSendFailed()
+{
+  std::lock_guard<std::mutex> sendQueueLock(this->Mutex);
+  this->SendFailed = true;
+  this->Messages.clear();
+  this->NumberOfQueuedFrameMessages = 0;
+}
+
+//----------------------------------------------------------------------------
+void vtkPlusOpenIGTLinkServer::QueueMessageForClient(ClientData& client, igtl::MessageBase::Pointer message)
+{
+  client.SendQueue->PushMessage(message);
+}
 
-        LOG_DEBUG("Client disconnected - could not send " << replyMsg->GetMessageType() << " message to client (device name: " << replyMsg->GetDeviceName()
-                  << "  Timestamp: " << std::fixed <<  ts->GetTimeStamp() << ").");
+//----------------------------------------------------------------------------
+void vtkPlusOpenIGTLinkServer::QueueFrameMessagesForClient(ClientData& client, const std::vector<igtl::MessageBase::Pointer>& messages, double latencyTraceAcquisitionTime)
+{
+  ClientSendQueue& sendQueue = *client.SendQueue;
+  unsigned long numberOfDroppedMessages = sendQueue.PushFrameMessages(messages, this->MaxClientSendQueueSize, this->ClientSendQueueDropPolicy == SEND_QUEUE_KEEP_LATEST_ONLY,
+                                          latencyTraceAcquisitionTime);
+  if (numberOfDroppedMessages > 0)
+  {
+    // Only the data sender thread queues frame messages, so LastDropReportTime does not need locking
+    double currentTime = vtkPlusAccurateTimer::GetSystemTime();
+    if (currentTime - sendQueue.LastDropReportTime > DROPPED_MESSAGES_REPORT_PERIOD_SEC)
+    {
+      unsigned int queueDepth = 0;
+      unsigned long totalNumberOfDroppedMessages = 0;
+      {
+        std::lock_guard<std::mutex> sendQueueLock(sendQueue.Mutex);
+        queueDepth = sendQueue.Messages.size();
+        totalNumberOfDroppedMessages = sendQueue.NumberOfDroppedMessages;
       }
-    } // clientIterator
-  } // unlock client list
+      LOG_WARNING("Client " << client.ClientId << " cannot keep up with the data stream. Send queue depth: " << queueDepth
+                  << ", dropped messages since connection: " << totalNumberOfDroppedMessages);
+      sendQueue.LastDropReportTime = currentTime;
+    }
+  }
+}
+
+//----------------------------------------------------------------------------
+void vtkPlusOpenIGTLinkServer::DisconnectFailedClients()
+{
+  std::vector< int > disconnectedClientIds;
+  {
+    PlusLockGuard<vtkPlusRecursiveCriticalSection> igtlClientsMutexGuardedLock(this->IgtlClientsMutex);
+    for (std::list<ClientData>::iterator clientIterator = this->IgtlClients.begin(); clientIterator != this->IgtlClients.end(); ++clientIterator)
+    {
+      std::lock_guard<std::mutex> sendQueueLock(clientIterator->SendQueue->Mutex);
+      if (clientIterator->SendQueue->SendFailed)
+      {
+        disconnectedClientIds.push_back(clientIterator->ClientId);
+      }
+    }
+  }
 
   // Clean up disconnected clients
   for (std::vector< int >::iterator it = disconnectedClientIds.begin(); it != disconnectedClientIds.end(); ++it)
@@ -1082,6 +1416,24 @@ PlusStatus vtkPlusOpenIGTLinkServer::GetClientInfo(unsigned int clientId, PlusIg
   return PLUS_FAIL;
 }
 
+//------------------------------------------------------------------------------
+PlusStatus vtkPlusOpenIGTLinkServer::GetClientSendQueueStatus(unsigned int clientId, unsigned int& queueDepth, unsigned long& numberOfDroppedMessages) const
+{
+  PlusLockGuard<vtkPlusRecursiveCriticalSection> igtlClientsMutexGuardedLock(this->IgtlClientsMutex);
+  for (std::list<ClientData>::const_iterator it = this->IgtlClients.begin(); it != this->IgtlClients.end(); ++it)
+  {
+    if (it->ClientId == clientId)
+    {
+      std::lock_guard<std::mutex> sendQueueLock(it->SendQueue->Mutex);
+      queueDepth = it->SendQueue->Messages.size();
+      numberOfDroppedMessages = it->SendQueue->NumberOfDroppedMessages;
+      return PLUS_SUCCESS;
+    }
+  }
+
+  return PLUS_FAIL;
+}
+
 //------------------------------------------------------------------------------
 PlusStatus vtkPlusOpenIGTLinkServer::ReadConfiguration(vtkXMLDataElement* serverElement, const std::string& aFilename)
 {
@@ -1105,6 +1457,9 @@ PlusStatus vtkPlusOpenIGTLinkServer::ReadConfiguration(vtkXMLDataElement* server
   XML_READ_BOOL_ATTRIBUTE_OPTIONAL(SendValidTransformsOnly, serverElement);
   XML_READ_BOOL_ATTRIBUTE_OPTIONAL(IgtlMessageCrcCheckEnabled, serverElement);
   XML_READ_BOOL_ATTRIBUTE_OPTIONAL(LogWarningOnNoDataAvailable, serverElement);
+  XML_READ_BOOL_ATTRIBUTE_OPTIONAL(ZeroCopyImageSend, serverElement);
+  XML_READ_BOOL_ATTRIBUTE_OPTIONAL(EnableLatencyTracing, serverElement);
+  XML_READ_SCALAR_ATTRIBUTE_OPTIONAL(double, LatencyTraceLogIntervalSec, serverElement);
 
   this->DefaultClientInfo.IgtlMessageTypes.clear();
   this->DefaultClientInfo.TransformNames.clear();
@@ -1125,6 +1480,11 @@ PlusStatus vtkPlusOpenIGTLinkServer::ReadConfiguration(vtkXMLDataElement* server
   XML_READ_SCALAR_ATTRIBUTE_OPTIONAL(float, DefaultClientSendTimeoutSec, serverElement);
   XML_READ_SCALAR_ATTRIBUTE_OPTIONAL(float, DefaultClientReceiveTimeoutSec, serverElement);
 
+  XML_READ_SCALAR_ATTRIBUTE_OPTIONAL(int, MaxClientSendQueueSize, serverElement);
+  XML_READ_ENUM2_ATTRIBUTE_OPTIONAL(ClientSendQueueDropPolicy, serverElement,
+                                    "DROP_OLDEST_IMAGE", SEND_QUEUE_DROP_OLDEST_IMAGE,
+                                    "KEEP_LATEST_ONLY", SEND_QUEUE_KEEP_LATEST_ONLY);
+
   return PLUS_SUCCESS;
 }
 
@@ -20,7 +20,11 @@
 #include <vtkSmartPointer.h>
 
 // STL includes
+#include <condition_variable>
 #include <deque>
+#include <memory>
+#include <mutex>
+#include <vector>
 
 // OS includes
 #if (_MSC_VER == 1500)
@@ -40,6 +44,63 @@ class vtkPlusCommandResponse;
 class vtkPlusRecursiveCriticalSection;
 class vtkPlusTransformRepository;
 
+/// Outgoing messages of a client. The messages are sent by the client's own sender thread,
+/// so that a slow client does not delay sending data to the other clients.
+struct vtkPlusServerExport ClientSendQueue
+{
+  ClientSendQueue()
+    : NumberOfQueuedFrameMessages(0)
+    , NumberOfDroppedMessages(0)
+    , LastDropReportTime(0.0)
+    , SendFailed(false)
+  {
+  }
+
+  struct QueuedMessage
+  {
+    igtl::MessageBase::Pointer Message;
+    /// Tracked frame data may be dropped if the client cannot keep up, responses and keep-alive messages are never dropped
+    bool FrameData;
+    /// IMAGE, VIDEO, ... messages that carry image data
+    bool ImageData;
+    /// System time when the frame was acquired, set for the last message of a traced frame (see PlusLatencyTracer), 0 otherwise
+    double LatencyTraceAcquisitionTime;
+  };
+
+  /// Add a response or keep-alive message, these messages are never dropped.
+  /// Returns false if the message is not queued because sending to the client failed.
+  bool PushMessage(igtl::MessageBase::Pointer message);
+
+  /// Add the messages of a tracked frame. If keepLatestFrameOnly is set then all queued frame data is dropped first.
+  /// Then, while more than maxNumberOfFrameMessages frame data messages are queued (0 means no limit), the oldest image message
+  /// is dropped (or the oldest frame data message if there are no image messages).
+  /// If latencyTraceAcquisitionTime is positive then the broadcast latency of the frame is recorded when its last message is sent.
+  /// Returns the number of dropped messages.
+  unsigned long PushFrameMessages(const std::vector<igtl::MessageBase::Pointer>& messages, int maxNumberOfFrameMessages, bool keepLatestFrameOnly,
+                                  double latencyTraceAcquisitionTime = 0.0);
+
+  /// Remove the oldest message from the queue. If the queue is empty then wait at most timeoutMs for a new message.
+  /// Returns false if there is no message.
+  bool PopMessage(QueuedMessage& message, int timeoutMs);
+
+  /// Discard all queued messages and prevent queuing new ones, called when a message could not be sent to the client
+  void SetSendFailed();
+
+  std::mutex Mutex;
+  /// Signaled when a message is queued or the sender thread is requested to stop
+  std::condition_variable MessageQueued;
+  std::deque<QueuedMessage> Messages;
+
+  /// Number of tracked frame data messages in the queue, only these count towards the queue size limit
+  unsigned int NumberOfQueuedFrameMessages;
+  /// Number of tracked frame data messages dropped since the client connected
+  unsigned long NumberOfDroppedMessages;
+  double LastDropReportTime;
+
+  /// Set by the sender thread if a message could not be sent to the client
+  bool SendFailed;
+};
+
 struct ClientData
 {
   ClientData()
@@ -47,6 +108,9 @@ struct ClientData
     , ClientSocket(NULL)
     , DataReceiverActive(std::make_pair(false, false))
     , DataReceiverThreadId(-1)
+    , ClientSenderActive(std::make_pair(false, false))
+    , ClientSenderThreadId(-1)
+    , SendQueue(std::make_shared<ClientSendQueue>())
     , Server(NULL)
   {
   }
@@ -65,6 +129,13 @@ struct ClientData
   std::pair<bool, bool> DataReceiverActive;
   int DataReceiverThreadId;
 
+  /// Active flag for the thread that sends the queued messages (first: request, second: respond )
+  std::pair<bool, bool> ClientSenderActive;
+  int ClientSenderThreadId;
+
+  /// Outgoing messages, shared so that the client data remains copyable
+  std::shared_ptr<ClientSendQueue> SendQueue;
+
   PlusIgtlClientInfo ClientInfo;
 
   vtkPlusOpenIGTLinkServer* Server;
@@ -83,6 +154,12 @@ struct ClientData
   requested image and tracking information in the same format as in the DefaultClientInfo element in the device set
   configuration file.
 
+  Messages are not sent directly to the clients but put in a per-client send queue, which is processed by a dedicated
+  sender thread for each client. If a client cannot keep up with the data stream then at most MaxClientSendQueueSize
+  tracked frame messages are kept in its queue and the rest is dropped according to ClientSendQueueDropPolicy
+  (DROP_OLDEST_IMAGE or KEEP_LATEST_ONLY). A client can query its queue depth and number of dropped messages
+  with the GetSendQueueStatus command.
+
   \ingroup PlusLibPlusServer
 */
 class vtkPlusServerExport vtkPlusOpenIGTLinkServer: public vtkObject
@@ -90,6 +167,13 @@ class vtkPlusServerExport vtkPlusOpenIGTLinkServer: public vtkObject
   typedef std::map<int, std::vector<igtl::MessageBase::Pointer> > ClientIdToMessageListMap;
 
 public:
+  /*! Policy applied when the send queue of a slow client is full */
+  enum SendQueueDropPolicyType
+  {
+    SEND_QUEUE_DROP_OLDEST_IMAGE, /*!< Drop the oldest queued image message (or the oldest frame data message if there are no images) */
+    SEND_QUEUE_KEEP_LATEST_ONLY   /*!< Drop all queued frame data when a new frame is queued, only the latest frame is sent */
+  };
+
   static vtkPlusOpenIGTLinkServer* New();
   vtkTypeMacro(vtkPlusOpenIGTLinkServer, vtkObject);
   virtual void PrintSelf(ostream& os, vtkIndent indent) VTK_OVERRIDE;
@@ -120,12 +204,32 @@ public:
   vtkSetMacro(SendValidTransformsOnly, bool);
   vtkGetMacroConst(SendValidTransformsOnly, bool);
 
+  /*! If enabled then the pixels of IMAGE messages are sent directly from the frame images, without copying them into the message buffer. Applied when the service is started. */
+  vtkSetMacro(ZeroCopyImageSend, bool);
+  vtkGetMacroConst(ZeroCopyImageSend, bool);
+
+  /*! If enabled then per-frame latency tracing (see PlusLatencyTracer) is enabled when the service is started. */
+  vtkSetMacro(EnableLatencyTracing, bool);
+  vtkGetMacroConst(EnableLatencyTracing, bool);
+
+  /*! Time between logging the latency statistics while latency tracing is enabled. Applied when the service is started. */
+  vtkSetMacro(LatencyTraceLogIntervalSec, double);
+  vtkGetMacroConst(LatencyTraceLogIntervalSec, double);
+
   vtkSetMacro(DefaultClientSendTimeoutSec, float);
   vtkGetMacroConst(DefaultClientSendTimeoutSec, float);
 
   vtkSetMacro(DefaultClientReceiveTimeoutSec, float);
   vtkGetMacroConst(DefaultClientReceiveTimeoutSec, float);
 
+  /*! Maximum number of tracked frame data messages that are queued for sending to a client */
+  vtkSetMacro(MaxClientSendQueueSize, int);
+  vtkGetMacroConst(MaxClientSendQueueSize, int);
+
+  /*! Policy to apply when a client cannot keep up with the data and its send queue is full */
+  vtkSetMacro(ClientSendQueueDropPolicy, SendQueueDropPolicyType);
+  vtkGetMacroConst(ClientSendQueueDropPolicy, SendQueueDropPolicyType);
+
   /*! Set data collector instance */
   vtkSetMacro(DataCollector, vtkPlusDataCollector*);
   vtkGetMacroConst(DataCollector, vtkPlusDataCollector*);
@@ -142,6 +246,9 @@ public:
     */
   virtual PlusStatus GetClientInfo(unsigned int clientId, PlusIgtlClientInfo& outClientInfo) const;
 
+  /*! Get the number of messages waiting in the send queue of a client and the number of messages dropped because the client could not keep up */
+  virtual PlusStatus GetClientSendQueueStatus(unsigned int clientId, unsigned int& queueDepth, unsigned long& numberOfDroppedMessages) const;
+
   /*! Start server */
   PlusStatus StartOpenIGTLinkService();
 
@@ -159,6 +266,20 @@ public:
   */
   int ProcessPendingCommands();
 
+  /*!
+    Wake up the data sender thread if it is waiting for new data, so that queued responses are sent immediately.
+    Can be called from any thread.
+  */
+  void WakeUpDataSender();
+
+protected:
+  /*! Messages packed for a client subscription, they can be sent to all clients with the same subscription */
+  struct PackedMessageGroup
+  {
+    PlusIgtlClientInfo ClientInfo;
+    std::vector<igtl::MessageBase::Pointer> IgtlMessages;
+  };
+
 protected:
   vtkPlusOpenIGTLinkServer();
   virtual ~vtkPlusOpenIGTLinkServer();
@@ -184,6 +305,21 @@ protected:
   /*! Thread for receiving control data from clients */
   static void* DataReceiverThread(vtkMultiThreader::ThreadInfo* data);
 
+  /*! Thread for sending the queued messages to a client */
+  static void* ClientSenderThread(vtkMultiThreader::ThreadInfo* data);
+
+  /*! Add a response or keep-alive message to the send queue of a client. These messages are never dropped. */
+  void QueueMessageForClient(ClientData& client, igtl::MessageBase::Pointer message);
+
+  /*!
+    Add the messages of a tracked frame to the send queue of a client, drop queued frame data according to the drop policy if the queue is full.
+    If latencyTraceAcquisitionTime is positive then the broadcast latency is recorded when the client's sender thread has sent the frame.
+  */
+  void QueueFrameMessagesForClient(ClientData& client, const std::vector<igtl::MessageBase::Pointer>& messages, double latencyTraceAcquisitionTime);
+
+  /*! Disconnect the clients whose sender thread failed to send a message */
+  void DisconnectFailedClients();
+
   /*! Tracked frame interface, sends the selected message type and data to all clients */
   virtual PlusStatus SendTrackedFrame(PlusTrackedFrame& trackedFrame);
 
@@ -193,7 +329,7 @@ protected:
   /*! Send status message to clients to keep alive the connection */
   virtual void KeepAlive();
 
-  /*! Stops client's data receiving thread, closes the socket, and removes the client from the client list */
+  /*! Stops client's data receiving and sending threads, closes the socket, and removes the client from the client list */
   void DisconnectClient(int clientId);
 
   /*! Set IGTL CRC check flag (0: disabled, 1: enabled) */
@@ -253,6 +389,12 @@ private:
   /*! Maximum number of IGTL messages to send in one period */
   int MaxNumberOfIgtlMessagesToSend;
 
+  /*! Maximum number of tracked frame data messages in the send queue of a client */
+  int MaxClientSendQueueSize;
+
+  /*! Policy to apply when the send queue of a client is full */
+  SendQueueDropPolicyType ClientSendQueueDropPolicy;
+
   // Active flag for threads (first: request, second: respond )
   std::pair<bool, bool> ConnectionActive;
   std::pair<bool, bool> DataSenderActive;
@@ -273,6 +415,9 @@ private:
   /*! Last sent tracked frame timestamp */
   double LastSentTrackedFrameTimestamp;
 
+  /*! Timestamp of the newest broadcast channel item that the data sender thread has been notified about */
+  double LastNotifiedDataTimestamp;
+
   /*! Maximum time spent with processing (getting tracked frames, sending messages) per second (in milliseconds) */
   int MaxTimeSpentWithProcessingMs;
 
@@ -282,6 +427,15 @@ private:
   /*! Whether or not the server should send invalid transforms through the IGT Link */
   bool SendValidTransformsOnly;
 
+  /*! Whether or not the pixels of IMAGE messages are sent directly from the frame images (see igtl::PlusImageMessage) */
+  bool ZeroCopyImageSend;
+
+  /*! Whether or not per-frame latency tracing is enabled when the service is started */
+  bool EnableLatencyTracing;
+
+  /*! Time between logging the latency statistics (in seconds) */
+  double LatencyTraceLogIntervalSec;
+
   /*!
   Default IGT client info used for sending data to clients.
   Used only if the client didn't set IGT message types and transform/image/string names.
@@ -306,9 +460,20 @@ private:
   /*! Channel ID to request the data from */
   std::string OutputChannelId;
 
-  /*! Channel to use for broadcasting */
+  /*! Channel to use for broadcasting, set while DataSenderWakeUpMutex is locked */
   vtkPlusChannel* BroadcastChannel;
 
+  /*! Used for waking up the data sender thread, see WakeUpDataSender */
+  std::mutex DataSenderWakeUpMutex;
+  /*! Signaled by WakeUpDataSender, the data sender thread waits on it if there is no broadcast channel */
+  std::condition_variable DataSenderWakeUpCondition;
+  /*! Number of WakeUpDataSender calls, protected by DataSenderWakeUpMutex */
+  unsigned long DataSenderWakeUpCount;
+  /*! DataSenderWakeUpCount value that the data sender thread has already handled */
+  unsigned long LastDataSenderWakeUpCount;
+  /*! Interrupt counter of the broadcast channel (see vtkPlusChannel::WaitForNewData), used by the data sender thread */
+  unsigned long BroadcastChannelInterruptCount;
+
   bool LogWarningOnNoDataAvailable;
 
   double KeepAliveIntervalSec;
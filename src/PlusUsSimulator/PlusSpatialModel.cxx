@@ -18,7 +18,9 @@ See License.txt for details.
 #include "vtkProbeFilter.h"
 #include "vtkPointData.h"
 #include "vtkIdList.h"
-#include "vtkTriangle.h"
+#include "vtkVersion.h"
+
+#include <mutex>
 
 // If fraction of the transmitted beam intensity is smaller then this value then we consider the beam to be completely absorbed
 const double MINIMUM_BEAM_INTENSITY = 1e-9;
@@ -26,6 +28,20 @@ const double MINIMUM_BEAM_INTENSITY = 1e-9;
 // Characterizes the specular reflection BRDF. If the value is smaller then reflection is limited to a smaller angle range (closer to 90deg incidence angle).
 double SPECULAR_REFLECTION_BRDF_STDEV = 30.0;
 
+#if VTK_MAJOR_VERSION < 9 || (VTK_MAJOR_VERSION == 9 && VTK_MINOR_VERSION < 2)
+// Line intersection of vtkModifiedBSPTree uses an internal cell object in this VTK version, so concurrent queries are serialized.
+// Model localizers are shared between copies of a model, therefore a single lock is used for all of them.
+static std::mutex ModelLocalizerMutex;
+#endif
+
+//-----------------------------------------------------------------------------
+PlusSpatialModel::LineIntersectionBuffers::LineIntersectionBuffers()
+  : IntersectionPoints_Model(vtkSmartPointer<vtkPoints>::New())
+  , IntersectionCellIds(vtkSmartPointer<vtkIdList>::New())
+  , Cell(vtkSmartPointer<vtkGenericCell>::New())
+{
+}
+
 //-----------------------------------------------------------------------------
 PlusSpatialModel::PlusSpatialModel()
   : Name("")
@@ -253,9 +269,8 @@ void PlusSpatialModel::CalculateIntensity(std::vector<double>& reflectedIntensit
   }
 
   // Compute attenuation within this model
-  double intensityAttenuationCoefficientdBPerPixel = this->AttenuationCoefficientDbPerCmMhz * (distanceBetweenScanlineSamplePointsMm / 10.0) * this->ImagingFrequencyMhz;
   // intensityAttenuationCoefficientPerPixel: should be close to 1, as it's the ratio of (transmitted beam intensity / incident beam intensity) after traversing through a single pixel
-  double intensityAttenuationCoefficientPerPixel = pow(10.0, -intensityAttenuationCoefficientdBPerPixel / 10.0);
+  double intensityAttenuationCoefficientPerPixel = GetIntensityAttenuationCoefficientPerPixel(distanceBetweenScanlineSamplePointsMm);
   // intensityAttenuatedFractionPerPixel: how big fraction of the intensity is attenuated during traversing through one voxel
   double intensityAttenuatedFractionPerPixel = (1 - intensityAttenuationCoefficientPerPixel);
   // intensityTransmittedFractionPerPixelTwoWay: how big fraction of the intensity is transmitted during traversing through one voxel; takes into account both propagation directions
@@ -313,8 +328,48 @@ void PlusSpatialModel::CalculateIntensity(std::vector<double>& reflectedIntensit
   // TODO: to simulate beamwidth, take into account the incidence angle and disperse the reflection on a larger area if the angle is large
 }
 
+//-----------------------------------------------------------------------------
+double PlusSpatialModel::GetIntensityAttenuationCoefficientPerPixel(double distanceBetweenScanlineSamplePointsMm)
+{
+  double intensityAttenuationCoefficientdBPerPixel = this->AttenuationCoefficientDbPerCmMhz * (distanceBetweenScanlineSamplePointsMm / 10.0) * this->ImagingFrequencyMhz;
+  return pow(10.0, -intensityAttenuationCoefficientdBPerPixel / 10.0);
+}
+
+//-----------------------------------------------------------------------------
+PlusStatus PlusSpatialModel::PrepareForSimulation(double distanceBetweenScanlineSamplePointsMm, unsigned int numberOfSamplesPerScanline)
+{
+  if (UpdateModelFile() != PLUS_SUCCESS)
+  {
+    return PLUS_FAIL;
+  }
+
+  if (this->PolyData != NULL)
+  {
+    // Cells are built on first access, which must not happen concurrently
+    this->PolyData->BuildCells();
+  }
+
+  // Attenuations for the longest possible segment, so that CalculateIntensity does not need to update them
+  double intensityAttenuationCoefficientPerPixel = GetIntensityAttenuationCoefficientPerPixel(distanceBetweenScanlineSamplePointsMm);
+  double intensityTransmittedFractionPerPixelTwoWay = intensityAttenuationCoefficientPerPixel * intensityAttenuationCoefficientPerPixel;
+  if (numberOfSamplesPerScanline > 0
+      && (this->PrecomputedAttenuations.size() < numberOfSamplesPerScanline || intensityTransmittedFractionPerPixelTwoWay != this->PrecomputedAttenuations[0]))
+  {
+    UpdatePrecomputedAttenuations(intensityTransmittedFractionPerPixelTwoWay, numberOfSamplesPerScanline);
+  }
+
+  return PLUS_SUCCESS;
+}
+
 //-----------------------------------------------------------------------------
 void PlusSpatialModel::GetLineIntersections(std::deque<LineIntersectionInfo>& lineIntersections, double* scanLineStartPoint_Reference, double* scanLineEndPoint_Reference)
+{
+  LineIntersectionBuffers buffers;
+  GetLineIntersections(lineIntersections, scanLineStartPoint_Reference, scanLineEndPoint_Reference, buffers);
+}
+
+//-----------------------------------------------------------------------------
+void PlusSpatialModel::GetLineIntersections(std::deque<LineIntersectionInfo>& lineIntersections, double* scanLineStartPoint_Reference, double* scanLineEndPoint_Reference, LineIntersectionBuffers& buffers)
 {
   UpdateModelFile();
 
@@ -355,9 +410,18 @@ void PlusSpatialModel::GetLineIntersections(std::deque<LineIntersectionInfo>& li
   referenceToModelMatrix->MultiplyPoint(searchLineStartPoint_Reference, searchLineStartPoint_Model);
   referenceToModelMatrix->MultiplyPoint(scanLineEndPoint_Reference, scanLineEndPoint_Model);
 
-  vtkSmartPointer<vtkPoints> intersectionPoints_Model = vtkSmartPointer<vtkPoints>::New();
-  vtkSmartPointer<vtkIdList> intersectionCellIds = vtkSmartPointer<vtkIdList>::New();
-  this->ModelLocalizer->IntersectWithLine(searchLineStartPoint_Model, scanLineEndPoint_Model, 0.0, intersectionPoints_Model, intersectionCellIds);
+  vtkPoints* intersectionPoints_Model = buffers.IntersectionPoints_Model;
+  vtkIdList* intersectionCellIds = buffers.IntersectionCellIds;
+  intersectionPoints_Model->Reset();
+  intersectionCellIds->Reset();
+#if VTK_MAJOR_VERSION < 9 || (VTK_MAJOR_VERSION == 9 && VTK_MINOR_VERSION < 2)
+  {
+    std::lock_guard<std::mutex> localizerLock(ModelLocalizerMutex);
+    this->ModelLocalizer->IntersectWithLine(searchLineStartPoint_Model, scanLineEndPoint_Model, 0.0, intersectionPoints_Model, intersectionCellIds);
+  }
+#else
+  this->ModelLocalizer->IntersectWithLine(searchLineStartPoint_Model, scanLineEndPoint_Model, 0.0, intersectionPoints_Model, intersectionCellIds, buffers.Cell);
+#endif
 
   if (intersectionPoints_Model->GetNumberOfPoints() < 1)
   {
@@ -416,8 +480,10 @@ void PlusSpatialModel::GetLineIntersections(std::deque<LineIntersectionInfo>& li
     intersectionPoints_Model->GetPoint(intersectionPointIndex, intersectionPoint_Model);
     modelToReferenceMatrix->MultiplyPoint(intersectionPoint_Model, intersectionPoint_Reference);
     intersectionInfo.IntersectionDistanceFromStartPointMm = sqrt(vtkMath::Distance2BetweenPoints(scanLineStartPoint_Reference, intersectionPoint_Reference));
-    vtkTriangle* cell = vtkTriangle::SafeDownCast(this->PolyData->GetCell(intersectionCellIds->GetId(intersectionPointIndex)));
-    if (cell != NULL && normals_Model != NULL)
+    // vtkPolyData::GetCell(cellId) returns a shared cell object, the cell of the buffers is used instead to allow concurrent calls
+    vtkGenericCell* cell = buffers.Cell;
+    this->PolyData->GetCell(intersectionCellIds->GetId(intersectionPointIndex), cell);
+    if (cell->GetCellType() == VTK_TRIANGLE && normals_Model != NULL)
     {
       const int NUMBER_OF_POINTS_PER_CELL = 3; // triangle cell
       double pcoords[NUMBER_OF_POINTS_PER_CELL] = {0, 0, 0};
@@ -429,12 +495,9 @@ void PlusSpatialModel::GetLineIntersections(std::deque<LineIntersectionInfo>& li
       double interpolatedNormal_Model[3] = {0, 0, 0};
       for (int pointIndex = 0; pointIndex < NUMBER_OF_POINTS_PER_CELL; pointIndex++)
       {
-        double* normalAtCellCorner = normals_Model->GetTuple3(cell->GetPointId(pointIndex));
-        if (normalAtCellCorner == NULL)
-        {
-          LOG_ERROR("SpatialModel::GetLineIntersections error: invalid normal");
-          continue;
-        }
+        // GetTuple3 returns a pointer to a buffer shared between threads, so the tuple is copied instead
+        double normalAtCellCorner[3] = {0, 0, 0};
+        normals_Model->GetTuple(cell->GetPointId(pointIndex), normalAtCellCorner);
         interpolatedNormal_Model[0] += normalAtCellCorner[0] * weights[pointIndex];
         interpolatedNormal_Model[1] += normalAtCellCorner[1] * weights[pointIndex];
         interpolatedNormal_Model[2] += normalAtCellCorner[2] * weights[pointIndex];
@@ -11,6 +11,11 @@
 
 #include "vtkPlusUsSimulatorExport.h"
 
+#include "vtkGenericCell.h"
+#include "vtkIdList.h"
+#include "vtkPoints.h"
+#include "vtkSmartPointer.h"
+
 class vtkMatrix4x4;
 class vtkModifiedBSPTree;
 class vtkPolyData;
@@ -38,6 +43,18 @@ public:
     double IntersectionIncidenceAngleRad;
   };
 
+  /*!
+    Work buffers for GetLineIntersections. They are reused between calls to avoid reallocations.
+    Each thread that computes line intersections must use its own instance.
+  */
+  struct LineIntersectionBuffers
+  {
+    LineIntersectionBuffers();
+    vtkSmartPointer<vtkPoints> IntersectionPoints_Model;
+    vtkSmartPointer<vtkIdList> IntersectionCellIds;
+    vtkSmartPointer<vtkGenericCell> Cell;
+  };
+
   PlusSpatialModel();
   virtual ~PlusSpatialModel();
 
@@ -72,6 +89,16 @@ public:
   */
   void GetLineIntersections(std::deque<LineIntersectionInfo>& lineIntersections, double* scanLineStartPoint_Reference, double* scanLineEndPoint_Reference);
 
+  /*! Same as GetLineIntersections but uses the provided work buffers. May be called from multiple threads after PrepareForSimulation. */
+  void GetLineIntersections(std::deque<LineIntersectionInfo>& lineIntersections, double* scanLineStartPoint_Reference, double* scanLineEndPoint_Reference, LineIntersectionBuffers& buffers);
+
+  /*!
+    Load the model file, build the cell links of the surface mesh and precompute attenuation values for scanlines
+    with the given sampling. After this GetLineIntersections (with separate buffers) and CalculateIntensity do not modify
+    the model, so they can be called from multiple threads, until the imaging parameters or transforms are changed.
+  */
+  PlusStatus PrepareForSimulation(double distanceBetweenScanlineSamplePointsMm, unsigned int numberOfSamplesPerScanline);
+
   double GetAcousticImpedanceMegarayls();
 
   /*!
@@ -101,6 +128,9 @@ protected:
   PlusStatus UpdateModelFile();
   void UpdatePrecomputedAttenuations(double intensityTransmittedFractionPerPixelTwoWay, int numberOfElements);
 
+  /*! Ratio of (transmitted beam intensity / incident beam intensity) after traversing through a single pixel */
+  double GetIntensityAttenuationCoefficientPerPixel(double distanceBetweenScanlineSamplePointsMm);
+
 protected:
   //PlusStatus LoadModel(const std::string& absoluteImagePath);
 
@@ -11,6 +11,7 @@ See License.txt for details.
 #include "vtkCubeSource.h"
 #include "vtkImageData.h"
 #include "vtkMatrix4x4.h"
+#include "vtkMultiThreader.h"
 #include "vtkPointData.h"
 #include "vtkSTLWriter.h"
 #include "vtkPlusSequenceIO.h"
@@ -174,6 +175,7 @@ int main(int argc, char** argv)
   std::string intersectionFile;
   bool showResults = false;
   bool useCompression(true);
+  int numberOfThreads = -1;
 
   int verboseLevel = vtkPlusLogger::LOG_LEVEL_UNDEFINED;
 
@@ -188,6 +190,7 @@ int main(int argc, char** argv)
   args.AddArgument("--output-us-img-file", vtksys::CommandLineArguments::EQUAL_ARGUMENT, &outputUsImageFile, "File name of the generated output ultrasound image");
   args.AddArgument("--output-slice-model-file", vtksys::CommandLineArguments::EQUAL_ARGUMENT, &intersectionFile, "Name of STL output file containing the model of all the frames (optional)");
   args.AddArgument("--show-results", vtksys::CommandLineArguments::NO_ARGUMENT, &showResults, "Show the simulated image on the screen");
+  args.AddArgument("--number-of-threads", vtksys::CommandLineArguments::EQUAL_ARGUMENT, &numberOfThreads, "Number of threads used for simulating scanlines (optional, 0 = number of processors, default: as specified in the config file)");
 
   // Input arguments error checking
   if (!args.Parse())
@@ -259,6 +262,10 @@ int main(int argc, char** argv)
     LOG_ERROR("Failed to read US simulator configuration!");
     exit(EXIT_FAILURE);
   }
+  if (numberOfThreads >= 0)
+  {
+    usSimulator->SetNumberOfThreads(numberOfThreads);
+  }
   usSimulator->SetTransformRepository(transformRepository);
   PlusTransformName imageToReferenceTransformName(usSimulator->GetImageCoordinateFrame(), usSimulator->GetReferenceCoordinateFrame());
 
@@ -357,6 +364,8 @@ int main(int argc, char** argv)
   LOG_INFO(" Average computation time per frame (sec): " << meanTimeElapsedPerFrameSec) ;
   LOG_INFO(" Standard dev computation time per frame (sec): " << stdevTimeElapsedPerFrameSec) ;
   LOG_INFO(" Average fps:  " << 1 / meanTimeElapsedPerFrameSec) ;
+  int numberOfSimulatorThreads = (usSimulator->GetNumberOfThreads() > 0 ? usSimulator->GetNumberOfThreads() : vtkMultiThreader::GetGlobalDefaultNumberOfThreads());
+  LOG_INFO(" Simulated frames/sec using " << numberOfSimulatorThreads << " thread(s): " << 1 / meanTimeElapsedPerFrameSec) ;
 
   return EXIT_SUCCESS;
 }
@@ -30,6 +30,7 @@ See License.txt for details.
 
 #include "vtkPlusRfProcessor.h"
 #include "vtkPlusUsScanConvert.h"
+#include "vtkPlusWorkerPool.h"
 
 // For noise generation
 #include "vtkLineSource.h"
@@ -41,6 +42,37 @@ See License.txt for details.
 
 vtkStandardNewMacro(vtkPlusUsSimulatorAlgo);
 
+//-----------------------------------------------------------------------------
+struct vtkPlusUsSimulatorAlgo::ScanLineSimulationBuffers
+{
+  std::deque<PlusSpatialModel::LineIntersectionInfo> LineIntersectionsWithModels;
+  PlusSpatialModel::LineIntersectionBuffers LineIntersectionBuffers;
+  std::vector<double> Intensities;
+  vtkSmartPointer<vtkLineSource> NoiseSamplerLine_Reference;
+};
+
+namespace
+{
+  // Scanline start/end positions in the Reference coordinate system
+  struct ScanLineEndPoints
+  {
+    double StartPoint_Reference[4];
+    double EndPoint_Reference[4];
+  };
+
+  // Parameters shared by all the threads that simulate the scanlines of a frame
+  struct SimulateScanLinesThreadInfo
+  {
+    vtkPlusUsSimulatorAlgo* Simulator;
+    std::vector<ScanLineEndPoints>* ScanLines;
+    double DistanceBetweenScanlineSamplePointsMm;
+    vtkPerlinNoise* NoiseFunction;
+    unsigned char* ScanLinesPixelPointer;
+    int NumberOfSamplesPerScanline;
+    std::vector<PlusStatus> ThreadStatus;
+  };
+}
+
 //-----------------------------------------------------------------------------
 vtkPlusUsSimulatorAlgo::vtkPlusUsSimulatorAlgo()
   : TransformRepository(NULL)
@@ -69,6 +101,9 @@ vtkPlusUsSimulatorAlgo::vtkPlusUsSimulatorAlgo()
   this->NoisePhase[1] = 0;
   this->NoisePhase[2] = 0;
 
+  this->NumberOfThreads = 0;
+  this->WorkerPool = vtkPlusWorkerPool::New();
+
   // this->TransducerSpatialModel doesn't have to be initialized, as the default parameters of SpatialModel
   // are for soft tissue that should match the transducer material in acoustic impedance
 }
@@ -83,6 +118,11 @@ vtkPlusUsSimulatorAlgo::~vtkPlusUsSimulatorAlgo()
     this->RfProcessor->Delete();
     this->RfProcessor = NULL;
   }
+  if (this->WorkerPool != NULL)
+  {
+    this->WorkerPool->Delete();
+    this->WorkerPool = NULL;
+  }
   this->SetTransformRepository(NULL);
 }
 
@@ -100,6 +140,7 @@ int vtkPlusUsSimulatorAlgo::FillOutputPortInformation(int, vtkInformation* info)
   return 1;
 }
 
+//-----------------------------------------------------------------------------
 inline double fastPow(double a, double b)
 {
   union
@@ -134,9 +175,6 @@ int vtkPlusUsSimulatorAlgo::RequestData(vtkInformation* request, vtkInformationV
   scanLines->SetExtent(0, this->NumberOfSamplesPerScanline - 1, 0, this->NumberOfScanlines - 1, 0, 0);
   scanLines->AllocateScalars(VTK_UNSIGNED_CHAR, 1);
 
-  // Create BSPTree for fast scanline-model intersection computation
-  vtkSmartPointer<vtkPoints> scanLineIntersectionWithModel = vtkSmartPointer<vtkPoints>::New();
-
   vtkPlusUsScanConvert* scanConverter = this->RfProcessor->GetScanConverter();
   if (scanConverter == NULL)
   {
@@ -153,12 +191,9 @@ int vtkPlusUsSimulatorAlgo::RequestData(vtkInformation* request, vtkInformationV
   double distanceBetweenScanlineSamplePointsMm = scanConverter->GetDistanceBetweenScanlineSamplePointsMm();
 
   // Initialize noise generator
-  vtkSmartPointer<vtkLineSource> noiseSamplerLine_Reference = vtkSmartPointer<vtkLineSource>::New();
   vtkSmartPointer<vtkPerlinNoise> noiseFunction = vtkSmartPointer<vtkPerlinNoise>::New();
-  double samplePointPosition_Reference[3] = {0, 0, 0};
   if (this->NoiseAmplitude > 0)
   {
-    noiseSamplerLine_Reference->SetResolution(this->NumberOfSamplesPerScanline - 1);
     noiseFunction->SetAmplitude(this->NoiseAmplitude);
     noiseFunction->SetFrequency(this->NoiseFrequency);
     noiseFunction->SetPhase(this->NoisePhase);
@@ -186,16 +221,6 @@ int vtkPlusUsSimulatorAlgo::RequestData(vtkInformation* request, vtkInformationV
   vtkSmartPointer<vtkMatrix4x4> referenceToImageMatrix = vtkSmartPointer<vtkMatrix4x4>::New();
   vtkMatrix4x4::Invert(imageToReferenceMatrix, referenceToImageMatrix);
 
-  // Create a few variables outside the loop to avoid reallocations and to make the code easier to read
-  vtkPoints* samplePointPositions_Reference = 0;
-  // Create a buffer outside the for loop to allow reusing it
-  std::vector<double> intensities;
-  // scanline start/end positions in Image and Reference coordinate systems
-  double scanLineStartPoint_Image[4] = {0, 0, 0, 1};
-  double scanLineEndPoint_Image[4] = {0, 0, 0, 1};
-  double scanLineStartPoint_Reference[4] = {0, 0, 0, 1};
-  double scanLineEndPoint_Reference[4] = {0, 0, 0, 1};
-
   for (std::vector<PlusSpatialModel>::iterator spatialModelIt = this->SpatialModels.begin(); spatialModelIt != this->SpatialModels.end(); ++spatialModelIt)
   {
     vtkSmartPointer<vtkMatrix4x4> referenceToObjectMatrix = vtkSmartPointer<vtkMatrix4x4>::New();
@@ -210,118 +235,189 @@ int vtkPlusUsSimulatorAlgo::RequestData(vtkInformation* request, vtkInformationV
       }
     }
     spatialModelIt->SetReferenceToObjectTransform(referenceToObjectMatrix);
+    // Load the model and precompute everything that the scanline threads would otherwise compute on demand
+    if (spatialModelIt->PrepareForSimulation(distanceBetweenScanlineSamplePointsMm, this->NumberOfSamplesPerScanline) != PLUS_SUCCESS)
+    {
+      LOG_ERROR("Failed to prepare " << spatialModelIt->GetName() << " SpatialModel for simulation");
+      return 0;
+    }
   }
 
+  // Compute scanline start/end positions in the Reference coordinate system
+  std::vector<ScanLineEndPoints> scanLineEndPoints(this->NumberOfScanlines);
+  double scanLineStartPoint_Image[4] = {0, 0, 0, 1};
+  double scanLineEndPoint_Image[4] = {0, 0, 0, 1};
   for (int scanLineIndex = 0; scanLineIndex < this->NumberOfScanlines; scanLineIndex++)
   {
     scanConverter->GetScanLineEndPoints(scanLineIndex, scanLineStartPoint_Image, scanLineEndPoint_Image);
-    imageToReferenceMatrix->MultiplyPoint(scanLineStartPoint_Image, scanLineStartPoint_Reference);
-    imageToReferenceMatrix->MultiplyPoint(scanLineEndPoint_Image, scanLineEndPoint_Reference);
+    imageToReferenceMatrix->MultiplyPoint(scanLineStartPoint_Image, scanLineEndPoints[scanLineIndex].StartPoint_Reference);
+    imageToReferenceMatrix->MultiplyPoint(scanLineEndPoint_Image, scanLineEndPoints[scanLineIndex].EndPoint_Reference);
+  }
 
-    if (this->NoiseAmplitude > 0)
+  // Simulate the scanlines in parallel, each thread computes a contiguous range of scanlines
+  this->WorkerPool->SetNumberOfThreads(this->NumberOfThreads);
+  SimulateScanLinesThreadInfo threadInfo;
+  threadInfo.Simulator = this;
+  threadInfo.ScanLines = &scanLineEndPoints;
+  threadInfo.DistanceBetweenScanlineSamplePointsMm = distanceBetweenScanlineSamplePointsMm;
+  threadInfo.NoiseFunction = noiseFunction;
+  threadInfo.ScanLinesPixelPointer = static_cast<unsigned char*>(scanLines->GetScalarPointer());
+  threadInfo.NumberOfSamplesPerScanline = this->NumberOfSamplesPerScanline;
+  threadInfo.ThreadStatus.assign(this->WorkerPool->GetNumberOfThreads(), PLUS_SUCCESS);
+  this->WorkerPool->SingleMethodExecute(&vtkPlusUsSimulatorAlgo::SimulateScanLinesThreadFunction, &threadInfo);
+  for (std::vector<PlusStatus>::iterator statusIt = threadInfo.ThreadStatus.begin(); statusIt != threadInfo.ThreadStatus.end(); ++statusIt)
+  {
+    if (*statusIt != PLUS_SUCCESS)
     {
-      noiseSamplerLine_Reference->SetPoint1(scanLineStartPoint_Reference);
-      noiseSamplerLine_Reference->SetPoint2(scanLineEndPoint_Reference);
-      noiseSamplerLine_Reference->Update();
-      samplePointPositions_Reference = noiseSamplerLine_Reference->GetOutput()->GetPoints();
+      return 0;
     }
+  }
 
-    // Get model intersection positions along the scanline for all the models
-    std::deque<PlusSpatialModel::LineIntersectionInfo> lineIntersectionsWithModels;
-    for (std::vector<PlusSpatialModel>::iterator spatialModelIt = this->SpatialModels.begin(); spatialModelIt != this->SpatialModels.end(); ++spatialModelIt)
-    {
-      // Append line intersections found with this model to lineIntersectionsWithModels
-      spatialModelIt->GetLineIntersections(lineIntersectionsWithModels, scanLineStartPoint_Reference, scanLineEndPoint_Reference);
-    }
+  vtkImageData* simulatedUsImage = vtkImageData::SafeDownCast(outInfo->Get(vtkDataObject::DATA_OBJECT()));
+  if (simulatedUsImage == NULL)
+  {
+    LOG_ERROR("vtkPlusUsSimulatorAlgo output type is invalid");
+    return 0;
+  }
+  this->RfProcessor->SetRfFrame(scanLines, US_IMG_BRIGHTNESS);
+  simulatedUsImage->DeepCopy(this->RfProcessor->GetBrightnessScanConvertedImage());
+  return 1;
+}
+
+//-----------------------------------------------------------------------------
+VTK_THREAD_RETURN_TYPE vtkPlusUsSimulatorAlgo::SimulateScanLinesThreadFunction(void* arg)
+{
+  vtkMultiThreader::ThreadInfo* info = static_cast<vtkMultiThreader::ThreadInfo*>(arg);
+  SimulateScanLinesThreadInfo* threadInfo = static_cast<SimulateScanLinesThreadInfo*>(info->UserData);
+  vtkPlusUsSimulatorAlgo* self = threadInfo->Simulator;
 
-    ConvertLineModelIntersectionsToSegmentDescriptor(lineIntersectionsWithModels);
+  int numberOfScanLines = static_cast<int>(threadInfo->ScanLines->size());
+  int firstScanLineIndex = numberOfScanLines * info->ThreadID / info->NumberOfThreads;
+  int lastScanLineIndex = numberOfScanLines * (info->ThreadID + 1) / info->NumberOfThreads; // exclusive
 
-    int currentPixelIndex = 0;
-    int scanLineExtent[6] = {0, this->NumberOfSamplesPerScanline - 1, scanLineIndex, scanLineIndex, 0, 0};
-    unsigned char* dstPixelAddress = (unsigned char*)scanLines->GetScalarPointerForExtent(scanLineExtent);
-    double incomingBeamIntensity = this->IncomingIntensityMwPerCm2 * 1000;
-    int numIntersectionPoints = lineIntersectionsWithModels.size();
-    if (numIntersectionPoints < 1)
+  ScanLineSimulationBuffers buffers;
+  if (self->NoiseAmplitude > 0)
+  {
+    buffers.NoiseSamplerLine_Reference = vtkSmartPointer<vtkLineSource>::New();
+    buffers.NoiseSamplerLine_Reference->SetResolution(threadInfo->NumberOfSamplesPerScanline - 1);
+  }
+
+  for (int scanLineIndex = firstScanLineIndex; scanLineIndex < lastScanLineIndex; scanLineIndex++)
+  {
+    ScanLineEndPoints& scanLine = (*threadInfo->ScanLines)[scanLineIndex];
+    unsigned char* dstPixelAddress = threadInfo->ScanLinesPixelPointer + static_cast<size_t>(scanLineIndex) * threadInfo->NumberOfSamplesPerScanline;
+    if (self->SimulateScanLine(scanLine.StartPoint_Reference, scanLine.EndPoint_Reference, threadInfo->DistanceBetweenScanlineSamplePointsMm,
+                               threadInfo->NoiseFunction, dstPixelAddress, buffers) != PLUS_SUCCESS)
     {
-      LOG_ERROR("No intersections with any SpatialObjects. Probably no background object is specified.");
-      return 0;
+      threadInfo->ThreadStatus[info->ThreadID] = PLUS_FAIL;
+      break;
     }
-    PlusSpatialModel* previousModel = &this->TransducerSpatialModel;
-    for (vtkIdType intersectionIndex = 0; (intersectionIndex <= numIntersectionPoints) && (currentPixelIndex < this->NumberOfSamplesPerScanline); intersectionIndex++)
+  }
+
+  return VTK_THREAD_RETURN_VALUE;
+}
+
+//-----------------------------------------------------------------------------
+PlusStatus vtkPlusUsSimulatorAlgo::SimulateScanLine(double* scanLineStartPoint_Reference, double* scanLineEndPoint_Reference, double distanceBetweenScanlineSamplePointsMm,
+    vtkPerlinNoise* noiseFunction, unsigned char* dstPixelAddress, ScanLineSimulationBuffers& buffers)
+{
+  vtkPoints* samplePointPositions_Reference = 0;
+  double samplePointPosition_Reference[3] = {0, 0, 0};
+  if (this->NoiseAmplitude > 0)
+  {
+    buffers.NoiseSamplerLine_Reference->SetPoint1(scanLineStartPoint_Reference);
+    buffers.NoiseSamplerLine_Reference->SetPoint2(scanLineEndPoint_Reference);
+    buffers.NoiseSamplerLine_Reference->Update();
+    samplePointPositions_Reference = buffers.NoiseSamplerLine_Reference->GetOutput()->GetPoints();
+  }
+
+  // Get model intersection positions along the scanline for all the models
+  std::deque<PlusSpatialModel::LineIntersectionInfo>& lineIntersectionsWithModels = buffers.LineIntersectionsWithModels;
+  lineIntersectionsWithModels.clear();
+  for (std::vector<PlusSpatialModel>::iterator spatialModelIt = this->SpatialModels.begin(); spatialModelIt != this->SpatialModels.end(); ++spatialModelIt)
+  {
+    // Append line intersections found with this model to lineIntersectionsWithModels
+    spatialModelIt->GetLineIntersections(lineIntersectionsWithModels, scanLineStartPoint_Reference, scanLineEndPoint_Reference, buffers.LineIntersectionBuffers);
+  }
+
+  ConvertLineModelIntersectionsToSegmentDescriptor(lineIntersectionsWithModels);
+
+  int currentPixelIndex = 0;
+  double incomingBeamIntensity = this->IncomingIntensityMwPerCm2 * 1000;
+  int numIntersectionPoints = lineIntersectionsWithModels.size();
+  if (numIntersectionPoints < 1)
+  {
+    LOG_ERROR("No intersections with any SpatialObjects. Probably no background object is specified.");
+    return PLUS_FAIL;
+  }
+  std::vector<double>& intensities = buffers.Intensities;
+  PlusSpatialModel* previousModel = &this->TransducerSpatialModel;
+  for (vtkIdType intersectionIndex = 0; (intersectionIndex <= numIntersectionPoints) && (currentPixelIndex < this->NumberOfSamplesPerScanline); intersectionIndex++)
+  {
+    // determine end of segment position and pixel color
+    int endOfSegmentPixelIndex = currentPixelIndex;
+    double distanceOfIntersectionPointFromScanLineStartPointMm = 0; // defined here to allow for access later on in code
+    if (intersectionIndex + 1 < numIntersectionPoints)
     {
-      // determine end of segment position and pixel color
-      int endOfSegmentPixelIndex = currentPixelIndex;
-      double distanceOfIntersectionPointFromScanLineStartPointMm = 0; // defined here to allow for access later on in code
-      if (intersectionIndex + 1 < numIntersectionPoints)
+      distanceOfIntersectionPointFromScanLineStartPointMm = lineIntersectionsWithModels[intersectionIndex + 1].IntersectionDistanceFromStartPointMm;
+      endOfSegmentPixelIndex = distanceOfIntersectionPointFromScanLineStartPointMm / distanceBetweenScanlineSamplePointsMm;
+      if (endOfSegmentPixelIndex > this->NumberOfSamplesPerScanline)
       {
-        distanceOfIntersectionPointFromScanLineStartPointMm = lineIntersectionsWithModels[intersectionIndex + 1].IntersectionDistanceFromStartPointMm;
-        endOfSegmentPixelIndex = distanceOfIntersectionPointFromScanLineStartPointMm / distanceBetweenScanlineSamplePointsMm;
-        if (endOfSegmentPixelIndex > this->NumberOfSamplesPerScanline)
-        {
-          // the next intersection point is out of the image
-          endOfSegmentPixelIndex = this->NumberOfSamplesPerScanline;
-        }
-      }
-      else
-      {
-        // last segment, after all the intersection points
+        // the next intersection point is out of the image
         endOfSegmentPixelIndex = this->NumberOfSamplesPerScanline;
       }
+    }
+    else
+    {
+      // last segment, after all the intersection points
+      endOfSegmentPixelIndex = this->NumberOfSamplesPerScanline;
+    }
 
-      int numberOfFilledPixels = endOfSegmentPixelIndex - currentPixelIndex;
-      if (numberOfFilledPixels < 1)
-      {
-        continue;
-      }
+    int numberOfFilledPixels = endOfSegmentPixelIndex - currentPixelIndex;
+    if (numberOfFilledPixels < 1)
+    {
+      continue;
+    }
 
-      PlusSpatialModel* currentModel = NULL;
-      if (intersectionIndex < numIntersectionPoints)
-      {
-        currentModel = lineIntersectionsWithModels[intersectionIndex].Model;
-      }
-      else
-      {
-        // the segment after the last intersection point is assumed to belong to the model of the last intersection
-        currentModel = lineIntersectionsWithModels[numIntersectionPoints - 1].Model;
-      }
+    PlusSpatialModel* currentModel = NULL;
+    if (intersectionIndex < numIntersectionPoints)
+    {
+      currentModel = lineIntersectionsWithModels[intersectionIndex].Model;
+    }
+    else
+    {
+      // the segment after the last intersection point is assumed to belong to the model of the last intersection
+      currentModel = lineIntersectionsWithModels[numIntersectionPoints - 1].Model;
+    }
 
-      double outgoingBeamIntensity = 0;
-      currentModel->CalculateIntensity(intensities, numberOfFilledPixels, distanceBetweenScanlineSamplePointsMm, previousModel->GetAcousticImpedanceMegarayls(), incomingBeamIntensity, outgoingBeamIntensity, lineIntersectionsWithModels[intersectionIndex].IntersectionIncidenceAngleRad);
-      previousModel = currentModel;
+    double outgoingBeamIntensity = 0;
+    currentModel->CalculateIntensity(intensities, numberOfFilledPixels, distanceBetweenScanlineSamplePointsMm, previousModel->GetAcousticImpedanceMegarayls(), incomingBeamIntensity, outgoingBeamIntensity, lineIntersectionsWithModels[intersectionIndex].IntersectionIncidenceAngleRad);
+    previousModel = currentModel;
 
-      if (this->NoiseAmplitude > 0)
+    if (this->NoiseAmplitude > 0)
+    {
+      for (int pixelIndex = 0; pixelIndex < numberOfFilledPixels; pixelIndex++)
       {
-        for (int pixelIndex = 0; pixelIndex < numberOfFilledPixels; pixelIndex++)
-        {
-          samplePointPositions_Reference->GetPoint(currentPixelIndex + pixelIndex, samplePointPosition_Reference);
-          double noise = noiseFunction->EvaluateFunction(samplePointPosition_Reference);
-          // Noise is multiplicative: NoisySignal = signal + noise * (signal-SignalMean) = signal*(1+noise) - noise*SignalMean;
-          (*dstPixelAddress++) = std::max(std::min(this->BrightnessConversionOffset + this->BrightnessConversionScale * fastPow(intensities[pixelIndex], this->BrightnessConversionGamma) + noise, 255.0), 0.0);
-        }
+        samplePointPositions_Reference->GetPoint(currentPixelIndex + pixelIndex, samplePointPosition_Reference);
+        double noise = noiseFunction->EvaluateFunction(samplePointPosition_Reference);
+        // Noise is multiplicative: NoisySignal = signal + noise * (signal-SignalMean) = signal*(1+noise) - noise*SignalMean;
+        (*dstPixelAddress++) = std::max(std::min(this->BrightnessConversionOffset + this->BrightnessConversionScale * fastPow(intensities[pixelIndex], this->BrightnessConversionGamma) + noise, 255.0), 0.0);
       }
-      else
+    }
+    else
+    {
+      for (int pixelIndex = 0; pixelIndex < numberOfFilledPixels; pixelIndex++)
       {
-        for (int pixelIndex = 0; pixelIndex < numberOfFilledPixels; pixelIndex++)
-        {
-          (*dstPixelAddress++) = std::max(std::min(this->BrightnessConversionOffset + this->BrightnessConversionScale * fastPow(intensities[pixelIndex], this->BrightnessConversionGamma), 255.0), 0.0);
-        }
+        (*dstPixelAddress++) = std::max(std::min(this->BrightnessConversionOffset + this->BrightnessConversionScale * fastPow(intensities[pixelIndex], this->BrightnessConversionGamma), 255.0), 0.0);
       }
+    }
 
-      incomingBeamIntensity = outgoingBeamIntensity;
+    incomingBeamIntensity = outgoingBeamIntensity;
 
-      currentPixelIndex += numberOfFilledPixels;
-    }
+    currentPixelIndex += numberOfFilledPixels;
   }
 
-  vtkImageData* simulatedUsImage = vtkImageData::SafeDownCast(outInfo->Get(vtkDataObject::DATA_OBJECT()));
-  if (simulatedUsImage == NULL)
-  {
-    LOG_ERROR("vtkPlusUsSimulatorAlgo output type is invalid");
-    return 0;
-  }
-  this->RfProcessor->SetRfFrame(scanLines, US_IMG_BRIGHTNESS);
-  simulatedUsImage->DeepCopy(this->RfProcessor->GetBrightnessScanConvertedImage());
-  return 1;
+  return PLUS_SUCCESS;
 }
 
 bool lineIntersectionLessThan(PlusSpatialModel::LineIntersectionInfo a, PlusSpatialModel::LineIntersectionInfo b)
@@ -405,6 +501,7 @@ PlusStatus vtkPlusUsSimulatorAlgo::ReadConfiguration(vtkXMLDataElement* config)
   XML_READ_SCALAR_ATTRIBUTE_OPTIONAL(double, NoiseAmplitude, usSimulatorAlgoElement);
   XML_READ_VECTOR_ATTRIBUTE_OPTIONAL(double, 3, NoiseFrequency, usSimulatorAlgoElement);
   XML_READ_VECTOR_ATTRIBUTE_OPTIONAL(double, 3, NoisePhase, usSimulatorAlgoElement);
+  XML_READ_SCALAR_ATTRIBUTE_OPTIONAL(int, NumberOfThreads, usSimulatorAlgoElement);
   XML_READ_CSTRING_ATTRIBUTE_REQUIRED(ImageCoordinateFrame, usSimulatorAlgoElement);
   XML_READ_CSTRING_ATTRIBUTE_REQUIRED(ReferenceCoordinateFrame, usSimulatorAlgoElement);
 
@@ -430,6 +527,31 @@ PlusStatus vtkPlusUsSimulatorAlgo::ReadConfiguration(vtkXMLDataElement* config)
   return PLUS_SUCCESS;
 }
 
+//-----------------------------------------------------------------------------
+PlusStatus vtkPlusUsSimulatorAlgo::WriteConfiguration(vtkXMLDataElement* config)
+{
+  LOG_TRACE("vtkPlusUsSimulatorAlgo::WriteConfiguration");
+
+  XML_FIND_NESTED_ELEMENT_CREATE_IF_MISSING(usSimulatorAlgoElement, config, "vtkPlusUsSimulatorAlgo");
+
+  usSimulatorAlgoElement->SetIntAttribute("NumberOfScanlines", this->NumberOfScanlines);
+  usSimulatorAlgoElement->SetIntAttribute("NumberOfSamplesPerScanline", this->NumberOfSamplesPerScanline);
+  usSimulatorAlgoElement->SetDoubleAttribute("FrequencyMhz", this->FrequencyMhz);
+  usSimulatorAlgoElement->SetDoubleAttribute("BrightnessConversionGamma", this->BrightnessConversionGamma);
+  usSimulatorAlgoElement->SetDoubleAttribute("BrightnessConversionOffset", this->BrightnessConversionOffset);
+  usSimulatorAlgoElement->SetDoubleAttribute("BrightnessConversionScale", this->BrightnessConversionScale);
+  usSimulatorAlgoElement->SetDoubleAttribute("IncomingIntensityMwPerCm2", this->IncomingIntensityMwPerCm2);
+  usSimulatorAlgoElement->SetDoubleAttribute("NoiseAmplitude", this->NoiseAmplitude);
+  usSimulatorAlgoElement->SetVectorAttribute("NoiseFrequency", 3, this->NoiseFrequency);
+  usSimulatorAlgoElement->SetVectorAttribute("NoisePhase", 3, this->NoisePhase);
+  usSimulatorAlgoElement->SetIntAttribute("NumberOfThreads", this->NumberOfThreads);
+  XML_WRITE_CSTRING_ATTRIBUTE_IF_NOT_NULL(ImageCoordinateFrame, usSimulatorAlgoElement);
+  XML_WRITE_CSTRING_ATTRIBUTE_IF_NOT_NULL(ReferenceCoordinateFrame, usSimulatorAlgoElement);
+
+  XML_FIND_NESTED_ELEMENT_CREATE_IF_MISSING(rfProcesingElement, usSimulatorAlgoElement, "RfProcessing");
+  return this->RfProcessor->WriteConfiguration(rfProcesingElement);
+}
+
 //-----------------------------------------------------------------------------
 PlusStatus vtkPlusUsSimulatorAlgo::GetFrameSize(FrameSizeType& frameSize)
 {
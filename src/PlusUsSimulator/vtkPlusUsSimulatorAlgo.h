@@ -10,6 +10,7 @@
 #include "vtkPlusUsSimulatorExport.h"
 
 #include "vtkImageAlgorithm.h"
+#include "vtkMultiThreader.h"
 
 #include "PlusSpatialModel.h"
 #include "vtkPlusTransformRepository.h"
@@ -18,7 +19,9 @@ class vtkPolyDataNormals;
 class vtkTriangleFilter;
 class vtkStripper;
 class vtkModifiedBSPTree;
+class vtkPerlinNoise;
 class vtkPlusRfProcessor;
+class vtkPlusWorkerPool;
 
 /*!
   \class vtkPlusUsSimulatorAlgo
@@ -35,6 +38,9 @@ public:
   /*! Read configuration from xml data */
   virtual PlusStatus ReadConfiguration(vtkXMLDataElement* config);
 
+  /*! Write configuration to xml data */
+  virtual PlusStatus WriteConfiguration(vtkXMLDataElement* config);
+
 public:
 
   /*! Set transform repository */
@@ -104,6 +110,15 @@ public:
   vtkSetVector3Macro(NoiseFrequency, double);
   vtkSetVector3Macro(NoisePhase, double);
 
+  /*!
+    Set the number of threads that simulate scanlines. Scanlines are independent, so they are distributed between the threads
+    and the result does not depend on the number of threads.
+    0 (default) means that the default number of threads is used (number of processors).
+  */
+  vtkSetMacro(NumberOfThreads, int);
+  /*! Get the number of threads that simulate scanlines */
+  vtkGetMacro(NumberOfThreads, int);
+
 protected:
   virtual int FillOutputPortInformation(int port, vtkInformation* info);
   virtual int RequestData(vtkInformation* request,
@@ -112,6 +127,19 @@ protected:
 
   void ConvertLineModelIntersectionsToSegmentDescriptor(std::deque<PlusSpatialModel::LineIntersectionInfo>& lineIntersectionsWithModels);
 
+  /*! Work buffers of a thread that simulates scanlines. They are reused between scanlines to avoid reallocations. */
+  struct ScanLineSimulationBuffers;
+
+  /*!
+    Compute the pixel values of a single scanline.
+    It does not modify the simulator or the spatial models, so scanlines can be simulated concurrently (using separate buffers).
+  */
+  PlusStatus SimulateScanLine(double* scanLineStartPoint_Reference, double* scanLineEndPoint_Reference, double distanceBetweenScanlineSamplePointsMm,
+                              vtkPerlinNoise* noiseFunction, unsigned char* dstPixelAddress, ScanLineSimulationBuffers& buffers);
+
+  /*! Simulate a range of scanlines, executed by each thread of the worker pool */
+  static VTK_THREAD_RETURN_TYPE SimulateScanLinesThreadFunction(void* arg);
+
 protected:
   vtkPlusUsSimulatorAlgo();
   ~vtkPlusUsSimulatorAlgo();
@@ -163,6 +191,12 @@ private:
   double NoiseAmplitude;
   double NoiseFrequency[3];
   double NoisePhase[3];
+
+  /*! Number of threads used for simulating scanlines, 0 means the default number of threads */
+  int NumberOfThreads;
+
+  /*! Threads that simulate the scanlines. They are kept alive between frames. */
+  vtkPlusWorkerPool* WorkerPool;
 };
 
 #endif // __vtkPlusUsSimulatorAlgo_h
@@ -0,0 +1,128 @@
+/*=Plus=header=begin======================================================
+  Program: Plus
+  Copyright (c) Laboratory for Percutaneous Surgery. All rights reserved.
+  See License.txt for details.
+=========================================================Plus=header=end*/
+
+/*!
+  \file vtkPlusPasteSliceIntoVolumeBenchmark.cxx
+  \brief Measures slice insertion rate with threads created for each slice and with persistent worker threads
+
+  Synthetic slices are inserted into a synthetic volume, so that no input data is needed.
+*/
+
+#include "PlusConfigure.h"
+#include "vtkPlusPasteSliceIntoVolume.h"
+
+// VTK includes
+#include <vtkImageData.h>
+#include <vtkMatrix4x4.h>
+#include <vtkSmartPointer.h>
+#include <vtkTransform.h>
+#include <vtksys/CommandLineArguments.hxx>
+
+// STL includes
+#include <iomanip>
+
+namespace
+{
+  //----------------------------------------------------------------------------
+  // Returns the number of inserted slices per second
+  double MeasureInsertionRate(vtkPlusPasteSliceIntoVolume* paster, vtkImageData* slice, int numberOfSlices, int volumeSize)
+  {
+    vtkSmartPointer<vtkTransform> sliceToVolume = vtkSmartPointer<vtkTransform>::New();
+    double startTimeSec = vtkPlusAccurateTimer::GetSystemTime();
+    for (int i = 0; i < numberOfSlices; ++i)
+    {
+      // Sweep through the volume with a slightly tilted slice
+      sliceToVolume->Identity();
+      sliceToVolume->Translate(0, 0, (i % volumeSize));
+      sliceToVolume->RotateX(10.0);
+      paster->InsertSlice(slice, sliceToVolume->GetMatrix());
+    }
+    double elapsedTimeSec = vtkPlusAccurateTimer::GetSystemTime() - startTimeSec;
+    return (elapsedTimeSec > 0 ? numberOfSlices / elapsedTimeSec : 0.0);
+  }
+}
+
+//----------------------------------------------------------------------------
+int main(int argc, char** argv)
+{
+  bool printHelp(false);
+  int verboseLevel = vtkPlusLogger::LOG_LEVEL_UNDEFINED;
+  int numberOfSlices = 500;
+  int sliceSize = 128;
+  int volumeSize = 128;
+  int numberOfThreads = 0;
+
+  vtksys::CommandLineArguments args;
+  args.Initialize(argc, argv);
+
+  args.AddArgument("--help", vtksys::CommandLineArguments::NO_ARGUMENT, &printHelp, "Print this help.");
+  args.AddArgument("--number-of-slices", vtksys::CommandLineArguments::EQUAL_ARGUMENT, &numberOfSlices, "Number of slices to insert with each threading model (default: 500)");
+  args.AddArgument("--slice-size", vtksys::CommandLineArguments::EQUAL_ARGUMENT, &sliceSize, "Width and height of the inserted slices in pixels (default: 128)");
+  args.AddArgument("--volume-size", vtksys::CommandLineArguments::EQUAL_ARGUMENT, &volumeSize, "Size of the output volume along each axis in voxels (default: 128)");
+  args.AddArgument("--number-of-threads", vtksys::CommandLineArguments::EQUAL_ARGUMENT, &numberOfThreads, "Number of threads, 0 means default (default: 0)");
+  args.AddArgument("--verbose", vtksys::CommandLineArguments::EQUAL_ARGUMENT, &verboseLevel, "Verbose level (1=error only, 2=warning, 3=info, 4=debug, 5=trace)");
+
+  if (!args.Parse())
+  {
+    std::cerr << "Problem parsing arguments" << std::endl;
+    std::cout << "Help: " << args.GetHelp() << std::endl;
+    exit(EXIT_FAILURE);
+  }
+
+  if (printHelp)
+  {
+    std::cout << args.GetHelp() << std::endl;
+    exit(EXIT_SUCCESS);
+  }
+
+  vtkPlusLogger::Instance()->SetLogLevel(verboseLevel);
+
+  if (numberOfSlices < 1 || sliceSize < 1 || volumeSize < 1)
+  {
+    LOG_ERROR("Number of slices, slice size, and volume size must be positive");
+    exit(EXIT_FAILURE);
+  }
+
+  // Slice filled with a simple pattern
+  vtkSmartPointer<vtkImageData> slice = vtkSmartPointer<vtkImageData>::New();
+  slice->SetExtent(0, sliceSize - 1, 0, sliceSize - 1, 0, 0);
+  slice->AllocateScalars(VTK_UNSIGNED_CHAR, 1);
+  unsigned char* slicePixels = static_cast<unsigned char*>(slice->GetScalarPointer());
+  for (int i = 0; i < sliceSize * sliceSize; ++i)
+  {
+    slicePixels[i] = static_cast<unsigned char>((i * 7) % 255 + 1);
+  }
+
+  vtkSmartPointer<vtkPlusPasteSliceIntoVolume> paster = vtkSmartPointer<vtkPlusPasteSliceIntoVolume>::New();
+  int outputExtent[6] = { 0, volumeSize - 1, 0, volumeSize - 1, 0, volumeSize - 1 };
+  paster->SetOutputExtent(outputExtent);
+  paster->SetCompoundingMode(vtkPlusPasteSliceIntoVolume::MEAN_COMPOUNDING_MODE);
+  paster->SetNumberOfThreads(numberOfThreads);
+
+  double ratePerSliceThreads = 0.0;
+  double rateWorkerPool = 0.0;
+
+  paster->UseWorkerPoolOff();
+  if (paster->ResetOutput() != PLUS_SUCCESS)
+  {
+    LOG_ERROR("Failed to reset output volume");
+    exit(EXIT_FAILURE);
+  }
+  ratePerSliceThreads = MeasureInsertionRate(paster, slice, numberOfSlices, volumeSize);
+
+  paster->UseWorkerPoolOn();
+  if (paster->ResetOutput() != PLUS_SUCCESS)
+  {
+    LOG_ERROR("Failed to reset output volume");
+    exit(EXIT_FAILURE);
+  }
+  rateWorkerPool = MeasureInsertionRate(paster, slice, numberOfSlices, volumeSize);
+
+  LOG_INFO("Slice insertion rate with threads created for each slice: " << std::fixed << std::setprecision(1) << ratePerSliceThreads << " slices/sec");
+  LOG_INFO("Slice insertion rate with persistent worker threads: " << std::fixed << std::setprecision(1) << rateWorkerPool << " slices/sec");
+
+  return EXIT_SUCCESS;
+}
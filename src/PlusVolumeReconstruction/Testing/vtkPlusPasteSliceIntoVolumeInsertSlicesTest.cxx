@@ -0,0 +1,203 @@
+/*=Plus=header=begin======================================================
+  Program: Plus
+  Copyright (c) Laboratory for Percutaneous Surgery. All rights reserved.
+  See License.txt for details.
+=========================================================Plus=header=end*/
+
+/*!
+  \file vtkPlusPasteSliceIntoVolumeInsertSlicesTest.cxx
+  \brief Verifies that inserting a batch of slices (InsertSlices) gives the same volume as inserting the slices one by one
+
+  Overlapping synthetic slices are inserted with a single thread one by one and as a batch with multiple threads,
+  with and without worker threads, using nearest neighbor and linear interpolation and mean and maximum compounding.
+  The reconstructed volumes and accumulation buffers must be identical.
+*/
+
+#include "PlusConfigure.h"
+#include "vtkPlusPasteSliceIntoVolume.h"
+
+// VTK includes
+#include <vtkImageData.h>
+#include <vtkMatrix4x4.h>
+#include <vtkSmartPointer.h>
+#include <vtkTransform.h>
+#include <vtksys/CommandLineArguments.hxx>
+
+// STL includes
+#include <cstring>
+
+namespace
+{
+  const int VOLUME_SIZE = 64;
+
+  //----------------------------------------------------------------------------
+  vtkSmartPointer<vtkPlusPasteSliceIntoVolume> CreatePaster(vtkPlusPasteSliceIntoVolume::CompoundingType compoundingMode, vtkPlusPasteSliceIntoVolume::InterpolationType interpolationMode,
+      int numberOfThreads, bool useWorkerPool)
+  {
+    vtkSmartPointer<vtkPlusPasteSliceIntoVolume> paster = vtkSmartPointer<vtkPlusPasteSliceIntoVolume>::New();
+    int outputExtent[6] = { 0, VOLUME_SIZE - 1, 0, VOLUME_SIZE - 1, 0, VOLUME_SIZE - 1 };
+    paster->SetOutputExtent(outputExtent);
+    paster->SetCompoundingMode(compoundingMode);
+    paster->SetInterpolationMode(interpolationMode);
+    paster->SetNumberOfThreads(numberOfThreads);
+    paster->SetUseWorkerPool(useWorkerPool);
+    if (paster->ResetOutput() != PLUS_SUCCESS)
+    {
+      LOG_ERROR("Failed to reset output volume");
+      return NULL;
+    }
+    return paster;
+  }
+
+  //----------------------------------------------------------------------------
+  bool ImagesEqual(vtkImageData* image1, vtkImageData* image2)
+  {
+    int extent1[6] = { 0, -1, 0, -1, 0, -1 };
+    int extent2[6] = { 0, -1, 0, -1, 0, -1 };
+    image1->GetExtent(extent1);
+    image2->GetExtent(extent2);
+    if (!std::equal(extent1, extent1 + 6, extent2)
+        || image1->GetScalarType() != image2->GetScalarType()
+        || image1->GetNumberOfScalarComponents() != image2->GetNumberOfScalarComponents())
+    {
+      return false;
+    }
+    size_t numberOfBytes = static_cast<size_t>(image1->GetNumberOfPoints()) * image1->GetNumberOfScalarComponents() * image1->GetScalarSize();
+    return memcmp(image1->GetScalarPointer(), image2->GetScalarPointer(), numberOfBytes) == 0;
+  }
+
+  //----------------------------------------------------------------------------
+  PlusStatus TestInsertSlices(vtkPlusPasteSliceIntoVolume::CompoundingType compoundingMode, vtkPlusPasteSliceIntoVolume::InterpolationType interpolationMode,
+                              bool useWorkerPool, int numberOfSlices, vtkImageData* slice, const std::vector<vtkSmartPointer<vtkMatrix4x4> >& sliceToVolumeMatrices)
+  {
+    // Reference: slices inserted one by one with a single thread
+    vtkSmartPointer<vtkPlusPasteSliceIntoVolume> referencePaster = CreatePaster(compoundingMode, interpolationMode, 1, useWorkerPool);
+    vtkSmartPointer<vtkPlusPasteSliceIntoVolume> batchPaster = CreatePaster(compoundingMode, interpolationMode, 0, useWorkerPool);
+    if (referencePaster.GetPointer() == NULL || batchPaster.GetPointer() == NULL)
+    {
+      return PLUS_FAIL;
+    }
+
+    std::vector<vtkPlusPasteSliceIntoVolume::SliceToInsert> slices;
+    for (int i = 0; i < numberOfSlices; ++i)
+    {
+      if (referencePaster->InsertSlice(slice, sliceToVolumeMatrices[i]) != PLUS_SUCCESS)
+      {
+        LOG_ERROR("Failed to insert slice " << i);
+        return PLUS_FAIL;
+      }
+      vtkPlusPasteSliceIntoVolume::SliceToInsert sliceToInsert;
+      sliceToInsert.Image = slice;
+      sliceToInsert.ImageToReference = sliceToVolumeMatrices[i];
+      batchPaster->GetFanAnglesDeg(sliceToInsert.FanAnglesDeg);
+      slices.push_back(sliceToInsert);
+    }
+    if (batchPaster->InsertSlices(slices) != PLUS_SUCCESS)
+    {
+      LOG_ERROR("Failed to insert slices");
+      return PLUS_FAIL;
+    }
+
+    std::string testName = std::string(referencePaster->GetCompoundingModeAsString(compoundingMode)) + " compounding, "
+                           + referencePaster->GetInterpolationModeAsString(interpolationMode) + (useWorkerPool ? " interpolation with worker threads" : " interpolation without worker threads");
+    if (!ImagesEqual(referencePaster->GetReconstructedVolume(), batchPaster->GetReconstructedVolume()))
+    {
+      LOG_ERROR("Reconstructed volume of batch insertion differs from inserting slices one by one (" << testName << ")");
+      return PLUS_FAIL;
+    }
+    if (!ImagesEqual(referencePaster->GetAccumulationBuffer(), batchPaster->GetAccumulationBuffer()))
+    {
+      LOG_ERROR("Accumulation buffer of batch insertion differs from inserting slices one by one (" << testName << ")");
+      return PLUS_FAIL;
+    }
+    LOG_INFO("Batch insertion matches inserting slices one by one (" << testName << ")");
+    return PLUS_SUCCESS;
+  }
+}
+
+//----------------------------------------------------------------------------
+int main(int argc, char** argv)
+{
+  bool printHelp(false);
+  int verboseLevel = vtkPlusLogger::LOG_LEVEL_UNDEFINED;
+  int numberOfSlices = 50;
+
+  vtksys::CommandLineArguments args;
+  args.Initialize(argc, argv);
+
+  args.AddArgument("--help", vtksys::CommandLineArguments::NO_ARGUMENT, &printHelp, "Print this help.");
+  args.AddArgument("--number-of-slices", vtksys::CommandLineArguments::EQUAL_ARGUMENT, &numberOfSlices, "Number of slices to insert (default: 50)");
+  args.AddArgument("--verbose", vtksys::CommandLineArguments::EQUAL_ARGUMENT, &verboseLevel, "Verbose level (1=error only, 2=warning, 3=info, 4=debug, 5=trace)");
+
+  if (!args.Parse())
+  {
+    std::cerr << "Problem parsing arguments" << std::endl;
+    std::cout << "Help: " << args.GetHelp() << std::endl;
+    exit(EXIT_FAILURE);
+  }
+
+  if (printHelp)
+  {
+    std::cout << args.GetHelp() << std::endl;
+    exit(EXIT_SUCCESS);
+  }
+
+  vtkPlusLogger::Instance()->SetLogLevel(verboseLevel);
+
+  if (numberOfSlices < 1)
+  {
+    LOG_ERROR("Number of slices must be positive");
+    exit(EXIT_FAILURE);
+  }
+
+  // Slice filled with a simple pattern
+  const int sliceSize = 48;
+  vtkSmartPointer<vtkImageData> slice = vtkSmartPointer<vtkImageData>::New();
+  slice->SetExtent(0, sliceSize - 1, 0, sliceSize - 1, 0, 0);
+  slice->AllocateScalars(VTK_UNSIGNED_CHAR, 1);
+  unsigned char* slicePixels = static_cast<unsigned char*>(slice->GetScalarPointer());
+  for (int i = 0; i < sliceSize * sliceSize; ++i)
+  {
+    slicePixels[i] = static_cast<unsigned char>((i * 7) % 255 + 1);
+  }
+
+  // Tilted slices that sweep through the volume and intersect each other, so that voxels are compounded from several slices
+  std::vector<vtkSmartPointer<vtkMatrix4x4> > sliceToVolumeMatrices;
+  vtkSmartPointer<vtkTransform> sliceToVolume = vtkSmartPointer<vtkTransform>::New();
+  for (int i = 0; i < numberOfSlices; ++i)
+  {
+    sliceToVolume->Identity();
+    sliceToVolume->Translate(5.3 + (i % 7) * 0.7, 3.1 + (i % 5) * 1.3, 10.0 + (i * 40.0) / numberOfSlices);
+    sliceToVolume->RotateX(-20.0 + (i % 9) * 5.0);
+    sliceToVolume->RotateY((i % 4) * 3.0);
+    vtkSmartPointer<vtkMatrix4x4> sliceToVolumeMatrix = vtkSmartPointer<vtkMatrix4x4>::New();
+    sliceToVolumeMatrix->DeepCopy(sliceToVolume->GetMatrix());
+    sliceToVolumeMatrices.push_back(sliceToVolumeMatrix);
+  }
+
+  int numberOfFailures = 0;
+  vtkPlusPasteSliceIntoVolume::CompoundingType compoundingModes[2] = { vtkPlusPasteSliceIntoVolume::MEAN_COMPOUNDING_MODE, vtkPlusPasteSliceIntoVolume::MAXIMUM_COMPOUNDING_MODE };
+  vtkPlusPasteSliceIntoVolume::InterpolationType interpolationModes[2] = { vtkPlusPasteSliceIntoVolume::NEAREST_NEIGHBOR_INTERPOLATION, vtkPlusPasteSliceIntoVolume::LINEAR_INTERPOLATION };
+  for (int compoundingIndex = 0; compoundingIndex < 2; ++compoundingIndex)
+  {
+    for (int interpolationIndex = 0; interpolationIndex < 2; ++interpolationIndex)
+    {
+      if (TestInsertSlices(compoundingModes[compoundingIndex], interpolationModes[interpolationIndex], true, numberOfSlices, slice, sliceToVolumeMatrices) != PLUS_SUCCESS)
+      {
+        numberOfFailures++;
+      }
+      if (TestInsertSlices(compoundingModes[compoundingIndex], interpolationModes[interpolationIndex], false, numberOfSlices, slice, sliceToVolumeMatrices) != PLUS_SUCCESS)
+      {
+        numberOfFailures++;
+      }
+    }
+  }
+
+  if (numberOfFailures > 0)
+  {
+    LOG_ERROR("InsertSlices test failed");
+    return EXIT_FAILURE;
+  }
+  LOG_INFO("InsertSlices test completed successfully");
+  return EXIT_SUCCESS;
+}
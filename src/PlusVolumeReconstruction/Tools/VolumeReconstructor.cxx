@@ -36,6 +36,7 @@ int main(int argc, char* argv[])
   int verboseLevel = vtkPlusLogger::LOG_LEVEL_UNDEFINED;
 
   bool disableCompression = false;
+  bool batchInsertion = false;
 
   vtksys::CommandLineArguments cmdargs;
   cmdargs.Initialize(argc, argv);
@@ -48,6 +49,7 @@ int main(int argc, char* argv[])
   cmdargs.AddArgument("--output-frame-file", vtksys::CommandLineArguments::EQUAL_ARGUMENT, &outputFrameFileName, "A filename that will be used for storing the tracked image frames. Each frame will be exported individually, with the proper position and orientation in the reference coordinate system");
   cmdargs.AddArgument("--help", vtksys::CommandLineArguments::NO_ARGUMENT, &printHelp, "Print this help.");
   cmdargs.AddArgument("--disable-compression", vtksys::CommandLineArguments::NO_ARGUMENT, &disableCompression, "Do not compress output image files.");
+  cmdargs.AddArgument("--batch-insertion", vtksys::CommandLineArguments::NO_ARGUMENT, &batchInsertion, "Insert all frames into the volume in one batch, which is faster for long sequences on multi-core computers. Ignored if --output-frame-file is specified.");
   cmdargs.AddArgument("--verbose", vtksys::CommandLineArguments::EQUAL_ARGUMENT, &verboseLevel, "Verbose level (1=error only, 2=warning, 3=info, 4=debug, 5=trace)");
   cmdargs.AddArgument("--importance-mask-file", vtksys::CommandLineArguments::EQUAL_ARGUMENT, &importanceMaskFileName, "The file to use as the importance mask.");
 
@@ -182,60 +184,70 @@ int main(int argc, char* argv[])
   const int numberOfFrames = trackedFrameList->GetNumberOfTrackedFrames();
   int numberOfFramesAddedToVolume = 0;
 
-  for (int frameIndex = 0; frameIndex < numberOfFrames; frameIndex += reconstructor->GetSkipInterval())
+  if (batchInsertion && outputFrameFileName.empty())
   {
-    LOG_DEBUG("Frame: " << frameIndex);
-    vtkPlusLogger::PrintProgressbar((100.0 * frameIndex) / numberOfFrames);
-
-    PlusTrackedFrame* frame = trackedFrameList->GetTrackedFrame(frameIndex);
-
-    if (transformRepository->SetTransforms(*frame) != PLUS_SUCCESS)
+    if (reconstructor->AddTrackedFrames(trackedFrameList, transformRepository, &numberOfFramesAddedToVolume) != PLUS_SUCCESS)
     {
-      LOG_ERROR("Failed to update transform repository with frame #" << frameIndex);
-      continue;
+      LOG_ERROR("Failed to add some of the tracked frames to the volume");
     }
-
-    // Insert slice for reconstruction
-    bool insertedIntoVolume = false;
-    if (reconstructor->AddTrackedFrame(frame, transformRepository, &insertedIntoVolume) != PLUS_SUCCESS)
+  }
+  else
+  {
+    for (int frameIndex = 0; frameIndex < numberOfFrames; frameIndex += reconstructor->GetSkipInterval())
     {
-      LOG_ERROR("Failed to add tracked frame to volume with frame #" << frameIndex);
-      continue;
-    }
+      LOG_DEBUG("Frame: " << frameIndex);
+      vtkPlusLogger::PrintProgressbar((100.0 * frameIndex) / numberOfFrames);
 
-    if (insertedIntoVolume)
-    {
-      numberOfFramesAddedToVolume++;
-    }
+      PlusTrackedFrame* frame = trackedFrameList->GetTrackedFrame(frameIndex);
 
-    // Write an ITK image with the image pose in the reference coordinate system
-    if (!outputFrameFileName.empty())
-    {
-      vtkSmartPointer<vtkMatrix4x4> imageToReferenceTransformMatrix = vtkSmartPointer<vtkMatrix4x4>::New();
-      if (transformRepository->GetTransform(imageToReferenceTransformName, imageToReferenceTransformMatrix) != PLUS_SUCCESS)
+      if (transformRepository->SetTransforms(*frame) != PLUS_SUCCESS)
       {
-        std::string strImageToReferenceTransformName;
-        imageToReferenceTransformName.GetTransformName(strImageToReferenceTransformName);
-        LOG_ERROR("Failed to get transform '" << strImageToReferenceTransformName << "' from transform repository!");
+        LOG_ERROR("Failed to update transform repository with frame #" << frameIndex);
         continue;
       }
 
-      // Print the image to reference transform
-      std::ostringstream os;
-      imageToReferenceTransformMatrix->Print(os);
-      LOG_TRACE("Image to reference transform: \n" << os.str());
-
-      // Insert frame index before the file extension (image.mha => image001.mha)
-      std::ostringstream ss;
-      size_t found;
-      found = outputFrameFileName.find_last_of(".");
-      ss << outputFrameFileName.substr(0, found);
-      ss.width(3);
-      ss.fill('0');
-      ss << frameIndex;
-      ss << outputFrameFileName.substr(found);
-
-      frame->WriteToFile(ss.str(), imageToReferenceTransformMatrix);
+      // Insert slice for reconstruction
+      bool insertedIntoVolume = false;
+      if (reconstructor->AddTrackedFrame(frame, transformRepository, &insertedIntoVolume) != PLUS_SUCCESS)
+      {
+        LOG_ERROR("Failed to add tracked frame to volume with frame #" << frameIndex);
+        continue;
+      }
+
+      if (insertedIntoVolume)
+      {
+        numberOfFramesAddedToVolume++;
+      }
+
+      // Write an ITK image with the image pose in the reference coordinate system
+      if (!outputFrameFileName.empty())
+      {
+        vtkSmartPointer<vtkMatrix4x4> imageToReferenceTransformMatrix = vtkSmartPointer<vtkMatrix4x4>::New();
+        if (transformRepository->GetTransform(imageToReferenceTransformName, imageToReferenceTransformMatrix) != PLUS_SUCCESS)
+        {
+          std::string strImageToReferenceTransformName;
+          imageToReferenceTransformName.GetTransformName(strImageToReferenceTransformName);
+          LOG_ERROR("Failed to get transform '" << strImageToReferenceTransformName << "' from transform repository!");
+          continue;
+        }
+
+        // Print the image to reference transform
+        std::ostringstream os;
+        imageToReferenceTransformMatrix->Print(os);
+        LOG_TRACE("Image to reference transform: \n" << os.str());
+
+        // Insert frame index before the file extension (image.mha => image001.mha)
+        std::ostringstream ss;
+        size_t found;
+        found = outputFrameFileName.find_last_of(".");
+        ss << outputFrameFileName.substr(0, found);
+        ss.width(3);
+        ss.fill('0');
+        ss << frameIndex;
+        ss << outputFrameFileName.substr(found);
+
+        frame->WriteToFile(ss.str(), imageToReferenceTransformMatrix);
+      }
     }
   }
 
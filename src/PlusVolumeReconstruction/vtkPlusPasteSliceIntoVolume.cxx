@@ -54,6 +54,11 @@ POSSIBILITY OF SUCH DAMAGES.
 #include "vtkPlusPasteSliceIntoVolumeHelperCommon.h"
 #include "vtkPlusPasteSliceIntoVolumeHelperUnoptimized.h"
 #include "vtkPlusPasteSliceIntoVolumeHelperOptimized.h"
+#include "vtkPlusWorkerPool.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
 
 vtkStandardNewMacro( vtkPlusPasteSliceIntoVolume );
 
@@ -78,6 +83,52 @@ struct InsertSliceThreadFunctionInfoStruct
   std::vector<unsigned int> AccumulationBufferSaturationErrors;
 };
 
+struct InsertSlicesIntoBricksThreadFunctionInfoStruct
+{
+  vtkPlusPasteSliceIntoVolume* Paster;
+  const std::vector<vtkPlusPasteSliceIntoVolume::SliceToInsert>* Slices;
+  // Voxel index range that may be modified by each slice (xmin, xmax, ymin, ymax, zmin, zmax)
+  std::vector< std::array<int, 6> > SliceVoxelExtents;
+  // Output volume extent partitions, each brick is processed by one thread
+  std::vector< std::array<int, 6> > BrickExtents;
+  std::atomic<int> NextBrickIndex;
+  std::vector<unsigned int> AccumulationBufferSaturationErrors;
+};
+
+namespace
+{
+  // Each thread processes multiple bricks for better load balancing (slices may cover only part of the volume)
+  const int NUMBER_OF_BRICKS_PER_THREAD = 4;
+
+  //----------------------------------------------------------------------------
+  // Copy the voxels in the extent from the source to the target image. Both images must contain the extent
+  // and must have the same scalar type and number of components.
+  void CopyImageRegion( vtkImageData* source, vtkImageData* target, const int extent[6] )
+  {
+    size_t rowSizeBytes = size_t( extent[1] - extent[0] + 1 ) * source->GetScalarSize() * source->GetNumberOfScalarComponents();
+    for ( int z = extent[4]; z <= extent[5]; z++ )
+    {
+      for ( int y = extent[2]; y <= extent[3]; y++ )
+      {
+        memcpy( target->GetScalarPointer( extent[0], y, z ), source->GetScalarPointer( extent[0], y, z ), rowSizeBytes );
+      }
+    }
+  }
+
+  //----------------------------------------------------------------------------
+  bool ExtentsIntersect( const int extentA[6], const int extentB[6] )
+  {
+    for ( int axis = 0; axis < 3; axis++ )
+    {
+      if ( extentA[2 * axis + 1] < extentB[2 * axis] || extentB[2 * axis + 1] < extentA[2 * axis] )
+      {
+        return false;
+      }
+    }
+    return true;
+  }
+}
+
 //----------------------------------------------------------------------------
 vtkPlusPasteSliceIntoVolume::vtkPlusPasteSliceIntoVolume()
 {
@@ -85,6 +136,7 @@ vtkPlusPasteSliceIntoVolume::vtkPlusPasteSliceIntoVolume()
   this->AccumulationBuffer = vtkImageData::New();
   this->ImportanceMask = NULL;
   this->Threader = vtkMultiThreader::New();
+  this->WorkerPool = vtkPlusWorkerPool::New();
 
   this->OutputOrigin[0] = 0.0;
   this->OutputOrigin[1] = 0.0;
@@ -124,6 +176,7 @@ vtkPlusPasteSliceIntoVolume::vtkPlusPasteSliceIntoVolume()
   this->CompoundingMode = UNDEFINED_COMPOUNDING_MODE;
 
   this->NumberOfThreads = 0; // 0 means not set, the default number of threads will be used
+  this->UseWorkerPool = true;
 
   this->EnableAccumulationBufferOverflowWarning = true;
 
@@ -153,6 +206,11 @@ vtkPlusPasteSliceIntoVolume::~vtkPlusPasteSliceIntoVolume()
     this->Threader->Delete();
     this->Threader = NULL;
   }
+  if ( this->WorkerPool )
+  {
+    this->WorkerPool->Delete();
+    this->WorkerPool = NULL;
+  }
 }
 
 //----------------------------------------------------------------------------
@@ -204,6 +262,7 @@ void vtkPlusPasteSliceIntoVolume::PrintSelf( ostream& os, vtkIndent indent )
   {
     os << "default\n";
   }
+  os << indent << "UseWorkerPool: " << ( this->UseWorkerPool ? "true" : "false" ) << "\n";
 }
 
 
@@ -296,6 +355,61 @@ PlusStatus vtkPlusPasteSliceIntoVolume::ResetOutput()
 // Does the actual work of optimally inserting a slice, with optimization
 // Basically, just calls Multithread()
 PlusStatus vtkPlusPasteSliceIntoVolume::InsertSlice( vtkImageData* image, vtkMatrix4x4* transformImageToReference )
+{
+  if ( this->CheckOutputExtent() != PLUS_SUCCESS )
+  {
+    return PLUS_FAIL;
+  }
+
+  InsertSliceThreadFunctionInfoStruct str;
+  this->GetInsertSliceParameters( str, image, transformImageToReference );
+
+  if ( this->NumberOfThreads > 0 )
+  {
+    this->Threader->SetNumberOfThreads( this->NumberOfThreads );
+  }
+  this->WorkerPool->SetNumberOfThreads( this->Threader->GetNumberOfThreads() );
+
+  // initialize array that counts the number of insertion errors due to overflow in the accumulation buffer
+  int numThreads( this->Threader->GetNumberOfThreads() );
+  str.AccumulationBufferSaturationErrors.resize( numThreads );
+  str.AccumulationBufferSaturationErrors.clear();
+  for ( int i = 0; i < numThreads; i++ )
+  {
+    str.AccumulationBufferSaturationErrors.push_back( 0 );
+  }
+
+  if ( this->UseWorkerPool )
+  {
+    // Worker threads are reused between slices, which avoids thread creation overhead at each slice
+    this->WorkerPool->SingleMethodExecute( InsertSliceThreadFunction, &str );
+  }
+  else
+  {
+    this->Threader->SetSingleMethod( InsertSliceThreadFunction, &str );
+    this->Threader->SingleMethodExecute();
+  }
+
+  // sum up str.AccumulationBufferSaturationErrors
+  unsigned int sumAccOverflowErrors( 0 );
+  for ( int i = 0; i < numThreads; i++ )
+  {
+    sumAccOverflowErrors += str.AccumulationBufferSaturationErrors[i];
+  }
+  if ( sumAccOverflowErrors && !EnableAccumulationBufferOverflowWarning )
+  {
+    LOG_WARNING( sumAccOverflowErrors << " voxels have had too many pixels inserted. This can result in errors in the final volume. It is recommended that the output volume resolution be increased." );
+  }
+
+  this->ReconstructedVolume->Modified();
+  this->AccumulationBuffer->Modified();
+  this->Modified();
+
+  return PLUS_SUCCESS;
+}
+
+//----------------------------------------------------------------------------
+PlusStatus vtkPlusPasteSliceIntoVolume::CheckOutputExtent()
 {
   if ( this->OutputExtent[0] >= this->OutputExtent[1]
        && this->OutputExtent[2] >= this->OutputExtent[3]
@@ -306,8 +420,12 @@ PlusStatus vtkPlusPasteSliceIntoVolume::InsertSlice( vtkImageData* image, vtkMat
                << " Cannot insert slice into the volume. Set the correct output volume origin, spacing, and extent before inserting slices." );
     return PLUS_FAIL;
   }
+  return PLUS_SUCCESS;
+}
 
-  InsertSliceThreadFunctionInfoStruct str;
+//----------------------------------------------------------------------------
+void vtkPlusPasteSliceIntoVolume::GetInsertSliceParameters( InsertSliceThreadFunctionInfoStruct& str, vtkImageData* image, vtkMatrix4x4* transformImageToReference )
+{
   str.InputFrameImage = image;
   str.TransformImageToReference = transformImageToReference;
   str.OutputVolume = this->ReconstructedVolume;
@@ -340,29 +458,107 @@ PlusStatus vtkPlusPasteSliceIntoVolume::InsertSlice( vtkImageData* image, vtkMat
   str.FanRadiusStop = this->FanRadiusStop;
 
   str.PixelRejectionThreshold = this->PixelRejectionThreshold;
+}
+
+//----------------------------------------------------------------------------
+PlusStatus vtkPlusPasteSliceIntoVolume::InsertSlices( const std::vector<SliceToInsert>& slices )
+{
+  if ( this->CheckOutputExtent() != PLUS_SUCCESS )
+  {
+    return PLUS_FAIL;
+  }
+  if ( slices.empty() )
+  {
+    return PLUS_SUCCESS;
+  }
 
   if ( this->NumberOfThreads > 0 )
   {
     this->Threader->SetNumberOfThreads( this->NumberOfThreads );
   }
-
-  // initialize array that counts the number of insertion errors due to overflow in the accumulation buffer
   int numThreads( this->Threader->GetNumberOfThreads() );
-  str.AccumulationBufferSaturationErrors.resize( numThreads );
-  str.AccumulationBufferSaturationErrors.clear();
-  for ( int i = 0; i < numThreads; i++ )
+  this->WorkerPool->SetNumberOfThreads( numThreads );
+
+  InsertSlicesIntoBricksThreadFunctionInfoStruct info;
+  info.Paster = this;
+  info.Slices = &slices;
+  info.NextBrickIndex = 0;
+  info.AccumulationBufferSaturationErrors.assign( numThreads, 0 );
+
+  // Compute the voxel extent that each slice may modify. A one voxel margin is added
+  // to account for rounding and for the neighbors modified by linear interpolation.
+  const double* volumeOrigin = this->ReconstructedVolume->GetOrigin();
+  const double* volumeSpacing = this->ReconstructedVolume->GetSpacing();
+  for ( std::vector<SliceToInsert>::const_iterator sliceIt = slices.begin(); sliceIt != slices.end(); ++sliceIt )
   {
-    str.AccumulationBufferSaturationErrors.push_back( 0 );
+    int imageExtent[6] = { 0, -1, 0, -1, 0, -1 };
+    sliceIt->Image->GetExtent( imageExtent );
+    double imageSpacing[3] = { 1.0, 1.0, 1.0 };
+    sliceIt->Image->GetSpacing( imageSpacing );
+    double voxelMin[3] = { VTK_DOUBLE_MAX, VTK_DOUBLE_MAX, VTK_DOUBLE_MAX };
+    double voxelMax[3] = { VTK_DOUBLE_MIN, VTK_DOUBLE_MIN, VTK_DOUBLE_MIN };
+    for ( int corner = 0; corner < 8; corner++ )
+    {
+      double imagePoint[4] =
+      {
+        imageExtent[( corner & 1 ) ? 1 : 0] * imageSpacing[0],
+        imageExtent[( corner & 2 ) ? 3 : 2] * imageSpacing[1],
+        imageExtent[( corner & 4 ) ? 5 : 4] * imageSpacing[2],
+        1.0
+      };
+      double referencePoint[4] = { 0.0, 0.0, 0.0, 1.0 };
+      sliceIt->ImageToReference->MultiplyPoint( imagePoint, referencePoint );
+      for ( int axis = 0; axis < 3; axis++ )
+      {
+        double voxelPosition = ( referencePoint[axis] - volumeOrigin[axis] ) / volumeSpacing[axis];
+        voxelMin[axis] = std::min( voxelMin[axis], voxelPosition );
+        voxelMax[axis] = std::max( voxelMax[axis], voxelPosition );
+      }
+    }
+    std::array<int, 6> sliceVoxelExtent;
+    for ( int axis = 0; axis < 3; axis++ )
+    {
+      // clamp to the output extent to avoid integer overflow for slices that are far outside of the volume
+      sliceVoxelExtent[2 * axis] = static_cast<int>( std::max<double>( floor( voxelMin[axis] ) - 1, this->OutputExtent[2 * axis] - 1 ) );
+      sliceVoxelExtent[2 * axis + 1] = static_cast<int>( std::min<double>( ceil( voxelMax[axis] ) + 1, this->OutputExtent[2 * axis + 1] + 1 ) );
+    }
+    info.SliceVoxelExtents.push_back( sliceVoxelExtent );
   }
 
-  this->Threader->SetSingleMethod( InsertSliceThreadFunction, &str );
-  this->Threader->SingleMethodExecute();
+  // Partition the output volume into bricks along its longest axis
+  int splitAxis = 0;
+  for ( int axis = 1; axis < 3; axis++ )
+  {
+    if ( this->OutputExtent[2 * axis + 1] - this->OutputExtent[2 * axis] > this->OutputExtent[2 * splitAxis + 1] - this->OutputExtent[2 * splitAxis] )
+    {
+      splitAxis = axis;
+    }
+  }
+  int splitAxisSize = this->OutputExtent[2 * splitAxis + 1] - this->OutputExtent[2 * splitAxis] + 1;
+  int numberOfBricks = std::max( 1, std::min( numThreads * NUMBER_OF_BRICKS_PER_THREAD, splitAxisSize ) );
+  for ( int brickIndex = 0; brickIndex < numberOfBricks; brickIndex++ )
+  {
+    std::array<int, 6> brickExtent;
+    std::copy( this->OutputExtent, this->OutputExtent + 6, brickExtent.begin() );
+    brickExtent[2 * splitAxis] = this->OutputExtent[2 * splitAxis] + ( brickIndex * splitAxisSize ) / numberOfBricks;
+    brickExtent[2 * splitAxis + 1] = this->OutputExtent[2 * splitAxis] + ( ( brickIndex + 1 ) * splitAxisSize ) / numberOfBricks - 1;
+    info.BrickExtents.push_back( brickExtent );
+  }
+
+  if ( this->UseWorkerPool )
+  {
+    this->WorkerPool->SingleMethodExecute( InsertSlicesIntoBricksThreadFunction, &info );
+  }
+  else
+  {
+    this->Threader->SetSingleMethod( InsertSlicesIntoBricksThreadFunction, &info );
+    this->Threader->SingleMethodExecute();
+  }
 
-  // sum up str.AccumulationBufferSaturationErrors
   unsigned int sumAccOverflowErrors( 0 );
   for ( int i = 0; i < numThreads; i++ )
   {
-    sumAccOverflowErrors += str.AccumulationBufferSaturationErrors[i];
+    sumAccOverflowErrors += info.AccumulationBufferSaturationErrors[i];
   }
   if ( sumAccOverflowErrors && !EnableAccumulationBufferOverflowWarning )
   {
@@ -376,6 +572,87 @@ PlusStatus vtkPlusPasteSliceIntoVolume::InsertSlice( vtkImageData* image, vtkMat
   return PLUS_SUCCESS;
 }
 
+//----------------------------------------------------------------------------
+VTK_THREAD_RETURN_TYPE vtkPlusPasteSliceIntoVolume::InsertSlicesIntoBricksThreadFunction( void* arg )
+{
+  vtkMultiThreader::ThreadInfo* threadInfo = static_cast<vtkMultiThreader::ThreadInfo*>( arg );
+  InsertSlicesIntoBricksThreadFunctionInfoStruct* info = static_cast<InsertSlicesIntoBricksThreadFunctionInfoStruct*>( threadInfo->UserData );
+  vtkPlusPasteSliceIntoVolume* self = info->Paster;
+  vtkImageData* volume = self->ReconstructedVolume;
+  vtkImageData* accumulator = self->AccumulationBuffer;
+
+  for ( int brickIndex = info->NextBrickIndex++; brickIndex < static_cast<int>( info->BrickExtents.size() ); brickIndex = info->NextBrickIndex++ )
+  {
+    const int* brickExtent = info->BrickExtents[brickIndex].data();
+
+    // The brick is processed in a separate image that has a one voxel margin around the brick. Slices are inserted
+    // into this image the same way as into the full volume, so pixels that are interpolated into voxels at the brick
+    // boundary are inserted the same way as in the full volume. Only voxels of the brick are copied back.
+    int paddedBrickExtent[6];
+    for ( int axis = 0; axis < 3; axis++ )
+    {
+      paddedBrickExtent[2 * axis] = std::max( brickExtent[2 * axis] - 1, self->OutputExtent[2 * axis] );
+      paddedBrickExtent[2 * axis + 1] = std::min( brickExtent[2 * axis + 1] + 1, self->OutputExtent[2 * axis + 1] );
+    }
+
+    std::vector<int> sliceIndices;
+    for ( unsigned int sliceIndex = 0; sliceIndex < info->Slices->size(); sliceIndex++ )
+    {
+      if ( ExtentsIntersect( info->SliceVoxelExtents[sliceIndex].data(), paddedBrickExtent ) )
+      {
+        sliceIndices.push_back( sliceIndex );
+      }
+    }
+    if ( sliceIndices.empty() )
+    {
+      continue;
+    }
+
+    vtkSmartPointer<vtkImageData> brickVolume = vtkSmartPointer<vtkImageData>::New();
+    brickVolume->SetExtent( paddedBrickExtent );
+    brickVolume->SetOrigin( volume->GetOrigin() );
+    brickVolume->SetSpacing( volume->GetSpacing() );
+    brickVolume->AllocateScalars( volume->GetScalarType(), volume->GetNumberOfScalarComponents() );
+    CopyImageRegion( volume, brickVolume, paddedBrickExtent );
+
+    vtkSmartPointer<vtkImageData> brickAccumulator = vtkSmartPointer<vtkImageData>::New();
+    brickAccumulator->SetExtent( paddedBrickExtent );
+    brickAccumulator->SetOrigin( accumulator->GetOrigin() );
+    brickAccumulator->SetSpacing( accumulator->GetSpacing() );
+    brickAccumulator->AllocateScalars( accumulator->GetScalarType(), accumulator->GetNumberOfScalarComponents() );
+    CopyImageRegion( accumulator, brickAccumulator, paddedBrickExtent );
+
+    for ( std::vector<int>::iterator sliceIndexIt = sliceIndices.begin(); sliceIndexIt != sliceIndices.end(); ++sliceIndexIt )
+    {
+      const SliceToInsert& slice = ( *info->Slices )[*sliceIndexIt];
+      InsertSliceThreadFunctionInfoStruct str;
+      self->GetInsertSliceParameters( str, slice.Image, slice.ImageToReference );
+      str.OutputVolume = brickVolume;
+      str.Accumulator = brickAccumulator;
+      str.FanAnglesDeg[0] = slice.FanAnglesDeg[0];
+      str.FanAnglesDeg[1] = slice.FanAnglesDeg[1];
+      str.AccumulationBufferSaturationErrors.assign( 1, 0 );
+
+      // Insert the whole slice from this thread
+      vtkMultiThreader::ThreadInfo sliceThreadInfo;
+      sliceThreadInfo.ThreadID = 0;
+      sliceThreadInfo.NumberOfThreads = 1;
+      sliceThreadInfo.ActiveFlag = NULL;
+      sliceThreadInfo.ActiveFlagLock = NULL;
+      sliceThreadInfo.UserData = &str;
+      InsertSliceThreadFunction( &sliceThreadInfo );
+
+      info->AccumulationBufferSaturationErrors[threadInfo->ThreadID] += str.AccumulationBufferSaturationErrors[0];
+    }
+
+    // Bricks do not overlap, so threads can write the volume without locking
+    CopyImageRegion( brickVolume, volume, brickExtent );
+    CopyImageRegion( brickAccumulator, accumulator, brickExtent );
+  }
+
+  return VTK_THREAD_RETURN_VALUE;
+}
+
 //----------------------------------------------------------------------------
 VTK_THREAD_RETURN_TYPE vtkPlusPasteSliceIntoVolume::InsertSliceThreadFunction( void* arg )
 {
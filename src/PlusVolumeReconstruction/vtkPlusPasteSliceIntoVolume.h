@@ -45,11 +45,15 @@ POSSIBILITY OF SUCH DAMAGES.
 
 #include "vtkPlusVolumeReconstructionExport.h"
 
+#include <vector>
+
+struct InsertSliceThreadFunctionInfoStruct;
 class PlusTrackedFrame;
 class vtkImageData;
 class vtkMatrix4x4;
 class vtkXMLDataElement;
 class vtkMultiThreader;
+class vtkPlusWorkerPool;
 
 /*!
   \class vtkPlusPasteSliceIntoVolume
@@ -152,6 +156,23 @@ public:
   */
   virtual PlusStatus InsertSlice(vtkImageData *image, vtkMatrix4x4* mImageToReference);
 
+  /*! Slice to be inserted into the volume by InsertSlices */
+  struct SliceToInsert
+  {
+    vtkImageData* Image;
+    vtkMatrix4x4* ImageToReference;
+    /*! Fan angles to use for clipping this slice (fan angles may be detected for each frame individually) */
+    double FanAnglesDeg[2];
+  };
+
+  /*!
+    Insert multiple slices into the reconstructed volume
+    The output volume is partitioned into bricks and each thread inserts the slices that intersect a brick
+    into that brick, so threads never write the same voxels. The result is the same as inserting the
+    slices one by one with a single thread. Efficient for inserting many slices at once (offline reconstruction).
+  */
+  virtual PlusStatus InsertSlices(const std::vector<SliceToInsert>& slices);
+
   /*!
     Get the output reconstructed 3D ultrasound volume
     (the output is the reconstruction volume, the second component
@@ -306,6 +327,16 @@ public:
   /*! Get number of threads used for processing the data */
   vtkGetMacro(NumberOfThreads,int);
 
+  /*!
+    If enabled (this is the default) then slices are inserted using worker threads that are kept alive
+    between InsertSlice and InsertSlices calls. If disabled then threads are created and joined for each slice, which is
+    significantly slower for small slices (mainly useful for performance comparison).
+  */
+  vtkSetMacro(UseWorkerPool,bool);
+  /*! Get if slices are inserted using persistent worker threads */
+  vtkGetMacro(UseWorkerPool,bool);
+  vtkBooleanMacro(UseWorkerPool,bool);
+
   /*! DEPRECATED - use CompoundingMode instead! */
   vtkSetMacro(Compounding,int);
   /*! DEPRECATED - use CompoundingMode instead! */
@@ -334,6 +365,15 @@ protected:
 
   /*! Thread function that actually performs the pasting of frame pixels into the volume */
   static VTK_THREAD_RETURN_TYPE InsertSliceThreadFunction( void *arg );
+
+  /*! Thread function that inserts slices into bricks of the volume, used by InsertSlices */
+  static VTK_THREAD_RETURN_TYPE InsertSlicesIntoBricksThreadFunction( void *arg );
+
+  /*! Set all the slice insertion parameters from the current settings */
+  void GetInsertSliceParameters(InsertSliceThreadFunctionInfoStruct& str, vtkImageData* image, vtkMatrix4x4* transformImageToReference);
+
+  /*! Returns PLUS_FAIL and logs an error if the output extent has not been set */
+  PlusStatus CheckOutputExtent();
   
   /*!
     To split the extent over many threads
@@ -370,7 +410,9 @@ protected:
 
   // Multithreading
   vtkMultiThreader *Threader;
+  vtkPlusWorkerPool *WorkerPool;
   int NumberOfThreads;
+  bool UseWorkerPool;
   
   double PixelRejectionThreshold;
   
@@ -14,6 +14,7 @@
 #include "vtkPlusVolumeReconstructor.h"
 
 // STL includes
+#include <algorithm>
 #include <limits>
 
 // VTK includes
@@ -536,6 +537,110 @@ PlusStatus vtkPlusVolumeReconstructor::AddTrackedFrame(PlusTrackedFrame* frame,
   return status;
 }
 
+//----------------------------------------------------------------------------
+PlusStatus vtkPlusVolumeReconstructor::AddTrackedFrames(vtkPlusTrackedFrameList* trackedFrameList, vtkPlusTransformRepository* transformRepository, int* numberOfInsertedFrames/*=NULL*/)
+{
+  if (numberOfInsertedFrames != NULL)
+  {
+    *numberOfInsertedFrames = 0;
+  }
+
+  PlusTransformName imageToReferenceTransformName;
+  if (GetImageToReferenceTransformName(imageToReferenceTransformName) != PLUS_SUCCESS)
+  {
+    LOG_ERROR("Invalid ImageToReference transform name");
+    return PLUS_FAIL;
+  }
+
+  if (trackedFrameList == NULL)
+  {
+    LOG_ERROR("Failed to add tracked frames to volume - input frame list is NULL");
+    return PLUS_FAIL;
+  }
+
+  if (transformRepository == NULL)
+  {
+    LOG_ERROR("Failed to add tracked frames to volume - input transform repository is NULL");
+    return PLUS_FAIL;
+  }
+
+  if (this->Reconstructor->GetCompoundingMode() == vtkPlusPasteSliceIntoVolume::IMPORTANCE_MASK_COMPOUNDING_MODE)
+  {
+    if (UpdateImportanceMask() == PLUS_FAIL)
+    {
+      LOG_ERROR("Failed to get importance mask");
+      return PLUS_FAIL;
+    }
+  }
+
+  PlusStatus status = PLUS_SUCCESS;
+  // Keeps the matrices referenced by the slices alive until the slices are inserted
+  std::vector< vtkSmartPointer<vtkMatrix4x4> > imageToReferenceTransformMatrices;
+  // Keeps the images alive as well: the image data loader of lazily loaded frames does not release referenced images
+  std::vector< vtkSmartPointer<vtkImageData> > sliceImages;
+  std::vector<vtkPlusPasteSliceIntoVolume::SliceToInsert> slices;
+  int skipInterval = std::max(this->SkipInterval, 1);
+  for (unsigned int frameIndex = 0; frameIndex < trackedFrameList->GetNumberOfTrackedFrames(); frameIndex += skipInterval)
+  {
+    PlusTrackedFrame* frame = trackedFrameList->GetTrackedFrame(frameIndex);
+    if (transformRepository->SetTransforms(*frame) != PLUS_SUCCESS)
+    {
+      LOG_ERROR("Failed to update transform repository with frame #" << frameIndex);
+      status = PLUS_FAIL;
+      continue;
+    }
+
+    bool isMatrixValid(false);
+    vtkSmartPointer<vtkMatrix4x4> imageToReferenceTransformMatrix = vtkSmartPointer<vtkMatrix4x4>::New();
+    if (transformRepository->GetTransform(imageToReferenceTransformName, imageToReferenceTransformMatrix, &isMatrixValid) != PLUS_SUCCESS)
+    {
+      std::string strImageToReferenceTransformName;
+      imageToReferenceTransformName.GetTransformName(strImageToReferenceTransformName);
+      LOG_ERROR("Failed to get transform '" << strImageToReferenceTransformName << "' from transform repository for frame #" << frameIndex);
+      status = PLUS_FAIL;
+      continue;
+    }
+
+    if (!isMatrixValid)
+    {
+      // Insert only valid frame into volume
+      LOG_DEBUG("ImageToReference transform is invalid for frame #" << frameIndex << ", therefore this frame is not be inserted into the volume");
+      continue;
+    }
+    if (numberOfInsertedFrames != NULL)
+    {
+      (*numberOfInsertedFrames)++;
+    }
+
+    vtkImageData* frameImage = frame->GetImageData()->GetImage();
+    bool isImageEmpty = false;
+    UpdateFanAnglesFromImage(frameImage, isImageEmpty);
+    if (isImageEmpty)
+    {
+      // nothing to insert, image is empty
+      continue;
+    }
+
+    // Fan angles may be detected for each frame, so they are stored for each slice
+    vtkPlusPasteSliceIntoVolume::SliceToInsert slice;
+    slice.Image = frameImage;
+    slice.ImageToReference = imageToReferenceTransformMatrix;
+    slice.FanAnglesDeg[0] = this->Reconstructor->GetFanAnglesDeg()[0];
+    slice.FanAnglesDeg[1] = this->Reconstructor->GetFanAnglesDeg()[1];
+    slices.push_back(slice);
+    imageToReferenceTransformMatrices.push_back(imageToReferenceTransformMatrix);
+    sliceImages.push_back(frameImage);
+  }
+
+  if (this->Reconstructor->InsertSlices(slices) != PLUS_SUCCESS)
+  {
+    LOG_ERROR("Failed to insert slices into the volume");
+    status = PLUS_FAIL;
+  }
+  this->Modified();
+  return status;
+}
+
 //----------------------------------------------------------------------------
 PlusStatus vtkPlusVolumeReconstructor::UpdateReconstructedVolume()
 {
@@ -73,6 +73,15 @@ public:
   */
   virtual PlusStatus AddTrackedFrame(PlusTrackedFrame* frame, vtkPlusTransformRepository* transformRepository, bool* insertedIntoVolume = NULL);
 
+  /*!
+    Inserts all the frames of the tracked frame list into the volume (every SkipInterval-th frame).
+    The transform repository is updated with the transforms of each frame. The frames are inserted
+    in one batch: each thread inserts the frames into a separate part of the volume, which is much faster
+    than adding the frames one by one if there are many frames.
+    \param numberOfInsertedFrames Number of frames that had valid image to reference transform and so were added to the volume (optional)
+  */
+  virtual PlusStatus AddTrackedFrames(vtkPlusTrackedFrameList* trackedFrameList, vtkPlusTransformRepository* transformRepository, int* numberOfInsertedFrames = NULL);
+
   /*!
     Makes the reconstructed volume ready to be retrieved.
     The slices are pasted into the volume immediately, but hole filling is performed only when this method is called.